@@ -109,10 +109,10 @@ internal static class Program
             sw.Stop();
             Program.LogIt($"took {sw.Elapsed}, and found {sections.Count:N0} binary sections and {compilands.Count:N0} compilands.");
 
-            Dictionary<uint, SymbolContributor> rvaToContributorMap;
+            RvaToContributorMap rvaToContributorMap;
             using (sessionLogger.StartTaskLog("BinaryBytes Creating RVA To Contributor Map"))
             {
-                rvaToContributorMap = Utilities.CreateRvaToContributorMap(compilands);
+                rvaToContributorMap = new RvaToContributorMap(compilands);
             }
 
             using (sessionLogger.StartTaskLog("BinaryBytes Processing Section Bytes"))
@@ -154,7 +154,7 @@ internal static class Program
     /// within those groups, for each of the section and mark the "bytes" as Symbols or Padding or SepcialCase 
     /// (i.e. Sections without any COFF groups OR COFF groups without any symbols, example .reloc section).  
     /// </summary>
-    private static async Task<IEnumerable<SectionBytes>> ProcessSectionBytes(Session session, IReadOnlyList<BinarySection> sections, Dictionary<uint, SymbolContributor> rvaToContributorMap)
+    private static async Task<IEnumerable<SectionBytes>> ProcessSectionBytes(Session session, IReadOnlyList<BinarySection> sections, RvaToContributorMap rvaToContributorMap)
     {
         var binaryBytes = new List<SectionBytes>();
         foreach (var section in sections)
@@ -172,7 +172,7 @@ internal static class Program
         return binaryBytes;
     }
 
-    private static void MarkSpecialBytesInSection(BinarySection section, Dictionary<uint, SymbolContributor> rvaToContributorMap, List<BytesItem> adjustedSymbols)
+    private static void MarkSpecialBytesInSection(BinarySection section, RvaToContributorMap rvaToContributorMap, List<BytesItem> adjustedSymbols)
     {
         if (section.COFFGroups.Count > 0)
         {
@@ -201,7 +201,7 @@ internal static class Program
         }
         else
         {
-            var rvaContributor = Utilities.GetContributorForRva(section.RVA, rvaToContributorMap);
+            var rvaContributor = rvaToContributorMap.GetContributorForRva(section.RVA);
             adjustedSymbols.Add(Utilities.CreateSpecialBytesItem(Constants.SpecialSection, String.Empty,
                 section.RVA, section.VirtualSize, rvaContributor));
         }
@@ -211,7 +211,7 @@ internal static class Program
     /// Given a section, this routine enumerates all of the COFF groups in it and 
     /// processes the bytes in each of those groups.
     /// </summary>
-    private static async Task<List<BytesItem>> ProcessCoffGroupBytes(Session session, BinarySection section, Dictionary<uint, SymbolContributor> rvaToContributorMap)
+    private static async Task<List<BytesItem>> ProcessCoffGroupBytes(Session session, BinarySection section, RvaToContributorMap rvaToContributorMap)
     {
         var adjustedSymbols = new List<BytesItem>();
         foreach (var coffgroup in section.COFFGroups)
@@ -232,7 +232,7 @@ internal static class Program
             }
             else
             {
-                var rvaContributor = Utilities.GetContributorForRva(coffgroup.RVA, rvaToContributorMap);
+                var rvaContributor = rvaToContributorMap.GetContributorForRva(coffgroup.RVA);
                 adjustedSymbols.Add(Utilities.CreateSpecialBytesItem(Constants.SpecialCoffGroup,
                     coffgroup.Name, coffgroup.RVA, coffgroup.VirtualSize, rvaContributor));
             }
@@ -248,7 +248,7 @@ internal static class Program
     /// Given a COFF group and a list of symbols in that group, this routine identifies all the Padding bytes and
     /// the actual symbols bytes in the COFF group and marks them appropriately.
     /// </summary>
-    private static void IdentifyPaddingAroundSymbols(List<ISymbol> symbols, COFFGroup coffgroup, Dictionary<uint, SymbolContributor> rvaToContributorMap, List<BytesItem> bytesItems)
+    private static void IdentifyPaddingAroundSymbols(List<ISymbol> symbols, COFFGroup coffgroup, RvaToContributorMap rvaToContributorMap, List<BytesItem> bytesItems)
     {
         // Is there gap at the start of this COFF group?
         var startingByteOfCoffgroup = coffgroup.RVA;
@@ -261,6 +261,8 @@ internal static class Program
 
         // Identify gaps between symbols
         uint endingByteOfPreviousSymbol = 0;
+        var contributorSearchHint = 0; // Symbols are sorted by RVA, so finding their contributors is one walk forward through the map
+
         foreach (var symbol in symbols)
         {
             // Look for padding
@@ -273,7 +275,7 @@ internal static class Program
             endingByteOfPreviousSymbol = symbol.RVA + symbol.VirtualSize;
 
             // Add the actual symbol itself to the items list
-            var rvaContributor = Utilities.GetContributorForRva(symbol.RVA, rvaToContributorMap);
+            var rvaContributor = rvaToContributorMap.GetContributorForRva(symbol.RVA, ref contributorSearchHint);
             bytesItems.Add(Utilities.CreateSymbolsBytesItem(symbol, coffgroup.Name, rvaContributor));
         }
 
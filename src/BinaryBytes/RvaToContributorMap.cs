@@ -0,0 +1,98 @@
+﻿using SizeBench.AnalysisEngine;
+
+namespace BinaryBytes;
+
+/// <summary>
+/// Finds the lib and compiland that contributed any RVA in the binary, from the RVA ranges of every COFF Group contribution.
+/// </summary>
+/// <remarks>
+/// This is queried once per symbol, so it's laid out for speed on very large binaries: the ranges are sorted by their start RVA into
+/// parallel arrays, so any RVA can be found with a binary search - and when RVAs are looked up in ascending order (as symbols in a
+/// COFF Group are), a caller can pass the same search hint to each lookup and it becomes a single walk forward through the ranges.
+/// </remarks>
+internal sealed class RvaToContributorMap
+{
+    private readonly uint[] _rvaStarts;
+    private readonly uint[] _rvaEnds; // Inclusive, like RVARange.RVAEnd
+    private readonly SymbolContributor[] _contributors;
+
+    public RvaToContributorMap(IReadOnlyCollection<Compiland> compilands)
+    {
+        ArgumentNullException.ThrowIfNull(compilands);
+
+        var ranges = new List<(RVARange range, SymbolContributor contributor)>();
+        foreach (var compiland in compilands)
+        {
+            // Every range in a compiland has the same contributor, so they can all share one.
+            var contributor = new SymbolContributor(compiland.Lib.ShortName, compiland.ShortName);
+            foreach (var coffgroupContribution in compiland.COFFGroupContributions.Values)
+            {
+                foreach (var rvaRange in coffgroupContribution.RVARanges)
+                {
+                    ranges.Add((rvaRange, contributor));
+                }
+            }
+        }
+
+        ranges.Sort((left, right) => left.range.RVAStart.CompareTo(right.range.RVAStart));
+
+        this._rvaStarts = new uint[ranges.Count];
+        this._rvaEnds = new uint[ranges.Count];
+        this._contributors = new SymbolContributor[ranges.Count];
+        for (var i = 0; i < ranges.Count; i++)
+        {
+            this._rvaStarts[i] = ranges[i].range.RVAStart;
+            this._rvaEnds[i] = ranges[i].range.RVAEnd;
+            this._contributors[i] = ranges[i].contributor;
+        }
+    }
+
+    /// <summary>
+    /// Finds the contributor of the range containing <paramref name="rva"/>.
+    /// </summary>
+    /// <returns>The contributor, or <see cref="SymbolContributor.Default"/> if no range contains this RVA.</returns>
+    public SymbolContributor GetContributorForRva(uint rva)
+    {
+        var searchHint = 0;
+        return GetContributorForRva(rva, ref searchHint);
+    }
+
+    /// <summary>
+    /// Finds the contributor of the range containing <paramref name="rva"/>, starting the search from <paramref name="searchHint"/>.
+    /// </summary>
+    /// <param name="rva">The RVA to look up.</param>
+    /// <param name="searchHint">Where to start looking, which is updated to where this RVA was found.  Start it at 0, and pass the same
+    /// one back in for each RVA in ascending order to look them all up in one pass over the ranges.  RVAs out of order still work, they
+    /// just fall back to a binary search.</param>
+    /// <returns>The contributor, or <see cref="SymbolContributor.Default"/> if no range contains this RVA.</returns>
+    public SymbolContributor GetContributorForRva(uint rva, ref int searchHint)
+    {
+        // The index of the last range starting at or before this RVA - it's the only one that could contain it.
+        int index;
+        if (searchHint > 0 && searchHint < this._rvaStarts.Length && this._rvaStarts[searchHint] <= rva)
+        {
+            index = searchHint;
+            while (index + 1 < this._rvaStarts.Length && this._rvaStarts[index + 1] <= rva)
+            {
+                index++;
+            }
+        }
+        else
+        {
+            index = Array.BinarySearch(this._rvaStarts, rva);
+            if (index < 0)
+            {
+                index = ~index - 1;
+            }
+        }
+
+        if (index < 0)
+        {
+            searchHint = 0;
+            return SymbolContributor.Default;
+        }
+
+        searchHint = index;
+        return rva <= this._rvaEnds[index] ? this._contributors[index] : SymbolContributor.Default;
+    }
+}
@@ -108,35 +108,4 @@ internal static class Utilities
             DynamicInstructionCount = functionSymbol?.DynamicInstructionCount ?? 0,
         };
     }
-
-    internal static Dictionary<uint, SymbolContributor> CreateRvaToContributorMap(IReadOnlyCollection<Compiland> compilands)
-    {
-        var rvaToContributorMap = new Dictionary<uint, SymbolContributor>();
-
-        foreach (var compiland in compilands)
-        {
-            foreach (var coffgroupContribution in compiland.COFFGroupContributions)
-            {
-                var compilandName = coffgroupContribution.Value.Compiland.ShortName;
-                var libName = coffgroupContribution.Value.Compiland.Lib.ShortName;
-                foreach (var rvaRange in coffgroupContribution.Value.RVARanges)
-                {
-                    var rva = rvaRange.RVAStart;
-                    rvaToContributorMap.Add(rva, new SymbolContributor(libName, compilandName));
-                }
-            }
-        }
-
-        return rvaToContributorMap;
-    }
-
-    internal static SymbolContributor GetContributorForRva(uint rva, Dictionary<uint, SymbolContributor> rvaToContributorMap)
-    {
-        if (rvaToContributorMap.TryGetValue(rva, out var value))
-        {
-            return value;
-        }
-
-        return SymbolContributor.Default;
-    }
 }
@@ -0,0 +1,79 @@
+﻿using System.Globalization;
+using System.IO;
+using System.Text.Json;
+using BenchmarkDotNet.Reports;
+
+namespace SizeBench.AnalysisEngine.Benchmarks;
+
+// Saves the results of a run so a later run (after a change, say) can be compared against it.  Timings depend on the machine, so a
+// baseline is only meaningful on the machine that recorded it - save one before making a change, then compare against it afterwards.
+//
+// Allocations are nearly deterministic, so they're held to the same threshold as time even though time is the noisier of the two.
+internal static class BenchmarkBaseline
+{
+    // How much slower, or how many more bytes allocated, a benchmark can be before it's called a regression.
+    private const double RegressionThreshold = 0.10;
+
+    private sealed record class BaselineEntry(double MedianNanoseconds, long AllocatedBytesPerOperation);
+
+    private static readonly JsonSerializerOptions SerializerOptions = new JsonSerializerOptions() { WriteIndented = true };
+
+    public static void Save(IEnumerable<Summary> summaries, string path)
+    {
+        var entries = GetEntries(summaries);
+        File.WriteAllText(path, JsonSerializer.Serialize(entries, SerializerOptions));
+        Console.WriteLine($"Saved a baseline of {entries.Count} benchmarks to {path}");
+    }
+
+    /// <returns>True if any benchmark regressed compared to the baseline.</returns>
+    public static bool CompareAndReportRegressions(IEnumerable<Summary> summaries, string path)
+    {
+        var baseline = JsonSerializer.Deserialize<SortedDictionary<string, BaselineEntry>>(File.ReadAllText(path), SerializerOptions)
+                       ?? throw new InvalidDataException($"{path} does not contain a benchmark baseline.");
+
+        var anyRegressed = false;
+        Console.WriteLine();
+        Console.WriteLine($"Comparison against the baseline in {path} (regressions are more than {RegressionThreshold:P0} worse):");
+        foreach (var (name, current) in GetEntries(summaries))
+        {
+            if (!baseline.TryGetValue(name, out var previous))
+            {
+                Console.WriteLine($"  NEW        {name}");
+                continue;
+            }
+
+            var timeRatio = current.MedianNanoseconds / previous.MedianNanoseconds;
+            var allocationRatio = previous.AllocatedBytesPerOperation == 0 ?
+                                  (current.AllocatedBytesPerOperation == 0 ? 1.0 : Double.PositiveInfinity) :
+                                  current.AllocatedBytesPerOperation / (double)previous.AllocatedBytesPerOperation;
+            var regressed = timeRatio > 1.0 + RegressionThreshold || allocationRatio > 1.0 + RegressionThreshold;
+            anyRegressed |= regressed;
+
+            Console.WriteLine(String.Format(CultureInfo.InvariantCulture, "  {0,-10} {1}: time x{2:F2}, allocated x{3:F2}",
+                                            regressed ? "REGRESSED" : "ok", name, timeRatio, allocationRatio));
+        }
+
+        return anyRegressed;
+    }
+
+    private static SortedDictionary<string, BaselineEntry> GetEntries(IEnumerable<Summary> summaries)
+    {
+        var entries = new SortedDictionary<string, BaselineEntry>(StringComparer.Ordinal);
+        foreach (var report in summaries.SelectMany(summary => summary.Reports))
+        {
+            // A benchmark that failed has no statistics, and there's nothing to compare it on.
+            if (report.ResultStatistics is null)
+            {
+                continue;
+            }
+
+            // The job's name is left out on purpose - it can differ from run to run, while the benchmark and its parameters identify it.
+            var benchmarkCase = report.BenchmarkCase;
+            var name = $"{benchmarkCase.Descriptor.Type.Name}.{benchmarkCase.Descriptor.WorkloadMethod.Name}{benchmarkCase.Parameters.DisplayInfo}";
+            entries[name] = new BaselineEntry(report.ResultStatistics.Median,
+                                              report.GcStats.GetBytesAllocatedPerOperation(benchmarkCase) ?? 0);
+        }
+
+        return entries;
+    }
+}
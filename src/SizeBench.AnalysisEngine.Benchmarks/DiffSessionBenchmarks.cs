@@ -0,0 +1,91 @@
+﻿using BenchmarkDotNet.Attributes;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.Benchmarks;
+
+// Measures the analyses a user can open when diffing two binaries, on the CppTestCasesBefore/After pair.  Like SessionAnalysisBenchmarks,
+// each measurement gets a freshly opened DiffSession (so nothing is already cached) and is a single invocation.
+[MemoryDiagnoser]
+[InvocationCount(1)]
+public class DiffSessionBenchmarks : IDisposable
+{
+    private NoOpLogger? _logger;
+    private DiffSession? _diffSession;
+
+    [GlobalSetup]
+    public void GlobalSetup() => this._logger = new NoOpLogger();
+
+    [IterationSetup(Targets = new[] { nameof(EnumerateBinarySectionAndCOFFGroupDiffs),
+                                      nameof(EnumerateLibDiffs),
+                                      nameof(EnumerateDuplicateDataDiffs),
+                                      nameof(EnumerateWastefulVirtualDiffs),
+                                      nameof(EnumerateTemplateFoldabilityDiffs) })]
+    public void IterationSetup()
+        => this._diffSession = DiffSession.Create(TestPEs.CppTestCasesBeforeBinaryPath, TestPEs.CppTestCasesBeforePDBPath,
+                                                  TestPEs.CppTestCasesAfterBinaryPath, TestPEs.CppTestCasesAfterPDBPath,
+                                                  this._logger!).GetAwaiter().GetResult();
+
+    [IterationCleanup]
+    public void IterationCleanup()
+    {
+        this._diffSession?.DisposeAsync().AsTask().GetAwaiter().GetResult();
+        this._diffSession = null;
+    }
+
+    [GlobalCleanup]
+    public void GlobalCleanup() => Dispose();
+
+    [Benchmark]
+    public async Task OpenDiffSession()
+    {
+        await using var diffSession = await DiffSession.Create(TestPEs.CppTestCasesBeforeBinaryPath, TestPEs.CppTestCasesBeforePDBPath,
+                                                               TestPEs.CppTestCasesAfterBinaryPath, TestPEs.CppTestCasesAfterPDBPath,
+                                                               this._logger!);
+    }
+
+    [Benchmark]
+    public async Task<int> EnumerateBinarySectionAndCOFFGroupDiffs()
+        => (await this._diffSession!.EnumerateBinarySectionsAndCOFFGroupDiffs(CancellationToken.None)).Count;
+
+    [Benchmark]
+    public async Task<int> EnumerateLibDiffs()
+        => (await this._diffSession!.EnumerateLibDiffs(CancellationToken.None)).Count;
+
+    [Benchmark]
+    public async Task<int> EnumerateDuplicateDataDiffs()
+        => (await this._diffSession!.EnumerateDuplicateDataItemDiffs(CancellationToken.None)).Count;
+
+    [Benchmark]
+    public async Task<int> EnumerateWastefulVirtualDiffs()
+        => (await this._diffSession!.EnumerateWastefulVirtualItemDiffs(CancellationToken.None)).Count;
+
+    [Benchmark]
+    public async Task<int> EnumerateTemplateFoldabilityDiffs()
+        => (await this._diffSession!.EnumerateTemplateFoldabilityItemDiffs(CancellationToken.None)).Count;
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    protected virtual void Dispose(bool disposing)
+    {
+        if (!this._isDisposed)
+        {
+            if (disposing)
+            {
+                IterationCleanup();
+                this._logger?.Dispose();
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    public void Dispose()
+    {
+        Dispose(true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
@@ -0,0 +1,98 @@
+﻿using System.Buffers.Binary;
+using BenchmarkDotNet.Attributes;
+using SizeBench.AnalysisEngine.Disassembly;
+using SizeBench.AnalysisEngine.PE;
+
+namespace SizeBench.AnalysisEngine.Benchmarks;
+
+// Measures ManagedDisassembler decoding every function in the largest binary in TestPEs, as found in its .pdata, which is what a
+// whole-binary statistic (instruction mix, call graph) would need to do.  Decoding doesn't touch DIA, so it can be spread across every
+// core - the Parallel benchmark shows how much that buys.
+[MemoryDiagnoser]
+public class DisassemblyBenchmarks : IDisposable
+{
+    private MappedPEImage? _image;
+    private MachineType _machineType;
+    private ulong _imageBase;
+    private (uint RVAStart, int Length)[] _functions = [];
+
+    [GlobalSetup]
+    public void GlobalSetup()
+    {
+        this._image = new MappedPEImage(TestPEs.LargestBinaryPath);
+        var headers = this._image.PEReader.PEHeaders;
+        this._machineType = (MachineType)headers.CoffHeader.Machine;
+        this._imageBase = headers.PEHeader!.ImageBase;
+
+        // x64 RUNTIME_FUNCTIONs are 12 bytes - begin RVA, end RVA, unwind info RVA.
+        var exceptionDirectory = headers.PEHeader.ExceptionTableDirectory;
+        var pdata = this._image.GetBytesByRVA(exceptionDirectory.RelativeVirtualAddress, exceptionDirectory.Size);
+        var functions = new List<(uint RVAStart, int Length)>(pdata.Length / 12);
+        for (var offset = 0; offset + 12 <= pdata.Length; offset += 12)
+        {
+            var begin = BinaryPrimitives.ReadUInt32LittleEndian(pdata[offset..]);
+            var end = BinaryPrimitives.ReadUInt32LittleEndian(pdata[(offset + 4)..]);
+            if (end > begin)
+            {
+                functions.Add((begin, (int)(end - begin)));
+            }
+        }
+        this._functions = functions.ToArray();
+    }
+
+    [GlobalCleanup]
+    public void GlobalCleanup() => Dispose();
+
+    [Benchmark(Baseline = true)]
+    public long DecodeAllFunctionsSequentially()
+    {
+        long instructionCount = 0;
+        foreach (var (rvaStart, length) in this._functions)
+        {
+            instructionCount += ManagedDisassembler.DecodeRange(this._image!.GetBytesByRVA(rvaStart, length), rvaStart, this._machineType, this._imageBase).Count;
+        }
+
+        return instructionCount;
+    }
+
+    [Benchmark]
+    public long DecodeAllFunctionsInParallel()
+    {
+        long instructionCount = 0;
+        Parallel.For(0, this._functions.Length,
+                     () => 0L,
+                     (i, _, localCount) =>
+                     {
+                         var (rvaStart, length) = this._functions[i];
+                         return localCount + ManagedDisassembler.DecodeRange(this._image!.GetBytesByRVA(rvaStart, length), rvaStart, this._machineType, this._imageBase).Count;
+                     },
+                     localCount => Interlocked.Add(ref instructionCount, localCount));
+
+        return instructionCount;
+    }
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    protected virtual void Dispose(bool disposing)
+    {
+        if (!this._isDisposed)
+        {
+            if (disposing)
+            {
+                this._image?.Dispose();
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    public void Dispose()
+    {
+        Dispose(true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
@@ -0,0 +1,132 @@
+﻿using System.Reflection.PortableExecutable;
+using BenchmarkDotNet.Attributes;
+using Moq;
+using SizeBench.AnalysisEngine.DIAInterop;
+using SizeBench.AnalysisEngine.SessionTasks;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+using SizeBench.TestDataCommon;
+
+namespace SizeBench.AnalysisEngine.Benchmarks;
+
+// A stress test for EnumerateDuplicateDataSessionTask on the pathological case of a header that stamps out thousands of file-static
+// variables with the same name and size into many compilands, where only some of them actually have the same contents.  This is synthetic
+// (no real binary in TestPEs looks like this) so the number of same-named symbols can be scaled up to show how detection scales with it.
+[MemoryDiagnoser]
+public class DuplicateDataBenchmarks : IDisposable
+{
+    private const int CompilandCount = 64;
+    private const uint SymbolSize = 16;
+    private const uint DataRVA = 0x1000;
+
+    // Each distinct set of contents appears this many times, so roughly 3/4 of the symbols are wasted duplicates.
+    private const int CopiesOfEachContents = 4;
+
+    private NoOpLogger? _logger;
+    private SessionDataCache? _dataCache;
+    private SessionTaskParameters? _sessionTaskParameters;
+    private byte[] _imageBytes = [];
+
+    [Params(1_000, 10_000)]
+    public int SymbolsWithTheSameName { get; set; }
+
+    [GlobalSetup]
+    public void GlobalSetup()
+    {
+        this._logger = new NoOpLogger();
+        this._dataCache = new SessionDataCache()
+        {
+            AllCanonicalNames = new SortedList<uint, NameCanonicalization>(),
+            PDataHasBeenInitialized = true,
+            XDataHasBeenInitialized = true,
+            RsrcHasBeenInitialized = true,
+            OtherPESymbolsHaveBeenInitialized = true,
+        };
+
+        var dataSize = (uint)this.SymbolsWithTheSameName * SymbolSize;
+        var diaAdapter = new TestDIAAdapter()
+        {
+            BinarySectionsToFind = [new BinarySection(this._dataCache, ".data", size: dataSize, virtualSize: dataSize, rva: DataRVA, fileAlignment: 0, sectionAlignment: 0, characteristics: SectionCharacteristics.MemRead | SectionCharacteristics.MemWrite)],
+            COFFGroupsToFind = [new COFFGroup(this._dataCache, ".data", size: dataSize, rva: DataRVA, fileAlignment: 0, sectionAlignment: 0, characteristics: SectionCharacteristics.MemRead | SectionCharacteristics.MemWrite)],
+            SectionContributionsToFind = Enumerable.Range(0, CompilandCount)
+                                                   .Select(i => new RawSectionContribution(@"c:\dummy\a.lib", $@"c:\dummy\{i}.obj", compilandSymIndexId: (uint)i, rva: DataRVA + ((uint)i * SymbolSize), length: SymbolSize))
+                                                   .ToList(),
+        };
+
+        var session = new Mock<ISession>();
+        session.Setup(s => s.CompareData(It.IsAny<long>(), It.IsAny<long>(), It.IsAny<uint>()))
+               .Returns((long rva1, long rva2, uint length) => GetBytes(rva1, length).SequenceEqual(GetBytes(rva2, length)));
+        session.Setup(s => s.HashData(It.IsAny<long>(), It.IsAny<uint>()))
+               .Returns((long rva, uint length) =>
+               {
+                   var hash = new HashCode();
+                   hash.AddBytes(GetBytes(rva, length));
+                   return hash.ToHashCode();
+               });
+
+        this._sessionTaskParameters = new SessionTaskParameters(session.Object, diaAdapter, this._dataCache);
+
+        new EnumerateLibsAndCompilandsSessionTask(this._sessionTaskParameters, CancellationToken.None, null).Execute(this._logger);
+        var compilands = this._dataCache.AllCompilands!.ToList();
+
+        // Lay the symbols out one after the other, spread across all the compilands, with each symbol's contents being its index modulo
+        // the number of distinct contents.
+        this._imageBytes = new byte[DataRVA + dataSize];
+        var distinctContents = Math.Max(1, this.SymbolsWithTheSameName / CopiesOfEachContents);
+        var type = new BasicTypeSymbol(this._dataCache, "int", size: 4, symIndexId: 0);
+        var symbolsByCompiland = compilands.ToDictionary(c => c, _ => new List<StaticDataSymbol>());
+        for (var i = 0; i < this.SymbolsWithTheSameName; i++)
+        {
+            var rva = DataRVA + ((uint)i * SymbolSize);
+            BitConverter.TryWriteBytes(this._imageBytes.AsSpan((int)rva), i % distinctContents);
+
+            var compiland = compilands[i % compilands.Count];
+            symbolsByCompiland[compiland].Add(new StaticDataSymbol(this._dataCache, "s_sameNameEverywhere", rva, SymbolSize, isVirtualSize: false, symIndexId: (uint)i + 1,
+                                                                   DataKind.DataIsFileStatic, type, referencedIn: compiland, functionParent: null));
+        }
+
+        foreach (var (compiland, symbols) in symbolsByCompiland)
+        {
+            diaAdapter.StaticDataSymbolsToFindByCompiland.Add(compiland, symbols);
+        }
+    }
+
+    [GlobalCleanup]
+    public void GlobalCleanup() => Dispose();
+
+    private ReadOnlySpan<byte> GetBytes(long rva, uint length) => this._imageBytes.AsSpan((int)rva, (int)length);
+
+    [Benchmark]
+    public int EnumerateDuplicateData()
+    {
+        // The task caches its results, so clear that out to measure the detection every time.
+        this._dataCache!.AllDuplicateDataItems = null;
+        return new EnumerateDuplicateDataSessionTask(this._sessionTaskParameters!, CancellationToken.None, null).Execute(this._logger!).Count;
+    }
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    protected virtual void Dispose(bool disposing)
+    {
+        if (!this._isDisposed)
+        {
+            if (disposing)
+            {
+                this._dataCache?.Dispose();
+                this._logger?.Dispose();
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    public void Dispose()
+    {
+        Dispose(true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
@@ -0,0 +1,19 @@
+﻿// This file is used by Code Analysis to maintain SuppressMessage
+// attributes that are applied to this project.
+// Project-level suppressions either have no target or are given
+// a specific target and scoped to a namespace, type, member, etc.
+
+using System.Diagnostics.CodeAnalysis;
+
+[assembly: SuppressMessage("Maintainability", "CA1515:Consider making public types internal",
+                           Justification = "BenchmarkDotNet requires benchmark classes to be public.")]
+
+[assembly: SuppressMessage("Reliability", "CA2007:Consider calling ConfigureAwait on the awaited task",
+                           Justification = "ConfigureAwait default is correct for app code, see this blog post by Stephen Toub: https://devblogs.microsoft.com/dotnet/configureawait-faq/")]
+
+[assembly: SuppressMessage("Globalization", "CA1303:Do not pass literals as localized parameters",
+                           Justification = "SizeBench doesn't care about localization currently",
+                           Scope = "namespaceanddescendants", Target = "~N:SizeBench.AnalysisEngine.Benchmarks")]
+
+[assembly: SuppressMessage("Security", "CA5394:Do not use insecure randomness",
+                           Justification = "Benchmarks use seeded Random to generate reproducible synthetic data, this has nothing to do with security.")]
@@ -0,0 +1,66 @@
+﻿using BenchmarkDotNet.Attributes;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.Benchmarks;
+
+// Compares opening a Session and parsing most of its symbols with and without the NamePool.  The pool doesn't reduce what's allocated -
+// DIA allocates every name either way, and the pool adds its own sets on top - so what this shows is the pool's cost in time and
+// allocations.  What it saves is in what the Session holds on to afterwards, which the Session logs (duplicates dropped, less the pool's
+// own size) when it's disposed.
+//
+// Wasteful virtuals are used to parse the symbols because they touch every user-defined type and its functions, which is where most of the
+// repeated names (parameters, member functions, base types) are.
+[MemoryDiagnoser]
+[InvocationCount(1)]
+public class NamePoolBenchmarks : IDisposable
+{
+    private NoOpLogger? _logger;
+
+    public static IEnumerable<string> Binaries => TestPEs.ScenarioBinaries;
+
+    [ParamsSource(nameof(Binaries))]
+    public string Binary { get; set; } = String.Empty;
+
+    [Params(true, false)]
+    public bool PoolSymbolNames { get; set; }
+
+    [GlobalSetup]
+    public void GlobalSetup() => this._logger = new NoOpLogger();
+
+    [GlobalCleanup]
+    public void GlobalCleanup() => Dispose();
+
+    [Benchmark]
+    public async Task<int> OpenSessionAndParseSymbols()
+    {
+        await using var session = await Session.Create(TestPEs.BinaryPathFor(this.Binary), TestPEs.PDBPathFor(this.Binary),
+                                                       new SessionOptions() { PoolSymbolNames = this.PoolSymbolNames }, this._logger!);
+        await session.EnumerateWastefulVirtuals(CancellationToken.None);
+        return session.DataCache.AllSymbolsBySymIndexId.Count;
+    }
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    protected virtual void Dispose(bool disposing)
+    {
+        if (!this._isDisposed)
+        {
+            if (disposing)
+            {
+                this._logger?.Dispose();
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    public void Dispose()
+    {
+        Dispose(true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
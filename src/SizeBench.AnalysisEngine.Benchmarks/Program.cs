@@ -0,0 +1,50 @@
+﻿using BenchmarkDotNet.Running;
+
+namespace SizeBench.AnalysisEngine.Benchmarks;
+
+internal static class Program
+{
+    // Run with no arguments to pick benchmarks interactively, or use the usual BenchmarkDotNet switches such as
+    // "--filter *SymIndicesByRVA*" to run a subset.
+    //
+    // In addition to those, "--save-baseline <file>" records the results of the run, and "--compare-to-baseline <file>" compares the run
+    // against results recorded earlier and returns a non-zero exit code if anything regressed.  For example, to check a change:
+    //     SizeBench.AnalysisEngine.Benchmarks --filter *SessionAnalysis* --save-baseline before.json
+    //     (make the change)
+    //     SizeBench.AnalysisEngine.Benchmarks --filter *SessionAnalysis* --compare-to-baseline before.json
+    public static int Main(string[] args)
+    {
+        var benchmarkDotNetArgs = new List<string>(args.Length);
+        string? saveBaselinePath = null;
+        string? compareToBaselinePath = null;
+        for (var i = 0; i < args.Length; i++)
+        {
+            if (args[i] == "--save-baseline" && i + 1 < args.Length)
+            {
+                saveBaselinePath = args[++i];
+            }
+            else if (args[i] == "--compare-to-baseline" && i + 1 < args.Length)
+            {
+                compareToBaselinePath = args[++i];
+            }
+            else
+            {
+                benchmarkDotNetArgs.Add(args[i]);
+            }
+        }
+
+        var summaries = BenchmarkSwitcher.FromAssembly(typeof(Program).Assembly).Run(benchmarkDotNetArgs.ToArray()).ToList();
+
+        if (saveBaselinePath != null)
+        {
+            BenchmarkBaseline.Save(summaries, saveBaselinePath);
+        }
+
+        if (compareToBaselinePath != null && BenchmarkBaseline.CompareAndReportRegressions(summaries, compareToBaselinePath))
+        {
+            return 1;
+        }
+
+        return 0;
+    }
+}
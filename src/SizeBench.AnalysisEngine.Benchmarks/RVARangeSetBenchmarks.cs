@@ -0,0 +1,113 @@
+﻿using BenchmarkDotNet.Attributes;
+
+namespace SizeBench.AnalysisEngine.Benchmarks;
+
+// Measures the RVARangeSet queries that get made once per symbol while parsing (FullyContains on RVARangesThatAreOnlyVirtualSize) and
+// while enumerating symbols or duplicate data (Contains/AtLeastPartiallyOverlapsWith on XDataRVARanges and OtherPESymbolsRVARanges).
+// The LinearScan baseline is what RVARangeSet did before it kept its ranges sorted - a walk over every range in a HashSet.
+[MemoryDiagnoser]
+public class RVARangeSetBenchmarks
+{
+    private const int ProbeCount = 10_000;
+
+    private RVARangeSet _set = new RVARangeSet();
+    private HashSet<RVARange> _linearSet = [];
+    private List<RVARange> _sourceRanges = [];
+    private uint[] _probes = [];
+
+    // Small sets look like RVARangesThatAreOnlyVirtualSize, large sets look like XDATA or other PE symbols in a big binary.
+    [Params(8, 512, 16_384)]
+    public int RangeCount { get; set; }
+
+    [GlobalSetup]
+    public void GlobalSetup()
+    {
+        // Fixed seed so every run (and the baseline) sees the same layout.
+        var random = new Random(0x5B);
+        this._sourceRanges = new List<RVARange>(this.RangeCount);
+        var rva = 0x1000u;
+        for (var i = 0; i < this.RangeCount; i++)
+        {
+            var size = (uint)random.Next(16, 256);
+            this._sourceRanges.Add(RVARange.FromRVAAndSize(rva, size));
+            rva += size + (uint)random.Next(2, 64); // Always leave a gap so nothing coalesces
+        }
+
+        this._set = RVARangeSet.FromListOfRVARanges([.. this._sourceRanges], maxPaddingToMerge: 1);
+        this._linearSet = [.. this._sourceRanges];
+
+        this._probes = new uint[ProbeCount];
+        for (var i = 0; i < this._probes.Length; i++)
+        {
+            this._probes[i] = (uint)random.Next(0x1000, (int)rva);
+        }
+    }
+
+    [Benchmark(Baseline = true)]
+    public int LinearScanContains()
+    {
+        var found = 0;
+        foreach (var probe in this._probes)
+        {
+            foreach (var range in this._linearSet)
+            {
+                if (range.Contains(probe))
+                {
+                    found++;
+                    break;
+                }
+            }
+        }
+
+        return found;
+    }
+
+    [Benchmark]
+    public int Contains()
+    {
+        var found = 0;
+        foreach (var probe in this._probes)
+        {
+            if (this._set.Contains(probe))
+            {
+                found++;
+            }
+        }
+
+        return found;
+    }
+
+    [Benchmark]
+    public int FullyContains()
+    {
+        var found = 0;
+        foreach (var probe in this._probes)
+        {
+            if (this._set.FullyContains(probe, 8))
+            {
+                found++;
+            }
+        }
+
+        return found;
+    }
+
+    [Benchmark]
+    public int AtLeastPartiallyOverlapsWith()
+    {
+        var found = 0;
+        foreach (var probe in this._probes)
+        {
+            if (this._set.AtLeastPartiallyOverlapsWith(RVARange.FromRVAAndSize(probe, 64)))
+            {
+                found++;
+            }
+        }
+
+        return found;
+    }
+
+    [Benchmark]
+    public int FromListOfRVARanges()
+        => RVARangeSet.FromListOfRVARanges([.. this._sourceRanges], maxPaddingToMerge: 1).Count;
+}
@@ -0,0 +1,83 @@
+﻿using BenchmarkDotNet.Attributes;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.Benchmarks;
+
+// Measures each of the whole-binary analyses a user can open in the GUI (and that SKUCrawler runs on every binary).  A Session caches what
+// it has computed, so each measurement gets a freshly opened Session and is a single invocation - which means each one also includes
+// anything the analysis needs that the Session hasn't computed yet, just as the first time a user opens that view.
+[MemoryDiagnoser]
+[InvocationCount(1)]
+public class SessionAnalysisBenchmarks : IDisposable
+{
+    private NoOpLogger? _logger;
+    private Session? _session;
+
+    public static IEnumerable<string> Binaries => TestPEs.ScenarioBinaries;
+
+    [ParamsSource(nameof(Binaries))]
+    public string Binary { get; set; } = String.Empty;
+
+    [GlobalSetup]
+    public void GlobalSetup() => this._logger = new NoOpLogger();
+
+    [IterationSetup]
+    public void IterationSetup()
+        => this._session = Session.Create(TestPEs.BinaryPathFor(this.Binary), TestPEs.PDBPathFor(this.Binary), this._logger!).GetAwaiter().GetResult();
+
+    [IterationCleanup]
+    public void IterationCleanup()
+    {
+        this._session?.DisposeAsync().AsTask().GetAwaiter().GetResult();
+        this._session = null;
+    }
+
+    [GlobalCleanup]
+    public void GlobalCleanup() => Dispose();
+
+    [Benchmark]
+    public async Task<int> EnumerateBinarySectionsAndCOFFGroups()
+        => (await this._session!.EnumerateBinarySectionsAndCOFFGroups(CancellationToken.None)).Count;
+
+    [Benchmark]
+    public async Task<int> EnumerateLibsAndCompilands()
+        => (await this._session!.EnumerateLibs(CancellationToken.None)).Count;
+
+    [Benchmark]
+    public async Task<int> EnumerateDuplicateData()
+        => (await this._session!.EnumerateDuplicateDataItems(CancellationToken.None)).Count;
+
+    [Benchmark]
+    public async Task<int> EnumerateWastefulVirtuals()
+        => (await this._session!.EnumerateWastefulVirtuals(CancellationToken.None)).Count;
+
+    [Benchmark]
+    public async Task<int> EnumerateTemplateFoldability()
+        => (await this._session!.EnumerateTemplateFoldabilityItems(CancellationToken.None)).Count;
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    protected virtual void Dispose(bool disposing)
+    {
+        if (!this._isDisposed)
+        {
+            if (disposing)
+            {
+                IterationCleanup();
+                this._logger?.Dispose();
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    public void Dispose()
+    {
+        Dispose(true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
@@ -0,0 +1,60 @@
+﻿using BenchmarkDotNet.Attributes;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.Benchmarks;
+
+// Measures opening (and closing) a Session, which is dominated by pre-processing every symbol in the PDB - the wait a user sees before
+// anything else can happen, and the per-binary overhead SKUCrawler pays on every binary it crawls.  The on-disk analysis cache is left
+// off, so every open does the full pre-processing.
+[MemoryDiagnoser]
+public class SessionOpenBenchmarks : IDisposable
+{
+    private NoOpLogger? _logger;
+
+    public static IEnumerable<string> Binaries => TestPEs.ScenarioBinaries;
+
+    [ParamsSource(nameof(Binaries))]
+    public string Binary { get; set; } = String.Empty;
+
+    [Params(PDBReader.DIA, PDBReader.Managed)]
+    public PDBReader PDBReader { get; set; }
+
+    [GlobalSetup]
+    public void GlobalSetup() => this._logger = new NoOpLogger();
+
+    [GlobalCleanup]
+    public void GlobalCleanup() => Dispose();
+
+    [Benchmark]
+    public async Task<int> OpenSession()
+    {
+        await using var session = await Session.Create(TestPEs.BinaryPathFor(this.Binary), TestPEs.PDBPathFor(this.Binary),
+                                                       new SessionOptions() { PDBReader = this.PDBReader }, this._logger!);
+        return session.DataCache.AllSymbolsBySymIndexId.Count;
+    }
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    protected virtual void Dispose(bool disposing)
+    {
+        if (!this._isDisposed)
+        {
+            if (disposing)
+            {
+                this._logger?.Dispose();
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    public void Dispose()
+    {
+        Dispose(true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
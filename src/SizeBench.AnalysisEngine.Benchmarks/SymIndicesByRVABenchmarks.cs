@@ -0,0 +1,135 @@
+﻿using BenchmarkDotNet.Attributes;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.Benchmarks;
+
+// Measures the cost of SessionDataCache.TryFindSymIndicesInRVARange for the same set of queries a user generates by opening every section,
+// COFF Group, lib and compiland in the GUI - one query per RVA range.  The LinearWalk baseline is the algorithm this used before it was
+// replaced with a binary search, run over identical data so the two are directly comparable.
+[MemoryDiagnoser]
+public class SymIndicesByRVABenchmarks : IDisposable
+{
+    private NoOpLogger? _logger;
+    private Session? _session;
+    private RVARange[] _queries = [];
+    private List<(uint rva, List<uint> symIndices)> _linearLayout = [];
+
+    [GlobalSetup]
+    public async Task GlobalSetup()
+    {
+        this._logger = new NoOpLogger();
+        this._session = await Session.Create(TestPEs.LargestBinaryPath, TestPEs.LargestPDBPath, this._logger);
+
+        var queries = new List<RVARange>();
+        foreach (var section in await this._session.EnumerateBinarySectionsAndCOFFGroups(CancellationToken.None))
+        {
+            queries.Add(RVARange.FromRVAAndSize(section.RVA, section.VirtualSize));
+            queries.AddRange(section.COFFGroups.Select(cg => RVARange.FromRVAAndSize(cg.RVA, cg.VirtualSize)));
+        }
+
+        foreach (var compiland in await this._session.EnumerateCompilands(CancellationToken.None))
+        {
+            queries.AddRange(compiland.SectionContributions.Values.SelectMany(contribution => contribution.RVARanges));
+            queries.AddRange(compiland.COFFGroupContributions.Values.SelectMany(contribution => contribution.RVARanges));
+        }
+
+        this._queries = queries.ToArray();
+
+        // Reconstruct the old List-of-Lists layout from the index so the baseline walks exactly the same RVAs.
+        if (this._session.DataCache.TryFindSymIndicesInRVARange(new RVARange(0, UInt32.MaxValue), out var index, out _, out _))
+        {
+            this._linearLayout = new List<(uint rva, List<uint> symIndices)>(index.Count);
+            for (var i = 0; i < index.Count; i++)
+            {
+                this._linearLayout.Add((index.RVAAt(i), new List<uint>(index.SymIndicesAt(i))));
+            }
+        }
+    }
+
+    [GlobalCleanup]
+    public void GlobalCleanup() => Dispose();
+
+    [Benchmark(Baseline = true)]
+    public int LinearWalk()
+    {
+        var found = 0;
+        foreach (var query in this._queries)
+        {
+            if (LinearWalkFind(this._linearLayout, query, out var minIdx, out var maxIdx))
+            {
+                found += maxIdx - minIdx + 1;
+            }
+        }
+
+        return found;
+    }
+
+    [Benchmark]
+    public int BinarySearch()
+    {
+        var found = 0;
+        foreach (var query in this._queries)
+        {
+            if (this._session!.DataCache.TryFindSymIndicesInRVARange(query, out _, out var minIdx, out var maxIdx))
+            {
+                found += maxIdx - minIdx + 1;
+            }
+        }
+
+        return found;
+    }
+
+    private static bool LinearWalkFind(List<(uint rva, List<uint> symIndices)> all, RVARange range, out int minIdx, out int maxIdx)
+    {
+        minIdx = maxIdx = 0;
+        if (all.Count == 0 || all[0].rva > range.RVAEnd)
+        {
+            return false;
+        }
+
+        var minIdxFound = false;
+        maxIdx = all.Count - 1;
+        for (var i = 0; i < all.Count; i++)
+        {
+            if (!minIdxFound && range.Contains(all[i].rva))
+            {
+                minIdx = i;
+                minIdxFound = true;
+            }
+
+            if (all[i].rva > range.RVAEnd)
+            {
+                maxIdx = i - 1;
+                break;
+            }
+        }
+
+        return minIdxFound && (minIdx != maxIdx || range.Contains(all[minIdx].rva));
+    }
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    protected virtual void Dispose(bool disposing)
+    {
+        if (!this._isDisposed)
+        {
+            if (disposing)
+            {
+                this._session?.DisposeAsync().AsTask().GetAwaiter().GetResult();
+                this._logger?.Dispose();
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    public void Dispose()
+    {
+        Dispose(true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
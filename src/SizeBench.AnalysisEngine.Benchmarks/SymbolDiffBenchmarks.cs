@@ -0,0 +1,125 @@
+﻿using BenchmarkDotNet.Attributes;
+using SizeBench.AnalysisEngine.DiffSessionTasks;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.Benchmarks;
+
+// Measures matching up every symbol in the CppTestCasesBefore/After binaries into SymbolDiffs, which is what a user does by opening the
+// symbols of every section in a diff.  The ListScan baseline is the algorithm this used before matching was done by name first - a scan of
+// every remaining 'after' symbol for each 'before' symbol - run over identical data so the two are directly comparable.
+//
+// The test binaries are small, so Copies repeats each side's symbols to approximate a binary many times larger.  Repeated symbols share a
+// name, which is the worst case for matching by name, so this errs on the side of understating the improvement.
+[MemoryDiagnoser]
+public class SymbolDiffBenchmarks : IDisposable
+{
+    private NoOpLogger? _logger;
+    private DiffSession? _diffSession;
+    private List<ISymbol> _beforeSymbols = [];
+    private List<ISymbol> _afterSymbols = [];
+
+    [Params(1, 8)]
+    public int Copies { get; set; }
+
+    [GlobalSetup]
+    public async Task GlobalSetup()
+    {
+        this._logger = new NoOpLogger();
+        this._diffSession = await DiffSession.Create(TestPEs.CppTestCasesBeforeBinaryPath, TestPEs.CppTestCasesBeforePDBPath,
+                                                     TestPEs.CppTestCasesAfterBinaryPath, TestPEs.CppTestCasesAfterPDBPath,
+                                                     this._logger);
+
+        var beforeSymbols = new List<ISymbol>();
+        foreach (var section in await this._diffSession.BeforeSession.EnumerateBinarySectionsAndCOFFGroups(CancellationToken.None))
+        {
+            beforeSymbols.AddRange(await this._diffSession.BeforeSession.EnumerateSymbolsInBinarySection(section, CancellationToken.None));
+        }
+
+        var afterSymbols = new List<ISymbol>();
+        foreach (var section in await this._diffSession.AfterSession.EnumerateBinarySectionsAndCOFFGroups(CancellationToken.None))
+        {
+            afterSymbols.AddRange(await this._diffSession.AfterSession.EnumerateSymbolsInBinarySection(section, CancellationToken.None));
+        }
+
+        this._beforeSymbols = Enumerable.Repeat(beforeSymbols, this.Copies).SelectMany(symbols => symbols).ToList();
+        this._afterSymbols = Enumerable.Repeat(afterSymbols, this.Copies).SelectMany(symbols => symbols).ToList();
+    }
+
+    [GlobalCleanup]
+    public void GlobalCleanup() => Dispose();
+
+    [Benchmark(Baseline = true)]
+    public int ListScan()
+    {
+        // Each run gets a fresh cache so neither benchmark gets to reuse SymbolDiffs from an earlier run.
+        using var dataCache = new DiffSessionDataCache();
+        var symbolDiffs = new List<SymbolDiff>();
+        var afterSymbols = this._afterSymbols.ToList();
+        var groupedAfterSymbols = afterSymbols.GroupBy(sym => sym.SymbolComparisonClass);
+
+        foreach (var beforeSymbolTypeGroup in this._beforeSymbols.GroupBy(sym => sym.SymbolComparisonClass))
+        {
+            var afterGroup = groupedAfterSymbols.FirstOrDefault(group => group.Key == beforeSymbolTypeGroup.Key);
+            var afterSymbolsOfThisType = afterGroup?.ToList() ?? new List<ISymbol>();
+            foreach (var beforeSymbol in beforeSymbolTypeGroup)
+            {
+                var matchingAfterSymbol = afterSymbolsOfThisType.FirstOrDefault(beforeSymbol.IsVeryLikelyTheSameAs);
+                if (matchingAfterSymbol != null)
+                {
+                    afterSymbolsOfThisType.Remove(matchingAfterSymbol);
+                    afterSymbols.Remove(matchingAfterSymbol);
+                }
+
+                symbolDiffs.Add(SymbolDiffFactory.CreateSymbolDiff(beforeSymbol, matchingAfterSymbol, dataCache));
+            }
+        }
+
+        foreach (var afterSymbol in afterSymbols)
+        {
+            symbolDiffs.Add(SymbolDiffFactory.CreateSymbolDiff(null, afterSymbol, dataCache));
+        }
+
+        return symbolDiffs.Count;
+    }
+
+    [Benchmark]
+    public async Task<int> MatchByName()
+    {
+        using var dataCache = new DiffSessionDataCache();
+        var task = new EnumerateSymbolDiffsBetweenTwoSymbolListsSessionTask(new DiffSessionTaskParameters(this._diffSession!, dataCache),
+                                                                            _ => Task.FromResult<IReadOnlyList<ISymbol>?>(this._beforeSymbols),
+                                                                            _ => Task.FromResult<IReadOnlyList<ISymbol>?>(this._afterSymbols),
+                                                                            nameOfThingBeingEnumerated: "all sections",
+                                                                            progress: null,
+                                                                            token: CancellationToken.None);
+        var symbolDiffs = await task.ExecuteAsync(this._logger!);
+        return symbolDiffs.Count;
+    }
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    protected virtual void Dispose(bool disposing)
+    {
+        if (!this._isDisposed)
+        {
+            if (disposing)
+            {
+                this._diffSession?.DisposeAsync().AsTask().GetAwaiter().GetResult();
+                this._logger?.Dispose();
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    public void Dispose()
+    {
+        Dispose(true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
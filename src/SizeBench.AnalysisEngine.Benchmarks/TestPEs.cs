@@ -0,0 +1,31 @@
+﻿using System.IO;
+
+namespace SizeBench.AnalysisEngine.Benchmarks;
+
+// The benchmarks run against the same binaries the RealPETests use, which get copied next to the benchmark executable.
+internal static class TestPEs
+{
+    private static string MakePath(string filename) => Path.Combine(AppContext.BaseDirectory, "Test PEs", filename);
+
+    // The largest binary in TestPEs, so it's the best stand-in we have for the big binaries where lookup costs matter.
+    public static string LargestBinaryPath => MakePath(Path.Combine("External", "x64", "ReactNativeXaml.dll"));
+    public static string LargestPDBPath => MakePath(Path.Combine("External", "x64", "ReactNativeXaml.pdb"));
+
+    // The pair of binaries the RealPETests use for diffing, built from the same sources with a few changes between them.
+    public static string CppTestCasesBeforeBinaryPath => MakePath("SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore.dll");
+    public static string CppTestCasesBeforePDBPath => MakePath("SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore.pdb");
+    public static string CppTestCasesAfterBinaryPath => MakePath("SizeBenchV2.AnalysisEngine.Tests.CppTestCasesAfter.dll");
+    public static string CppTestCasesAfterPDBPath => MakePath("SizeBenchV2.AnalysisEngine.Tests.CppTestCasesAfter.pdb");
+
+    // The binaries the end-to-end scenario benchmarks are run against - a small one, a medium one, and the largest one, so a regression
+    // that only shows up at scale can be told apart from one that costs the same everywhere.  Each is the name of a .dll/.pdb pair.
+    public static IEnumerable<string> ScenarioBinaries =>
+    [
+        "SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore",
+        "PEParser.Tests.Dllx64",
+        Path.Combine("External", "x64", "ReactNativeXaml"),
+    ];
+
+    public static string BinaryPathFor(string scenarioBinary) => MakePath(scenarioBinary + ".dll");
+    public static string PDBPathFor(string scenarioBinary) => MakePath(scenarioBinary + ".pdb");
+}
@@ -0,0 +1,94 @@
+﻿using System.IO;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.RealPETests.Single_Binary;
+
+// Splitting work across the DIA worker pool should never change the answer, only how long it takes to get it.
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore.dll")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore.pdb")]
+[TestClass]
+public sealed class DIAWorkerPoolTests
+{
+    public TestContext? TestContext { get; set; }
+
+    private string BinaryPath => MakePath("SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore.dll");
+
+    private string PDBPath => MakePath("SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore.pdb");
+
+    public string MakePath(string binary) => Path.Combine(this.TestContext!.DeploymentDirectory!, binary);
+
+    [TestMethod]
+    [DataRow(1)]
+    [DataRow(3)]
+    public async Task LabelsFoundOnWorkersMatchLabelsFoundSerially(int workerCount)
+    {
+        using var logger = new NoOpLogger();
+        await using var serialSession = await Session.Create(this.BinaryPath, this.PDBPath, logger);
+        await using var pooledSession = await Session.Create(this.BinaryPath, this.PDBPath, new SessionOptions() { DIAWorkerCount = workerCount }, logger);
+
+        Assert.IsNull(serialSession.DIAWorkerPool);
+        Assert.IsNotNull(pooledSession.DIAWorkerPool);
+
+        // This binary has MASM code in it, so there are labels to be found.
+        Assert.IsNotEmpty(serialSession.DataCache.RVAsOfLabelSymbols);
+        CollectionAssert.AreEquivalent(serialSession.DataCache.RVAsOfLabelSymbols.ToList(), pooledSession.DataCache.RVAsOfLabelSymbols.ToList());
+    }
+
+    [TestMethod]
+    [DataRow(1)]
+    [DataRow(3)]
+    public async Task DuplicateDataFoundWithWorkersMatchesDuplicateDataFoundSerially(int workerCount)
+    {
+        using var logger = new NoOpLogger();
+        await using var serialSession = await Session.Create(this.BinaryPath, this.PDBPath, logger);
+        await using var pooledSession = await Session.Create(this.BinaryPath, this.PDBPath, new SessionOptions() { DIAWorkerCount = workerCount }, logger);
+
+        static string Describe(DuplicateDataItem dupe)
+            => $"{dupe.Symbol.Name} ({dupe.Symbol.Size}) wastes {dupe.WastedSize} at {String.Join(",", dupe.RVAs)} in {String.Join(",", dupe.ReferencedIn.Select(c => c.ShortName))}";
+
+        var serialDuplicates = (await serialSession.EnumerateDuplicateDataItems(CancellationToken.None)).Select(Describe).ToList();
+        var pooledDuplicates = (await pooledSession.EnumerateDuplicateDataItems(CancellationToken.None)).Select(Describe).ToList();
+
+        Assert.IsNotEmpty(serialDuplicates);
+        CollectionAssert.AreEqual(serialDuplicates, pooledDuplicates);
+    }
+
+    [TestMethod]
+    [DataRow(1)]
+    [DataRow(3)]
+    public async Task WastefulVirtualsFoundWithWorkersMatchWastefulVirtualsFoundSerially(int workerCount)
+    {
+        using var logger = new NoOpLogger();
+        await using var serialSession = await Session.Create(this.BinaryPath, this.PDBPath, logger);
+        await using var pooledSession = await Session.Create(this.BinaryPath, this.PDBPath, new SessionOptions() { DIAWorkerCount = workerCount }, logger);
+
+        static string Describe(WastefulVirtualItem wvi)
+            => $"{wvi.UserDefinedType.Name} wastes {wvi.WastedSize} in {String.Join(",", wvi.WastedOverridesPureWithExactlyOneOverride.Select(f => f.FullName))} " +
+               $"and {String.Join(",", wvi.WastedOverridesNonPureWithNoOverrides.Select(f => f.FullName))}";
+
+        var serialWastefulVirtuals = (await serialSession.EnumerateWastefulVirtuals(CancellationToken.None)).Select(Describe).ToList();
+        var pooledWastefulVirtuals = (await pooledSession.EnumerateWastefulVirtuals(CancellationToken.None)).Select(Describe).ToList();
+
+        Assert.IsNotEmpty(serialWastefulVirtuals);
+        CollectionAssert.AreEqual(serialWastefulVirtuals, pooledWastefulVirtuals);
+    }
+
+    [TestMethod]
+    public void RunPartitionedReturnsResultsInPartitionOrder()
+    {
+        using var pool = new DIAInterop.DIAWorkerPool(this.PDBPath, workerCount: 2);
+
+        var results = pool.RunPartitioned(10, (diaSession, partition, _) => (partition, diaSession.globalScope.name), CancellationToken.None);
+
+        CollectionAssert.AreEqual(Enumerable.Range(0, 10).ToArray(), results.Select(r => r.partition).ToArray());
+        Assert.HasCount(1, results.Select(r => r.name).Distinct());
+    }
+
+    [TestMethod]
+    public void RunPartitionedRethrowsTheWorkersException()
+    {
+        using var pool = new DIAInterop.DIAWorkerPool(this.PDBPath, workerCount: 2);
+
+        Assert.ThrowsExactly<InvalidOperationException>(() => pool.RunPartitioned<int>(4, (_, partition, _) => partition == 2 ? throw new InvalidOperationException() : partition, CancellationToken.None));
+    }
+}
@@ -1,4 +1,5 @@
 ﻿using System.IO;
+using System.Text.RegularExpressions;
 using Nito.AsyncEx;
 using SizeBench.AnalysisEngine.Symbols;
 using SizeBench.Logging;
@@ -16,6 +17,9 @@ namespace SizeBench.AnalysisEngine.Tests;
 [STATestClass]
 public sealed class DisassembleFunctionTests
 {
+    // Module!Name (address), where Name can have its own parentheses, like "operator()+0x13f".
+    private static readonly Regex SymbolizedTargetRegex = new Regex(@"(?<name>\w+!.+?) \((?<address>[0-9a-f]+)\)", RegexOptions.CultureInvariant);
+
     public TestContext? TestContext { get; set; }
 
     private string MakePath(string binary) => Path.Combine(this.TestContext!.DeploymentDirectory!, binary);
@@ -62,6 +66,136 @@ public sealed class DisassembleFunctionTests
         });
     }
 
+    [Timeout(90 * 1000, CooperativeCancellation = true)]
+    [STATestMethod]
+    public void ReactNativeXamlNoReturnFunctionDisassemblesCorrectlyWithManagedDisassembler()
+    {
+        AsyncContext.Run(async () =>
+        {
+            using var logger = new NoOpLogger();
+            await using var session = await Session.Create(MakePath("ReactNativeXaml.dll"), MakePath("ReactNativeXaml.pdb"), ManagedDisassemblerSessionOptions, logger);
+            var lambda1071Function = await FindFunctionInText(session, "EventInfo::<lambda_1071>::operator()");
+
+            var disassembly = await session.DisassembleFunction(lambda1071Function, new DisassembleFunctionOptions(), this.CancellationToken);
+            VerifyManagedDisassembly(disassembly, @"EventInfo_lambda1071_operator()_Disassembly.txt", lambda1071Function);
+        });
+    }
+
+    [Timeout(30 * 1000, CooperativeCancellation = true)]
+    [STATestMethod]
+    public void VeryLongBasicBlockDisassemblesCorrectlyWithManagedDisassembler()
+    {
+        AsyncContext.Run(async () =>
+        {
+            using var logger = new NoOpLogger();
+            await using var session = await Session.Create(MakePath("SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore.dll"), MakePath("SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore.pdb"), ManagedDisassemblerSessionOptions, logger);
+            var asmVeryLongBasicBlockFunction = await FindFunctionInText(session, "asmVeryLongBasicBlock");
+
+            var disassembly = await session.DisassembleFunction(asmVeryLongBasicBlockFunction, new DisassembleFunctionOptions(), this.CancellationToken);
+            VerifyManagedDisassembly(disassembly, @"asmVeryLongBasicBlock_Disassembly.txt", asmVeryLongBasicBlockFunction);
+        });
+    }
+
+    [Timeout(90 * 1000, CooperativeCancellation = true)]
+    [STATestMethod]
+    public void ManagedDisassemblerStripsAbsoluteAddressOnlyForFunctionLocalReferences()
+    {
+        AsyncContext.Run(async () =>
+        {
+            using var logger = new NoOpLogger();
+            await using var session = await Session.Create(MakePath("ReactNativeXaml.dll"), MakePath("ReactNativeXaml.pdb"), ManagedDisassemblerSessionOptions, logger);
+            var lambda1071Function = await FindFunctionInText(session, "EventInfo::<lambda_1071>::operator()");
+
+            var options = new DisassembleFunctionOptions() { StripAbsoluteAddressForFunctionLocalReferences = true };
+            var lines = SplitLines(await session.DisassembleFunction(lambda1071Function, options, this.CancellationToken));
+
+            Assert.Contains("je          ReactNativeXaml!EventInfo::<lambda_1071>::operator()+0x13f", lines);
+            Assert.Contains("je          ReactNativeXaml!EventInfo::<lambda_1071>::operator()+0x58", lines);
+            Assert.Contains("call        ReactNativeXaml!DoTheTypeChecking<winrt::Windows::UI::Xaml::UIElement> (18004c4d0)", lines);
+            Assert.Contains("call        ReactNativeXaml!__security_check_cookie (1800c83a0)", lines);
+        });
+    }
+
+    [Timeout(90 * 1000, CooperativeCancellation = true)]
+    [STATestMethod]
+    public void ManagedDisassemblerReplacesFunctionNameInLocalReferencesAndFunctionsThatShareAnRVA()
+    {
+        AsyncContext.Run(async () =>
+        {
+            using var logger = new NoOpLogger();
+            await using var session = await Session.Create(MakePath("ReactNativeXaml.dll"), MakePath("ReactNativeXaml.pdb"), ManagedDisassemblerSessionOptions, logger);
+            var lambda1071Function = await FindFunctionInText(session, "EventInfo::<lambda_1071>::operator()");
+
+            // Standing in for a function COMDAT-folded with the one being disassembled - a call to it should get the replacement name too.
+            var doTheTypeCheckingFunction = await session.LoadSymbolByRVA(0x4c4d0, this.CancellationToken, logger) as IFunctionCodeSymbol;
+            Assert.IsNotNull(doTheTypeCheckingFunction);
+
+            var options = new DisassembleFunctionOptions() { ReplaceFunctionNameWith = "---" };
+            options.FunctionsThatShareAnRVAWithDisassembledFunction.Add(doTheTypeCheckingFunction);
+            var lines = SplitLines(await session.DisassembleFunction(lambda1071Function, options, this.CancellationToken));
+
+            Assert.Contains("je          ReactNativeXaml!---+0x13f (18002d43f)", lines);
+            Assert.Contains("call        ReactNativeXaml!--- (18004c4d0)", lines);
+            Assert.Contains("call        ReactNativeXaml!__security_check_cookie (1800c83a0)", lines);
+            Assert.IsFalse(lines.Any(line => line.Contains("lambda_1071", StringComparison.Ordinal) || line.Contains("DoTheTypeChecking", StringComparison.Ordinal)));
+        });
+    }
+
+    private static SessionOptions ManagedDisassemblerSessionOptions => new SessionOptions() { Disassembler = Disassembler.Managed };
+
+    private async Task<SimpleFunctionCodeSymbol> FindFunctionInText(Session session, string name)
+    {
+        var sections = await session.EnumerateBinarySectionsAndCOFFGroups(this.CancellationToken);
+        var symbolsInText = await session.EnumerateSymbolsInBinarySection(sections.Single(s => s.Name == ".text"), this.CancellationToken);
+        return symbolsInText.OfType<SimpleFunctionCodeSymbol>().Single(s => s.FormattedName.IncludeParentType == name);
+    }
+
+    // The managed disassembler doesn't print the source file and line headers between blocks, and doesn't know which registers hold which
+    // locals and parameters, so it can't print them the way the debugger does ("mov rsi,reactContext (r8)").  The debugger also names data
+    // by the member or element at the address ("guid_v<...>{.Data1}") where the managed disassembler just has the symbol, and when several
+    // functions are COMDAT-folded together the two can pick different ones to name a call after.  So against the debugger's output, each
+    // instruction's mnemonic has to match, everything it refers to has to be symbolized at the same address, and every function-local label
+    // has to have the same name and offset into this function.
+    private void VerifyManagedDisassembly(string disassembly, string filenameOfExpectedOutput, IFunctionCodeSymbol function)
+    {
+        var localLabelPrefix = $"!{function.FormattedName.IncludeParentType}";
+        var expectedLines = SplitLines(File.ReadAllText(MakePath(filenameOfExpectedOutput))).Where(line => !IsSourceLineHeader(line)).ToArray();
+        var actualLines = SplitLines(disassembly);
+
+        Assert.HasCount(expectedLines.Length, actualLines);
+
+        for (var i = 0; i < expectedLines.Length; i++)
+        {
+            var expectedMnemonic = expectedLines[i].Split(' ')[0];
+            var message = $"Line {i} of the disassembly differed.  Expected: '{expectedLines[i]}', Actual: '{actualLines[i]}'";
+            Assert.AreEqual(expectedMnemonic, actualLines[i].Split(' ')[0], message);
+
+            var expectedTargets = SymbolizedTargetRegex.Matches(expectedLines[i]);
+            var actualTargets = SymbolizedTargetRegex.Matches(actualLines[i]);
+            CollectionAssert.AreEqual(expectedTargets.Select(target => target.Groups["address"].Value).ToArray(),
+                                      actualTargets.Select(target => target.Groups["address"].Value).ToArray(), message);
+
+            for (var targetIndex = 0; targetIndex < expectedTargets.Count; targetIndex++)
+            {
+                var expectedName = expectedTargets[targetIndex].Groups["name"].Value;
+                if (expectedName.EndsWith(localLabelPrefix, StringComparison.Ordinal) || expectedName.Contains(localLabelPrefix + "+0x", StringComparison.Ordinal))
+                {
+                    Assert.AreEqual(expectedName, actualTargets[targetIndex].Groups["name"].Value, message);
+                }
+            }
+        }
+    }
+
+    private static bool IsSourceLineHeader(string line)
+        => line.EndsWith("]:", StringComparison.Ordinal) && line.Contains(" @ ", StringComparison.Ordinal);
+
+    private static string[] SplitLines(string text)
+        => text.Trim()
+               .Replace("\r\n", "\r", StringComparison.OrdinalIgnoreCase)
+               .Replace("\n\r", "\r", StringComparison.OrdinalIgnoreCase)
+               .Replace("\n", "\r", StringComparison.OrdinalIgnoreCase)
+               .Split('\r', StringSplitOptions.RemoveEmptyEntries | StringSplitOptions.TrimEntries);
+
     private void VerifyDisassembly(string disassembly, string filenameOfExpectedOutput)
     {
         var expectedLines = File.ReadAllText(MakePath(filenameOfExpectedOutput))
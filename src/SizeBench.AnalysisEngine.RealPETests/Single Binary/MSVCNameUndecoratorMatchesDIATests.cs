@@ -0,0 +1,110 @@
+﻿using System.IO;
+using System.Runtime.InteropServices;
+using Dia2Lib;
+using SizeBench.AnalysisEngine.DIAInterop;
+
+namespace SizeBench.AnalysisEngine.RealPETests.Single_Binary;
+
+// MSVCNameUndecorator stands in for DIA's undecorator, so wherever it gives an answer at all that has to be exactly what DIA says - for the
+// default flags (undecoratedName, as used for public symbols) and for the flags used to name thunks (get_undecoratedNameEx).  Returning null
+// is always allowed, since callers fall back to DIA or the decorated name then.
+[DeploymentItem(@"Test PEs\CppTestCases_BasicDiffObjectsAfter.pdb")]
+[DeploymentItem(@"Test PEs\CppTestCases_BasicDiffObjectsBefore.pdb")]
+[DeploymentItem(@"Test PEs\FortranDll.pdb")]
+[DeploymentItem(@"Test PEs\PEParser.Tests.DllCxxFrameHandler4.pdb")]
+[DeploymentItem(@"Test PEs\PEParser.Tests.Dllarm32.pdb")]
+[DeploymentItem(@"Test PEs\PEParser.Tests.Dllx64.pdb")]
+[DeploymentItem(@"Test PEs\PEParser.Tests.Dllx86.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.ClangClx64.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.CodePageWin32Rsrc.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.Cpp17.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.Cpp32BitDll.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.CppDll.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.CppTestCasesAfter.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.CppWinRT.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.Dllx64CustomAlign.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.ForceIntegrityBit.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.InlineSites.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.Zig.pdb")]
+[DeploymentItem(@"Test PEs\sizebenchv2_analysisengine_tests_rust.pdb")]
+[TestClass]
+public sealed class MSVCNameUndecoratorMatchesDIATests
+{
+    public TestContext? TestContext { get; set; }
+
+    private string MakePath(string filename) => Path.Combine(this.TestContext!.DeploymentDirectory!, filename);
+
+    [TestMethod]
+    [DataRow("CppTestCases_BasicDiffObjectsAfter")]
+    [DataRow("CppTestCases_BasicDiffObjectsBefore")]
+    [DataRow("FortranDll")]
+    [DataRow("PEParser.Tests.DllCxxFrameHandler4")]
+    [DataRow("PEParser.Tests.Dllarm32")]
+    [DataRow("PEParser.Tests.Dllx64")]
+    [DataRow("PEParser.Tests.Dllx86")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.ClangClx64")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.CodePageWin32Rsrc")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.Cpp17")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.Cpp32BitDll")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.CppDll")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.CppTestCasesAfter")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.CppWinRT")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.Dllx64CustomAlign")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.ForceIntegrityBit")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.InlineSites")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.Zig")]
+    [DataRow("sizebenchv2_analysisengine_tests_rust")]
+    public void UndecoratedPublicSymbolNamesMatchDIA(string pdbName)
+    {
+        using var pool = new DIAWorkerPool(MakePath($"{pdbName}.pdb"), workerCount: 1);
+        var (publicSymbolCount, undecoratedCount, mismatches) = pool.RunPartitioned(1, (diaSession, _, _) => CompareWithDIA(diaSession), CancellationToken.None)[0];
+
+        Assert.IsGreaterThan(0, publicSymbolCount);
+        Assert.IsEmpty(mismatches, $"{mismatches.Count} of {undecoratedCount} undecorated names differ from DIA:{Environment.NewLine}{String.Join(Environment.NewLine, mismatches.Take(20))}");
+    }
+
+    private static (int publicSymbolCount, int undecoratedCount, List<string> mismatches) CompareWithDIA(IDiaSession diaSession)
+    {
+        var publicSymbolCount = 0;
+        var undecoratedCount = 0;
+        var mismatches = new List<string>();
+
+        diaSession.findChildren(diaSession.globalScope, SymTagEnum.SymTagPublicSymbol, name: null, compareFlags: 0, ppResult: out var diaEnum);
+        foreach (IDiaSymbol? publicSymbol in diaEnum)
+        {
+            if (publicSymbol is null)
+            {
+                continue;
+            }
+
+            publicSymbolCount++;
+            var decoratedName = publicSymbol.name;
+
+            var undecorated = MSVCNameUndecorator.Undecorate(decoratedName);
+            if (undecorated is not null)
+            {
+                undecoratedCount++;
+                if (undecorated != publicSymbol.undecoratedName)
+                {
+                    mismatches.Add($"{decoratedName}: ours=\"{undecorated}\", DIA=\"{publicSymbol.undecoratedName}\"");
+                }
+            }
+
+            var undecoratedForThunk = MSVCNameUndecorator.Undecorate(decoratedName, DIAAdapter.ThunkNameUndecorationFlags);
+            if (undecoratedForThunk is not null)
+            {
+                publicSymbol.get_undecoratedNameEx((uint)DIAAdapter.ThunkNameUndecorationFlags, out var diaUndecoratedForThunk);
+                if (undecoratedForThunk != diaUndecoratedForThunk)
+                {
+                    mismatches.Add($"{decoratedName} (thunk flags): ours=\"{undecoratedForThunk}\", DIA=\"{diaUndecoratedForThunk}\"");
+                }
+            }
+        }
+
+        Marshal.FinalReleaseComObject(diaEnum);
+
+        return (publicSymbolCount, undecoratedCount, mismatches);
+    }
+}
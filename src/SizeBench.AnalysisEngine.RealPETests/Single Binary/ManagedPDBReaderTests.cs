@@ -0,0 +1,103 @@
+﻿using System.IO;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.Tests;
+
+// The managed PDB reader should agree with DIA on everything it supports - these tests open the same binary both ways and compare.
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.CppDll.dll")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.CppDll.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.Cpp32BitDll.dll")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.Cpp32BitDll.pdb")]
+[TestClass]
+public sealed class ManagedPDBReaderTests
+{
+    public TestContext? TestContext { get; set; }
+    private string MakePath(string filename) => Path.Combine(this.TestContext!.DeploymentDirectory!, filename);
+
+    private static readonly SessionOptions ManagedReaderOptions = new SessionOptions() { PDBReader = PDBReader.Managed };
+
+    [TestMethod]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.CppDll")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.Cpp32BitDll")]
+    public async Task SectionsAndCOFFGroupsMatchDIA(string binaryName)
+    {
+        using var logger = new NoOpLogger();
+        await using var diaSession = await Session.Create(MakePath($"{binaryName}.dll"), MakePath($"{binaryName}.pdb"), logger);
+        await using var managedSession = await Session.Create(MakePath($"{binaryName}.dll"), MakePath($"{binaryName}.pdb"), ManagedReaderOptions, logger);
+
+        var diaSections = await diaSession.EnumerateBinarySectionsAndCOFFGroups(CancellationToken.None);
+        var managedSections = await managedSession.EnumerateBinarySectionsAndCOFFGroups(CancellationToken.None);
+
+        Assert.HasCount(diaSections.Count, managedSections);
+        for (var i = 0; i < diaSections.Count; i++)
+        {
+            Assert.AreEqual(diaSections[i].Name, managedSections[i].Name);
+            Assert.AreEqual(diaSections[i].RVA, managedSections[i].RVA);
+            Assert.AreEqual(diaSections[i].Size, managedSections[i].Size);
+            Assert.AreEqual(diaSections[i].VirtualSize, managedSections[i].VirtualSize);
+
+            var diaCOFFGroups = diaSections[i].COFFGroups;
+            var managedCOFFGroups = managedSections[i].COFFGroups;
+            Assert.HasCount(diaCOFFGroups.Count, managedCOFFGroups);
+            for (var j = 0; j < diaCOFFGroups.Count; j++)
+            {
+                Assert.AreEqual(diaCOFFGroups[j].Name, managedCOFFGroups[j].Name);
+                Assert.AreEqual(diaCOFFGroups[j].RVA, managedCOFFGroups[j].RVA);
+                Assert.AreEqual(diaCOFFGroups[j].Size, managedCOFFGroups[j].Size);
+                Assert.AreEqual(diaCOFFGroups[j].VirtualSize, managedCOFFGroups[j].VirtualSize);
+            }
+        }
+    }
+
+    [TestMethod]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.CppDll")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.Cpp32BitDll")]
+    public async Task LibsAndCompilandsMatchDIA(string binaryName)
+    {
+        using var logger = new NoOpLogger();
+        await using var diaSession = await Session.Create(MakePath($"{binaryName}.dll"), MakePath($"{binaryName}.pdb"), logger);
+        await using var managedSession = await Session.Create(MakePath($"{binaryName}.dll"), MakePath($"{binaryName}.pdb"), ManagedReaderOptions, logger);
+
+        var diaLibs = (await diaSession.EnumerateLibs(CancellationToken.None)).ToDictionary(l => l.Name, StringComparer.OrdinalIgnoreCase);
+        var managedLibs = (await managedSession.EnumerateLibs(CancellationToken.None)).ToDictionary(l => l.Name, StringComparer.OrdinalIgnoreCase);
+
+        Assert.HasCount(diaLibs.Count, managedLibs);
+        foreach (var diaLib in diaLibs.Values)
+        {
+            var managedLib = managedLibs[diaLib.Name];
+            Assert.AreEqual(diaLib.Size, managedLib.Size, $"Size of {diaLib.Name}");
+            Assert.AreEqual(diaLib.VirtualSize, managedLib.VirtualSize, $"VirtualSize of {diaLib.Name}");
+            Assert.HasCount(diaLib.Compilands.Count, managedLib.Compilands);
+
+            foreach (var diaCompiland in diaLib.Compilands.Values)
+            {
+                var managedCompiland = managedLib.Compilands[diaCompiland.Name];
+                Assert.AreEqual(diaCompiland.Size, managedCompiland.Size, $"Size of {diaCompiland.Name}");
+                Assert.AreEqual(diaCompiland.CommandLine, managedCompiland.CommandLine);
+                Assert.AreEqual(diaCompiland.ToolName, managedCompiland.ToolName);
+                Assert.AreEqual(diaCompiland.ToolLanguage, managedCompiland.ToolLanguage);
+            }
+        }
+    }
+
+    [TestMethod]
+    public async Task FunctionSymbolsCanBeFoundByRVA()
+    {
+        using var logger = new NoOpLogger();
+        var binaryPath = MakePath("SizeBenchV2.AnalysisEngine.Tests.CppDll.dll");
+        var pdbPath = MakePath("SizeBenchV2.AnalysisEngine.Tests.CppDll.pdb");
+        await using var diaSession = await Session.Create(binaryPath, pdbPath, logger);
+        await using var managedSession = await Session.Create(binaryPath, pdbPath, ManagedReaderOptions, logger);
+
+        var textSection = (await managedSession.EnumerateBinarySectionsAndCOFFGroups(CancellationToken.None)).First(s => s.Name == ".text");
+        var managedSymbols = await managedSession.EnumerateSymbolsInBinarySection(textSection, CancellationToken.None);
+        Assert.IsNotEmpty(managedSymbols);
+
+        foreach (var managedSymbol in managedSymbols.OfType<Symbols.CodeBlockSymbol>())
+        {
+            var diaSymbol = await diaSession.LoadSymbolByRVA(managedSymbol.RVA);
+            Assert.IsNotNull(diaSymbol, $"DIA could not find a symbol at 0x{managedSymbol.RVA:X}, where the managed reader found {managedSymbol.Name}");
+            Assert.AreEqual(diaSymbol.Size, managedSymbol.Size, $"Size of {managedSymbol.Name}");
+        }
+    }
+}
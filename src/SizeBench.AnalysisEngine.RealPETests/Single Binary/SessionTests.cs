@@ -1,4 +1,5 @@
 ﻿using System.IO;
+using SizeBench.AnalysisEngine.PE;
 using SizeBench.Logging;
 
 namespace SizeBench.AnalysisEngine.Tests;
@@ -49,4 +50,16 @@ public class SessionTests
 
         Assert.Contains("E_PDB_FORMAT", ex.Message, StringComparison.Ordinal);
     }
+
+    [TestMethod]
+    public async Task DebugSignatureReadWithoutASessionMatchesTheSession()
+    {
+        using var logger = new NoOpLogger();
+        await using var session = await Session.Create(this.CppDllBinaryPath, this.CppDllPDBPath, logger);
+
+        var signature = PEFileDebugSignature.ReadFromBinary(this.CppDllBinaryPath);
+        Assert.AreNotEqual(Guid.Empty, signature.PdbGuid);
+        Assert.AreEqual(session.PEFile.DebugSignature, signature);
+        Assert.AreNotEqual(signature, PEFileDebugSignature.ReadFromBinary(this.Cpp32BitDllBinaryPath));
+    }
 }
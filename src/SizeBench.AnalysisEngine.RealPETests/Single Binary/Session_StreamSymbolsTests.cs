@@ -0,0 +1,89 @@
+﻿using System.IO;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.Tests;
+
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore.dll")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore.pdb")]
+[TestClass]
+public sealed class Session_StreamSymbolsTests
+{
+    public TestContext? TestContext { get; set; }
+    private CancellationToken CancellationToken => this.TestContext!.CancellationToken;
+    private string MakePath(string filename) => Path.Combine(this.TestContext!.DeploymentDirectory!, filename);
+
+    private string BinaryPath => MakePath("SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore.dll");
+
+    private string PDBPath => MakePath("SizeBenchV2.AnalysisEngine.Tests.CppTestCasesBefore.pdb");
+
+    [TestMethod]
+    public async Task StreamingEachBinarySectionFindsTheSameSymbolsAsEnumerating()
+    {
+        using var logger = new NoOpLogger();
+        await using var session = await Session.Create(this.BinaryPath, this.PDBPath, logger);
+        var sections = await session.EnumerateBinarySectionsAndCOFFGroups(this.CancellationToken);
+
+        foreach (var section in sections)
+        {
+            var symbols = await session.EnumerateSymbolsInBinarySection(section, this.CancellationToken);
+            var streamedSymbols = await StreamToList(session.StreamSymbolsInBinarySection(section, this.CancellationToken));
+
+            CollectionAssert.AreEqual(symbols.Select(s => (s.RVA, s.Name)).ToList(), streamedSymbols.Select(s => (s.RVA, s.Name)).ToList(), $"Section {section.Name}");
+        }
+    }
+
+    [TestMethod]
+    public async Task StreamingEachCompilandFindsTheSameSymbolsAsEnumerating()
+    {
+        using var logger = new NoOpLogger();
+        await using var session = await Session.Create(this.BinaryPath, this.PDBPath, logger);
+        var compilands = await session.EnumerateCompilands(this.CancellationToken);
+
+        foreach (var compiland in compilands)
+        {
+            var symbols = await session.EnumerateSymbolsInCompiland(compiland, this.CancellationToken);
+            var streamedSymbols = await StreamToList(session.StreamSymbolsInCompiland(compiland, this.CancellationToken));
+
+            CollectionAssert.AreEqual(symbols.Select(s => (s.RVA, s.Name)).ToList(), streamedSymbols.Select(s => (s.RVA, s.Name)).ToList(), $"Compiland {compiland.Name}");
+        }
+    }
+
+    [TestMethod]
+    public async Task SessionCanBeUsedWhileStreamingAndAfterStoppingEarly()
+    {
+        using var logger = new NoOpLogger();
+        await using var session = await Session.Create(this.BinaryPath, this.PDBPath, logger);
+        var textSection = (await session.LoadBinarySectionByName(".text", this.CancellationToken))!;
+        Assert.IsNotNull(textSection);
+
+        // The DIA thread is only busy while a batch is being found, so calling back into the session from the middle of a stream must not deadlock.
+        var symbolsSeen = 0;
+        await foreach (var symbol in session.StreamSymbolsInBinarySection(textSection, this.CancellationToken))
+        {
+            var placement = await session.LookupSymbolPlacementInBinary(symbol, this.CancellationToken);
+            Assert.AreEqual(textSection, placement.BinarySection);
+
+            if (++symbolsSeen == 5)
+            {
+                break;
+            }
+        }
+
+        Assert.AreEqual(5, symbolsSeen);
+
+        // And abandoning that stream part-way through must leave the session usable.
+        var libs = await session.EnumerateLibs(this.CancellationToken);
+        Assert.IsNotEmpty(libs);
+    }
+
+    private static async Task<List<ISymbol>> StreamToList(IAsyncEnumerable<ISymbol> symbols)
+    {
+        var list = new List<ISymbol>();
+        await foreach (var symbol in symbols)
+        {
+            list.Add(symbol);
+        }
+        return list;
+    }
+}
@@ -0,0 +1,187 @@
+﻿using System.IO;
+using Dia2Lib;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.Tests;
+
+[TestClass]
+public sealed class AnalysisCacheFileTests
+{
+    private static readonly AnalysisCacheKey Key = new AnalysisCacheKey(new Guid("0B6F1E32-7A8E-4C1D-9F35-2D6A4B1C8E07"), 3, "0123456789ABCDEF", PDBReader.DIA, SymbolSourcesSupported.All);
+
+    private static readonly Func<uint, uint, bool> AllSymIndexIdsMatch = (_, _) => true;
+
+    private string CacheDirectory = String.Empty;
+
+    [TestInitialize]
+    public void TestInitialize()
+    {
+        this.CacheDirectory = Path.Combine(Path.GetTempPath(), nameof(AnalysisCacheFileTests), Path.GetRandomFileName());
+    }
+
+    [TestCleanup]
+    public void TestCleanup()
+    {
+        if (Directory.Exists(this.CacheDirectory))
+        {
+            Directory.Delete(this.CacheDirectory, recursive: true);
+        }
+    }
+
+    private static SessionDataCache CreatePreProcessedDataCache()
+    {
+        var dataCache = new SessionDataCache();
+        dataCache.InitializeRVARanges(new Dictionary<uint, List<uint>>
+        {
+            { 0x2000, [5, 6] },
+            { 0x1000, [1, 2, 3] },
+            { 0x3000, [9] },
+        }, [0x1010, 0x2020]);
+
+        var folded = new NameCanonicalization();
+        folded.AddName(1, SymTagEnum.SymTagFunction, name: "Zebra");
+        folded.AddName(2, SymTagEnum.SymTagFunction, name: "Aardvark");
+        folded.AddName(3, SymTagEnum.SymTagThunk, name: "[thunk]: Aardvark`adjustor{8}'");
+        folded.Canonicalize();
+        dataCache.AllCanonicalNames = new SortedList<uint, NameCanonicalization>() { { 0x1000, folded } };
+
+        return dataCache;
+    }
+
+    [TestMethod]
+    public void PreProcessedSymbolsRoundTrip()
+    {
+        using var logger = new NoOpLogger();
+        using var original = CreatePreProcessedDataCache();
+        AnalysisCacheFile.TrySavePreProcessedSymbols(this.CacheDirectory, Key, original, logger);
+
+        using var loaded = new SessionDataCache();
+        Assert.IsTrue(AnalysisCacheFile.TryLoadPreProcessedSymbols(this.CacheDirectory, Key, loaded, logger, AllSymIndexIdsMatch));
+
+        Assert.IsTrue(loaded.TryFindSymIndicesInRVARange(new RVARange(0, UInt32.MaxValue), out var index, out var minIdx, out var maxIdx));
+        Assert.AreEqual(0, minIdx);
+        Assert.AreEqual(2, maxIdx);
+        CollectionAssert.AreEqual(new uint[] { 0x1000, 0x2000, 0x3000 }, Enumerable.Range(0, index.Count).Select(index.RVAAt).ToArray());
+        CollectionAssert.AreEqual(new uint[] { 1, 2, 3 }, index.SymIndicesAt(0).ToArray());
+        CollectionAssert.AreEqual(new uint[] { 5, 6 }, index.SymIndicesAt(1).ToArray());
+        CollectionAssert.AreEqual(new uint[] { 9 }, index.SymIndicesAt(2).ToArray());
+
+        Assert.IsTrue(loaded.LabelExistsAtRVA(0x1010));
+        Assert.IsTrue(loaded.LabelExistsAtRVA(0x2020));
+        Assert.IsFalse(loaded.LabelExistsAtRVA(0x1000));
+
+        Assert.IsNotNull(loaded.AllCanonicalNames);
+        Assert.HasCount(1, loaded.AllCanonicalNames);
+        var originalFolded = original.AllCanonicalNames![0x1000];
+        var loadedFolded = loaded.AllCanonicalNames[0x1000];
+        CollectionAssert.AreEqual(originalFolded.NamesBySymIndexID.ToArray(), loadedFolded.NamesBySymIndexID.ToArray());
+        Assert.AreEqual(2u, loadedFolded.CanonicalSymIndexID);
+        Assert.AreEqual("Aardvark", loadedFolded.CanonicalName);
+    }
+
+    [TestMethod]
+    public void EmptyPreProcessedSymbolsRoundTrip()
+    {
+        using var logger = new NoOpLogger();
+        using var original = new SessionDataCache() { AllCanonicalNames = new SortedList<uint, NameCanonicalization>() };
+        original.InitializeRVARanges(new Dictionary<uint, List<uint>>(), []);
+        AnalysisCacheFile.TrySavePreProcessedSymbols(this.CacheDirectory, Key, original, logger);
+
+        using var loaded = new SessionDataCache();
+        Assert.IsTrue(AnalysisCacheFile.TryLoadPreProcessedSymbols(this.CacheDirectory, Key, loaded, logger, AllSymIndexIdsMatch));
+        Assert.IsFalse(loaded.TryFindSymIndicesInRVARange(new RVARange(0, UInt32.MaxValue), out _, out _, out _));
+        Assert.IsNotNull(loaded.AllCanonicalNames);
+        Assert.IsEmpty(loaded.AllCanonicalNames);
+    }
+
+    [TestMethod]
+    public void MissingFileIsAMiss()
+    {
+        using var logger = new NoOpLogger();
+        using var loaded = new SessionDataCache();
+
+        Assert.IsFalse(AnalysisCacheFile.TryLoadPreProcessedSymbols(this.CacheDirectory, Key, loaded, logger, AllSymIndexIdsMatch));
+        Assert.IsNull(loaded.AllCanonicalNames);
+    }
+
+    [TestMethod]
+    public void FileForADifferentBinaryIsIgnored()
+    {
+        using var logger = new NoOpLogger();
+        using var original = CreatePreProcessedDataCache();
+        AnalysisCacheFile.TrySavePreProcessedSymbols(this.CacheDirectory, Key, original, logger);
+
+        // Same PDB signature (so the same file name), but the binary was rebuilt or patched.
+        var rebuiltBinaryKey = Key with { BinarySHA256 = "FEDCBA9876543210" };
+        Assert.AreEqual(Key.FileName, rebuiltBinaryKey.FileName);
+
+        using var loaded = new SessionDataCache();
+        Assert.IsFalse(AnalysisCacheFile.TryLoadPreProcessedSymbols(this.CacheDirectory, rebuiltBinaryKey, loaded, logger, AllSymIndexIdsMatch));
+        Assert.IsNull(loaded.AllCanonicalNames);
+        Assert.IsFalse(loaded.TryFindSymIndicesInRVARange(new RVARange(0, UInt32.MaxValue), out _, out _, out _));
+    }
+
+    [TestMethod]
+    public void FileForADifferentPDBReaderOrSymbolSourcesIsNotShared()
+    {
+        Assert.AreNotEqual(Key.FileName, (Key with { PDBReader = PDBReader.Managed }).FileName);
+        Assert.AreNotEqual(Key.FileName, (Key with { SymbolSourcesSupported = SymbolSourcesSupported.Code }).FileName);
+    }
+
+    [TestMethod]
+    public void FileWhoseSymIndexIdsNoLongerMatchIsIgnored()
+    {
+        using var logger = new NoOpLogger();
+        using var original = CreatePreProcessedDataCache();
+        AnalysisCacheFile.TrySavePreProcessedSymbols(this.CacheDirectory, Key, original, logger);
+
+        // symIndexId 6 is at 0x2000 in the file, but this session says it's somewhere else now.
+        var symIndexIdsChecked = new List<(uint symIndexId, uint rva)>();
+        bool symIndexIdIsAtRVA(uint symIndexId, uint rva)
+        {
+            symIndexIdsChecked.Add((symIndexId, rva));
+            return symIndexId != 6;
+        }
+
+        using var loaded = new SessionDataCache();
+        Assert.IsFalse(AnalysisCacheFile.TryLoadPreProcessedSymbols(this.CacheDirectory, Key, loaded, logger, symIndexIdIsAtRVA));
+        Assert.IsNull(loaded.AllCanonicalNames);
+        Assert.IsFalse(loaded.TryFindSymIndicesInRVARange(new RVARange(0, UInt32.MaxValue), out _, out _, out _));
+        CollectionAssert.AreEqual(new[] { (1u, 0x1000u), (2u, 0x1000u), (3u, 0x1000u), (5u, 0x2000u), (6u, 0x2000u) }, symIndexIdsChecked.ToArray());
+    }
+
+    [TestMethod]
+    public void TruncatedFileIsIgnored()
+    {
+        using var logger = new NoOpLogger();
+        using var original = CreatePreProcessedDataCache();
+        AnalysisCacheFile.TrySavePreProcessedSymbols(this.CacheDirectory, Key, original, logger);
+
+        var path = Path.Combine(this.CacheDirectory, Key.FileName);
+        var bytes = File.ReadAllBytes(path);
+        File.WriteAllBytes(path, bytes.AsSpan(0, bytes.Length - 10).ToArray());
+
+        using var loaded = new SessionDataCache();
+        Assert.IsFalse(AnalysisCacheFile.TryLoadPreProcessedSymbols(this.CacheDirectory, Key, loaded, logger, AllSymIndexIdsMatch));
+        Assert.IsNull(loaded.AllCanonicalNames);
+        Assert.IsFalse(loaded.TryFindSymIndicesInRVARange(new RVARange(0, UInt32.MaxValue), out _, out _, out _));
+    }
+
+    [TestMethod]
+    public void SavingReplacesAnExistingFile()
+    {
+        using var logger = new NoOpLogger();
+        using var empty = new SessionDataCache() { AllCanonicalNames = new SortedList<uint, NameCanonicalization>() };
+        empty.InitializeRVARanges(new Dictionary<uint, List<uint>>(), []);
+        AnalysisCacheFile.TrySavePreProcessedSymbols(this.CacheDirectory, Key, empty, logger);
+
+        using var original = CreatePreProcessedDataCache();
+        AnalysisCacheFile.TrySavePreProcessedSymbols(this.CacheDirectory, Key, original, logger);
+
+        using var loaded = new SessionDataCache();
+        Assert.IsTrue(AnalysisCacheFile.TryLoadPreProcessedSymbols(this.CacheDirectory, Key, loaded, logger, AllSymIndexIdsMatch));
+        Assert.HasCount(1, loaded.AllCanonicalNames!);
+        CollectionAssert.AreEquivalent(new[] { Key.FileName }, Directory.GetFiles(this.CacheDirectory).Select(Path.GetFileName).ToArray());
+    }
+}
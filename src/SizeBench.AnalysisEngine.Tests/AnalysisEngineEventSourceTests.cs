@@ -0,0 +1,115 @@
+﻿using System.Collections.Concurrent;
+using System.Diagnostics.Tracing;
+using SizeBench.AnalysisEngine.SessionTasks;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+using SizeBench.TestDataCommon;
+
+namespace SizeBench.AnalysisEngine.Tests;
+
+[TestClass]
+public sealed class AnalysisEngineEventSourceTests
+{
+    private sealed class TaskEventListener : EventListener
+    {
+        public ConcurrentQueue<(string EventName, string TaskName)> Events { get; } = new ConcurrentQueue<(string, string)>();
+
+        protected override void OnEventSourceCreated(EventSource eventSource)
+        {
+            if (eventSource.Name == "SizeBench-AnalysisEngine")
+            {
+                EnableEvents(eventSource, EventLevel.Informational);
+            }
+        }
+
+        protected override void OnEventWritten(EventWrittenEventArgs eventData)
+        {
+            if (eventData.Payload?.Count > 0 && eventData.Payload[0] is string taskName)
+            {
+                this.Events.Enqueue((eventData.EventName ?? String.Empty, taskName));
+            }
+        }
+    }
+
+    private sealed class TestSessionTask : SessionTask<List<int>>
+    {
+        private readonly bool _shouldThrow;
+
+        public TestSessionTask(SessionTaskParameters parameters, string taskName, bool shouldThrow)
+            : base(parameters, null, CancellationToken.None)
+        {
+            this.TaskName = taskName;
+            this._shouldThrow = shouldThrow;
+        }
+
+        protected override List<int> ExecuteCore(ILogger logger)
+            => this._shouldThrow ? throw new InvalidOperationException() : new List<int>();
+    }
+
+    // Tests run in parallel, so each one uses its own task name and only looks at the events with that name.
+    private static List<string> EventsForTask(TaskEventListener listener, string taskName)
+        => listener.Events.Where(e => e.TaskName == taskName).Select(e => e.EventName).ToList();
+
+    [TestMethod]
+    public void SessionTaskEmitsStartAndStop()
+    {
+        using var listener = new TaskEventListener();
+        using var dataCache = new SessionDataCache();
+        var parameters = new SessionTaskParameters(new Mock<ISession>().Object, new TestDIAAdapter(), dataCache);
+        var taskName = $"Test Task {Guid.NewGuid()}";
+
+        using var logger = new NoOpLogger();
+        new TestSessionTask(parameters, taskName, shouldThrow: false).Execute(logger);
+
+        CollectionAssert.AreEqual(new[] { "SessionTaskStart", "SessionTaskStop" }, EventsForTask(listener, taskName));
+    }
+
+    [TestMethod]
+    public void SessionTaskEmitsStopEvenWhenItThrows()
+    {
+        using var listener = new TaskEventListener();
+        using var dataCache = new SessionDataCache();
+        var parameters = new SessionTaskParameters(new Mock<ISession>().Object, new TestDIAAdapter(), dataCache);
+        var taskName = $"Test Task {Guid.NewGuid()}";
+
+        using var logger = new NoOpLogger();
+        Assert.ThrowsExactly<InvalidOperationException>(() => new TestSessionTask(parameters, taskName, shouldThrow: true).Execute(logger));
+
+        CollectionAssert.AreEqual(new[] { "SessionTaskStart", "SessionTaskStop" }, EventsForTask(listener, taskName));
+    }
+
+    [TestMethod]
+    public async Task StreamingSessionTaskEmitsStartAndStopWhenAdvancedFromDifferentThreads()
+    {
+        using var listener = new TaskEventListener();
+        using var dataCache = new SessionDataCache()
+        {
+            AllCanonicalNames = new SortedList<uint, NameCanonicalization>(),
+            PDataHasBeenInitialized = true,
+            XDataHasBeenInitialized = true,
+            RsrcHasBeenInitialized = true,
+            OtherPESymbolsHaveBeenInitialized = true,
+        };
+        var diaAdapter = new TestDIAAdapter();
+        var rvaRange = RVARange.FromRVAAndSize(0x1000, 0x20);
+        diaAdapter.SymbolsToFindByRVARange.Add(rvaRange, new List<(ISymbol, uint)>()
+        {
+            (new SimpleFunctionCodeSymbol(dataCache, "test symbol 1", rva: 0x1000, size: 0x10, symIndexId: 1), 1),
+            (new SimpleFunctionCodeSymbol(dataCache, "test symbol 2", rva: 0x1010, size: 0x10, symIndexId: 2), 2),
+        });
+        var parameters = new SessionTaskParameters(new Mock<ISession>().Object, diaAdapter, dataCache);
+        var taskName = $"Test Streaming Task {Guid.NewGuid()}";
+
+        // The Session advances a stream one DIA thread work item at a time, so each step here is on its own thread pool work item too.
+        using var logger = new NoOpLogger();
+        using var enumerator = EnumerateSymbolsInRVARangeSessionTask.StreamSymbolsInRVARanges(parameters, CancellationToken.None, taskName, new[] { rvaRange }, logger).GetEnumerator();
+        var symbolsStreamed = 0;
+        while (await Task.Run(enumerator.MoveNext))
+        {
+            symbolsStreamed++;
+        }
+
+        Assert.AreEqual(2, symbolsStreamed);
+        CollectionAssert.AreEqual(new[] { "StreamingSessionTaskStart", "StreamingSessionTaskStop" }, EventsForTask(listener, taskName));
+    }
+}
@@ -0,0 +1,107 @@
+﻿using SizeBench.AnalysisEngine.DIAInterop;
+
+namespace SizeBench.AnalysisEngine.Tests.DIAInterop;
+
+// The expected names here are what DIA's undecoratedName returns, since SizeBench has always displayed (and diffed) those - so the
+// formatting quirks like "> >" and ")const __ptr64" matter, not just getting the structure right.
+[TestClass]
+public sealed class MSVCNameUndecoratorTests
+{
+    [TestMethod]
+    public void MemberFunctionsAreUndecorated()
+    {
+        Assert.AreEqual("public: __cdecl std::bad_alloc::bad_alloc(class std::bad_alloc const & __ptr64) __ptr64",
+                        MSVCNameUndecorator.Undecorate("??0bad_alloc@std@@QEAA@AEBV01@@Z"));
+        Assert.AreEqual("public: virtual __cdecl std::bad_alloc::~bad_alloc(void) __ptr64",
+                        MSVCNameUndecorator.Undecorate("??1bad_alloc@std@@UEAA@XZ"));
+        Assert.AreEqual("public: int __cdecl Foo::get(void)const __ptr64",
+                        MSVCNameUndecorator.Undecorate("?get@Foo@@QEBAHXZ"));
+        Assert.AreEqual("public: __cdecl Foo::operator bool(void)const __ptr64",
+                        MSVCNameUndecorator.Undecorate("??BFoo@@QEBA_NXZ"));
+        Assert.AreEqual("public: virtual void * __ptr64 __cdecl type_info::`scalar deleting destructor'(unsigned int) __ptr64",
+                        MSVCNameUndecorator.Undecorate("??_Gtype_info@@UEAAPEAXI@Z"));
+
+        // 32-bit names have no __ptr64 anywhere
+        Assert.AreEqual("public: __cdecl std::exception::exception(char const * const)",
+                        MSVCNameUndecorator.Undecorate("??0exception@std@@QAA@QBD@Z"));
+    }
+
+    [TestMethod]
+    public void GlobalFunctionsAreUndecorated()
+    {
+        Assert.AreEqual("void * __ptr64 __cdecl operator new(unsigned __int64,struct std::nothrow_t const & __ptr64)",
+                        MSVCNameUndecorator.Undecorate("??2@YAPEAX_KAEBUnothrow_t@std@@@Z"));
+        Assert.AreEqual("void __cdecl f(void (__cdecl*)(int))", MSVCNameUndecorator.Undecorate("?f@@YAXP6AXH@Z@Z"));
+        Assert.AreEqual("void __cdecl f(int,...)", MSVCNameUndecorator.Undecorate("?f@@YAXHZZ"));
+        Assert.AreEqual("void __cdecl `dynamic initializer for 'g_x''(void)", MSVCNameUndecorator.Undecorate("??__Eg_x@@YAXXZ"));
+    }
+
+    [TestMethod]
+    public void TemplatesAndBackReferencesAreUndecorated()
+    {
+        Assert.AreEqual("public: __cdecl std::vector<wchar_t,class std::allocator<wchar_t> >::~vector<wchar_t,class std::allocator<wchar_t> >(void) __ptr64",
+                        MSVCNameUndecorator.Undecorate("??1?$vector@_WV?$allocator@_W@std@@@std@@QEAA@XZ"));
+
+        // Function templates aren't remembered for backreferences, so "12" here is winrt::guid...
+        Assert.AreEqual("struct winrt::guid * __ptr64 __cdecl std::copy<struct winrt::guid const * __ptr64,struct winrt::guid * __ptr64>" +
+                        "(struct winrt::guid const * __ptr64,struct winrt::guid const * __ptr64,struct winrt::guid * __ptr64)",
+                        MSVCNameUndecorator.Undecorate("??$copy@PEBUguid@winrt@@PEAU12@@std@@YAPEAUguid@winrt@@PEBU12@0PEAU12@@Z"));
+
+        // ...but variable templates are, so "2" here is winrt.
+        Assert.AreEqual("struct winrt::guid const winrt::impl::guid_v<struct winrt::impl::IAgileObject>",
+                        MSVCNameUndecorator.Undecorate("??$guid_v@UIAgileObject@impl@winrt@@@impl@winrt@@3Uguid@2@B"));
+
+        Assert.AreEqual("const winrt::impl::weak_source<1,1>::`vftable'", MSVCNameUndecorator.Undecorate("??_7?$weak_source@$00$00@impl@winrt@@6B@"));
+        Assert.AreEqual("void __cdecl f<void __cdecl(int)>(void)", MSVCNameUndecorator.Undecorate("??$f@$$A6AXH@Z@@YAXXZ"));
+    }
+
+    [TestMethod]
+    public void VariablesAreUndecorated()
+    {
+        Assert.AreEqual("private: static int Foo::s_count", MSVCNameUndecorator.Undecorate("?s_count@Foo@@0HA"));
+        Assert.AreEqual("int * __ptr64 __ptr64 p", MSVCNameUndecorator.Undecorate("?p@@3PEAHEA"));
+        Assert.AreEqual("int `void __cdecl f(void)'::`2'::x", MSVCNameUndecorator.Undecorate("?x@?1??f@@YAXXZ@4HA"));
+        Assert.AreEqual("`string'", MSVCNameUndecorator.Undecorate("??_C@_0M@LACCCNMM@SomeString@"));
+    }
+
+    [TestMethod]
+    public void VTablesAndRTTIAreUndecorated()
+    {
+        Assert.AreEqual("const std::exception::`vftable'", MSVCNameUndecorator.Undecorate("??_7exception@std@@6B@"));
+        Assert.AreEqual("const Foo::`vftable'{for `IBar'}", MSVCNameUndecorator.Undecorate("??_7Foo@@6BIBar@@@"));
+        Assert.AreEqual("const Foo::`vftable'{for `IBar's `IBaz'}", MSVCNameUndecorator.Undecorate("??_7Foo@@6BIBar@@IBaz@@@"));
+        Assert.AreEqual("const Foo::`RTTI Complete Object Locator'", MSVCNameUndecorator.Undecorate("??_R4Foo@@6B@"));
+        Assert.AreEqual("class Foo `RTTI Type Descriptor'", MSVCNameUndecorator.Undecorate("??_R0?AVFoo@@@8"));
+        Assert.AreEqual("Foo::`RTTI Base Class Descriptor at (0,-1,0,64)'", MSVCNameUndecorator.Undecorate("??_R1A@?0A@EA@Foo@@8"));
+    }
+
+    [TestMethod]
+    public void FlagsAreHonored()
+    {
+        const UndName thunkNameFlags = UndName.UNDNAME_NO_PTR64 | UndName.UNDNAME_NO_ECSU | UndName.UNDNAME_NO_MEMBER_TYPE |
+                                       UndName.UNDNAME_NO_ACCESS_SPECIFIERS | UndName.UNDNAME_NO_THISTYPE | UndName.UNDNAME_NO_ALLOCATION_LANGUAGE |
+                                       UndName.UNDNAME_NO_FUNCTION_RETURNS | UndName.UNDNAME_NO_MS_KEYWORDS;
+
+        Assert.AreEqual("type_info::`scalar deleting destructor'(unsigned int)", MSVCNameUndecorator.Undecorate("??_Gtype_info@@UEAAPEAXI@Z", thunkNameFlags));
+        Assert.AreEqual("std::bad_alloc::bad_alloc(std::bad_alloc const &)", MSVCNameUndecorator.Undecorate("??0bad_alloc@std@@QEAA@AEBV01@@Z", thunkNameFlags));
+        Assert.AreEqual("public: int __cdecl Foo::get(void)const", MSVCNameUndecorator.Undecorate("?get@Foo@@QEBAHXZ", UndName.UNDNAME_NO_PTR64));
+        Assert.AreEqual("Foo::get", MSVCNameUndecorator.Undecorate("?get@Foo@@QEBAHXZ", UndName.UNDNAME_NAME_ONLY));
+        Assert.AreEqual("Foo::s_count", MSVCNameUndecorator.Undecorate("?s_count@Foo@@0HA", UndName.UNDNAME_NAME_ONLY));
+    }
+
+    [TestMethod]
+    public void UnsupportedNamesReturnNull()
+    {
+        Assert.IsNull(MSVCNameUndecorator.Undecorate(String.Empty));
+        Assert.IsNull(MSVCNameUndecorator.Undecorate("_printf")); // Not decorated
+        Assert.IsNull(MSVCNameUndecorator.Undecorate("??@a1b2c3d4e5f6a7b8c9d0e1f2a3b4c5d6@")); // MD5-hashed
+        Assert.IsNull(MSVCNameUndecorator.Undecorate("?AddRef@error_info_fallback@impl@winrt@@W7EAAIXZ")); // Adjustor thunk
+        Assert.IsNull(MSVCNameUndecorator.Undecorate("?get@Foo@@QEBAHXZ", UndName.UNDNAME_TYPE_ONLY));
+
+        // Malformed or truncated names
+        Assert.IsNull(MSVCNameUndecorator.Undecorate("?"));
+        Assert.IsNull(MSVCNameUndecorator.Undecorate("?get@Foo@@QEBAH"));
+        Assert.IsNull(MSVCNameUndecorator.Undecorate("?get@Foo@@QEBAHXZextra"));
+        Assert.IsNull(MSVCNameUndecorator.Undecorate("?f@@YAXV9@Z"));
+    }
+}
@@ -1,4 +1,5 @@
-﻿using SizeBench.AnalysisEngine.Symbols;
+﻿using Dia2Lib;
+using SizeBench.AnalysisEngine.Symbols;
 using SizeBench.Logging;
 using SizeBench.TestDataCommon;
 
@@ -119,5 +120,131 @@ public sealed class EnumerateSymbolDiffsBetweenTwoSymbolListsSessionTaskTests :
         }
     }
 
+    [TestMethod]
+    public async Task MatchesSymbolsWhereverTheyAppearInTheAfterList()
+    {
+        var before = this._generator.GenerateABunchOfBeforeSymbols(new List<RVARange>() { RVARange.FromRVAAndSize(0x100, 0x100) });
+        var after = this._generator.GenerateABunchOfAfterSymbols(new List<RVARange>() { RVARange.FromRVAAndSize(0x100, 0x100) });
+        after.Reverse();
+
+        var results = await DiffSymbolLists(before, after);
+
+        Assert.HasCount(5, results);
+        for (var i = 0; i < 5; i++)
+        {
+            // The diffs come out in 'before' order, no matter the order of 'after'
+            Assert.AreSame(before[i], results[i].BeforeSymbol);
+            Assert.IsNotNull(results[i].AfterSymbol);
+            Assert.AreEqual(before[i].Name, results[i].AfterSymbol!.Name);
+            Assert.AreEqual(-2, results[i].SizeDiff);
+        }
+    }
+
+    [TestMethod]
+    public async Task SymbolsSharingANameAreMatchedUpInOrder()
+    {
+        var before = new List<Symbol>()
+        {
+            new Symbol(this._generator.BeforeDataCache, "`string'", rva: 0x100, size: 5, isVirtualSize: false, symIndexId: 1000),
+            new Symbol(this._generator.BeforeDataCache, "`string'", rva: 0x200, size: 6, isVirtualSize: false, symIndexId: 1001),
+        };
+        var after = new List<Symbol>()
+        {
+            new Symbol(this._generator.AfterDataCache, "`string'", rva: 0x300, size: 7, isVirtualSize: false, symIndexId: 1000),
+            new Symbol(this._generator.AfterDataCache, "`string'", rva: 0x400, size: 8, isVirtualSize: false, symIndexId: 1001),
+            new Symbol(this._generator.AfterDataCache, "`string'", rva: 0x500, size: 9, isVirtualSize: false, symIndexId: 1002),
+        };
+
+        var results = await DiffSymbolLists(before, after);
+
+        Assert.HasCount(3, results);
+        Assert.AreSame(before[0], results[0].BeforeSymbol);
+        Assert.AreSame(after[0], results[0].AfterSymbol);
+        Assert.AreSame(before[1], results[1].BeforeSymbol);
+        Assert.AreSame(after[1], results[1].AfterSymbol);
+        Assert.IsNull(results[2].BeforeSymbol);
+        Assert.AreSame(after[2], results[2].AfterSymbol);
+    }
+
+    [TestMethod]
+    public async Task FoldedSymbolsAreMatchedByCanonicalName()
+    {
+        var beforeCanonicalization = new NameCanonicalization();
+        beforeCanonicalization.AddName(1000, SymTagEnum.SymTagPublicSymbol, name: "Aardvark");
+        beforeCanonicalization.AddName(1001, SymTagEnum.SymTagPublicSymbol, name: "Zebra");
+        beforeCanonicalization.Canonicalize();
+        this._generator.BeforeDataCache.AllCanonicalNames!.Add(0x100, beforeCanonicalization);
+
+        var afterCanonicalization = new NameCanonicalization();
+        afterCanonicalization.AddName(1000, SymTagEnum.SymTagPublicSymbol, name: "Aardvark");
+        afterCanonicalization.AddName(1001, SymTagEnum.SymTagPublicSymbol, name: "Yak");
+        afterCanonicalization.Canonicalize();
+        this._generator.AfterDataCache.AllCanonicalNames!.Add(0x200, afterCanonicalization);
+
+        var before = new PublicSymbol(this._generator.BeforeDataCache, "Zebra", rva: 0x100, size: 5, isVirtualSize: false, symIndexId: 1001, targetRva: 0);
+        var after = new PublicSymbol(this._generator.AfterDataCache, "Yak", rva: 0x200, size: 5, isVirtualSize: false, symIndexId: 1001, targetRva: 0);
+        Assert.AreEqual("Aardvark", before.CanonicalName);
+        Assert.AreEqual("Aardvark", after.CanonicalName);
+
+        var results = await DiffSymbolLists(new List<Symbol>() { before }, new List<Symbol>() { after });
+
+        Assert.HasCount(1, results);
+        Assert.AreSame(before, results[0].BeforeSymbol);
+        Assert.AreSame(after, results[0].AfterSymbol);
+    }
+
+    [TestMethod]
+    public async Task SymbolsThatAreTheSameWithoutSharingANameAreStillMatched()
+    {
+        var before = new List<Symbol>()
+        {
+            new SameRVAIsTheSameSymbol(this._generator.BeforeDataCache, "old name", rva: 0x100, symIndexId: 1000),
+            new SameRVAIsTheSameSymbol(this._generator.BeforeDataCache, "unchanged", rva: 0x200, symIndexId: 1001),
+            new SameRVAIsTheSameSymbol(this._generator.BeforeDataCache, "removed", rva: 0x300, symIndexId: 1002),
+        };
+        var after = new List<Symbol>()
+        {
+            new SameRVAIsTheSameSymbol(this._generator.AfterDataCache, "unchanged", rva: 0x200, symIndexId: 1000),
+            new SameRVAIsTheSameSymbol(this._generator.AfterDataCache, "new name", rva: 0x100, symIndexId: 1001),
+            new SameRVAIsTheSameSymbol(this._generator.AfterDataCache, "added", rva: 0x400, symIndexId: 1002),
+        };
+
+        var results = await DiffSymbolLists(before, after);
+
+        Assert.HasCount(4, results);
+        Assert.AreSame(before[0], results[0].BeforeSymbol);
+        Assert.AreSame(after[1], results[0].AfterSymbol);
+        Assert.AreSame(before[1], results[1].BeforeSymbol);
+        Assert.AreSame(after[0], results[1].AfterSymbol);
+        Assert.AreSame(before[2], results[2].BeforeSymbol);
+        Assert.IsNull(results[2].AfterSymbol);
+        Assert.IsNull(results[3].BeforeSymbol);
+        Assert.AreSame(after[2], results[3].AfterSymbol);
+    }
+
+    // A symbol whose identity is its RVA rather than its name, so it can only be matched by IsVeryLikelyTheSameAs and never by name.
+    private sealed class SameRVAIsTheSameSymbol : Symbol
+    {
+        public SameRVAIsTheSameSymbol(SessionDataCache cache, string name, uint rva, uint symIndexId)
+            : base(cache, name, rva, size: 5, isVirtualSize: false, symIndexId: symIndexId)
+        { }
+
+        public override bool IsVeryLikelyTheSameAs(ISymbol otherSymbol) => otherSymbol.RVA == this.RVA;
+    }
+
+    private async Task<List<SymbolDiff>> DiffSymbolLists(IEnumerable<Symbol> beforeSymbols, IEnumerable<Symbol> afterSymbols)
+    {
+        var task = new EnumerateSymbolDiffsBetweenTwoSymbolListsSessionTask(
+            this._generator.DiffSessionTaskParameters,
+            (logger) => Task.FromResult<IReadOnlyList<ISymbol>?>(beforeSymbols.Cast<ISymbol>().ToList()),
+            (logger) => Task.FromResult<IReadOnlyList<ISymbol>?>(afterSymbols.Cast<ISymbol>().ToList()),
+            nameOfThingBeingEnumerated: "test symbols",
+            progress: null,
+            token: CancellationToken.None);
+
+        using var logger = new NoOpLogger();
+        return await task.ExecuteAsync(logger);
+    }
+
     public void Dispose() => this._generator.Dispose();
 }
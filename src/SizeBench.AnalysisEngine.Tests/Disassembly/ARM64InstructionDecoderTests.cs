@@ -0,0 +1,92 @@
+﻿using SizeBench.AnalysisEngine.Disassembly;
+using SizeBench.AnalysisEngine.PE;
+
+namespace SizeBench.AnalysisEngine.Tests.Disassembly;
+
+// Like X64InstructionDecoderTests, the expected text is in the debugger's style - no spaces between operands, and the procedure-call-standard
+// names for the special registers (fp, lr, xip0...).  The bytes are little-endian, as they appear in the binary.
+[TestClass]
+public sealed class ARM64InstructionDecoderTests
+{
+    private const ulong ImageBase = 0x180000000;
+
+    private static DecodedInstruction Decode(string hex, uint rva = 0x1000)
+        => ARM64InstructionDecoder.Decode(Convert.FromHexString(hex), rva, ImageBase);
+
+    [TestMethod]
+    public void PrologAndEpilogMatchTheDebuggersText()
+    {
+        Assert.AreEqual("stp         fp,lr,[sp,#-0x10]!", Decode("FD7BBFA9").ToDisplayString());
+        Assert.AreEqual("mov         fp,sp", Decode("FD030091").ToDisplayString());
+        Assert.AreEqual("ldp         fp,lr,[sp],#0x10", Decode("FD7BC1A8").ToDisplayString());
+        Assert.AreEqual("ret", Decode("C0035FD6").ToDisplayString());
+        Assert.AreEqual(InstructionFlow.Return, Decode("C0035FD6").Flow);
+    }
+
+    [TestMethod]
+    public void AliasesArePreferredLikeTheDebuggerDoes()
+    {
+        Assert.AreEqual("mov         x0,#-2", Decode("20008092").ToDisplayString());
+        Assert.AreEqual("mov         x0,x1", Decode("E00301AA").ToDisplayString());
+        Assert.AreEqual("cmp         x0,#5", Decode("1F1400F1").ToDisplayString());
+        Assert.AreEqual("cset        w0,ne", Decode("E0079F1A").ToDisplayString());
+        Assert.AreEqual("lsl         x0,x1,#3", Decode("20F07DD3").ToDisplayString());
+        Assert.AreEqual("mul         x0,x1,x2", Decode("207C029B").ToDisplayString());
+        Assert.AreEqual("nop", Decode("1F2003D5").ToDisplayString());
+
+        // Zero with a shift isn't the canonical way to write zero, so it keeps its real name
+        Assert.AreEqual("movz        x0,#0,lsl #16", Decode("0000A0D2").ToDisplayString());
+    }
+
+    [TestMethod]
+    public void LoadsAndStoresFormatEveryAddressingMode()
+    {
+        Assert.AreEqual("ldr         x8,[x19,#0x18]", Decode("680E40F9").ToDisplayString());
+        Assert.AreEqual("ldr         w0,[x1,x2,lsl #2]", Decode("207862B8").ToDisplayString());
+        Assert.AreEqual("ldr         x0,[x1,w2,sxtw #3]", Decode("20D862F8").ToDisplayString());
+        Assert.AreEqual("ldur        x0,[fp,#-8]", Decode("A0835FF8").ToDisplayString());
+        Assert.AreEqual("str         q0,[x1,#0x20]", Decode("2008803D").ToDisplayString());
+        Assert.AreEqual("ldaddal     x0,x1,[x2]", Decode("4100E0F8").ToDisplayString());
+    }
+
+    [TestMethod]
+    public void BranchesHaveTheirTargetAndFlow()
+    {
+        var bl = Decode("00010094");
+        Assert.AreEqual(InstructionFlow.Call, bl.Flow);
+        Assert.AreEqual(0x1400u, bl.TargetRVA);
+        Assert.AreEqual("bl          00000001`80001400", bl.ToDisplayString());
+
+        var cbz = Decode("E0000034");
+        Assert.AreEqual(InstructionFlow.ConditionalJump, cbz.Flow);
+        Assert.AreEqual(0x101Cu, cbz.TargetRVA);
+        Assert.AreEqual("00000001`8000101c", cbz.Operands.Substring(cbz.TargetTextStart, cbz.TargetTextLength));
+
+        var bne = Decode("41000054");
+        Assert.AreEqual("bne         00000001`80001008", bne.ToDisplayString());
+
+        var blr = Decode("00013FD6");
+        Assert.AreEqual(InstructionFlow.Call, blr.Flow);
+        Assert.IsNull(blr.TargetRVA);
+    }
+
+    [TestMethod]
+    public void ADRPTargetsThePageOfItsTarget()
+    {
+        var adrp = Decode("08000090", rva: 0x1234);
+        Assert.AreEqual(0x1000u, adrp.TargetRVA);
+        Assert.AreEqual("adrp        x8,00000001`80001000", adrp.ToDisplayString());
+    }
+
+    [TestMethod]
+    public void UnsupportedInstructionsAreUnknownButStillFourBytes()
+    {
+        Assert.IsTrue(Decode("00000000").IsUnknown);
+        Assert.AreEqual(4, Decode("00000000").Length);
+
+        var instructions = ManagedDisassembler.DecodeRange(Convert.FromHexString("FD7BBFA900000000C0035FD6"), 0x1000, MachineType.ARM64, ImageBase);
+        Assert.AreEqual(3, instructions.Count);
+        Assert.IsTrue(instructions[1].IsUnknown);
+        Assert.AreEqual(InstructionFlow.Return, instructions[2].Flow);
+    }
+}
@@ -0,0 +1,105 @@
+﻿using SizeBench.AnalysisEngine.Disassembly;
+using SizeBench.AnalysisEngine.PE;
+
+namespace SizeBench.AnalysisEngine.Tests.Disassembly;
+
+// The expected text here is what the debugger prints for the same bytes, since disassembly from either backend gets diffed and compared
+// by the same code - so the MASM-style hex ("28h", "0A0h") and the column the operands start at matter, not just the instruction.
+[TestClass]
+public sealed class X64InstructionDecoderTests
+{
+    private const ulong ImageBase = 0x180000000;
+
+    private static DecodedInstruction Decode(string hex, uint rva = 0x1000)
+        => X64InstructionDecoder.Decode(Convert.FromHexString(hex), rva, ImageBase);
+
+    [TestMethod]
+    public void CommonInstructionsMatchTheDebuggersText()
+    {
+        Assert.AreEqual("sub         rsp,28h", Decode("4883EC28").ToDisplayString());
+        Assert.AreEqual("lea         rcx,[rbp-10h]", Decode("488D4DF0").ToDisplayString());
+        Assert.AreEqual("call        qword ptr [rax+8]", Decode("FF5008").ToDisplayString());
+        Assert.AreEqual("nop         dword ptr [rax+rax]", Decode("0F1F440000").ToDisplayString());
+        Assert.AreEqual("mov         rax,1122334455667788h", Decode("48B88877665544332211").ToDisplayString());
+        Assert.AreEqual("movq        xmm0,rax", Decode("66480F6EC0").ToDisplayString());
+        Assert.AreEqual("vmovss      xmm0,xmm0,xmm1", Decode("C5FA10C1").ToDisplayString());
+        Assert.AreEqual("vzeroupper", Decode("C5F877").ToDisplayString());
+        Assert.AreEqual("ret", Decode("C3").ToDisplayString());
+    }
+
+    [TestMethod]
+    public void PrefixesThatMakeTheMnemonicTooLongGetASingleSpace()
+    {
+        Assert.AreEqual("lock cmpxchg16b oword ptr [r10]", Decode("F0490FC70A").ToDisplayString());
+        Assert.AreEqual("rep movs    byte ptr [rdi],byte ptr [rsi]", Decode("F3A4").ToDisplayString());
+    }
+
+    [TestMethod]
+    public void InstructionLengthsAreCorrect()
+    {
+        Assert.AreEqual(4, Decode("4883EC28").Length);
+        Assert.AreEqual(5, Decode("F0490FC70A").Length);
+        Assert.AreEqual(10, Decode("48B88877665544332211").Length);
+        Assert.AreEqual(8, Decode("C5FA100510000000").Length);
+    }
+
+    [TestMethod]
+    public void BranchesHaveTheirTargetAndFlow()
+    {
+        var call = Decode("E800100000");
+        Assert.AreEqual(InstructionFlow.Call, call.Flow);
+        Assert.AreEqual(0x2005u, call.TargetRVA);
+        Assert.AreEqual("call        00000001`80002005", call.ToDisplayString());
+        Assert.AreEqual("00000001`80002005", call.Operands.Substring(call.TargetTextStart, call.TargetTextLength));
+
+        var jumpBackwards = Decode("E9FBEFFFFF");
+        Assert.AreEqual(InstructionFlow.Jump, jumpBackwards.Flow);
+        Assert.AreEqual(0x0u, jumpBackwards.TargetRVA);
+
+        var conditionalJump = Decode("7405");
+        Assert.AreEqual(InstructionFlow.ConditionalJump, conditionalJump.Flow);
+        Assert.AreEqual(0x1007u, conditionalJump.TargetRVA);
+        Assert.AreEqual("je          00000001`80001007", conditionalJump.ToDisplayString());
+
+        Assert.AreEqual(InstructionFlow.Return, Decode("C3").Flow);
+        Assert.IsNull(Decode("FF5008").TargetRVA);
+    }
+
+    [TestMethod]
+    public void RIPRelativeOperandsHaveTheirTarget()
+    {
+        var lea = Decode("488D05F80F0000");
+        Assert.AreEqual(0x1FFFu, lea.TargetRVA);
+        Assert.AreEqual("lea         rax,[00000001`80001fff]", lea.ToDisplayString());
+        Assert.AreEqual("00000001`80001fff", lea.Operands.Substring(lea.TargetTextStart, lea.TargetTextLength));
+
+        // The displacement is relative to the end of the instruction, which includes the VEX prefix
+        var vmovss = Decode("C5FA100510000000");
+        Assert.AreEqual(0x1018u, vmovss.TargetRVA);
+        Assert.AreEqual("vmovss      xmm0,dword ptr [00000001`80001018]", vmovss.ToDisplayString());
+    }
+
+    [TestMethod]
+    public void InvalidOrTruncatedBytesAreUnknownAndOneByteLong()
+    {
+        // 06 (push es) isn't valid in 64-bit mode
+        Assert.IsTrue(Decode("06").IsUnknown);
+        Assert.AreEqual(1, Decode("06").Length);
+        Assert.AreEqual("???", Decode("06").ToDisplayString());
+
+        // A RIP-relative operand cut off before the end of its displacement
+        Assert.IsTrue(Decode("C5FA1005100000").IsUnknown);
+        Assert.AreEqual(1, Decode("C5FA1005100000").Length);
+    }
+
+    [TestMethod]
+    public void DecodeRangeWalksInstructionBoundaries()
+    {
+        var instructions = ManagedDisassembler.DecodeRange(Convert.FromHexString("4883EC28488D4DF0E800100000904883C428C3"), 0x1000, MachineType.x64, ImageBase);
+
+        CollectionAssert.AreEqual(new uint[] { 0x1000, 0x1004, 0x1008, 0x100D, 0x100E, 0x1012 }, instructions.Select(i => i.RVA).ToArray());
+        Assert.AreEqual("nop", instructions[3].ToDisplayString());
+        Assert.AreEqual("add         rsp,28h", instructions[4].ToDisplayString());
+        Assert.AreEqual(InstructionFlow.Return, instructions[5].Flow);
+    }
+}
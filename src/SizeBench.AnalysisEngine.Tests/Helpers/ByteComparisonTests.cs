@@ -0,0 +1,42 @@
+﻿using SizeBench.AnalysisEngine.Helpers;
+
+namespace SizeBench.AnalysisEngine.Tests;
+
+[TestClass]
+public class ByteComparisonTests
+{
+    [TestMethod]
+    public void CountEqualBytesMatchesAByteAtATimeCountForEveryLength()
+    {
+        // Cover lengths on both sides of every vector width so the 256-bit, 128-bit and scalar tails all get exercised.
+        for (var length = 0; length <= 100; length++)
+        {
+            var first = new byte[length];
+            var second = new byte[length];
+            var expected = 0;
+            for (var i = 0; i < length; i++)
+            {
+                // Make every third byte match, so the matches land in different lanes of each vector as the length changes.
+                first[i] = (byte)(i * 7);
+                second[i] = (i % 3 == 0) ? first[i] : (byte)(first[i] + 1);
+                if (i % 3 == 0)
+                {
+                    expected++;
+                }
+            }
+
+            Assert.AreEqual(expected, ByteComparison.CountEqualBytes(first, second), $"length {length}");
+        }
+    }
+
+    [TestMethod]
+    public void CountEqualBytesOnlyComparesUpToTheShorterSpan()
+    {
+        var first = new byte[70];
+        var second = new byte[40];
+
+        Assert.AreEqual(40, ByteComparison.CountEqualBytes(first, second));
+        Assert.AreEqual(40, ByteComparison.CountEqualBytes(second, first));
+        Assert.AreEqual(0, ByteComparison.CountEqualBytes(first, ReadOnlySpan<byte>.Empty));
+    }
+}
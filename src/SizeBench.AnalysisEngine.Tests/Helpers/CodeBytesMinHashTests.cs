@@ -0,0 +1,79 @@
+﻿using SizeBench.AnalysisEngine.Helpers;
+
+namespace SizeBench.AnalysisEngine.Tests;
+
+[TestClass]
+public class CodeBytesMinHashTests
+{
+    private static byte[] RandomBytes(int seed, int length)
+    {
+        var bytes = new byte[length];
+        new Random(seed).NextBytes(bytes);
+        return bytes;
+    }
+
+    private static ulong[] Signature(params byte[][] blocks)
+    {
+        var signature = CodeBytesMinHash.CreateEmptySignature();
+        foreach (var block in blocks)
+        {
+            CodeBytesMinHash.AddBytes(block, signature);
+        }
+        return signature;
+    }
+
+    [TestMethod]
+    public void IdenticalBytesHaveIdenticalSignatures()
+    {
+        var bytes = RandomBytes(seed: 1, length: 500);
+
+        var first = Signature(bytes);
+        var second = Signature((byte[])bytes.Clone());
+
+        CollectionAssert.AreEqual(first, second);
+        Assert.AreEqual(1.0f, CodeBytesMinHash.EstimateSimilarity(first, second));
+        for (var band = 0; band < CodeBytesMinHash.BandCount; band++)
+        {
+            Assert.AreEqual(CodeBytesMinHash.BandKey(first, band), CodeBytesMinHash.BandKey(second, band));
+        }
+    }
+
+    [TestMethod]
+    public void NearlyIdenticalBytesAreEstimatedToBeVerySimilar()
+    {
+        var bytes = RandomBytes(seed: 2, length: 1000);
+        var patched = (byte[])bytes.Clone();
+        patched[500]++;
+
+        Assert.IsTrue(CodeBytesMinHash.EstimateSimilarity(Signature(bytes), Signature(patched)) >= 0.9f);
+    }
+
+    [TestMethod]
+    public void UnrelatedBytesAreEstimatedToBeDissimilar()
+    {
+        Assert.IsTrue(CodeBytesMinHash.EstimateSimilarity(Signature(RandomBytes(seed: 3, length: 1000)),
+                                                          Signature(RandomBytes(seed: 4, length: 1000))) <= 0.1f);
+    }
+
+    [TestMethod]
+    public void SplittingTheBytesIntoBlocksBarelyChangesTheSignature()
+    {
+        // Shingles that would straddle the split are lost, so this isn't exactly the same signature - but with only a handful of shingles
+        // out of hundreds missing, it should be close.
+        var bytes = RandomBytes(seed: 5, length: 600);
+
+        Assert.IsTrue(CodeBytesMinHash.EstimateSimilarity(Signature(bytes), Signature(bytes[..300], bytes[300..])) >= 0.9f);
+    }
+
+    [TestMethod]
+    public void InputsShorterThanOneShingleStillProduceASignature()
+    {
+        var empty = CodeBytesMinHash.CreateEmptySignature();
+        var tiny = Signature([0xC3]);
+        var otherTiny = Signature([0xCC]);
+
+        Assert.AreEqual(0.0f, CodeBytesMinHash.EstimateSimilarity(empty, tiny));
+        Assert.AreEqual(0.0f, CodeBytesMinHash.EstimateSimilarity(tiny, otherTiny));
+        Assert.AreEqual(1.0f, CodeBytesMinHash.EstimateSimilarity(tiny, Signature([0xC3])));
+    }
+}
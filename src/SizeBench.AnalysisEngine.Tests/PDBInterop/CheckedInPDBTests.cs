@@ -0,0 +1,122 @@
+﻿using System.IO;
+using System.Reflection.PortableExecutable;
+using SizeBench.AnalysisEngine.PDBInterop;
+
+namespace SizeBench.AnalysisEngine.Tests;
+
+// Real linker-produced PDBs, parsed with nothing but the managed reader - the binary next to each one (read with PEReader, not DIA or
+// SizeBench's PEFile) says what the PDB has to agree with.  The RealPETests go further and compare whole sessions against DIA.
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.CppDll.dll")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.CppDll.pdb")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.Cpp32BitDll.dll")]
+[DeploymentItem(@"Test PEs\SizeBenchV2.AnalysisEngine.Tests.Cpp32BitDll.pdb")]
+[TestClass]
+public sealed class CheckedInPDBTests
+{
+    public TestContext? TestContext { get; set; }
+    private string MakePath(string filename) => Path.Combine(this.TestContext!.DeploymentDirectory!, filename);
+
+    private PEReader OpenBinary(string binaryName) => new PEReader(File.OpenRead(MakePath($"{binaryName}.dll")));
+    private ManagedPDBFile OpenPDB(string binaryName) => new ManagedPDBFile(MakePath($"{binaryName}.pdb"));
+
+    [TestMethod]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.CppDll")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.Cpp32BitDll")]
+    public void SuperblockAndStreamDirectory(string binaryName)
+    {
+        using var msf = new MSFFile(MakePath($"{binaryName}.pdb"));
+
+        Assert.AreEqual(4096u, msf.BlockSize);
+
+        // The fixed streams (old directory, PDB info, TPI, DBI, IPI) are always there, and the DBI stream points at more.
+        Assert.IsGreaterThan(DBIStream.StreamIndex + 1, msf.StreamCount);
+        Assert.IsTrue(msf.StreamExists(PDBInfoStream.StreamIndex));
+        Assert.IsTrue(msf.StreamExists(DBIStream.StreamIndex));
+        Assert.IsNotEmpty(msf.ReadStream(DBIStream.StreamIndex));
+    }
+
+    [TestMethod]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.CppDll")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.Cpp32BitDll")]
+    public void InfoStreamMatchesTheBinarysDebugDirectory(string binaryName)
+    {
+        using var peReader = OpenBinary(binaryName);
+        using var pdb = OpenPDB(binaryName);
+
+        var codeView = peReader.ReadCodeViewDebugDirectoryData(peReader.ReadDebugDirectory().First(static d => d.Type == DebugDirectoryEntryType.CodeView));
+        Assert.AreEqual(codeView.Guid, pdb.InfoStream.Guid);
+        Assert.AreEqual((uint)codeView.Age, pdb.DBI.Age);
+    }
+
+    [TestMethod]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.CppDll")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.Cpp32BitDll")]
+    public void DBIModulesAndSectionContributions(string binaryName)
+    {
+        using var peReader = OpenBinary(binaryName);
+        using var pdb = OpenPDB(binaryName);
+
+        // The section header stream is a copy of the binary's section headers.
+        var peSections = peReader.PEHeaders.SectionHeaders;
+        Assert.HasCount(peSections.Length, pdb.SectionHeaders);
+        for (var i = 0; i < peSections.Length; i++)
+        {
+            Assert.AreEqual((uint)peSections[i].VirtualAddress, pdb.SectionHeaders[i].VirtualAddress);
+            Assert.AreEqual((uint)peSections[i].VirtualSize, pdb.SectionHeaders[i].VirtualSize);
+        }
+
+        Assert.IsTrue(pdb.HasLinkerModule);
+        Assert.IsTrue(pdb.DBI.Modules.Any(static m => m.ObjFileName.EndsWith(".obj", StringComparison.OrdinalIgnoreCase)));
+        Assert.IsFalse(pdb.DBI.HasOmapStreams);
+
+        Assert.IsNotEmpty(pdb.DBI.SectionContributions);
+        foreach (var sc in pdb.DBI.SectionContributions)
+        {
+            Assert.IsLessThan(pdb.DBI.Modules.Count, (int)sc.ModuleIndex);
+            Assert.IsTrue(sc.Section >= 1 && sc.Section <= peSections.Length, $"Section contribution in section {sc.Section}");
+            Assert.IsLessThanOrEqualTo((long)Math.Max(peSections[sc.Section - 1].VirtualSize, peSections[sc.Section - 1].SizeOfRawData), (long)sc.Offset + sc.Size);
+
+            // Every byte a module contributed should map back to a module (not necessarily this one, if an empty contribution shares a start).
+            if (sc.Size > 0)
+            {
+                Assert.IsTrue(pdb.TryFindModuleIndexContributingRVA((uint)peSections[sc.Section - 1].VirtualAddress + sc.Offset, out _));
+            }
+        }
+    }
+
+    [TestMethod]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.CppDll")]
+    [DataRow("SizeBenchV2.AnalysisEngine.Tests.Cpp32BitDll")]
+    public void PublicAndGlobalSymbols(string binaryName)
+    {
+        using var peReader = OpenBinary(binaryName);
+        using var pdb = OpenPDB(binaryName);
+
+        var peSections = peReader.PEHeaders.SectionHeaders;
+        bool IsInASection(uint rva) => peSections.Any(s => rva >= (uint)s.VirtualAddress && rva < (uint)s.VirtualAddress + (uint)Math.Max(s.VirtualSize, s.SizeOfRawData));
+
+        var publicSymbols = pdb.Symbols.Where(static s => s.Kind == PDBSymbolKind.PublicSymbol).ToList();
+        Assert.IsNotEmpty(publicSymbols);
+        Assert.IsTrue(publicSymbols.Any(static s => s.IsCode));
+        Assert.IsTrue(publicSymbols.Any(static s => !s.IsCode));
+        foreach (var publicSymbol in publicSymbols)
+        {
+            Assert.IsTrue(IsInASection(publicSymbol.RVA), $"{publicSymbol.Name} at 0x{publicSymbol.RVA:X}");
+        }
+
+        // The entry point is code that the linker knows about, so there's a public symbol for it.
+        var entryPointRVA = (uint)peReader.PEHeaders.PEHeader!.AddressOfEntryPoint;
+        Assert.IsTrue(publicSymbols.Any(s => s.RVA == entryPointRVA && s.IsCode));
+
+        var dataSymbols = pdb.Symbols.Where(static s => s.Kind == PDBSymbolKind.Data).ToList();
+        Assert.IsNotEmpty(dataSymbols);
+        Assert.IsTrue(dataSymbols.Any(static s => s.IsGlobal));
+        Assert.AreEqual(dataSymbols.Count, dataSymbols.Select(static s => (s.RVA, s.Name)).Distinct().Count(), "Globals should only be counted once.");
+
+        foreach (var function in pdb.Symbols.Where(static s => s.Kind == PDBSymbolKind.Function))
+        {
+            Assert.IsTrue(IsInASection(function.RVA), $"{function.Name} at 0x{function.RVA:X}");
+            Assert.IsTrue(pdb.IsCompilandSymIndexId(function.CompilandSymIndexId));
+        }
+    }
+}
@@ -0,0 +1,369 @@
+﻿using System.Buffers.Binary;
+using System.IO;
+using SizeBench.AnalysisEngine.DIAInterop;
+using SizeBench.AnalysisEngine.PDBInterop;
+
+namespace SizeBench.AnalysisEngine.Tests;
+
+// These parse PDBs written by TestPDBBuilder, so they know exactly what should come out and don't need DIA (or Windows) to check it.
+[TestClass]
+public sealed class ManagedPDBFileTests
+{
+    private readonly List<string> _tempFiles = new List<string>();
+
+    [TestCleanup]
+    public void TestCleanup()
+    {
+        foreach (var tempFile in this._tempFiles)
+        {
+            File.Delete(tempFile);
+        }
+    }
+
+    private string WriteToTempFile(byte[] pdbBytes)
+    {
+        var path = TestPDBBuilder.WriteToTempFile(pdbBytes);
+        this._tempFiles.Add(path);
+        return path;
+    }
+
+    private const uint TextRVA = 0x1000;
+    private const uint DataRVA = 0x5000;
+
+    // Two sections, a "real" compiland with a function, a static local and a global, the linker's module, and some public symbols.
+    private static TestPDBBuilder CreateBuilder(uint blockSize = 512)
+    {
+        var builder = new TestPDBBuilder() { BlockSize = blockSize, Age = 3 };
+        builder.Sections.Add((".text", TextRVA, 0x2000));
+        builder.Sections.Add((".data", DataRVA, 0x1000));
+
+        var compiland = builder.AddModule(@"c:\src\a.obj");
+        compiland.Symbols.Add(TestPDBBuilder.Compile3(CompilandLanguage.CV_CFL_CXX, "Microsoft (R) Optimizing Compiler"));
+        compiland.Symbols.Add(TestPDBBuilder.Proc32(isGlobal: true, segment: 1, offset: 0x100, length: 0x40, "Foo"));
+        compiland.Symbols.Add(TestPDBBuilder.Data32(isGlobal: false, segment: 2, offset: 0x10, "s_staticLocal"));
+        compiland.Symbols.Add(TestPDBBuilder.End());
+        compiland.Symbols.Add(TestPDBBuilder.Data32(isGlobal: true, segment: 2, offset: 0x20, "g_global"));
+
+        builder.AddModule(ManagedPDBFile.LinkerModuleName, String.Empty);
+
+        builder.SectionContributions.Add((1, 0x100, 0x40, 0));
+        builder.SectionContributions.Add((2, 0x10, 0x20, 0));
+        builder.SectionContributions.Add((1, 0x200, 0x10, 1));
+
+        builder.GlobalSymbols.Add(TestPDBBuilder.Pub32(isCode: true, segment: 1, offset: 0x100, "?Foo@@YAXXZ"));
+        builder.GlobalSymbols.Add(TestPDBBuilder.Pub32(isCode: true, segment: 1, offset: 0x200, "?Bar@@YAXXZ"));
+        builder.GlobalSymbols.Add(TestPDBBuilder.Pub32(isCode: false, segment: 0, offset: 7, "__guard_fids_count"));
+        // Globals show up in the global symbol records too, but they should only be counted once.
+        builder.GlobalSymbols.Add(TestPDBBuilder.Data32(isGlobal: true, segment: 2, offset: 0x20, "g_global"));
+        return builder;
+    }
+
+    #region MSF container
+
+    [TestMethod]
+    public void SuperblockAndStreamDirectoryAreRead()
+    {
+        var builder = CreateBuilder();
+        var streams = builder.BuildStreams();
+        using var msf = new MSFFile(WriteToTempFile(builder.Build()));
+
+        Assert.AreEqual(512u, msf.BlockSize);
+        Assert.AreEqual(streams.Count, msf.StreamCount);
+        for (var i = 0; i < streams.Count; i++)
+        {
+            CollectionAssert.AreEqual(streams[i], msf.ReadStream((ushort)i), $"Stream {i}");
+        }
+
+        Assert.IsFalse(msf.StreamExists(MSFFile.NilStreamIndex));
+        Assert.IsFalse(msf.StreamExists((ushort)streams.Count));
+        Assert.IsEmpty(msf.ReadStream((ushort)streams.Count));
+    }
+
+    [TestMethod]
+    public void StreamsAndTheDirectoryCanSpanManyBlocks()
+    {
+        // Enough modules that the directory needs more than one 512-byte block, and a module stream bigger than a block too.
+        var builder = CreateBuilder();
+        for (var i = 0; i < 200; i++)
+        {
+            var module = builder.AddModule($"m{i}.obj");
+            module.Symbols.Add(TestPDBBuilder.Data32(isGlobal: false, segment: 2, offset: (uint)(0x100 + (i * 4)), new string('x', 600)));
+        }
+
+        var streams = builder.BuildStreams();
+        using var msf = new MSFFile(WriteToTempFile(builder.Build()));
+
+        Assert.AreEqual(streams.Count, msf.StreamCount);
+        for (var i = 0; i < streams.Count; i++)
+        {
+            CollectionAssert.AreEqual(streams[i], msf.ReadStream((ushort)i), $"Stream {i}");
+        }
+    }
+
+    [TestMethod]
+    public void InfoStreamHasTheGuidAndAge()
+    {
+        var builder = CreateBuilder();
+        using var pdb = new ManagedPDBFile(WriteToTempFile(builder.Build()));
+
+        Assert.AreEqual(builder.Guid, pdb.InfoStream.Guid);
+        Assert.AreEqual(3u, pdb.InfoStream.Age);
+        Assert.AreEqual(3u, pdb.DBI.Age);
+    }
+
+    #endregion
+
+    #region DBI
+
+    [TestMethod]
+    public void ModulesAndSectionContributionsAreRead()
+    {
+        using var pdb = new ManagedPDBFile(WriteToTempFile(CreateBuilder().Build()));
+
+        Assert.HasCount(2, pdb.DBI.Modules);
+        Assert.AreEqual(@"c:\src\a.obj", pdb.DBI.Modules[0].ModuleName);
+        Assert.AreEqual(ManagedPDBFile.LinkerModuleName, pdb.DBI.Modules[1].ModuleName);
+        Assert.IsTrue(pdb.HasLinkerModule);
+        Assert.AreEqual(TestPDBBuilder.SymbolRecordStreamIndex, pdb.DBI.SymbolRecordStreamIndex);
+        Assert.AreEqual(TestPDBBuilder.SectionHeaderStreamIndex, pdb.DBI.SectionHeaderStreamIndex);
+        Assert.IsFalse(pdb.DBI.HasOmapStreams);
+
+        Assert.HasCount(3, pdb.DBI.SectionContributions);
+        Assert.AreEqual(new PDBSectionContribution(2, 0x10, 0x20, 0x60000020, 0), pdb.DBI.SectionContributions[1]);
+
+        Assert.HasCount(2, pdb.SectionHeaders);
+        Assert.AreEqual(DataRVA, pdb.SectionHeaders[1].VirtualAddress);
+        Assert.AreEqual(0x1000u, pdb.SectionHeaders[1].VirtualSize);
+    }
+
+    [TestMethod]
+    public void SectionContributionsFindTheModuleForAnRVA()
+    {
+        using var pdb = new ManagedPDBFile(WriteToTempFile(CreateBuilder().Build()));
+
+        Assert.IsTrue(pdb.TryFindModuleIndexContributingRVA(TextRVA + 0x100, out var moduleIndex));
+        Assert.AreEqual(0, moduleIndex);
+        Assert.IsTrue(pdb.TryFindModuleIndexContributingRVA(TextRVA + 0x13F, out moduleIndex));
+        Assert.AreEqual(0, moduleIndex);
+        Assert.IsTrue(pdb.TryFindModuleIndexContributingRVA(DataRVA + 0x2F, out moduleIndex));
+        Assert.AreEqual(0, moduleIndex);
+        Assert.IsTrue(pdb.TryFindModuleIndexContributingRVA(TextRVA + 0x205, out moduleIndex));
+        Assert.AreEqual(1, moduleIndex);
+
+        Assert.IsFalse(pdb.TryFindModuleIndexContributingRVA(TextRVA + 0x140, out _));
+        Assert.IsFalse(pdb.TryFindModuleIndexContributingRVA(0, out _));
+        Assert.IsFalse(pdb.TryFindModuleIndexContributingRVA(UInt32.MaxValue, out _));
+    }
+
+    #endregion
+
+    #region Symbol streams
+
+    [TestMethod]
+    public void ModuleSymbolsAreRead()
+    {
+        using var pdb = new ManagedPDBFile(WriteToTempFile(CreateBuilder().Build()));
+        var compilandSymIndexId = ManagedPDBFile.CompilandSymIndexIdFromModuleIndex(0);
+
+        var details = pdb.GetCompilandDetails(compilandSymIndexId);
+        Assert.AreEqual(CompilandLanguage.CV_CFL_CXX, details.Language);
+        Assert.AreEqual("Microsoft (R) Optimizing Compiler", details.ToolName);
+        Assert.AreEqual(new Version(19, 40, 33811, 0), details.FrontEndVersion);
+
+        var function = pdb.FindSymbolsByName("Foo").Single();
+        Assert.AreEqual(PDBSymbolKind.Function, function.Kind);
+        Assert.AreEqual(TextRVA + 0x100, function.RVA);
+        Assert.AreEqual(0x40u, function.Length);
+        Assert.AreEqual(compilandSymIndexId, function.CompilandSymIndexId);
+        Assert.IsTrue(function.IsGlobal);
+
+        var staticLocal = pdb.FindSymbolsByName("s_staticLocal").Single();
+        Assert.AreEqual(PDBSymbolKind.Data, staticLocal.Kind);
+        Assert.AreEqual(function.SymIndexId, staticLocal.ParentFunctionSymIndexId);
+        Assert.IsFalse(staticLocal.IsGlobal);
+
+        // S_END closed Foo, so this is at module scope.
+        var global = pdb.FindSymbolsByName("g_global").Single();
+        Assert.AreEqual(0u, global.ParentFunctionSymIndexId);
+        Assert.AreEqual(DataRVA + 0x20, global.RVA);
+
+        CollectionAssert.AreEqual(new[] { staticLocal, global }, pdb.GetDataSymbolsInCompiland(compilandSymIndexId).ToArray());
+        Assert.IsEmpty(pdb.GetDataSymbolsInCompiland(ManagedPDBFile.CompilandSymIndexIdFromModuleIndex(1)));
+        Assert.IsEmpty(pdb.GetDataSymbolsInCompiland(0));
+    }
+
+    [TestMethod]
+    public void PublicSymbolsAreReadFromTheSymbolRecordsStream()
+    {
+        using var pdb = new ManagedPDBFile(WriteToTempFile(CreateBuilder().Build()));
+
+        var foo = pdb.FindSymbolsByName("?Foo@@YAXXZ").Single();
+        Assert.AreEqual(PDBSymbolKind.PublicSymbol, foo.Kind);
+        Assert.AreEqual(TextRVA + 0x100, foo.RVA);
+        Assert.IsTrue(foo.IsCode);
+        Assert.AreEqual(0u, foo.CompilandSymIndexId);
+
+        // Public symbols are sized up to the next thing that starts after them - for Foo that's Bar, and for Bar it's the end of .text.
+        Assert.AreEqual(0x100u, foo.Length);
+        Assert.AreEqual(0x2000u - 0x200u, pdb.FindSymbolsByName("?Bar@@YAXXZ").Single().Length);
+
+        // Absolute symbols aren't at an RVA at all, their value is the data.
+        Assert.IsEmpty(pdb.FindSymbolsByName("__guard_fids_count"));
+        Assert.IsTrue(pdb.TryGetAbsolutePublicSymbolValue("__guard_fids_count", out var value));
+        Assert.AreEqual(7u, value);
+        Assert.IsFalse(pdb.TryGetAbsolutePublicSymbolValue("__guard_iat_count", out _));
+
+        Assert.IsEmpty(pdb.FindSymbolsByName("NotInThePDB"));
+    }
+
+    [TestMethod]
+    public void SymIndexIdsComeAfterTheCompilands()
+    {
+        using var pdb = new ManagedPDBFile(WriteToTempFile(CreateBuilder().Build()));
+
+        Assert.IsTrue(pdb.IsCompilandSymIndexId(1));
+        Assert.IsTrue(pdb.IsCompilandSymIndexId(2));
+        Assert.IsFalse(pdb.IsCompilandSymIndexId(3));
+
+        Assert.AreEqual(3u, pdb.Symbols[0].SymIndexId);
+        foreach (var symbol in pdb.Symbols)
+        {
+            Assert.AreSame(symbol, pdb.GetSymbol(symbol.SymIndexId));
+        }
+
+        Assert.IsFalse(pdb.TryGetSymbol(2, out _));
+        Assert.IsFalse(pdb.TryGetSymbol((uint)(pdb.Symbols.Count + 3), out _));
+    }
+
+    [TestMethod]
+    public void FindSymbolByRVAPrefersExactMatchesThatArentPublicSymbols()
+    {
+        using var pdb = new ManagedPDBFile(WriteToTempFile(CreateBuilder().Build()));
+
+        // Foo and ?Foo@@YAXXZ are both at this RVA - the function is more descriptive.
+        Assert.AreEqual("Foo", pdb.FindSymbolByRVA(TextRVA + 0x100, allowFindingNearest: false)?.Name);
+        Assert.AreEqual("?Bar@@YAXXZ", pdb.FindSymbolByRVA(TextRVA + 0x200, allowFindingNearest: false)?.Name);
+
+        // Inside Foo, nearest finds the function that covers it (Foo's public symbol is longer, but starts at the same RVA and comes later).
+        Assert.IsNull(pdb.FindSymbolByRVA(TextRVA + 0x110, allowFindingNearest: false));
+        Assert.AreEqual("Foo", pdb.FindSymbolByRVA(TextRVA + 0x110, allowFindingNearest: true)?.Name);
+
+        // Past Foo's end only its public symbol still covers the RVA.
+        Assert.AreEqual("?Foo@@YAXXZ", pdb.FindSymbolByRVA(TextRVA + 0x150, allowFindingNearest: true)?.Name);
+
+        // Data symbols have no length here, so they only match exactly - and nothing covers the start of .text.
+        Assert.AreEqual("g_global", pdb.FindSymbolByRVA(DataRVA + 0x20, allowFindingNearest: true)?.Name);
+        Assert.IsNull(pdb.FindSymbolByRVA(DataRVA + 0x21, allowFindingNearest: true));
+        Assert.IsNull(pdb.FindSymbolByRVA(TextRVA, allowFindingNearest: true));
+    }
+
+    #endregion
+
+    #region Malformed and truncated input
+
+    [TestMethod]
+    public void NotAnMSFFileIsRejected()
+    {
+        var path = WriteToTempFile("Microsoft C/C++ program database 2.00\r\n\u001AJG\0\0"u8.ToArray());
+        Assert.ThrowsExactly<PDBNotSuitableForAnalysisException>(() => new MSFFile(path));
+
+        path = WriteToTempFile(Array.Empty<byte>());
+        Assert.ThrowsExactly<PDBNotSuitableForAnalysisException>(() => new MSFFile(path));
+    }
+
+    [TestMethod]
+    public void UnexpectedBlockSizeIsRejected()
+    {
+        var pdbBytes = CreateBuilder().Build();
+        BinaryPrimitives.WriteUInt32LittleEndian(pdbBytes.AsSpan(32), 1000);
+
+        var path = WriteToTempFile(pdbBytes);
+        Assert.ThrowsExactly<PDBNotSuitableForAnalysisException>(() => new MSFFile(path));
+    }
+
+    [TestMethod]
+    public void TruncatedFileIsRejected()
+    {
+        var pdbBytes = CreateBuilder().Build();
+
+        // Cutting off the last block loses the block map, and cutting halfway loses some of the streams.
+        foreach (var length in new[] { pdbBytes.Length - 512, pdbBytes.Length / 2, 100 })
+        {
+            var path = WriteToTempFile(pdbBytes[..length]);
+            Assert.ThrowsExactly<PDBNotSuitableForAnalysisException>(() => new ManagedPDBFile(path), $"Truncated to {length} bytes");
+        }
+    }
+
+    [TestMethod]
+    public void StreamDirectoryThatOverrunsItselfIsRejected()
+    {
+        var pdbBytes = CreateBuilder().Build();
+
+        // Claim far more streams than the directory has room to describe.
+        var blockMapAddress = BinaryPrimitives.ReadUInt32LittleEndian(pdbBytes.AsSpan(52));
+        var firstDirectoryBlock = BinaryPrimitives.ReadUInt32LittleEndian(pdbBytes.AsSpan((int)(blockMapAddress * 512)));
+        BinaryPrimitives.WriteUInt32LittleEndian(pdbBytes.AsSpan((int)(firstDirectoryBlock * 512)), 100_000);
+
+        var path = WriteToTempFile(pdbBytes);
+        Assert.ThrowsExactly<PDBNotSuitableForAnalysisException>(() => new MSFFile(path));
+    }
+
+    [TestMethod]
+    public void MissingOrTruncatedRequiredStreamsAreRejected()
+    {
+        var streams = CreateBuilder().BuildStreams();
+
+        var withoutInfo = new List<byte[]>(streams) { [PDBInfoStream.StreamIndex] = new byte[10] };
+        var path = WriteToTempFile(TestPDBBuilder.BuildMSF(withoutInfo, 512));
+        Assert.ThrowsExactly<PDBNotSuitableForAnalysisException>(() => new ManagedPDBFile(path));
+
+        var withShortDBI = new List<byte[]>(streams) { [DBIStream.StreamIndex] = streams[DBIStream.StreamIndex][..40] };
+        path = WriteToTempFile(TestPDBBuilder.BuildMSF(withShortDBI, 512));
+        Assert.ThrowsExactly<PDBNotSuitableForAnalysisException>(() => new ManagedPDBFile(path));
+    }
+
+    [TestMethod]
+    public void DBISubstreamSizesThatOverrunTheStreamAreRejected()
+    {
+        var streams = CreateBuilder().BuildStreams();
+
+        // The module info size is at offset 24 of the DBI header - make it run off the end of the stream.
+        var dbi = (byte[])streams[DBIStream.StreamIndex].Clone();
+        BinaryPrimitives.WriteInt32LittleEndian(dbi.AsSpan(24), dbi.Length);
+        var path = WriteToTempFile(TestPDBBuilder.BuildMSF(new List<byte[]>(streams) { [DBIStream.StreamIndex] = dbi }, 512));
+        Assert.ThrowsExactly<PDBNotSuitableForAnalysisException>(() => new ManagedPDBFile(path));
+
+        // And a negative section contribution size.
+        dbi = (byte[])streams[DBIStream.StreamIndex].Clone();
+        BinaryPrimitives.WriteInt32LittleEndian(dbi.AsSpan(28), -4);
+        path = WriteToTempFile(TestPDBBuilder.BuildMSF(new List<byte[]>(streams) { [DBIStream.StreamIndex] = dbi }, 512));
+        Assert.ThrowsExactly<PDBNotSuitableForAnalysisException>(() => new ManagedPDBFile(path));
+    }
+
+    [TestMethod]
+    public void SymbolRecordsCutOffPartWayAreRejected()
+    {
+        // A record whose length covers its kind but not the fields every S_PUB32 must have.
+        var builder = CreateBuilder();
+        builder.GlobalSymbols.Add(TestPDBBuilder.Record(CodeViewSymbolKind.S_PUB32, w => w.Write((ushort)0)));
+
+        var path = WriteToTempFile(builder.Build());
+        Assert.ThrowsExactly<PDBNotSuitableForAnalysisException>(() => new ManagedPDBFile(path));
+    }
+
+    [TestMethod]
+    public void SymbolStreamEndingMidRecordStopsAtTheLastWholeRecord()
+    {
+        var streams = CreateBuilder().BuildStreams();
+        var symbolRecords = streams[TestPDBBuilder.SymbolRecordStreamIndex];
+
+        // Chop the last record (g_global's duplicate) in half - the records before it are still fine to use.
+        var path = WriteToTempFile(TestPDBBuilder.BuildMSF(new List<byte[]>(streams) { [TestPDBBuilder.SymbolRecordStreamIndex] = symbolRecords[..^8] }, 512));
+        using var pdb = new ManagedPDBFile(path);
+
+        Assert.HasCount(1, pdb.FindSymbolsByName("?Bar@@YAXXZ"));
+        Assert.HasCount(1, pdb.FindSymbolsByName("g_global"));
+    }
+
+    #endregion
+}
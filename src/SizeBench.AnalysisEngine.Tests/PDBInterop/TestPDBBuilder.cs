@@ -0,0 +1,350 @@
+﻿using System.Buffers.Binary;
+using System.IO;
+using System.Text;
+using SizeBench.AnalysisEngine.DIAInterop;
+using SizeBench.AnalysisEngine.PDBInterop;
+
+namespace SizeBench.AnalysisEngine.Tests;
+
+// Writes small but well-formed MSF 7.00 PDBs, so the managed PDB reader can be tested against exactly-known contents (and against
+// deliberately broken ones) without needing DIA, a linker, or any of the checked-in test binaries.
+//
+// The stream layout follows what link.exe produces: 0 is the old directory, 1 is the PDB info stream, 2 the TPI, 3 the DBI, 4 the IPI,
+// and everything after that is whatever the DBI stream points at - here that's the symbol records, the section headers, and then one
+// stream for each module.
+internal sealed class TestPDBBuilder
+{
+    public const ushort SymbolRecordStreamIndex = 5;
+    public const ushort SectionHeaderStreamIndex = 6;
+    private const ushort FirstModuleStreamIndex = 7;
+
+    internal sealed class Module
+    {
+        public string Name { get; init; } = String.Empty;
+        public string ObjFileName { get; init; } = String.Empty;
+        public List<byte[]> Symbols { get; } = new List<byte[]>();
+    }
+
+    public uint BlockSize { get; init; } = 512;
+    public Guid Guid { get; init; } = new Guid("8B2A6E3C-0F1D-4C8E-9A7B-5D4E3F2A1B0C");
+    public uint Age { get; init; } = 1;
+
+    public List<(string Name, uint VirtualAddress, uint VirtualSize)> Sections { get; } = new List<(string, uint, uint)>();
+    public List<Module> Modules { get; } = new List<Module>();
+    public List<(ushort Section, uint Offset, uint Size, ushort ModuleIndex)> SectionContributions { get; } = new List<(ushort, uint, uint, ushort)>();
+    public List<byte[]> GlobalSymbols { get; } = new List<byte[]>();
+
+    public Module AddModule(string name, string? objFileName = null)
+    {
+        var module = new Module() { Name = name, ObjFileName = objFileName ?? name };
+        this.Modules.Add(module);
+        return module;
+    }
+
+    #region Symbol records
+
+    public static byte[] Pub32(bool isCode, ushort segment, uint offset, string name)
+        => Record(CodeViewSymbolKind.S_PUB32, w =>
+        {
+            w.Write(isCode ? 1u : 0u);
+            w.Write(offset);
+            w.Write(segment);
+            WriteString(w, name);
+        });
+
+    public static byte[] Data32(bool isGlobal, ushort segment, uint offset, string name, uint typeIndex = 0x74 /* T_INT4 */)
+        => Record(isGlobal ? CodeViewSymbolKind.S_GDATA32 : CodeViewSymbolKind.S_LDATA32, w =>
+        {
+            w.Write(typeIndex);
+            w.Write(offset);
+            w.Write(segment);
+            WriteString(w, name);
+        });
+
+    public static byte[] Proc32(bool isGlobal, ushort segment, uint offset, uint length, string name)
+        => Record(isGlobal ? CodeViewSymbolKind.S_GPROC32 : CodeViewSymbolKind.S_LPROC32, w =>
+        {
+            w.Write(0u); // Parent
+            w.Write(0u); // End
+            w.Write(0u); // Next
+            w.Write(length);
+            w.Write(0u); // DbgStart
+            w.Write(0u); // DbgEnd
+            w.Write(0u); // TypeIndex
+            w.Write(offset);
+            w.Write(segment);
+            w.Write((byte)0); // Flags
+            WriteString(w, name);
+        });
+
+    public static byte[] End() => Record(CodeViewSymbolKind.S_END, _ => { });
+
+    public static byte[] Compile3(CompilandLanguage language, string toolName)
+        => Record(CodeViewSymbolKind.S_COMPILE3, w =>
+        {
+            w.Write((uint)language);
+            w.Write((ushort)0xD0); // Machine - x64
+            foreach (var versionPart in new ushort[] { 19, 40, 33811, 0, 19, 40, 33811, 0 })
+            {
+                w.Write(versionPart);
+            }
+            WriteString(w, toolName);
+        });
+
+    public static byte[] Record(CodeViewSymbolKind kind, Action<BinaryWriter> writeData)
+    {
+        using var data = new MemoryStream();
+        using (var w = new BinaryWriter(data, Encoding.UTF8, leaveOpen: true))
+        {
+            writeData(w);
+            // Records are padded to 4 bytes, like the linker does.
+            while ((data.Length + 4) % 4 != 0)
+            {
+                w.Write((byte)0);
+            }
+        }
+
+        var record = new byte[4 + data.Length];
+        BinaryPrimitives.WriteUInt16LittleEndian(record, (ushort)(data.Length + sizeof(ushort)));
+        BinaryPrimitives.WriteUInt16LittleEndian(record.AsSpan(2), (ushort)kind);
+        data.ToArray().CopyTo(record, 4);
+        return record;
+    }
+
+    private static void WriteString(BinaryWriter w, string s)
+    {
+        w.Write(Encoding.UTF8.GetBytes(s));
+        w.Write((byte)0);
+    }
+
+    #endregion
+
+    #region Streams
+
+    private byte[] BuildInfoStream()
+    {
+        using var stream = new MemoryStream();
+        using var w = new BinaryWriter(stream);
+        w.Write(20000404u); // VC70
+        w.Write(0u); // Signature
+        w.Write(this.Age);
+        w.Write(this.Guid.ToByteArray());
+        w.Write(0u); // Named stream map, empty
+        w.Flush();
+        return stream.ToArray();
+    }
+
+    private byte[] BuildDBIStream()
+    {
+        using var moduleInfo = new MemoryStream();
+        using (var w = new BinaryWriter(moduleInfo, Encoding.UTF8, leaveOpen: true))
+        {
+            for (var i = 0; i < this.Modules.Count; i++)
+            {
+                w.Write(0u); // Unused1
+                w.Write(new byte[28]); // SectionContribEntry
+                w.Write((ushort)0); // Flags
+                w.Write((ushort)(FirstModuleStreamIndex + i));
+                w.Write((uint)(sizeof(uint) + this.Modules[i].Symbols.Sum(static s => s.Length)));
+                w.Write(0u); // C11ByteSize
+                w.Write(0u); // C13ByteSize
+                w.Write((ushort)0); // SourceFileCount
+                w.Write((ushort)0); // Padding
+                w.Write(0u); // Unused2
+                w.Write(0u); // SourceFileNameIndex
+                w.Write(0u); // PdbFilePathNameIndex
+                WriteString(w, this.Modules[i].Name);
+                WriteString(w, this.Modules[i].ObjFileName);
+                while (moduleInfo.Length % 4 != 0)
+                {
+                    w.Write((byte)0);
+                }
+            }
+        }
+
+        using var sectionContributions = new MemoryStream();
+        using (var w = new BinaryWriter(sectionContributions, Encoding.UTF8, leaveOpen: true))
+        {
+            w.Write(0xEFFE0000 + 19970605); // V60
+            foreach (var (section, offset, size, moduleIndex) in this.SectionContributions)
+            {
+                w.Write(section);
+                w.Write((ushort)0); // Padding
+                w.Write(offset);
+                w.Write(size);
+                w.Write(0x60000020u); // Characteristics
+                w.Write(moduleIndex);
+                w.Write((ushort)0); // Padding
+                w.Write(0u); // DataCrc
+                w.Write(0u); // RelocCrc
+            }
+        }
+
+        // 11 optional debug streams, of which only the section headers are present.
+        var optionalDebugHeader = Enumerable.Repeat(MSFFile.NilStreamIndex, 11).ToArray();
+        optionalDebugHeader[5] = SectionHeaderStreamIndex;
+
+        using var stream = new MemoryStream();
+        using var writer = new BinaryWriter(stream);
+        writer.Write(-1); // VersionSignature
+        writer.Write(19990903u); // VersionHeader
+        writer.Write(this.Age);
+        writer.Write(MSFFile.NilStreamIndex); // GlobalStreamIndex
+        writer.Write((ushort)0x8E00); // BuildNumber
+        writer.Write(MSFFile.NilStreamIndex); // PublicStreamIndex
+        writer.Write((ushort)0); // PdbDllVersion
+        writer.Write(SymbolRecordStreamIndex);
+        writer.Write((ushort)0); // PdbDllRbld
+        writer.Write((int)moduleInfo.Length);
+        writer.Write((int)sectionContributions.Length);
+        writer.Write(0); // SectionMapSize
+        writer.Write(0); // SourceInfoSize
+        writer.Write(0); // TypeServerMapSize
+        writer.Write(0u); // MFCTypeServerIndex
+        writer.Write(optionalDebugHeader.Length * sizeof(ushort));
+        writer.Write(0); // ECSubstreamSize
+        writer.Write((ushort)0); // Flags
+        writer.Write((ushort)0x8664); // Machine
+        writer.Write(0u); // Padding
+        writer.Write(moduleInfo.ToArray());
+        writer.Write(sectionContributions.ToArray());
+        foreach (var streamIndex in optionalDebugHeader)
+        {
+            writer.Write(streamIndex);
+        }
+        writer.Flush();
+        return stream.ToArray();
+    }
+
+    private byte[] BuildSectionHeaderStream()
+    {
+        using var stream = new MemoryStream();
+        using var w = new BinaryWriter(stream);
+        foreach (var (name, virtualAddress, virtualSize) in this.Sections)
+        {
+            var nameBytes = new byte[8];
+            Encoding.ASCII.GetBytes(name).AsSpan(0, Math.Min(name.Length, 8)).CopyTo(nameBytes);
+            w.Write(nameBytes);
+            w.Write(virtualSize);
+            w.Write(virtualAddress);
+            w.Write(virtualSize); // SizeOfRawData
+            w.Write(virtualAddress); // PointerToRawData
+            w.Write(0u); // PointerToRelocations
+            w.Write(0u); // PointerToLinenumbers
+            w.Write((ushort)0); // NumberOfRelocations
+            w.Write((ushort)0); // NumberOfLinenumbers
+            w.Write(0x40000040u); // Characteristics
+        }
+        w.Flush();
+        return stream.ToArray();
+    }
+
+    private static byte[] Concat(IEnumerable<byte[]> records, bool withCodeViewSignature)
+    {
+        using var stream = new MemoryStream();
+        if (withCodeViewSignature)
+        {
+            stream.Write(BitConverter.GetBytes(4u)); // CV_SIGNATURE_C13
+        }
+
+        foreach (var record in records)
+        {
+            stream.Write(record);
+        }
+
+        return stream.ToArray();
+    }
+
+    public List<byte[]> BuildStreams()
+    {
+        var streams = new List<byte[]>
+        {
+            Array.Empty<byte>(), // Old directory
+            BuildInfoStream(),
+            Array.Empty<byte>(), // TPI
+            BuildDBIStream(),
+            Array.Empty<byte>(), // IPI
+            Concat(this.GlobalSymbols, withCodeViewSignature: false),
+            BuildSectionHeaderStream(),
+        };
+
+        foreach (var module in this.Modules)
+        {
+            streams.Add(Concat(module.Symbols, withCodeViewSignature: true));
+        }
+
+        return streams;
+    }
+
+    #endregion
+
+    #region MSF container
+
+    public byte[] Build() => BuildMSF(BuildStreams(), this.BlockSize);
+
+    // Block 0 is the superblock and blocks 1 and 2 are the free block maps (which readers don't need), so the streams start at block 3,
+    // each one in consecutive blocks.  After them comes the stream directory, and then the block that lists where the directory is.
+    public static byte[] BuildMSF(IReadOnlyList<byte[]> streams, uint blockSize)
+    {
+        var blocks = new List<byte[]> { Array.Empty<byte>(), Array.Empty<byte>(), Array.Empty<byte>() };
+
+        List<uint> AddBlocks(byte[] data)
+        {
+            var blockNumbers = new List<uint>();
+            for (var offset = 0; offset < data.Length; offset += (int)blockSize)
+            {
+                blockNumbers.Add((uint)blocks.Count);
+                blocks.Add(data.AsSpan(offset, Math.Min((int)blockSize, data.Length - offset)).ToArray());
+            }
+            return blockNumbers;
+        }
+
+        var blocksOfEachStream = streams.Select(AddBlocks).ToList();
+
+        using var directory = new MemoryStream();
+        using (var w = new BinaryWriter(directory, Encoding.UTF8, leaveOpen: true))
+        {
+            w.Write((uint)streams.Count);
+            foreach (var stream in streams)
+            {
+                w.Write((uint)stream.Length);
+            }
+            foreach (var blockNumber in blocksOfEachStream.SelectMany(static b => b))
+            {
+                w.Write(blockNumber);
+            }
+        }
+
+        var directoryBytes = directory.ToArray();
+        var directoryBlocks = AddBlocks(directoryBytes);
+        var blockMapAddress = (uint)blocks.Count;
+        blocks.Add(directoryBlocks.SelectMany(BitConverter.GetBytes).ToArray());
+
+        var file = new byte[blocks.Count * blockSize];
+        "Microsoft C/C++ MSF 7.00\r\n\u001ADS\0\0\0"u8.CopyTo(file);
+        var superBlockFields = file.AsSpan(32);
+        BinaryPrimitives.WriteUInt32LittleEndian(superBlockFields, blockSize);
+        BinaryPrimitives.WriteUInt32LittleEndian(superBlockFields[4..], 1); // FreeBlockMapBlock
+        BinaryPrimitives.WriteUInt32LittleEndian(superBlockFields[8..], (uint)blocks.Count);
+        BinaryPrimitives.WriteUInt32LittleEndian(superBlockFields[12..], (uint)directoryBytes.Length);
+        BinaryPrimitives.WriteUInt32LittleEndian(superBlockFields[20..], blockMapAddress);
+
+        for (var i = 3; i < blocks.Count; i++)
+        {
+            blocks[i].CopyTo(file, i * blockSize);
+        }
+
+        return file;
+    }
+
+    #endregion
+
+    public string WriteToTempFile() => WriteToTempFile(Build());
+
+    public static string WriteToTempFile(byte[] pdbBytes)
+    {
+        var path = Path.Combine(Path.GetTempPath(), $"SizeBench.TestPDB.{Guid.NewGuid():N}.pdb");
+        File.WriteAllBytes(path, pdbBytes);
+        return path;
+    }
+}
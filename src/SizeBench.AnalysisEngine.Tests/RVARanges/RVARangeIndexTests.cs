@@ -0,0 +1,49 @@
+﻿namespace SizeBench.AnalysisEngine.Tests;
+
+[TestClass]
+public class RVARangeIndexTests
+{
+    private sealed record class Owner(string Name, RVARange[] Ranges);
+
+    private static readonly Owner First = new Owner("first", [new RVARange(100, 199), new RVARange(500, 599)]);
+    private static readonly Owner Second = new Owner("second", [new RVARange(200, 299)]);
+    // Overlaps both of the others, and comes last, so it should only be found where they don't contain the queried range.
+    private static readonly Owner Wide = new Owner("wide", [new RVARange(0, 1000)]);
+
+    private static RVARangeIndex<Owner> CreateIndex()
+        => new RVARangeIndex<Owner>([First, Second, Wide], o => o.Ranges);
+
+    [TestMethod]
+    public void FindsOwnerOfRangeWithInclusiveEnds()
+    {
+        var index = CreateIndex();
+
+        Assert.AreEqual(4, index.Count);
+        Assert.AreSame(First, index.FindFirstOwnerContaining(100, 199));
+        Assert.AreSame(First, index.FindFirstOwnerContaining(550, 560));
+        Assert.AreSame(Second, index.FindFirstOwnerContaining(200, 200));
+        Assert.AreSame(Second, index.FindFirstOwnerContaining(299, 299));
+    }
+
+    [TestMethod]
+    public void EarlierOwnersWinWhenRangesOverlap()
+    {
+        // The same answer a linear scan over the owners in order would give.
+        var index = CreateIndex();
+
+        Assert.AreSame(First, index.FindFirstOwnerContaining(150, 150));
+        Assert.AreSame(Wide, index.FindFirstOwnerContaining(150, 250)); // Spans First and Second, so neither contains all of it
+        Assert.AreSame(Wide, index.FindFirstOwnerContaining(0, 10));
+        Assert.AreSame(Wide, index.FindFirstOwnerContaining(300, 499));
+    }
+
+    [TestMethod]
+    public void RangesContainedByNothingFindNothing()
+    {
+        var index = CreateIndex();
+
+        Assert.IsNull(index.FindFirstOwnerContaining(1001, 1001));
+        Assert.IsNull(index.FindFirstOwnerContaining(900, 1100));
+        Assert.IsNull(new RVARangeIndex<Owner>([], o => o.Ranges).FindFirstOwnerContaining(0, 0));
+    }
+}
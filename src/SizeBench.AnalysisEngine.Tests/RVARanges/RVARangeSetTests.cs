@@ -58,6 +58,93 @@ public class RVARangeSetTests
             });
     }
 
+    [TestMethod]
+    public void PartiallyOverlappingRVARangesBeingAddedThrows()
+    {
+        // Neither range contains the other, but they still overlap so this should be rejected just like full containment is.
+        Assert.ThrowsExactly<ArgumentException>(() => new RVARangeSet
+            {
+                new RVARange(100, 200),
+                new RVARange(150, 300)
+            });
+    }
+
+    [TestMethod]
+    public void RangesAreEnumeratedInRVAOrderRegardlessOfInsertionOrder()
+    {
+        var set = new RVARangeSet
+            {
+                new RVARange(400, 500),
+                new RVARange(0, 50),
+                new RVARange(202, 300),
+                new RVARange(100, 200)
+            };
+
+        CollectionAssert.AreEqual(new[] { new RVARange(0, 50), new RVARange(100, 200), new RVARange(202, 300), new RVARange(400, 500) },
+                                  set.ToArray());
+    }
+
+    [TestMethod]
+    public void ContainsAndFullyContainsRespectRangeBoundaries()
+    {
+        var set = new RVARangeSet
+            {
+                new RVARange(100, 200),
+                new RVARange(400, 500),
+                new RVARange(UInt32.MaxValue - 10, UInt32.MaxValue)
+            };
+
+        Assert.IsFalse(set.Contains(0));
+        Assert.IsFalse(set.Contains(99));
+        Assert.IsTrue(set.Contains(100));
+        Assert.IsTrue(set.Contains(200));
+        Assert.IsFalse(set.Contains(201));
+        Assert.IsFalse(set.Contains(399));
+        Assert.IsTrue(set.Contains(UInt32.MaxValue));
+
+        Assert.IsTrue(set.FullyContains(100, 101));
+        Assert.IsFalse(set.FullyContains(100, 102));
+        Assert.IsFalse(set.FullyContains(150, 300)); // Spans the gap between (100, 200) and (400, 500)
+        Assert.IsTrue(set.FullyContains(new RVARange(450, 500)));
+        Assert.IsFalse(set.FullyContains(new RVARange(450, 501)));
+        Assert.IsFalse(set.FullyContains(new RVARange(50, 150)));
+    }
+
+    [TestMethod]
+    public void AtLeastPartiallyOverlapsWithReturnsFalseForGaps()
+    {
+        var set = new RVARangeSet
+            {
+                new RVARange(100, 200),
+                new RVARange(400, 500)
+            };
+
+        Assert.IsFalse(set.AtLeastPartiallyOverlapsWith(new RVARange(0, 99)));
+        Assert.IsFalse(set.AtLeastPartiallyOverlapsWith(new RVARange(201, 399)));
+        Assert.IsFalse(set.AtLeastPartiallyOverlapsWith(new RVARange(501, 1000)));
+        Assert.IsFalse(new RVARangeSet().AtLeastPartiallyOverlapsWith(new RVARange(0, UInt32.MaxValue)));
+    }
+
+    [TestMethod]
+    public void UnionWithToleratesRangesPresentInBothSets()
+    {
+        var set = new RVARangeSet
+            {
+                new RVARange(100, 200),
+                new RVARange(400, 500)
+            };
+
+        var set2 = new RVARangeSet
+            {
+                new RVARange(100, 200),
+                new RVARange(600, 700)
+            };
+
+        set.UnionWith(set2);
+
+        CollectionAssert.AreEqual(new[] { new RVARange(100, 200), new RVARange(400, 500), new RVARange(600, 700) }, set.ToArray());
+    }
+
     [TestMethod]
     public void UnionWithWorks()
     {
@@ -127,6 +214,9 @@ public class RVARangeSetTests
             };
 
         Assert.ThrowsExactly<ArgumentException>(() => set.UnionWith(set2)); // Should throw because of the overlapping set
+
+        // And the set should be left as it was before the failed union
+        CollectionAssert.AreEqual(new[] { new RVARange(100, 200), new RVARange(400, 500) }, set.ToArray());
     }
 
     [TestMethod]
@@ -0,0 +1,68 @@
+﻿namespace SizeBench.AnalysisEngine.Tests;
+
+[TestClass]
+public class SymIndicesByRVATests
+{
+    private static SymIndicesByRVA CreateIndex()
+        => new SymIndicesByRVA(new Dictionary<uint, List<uint>>
+        {
+            // Deliberately not in RVA order, since a Dictionary makes no promises about that anyway.
+            { 300, [7] },
+            { 100, [1, 2, 3] },
+            { 200, [4, 5] },
+            { 400, [] },
+        });
+
+    [TestMethod]
+    public void RVAsAreSortedAndSymIndicesStayWithTheirRVA()
+    {
+        var index = CreateIndex();
+
+        Assert.AreEqual(4, index.Count);
+        CollectionAssert.AreEqual(new uint[] { 100, 200, 300, 400 }, Enumerable.Range(0, index.Count).Select(index.RVAAt).ToArray());
+        CollectionAssert.AreEqual(new uint[] { 1, 2, 3 }, index.SymIndicesAt(0).ToArray());
+        CollectionAssert.AreEqual(new uint[] { 4, 5 }, index.SymIndicesAt(1).ToArray());
+        CollectionAssert.AreEqual(new uint[] { 7 }, index.SymIndicesAt(2).ToArray());
+        Assert.IsEmpty(index.SymIndicesAt(3));
+    }
+
+    [TestMethod]
+    public void TryFindIndexRangeTreatsRVAEndAsInclusive()
+    {
+        var index = CreateIndex();
+
+        Assert.IsTrue(index.TryFindIndexRange(new RVARange(0, 100), out var minIdx, out var maxIdx));
+        Assert.AreEqual(0, minIdx);
+        Assert.AreEqual(0, maxIdx);
+
+        Assert.IsTrue(index.TryFindIndexRange(new RVARange(100, 300), out minIdx, out maxIdx));
+        Assert.AreEqual(0, minIdx);
+        Assert.AreEqual(2, maxIdx);
+
+        Assert.IsTrue(index.TryFindIndexRange(new RVARange(101, 300), out minIdx, out maxIdx));
+        Assert.AreEqual(1, minIdx);
+        Assert.AreEqual(2, maxIdx);
+    }
+
+    [TestMethod]
+    public void TryFindIndexRangeFindsNothingOutsideOrBetweenRVAs()
+    {
+        var index = CreateIndex();
+
+        Assert.IsFalse(index.TryFindIndexRange(new RVARange(0, 99), out _, out _));
+        Assert.IsFalse(index.TryFindIndexRange(new RVARange(201, 299), out _, out _));
+        Assert.IsFalse(index.TryFindIndexRange(new RVARange(401, 1000), out var minIdx, out var maxIdx));
+        Assert.AreEqual(0, minIdx);
+        Assert.AreEqual(0, maxIdx);
+    }
+
+    [TestMethod]
+    public void TryFindIndexRangeHandlesTheEntireAddressSpace()
+    {
+        var index = CreateIndex();
+
+        Assert.IsTrue(index.TryFindIndexRange(new RVARange(0, UInt32.MaxValue), out var minIdx, out var maxIdx));
+        Assert.AreEqual(0, minIdx);
+        Assert.AreEqual(3, maxIdx);
+    }
+}
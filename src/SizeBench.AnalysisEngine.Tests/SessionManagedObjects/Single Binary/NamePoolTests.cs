@@ -0,0 +1,155 @@
+﻿using SizeBench.AnalysisEngine.Symbols;
+
+namespace SizeBench.AnalysisEngine.Tests;
+
+[TestClass]
+public sealed class NamePoolTests
+{
+    // Names from DIA are always freshly allocated, so the tests need to make sure they aren't comparing two references to the same literal.
+    private static string FreshCopyOf(string name) => new string(name.AsSpan());
+
+    [TestMethod]
+    public void InterningReturnsTheFirstCopyOfEachName()
+    {
+        var pool = new NamePool();
+        var firstThis = FreshCopyOf("this");
+        var secondThis = FreshCopyOf("this");
+        Assert.AreNotSame(firstThis, secondThis);
+
+        Assert.AreSame(firstThis, pool.Intern(firstThis));
+        Assert.AreSame(firstThis, pool.Intern(secondThis));
+        Assert.AreSame(firstThis, pool.Intern(FreshCopyOf("this")));
+
+        var that = FreshCopyOf("that");
+        Assert.AreSame(that, pool.Intern(that));
+        Assert.AreEqual(2, pool.DistinctNameCount);
+    }
+
+    [TestMethod]
+    public void NamesAreCaseSensitive()
+    {
+        var pool = new NamePool();
+        var lower = pool.Intern(FreshCopyOf("foo"));
+        var upper = pool.Intern(FreshCopyOf("FOO"));
+
+        Assert.AreEqual("foo", lower);
+        Assert.AreEqual("FOO", upper);
+        Assert.AreEqual(2, pool.DistinctNameCount);
+    }
+
+    [TestMethod]
+    public void DuplicatesAreCounted()
+    {
+        var pool = new NamePool();
+        var name = FreshCopyOf("SomeFunctionName");
+        pool.Intern(name);
+        pool.Intern(name); // The same reference again is not a duplicate, nothing is saved by pooling it
+        Assert.AreEqual(0, pool.DuplicateNamesFound);
+        Assert.AreEqual(0, pool.ApproximateDuplicateBytes);
+
+        pool.Intern(FreshCopyOf("SomeFunctionName"));
+        pool.Intern(FreshCopyOf("SomeFunctionName"));
+
+        Assert.AreEqual(4, pool.NamesLookedUp);
+        Assert.AreEqual(2, pool.DuplicateNamesFound);
+        Assert.IsGreaterThan(2L * 2 * name.Length, pool.ApproximateDuplicateBytes);
+        Assert.AreEqual(pool.ApproximateDuplicateBytes - pool.ApproximatePoolBytes, pool.ApproximateBytesSaved);
+    }
+
+    [TestMethod]
+    public void PoolOfNamesThatAreNeverRepeatedCostsMoreThanItSaves()
+    {
+        var pool = new NamePool();
+        for (var i = 0; i < 1000; i++)
+        {
+            pool.Intern(FreshCopyOf($"Name{i}"));
+        }
+
+        Assert.AreEqual(0, pool.ApproximateDuplicateBytes);
+        Assert.IsGreaterThanOrEqualTo(1000 * 16L, pool.ApproximatePoolBytes);
+        Assert.IsLessThan(0L, pool.ApproximateBytesSaved);
+    }
+
+    [TestMethod]
+    public void DisabledPoolReturnsEveryNameAsItWasGiven()
+    {
+        var pool = new NamePool(isEnabled: false);
+        var firstThis = FreshCopyOf("this");
+        var secondThis = FreshCopyOf("this");
+
+        Assert.AreSame(firstThis, pool.Intern(firstThis));
+        Assert.AreSame(secondThis, pool.Intern(secondThis));
+        Assert.AreEqual(2, pool.NamesLookedUp);
+        Assert.AreEqual(0, pool.DuplicateNamesFound);
+        Assert.AreEqual(0, pool.DistinctNameCount);
+        Assert.AreEqual(0, pool.ApproximateBytesSaved);
+    }
+
+    [TestMethod]
+    public void WithABudgetNamesAreForgottenAfterTwoGenerations()
+    {
+        var budget = new SymbolCacheBudget(3 * SymbolCacheBudget.EstimatedBytesPerSymbol);
+        var pool = new NamePool(budget);
+        var first = pool.Intern(FreshCopyOf("first"));
+
+        // Two generations later, nothing has looked up "first" since, so it's gone and the next copy becomes the pooled one.
+        for (var i = 0; i < 6; i++)
+        {
+            budget.SymbolAdded();
+        }
+
+        Assert.AreEqual(0, pool.DistinctNameCount);
+        var secondFirst = FreshCopyOf("first");
+        Assert.AreSame(secondFirst, pool.Intern(secondFirst));
+        Assert.AreNotSame(first, secondFirst);
+        Assert.AreEqual(0, budget.SymbolsEvicted);
+    }
+
+    [TestMethod]
+    public void WithABudgetThePoolStaysTheSameSizeAsSymbolsComeAndGo()
+    {
+        // Each generation holds three symbols, and each symbol here has a name no other symbol has - except "this", which every symbol
+        // looks up too, the way parameters of member functions do.
+        using var cache = new SessionDataCache(symbolCacheMemoryBudgetInBytes: 3 * SymbolCacheBudget.EstimatedBytesPerSymbol);
+        var firstThis = cache.Names.Intern(FreshCopyOf("this"));
+        var largestPoolSize = 0;
+        for (uint i = 0; i < 1000; i++)
+        {
+            Assert.AreSame(firstThis, cache.Names.Intern(FreshCopyOf("this")));
+            _ = new BasicTypeSymbol(cache, FreshCopyOf($"Type{i}"), size: 4, symIndexId: i);
+            largestPoolSize = Math.Max(largestPoolSize, cache.Names.DistinctNameCount);
+        }
+
+        // At most two generations of three names each, plus "this" - rather than all 1001 names.
+        Assert.IsLessThanOrEqualTo(7, largestPoolSize);
+    }
+
+    [TestMethod]
+    public void WithoutABudgetEveryNameIsKept()
+    {
+        using var cache = new SessionDataCache();
+        for (uint i = 0; i < 1000; i++)
+        {
+            _ = new BasicTypeSymbol(cache, FreshCopyOf($"Type{i}"), size: 4, symIndexId: i);
+        }
+
+        Assert.AreEqual(1000, cache.Names.DistinctNameCount);
+    }
+
+    [TestMethod]
+    public void SymbolsWithTheSameNameShareOneString()
+    {
+        using var cache = new SessionDataCache() { AllCanonicalNames = new SortedList<uint, NameCanonicalization>() };
+        var intType = new BasicTypeSymbol(cache, FreshCopyOf("int"), size: 4, symIndexId: 1);
+        var otherIntType = new BasicTypeSymbol(cache, FreshCopyOf("int"), size: 4, symIndexId: 2);
+        var thisParameter = new ParameterDataSymbol(cache, FreshCopyOf("this"), symIndexId: 3, intType);
+        var otherThisParameter = new ParameterDataSymbol(cache, FreshCopyOf("this"), symIndexId: 4, otherIntType);
+        var function = new SimpleFunctionCodeSymbol(cache, FreshCopyOf("DoTheThing"), rva: 0x1000, size: 10, symIndexId: 5);
+        var otherFunction = new SimpleFunctionCodeSymbol(cache, FreshCopyOf("DoTheThing"), rva: 0x2000, size: 10, symIndexId: 6);
+
+        Assert.AreSame(intType.Name, otherIntType.Name);
+        Assert.AreSame(thisParameter.Name, otherThisParameter.Name);
+        Assert.AreSame(function.FunctionName, otherFunction.FunctionName);
+        Assert.AreSame(function.Name, otherFunction.Name);
+    }
+}
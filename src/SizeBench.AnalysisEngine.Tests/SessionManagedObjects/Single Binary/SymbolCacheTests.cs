@@ -0,0 +1,140 @@
+﻿using System.Runtime.CompilerServices;
+
+namespace SizeBench.AnalysisEngine.Tests;
+
+[TestClass]
+public sealed class SymbolCacheTests
+{
+    private sealed class FakeSymbol
+    {
+        public uint SymIndexId { get; init; }
+    }
+
+    // A budget of this many bytes holds this many symbols in each generation.
+    private const int ThreeSymbols = 3 * SymbolCacheBudget.EstimatedBytesPerSymbol;
+
+    [TestMethod]
+    public void WithoutABudgetNothingIsEverEvicted()
+    {
+        var cache = new SymbolCache<FakeSymbol>();
+        var symbols = new List<FakeSymbol>();
+        for (uint i = 0; i < 1000; i++)
+        {
+            var symbol = new FakeSymbol() { SymIndexId = i };
+            symbols.Add(symbol);
+            cache.Add(i, symbol);
+        }
+
+        Assert.AreEqual(1000, cache.Count);
+        foreach (var symbol in symbols)
+        {
+            Assert.IsTrue(cache.TryGetValue(symbol.SymIndexId, out var found));
+            Assert.AreSame(symbol, found);
+        }
+    }
+
+    [TestMethod]
+    public void EvictedSymbolsThatAreStillAliveAreFoundAndPromoted()
+    {
+        var budget = new SymbolCacheBudget(ThreeSymbols);
+        var cache = new SymbolCache<FakeSymbol>(budget: budget);
+        var symbols = new List<FakeSymbol>();
+        for (uint i = 0; i < 3; i++)
+        {
+            var symbol = new FakeSymbol() { SymIndexId = i };
+            symbols.Add(symbol);
+            cache.Add(i, symbol);
+        }
+
+        // The third symbol filled the generation, so all three are now only held weakly - but they're still alive, since this test holds
+        // them, so they must come back as the same objects.
+        Assert.AreEqual(3, budget.SymbolsEvicted);
+        Assert.IsTrue(cache.ContainsKey(0));
+        Assert.IsTrue(cache.TryGetValue(1, out var found));
+        Assert.AreSame(symbols[1], found);
+        Assert.AreSame(symbols[2], cache[2]);
+
+        // And something that's still alive can't be added twice.
+        Assert.ThrowsExactly<ArgumentException>(() => cache.Add(0, new FakeSymbol() { SymIndexId = 0 }));
+    }
+
+    [TestMethod]
+    public void EvictedSymbolsThatHaveBeenCollectedMissAndCanBeAddedAgain()
+    {
+        var budget = new SymbolCacheBudget(ThreeSymbols);
+        var cache = new SymbolCache<FakeSymbol>(budget: budget);
+        AddSymbolsNothingElseHolds(cache, 3);
+
+        GC.Collect();
+        GC.WaitForPendingFinalizers();
+        GC.Collect();
+
+        for (uint i = 0; i < 3; i++)
+        {
+            Assert.IsFalse(cache.ContainsKey(i));
+            Assert.IsFalse(cache.TryGetValue(i, out _));
+        }
+
+        var reparsed = new FakeSymbol() { SymIndexId = 1 };
+        cache.Add(1, reparsed);
+        Assert.AreSame(reparsed, cache[1]);
+    }
+
+    [TestMethod]
+    public void RecentlyUsedSymbolsStayStronglyHeld()
+    {
+        var budget = new SymbolCacheBudget(ThreeSymbols);
+        var cache = new SymbolCache<FakeSymbol>(budget: budget);
+        AddSymbolsNothingElseHolds(cache, 3);
+
+        // Using symbol 0 promotes it into the current generation, which isn't full yet, so it survives a collection - and the others don't.
+        Assert.IsTrue(cache.TryGetValue(0, out _));
+
+        GC.Collect();
+        GC.WaitForPendingFinalizers();
+        GC.Collect();
+
+        Assert.IsTrue(cache.TryGetValue(0, out _));
+        Assert.IsFalse(cache.TryGetValue(1, out _));
+        Assert.IsFalse(cache.TryGetValue(2, out _));
+    }
+
+    [TestMethod]
+    public void BudgetIsSharedByEveryCacheUsingIt()
+    {
+        var budget = new SymbolCacheBudget(ThreeSymbols);
+        var first = new SymbolCache<FakeSymbol>(budget: budget);
+        var second = new SymbolCache<string>(budget: budget);
+
+        var symbol = new FakeSymbol() { SymIndexId = 1 };
+        first.Add(1, symbol);
+        second.Add(1, "one");
+        Assert.AreEqual(0, budget.SymbolsEvicted);
+
+        // The third symbol fills the generation for both caches together.
+        second.Add(2, "two");
+        Assert.AreEqual(3, budget.SymbolsEvicted);
+        Assert.AreSame(symbol, first[1]);
+    }
+
+    [TestMethod]
+    public void SessionDataCacheOnlyHasABudgetWhenAskedFor()
+    {
+        using var unlimited = new SessionDataCache();
+        Assert.IsNull(unlimited.SymbolCacheBudget);
+
+        using var budgeted = new SessionDataCache(symbolCacheMemoryBudgetInBytes: 1024 * 1024);
+        Assert.IsNotNull(budgeted.SymbolCacheBudget);
+        Assert.AreEqual(1024 * 1024 / SymbolCacheBudget.EstimatedBytesPerSymbol, budgeted.SymbolCacheBudget.SymbolsPerGeneration);
+    }
+
+    // In its own method, so that nothing on this test's stack keeps the symbols alive.
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static void AddSymbolsNothingElseHolds(SymbolCache<FakeSymbol> cache, uint count)
+    {
+        for (uint i = 0; i < count; i++)
+        {
+            cache.Add(i, new FakeSymbol() { SymIndexId = i });
+        }
+    }
+}
@@ -0,0 +1,45 @@
+﻿using SizeBench.AnalysisEngine.DIAInterop;
+
+namespace SizeBench.AnalysisEngine.Tests;
+
+[TestClass]
+public sealed class UndecoratedNameCacheTests
+{
+    [TestMethod]
+    public void EachNameIsUndecoratedOnceAndShared()
+    {
+        var cache = new UndecoratedNameCache();
+
+        var first = cache.GetUndecoratedName("?get@Foo@@QEBAHXZ");
+        var second = cache.GetUndecoratedName(new string("?get@Foo@@QEBAHXZ".AsSpan()));
+
+        Assert.AreEqual("public: int __cdecl Foo::get(void)const __ptr64", first);
+        Assert.AreSame(first, second);
+        Assert.AreEqual(1, cache.Count);
+    }
+
+    [TestMethod]
+    public void FlagsAreCachedSeparately()
+    {
+        var cache = new UndecoratedNameCache();
+
+        Assert.AreEqual("public: int __cdecl Foo::get(void)const __ptr64", cache.GetUndecoratedName("?get@Foo@@QEBAHXZ"));
+        Assert.AreEqual("Foo::get", cache.GetUndecoratedName("?get@Foo@@QEBAHXZ", UndName.UNDNAME_NAME_ONLY));
+        Assert.AreEqual(2, cache.Count);
+    }
+
+    [TestMethod]
+    public void NamesThatArentDecoratedAreNotCached()
+    {
+        var cache = new UndecoratedNameCache();
+
+        Assert.IsNull(cache.GetUndecoratedName(null));
+        Assert.IsNull(cache.GetUndecoratedName(String.Empty));
+        Assert.IsNull(cache.GetUndecoratedName("_printf"));
+        Assert.AreEqual(0, cache.Count);
+
+        // Names that are decorated but can't be undecorated are remembered, so they're only attempted once.
+        Assert.IsNull(cache.GetUndecoratedName("?AddRef@error_info_fallback@impl@winrt@@W7EAAIXZ"));
+        Assert.AreEqual(1, cache.Count);
+    }
+}
@@ -156,6 +156,39 @@ public sealed class EnumerateDuplicateDataSessionTaskTests : IDisposable
     }
 
 
+    [TestMethod]
+    public void DataIsOnlyComparedToDataWithTheSameContentHash()
+    {
+        SetupDuplicateData(out var a1Compiland, out var b2Compiland, out var cCompiland);
+
+        // The "test 1" at RVA 10 has different contents from the other "test 1" symbols, so give it a different hash - then it should never
+        // need to be byte-compared with any of them.
+        this.MockSession.Setup(s => s.HashData(It.IsAny<long>(), It.IsAny<uint>())).Returns(1);
+        this.MockSession.Setup(s => s.HashData(10, 1)).Returns(2);
+
+        var task = new EnumerateDuplicateDataSessionTask(this.SessionTaskParameters!,
+                                                         CancellationToken.None,
+                                                         null /*progressReporter*/);
+
+        using var logger = new NoOpLogger();
+        var duplicates = task.Execute(logger);
+
+        this.MockSession.Verify(s => s.CompareData(It.IsAny<long>(), 10, It.IsAny<uint>()), Times.Never());
+        this.MockSession.Verify(s => s.CompareData(10, It.IsAny<long>(), It.IsAny<uint>()), Times.Never());
+
+        // The results should be identical to when everything hashes the same and CompareData has to sort it all out.
+        Assert.HasCount(2, duplicates);
+
+        var duplicate1 = duplicates.First(ddi => ddi.Symbol.Name == "test 1");
+        Assert.HasCount(3, duplicate1.ReferencedIn);
+        Assert.Contains(a1Compiland, duplicate1.ReferencedIn);
+        Assert.Contains(b2Compiland, duplicate1.ReferencedIn);
+        Assert.Contains(cCompiland, duplicate1.ReferencedIn);
+
+        var duplicate2 = duplicates.First(ddi => ddi.Symbol.Name == "test 2");
+        Assert.HasCount(2, duplicate2.ReferencedIn);
+    }
+
     private void SetupDataWithNoDuplicates()
     {
         var a1Compiland = this.DataCache.AllCompilands!.First(c => c.Name == @"c:\dummy\a1.obj");
@@ -0,0 +1,148 @@
+﻿using System.Reflection.PortableExecutable;
+using SizeBench.AnalysisEngine.Helpers;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+using SizeBench.TestDataCommon;
+
+namespace SizeBench.AnalysisEngine.SessionTasks.Tests;
+
+[TestClass]
+public sealed class EnumerateNearDuplicateFunctionsSessionTaskTests : IDisposable
+{
+    private Mock<ISession> MockSession = new Mock<ISession>();
+    private SessionTaskParameters? SessionTaskParameters;
+    private TestDIAAdapter TestDIAAdapter = new TestDIAAdapter();
+    private SessionDataCache DataCache = new SessionDataCache();
+    private BinarySection? TextSection;
+
+    [TestInitialize]
+    public void TestInitialize()
+    {
+        this.MockSession = new Mock<ISession>();
+        this.TestDIAAdapter = new TestDIAAdapter();
+        this.DataCache = new SessionDataCache()
+        {
+            AllCanonicalNames = new SortedList<uint, NameCanonicalization>(),
+            PDataHasBeenInitialized = true,
+            XDataHasBeenInitialized = true,
+            RsrcHasBeenInitialized = true,
+            OtherPESymbolsHaveBeenInitialized = true
+        };
+
+        this.SessionTaskParameters = new SessionTaskParameters(
+            this.MockSession.Object,
+            this.TestDIAAdapter,
+            this.DataCache);
+
+        this.TextSection = new BinarySection(this.DataCache, ".text", size: 0x1000, virtualSize: 0x1000, rva: 0x1000, fileAlignment: 0x200, sectionAlignment: 0x1000, characteristics: SectionCharacteristics.MemExecute);
+        this.TextSection.MarkFullyConstructed();
+        var dataSection = new BinarySection(this.DataCache, ".data", size: 0x1000, virtualSize: 0x1000, rva: 0x2000, fileAlignment: 0x200, sectionAlignment: 0x1000, characteristics: SectionCharacteristics.MemRead);
+        dataSection.MarkFullyConstructed();
+        this.DataCache.AllBinarySections = new List<BinarySection>() { this.TextSection, dataSection };
+    }
+
+    private static ulong[] SignatureOf(byte[] bytes)
+    {
+        var signature = CodeBytesMinHash.CreateEmptySignature();
+        CodeBytesMinHash.AddBytes(bytes, signature);
+        return signature;
+    }
+
+    private static byte[] RandomBytes(int seed)
+    {
+        var bytes = new byte[1000];
+        new Random(seed).NextBytes(bytes);
+        return bytes;
+    }
+
+    private SimpleFunctionCodeSymbol AddFunction(string name, uint rva, uint size, uint symIndexId, byte[] codeBytes, List<ValueTuple<ISymbol, uint>> symbolsToFind)
+    {
+        var function = new SimpleFunctionCodeSymbol(this.DataCache, name, rva, size, symIndexId);
+        this.MockSession.Setup(s => s.FingerprintCodeBytesInBinary(function)).Returns(SignatureOf(codeBytes));
+        symbolsToFind.Add(new ValueTuple<ISymbol, uint>(function, rva - this.TextSection!.RVA));
+        return function;
+    }
+
+    private (SimpleFunctionCodeSymbol, SimpleFunctionCodeSymbol, SimpleFunctionCodeSymbol) SetupFunctionsWithOneClusterOfNearDuplicates()
+    {
+        var copyPastedBytes = RandomBytes(seed: 1);
+        var slightlyDifferentBytes = (byte[])copyPastedBytes.Clone();
+        slightlyDifferentBytes[500]++;
+
+        var symbolsToFind = new List<ValueTuple<ISymbol, uint>>();
+        var original = AddFunction("Original", rva: 0x1000, size: 100, symIndexId: 1, copyPastedBytes, symbolsToFind);
+        AddFunction("Unrelated", rva: 0x1100, size: 100, symIndexId: 2, RandomBytes(seed: 2), symbolsToFind);
+        var copy = AddFunction("CopyPasted", rva: 0x1200, size: 100, symIndexId: 3, copyPastedBytes, symbolsToFind);
+        var nearCopy = AddFunction("CopyPastedThenTweaked", rva: 0x1300, size: 120, symIndexId: 4, slightlyDifferentBytes, symbolsToFind);
+
+        // Identical to the original, but too small to be worth considering.
+        AddFunction("TinyThunk", rva: 0x1400, size: EnumerateNearDuplicateFunctionsSessionTask.MinimumFunctionSize - 1, symIndexId: 5, copyPastedBytes, symbolsToFind);
+
+        this.TestDIAAdapter.SymbolsToFindByRVARange.Add(RVARange.FromRVAAndSize(this.TextSection!.RVA, this.TextSection.Size), symbolsToFind);
+
+        return (original, copy, nearCopy);
+    }
+
+    [TestMethod]
+    public void NearDuplicateFunctionsAreClusteredLargestFirst()
+    {
+        var (original, copy, nearCopy) = SetupFunctionsWithOneClusterOfNearDuplicates();
+
+        var task = new EnumerateNearDuplicateFunctionsSessionTask(this.SessionTaskParameters!,
+                                                                  null /*progressReporter*/,
+                                                                  CancellationToken.None);
+
+        Assert.IsFalse(String.IsNullOrEmpty(task.TaskName));
+        using var logger = new NoOpLogger();
+        var clusters = task.Execute(logger);
+
+        Assert.HasCount(1, clusters);
+        var cluster = clusters[0];
+        Assert.HasCount(3, cluster.Functions);
+        Assert.IsTrue(ReferenceEquals(nearCopy, cluster.Functions[0]));
+        Assert.IsTrue(ReferenceEquals(original, cluster.Functions[1]));
+        Assert.IsTrue(ReferenceEquals(copy, cluster.Functions[2]));
+        Assert.AreEqual(320u, cluster.TotalSize);
+        Assert.IsTrue(cluster.EstimatedSimilarity >= EnumerateNearDuplicateFunctionsSessionTask.MinimumEstimatedSimilarity);
+        Assert.IsTrue(cluster.EstimatedSavingsIfFolded > 0 && cluster.EstimatedSavingsIfFolded <= 200u);
+    }
+
+    [TestMethod]
+    public void CacheIsReusedAfterOneRun()
+    {
+        SetupFunctionsWithOneClusterOfNearDuplicates();
+
+        Assert.IsNull(this.DataCache.AllNearDuplicateFunctionClusters);
+
+        using var logger = new NoOpLogger();
+        var clusters = new EnumerateNearDuplicateFunctionsSessionTask(this.SessionTaskParameters!,
+                                                                      null /*progressReporter*/,
+                                                                      CancellationToken.None).Execute(logger);
+
+        Assert.IsTrue(ReferenceEquals(clusters, this.DataCache.AllNearDuplicateFunctionClusters));
+
+        var clusters2 = new EnumerateNearDuplicateFunctionsSessionTask(this.SessionTaskParameters!,
+                                                                       null /*progressReporter*/,
+                                                                       CancellationToken.None).Execute(logger);
+
+        Assert.IsTrue(ReferenceEquals(clusters, clusters2));
+        this.MockSession.Verify(s => s.FingerprintCodeBytesInBinary(It.IsAny<IFunctionCodeSymbol>()), Times.Exactly(4));
+    }
+
+    [TestMethod]
+    public void CanCancel()
+    {
+        SetupFunctionsWithOneClusterOfNearDuplicates();
+
+        using var cts = new CancellationTokenSource();
+        cts.Cancel();
+
+        using var logger = new NoOpLogger();
+        Assert.ThrowsExactly<OperationCanceledException>(() => new EnumerateNearDuplicateFunctionsSessionTask(this.SessionTaskParameters!,
+                                                                                                               null /*progressReporter*/,
+                                                                                                               cts.Token).Execute(logger));
+        Assert.IsNull(this.DataCache.AllNearDuplicateFunctionClusters);
+    }
+
+    public void Dispose() => this.DataCache.Dispose();
+}
@@ -117,5 +117,64 @@ public sealed class EnumerateSymbolsInBinarySectionSessionTaskTests : IDisposabl
         mockProgress.Verify(p => p.Report(It.IsAny<SessionTaskProgress>()), Times.Exactly(3));
     }
 
+    [TestMethod]
+    public void StreamingFindsTheSameSymbolsInTheSameOrderAsExecute()
+    {
+        var section = GenerateSectionWithSymbols(250);
+
+        using var logger = new NoOpLogger();
+        var symbols = new EnumerateSymbolsInBinarySectionSessionTask(this.SessionTaskParameters!, CancellationToken.None, null /* progress */, section).Execute(logger);
+        var streamedSymbols = new EnumerateSymbolsInBinarySectionSessionTask(this.SessionTaskParameters!, CancellationToken.None, null /* progress */, section).ExecuteStreaming(logger).ToList();
+
+        Assert.HasCount(250, streamedSymbols);
+        CollectionAssert.AreEqual(symbols, streamedSymbols);
+    }
+
+    [TestMethod]
+    public void StreamingOnlyEnumeratesAsManySymbolsAsHaveBeenAskedFor()
+    {
+        var section = GenerateSectionWithSymbols(250);
+        var symbolsToFind = this.TestDIAAdapter.SymbolsToFindByRVARange[RVARange.FromRVAAndSize(section.RVA, section.Size)].ToList();
+        var symbolsEnumeratedFromDIA = 0;
+        IEnumerable<(ISymbol, uint)> countSymbolsEnumeratedFromDIA()
+        {
+            foreach (var symbol in symbolsToFind)
+            {
+                symbolsEnumeratedFromDIA++;
+                yield return symbol;
+            }
+        }
+        this.TestDIAAdapter.SymbolsToFindByRVARange[RVARange.FromRVAAndSize(section.RVA, section.Size)] = countSymbolsEnumeratedFromDIA();
+
+        var task = new EnumerateSymbolsInBinarySectionSessionTask(this.SessionTaskParameters!,
+                                                                  CancellationToken.None,
+                                                                  null /* progress */,
+                                                                  section);
+
+        using var logger = new NoOpLogger();
+        var firstSymbols = task.ExecuteStreaming(logger).Take(10).ToList();
+
+        Assert.HasCount(10, firstSymbols);
+        Assert.AreEqual(10, symbolsEnumeratedFromDIA);
+    }
+
+    private BinarySection GenerateSectionWithSymbols(uint symbolCount)
+    {
+        var section = new BinarySection(this.SessionTaskParameters!.DataCache, ".text", size: 0x200, virtualSize: symbolCount, rva: 0x500, fileAlignment: 0x200, sectionAlignment: 0x1000, characteristics: SectionCharacteristics.MemExecute);
+        section.MarkFullyConstructed();
+
+        var symbolsToFind = new List<ValueTuple<ISymbol, uint>>();
+        for (uint i = 0; i < symbolCount; i++)
+        {
+            ISymbol symbolToFind = new SimpleFunctionCodeSymbol(this.SessionTaskParameters.DataCache, $"test {i}", rva: section.RVA + i, size: 1, symIndexId: i);
+
+            symbolsToFind.Add(new ValueTuple<ISymbol, uint>(symbolToFind, i));
+        }
+
+        this.TestDIAAdapter.SymbolsToFindByRVARange.Add(RVARange.FromRVAAndSize(section.RVA, section.Size), symbolsToFind);
+
+        return section;
+    }
+
     public void Dispose() => this.DataCache.Dispose();
 }
@@ -128,6 +128,55 @@ public sealed class EnumerateSymbolsInCompilandSessionTaskTests : IDisposable
         mockProgress.Verify(p => p.Report(It.IsAny<SessionTaskProgress>()), Times.Exactly(3));
     }
 
+    [TestMethod]
+    public void StreamingFindsTheSameSymbolsInTheSameOrderAsExecute()
+    {
+        AddMockSymbolsTo(GenerateMockTextSection(), firstSymIndexId: 0);
+        AddMockSymbolsTo(GenerateMockRDataSection(), firstSymIndexId: 1000);
+        this.TestCompiland!.MarkFullyConstructed();
+
+        using var logger = new NoOpLogger();
+        var symbols = new EnumerateSymbolsInCompilandSessionTask(this.SessionTaskParameters!, CancellationToken.None, null /* progress */, this.TestCompiland).Execute(logger);
+        var streamedSymbols = new EnumerateSymbolsInCompilandSessionTask(this.SessionTaskParameters!, CancellationToken.None, null /* progress */, this.TestCompiland).ExecuteStreaming(logger).ToList();
+
+        Assert.HasCount(120, streamedSymbols);
+        CollectionAssert.AreEqual(symbols, streamedSymbols);
+    }
+
+    [TestMethod]
+    public void StreamingOnlyCodeSymbolsSkipsSectionsWithoutCode()
+    {
+        var textSection = GenerateMockTextSection();
+        AddMockSymbolsTo(textSection, firstSymIndexId: 0);
+        AddMockSymbolsTo(GenerateMockRDataSection(), firstSymIndexId: 1000);
+        this.TestCompiland!.MarkFullyConstructed();
+
+        var task = new EnumerateSymbolsInCompilandSessionTask(this.SessionTaskParameters!,
+                                                              CancellationToken.None,
+                                                              null /* progress */,
+                                                              this.TestCompiland,
+                                                              new SymbolEnumerationOptions() { OnlyCodeSymbols = true });
+
+        using var logger = new NoOpLogger();
+        var streamedSymbols = task.ExecuteStreaming(logger).ToList();
+
+        Assert.HasCount(60, streamedSymbols);
+        Assert.IsTrue(streamedSymbols.All(s => textSection.RVA <= s.RVA && s.RVAEnd <= textSection.RVA + textSection.Size));
+    }
+
+    // One 10-byte symbol at the start of each of the RVA ranges the Generate* methods give the compiland.
+    private void AddMockSymbolsTo(BinarySection section, uint firstSymIndexId)
+    {
+        var symbols = new List<(ISymbol, uint)>();
+        for (uint i = 0; i < 60; i++)
+        {
+            ISymbol symbol = new SimpleFunctionCodeSymbol(this.SessionTaskParameters!.DataCache, $"test {section.Name} symbol {i}", rva: section.RVA + (i * 20), size: 10, symIndexId: firstSymIndexId + i);
+            symbols.Add((symbol, i));
+        }
+
+        this.TestDIAAdapter.SymbolsToFindByRVARange.Add(RVARange.FromRVAAndSize(section.RVA, section.Size), symbols);
+    }
+
     private BinarySection GenerateMockTextSection()
     {
         var textSection = new BinarySection(this.SessionTaskParameters!.DataCache, ".text", size: 0x1000u, virtualSize: 0, rva: 0x4000u, fileAlignment: 0, sectionAlignment: 0, characteristics: SectionCharacteristics.MemExecute);
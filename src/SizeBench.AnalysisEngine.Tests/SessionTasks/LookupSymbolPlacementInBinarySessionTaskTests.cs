@@ -134,5 +134,49 @@ public sealed class LookupSymbolPlacementInBinarySessionTaskTests : IDisposable
         }
     }
 
+    [TestMethod]
+    public void BatchLookupMatchesLookingUpEachSymbolInOrder()
+    {
+        static ISymbol MockSymbol(uint rva, uint size)
+        {
+            var mockSymbol = new Mock<ISymbol>();
+            mockSymbol.Setup(s => s.Name).Returns($"symbol at {rva}");
+            mockSymbol.Setup(s => s.RVA).Returns(rva);
+            mockSymbol.Setup(s => s.RVAEnd).Returns(rva + size - 1);
+            mockSymbol.Setup(s => s.Size).Returns(size);
+            mockSymbol.Setup(s => s.VirtualSize).Returns(size);
+            return mockSymbol.Object;
+        }
+
+        var symbols = new List<ISymbol>()
+        {
+            MockSymbol(11000, 10),
+            MockSymbol(0, 100),
+            MockSymbol(0xFFFF0000, 10), // Outside everything in the binary
+            MockSymbol(11000, 10),
+        };
+
+        using var logger = new NoOpLogger();
+        var output = new LookupSymbolPlacementsInBinarySessionTask(symbols, options: null, parameters: this.SessionTaskParameters!, token: CancellationToken.None, progress: null).Execute(logger);
+
+        Assert.AreEqual(symbols.Count, output.Count);
+        for (var i = 0; i < symbols.Count; i++)
+        {
+            var expected = new LookupSymbolPlacementInBinarySessionTask(symbols[i], options: null, parameters: this.SessionTaskParameters!, token: CancellationToken.None, progress: null).Execute(logger);
+            Assert.AreSame(expected.BinarySection, output[i].BinarySection);
+            Assert.AreSame(expected.COFFGroup, output[i].COFFGroup);
+            Assert.AreSame(expected.Lib, output[i].Lib);
+            Assert.AreSame(expected.Compiland, output[i].Compiland);
+            Assert.AreSame(expected.SourceFile, output[i].SourceFile);
+        }
+
+        Assert.IsTrue(ReferenceEquals(this._generator.BeforeRDataBefCG, output[0].COFFGroup));
+        Assert.AreEqual(this._generator.BeforeA3Compiland, output[0].Compiland);
+        Assert.AreEqual(this._generator.BeforeTextMnCG, output[1].COFFGroup);
+        Assert.AreEqual(this._generator.BeforeA1Compiland, output[1].Compiland);
+        Assert.IsNull(output[2].COFFGroup);
+        Assert.IsNull(output[2].Compiland);
+    }
+
     public void Dispose() => this._generator.Dispose();
 }
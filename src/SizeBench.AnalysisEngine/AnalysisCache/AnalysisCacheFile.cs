@@ -0,0 +1,251 @@
+﻿using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Text;
+using Dia2Lib;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine;
+
+// Pre-processing walks every symbol in the PDB to build the RVA -> symIndexId index, find the labels, and pick canonical names for folded RVAs.
+// That walk is the single most expensive part of opening a session on a large binary, and its results depend only on the binary and PDB - so
+// they can be saved to a file and read back the next time the same pair is opened, instead of walking the PDB again.
+//
+// Everything else in the SessionDataCache is made of objects that point back at DIA symbols and are built lazily, so those are not persisted;
+// the PDB is still opened as usual and symbols are still materialized from it by symIndexId on demand.
+//
+// A cache file is only ever an optimization - if it's missing, stale, unreadable or damaged in any way it is ignored and recomputed.
+//
+// The file stores symIndexIds, and DIA makes no promise that a symIndexId means the same symbol in every session on a PDB.  So before a file
+// is trusted, a sample of the symIndexIds in it are looked up in the current session to make sure they're still at the RVA they were at when
+// the file was written.
+internal static class AnalysisCacheFile
+{
+    private const int SymIndexIdsToValidate = 64;
+
+    private const uint FileMagic = 0x43414253; // "SBAC", for "SizeBench Analysis Cache"
+    private const uint EndOfFileMagic = 0x464F4553; // "SEOF", so a truncated file can't be mistaken for a complete one
+
+    // Bump this whenever what gets cached changes meaning, not just layout - a file from an older SizeBench must not be trusted.
+    //   2: canonical names of public symbols are undecorated in-process (MSVCNameUndecorator), which can differ from what DIA gave before.
+    private const int FormatVersion = 2;
+
+    public static bool TryLoadPreProcessedSymbols(string cacheDirectory, AnalysisCacheKey key, SessionDataCache dataCache, ILogger logger,
+                                                  Func<uint, uint, bool> symIndexIdIsAtRVA)
+    {
+        var path = Path.Combine(cacheDirectory, key.FileName);
+        if (!File.Exists(path))
+        {
+            logger.Log($"No analysis cache file found at {path}");
+            return false;
+        }
+
+        try
+        {
+            using var fileStream = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.Read | FileShare.Delete, bufferSize: 1, FileOptions.SequentialScan);
+            if (fileStream.Length == 0)
+            {
+                throw new InvalidDataException("The file is empty.");
+            }
+
+            using var mappedFile = MemoryMappedFile.CreateFromFile(fileStream, mapName: null, capacity: 0, MemoryMappedFileAccess.Read, HandleInheritability.None, leaveOpen: false);
+            using var viewStream = mappedFile.CreateViewStream(0, 0, MemoryMappedFileAccess.Read);
+            using var reader = new BinaryReader(viewStream, Encoding.UTF8);
+
+            if (!ReadAndCheckHeader(reader, key, out var mismatchReason))
+            {
+                logger.Log($"Ignoring analysis cache file at {path} because {mismatchReason}");
+                return false;
+            }
+
+            var symIndicesByRVA = reader.ReadBoolean() ? SymIndicesByRVA.ReadFrom(reader) : null;
+
+            var labelCount = ReadCount(reader);
+            var rvasOfLabels = new HashSet<uint>(labelCount);
+            for (var i = 0; i < labelCount; i++)
+            {
+                rvasOfLabels.Add(reader.ReadUInt32());
+            }
+
+            var canonicalNamesCount = ReadCount(reader);
+            var canonicalNames = new SortedList<uint, NameCanonicalization>(canonicalNamesCount);
+            for (var i = 0; i < canonicalNamesCount; i++)
+            {
+                var rva = reader.ReadUInt32();
+                var nameCanonicalization = new NameCanonicalization();
+                var namesCount = ReadCount(reader);
+                for (var j = 0; j < namesCount; j++)
+                {
+                    var symIndexId = reader.ReadUInt32();
+                    var symTag = (SymTagEnum)reader.ReadInt32();
+                    var name = reader.ReadString();
+
+                    // These names were all accepted when the file was written, and are replayed in the same order, so each one must be accepted again.
+                    if (!nameCanonicalization.AddName(symIndexId, symTag, name: name))
+                    {
+                        throw new InvalidDataException($"The name '{name}' at RVA 0x{rva:X} was rejected when it was read back.");
+                    }
+                }
+
+                nameCanonicalization.Canonicalize();
+                canonicalNames.Add(rva, nameCanonicalization);
+            }
+
+            if (reader.ReadUInt32() != EndOfFileMagic)
+            {
+                throw new InvalidDataException("The file does not end where it should.");
+            }
+
+            if (symIndicesByRVA is not null && !SampledSymIndexIdsAreStillAtTheirRVAs(symIndicesByRVA, symIndexIdIsAtRVA))
+            {
+                logger.Log($"Ignoring analysis cache file at {path} because its symIndexIds don't match the symbols in this session");
+                return false;
+            }
+
+            // Only now that the whole file has been read successfully do we touch the data cache, so a damaged file can't leave it half-initialized.
+            dataCache.AllCanonicalNames = canonicalNames;
+            dataCache.InitializeRVARanges(symIndicesByRVA, rvasOfLabels);
+            logger.Log($"Loaded pre-processed symbols from analysis cache file at {path}");
+            return true;
+        }
+        catch (Exception ex) when (ex is IOException or InvalidDataException or UnauthorizedAccessException or ArgumentException)
+        {
+            logger.LogException($"Ignoring analysis cache file at {path} because it could not be read", ex);
+            return false;
+        }
+    }
+
+    public static void TrySavePreProcessedSymbols(string cacheDirectory, AnalysisCacheKey key, SessionDataCache dataCache, ILogger logger)
+    {
+        var path = Path.Combine(cacheDirectory, key.FileName);
+
+        // Written to a uniquely named file first and then moved into place, so that two sessions opening the same binary at once can't interleave
+        // their writes, and a session reading the file never sees it half-written.
+        var tempPath = $"{path}.{Path.GetRandomFileName()}.tmp";
+
+        try
+        {
+            Directory.CreateDirectory(cacheDirectory);
+
+            using (var fileStream = new FileStream(tempPath, FileMode.CreateNew, FileAccess.Write, FileShare.None))
+            using (var writer = new BinaryWriter(fileStream, Encoding.UTF8))
+            {
+                WriteHeader(writer, key);
+
+                var symIndicesByRVA = dataCache.AllSymIndexIDsByRVA;
+                writer.Write(symIndicesByRVA is not null);
+                symIndicesByRVA?.WriteTo(writer);
+
+                var rvasOfLabels = dataCache.RVAsOfLabelSymbols;
+                writer.Write(rvasOfLabels.Count);
+                foreach (var rva in rvasOfLabels)
+                {
+                    writer.Write(rva);
+                }
+
+                var canonicalNames = dataCache.AllCanonicalNames ?? new SortedList<uint, NameCanonicalization>();
+                writer.Write(canonicalNames.Count);
+                foreach (var (rva, nameCanonicalization) in canonicalNames)
+                {
+                    writer.Write(rva);
+                    writer.Write(nameCanonicalization.NamesBySymIndexID.Count);
+                    foreach (var (symIndexId, symTag, name) in nameCanonicalization.NamesBySymIndexID)
+                    {
+                        writer.Write(symIndexId);
+                        writer.Write((int)symTag);
+                        writer.Write(name);
+                    }
+                }
+
+                writer.Write(EndOfFileMagic);
+            }
+
+            File.Move(tempPath, path, overwrite: true);
+            logger.Log($"Saved pre-processed symbols to analysis cache file at {path}");
+        }
+        catch (Exception ex) when (ex is IOException or UnauthorizedAccessException)
+        {
+            logger.LogException($"Could not save analysis cache file to {path}, the next session will pre-process symbols again", ex);
+            try
+            {
+                File.Delete(tempPath);
+            }
+            catch (Exception deleteEx) when (deleteEx is IOException or UnauthorizedAccessException)
+            {
+                // Nothing more we can do, this is just a stray temp file.
+            }
+        }
+    }
+
+    private static bool SampledSymIndexIdsAreStillAtTheirRVAs(SymIndicesByRVA symIndicesByRVA, Func<uint, uint, bool> symIndexIdIsAtRVA)
+    {
+        var stride = Math.Max(1, symIndicesByRVA.Count / SymIndexIdsToValidate);
+        for (var i = 0; i < symIndicesByRVA.Count; i += stride)
+        {
+            var rva = symIndicesByRVA.RVAAt(i);
+            foreach (var symIndexId in symIndicesByRVA.SymIndicesAt(i))
+            {
+                if (!symIndexIdIsAtRVA(symIndexId, rva))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    private static void WriteHeader(BinaryWriter writer, AnalysisCacheKey key)
+    {
+        writer.Write(FileMagic);
+        writer.Write(FormatVersion);
+        writer.Write(key.PdbGuid.ToByteArray());
+        writer.Write(key.PdbAge);
+        writer.Write(key.BinarySHA256);
+        writer.Write((int)key.PDBReader);
+        writer.Write((int)key.SymbolSourcesSupported);
+    }
+
+    private static bool ReadAndCheckHeader(BinaryReader reader, AnalysisCacheKey key, out string mismatchReason)
+    {
+        if (reader.ReadUInt32() != FileMagic)
+        {
+            mismatchReason = "it is not an analysis cache file";
+            return false;
+        }
+
+        var formatVersion = reader.ReadInt32();
+        if (formatVersion != FormatVersion)
+        {
+            mismatchReason = $"it is format version {formatVersion}, and this version of SizeBench uses {FormatVersion}";
+            return false;
+        }
+
+        var fileKey = new AnalysisCacheKey(new Guid(reader.ReadBytes(16)),
+                                           reader.ReadUInt32(),
+                                           reader.ReadString(),
+                                           (PDBReader)reader.ReadInt32(),
+                                           (SymbolSourcesSupported)reader.ReadInt32());
+        if (fileKey != key)
+        {
+            mismatchReason = $"it was computed from something different ({fileKey}) than what is being opened now ({key})";
+            return false;
+        }
+
+        mismatchReason = String.Empty;
+        return true;
+    }
+
+    private static int ReadCount(BinaryReader reader)
+    {
+        // Every counted item takes at least one byte, so a count larger than what's left of the file means the file is damaged - and
+        // checking that keeps a damaged count from turning into an enormous allocation.
+        var count = reader.ReadInt32();
+        if (count < 0 || count > reader.BaseStream.Length - reader.BaseStream.Position)
+        {
+            throw new InvalidDataException($"A count of {count} is not valid.");
+        }
+
+        return count;
+    }
+}
@@ -0,0 +1,20 @@
+﻿using SizeBench.AnalysisEngine.PE;
+
+namespace SizeBench.AnalysisEngine;
+
+// Identifies exactly what a cache file was computed from.  The PDB's GUID and age say which PDB matches, the hash of the binary catches a binary
+// that was rebuilt or patched without its PDB signature changing, and the reader and symbol sources are here because they change the results -
+// the managed reader and DIA don't hand out the same symIndexIds, and excluding a symbol source excludes those symbols from pre-processing.
+internal sealed record class AnalysisCacheKey(Guid PdbGuid, uint PdbAge, string BinarySHA256, PDBReader PDBReader, SymbolSourcesSupported SymbolSourcesSupported)
+{
+    public static AnalysisCacheKey Create(PEFile peFile, SessionOptions options)
+        => new AnalysisCacheKey(peFile.DebugSignature.PdbGuid,
+                                peFile.DebugSignature.Age,
+                                Convert.ToHexString(peFile.ComputeFileSHA256()),
+                                options.PDBReader,
+                                options.SymbolSourcesSupported);
+
+    // The binary's hash is checked inside the file rather than being part of the name, so that a rebuilt binary with the same PDB signature
+    // overwrites the stale file instead of accumulating next to it.
+    public string FileName => $"{this.PdbGuid:N}-{this.PdbAge}-{this.PDBReader}-{(int)this.SymbolSourcesSupported}.sbcache";
+}
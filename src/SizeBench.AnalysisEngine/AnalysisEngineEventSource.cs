@@ -0,0 +1,131 @@
+﻿using System.Diagnostics.Tracing;
+
+namespace SizeBench.AnalysisEngine;
+
+// Lets a crawl (or the GUI) be profiled in production without rebuilding anything - for example:
+//     dotnet-counters monitor --process-id <pid> --counters SizeBench-AnalysisEngine
+//     dotnet-trace collect --process-id <pid> --providers SizeBench-AnalysisEngine
+//
+// Every SessionTask emits a start and stop event around its execution.  Tasks that run other tasks nest, and the runtime tracks that nesting
+// through the activity IDs of the start/stop pairs, so a trace shows which task spent time where.  Streaming tasks are the exception, see
+// StreamingSessionTaskStart.  The counters are process-wide, summed across every Session that's open.
+[EventSource(Name = "SizeBench-AnalysisEngine")]
+internal sealed class AnalysisEngineEventSource : EventSource
+{
+    public static readonly AnalysisEngineEventSource Log = new AnalysisEngineEventSource();
+
+    private long _diaCalls;
+    private long _symbolsParsed;
+    private long _symbolCacheHits;
+    private long _symbolCacheMisses;
+    private long _symbolsEvicted;
+    private long _bytesMapped;
+
+    // Created the first time a listener enables this source, so a process that's never observed never pays for polling them.
+    private IncrementingPollingCounter? _diaCallRateCounter;
+    private IncrementingPollingCounter? _symbolsParsedRateCounter;
+    private IncrementingPollingCounter? _symbolCacheHitRateCounter;
+    private IncrementingPollingCounter? _symbolCacheMissRateCounter;
+    private IncrementingPollingCounter? _symbolsEvictedRateCounter;
+    private PollingCounter? _bytesMappedCounter;
+
+    private AnalysisEngineEventSource()
+    {
+    }
+
+    [Event(1, Level = EventLevel.Informational)]
+    public void SessionTaskStart(string taskName) => WriteEvent(1, taskName);
+
+    [Event(2, Level = EventLevel.Informational)]
+    public void SessionTaskStop(string taskName) => WriteEvent(2, taskName);
+
+    // A streaming task starts and stops in whichever DIA thread work items happen to be advancing its enumeration when it begins and ends,
+    // and the activity ID doesn't flow from one work item to the next - so these aren't tracked as an activity, and a trace has to pair them
+    // up by task name instead.
+
+    [Event(3, Level = EventLevel.Informational, ActivityOptions = EventActivityOptions.Disable)]
+    public void StreamingSessionTaskStart(string taskName) => WriteEvent(3, taskName);
+
+    [Event(4, Level = EventLevel.Informational, ActivityOptions = EventActivityOptions.Disable)]
+    public void StreamingSessionTaskStop(string taskName) => WriteEvent(4, taskName);
+
+    // These are called far too often to be events of their own, so they only feed the counters.
+
+    [NonEvent]
+    public void DIACall() => Interlocked.Increment(ref this._diaCalls);
+
+    [NonEvent]
+    public void SymbolParsed() => Interlocked.Increment(ref this._symbolsParsed);
+
+    [NonEvent]
+    public void SymbolCacheHit() => Interlocked.Increment(ref this._symbolCacheHits);
+
+    [NonEvent]
+    public void SymbolCacheMiss() => Interlocked.Increment(ref this._symbolCacheMisses);
+
+    [NonEvent]
+    public void SymbolsEvicted(long count) => Interlocked.Add(ref this._symbolsEvicted, count);
+
+    [NonEvent]
+    public void BytesMapped(long bytes) => Interlocked.Add(ref this._bytesMapped, bytes);
+
+    [NonEvent]
+    public void BytesUnmapped(long bytes) => Interlocked.Add(ref this._bytesMapped, -bytes);
+
+    protected override void OnEventCommand(EventCommandEventArgs command)
+    {
+        if (command.Command != EventCommand.Enable)
+        {
+            return;
+        }
+
+        this._diaCallRateCounter ??= new IncrementingPollingCounter("dia-call-rate", this, () => Volatile.Read(ref this._diaCalls))
+        {
+            DisplayName = "DIA Calls",
+            DisplayRateTimeScale = TimeSpan.FromSeconds(1)
+        };
+        this._symbolsParsedRateCounter ??= new IncrementingPollingCounter("symbols-parsed-rate", this, () => Volatile.Read(ref this._symbolsParsed))
+        {
+            DisplayName = "Symbols Parsed",
+            DisplayRateTimeScale = TimeSpan.FromSeconds(1)
+        };
+        this._symbolCacheHitRateCounter ??= new IncrementingPollingCounter("symbol-cache-hit-rate", this, () => Volatile.Read(ref this._symbolCacheHits))
+        {
+            DisplayName = "Symbols Found in the SessionDataCache",
+            DisplayRateTimeScale = TimeSpan.FromSeconds(1)
+        };
+        this._symbolCacheMissRateCounter ??= new IncrementingPollingCounter("symbol-cache-miss-rate", this, () => Volatile.Read(ref this._symbolCacheMisses))
+        {
+            DisplayName = "Symbols Not Found in the SessionDataCache",
+            DisplayRateTimeScale = TimeSpan.FromSeconds(1)
+        };
+        this._symbolsEvictedRateCounter ??= new IncrementingPollingCounter("symbols-evicted-rate", this, () => Volatile.Read(ref this._symbolsEvicted))
+        {
+            DisplayName = "Symbols Evicted from the SessionDataCache",
+            DisplayRateTimeScale = TimeSpan.FromSeconds(1)
+        };
+        this._bytesMappedCounter ??= new PollingCounter("bytes-mapped", this, () => Volatile.Read(ref this._bytesMapped) / (1024.0 * 1024.0))
+        {
+            DisplayName = "Binary Bytes Mapped",
+            DisplayUnits = "MB"
+        };
+    }
+
+    protected override void Dispose(bool disposing)
+    {
+        this._diaCallRateCounter?.Dispose();
+        this._diaCallRateCounter = null;
+        this._symbolsParsedRateCounter?.Dispose();
+        this._symbolsParsedRateCounter = null;
+        this._symbolCacheHitRateCounter?.Dispose();
+        this._symbolCacheHitRateCounter = null;
+        this._symbolCacheMissRateCounter?.Dispose();
+        this._symbolCacheMissRateCounter = null;
+        this._symbolsEvictedRateCounter?.Dispose();
+        this._symbolsEvictedRateCounter = null;
+        this._bytesMappedCounter?.Dispose();
+        this._bytesMappedCounter = null;
+
+        base.Dispose(disposing);
+    }
+}
@@ -2,7 +2,6 @@
 using System.Globalization;
 using System.IO;
 using System.Reflection;
-using System.Reflection.PortableExecutable;
 using System.Runtime.CompilerServices;
 using System.Runtime.InteropServices;
 using System.Text;
@@ -46,6 +45,7 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
 {
     // Once we load DIA we never try to unload it, because it's very hard to deterministically collect all the COM objects before we unload the DLL.  That's why this is static.
     private static readonly LibraryModule _diaLibraryModule = LibraryModule.LoadModule(Path.Combine(Path.GetDirectoryName(Assembly.GetExecutingAssembly().Location) ?? ".", @"msdia140.dll"));
+    internal static LibraryModule DiaLibraryModule => _diaLibraryModule;
     private IDiaDataSourceEx2? _diaDataSource;
     private Session? _session;
     private PEFile? _peFile;
@@ -56,17 +56,18 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
     private uint _sectionAlignment;
     private readonly int _affinitizedThreadId;
 
-    private static readonly string[] debugFastlinkSwitchNames = ["/debug:fastlink"];
-
     [ThreadStatic]
     private static StringBuilder? tls_nameStringBuilder;
 
+    // Every call into this adapter starts here, which also makes it the place to count them.
     private void ThrowIfOnWrongThread()
     {
         if (Environment.CurrentManagedThreadId != this._affinitizedThreadId)
         {
             throw new InvalidOperationException($"This operation is not permitted on this thread.  This object expects to only interact with DIA on ManagedThreadId {this._affinitizedThreadId}, but it is being called on ManagedThreadId {Environment.CurrentManagedThreadId}.  This is a bug in SizeBench, not in your usage of it.");
         }
+
+        AnalysisEngineEventSource.Log.DIACall();
     }
 
     // There are several fields of this type that we want to access a lot without checking for null or using "!" everywhere, so these properties let us do that safely.
@@ -160,28 +161,7 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
         this._globalScope = this._diaSession.globalScope;
         var machineType = this._globalScope.machineType;
 
-        // See http://msdn.microsoft.com/en-us/library/windows/desktop/ms680313(v=vs.85).aspx
-        switch (machineType)
-        {
-            case 0x014c: // IMAGE_FILE_MACHINE_I386
-            case 0x8664: // IMAGE_FILE_MACHINE_AMD64
-            case 0x01c4: // IMAGE_FILE_MACHINE_ARM
-            case 0xAA64: // IMAGE_FILE_MACHINE_ARM64
-                break;
-            case 0: // Machine type not set in the PDB - ngen seems to do this, maybe other toolchains do too?
-                throw new BinaryNotAnalyzableException("This binary does not have a machine type set in the PDB.  SizeBench does not yet know how to analyze this code.  Is this an ngen'd binary?");
-            case 0xC0EE: // IMAGE_FILE_MACHINE_CEE, aka managed code
-                throw new BinaryNotAnalyzableException("This binary appears to contain managed code.  SizeBench does not yet know how to analyze managed code.");
-            case 0x3A64: // IMAGE_FILE_MACHINE_CHPE_X86
-                throw new BinaryNotAnalyzableException("This binary appears to be a CHPE binary.  SizeBench does not yet know how to analyze CHPE binaries.");
-            case 0xA641: // IMAGE_FILE_MACHINE_ARM64EC
-                throw new BinaryNotAnalyzableException("This binary appears to be a ARM64EC binary.  SizeBench does not yet know how to analyze ARM64EC binaries.");
-            case 0xA64E: // IMAGE_FILE_MACHINE_ARM64X
-                throw new BinaryNotAnalyzableException("This binary appears to be a ARM64X binary.  SizeBench does not yet know how to analyze ARM64X binaries.");
-
-            default:
-                throw new InvalidOperationException("Unknown machine type!");
-        }
+        PDBAdapterCommon.ThrowIfMachineTypeNotSupported(machineType);
     }
 
     internal void Initialize(PEFile peFile, ILogger logger)
@@ -195,40 +175,11 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
 
         ThrowIfPDBNotSuitableForAnalysis();
 
-        // If we found a debug signature, let's try to validate that it matches the PDB being loaded.  If not, then the user
-        // has selected a mismatched PDB/Binary pair which isn't a good idea - we'll likely discover weird mismatches later, so
-        // instead fail out very early here to make this clear.
-        if (this.Session.PEFile!.DebugSignature != null)
-        {
-            if (this.Session.PEFile.DebugSignature.PdbGuid != this.DiaGlobalScope.guid)
-            {
-                throw new BinaryAndPDBSignatureMismatchException($"Binary and PDB do not match debug signatures, they appear to be from different builds.  SizeBench requires that a binary and PDB match exactly." + Environment.NewLine +
-                                                                 $"Binary guid={this.Session.PEFile.DebugSignature.PdbGuid}, PDB guid={this.DiaGlobalScope.guid}");
-            }
-
-            if (this.Session.PEFile.DebugSignature.Age != this.DiaGlobalScope.age)
-            {
-                throw new BinaryAndPDBSignatureMismatchException($"Binary and PDB do not match debug signatures, they appear to be from different builds.  SizeBench requires that a binary and PDB match exactly." + Environment.NewLine +
-                                                                 $"Binary age={this.Session.PEFile.DebugSignature.Age}, PDB age={this.DiaGlobalScope.age}");
-            }
-        }
-
-        var xdataRVARangeFromCoffGroupsIfAvailable = GetXDataRVARangeFromCoffGroupsIfAvailable();
+        PDBAdapterCommon.ThrowIfDebugSignatureMismatch(peFile, this.DiaGlobalScope.guid, this.DiaGlobalScope.age);
 
-        // We know that the COFF Groups are populated by this point, because we needed them to get the XDATA RVA Range above.
-        // So using these doesn't incur any additional overhead in parsing stuff, just a bit of manipulation of the RVA Ranges
-        // to make the RVARangeSet of virtual RVA Ranges needed during symbol parsing (to know if a symbol is in on-disk space
-        // or only in virtual space in memory).
-        var fullyVirtualRVARanges = new List<RVARange>();
-        foreach (var cg in this.DataCache.AllCOFFGroups!)
-        {
-            if (cg.IsVirtualSizeOnly)
-            {
-                fullyVirtualRVARanges.Add(RVARange.FromRVAAndSize(cg.RVA, cg.VirtualSize, isVirtualSize: true));
-            }
-        }
+        var xdataRVARangeFromCoffGroupsIfAvailable = PDBAdapterCommon.GetXDataRVARangeFromCoffGroupsIfAvailable(this.Session);
 
-        this.DataCache.RVARangesThatAreOnlyVirtualSize = RVARangeSet.FromListOfRVARanges(fullyVirtualRVARanges, this._peFile.BytesPerWord);
+        PDBAdapterCommon.InitializeRVARangesThatAreOnlyVirtualSize(this.DataCache, this._peFile.BytesPerWord);
 
         if (this.SupportsDataSymbols)
         {
@@ -250,7 +201,7 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
 
         {
             using var preProcessLog = logger.StartTaskLog("Pre-processing appropriate symbols");
-            PreProcessSymbols(preProcessLog, CancellationToken.None);
+            PDBAdapterCommon.PreProcessSymbolsOrLoadFromCache(this.Session, peFile, this.DataCache, preProcessLog, PreProcessSymbols, SymIndexIdIsAtRVA);
         }
 
         // It is important that this comes after RVARangesThatAreOnlyVirtualSize is set up, as some of the EH Symbols may need
@@ -269,6 +220,20 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
         this.DataCache.OtherPESymbolsHaveBeenInitialized = true;
     }
 
+    private bool SymIndexIdIsAtRVA(uint symIndexId, uint rva)
+    {
+        try
+        {
+            this.DiaSession.symbolById(symIndexId, out var diaSymbol);
+            return diaSymbol is not null && diaSymbol.relativeVirtualAddress == rva;
+        }
+        catch (COMException)
+        {
+            // DIA doesn't know of any symbol with this symIndexId.
+            return false;
+        }
+    }
+
     private LinkerCommandLine? GetLinkerCommandLine()
     {
         ThrowIfDisposingOrDisposed();
@@ -285,61 +250,15 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
 
     private void ThrowIfPDBNotSuitableForAnalysis()
     {
-        var linkerCommandLine = GetLinkerCommandLine();
-
-        if (AreSymbolsStripped())
-        {
-            throw new PDBNotSuitableForAnalysisException("This PDB is stripped - it contains only public symbols.  This is not suitable for analysis purposes, a full PDB with private symbols is required.");
-        }
-
-        if (IsBBTedBinary())
-        {
-            throw new PDBNotSuitableForAnalysisException("This PDB is for a binary that has gone through BBT - SizeBench doesn't yet support this.  Please use the pre-BBT'd binary and PDB, which your build system should be producing already.");
-        }
-
-        // Older linkers don't record the linker command line at all in a mini-PDB, so we'll catch that last here, to try to catch more specific failure
-        // cases with more specific error messages above.
-        if (linkerCommandLine is null)
-        {
-            throw new PDBNotSuitableForAnalysisException("Unable to find the linker command-line used, this binary was probably produced by using /debug:fastlink in your link command - please generate a full PDB with /debug:full for use with SizeBench.");
-        }
-
         this._diaSession!.isPortablePDB(out var isPortablePdb);
-
-        if (isPortablePdb != 0)
-        {
-            throw new PDBNotSuitableForAnalysisException("This PDB is a 'Portable PDB', which has very different data than SizeBench was designed to analyze in traditional PDBs.");
-        }
-
         this._diaSession!.isFastLinkPDB(out var isFastLinkPdb);
 
-        if (isFastLinkPdb != 0 ||
-            linkerCommandLine.GetSwitchState(debugFastlinkSwitchNames, CommandLineSwitchState.SwitchNotFound, CommandLineOrderOfPrecedence.LastWins, StringComparison.OrdinalIgnoreCase) == CommandLineSwitchState.SwitchEnabled)
-        {
-            throw new PDBNotSuitableForAnalysisException("This PDB is a 'Mini PDB', also known as a 'fast link PDB' which is not suitable for static analysis purposes.  This PDB was probably produced by using /debug:fastlink in your link command - please generate a full PDB with /debug:full for use with SizeBench.");
-        }
-
-        if (linkerCommandLine.IsPGInstrumented)
-        {
-            throw new PDBNotSuitableForAnalysisException("This binary is a PGI binary, meaning it is instrumented for PGO training by using /ltcg:pgi or /[fast]genprofile on your linker command line.  This is not a useful kind of binary to analyze, and SizeBench has a lot of trouble parsing such binaries.  Please use a regular binary either before or after PGO training has been applied.");
-        }
-
-        if (linkerCommandLine is not MSVC_LINK_CommandLine)
-        {
-            throw new PDBNotSuitableForAnalysisException($"This binary was linked with '{linkerCommandLine.ToolName}'.  Currently, SizeBench requires linking with link.exe or lld-link.exe, as only those PDBs contain sufficient information.");
-        }
-
-        if (linkerCommandLine.IncrementallyLinked)
-        {
-            throw new PDBNotSuitableForAnalysisException("This binary is using incremental linking (such as /ltcg:incremental, or /debug without specifying /incremental:no).  This is not valid for SizeBench's static analysis purposes - please use /ltcg or /incremental:no or otherwise ensure a full link happens.");
-        }
-
-        this.DataCache.LinkerDetected = linkerCommandLine switch
-        {
-            LLD_LINK_CommandLine => Linker.LLD,
-            MSVC_LINK_CommandLine => Linker.MSVC,
-            _ => throw new InvalidOperationException("Unknown linker!")
-        };
+        PDBAdapterCommon.ThrowIfPDBNotSuitableForAnalysis(this.DataCache,
+                                                          GetLinkerCommandLine(),
+                                                          areSymbolsStripped: AreSymbolsStripped(),
+                                                          isBBTedBinary: IsBBTedBinary(),
+                                                          isPortablePdb: isPortablePdb != 0,
+                                                          isFastLinkPdb: isFastLinkPdb != 0);
     }
 
     private bool AreSymbolsStripped() => this.DiaGlobalScope.isStripped != 0;
@@ -358,18 +277,6 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
         return false;
     }
 
-    private RVARange? GetXDataRVARangeFromCoffGroupsIfAvailable()
-    {
-        var sections = this.Session.EnumerateBinarySectionsAndCOFFGroups(CancellationToken.None).Result;
-
-        // We are only looking for a COFF group named .xdata whose content parsing needs special handling. 
-        // the other .xdata COFF group .xdata$x can be enumerated using DIA, hence not included in this range.
-        // This seems like it could be potentially wrong for [cppxdata] stuff that's in .rdata and/or .data (I still don't
-        // know why it can end up there sometimes) - but so far in practice this seems to be enough so I guess I'll just
-        // live with the mystery of why this is enough...
-        return (from bs in sections from COFFGroup cg in bs.COFFGroups.Where(cg => cg.Name == ".xdata") select RVARange.FromRVAAndSize(cg.RVA, cg.Size)).FirstOrDefault();
-    }
-
     #endregion
 
     private bool IsSymbolSourceSuppored(IDiaSymbol diaSymbol)
@@ -408,24 +315,6 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
 
     #region Finding Binary Sections
 
-    private sealed record class RawBinarySection(string name, int rva, int size, int virtualSize, SectionCharacteristics characteristics)
-    {
-        public string Name { get; set; } = name;
-        public uint Size { get; private set; } = (uint)size;
-        public uint VirtualSize { get; private set; } = (uint)virtualSize;
-        public uint RVAStart { get; } = (uint)rva;
-        public SectionCharacteristics Characteristics { get; } = characteristics;
-
-        public void ExpandToInclude(int rva, int size, int virtualSize)
-        {
-            // There might be padding between these so we can't just add the [virtual]size, we need to calculate the length as (new final RVA - original starting RVA)
-            var newSize = rva + size - this.RVAStart;
-            var newVirtualSize = rva + virtualSize - this.RVAStart;
-            this.Size = (uint)newSize;
-            this.VirtualSize = (uint)newVirtualSize;
-        }
-    }
-
     public IEnumerable<BinarySection> FindBinarySections(IPEFile peFile, ILogger parentLogger, CancellationToken token)
     {
         ThrowIfOnWrongThread();
@@ -440,81 +329,7 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
         // name.  This happens especially with some types of code obfuscation.
         var coffGroups = FindCompressedRawCOFFGroups(peFile, parentLogger, token);
 
-        var almostFinal = new List<RawBinarySection>(capacity: 20);
-
-        // Sometimes multiple sections in a binary can share a name - obfuscated code can do this, and it seems kernel-mode code sometimes chooses to as well.
-        // SizeBench doesn't really want to deal with the complexity of multiple sections with the same name, since we rather regularly key off of name in
-        // dictionary lookups, database storage for SKUCrawler, UI in the GUI tool and such.  Because sections are sorted by name, all identically-named 
-        // sections will be adjacent anyway, so we'll just smush them together into one big section with that name.
-        //
-        // Additionally, some binaries have multiple sections with the same name but different characteristics - like sdbus.sys in Windows.  This is
-        // allowed, though it does generate the LNK4078 linker warning.  We don't want to merge those sections together because we depend on characteristics
-        // sometimes - so if the characteristics differ, we'll conjure up a new name to keep them unique.
-        RawBinarySection? pendingSection = null;
-        foreach (var section in peFile.PEReader.PEHeaders.SectionHeaders
-                                               .OrderBy(s => s.VirtualAddress))
-        {
-            if (pendingSection != null &&
-                pendingSection.Name == section.Name &&
-                pendingSection.Characteristics == section.SectionCharacteristics)
-            {
-                // If the name is identical to the one before this, merge the length.
-                pendingSection.ExpandToInclude(section.VirtualAddress, section.SizeOfRawData, section.VirtualSize);
-            }
-            else
-            {
-                if (pendingSection != null)
-                {
-                    almostFinal.Add(pendingSection);
-                    pendingSection = null;
-                }
-
-                pendingSection = new RawBinarySection(section.Name, section.VirtualAddress, section.SizeOfRawData, section.VirtualSize, section.SectionCharacteristics);
-            }
-        }
-
-        if (pendingSection != null)
-        {
-            almostFinal.Add(pendingSection);
-        }
-
-        var final = new List<BinarySection>();
-        var namesSeen = new List<string>(capacity: 10);
-
-        for (var i = 0; i < almostFinal.Count; i++)
-        {
-            var finalSection = almostFinal[i];
-
-            if (finalSection.Name.Length == 8)
-            {
-                // In some binaries, especially obfuscated ones, the section names can exceed the maximum length (8 characters) and be truncated by the linker.
-                // So for example, in mfcore.dll there are two sections called "?g_Encry" because both start with "?g_Encrypted".
-                // The linker has truncated this data, so the IMAGE_SECTION_HEADERS only contain the truncated data.  If we can find a COFF Group that has the same
-                // RVA and start of the name as a section, we'll prefer the COFF Group's name if it's longer.
-                foreach (var coffGroup in coffGroups)
-                {
-                    if (coffGroup.RVAStart == finalSection.RVAStart &&
-                        coffGroup.Name.Length > finalSection.Name.Length &&
-                        coffGroup.Name.StartsWith(finalSection.Name, StringComparison.Ordinal))
-                    {
-                        finalSection.Name = coffGroup.Name;
-                        break;
-                    }
-                }
-            }
-
-            if (namesSeen.Contains(finalSection.Name))
-            {
-                // These still have the same name - for that to be possible by the time we end up here, they must have differed in their characteristics, so
-                // the final name will take into account the characteristics as a differentiator to ensure unique names.
-                finalSection.Name += $" ({(uint)finalSection.Characteristics:X})";
-            }
-
-            final.Add(new BinarySection(this._cache, finalSection.Name, finalSection.Size, finalSection.VirtualSize, finalSection.RVAStart, this._fileAlignment, this._sectionAlignment, finalSection.Characteristics));
-            namesSeen.Add(finalSection.Name);
-        }
-
-        this.DataCache.AllBinarySections = final;
+        this.DataCache.AllBinarySections = PDBAdapterCommon.CreateBinarySections(this.DataCache, peFile, coffGroups, this._fileAlignment, this._sectionAlignment);
 
         return this.DataCache.AllBinarySections;
     }
@@ -572,97 +387,10 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
 
     private List<RawCOFFGroup> FindCompressedRawCOFFGroups(IPEFile peFile, ILogger parentLogger, CancellationToken token)
     {
-        var almostFinal = new List<RawCOFFGroup>();
-
-        // Some obfuscation technologies cause thousands or tens of thousands of COFF Groups to be created which are all
-        // extremely small (hundreds of bytes at the most).  This can cause pathologically bad performance in SizeBench and
-        // no consumer can possibly care about a specific one of these COFF Groups' size because their names are not intended to
-        // be for human consumption anyway.  So, we'll compress all of these into one COFF Group - the good news is we know that
-        // they all get put in a contiguous block within a section, so if we find one of these, we'll smush it together with all
-        // the other similar ones.
-        //
-        // Additionally, some binaries have identically named COFF Groups because they may have sections with identical names but
-        // different DataSectionFlags (characteristics).  We'll need to handle that here to ensure every COFF Group has a unique
-        // name since we key off the name in so many places.
-        var prefixToMerge = String.Empty;
-        RawCOFFGroup? pendingRawCG = null;
-        foreach (var coffGroup in this.DiaSession.EnumerateCoffGroupSymbols(peFile, token)
-                                                 .WithCancellation(token)
-                                                 .WithLogging(parentLogger, "COFF Groups")
-                                                 .OrderBy(cg => cg.RVAStart))
-        {
-            if (coffGroup.Name.Contains("$wbrd", StringComparison.Ordinal) ||
-                coffGroup.Name.StartsWith("?g_EncryptedSegment", StringComparison.Ordinal))
-            {
-                if (coffGroup.Name.StartsWith(prefixToMerge, StringComparison.Ordinal) && pendingRawCG != null)
-                {
-                    // If this is part of the existing section's wbrd COFF Group chunk, we'll merge it.
-                    pendingRawCG.ExpandToInclude(coffGroup.RVAStart, coffGroup.Length);
-                }
-                else
-                {
-                    // We've found the start of a new wbrd COFF Group chunk, so create the 'pseudo-CG' that we begin to merge
-
-                    // First yield the previous one, if there is one.  This way if .data$wbrd123 comes immediately before .rdata$wbrd123, we will yield
-                    // back the .data one.
-                    if (pendingRawCG != null)
-                    {
-                        almostFinal.Add(pendingRawCG);
-                        pendingRawCG = null;
-                        prefixToMerge = String.Empty;
-                    }
-
-                    if (coffGroup.Name.Contains("$wbrd", StringComparison.Ordinal))
-                    {
-                        prefixToMerge = coffGroup.Name[..(coffGroup.Name.IndexOf("$wbrd", StringComparison.Ordinal) + "$wbrd".Length)];
-                    }
-                    else if (coffGroup.Name.StartsWith("?g_EncryptedSegment", StringComparison.Ordinal))
-                    {
-                        // Example:
-                        // ?g_EncryptedSegmentSystemCall_160@WarbirdRuntime@@3U_ENCRYPTION_SEGMENT@1@C
-                        prefixToMerge = coffGroup.Name[..(coffGroup.Name.IndexOf('_', startIndex: "?g_E".Length) + "_".Length)];
-                    }
-                    pendingRawCG = new RawCOFFGroup(prefixToMerge + "<all>", coffGroup.Length, coffGroup.RVAStart, coffGroup.Characteristics);
-                }
-            }
-            else
-            {
-                if (pendingRawCG != null)
-                {
-                    almostFinal.Add(pendingRawCG);
-                    pendingRawCG = null;
-                    prefixToMerge = String.Empty;
-                }
-
-                almostFinal.Add(coffGroup);
-            }
-        }
-
-        if (pendingRawCG != null)
-        {
-            // In case the last thing we found was one of these COFF Groups, we still need to yield it back.
-            almostFinal.Add(pendingRawCG);
-        }
-
-        var final = new List<RawCOFFGroup>();
-        var namesSeen = new HashSet<string>(capacity: 10);
-
-        for (var i = 0; i < almostFinal.Count; i++)
-        {
-            var finalCG = almostFinal[i];
-
-            if (namesSeen.Contains(finalCG.Name))
-            {
-                // These still have the same name - for that to be possible by the time we end up here, they must have differed in their characteristics, so
-                // the final name will take into account the characteristics as a differentiator to ensure unique names.
-                finalCG = new RawCOFFGroup(finalCG.Name + $" ({(uint)finalCG.Characteristics:X})", finalCG.Length, finalCG.RVAStart, finalCG.Characteristics);
-            }
-
-            final.Add(finalCG);
-            namesSeen.Add(finalCG.Name);
-        }
-
-        return final;
+        return PDBAdapterCommon.CompressRawCOFFGroups(this.DiaSession.EnumerateCoffGroupSymbols(peFile, token)
+                                                                     .WithCancellation(token)
+                                                                     .WithLogging(parentLogger, "COFF Groups")
+                                                                     .OrderBy(cg => cg.RVAStart));
     }
 
     public IEnumerable<COFFGroup> FindCOFFGroups(IPEFile peFile, ILogger parentLogger, CancellationToken token)
@@ -766,52 +494,75 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
 
     #endregion
 
-    #region Finding RVA ranges with a source file and compiland
+    #region Finding RVA ranges with source files and compilands
 
-    public IEnumerable<RVARange> FindRVARangesForSourceFileAndCompiland(SourceFile sourceFile, Compiland compiland, CancellationToken token)
+    public Dictionary<(SourceFile sourceFile, Compiland compiland), List<RVARange>> FindRVARangesForSourceFilesAndCompilands(IReadOnlyList<SourceFile> sourceFiles, ILogger logger, CancellationToken token)
     {
         ThrowIfOnWrongThread();
 
-        var ranges = new List<RVARange>();
+        using var log = logger.StartTaskLog("Finding RVA ranges for every source file and compiland from the line number table");
 
-        foreach (var diaCompilandSymIndexId in compiland.SymIndexIds)
+        // One SourceFile can have several DIA file IDs, when DIA recorded the same file with different casing.
+        var sourceFilesByDiaFileId = new Dictionary<uint, SourceFile>(capacity: sourceFiles.Count);
+        foreach (var sourceFile in sourceFiles)
         {
-            this.DiaSession.symbolById(diaCompilandSymIndexId, out var diaCompiland);
             foreach (var diaFileId in sourceFile.DiaFileIds)
             {
-                this.DiaSession.findFileById(diaFileId, out var diaSourceFile);
-                this.DiaSession.findLines(diaCompiland, diaSourceFile, out var diaEnumLineNumbers);
+                sourceFilesByDiaFileId[diaFileId] = sourceFile;
+            }
+        }
 
-                foreach (var diaLineNumObject in diaEnumLineNumbers)
-                {
-                    token.ThrowIfCancellationRequested();
-                    if (diaLineNumObject != null)
-                    {
-                        if (diaLineNumObject is IDiaLineNumber diaLineNum)
-                        {
-                            // How do I know if this is virtual size here?  At the moment it seems that line number enumerations only ever find
-                            // code, so it's all 'real size' so passing false for isVirtualSize is fine.
-                            if (diaLineNum.length > 0)
-                            {
-                                var rva = diaLineNum.relativeVirtualAddress;
+        var rangesBySourceFileAndCompiland = new Dictionary<(SourceFile sourceFile, Compiland compiland), List<RVARange>>(capacity: sourceFiles.Count);
+        var lineNumbersSeen = 0;
 
-                                // When things are COMDAT-folded this gets tricky.  The line number was actaully used in multiple source files, but only
-                                // one of them actually 'holds' the contribution - so we need to check if this compiland believes it owns this RVA from
-                                // its section contributions.  If it does not, then this line number RVA was COMDAT folded elsewhere and we'll find it
-                                // and attribute it there instead.
-                                if (compiland.ContainsExecutableCodeAtRVA(rva))
-                                {
-                                    var newRange = RVARange.FromRVAAndSize(rva, diaLineNum.length, isVirtualSize: false);
-                                    ranges.Add(newRange);
-                                }
-                            }
-                        }
-                    }
+        foreach (var diaLineNum in this.DiaSession.EnumerateLineNumbers(log))
+        {
+            if (++lineNumbersSeen % 10_000 == 0)
+            {
+                token.ThrowIfCancellationRequested();
+            }
+
+            // How do I know if this is virtual size here?  At the moment it seems that line number enumerations only ever find
+            // code, so it's all 'real size' so passing false for isVirtualSize is fine.
+            if (diaLineNum.length == 0 ||
+                !sourceFilesByDiaFileId.TryGetValue(diaLineNum.sourceFileId, out var sourceFile))
+            {
+                continue;
+            }
+
+            // Compilands that don't contribute anything to the binary were never created, and weren't given to the source file either.
+            var compiland = this.DataCache.FindCompilandBySymIndexId(diaLineNum.compilandId);
+            if (compiland is null || !sourceFile._compilands.Contains(compiland))
+            {
+                continue;
+            }
+
+            var rva = diaLineNum.relativeVirtualAddress;
+
+            // When things are COMDAT-folded this gets tricky.  The line number was actaully used in multiple source files, but only
+            // one of them actually 'holds' the contribution - so we need to check if this compiland believes it owns this RVA from
+            // its section contributions.  If it does not, then this line number RVA was COMDAT folded elsewhere and we'll find it
+            // and attribute it there instead.
+            if (compiland.ContainsExecutableCodeAtRVA(rva))
+            {
+                if (!rangesBySourceFileAndCompiland.TryGetValue((sourceFile, compiland), out var ranges))
+                {
+                    ranges = new List<RVARange>();
+                    rangesBySourceFileAndCompiland.Add((sourceFile, compiland), ranges);
                 }
+
+                ranges.Add(RVARange.FromRVAAndSize(rva, diaLineNum.length, isVirtualSize: false));
             }
         }
 
-        return RVARangeSet.CoalesceRVARangesFromList(ranges);
+        foreach (var key in rangesBySourceFileAndCompiland.Keys)
+        {
+            rangesBySourceFileAndCompiland[key] = RVARangeSet.CoalesceRVARangesFromList(rangesBySourceFileAndCompiland[key]);
+        }
+
+        log.Log($"Found RVA ranges for {rangesBySourceFileAndCompiland.Count:N0} source file and compiland pairs from {lineNumbersSeen:N0} line numbers.");
+
+        return rangesBySourceFileAndCompiland;
     }
 
     #endregion
@@ -861,6 +612,185 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
         return allSymbols;
     }
 
+    // Finding duplicate data parses every file-static data symbol in every compiland, but almost all of them have a name that nothing
+    // else in the binary has, so they can't be duplicates of anything.  With a DIAWorkerPool, the walk over the compilands and the
+    // names of each symbol are looked up on the workers, and only the symbols that could be duplicates - those whose name appears more
+    // than once, or that are in XDATA - are parsed back here on the DIA thread.  DIA symbols can't be handed from one session to another,
+    // so each worker returns which compiland a symbol is in, its name, and its RVA, and those are used to find the same symbol again in
+    // this session.
+    //
+    // The symbols come back in the same order FindAllStaticDataSymbolsWithinCompiland would find them across 'compilands', so the
+    // duplicates found from them are too.  Returns null when there's no DIAWorkerPool to do this with.
+    public List<StaticDataSymbol>? FindStaticDataSymbolsThatMayBeDuplicates(HashSet<Compiland> compilands, ILogger logger, CancellationToken cancellationToken)
+    {
+        ThrowIfOnWrongThread();
+
+        var workerPool = this.Session.DIAWorkerPool;
+        if (workerPool is null || !this.SupportsDataSymbols)
+        {
+            return null;
+        }
+
+        // More partitions than workers, so a worker that draws a few small compilands can pick up more work instead of sitting idle.
+        var compilandPartitionCount = workerPool.WorkerCount * 4;
+        var dataSymbolsByPartition = workerPool.RunPartitioned(compilandPartitionCount, (diaSession, partition, token) =>
+        {
+            var dataSymbols = new List<(int compilandIndex, string? rawName, string name, uint rva)>();
+            var compilandIndex = 0;
+            void processDataSymbol(IDiaSymbol diaSymbol)
+            {
+                if ((LocationType)diaSymbol.locationType == LocationType.LocIsStatic && (DataKind)diaSymbol.dataKind == DataKind.DataIsFileStatic)
+                {
+                    var rawName = diaSymbol.name;
+                    dataSymbols.Add((compilandIndex, rawName, diaSymbol.undecoratedName ?? rawName ?? "<unknown name>", diaSymbol.relativeVirtualAddress));
+                }
+            }
+
+            SymTagEnum[] symTagsToSearchThrough = [SymTagEnum.SymTagCoffGroup, SymTagEnum.SymTagCompiland, SymTagEnum.SymTagData];
+            diaSession.findChildren(diaSession.globalScope, SymTagEnum.SymTagCompiland, name: null, compareFlags: 0, ppResult: out var diaCompilandEnum);
+            foreach (IDiaSymbol? diaCompiland in diaCompilandEnum)
+            {
+                token.ThrowIfCancellationRequested();
+                if (diaCompiland is not null && compilandIndex % compilandPartitionCount == partition)
+                {
+                    RecursivelyFindSymbols(diaCompiland, symTagsToSearchThrough, SymTagEnum.SymTagData, token, processDataSymbol);
+                }
+
+                compilandIndex++;
+            }
+
+            return dataSymbols;
+        }, cancellationToken);
+
+        var countsByName = new Dictionary<string, int>(StringComparer.Ordinal);
+        foreach (var dataSymbols in dataSymbolsByPartition)
+        {
+            foreach (var dataSymbol in dataSymbols)
+            {
+                countsByName[dataSymbol.name] = countsByName.GetValueOrDefault(dataSymbol.name) + 1;
+            }
+        }
+
+        // This session enumerates the compilands in the same order the workers' sessions do, which is how a compiland index from a worker
+        // becomes a compiland here.
+        var compilandSymIndexIds = new List<uint>();
+        this.DiaSession.findChildren(this.DiaGlobalScope, SymTagEnum.SymTagCompiland, name: null, compareFlags: 0, ppResult: out var compilandEnum);
+        foreach (IDiaSymbol? diaCompiland in compilandEnum)
+        {
+            if (diaCompiland is not null)
+            {
+                compilandSymIndexIds.Add(diaCompiland.symIndexId);
+            }
+        }
+
+        var candidatesByCompilandSymIndexId = new Dictionary<uint, List<(string? rawName, uint rva)>>();
+        var candidateCount = 0;
+        foreach (var dataSymbols in dataSymbolsByPartition)
+        {
+            foreach (var (compilandIndex, rawName, name, rva) in dataSymbols)
+            {
+                if (countsByName[name] < 2 && !this.DataCache.XDataRVARanges.Contains(rva))
+                {
+                    continue;
+                }
+
+                if (compilandIndex >= compilandSymIndexIds.Count)
+                {
+                    throw new InvalidOperationException($"A DIA worker found data in compiland #{compilandIndex}, but this session only has {compilandSymIndexIds.Count} compilands.  This is a bug in SizeBench's implementation, not your usage of it.");
+                }
+
+                var compilandSymIndexId = compilandSymIndexIds[compilandIndex];
+                if (!candidatesByCompilandSymIndexId.TryGetValue(compilandSymIndexId, out var candidates))
+                {
+                    candidates = new List<(string? rawName, uint rva)>();
+                    candidatesByCompilandSymIndexId.Add(compilandSymIndexId, candidates);
+                }
+
+                candidates.Add((rawName, rva));
+                candidateCount++;
+            }
+        }
+
+        logger.Log($"Found {candidateCount:N0} of {countsByName.Values.Sum():N0} file-static data symbols that may be duplicates using {workerPool.WorkerCount} DIA workers.");
+
+        // The workers found each compiland's candidates in the same order the serial walk would, so walking the candidates in the order the
+        // compilands are given keeps the whole list in the order FindAllStaticDataSymbolsWithinCompiland would produce it.
+        var allSymbols = new List<StaticDataSymbol>(capacity: candidateCount);
+        foreach (var compiland in compilands)
+        {
+            foreach (var diaCompilandSymIndexId in compiland.SymIndexIds)
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+                if (candidatesByCompilandSymIndexId.TryGetValue(diaCompilandSymIndexId, out var candidates))
+                {
+                    this.DiaSession.symbolById(diaCompilandSymIndexId, out var diaCompiland);
+                    FindStaticDataSymbolsInCompiland(diaCompiland, candidates, allSymbols, cancellationToken);
+                }
+            }
+        }
+
+        return allSymbols;
+    }
+
+    private void FindStaticDataSymbolsInCompiland(IDiaSymbol diaCompiland, List<(string? rawName, uint rva)> candidates, List<StaticDataSymbol> allSymbols, CancellationToken cancellationToken)
+    {
+        var diaSymbols = new IDiaSymbol?[candidates.Count];
+        var anyNotFoundByName = false;
+
+        // Most file-static data is a direct child of its compiland, so it can be found by name without looking at anything else in the compiland.
+        for (var i = 0; i < candidates.Count; i++)
+        {
+            var (rawName, rva) = candidates[i];
+            if (rawName is not null)
+            {
+                diaCompiland.findChildren(SymTagEnum.SymTagData, rawName, (uint)NameSearchOptions.nsfCaseSensitive, out var diaEnum);
+                foreach (IDiaSymbol? diaSymbol in diaEnum)
+                {
+                    if (diaSymbol is not null && IsStaticDataAtRVA(diaSymbol, rva))
+                    {
+                        diaSymbols[i] = diaSymbol;
+                        break;
+                    }
+                }
+            }
+
+            anyNotFoundByName |= diaSymbols[i] is null;
+        }
+
+        // Anything else is somewhere further down, so this falls back to the same walk FindAllStaticDataSymbolsWithinCompiland does.
+        if (anyNotFoundByName)
+        {
+            RecursivelyFindSymbols(diaCompiland, [SymTagEnum.SymTagCoffGroup, SymTagEnum.SymTagCompiland, SymTagEnum.SymTagData], SymTagEnum.SymTagData, cancellationToken,
+            (diaSymbol) =>
+            {
+                var name = diaSymbol.name;
+                for (var i = 0; i < candidates.Count; i++)
+                {
+                    if (diaSymbols[i] is null && candidates[i].rawName == name && IsStaticDataAtRVA(diaSymbol, candidates[i].rva))
+                    {
+                        diaSymbols[i] = diaSymbol;
+                        break;
+                    }
+                }
+            });
+        }
+
+        foreach (var diaSymbol in diaSymbols)
+        {
+            if (diaSymbol is null)
+            {
+                throw new InvalidOperationException($"A data symbol found by a DIA worker could not be found again in compiland {diaCompiland.name}.  This is a bug in SizeBench's implementation, not your usage of it.");
+            }
+
+            allSymbols.Add(GetOrCreateSymbol<StaticDataSymbol>(diaSymbol, cancellationToken));
+        }
+    }
+
+    private static bool IsStaticDataAtRVA(IDiaSymbol diaSymbol, uint rva)
+        => (LocationType)diaSymbol.locationType == LocationType.LocIsStatic &&
+           (DataKind)diaSymbol.dataKind == DataKind.DataIsFileStatic &&
+           diaSymbol.relativeVirtualAddress == rva;
+
     public IEnumerable<MemberDataSymbol> FindAllMemberDataSymbolsWithinUDT(UserDefinedTypeSymbol udt, CancellationToken cancellationToken)
     {
         ThrowIfOnWrongThread();
@@ -1532,6 +1462,61 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
                               .Select((diaSymbol) => GetOrCreateTypeSymbol<UserDefinedTypeSymbol>(diaSymbol, token));
     }
 
+    // Wasteful virtuals only cares about the functions of types in a hierarchy with virtual functions in it, but finding out which types
+    // have virtual functions means looking at every function of every type.  With a DIAWorkerPool, that's split up across the workers, and
+    // each returns the names of the types it found with a virtual function - names because the UserDefinedTypeSymbols only exist here on
+    // the DIA thread.  A name can be shared by more than one type, so all this can say is that a type whose name is not in the set has no
+    // virtual functions.  Returns null when there's no DIAWorkerPool to do this with.
+    public HashSet<string>? FindNamesOfUserDefinedTypesWithVirtualFunctions(ILogger logger, CancellationToken cancellationToken)
+    {
+        ThrowIfOnWrongThread();
+
+        var workerPool = this.Session.DIAWorkerPool;
+        if (workerPool is null)
+        {
+            return null;
+        }
+
+        var partitionCount = workerPool.WorkerCount * 4;
+        var namesByPartition = workerPool.RunPartitioned(partitionCount, (diaSession, partition, token) =>
+        {
+            var names = new List<string>();
+            var udtIndex = 0;
+            foreach (var diaUDT in diaSession.EnumerateUDTSymbols())
+            {
+                token.ThrowIfCancellationRequested();
+                if (udtIndex++ % partitionCount != partition)
+                {
+                    continue;
+                }
+
+                // The same search FindAllFunctionsWithinUDT does, and the same test for virtual-ness that the IFunctionCodeSymbols it
+                // returns would have.
+                var hasVirtualFunction = false;
+                RecursivelyFindSymbols(diaUDT, [SymTagEnum.SymTagFunction], SymTagEnum.SymTagFunction, token, (diaFunction) =>
+                {
+                    hasVirtualFunction |= diaFunction.@virtual != 0 && ((IDiaSymbol6)diaFunction).isStaticMemberFunc == 0;
+                });
+
+                if (hasVirtualFunction)
+                {
+                    names.Add(diaUDT.name);
+                }
+            }
+
+            return names;
+        }, cancellationToken);
+
+        var namesOfTypesWithVirtualFunctions = new HashSet<string>(StringComparer.Ordinal);
+        foreach (var names in namesByPartition)
+        {
+            namesOfTypesWithVirtualFunctions.UnionWith(names);
+        }
+
+        logger.Log($"Found {namesOfTypesWithVirtualFunctions.Count:N0} names of user-defined types with virtual functions using {workerPool.WorkerCount} DIA workers.");
+        return namesOfTypesWithVirtualFunctions;
+    }
+
     #endregion
 
     #region Finding Annotations
@@ -1704,7 +1689,7 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
                 }
 
                 var publicSymRVA = publicSym.relativeVirtualAddress;
-                var publicSymName = publicSym.undecoratedName;
+                var publicSymName = this.DataCache.UndecoratedNames.GetUndecoratedName(publicSym.name) ?? publicSym.undecoratedName;
 
                 // The "const " prefix is not useful to anything we do with vtable names, so we strip it if present.
                 if (publicSymName.StartsWith("const ", StringComparison.Ordinal))
@@ -1731,6 +1716,7 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
 
         if (this.DataCache.AllSymbolsBySymIndexId.TryGetValue(symIndexId, out var symbol))
         {
+            AnalysisEngineEventSource.Log.SymbolCacheHit();
             return (TSymbol)symbol;
         }
 
@@ -1752,6 +1738,7 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
 
         if(this.DataCache.AllTypesBySymIndexId.TryGetValue(symIndexId, out var typeSymbol))
         {
+            AnalysisEngineEventSource.Log.SymbolCacheHit();
             return (TSymbol)typeSymbol;
         }
 
@@ -1877,7 +1864,7 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
                 cancellationToken.ThrowIfCancellationRequested();
 
                 // We know the symIndices are already filtered by supported symbol sources, so we don't have to check that here.
-                foreach (var symIndex in symIndicesByRVA[i].symIndices)
+                foreach (var symIndex in symIndicesByRVA.SymIndicesAt(i))
                 {
                     var symbol = FindSymbolBySymIndexId<Symbol>(symIndex, cancellationToken);
 
@@ -2031,16 +2018,24 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
         {
             using var labelLog = logger.StartTaskLog("Finding RVAs of Labels");
 
-            RecursivelyFindSymbols(this.DiaGlobalScope, [SymTagEnum.SymTagCompiland, SymTagEnum.SymTagFunction, SymTagEnum.SymTagBlock, SymTagEnum.SymTagLabel],
-            SymTagEnum.SymTagLabel, cancellationToken,
-            (diaSymbol) =>
+            var workerPool = this.Session.DIAWorkerPool;
+            if (workerPool is null)
             {
-                var labelRVA = diaSymbol.relativeVirtualAddress;
-                if (labelRVA != 0)
+                RecursivelyFindSymbols(this.DiaGlobalScope, [SymTagEnum.SymTagCompiland, SymTagEnum.SymTagFunction, SymTagEnum.SymTagBlock, SymTagEnum.SymTagLabel],
+                SymTagEnum.SymTagLabel, cancellationToken,
+                (diaSymbol) =>
                 {
-                    rvasOfLabels.Add(labelRVA);
-                }
-            });
+                    var labelRVA = diaSymbol.relativeVirtualAddress;
+                    if (labelRVA != 0)
+                    {
+                        rvasOfLabels.Add(labelRVA);
+                    }
+                });
+            }
+            else
+            {
+                FindRVAsOfLabelsOnWorkers(workerPool, rvasOfLabels, labelLog, cancellationToken);
+            }
         }
 
         using (var findCanonicalNamesLog = logger.StartTaskLog("Finding canonical names for foldable RVAs"))
@@ -2051,6 +2046,58 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
         this.DataCache.InitializeRVARanges(rvaToSymIndexIDs, rvasOfLabels);
     }
 
+    // Labels are the one part of pre-processing that's a walk over every function and block in every compiland, and which only needs to
+    // produce RVAs - so it can be split up by compiland across the worker pool's DIA sessions.  Partition 0 looks at the functions reachable
+    // directly from the global scope, and every other partition looks at every Nth compiland.  Together that's the same set of scopes the
+    // serial walk above looks at.
+    private static void FindRVAsOfLabelsOnWorkers(DIAWorkerPool workerPool, HashSet<uint> rvasOfLabels, ILogger logger, CancellationToken cancellationToken)
+    {
+        // More partitions than workers, so a worker that draws a few small compilands can pick up more work instead of sitting idle.
+        var compilandPartitionCount = workerPool.WorkerCount * 4;
+        var rvasOfLabelsByPartition = workerPool.RunPartitioned(compilandPartitionCount + 1, (diaSession, partition, token) =>
+        {
+            var rvas = new List<uint>();
+            void processLabel(IDiaSymbol diaSymbol)
+            {
+                var labelRVA = diaSymbol.relativeVirtualAddress;
+                if (labelRVA != 0)
+                {
+                    rvas.Add(labelRVA);
+                }
+            }
+
+            SymTagEnum[] symTagsToSearchThrough = [SymTagEnum.SymTagFunction, SymTagEnum.SymTagBlock, SymTagEnum.SymTagLabel];
+            var globalScope = diaSession.globalScope;
+            if (partition == 0)
+            {
+                RecursivelyFindSymbols(globalScope, symTagsToSearchThrough, SymTagEnum.SymTagLabel, token, processLabel);
+                return rvas;
+            }
+
+            diaSession.findChildren(globalScope, SymTagEnum.SymTagCompiland, name: null, compareFlags: 0, ppResult: out var diaCompilandEnum);
+            var compilandIndex = 0;
+            foreach (IDiaSymbol? diaCompiland in diaCompilandEnum)
+            {
+                token.ThrowIfCancellationRequested();
+                if (diaCompiland is not null && compilandIndex % compilandPartitionCount == partition - 1)
+                {
+                    RecursivelyFindSymbols(diaCompiland, symTagsToSearchThrough, SymTagEnum.SymTagLabel, token, processLabel);
+                }
+
+                compilandIndex++;
+            }
+
+            return rvas;
+        }, cancellationToken);
+
+        foreach (var rvas in rvasOfLabelsByPartition)
+        {
+            rvasOfLabels.UnionWith(rvas);
+        }
+
+        logger.Log($"Found {rvasOfLabels.Count:N0} label RVAs using {workerPool.WorkerCount} DIA workers.");
+    }
+
     #endregion
 
     #region Finding VTable Count
@@ -2449,6 +2496,15 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
 
     #region Symbol Names
 
+    internal const UndName ThunkNameUndecorationFlags = UndName.UNDNAME_NO_PTR64 |
+                                                       UndName.UNDNAME_NO_ECSU |
+                                                       UndName.UNDNAME_NO_MEMBER_TYPE |
+                                                       UndName.UNDNAME_NO_ACCESS_SPECIFIERS |
+                                                       UndName.UNDNAME_NO_THISTYPE |
+                                                       UndName.UNDNAME_NO_ALLOCATION_LANGUAGE |
+                                                       UndName.UNDNAME_NO_FUNCTION_RETURNS |
+                                                       UndName.UNDNAME_NO_MS_KEYWORDS;
+
     private static string GetSymbolName(IDiaSymbol diaSymbol, IDiaSession diaSession, SessionDataCache dataCache)
     {
         var symTag = (SymTagEnum)diaSymbol.symTag;
@@ -2458,10 +2514,14 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
         // the FunctionType and recombining to a "FullName" elsewhere.
         // Data symbols also get complicated because the names for vftable symbols can be too short and we need to refer to
         // the PublicSymbols to find the full name.
+        //
+        // Public symbols have decorated names, which we undecorate ourselves when we can (see MSVCNameUndecorator) - that's much cheaper than
+        // DIA undecorating them on the other side of a COM call, and the results are shared by every symbol with the same name.
         switch (symTag)
         {
             case SymTagEnum.SymTagPublicSymbol:
-                return diaSymbol.undecoratedName ?? diaSymbol.name ?? "<unknown name>";
+                var publicSymbolName = diaSymbol.name;
+                return dataCache.UndecoratedNames.GetUndecoratedName(publicSymbolName) ?? diaSymbol.undecoratedName ?? publicSymbolName ?? "<unknown name>";
             case SymTagEnum.SymTagData:
                 var dataSymbolName = diaSymbol.undecoratedName ?? diaSymbol.name;
                 var dataKind = (DataKind)diaSymbol.dataKind;
@@ -2567,16 +2627,14 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
                 diaSession.findSymbolByRVA(diaSymbol.relativeVirtualAddress, SymTagEnum.SymTagPublicSymbol, out var thunkPublicSymbol);
                 if (thunkPublicSymbol is not null)
                 {
-                    thunkPublicSymbol.get_undecoratedNameEx((uint)(UndName.UNDNAME_NO_PTR64 |
-                                                                   UndName.UNDNAME_NO_ECSU |
-                                                                   UndName.UNDNAME_NO_MEMBER_TYPE |
-                                                                   UndName.UNDNAME_NO_ACCESS_SPECIFIERS |
-                                                                   UndName.UNDNAME_NO_THISTYPE |
-                                                                   UndName.UNDNAME_NO_ALLOCATION_LANGUAGE |
-                                                                   UndName.UNDNAME_NO_FUNCTION_RETURNS |
-                                                                   UndName.UNDNAME_NO_MS_KEYWORDS), out var undecoratedPublicName);
-
-                    return undecoratedPublicName ?? thunkPublicSymbol.undecoratedName ?? thunkPublicSymbol.name ?? "[thunk] <unknown name>";
+                    var thunkPublicSymbolName = thunkPublicSymbol.name;
+                    var undecoratedPublicName = dataCache.UndecoratedNames.GetUndecoratedName(thunkPublicSymbolName, ThunkNameUndecorationFlags);
+                    if (undecoratedPublicName is null)
+                    {
+                        thunkPublicSymbol.get_undecoratedNameEx((uint)ThunkNameUndecorationFlags, out undecoratedPublicName);
+                    }
+
+                    return undecoratedPublicName ?? thunkPublicSymbol.undecoratedName ?? thunkPublicSymbolName ?? "[thunk] <unknown name>";
                 }
 
                 // Fall back to whatever the thunk has as our best attempt.
@@ -2595,10 +2653,12 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
         TSymbol? returnValue;
         if (this.DataCache.AllTypesBySymIndexId.TryGetValue(diaSymbol.symIndexId, out var parsedSymbol))
         {
+            AnalysisEngineEventSource.Log.SymbolCacheHit();
             returnValue = parsedSymbol as TSymbol;
         }
         else
         {
+            AnalysisEngineEventSource.Log.SymbolCacheMiss();
             parsedSymbol = ParseTypeSymbol(diaSymbol, cancellationToken);
             returnValue = parsedSymbol as TSymbol;
         }
@@ -3221,10 +3281,12 @@ internal sealed class DIAAdapter : IDIAAdapter, IDisposable
         TSymbol? returnValue;
         if (this.DataCache.AllSymbolsBySymIndexId.TryGetValue(diaSymbol.symIndexId, out var parsedSymbol))
         {
+            AnalysisEngineEventSource.Log.SymbolCacheHit();
             returnValue = parsedSymbol as TSymbol;
         }
         else
         {
+            AnalysisEngineEventSource.Log.SymbolCacheMiss();
             parsedSymbol = ParseSymbol(diaSymbol, cancellationToken);
             returnValue = parsedSymbol as TSymbol;
         }
@@ -0,0 +1,115 @@
+﻿using System.Runtime.InteropServices;
+using Dia2Lib;
+using SizeBench.AnalysisEngine.COMInterop;
+using SizeBench.Threading.Tasks.Schedulers;
+
+namespace SizeBench.AnalysisEngine.DIAInterop;
+
+// DIA is thread-affinitive, so everything a Session does with its DIA session happens on one thread.  For walks over the whole PDB that
+// doesn't have to be the case though - a PDB can be opened in several DIA sessions at once, so this pool opens one per worker thread and
+// hands out pieces of a walk to whichever worker is idle.
+//
+// Each worker has its own DIA session, and DIA does not promise that a symIndexId in one session means the same symbol in another, nor
+// are any of the objects in the SessionDataCache safe to touch from more than one thread.  So work given to the pool must only read from
+// its own DIA session and must only return plain data (RVAs, lengths, names...) - the caller, back on the Session's DIA thread, is
+// responsible for merging what comes back into the SessionDataCache.
+internal sealed class DIAWorkerPool : IDisposable
+{
+    private readonly string _pdbPath;
+    private readonly QueuedTaskScheduler _taskScheduler;
+    private readonly TaskFactory _taskFactory;
+
+    // Opened lazily, the first time each worker thread is given something to do, so a pool that's never used never loads the PDB again.
+    private readonly ThreadLocal<WorkerDiaSession?> _workerDiaSession = new ThreadLocal<WorkerDiaSession?>();
+
+    public int WorkerCount { get; }
+
+    public DIAWorkerPool(string pdbPath, int workerCount)
+    {
+        ArgumentOutOfRangeException.ThrowIfNegativeOrZero(workerCount);
+
+        this._pdbPath = pdbPath;
+        this.WorkerCount = workerCount;
+        this._taskScheduler = new QueuedTaskScheduler(threadCount: workerCount,
+                                                      threadName: "SizeBench DIA worker",
+                                                      threadApartmentState: ApartmentState.STA,
+                                                      threadFinally: CloseDiaSessionOnThisThread);
+        this._taskFactory = new TaskFactory(this._taskScheduler);
+    }
+
+    /// <summary>
+    /// Runs <paramref name="work"/> once for each partition in [0, <paramref name="partitionCount"/>), each on whichever worker is free, and
+    /// waits for all of them to finish.
+    /// </summary>
+    /// <returns>The result of each partition, in partition order.</returns>
+    public T[] RunPartitioned<T>(int partitionCount, Func<IDiaSession, int, CancellationToken, T> work, CancellationToken token)
+    {
+        ObjectDisposedException.ThrowIf(this._isDisposed, this);
+
+        var tasks = new Task<T>[partitionCount];
+        for (var i = 0; i < partitionCount; i++)
+        {
+            var partition = i;
+            tasks[i] = this._taskFactory.StartNew(() => work(GetOrOpenDiaSessionOnThisThread(), partition, token), token);
+        }
+
+        // WhenAll+GetResult rather than WaitAll so the caller sees the first exception as-is instead of wrapped in an AggregateException, just
+        // as they would if the work had been done serially.
+        return Task.WhenAll(tasks).GetAwaiter().GetResult();
+    }
+
+    private IDiaSession GetOrOpenDiaSessionOnThisThread()
+    {
+        var workerDiaSession = this._workerDiaSession.Value;
+        if (workerDiaSession is null)
+        {
+            var diaDataSource = CoClassLoaderRegFree.CreateInstance<IDiaDataSourceEx2>(DIAAdapter.DiaLibraryModule, DIAAdapter.Dia140Clsid);
+            diaDataSource.loadDataFromPdbEx(this._pdbPath, fPdbPrefetching: 1);
+            diaDataSource.openSession(out var diaSession);
+            workerDiaSession = new WorkerDiaSession(diaDataSource, diaSession);
+            this._workerDiaSession.Value = workerDiaSession;
+        }
+
+        return workerDiaSession.DiaSession;
+    }
+
+    private void CloseDiaSessionOnThisThread()
+    {
+        var workerDiaSession = this._workerDiaSession.Value;
+        if (workerDiaSession is not null)
+        {
+            Marshal.ReleaseComObject(workerDiaSession.DiaSession);
+            Marshal.ReleaseComObject(workerDiaSession.DiaDataSource);
+            this._workerDiaSession.Value = null;
+        }
+    }
+
+    private sealed record class WorkerDiaSession(IDiaDataSourceEx2 DiaDataSource, IDiaSession DiaSession);
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    private void Dispose(bool disposing)
+    {
+        if (!this._isDisposed)
+        {
+            if (disposing)
+            {
+                // This joins each worker thread, and each closes its DIA session on the way out.
+                this._taskScheduler.Dispose();
+                this._workerDiaSession.Dispose();
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    public void Dispose()
+    {
+        Dispose(true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
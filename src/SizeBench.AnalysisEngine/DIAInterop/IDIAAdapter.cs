@@ -10,15 +10,17 @@ internal interface IDIAAdapter
     IEnumerable<COFFGroup> FindCOFFGroups(IPEFile peFile, ILogger logger, CancellationToken token);
     IEnumerable<RawSectionContribution> FindSectionContributions(ILogger logger, CancellationToken token);
     IEnumerable<SourceFile> FindSourceFiles(ILogger logger, CancellationToken token);
-    IEnumerable<RVARange> FindRVARangesForSourceFileAndCompiland(SourceFile sourceFile, Compiland compiland, CancellationToken token);
+    Dictionary<(SourceFile sourceFile, Compiland compiland), List<RVARange>> FindRVARangesForSourceFilesAndCompilands(IReadOnlyList<SourceFile> sourceFiles, ILogger logger, CancellationToken token);
     IEnumerable<MemberDataSymbol> FindAllMemberDataSymbolsWithinUDT(UserDefinedTypeSymbol udt, CancellationToken cancellationToken);
     IEnumerable<(uint typeId, uint offset)> FindAllBaseTypeIDsForUDT(UserDefinedTypeSymbol udt);
     IEnumerable<StaticDataSymbol> FindAllStaticDataSymbolsWithinCompiland(Compiland compiland, CancellationToken cancellation);
+    List<StaticDataSymbol>? FindStaticDataSymbolsThatMayBeDuplicates(HashSet<Compiland> compilands, ILogger logger, CancellationToken cancellation);
     IEnumerable<IFunctionCodeSymbol> FindAllFunctionsWithinUDT(uint symIndexId, CancellationToken cancellationToken);
     IEnumerable<IFunctionCodeSymbol> FindAllTemplatedFunctions(CancellationToken cancellationToken);
 
     IEnumerable<UserDefinedTypeSymbol> FindAllUserDefinedTypes(ILogger logger, CancellationToken token);
     IEnumerable<UserDefinedTypeSymbol> FindUserDefinedTypesByName(ILogger logger, string name, CancellationToken token);
+    HashSet<string>? FindNamesOfUserDefinedTypesWithVirtualFunctions(ILogger logger, CancellationToken token);
     IEnumerable<AnnotationSymbol> FindAllAnnotations(ILogger parentLogger, CancellationToken token);
     SortedList<uint, List<string>> FindAllDisambiguatingVTablePublicSymbolNamesByRVA(ILogger parentLogger, CancellationToken token);
     byte FindCountOfVTablesWithin(uint symIndexId);
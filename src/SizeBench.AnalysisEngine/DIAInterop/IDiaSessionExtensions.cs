@@ -158,70 +158,9 @@ internal static class IDiaSessionExtensions
                 }
             }
 
-            var discoveredSet = RVARangeSet.FromListOfRVARanges(diaCoffGroupRanges, maxPaddingToMerge: 8);
-
-            // lld-link sometimes leaves 'holes' between SymTagCoffGroup symbols that can be filled in by PE directories that we have already
-            // parsed, or by certain well-known tables like the .gfids/.giats tables.  We'll synthesize COFF Groups in this case, though arguably
-            // this is a bug in lld-link's PDB generation.
-            foreach (var directory in peFile.PEDirectorySymbols)
-            {
-                var directoryRVARange = RVARange.FromRVAAndSize(directory.RVA, directory.Size);
-                if (!discoveredSet.AtLeastPartiallyOverlapsWith(directoryRVARange))
-                {
-                    // We don't know what the characteristics ought to be, so we just won't specify any.
-                    yield return new RawCOFFGroup(directory.COFFGroupFallbackName, directory.Size, directory.RVA, 0);
-                }
-            }
-
-            if (peFile.GFIDSTable != null)
-            {
-                var gfidsRange = RVARange.FromRVAAndSize(peFile.GFIDSTable.RVA, peFile.GFIDSTable.Size);
-                if (!discoveredSet.AtLeastPartiallyOverlapsWith(gfidsRange))
-                {
-                    yield return new RawCOFFGroup(".gfids", peFile.GFIDSTable.Size, peFile.GFIDSTable.RVA, 0);
-                }
-            }
-
-            if (peFile.GIATSTable != null)
-            {
-                var giatsRange = RVARange.FromRVAAndSize(peFile.GIATSTable.RVA, peFile.GIATSTable.Size);
-                if (!discoveredSet.AtLeastPartiallyOverlapsWith(giatsRange))
-                {
-                    yield return new RawCOFFGroup(".giats", peFile.GIATSTable.Size, peFile.GIATSTable.RVA, 0);
-                }
-            }
-
-            var i = 0;
-            foreach (var importThunksRange in peFile.DelayLoadImportThunksRVARanges)
-            {
-                if (!discoveredSet.AtLeastPartiallyOverlapsWith(importThunksRange))
-                {
-                    var synthesizedName = i == 0 ? ".sizebench-synthesized-delay-load-import-thunks" : $".sizebench-synthesized-delay-load-import-thunks-{i}";
-                    i++;
-                    yield return new RawCOFFGroup(synthesizedName, importThunksRange.Size, importThunksRange.RVAStart, 0);
-                }
-            }
-
-            i = 0;
-            foreach (var importStringsRange in peFile.DelayLoadImportStringsRVARanges)
+            foreach (var synthesizedCoffGroup in PDBAdapterCommon.SynthesizeCOFFGroupsMissingFromPDB(diaCoffGroupRanges, peFile))
             {
-                if (!discoveredSet.AtLeastPartiallyOverlapsWith(importStringsRange))
-                {
-                    var synthesizedName = i == 0 ? ".sizebench-synthesized-delay-load-import-strings" : $".sizebench-synthesized-delay-load-import-strings-{i}";
-                    i++;
-                    yield return new RawCOFFGroup(synthesizedName, importStringsRange.Size, importStringsRange.RVAStart, 0);
-                }
-            }
-
-            i = 0;
-            foreach (var importModuleHandlesRange in peFile.DelayLoadModuleHandlesRVARanges)
-            {
-                if (!discoveredSet.AtLeastPartiallyOverlapsWith(importModuleHandlesRange))
-                {
-                    var synthesizedName = i == 0 ? ".sizebench-synthesized-delay-load-module-handles" : $".sizebench-synthesized-delay-load-module-handles-{i}";
-                    i++;
-                    yield return new RawCOFFGroup(synthesizedName, importModuleHandlesRange.Size, importModuleHandlesRange.RVAStart, 0);
-                }
+                yield return synthesizedCoffGroup;
             }
         }
     }
@@ -307,6 +246,48 @@ internal static class IDiaSessionExtensions
 
     #endregion
 
+    #region Enumerate Raw Line Numbers
+
+    // Every line number in the PDB, for every compiland and source file, in whatever order DIA keeps them.  Walking this table once is much
+    // cheaper than asking findLines for each (compiland, source file) pair, which on large binaries means tens of thousands of calls.
+    public static IEnumerable<IDiaLineNumber> EnumerateLineNumbers(this IDiaSession session, ILogger logger)
+    {
+        var enumLineNumbers = session.FindTable<IDiaEnumLineNumbersHandCoded>(logger);
+
+        if (enumLineNumbers is null)
+        {
+            yield break;
+        }
+
+        IDiaLineNumber? lineNumber;
+        var celt = 0u;
+        const int chunkSize = 1_000;
+        var intPtrs = new IntPtr[chunkSize];
+        var currentIntPtrsIndex = chunkSize;
+        var pin = GCHandle.Alloc(intPtrs, GCHandleType.Pinned);
+
+        try
+        {
+            while (true)
+            {
+                lineNumber = DiaChunkMarshaling.AdvanceToNewElementInChunk(enumLineNumbers, chunkSize, intPtrs, ref celt, ref currentIntPtrsIndex);
+
+                if (lineNumber is null || celt == 0)
+                {
+                    break;
+                }
+
+                yield return lineNumber;
+            }
+        }
+        finally
+        {
+            pin.Free();
+        }
+    }
+
+    #endregion
+
     #region Enumerate Raw Source Files
 
     public static IEnumerable<IDiaSourceFile> EnumerateDiaSourceFiles(this IDiaSession session, ILogger logger)
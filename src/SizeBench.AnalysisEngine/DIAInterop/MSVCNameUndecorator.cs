@@ -0,0 +1,1020 @@
+﻿using System.Globalization;
+using System.Text;
+
+namespace SizeBench.AnalysisEngine.DIAInterop;
+
+// Undecorates MSVC-decorated names in-process, producing the same text as DIA's undecoratedName and get_undecoratedNameEx so that naming a
+// symbol doesn't need a call across COM into DIA's undecorator (and so that the managed PDB reader can undecorate names at all).
+//
+// This covers the parts of the decoration grammar that the vast majority of public and data symbols use - functions, variables, vftables,
+// RTTI, string literals, templates, anonymous namespaces and function-local statics.  Anything else (thunks, pointers to members, arrays,
+// template arguments that refer to other symbols, MD5-hashed names, and so on) returns null, and callers should fall back to DIA or to the
+// decorated name, as they did before this existed.
+internal static class MSVCNameUndecorator
+{
+    /// <summary>
+    /// Undecorates a name the way DIA's undecorator would, honoring <paramref name="flags"/>.
+    /// </summary>
+    /// <returns>The undecorated name, or null if this isn't a decorated name or it uses something this undecorator doesn't support.</returns>
+    public static string? Undecorate(string decoratedName, UndName flags = UndName.UNDNAME_COMPLETE)
+    {
+        ArgumentNullException.ThrowIfNull(decoratedName);
+
+        if (decoratedName.Length == 0 || decoratedName[0] != '?' || (flags & UndName.UNDNAME_TYPE_ONLY) != 0)
+        {
+            return null;
+        }
+
+        var parser = new Parser(decoratedName, flags);
+        var undecoratedName = parser.ParseSymbol();
+
+        return parser.Failed || !parser.AtEnd ? null : undecoratedName;
+    }
+
+    private readonly record struct TypeName(string Left, string Right, bool IsPointerOrReference)
+    {
+        public static TypeName Simple(string name) => new TypeName(name, String.Empty, false);
+
+        public override string ToString() => this.Left + this.Right;
+    }
+
+    private enum SpecialName
+    {
+        None,
+        Constructor,
+        Destructor,
+        ConversionOperator,
+        ConstantTable, // vftables, vbtables and RTTI Complete Object Locators, which are "const Foo::`vftable'{for `IBar'}"
+        RTTIDescriptor,
+    }
+
+    // The decoration grammar never nests deep enough for recursion to be a concern, and anything malformed fails (which ends every loop
+    // below, since failing moves to the end of the name) rather than throwing - so a bad name costs about as much as a good one.
+    private sealed class Parser
+    {
+        private const int MaxBackReferences = 10;
+
+        private readonly string _name;
+        private readonly UndName _flags;
+        private int _pos;
+
+        // Backreferences are per template instantiation, so these get swapped out while parsing a template's arguments.  Names are keyed by
+        // their decorated text since different names can undecorate to the same thing, like two `anonymous namespace's.
+        private List<(string Key, string Name)> _names = new List<(string Key, string Name)>(MaxBackReferences);
+        private List<string> _parameterTypes = new List<string>(MaxBackReferences);
+
+        public Parser(string name, UndName flags)
+        {
+            this._name = name;
+            this._flags = flags;
+        }
+
+        public bool Failed { get; private set; }
+
+        public bool AtEnd => this._pos >= this._name.Length;
+
+        #region Symbols
+
+        public string ParseSymbol()
+        {
+            if (!Consume('?'))
+            {
+                return Fail();
+            }
+
+            if (StartsWith("?_C@"))
+            {
+                this._pos = this._name.Length;
+                return "`string'";
+            }
+
+            // MD5-hashed names (??@...@) have nothing left to undecorate
+            if (StartsWith("?@"))
+            {
+                return Fail();
+            }
+
+            if (Consume("?_R0"))
+            {
+                var rttiType = ParseTypeWithStorageClass();
+                return Consume("@8") ? $"{rttiType} `RTTI Type Descriptor'" : Fail();
+            }
+
+            string name;
+            var special = SpecialName.None;
+            if (Consume("?__E"))
+            {
+                name = $"`dynamic initializer for '{ParseDynamicInitializerTarget()}''";
+            }
+            else if (Consume("?__F"))
+            {
+                name = $"`dynamic atexit destructor for '{ParseDynamicInitializerTarget()}''";
+            }
+            else
+            {
+                var nameStart = this._pos;
+                var namesCount = this._names.Count;
+                name = ParseQualifiedName(out special);
+
+                // The compiler remembers the names of variable templates for backreferences, but not function templates, and there's no way
+                // to tell which this is until after the name - so variable templates have their name parsed again.
+                if (Peek() is >= '0' and <= '4' && this._name.AsSpan(nameStart).StartsWith("?$", StringComparison.Ordinal))
+                {
+                    this._pos = nameStart;
+                    this._names.RemoveRange(namesCount, this._names.Count - namesCount);
+                    name = ParseQualifiedName(out special, memorizeTemplate: true);
+                }
+            }
+
+            if (this.Failed)
+            {
+                return String.Empty;
+            }
+
+            switch (Peek())
+            {
+                case >= '0' and <= '4':
+                    return special == SpecialName.None ? ParseVariable(name) : Fail();
+                case '6' or '7':
+                    return special == SpecialName.ConstantTable ? ParseConstantTable(name) : Fail();
+                case '8':
+                    this._pos++;
+                    return special == SpecialName.RTTIDescriptor ? name : Fail();
+                default:
+                    return special is SpecialName.ConstantTable or SpecialName.RTTIDescriptor ? Fail() : ParseFunction(name, special);
+            }
+        }
+
+        private string ParseDynamicInitializerTarget()
+        {
+            // The target can be a full decorated name of its own (for static data members) - that's rare enough not to be worth supporting.
+            return Peek() == '?' ? Fail() : ParseQualifiedName(out _);
+        }
+
+        private string ParseVariable(string name)
+        {
+            var storageClass = Next();
+            var type = ParseType();
+            var isPtr64 = Consume('E');
+            var cv = ParseCVQualifiers();
+
+            if (HasFlag(UndName.UNDNAME_NAME_ONLY))
+            {
+                return name;
+            }
+
+            var result = new StringBuilder();
+            if (storageClass <= '2')
+            {
+                if (!HasFlag(UndName.UNDNAME_NO_ACCESS_SPECIFIERS))
+                {
+                    result.Append(storageClass switch { '0' => "private: ", '1' => "protected: ", _ => "public: " });
+                }
+                if (!HasFlag(UndName.UNDNAME_NO_MEMBER_TYPE))
+                {
+                    result.Append("static ");
+                }
+            }
+
+            result.Append(type.Left);
+            if (type.IsPointerOrReference)
+            {
+                // A pointer is already qualified by its own encoding, so all the storage class adds is the __ptr64 on the variable itself
+                if (isPtr64)
+                {
+                    AppendKeyword(result, Ptr64);
+                }
+            }
+            else
+            {
+                AppendKeyword(result, cv);
+            }
+
+            return result.Append(' ').Append(name).Append(type.Right).ToString();
+        }
+
+        private string ParseConstantTable(string name)
+        {
+            this._pos++;
+            var cv = ParseCVQualifiers();
+
+            var targets = new List<string>();
+            while (!this.Failed && !Consume('@'))
+            {
+                targets.Add(ParseQualifiedTypeName());
+            }
+
+            var result = new StringBuilder();
+            if (cv.Length > 0 && !HasFlag(UndName.UNDNAME_NAME_ONLY))
+            {
+                result.Append(cv).Append(' ');
+            }
+
+            result.Append(name);
+            if (targets.Count > 0)
+            {
+                result.Append("{for `").AppendJoin("'s `", targets).Append("'}");
+            }
+
+            return result.ToString();
+        }
+
+        private string ParseFunction(string name, SpecialName special)
+        {
+            var functionClass = Next();
+            string? access = null;
+            string? memberType = null;
+            var isInstanceMember = false;
+
+            switch (functionClass)
+            {
+                case >= 'A' and <= 'X':
+                    var index = functionClass - 'A';
+                    access = (index / 8) switch { 0 => "private: ", 1 => "protected: ", _ => "public: " };
+                    switch ((index % 8) / 2)
+                    {
+                        case 0:
+                            isInstanceMember = true;
+                            break;
+                        case 1:
+                            memberType = "static ";
+                            break;
+                        case 2:
+                            isInstanceMember = true;
+                            memberType = "virtual ";
+                            break;
+                        default:
+                            // Adjustor thunks
+                            return Fail();
+                    }
+                    break;
+                case 'Y' or 'Z':
+                    break;
+                default:
+                    // Virtual displacement thunks, extern "C" functions in C++/CLI and friends
+                    return Fail();
+            }
+
+            var thisIsPtr64 = false;
+            var thisCV = String.Empty;
+            if (isInstanceMember)
+            {
+                thisIsPtr64 = Consume('E');
+                thisCV = ParseCVQualifiers();
+            }
+
+            var callingConvention = ParseCallingConvention();
+
+            TypeName? returnType = null;
+            if (!Consume('@'))
+            {
+                returnType = ParseReturnType();
+            }
+            else if (special is not (SpecialName.Constructor or SpecialName.Destructor))
+            {
+                return Fail();
+            }
+
+            var parameters = ParseParameterList();
+            if (!Consume('Z') || this.Failed)
+            {
+                return Fail();
+            }
+
+            if (special == SpecialName.ConversionOperator)
+            {
+                if (returnType is null)
+                {
+                    return Fail();
+                }
+
+                name = $"{name} {returnType}";
+                returnType = null;
+            }
+
+            if (HasFlag(UndName.UNDNAME_NAME_ONLY))
+            {
+                return name;
+            }
+
+            var result = new StringBuilder();
+            if (access != null && !HasFlag(UndName.UNDNAME_NO_ACCESS_SPECIFIERS))
+            {
+                result.Append(access);
+            }
+            if (memberType != null && !HasFlag(UndName.UNDNAME_NO_MEMBER_TYPE))
+            {
+                result.Append(memberType);
+            }
+            if (returnType is TypeName returns && !HasFlag(UndName.UNDNAME_NO_FUNCTION_RETURNS))
+            {
+                if (returns.Right.Length > 0)
+                {
+                    // Functions returning pointers to functions need the whole declaration nested inside the return type
+                    return Fail();
+                }
+
+                result.Append(returns.Left).Append(' ');
+            }
+            if (!HasFlag(UndName.UNDNAME_NO_ALLOCATION_LANGUAGE) && callingConvention.Length > 0)
+            {
+                result.Append(callingConvention).Append(' ');
+            }
+
+            result.Append(name).Append('(').Append(parameters).Append(')');
+
+            if (isInstanceMember && !HasFlag(UndName.UNDNAME_NO_THISTYPE))
+            {
+                result.Append(thisCV);
+                if (thisIsPtr64)
+                {
+                    AppendKeyword(result, Ptr64);
+                }
+            }
+
+            return result.ToString();
+        }
+
+        #endregion
+
+        #region Names
+
+        private string ParseQualifiedName(out SpecialName special, bool memorizeTemplate = false)
+        {
+            var innermost = ParseInnermostName(out special, memorizeTemplate);
+
+            var scopes = new List<string>();
+            while (!this.Failed && !Consume('@'))
+            {
+                scopes.Add(ParseScopeName());
+            }
+
+            if (special is SpecialName.Constructor or SpecialName.Destructor)
+            {
+                // The name of a constructor or destructor is the name of its class (including any template arguments), and innermost has
+                // only the constructor's own template arguments, if it has any.
+                if (scopes.Count == 0)
+                {
+                    return Fail();
+                }
+
+                innermost = (special == SpecialName.Destructor ? "~" : String.Empty) + scopes[0] + innermost;
+            }
+
+            return JoinScopes(scopes, innermost);
+        }
+
+        private string ParseQualifiedTypeName()
+        {
+            string innermost;
+            if (IsDigit(Peek()))
+            {
+                innermost = ParseNameBackReference();
+            }
+            else if (StartsWith("?$"))
+            {
+                innermost = ParseTemplateName(out var special);
+                if (special != SpecialName.None)
+                {
+                    return Fail();
+                }
+            }
+            else
+            {
+                innermost = ParseSimpleName();
+            }
+
+            var scopes = new List<string>();
+            while (!this.Failed && !Consume('@'))
+            {
+                scopes.Add(ParseScopeName());
+            }
+
+            return JoinScopes(scopes, innermost);
+        }
+
+        private static string JoinScopes(List<string> scopes, string innermost)
+        {
+            if (scopes.Count == 0)
+            {
+                return innermost;
+            }
+
+            var result = new StringBuilder();
+            for (var i = scopes.Count - 1; i >= 0; i--)
+            {
+                result.Append(scopes[i]).Append("::");
+            }
+
+            return result.Append(innermost).ToString();
+        }
+
+        private string ParseInnermostName(out SpecialName special, bool memorizeTemplate)
+        {
+            special = SpecialName.None;
+
+            if (IsDigit(Peek()))
+            {
+                return ParseNameBackReference();
+            }
+            else if (StartsWith("?$"))
+            {
+                return ParseTemplateName(out special, memorizeTemplate);
+            }
+            else if (Consume('?'))
+            {
+                return ParseOperatorName(out special);
+            }
+            else
+            {
+                return ParseSimpleName();
+            }
+        }
+
+        private string ParseScopeName()
+        {
+            if (IsDigit(Peek()))
+            {
+                return ParseNameBackReference();
+            }
+            else if (StartsWith("?$"))
+            {
+                var template = ParseTemplateName(out var special);
+                return special == SpecialName.None ? template : Fail();
+            }
+            else if (StartsWith("?A"))
+            {
+                var start = this._pos;
+                this._pos += 2;
+                ParseSimpleName(memorize: false);
+                Memorize(this._name[start..this._pos], "`anonymous namespace'");
+                return "`anonymous namespace'";
+            }
+            else if (Consume('?'))
+            {
+                // A function-local scope, like `void __cdecl Foo(void)'::`2'
+                var scopeNumber = ParseNumber(out var isNegative);
+                if (isNegative || !Consume('?'))
+                {
+                    return Fail();
+                }
+
+                return $"`{ParseSymbol()}'::`{scopeNumber.ToString(CultureInfo.InvariantCulture)}'";
+            }
+            else
+            {
+                return ParseSimpleName();
+            }
+        }
+
+        private string ParseSimpleName(bool memorize = true)
+        {
+            var end = this._name.IndexOf('@', this._pos);
+            if (end <= this._pos)
+            {
+                return Fail();
+            }
+
+            var name = this._name[this._pos..end];
+            this._pos = end + 1;
+
+            if (memorize)
+            {
+                Memorize(name, name);
+            }
+
+            return name;
+        }
+
+        private string ParseNameBackReference()
+        {
+            var index = Next() - '0';
+            return index < this._names.Count ? this._names[index].Name : Fail();
+        }
+
+        private void Memorize(string key, string name)
+        {
+            if (this._names.Count >= MaxBackReferences)
+            {
+                return;
+            }
+
+            foreach (var existing in this._names)
+            {
+                if (existing.Key == key)
+                {
+                    return;
+                }
+            }
+
+            this._names.Add((key, name));
+        }
+
+        private string ParseTemplateName(out SpecialName special, bool memorize = true)
+        {
+            this._pos += "?$".Length;
+
+            var outerNames = this._names;
+            var outerParameterTypes = this._parameterTypes;
+            this._names = new List<(string Key, string Name)>(MaxBackReferences);
+            this._parameterTypes = new List<string>(MaxBackReferences);
+
+            special = SpecialName.None;
+            var name = Consume('?') ? ParseOperatorName(out special) : ParseSimpleName();
+            var arguments = ParseTemplateArguments();
+
+            this._names = outerNames;
+            this._parameterTypes = outerParameterTypes;
+
+            if (this.Failed)
+            {
+                return String.Empty;
+            }
+
+            var template = arguments.EndsWith('>') ? $"{name}<{arguments} >" : $"{name}<{arguments}>";
+            if (memorize && special == SpecialName.None)
+            {
+                Memorize(template, template);
+            }
+
+            return template;
+        }
+
+        private string ParseTemplateArguments()
+        {
+            // An empty argument list is how the compiler names things like the guard variables for thread-safe statics ($TSS0) - those
+            // aren't templates, and DIA doesn't display them as though they were.
+            if (Peek() == '@')
+            {
+                return Fail();
+            }
+
+            var arguments = new List<string>();
+            while (!this.Failed && !Consume('@'))
+            {
+                if (Consume("$$V") || Consume("$$Z") || Consume("$S"))
+                {
+                    // Empty parameter packs
+                    continue;
+                }
+                else if (Consume("$0"))
+                {
+                    var value = ParseNumber(out var isNegative);
+                    arguments.Add(isNegative ? "-" + value.ToString(CultureInfo.InvariantCulture) : value.ToString(CultureInfo.InvariantCulture));
+                }
+                else if (Peek() == '?' || (Peek() == '$' && !StartsWith("$$")))
+                {
+                    // Template parameters that refer to other template parameters, or to symbols, or to pointers to members
+                    return Fail();
+                }
+                else
+                {
+                    arguments.Add(ParseType().ToString());
+                }
+            }
+
+            return String.Join(',', arguments);
+        }
+
+        private string ParseOperatorName(out SpecialName special)
+        {
+            special = SpecialName.None;
+
+            switch (Next())
+            {
+                case '0':
+                    special = SpecialName.Constructor;
+                    return String.Empty;
+                case '1':
+                    special = SpecialName.Destructor;
+                    return String.Empty;
+                case '2': return "operator new";
+                case '3': return "operator delete";
+                case '4': return "operator=";
+                case '5': return "operator>>";
+                case '6': return "operator<<";
+                case '7': return "operator!";
+                case '8': return "operator==";
+                case '9': return "operator!=";
+                case 'A': return "operator[]";
+                case 'B':
+                    special = SpecialName.ConversionOperator;
+                    return "operator";
+                case 'C': return "operator->";
+                case 'D': return "operator*";
+                case 'E': return "operator++";
+                case 'F': return "operator--";
+                case 'G': return "operator-";
+                case 'H': return "operator+";
+                case 'I': return "operator&";
+                case 'J': return "operator->*";
+                case 'K': return "operator/";
+                case 'L': return "operator%";
+                case 'M': return "operator<";
+                case 'N': return "operator<=";
+                case 'O': return "operator>";
+                case 'P': return "operator>=";
+                case 'Q': return "operator,";
+                case 'R': return "operator()";
+                case 'S': return "operator~";
+                case 'T': return "operator^";
+                case 'U': return "operator|";
+                case 'V': return "operator&&";
+                case 'W': return "operator||";
+                case 'X': return "operator*=";
+                case 'Y': return "operator+=";
+                case 'Z': return "operator-=";
+                case '_':
+                    break;
+                default:
+                    return Fail();
+            }
+
+            switch (Next())
+            {
+                case '0': return "operator/=";
+                case '1': return "operator%=";
+                case '2': return "operator>>=";
+                case '3': return "operator<<=";
+                case '4': return "operator&=";
+                case '5': return "operator|=";
+                case '6': return "operator^=";
+                case '7':
+                    special = SpecialName.ConstantTable;
+                    return "`vftable'";
+                case '8':
+                    special = SpecialName.ConstantTable;
+                    return "`vbtable'";
+                case 'B': return "`local static guard'";
+                case 'D': return "`vbase destructor'";
+                case 'E': return "`vector deleting destructor'";
+                case 'F': return "`default constructor closure'";
+                case 'G': return "`scalar deleting destructor'";
+                case 'H': return "`vector constructor iterator'";
+                case 'I': return "`vector destructor iterator'";
+                case 'J': return "`vector vbase constructor iterator'";
+                case 'K': return "`virtual displacement map'";
+                case 'L': return "`eh vector constructor iterator'";
+                case 'M': return "`eh vector destructor iterator'";
+                case 'N': return "`eh vector vbase constructor iterator'";
+                case 'O': return "`copy constructor closure'";
+                case 'R':
+                    return ParseRTTIName(out special);
+                case 'S':
+                    special = SpecialName.ConstantTable;
+                    return "`local vftable'";
+                case 'T': return "`local vftable constructor closure'";
+                case 'U': return "operator new[]";
+                case 'V': return "operator delete[]";
+                case 'X': return "`placement delete closure'";
+                case 'Y': return "`placement delete[] closure'";
+                case '_':
+                    return Next() switch
+                    {
+                        'L' => "operator co_await",
+                        'M' => "operator<=>",
+                        _ => Fail(),
+                    };
+                default:
+                    return Fail();
+            }
+        }
+
+        private string ParseRTTIName(out SpecialName special)
+        {
+            special = SpecialName.RTTIDescriptor;
+
+            switch (Next())
+            {
+                case '1':
+                    var offsets = new string[4];
+                    for (var i = 0; i < offsets.Length; i++)
+                    {
+                        var value = ParseNumber(out var isNegative);
+                        offsets[i] = isNegative ? "-" + value.ToString(CultureInfo.InvariantCulture) : value.ToString(CultureInfo.InvariantCulture);
+                    }
+                    return $"`RTTI Base Class Descriptor at ({String.Join(',', offsets)})'";
+                case '2':
+                    return "`RTTI Base Class Array'";
+                case '3':
+                    return "`RTTI Class Hierarchy Descriptor'";
+                case '4':
+                    special = SpecialName.ConstantTable;
+                    return "`RTTI Complete Object Locator'";
+                default:
+                    return Fail();
+            }
+        }
+
+        #endregion
+
+        #region Types
+
+        private TypeName ParseType()
+        {
+            var typeCode = Next();
+            switch (typeCode)
+            {
+                case 'C': return TypeName.Simple("signed char");
+                case 'D': return TypeName.Simple("char");
+                case 'E': return TypeName.Simple("unsigned char");
+                case 'F': return TypeName.Simple("short");
+                case 'G': return TypeName.Simple("unsigned short");
+                case 'H': return TypeName.Simple("int");
+                case 'I': return TypeName.Simple("unsigned int");
+                case 'J': return TypeName.Simple("long");
+                case 'K': return TypeName.Simple("unsigned long");
+                case 'M': return TypeName.Simple("float");
+                case 'N': return TypeName.Simple("double");
+                case 'O': return TypeName.Simple("long double");
+                case 'X': return TypeName.Simple("void");
+                case '_':
+                    return Next() switch
+                    {
+                        'D' => TypeName.Simple("__int8"),
+                        'E' => TypeName.Simple("unsigned __int8"),
+                        'F' => TypeName.Simple("__int16"),
+                        'G' => TypeName.Simple("unsigned __int16"),
+                        'H' => TypeName.Simple("__int32"),
+                        'I' => TypeName.Simple("unsigned __int32"),
+                        'J' => TypeName.Simple("__int64"),
+                        'K' => TypeName.Simple("unsigned __int64"),
+                        'L' => TypeName.Simple("__int128"),
+                        'M' => TypeName.Simple("unsigned __int128"),
+                        'N' => TypeName.Simple("bool"),
+                        'Q' => TypeName.Simple("char8_t"),
+                        'S' => TypeName.Simple("char16_t"),
+                        'U' => TypeName.Simple("char32_t"),
+                        'W' => TypeName.Simple("wchar_t"),
+                        _ => FailType(),
+                    };
+                case 'T': return TypeName.Simple(TagKeyword("union ") + ParseQualifiedTypeName());
+                case 'U': return TypeName.Simple(TagKeyword("struct ") + ParseQualifiedTypeName());
+                case 'V': return TypeName.Simple(TagKeyword("class ") + ParseQualifiedTypeName());
+                case 'W':
+                    // The digit is the enum's underlying type, which DIA doesn't display
+                    return IsDigit(Next()) ? TypeName.Simple(TagKeyword("enum ") + ParseQualifiedTypeName()) : FailType();
+                case 'P': return ParsePointer("*", String.Empty);
+                case 'Q': return ParsePointer("*", "const");
+                case 'R': return ParsePointer("*", "volatile");
+                case 'S': return ParsePointer("*", "const volatile");
+                case 'A': return ParsePointer("&", String.Empty);
+                case 'B': return ParsePointer("&", "volatile");
+                case '$':
+                    if (Consume("$Q"))
+                    {
+                        return ParsePointer("&&", String.Empty);
+                    }
+                    else if (Consume("$R"))
+                    {
+                        return ParsePointer("&&", "volatile");
+                    }
+                    else if (Consume("$C"))
+                    {
+                        var cv = ParseCVQualifiers();
+                        var type = ParseType();
+                        return type.Right.Length == 0 ? type with { Left = AppendKeyword(type.Left, cv) } : FailType();
+                    }
+                    else if (Consume("$T"))
+                    {
+                        return TypeName.Simple("std::nullptr_t");
+                    }
+                    else if (Consume("$A6"))
+                    {
+                        var callingConvention = ParseCallingConvention();
+                        var returnType = ParseReturnType();
+                        var parameters = ParseParameterList();
+                        return Consume('Z') && returnType.Right.Length == 0 ?
+                               TypeName.Simple($"{AppendKeyword(returnType.Left, callingConvention)}({parameters})") :
+                               FailType();
+                    }
+                    return FailType();
+                case >= '0' and <= '9':
+                    var index = typeCode - '0';
+                    return index < this._parameterTypes.Count ? TypeName.Simple(this._parameterTypes[index]) : FailType();
+                default:
+                    // Arrays, pointers to members, and a long tail of rarer things
+                    return FailType();
+            }
+        }
+
+        private TypeName ParsePointer(string pointerKind, string pointerCV)
+        {
+            if (Consume('6'))
+            {
+                if (pointerKind != "*" || pointerCV.Length > 0)
+                {
+                    return FailType();
+                }
+
+                var callingConvention = ParseCallingConvention();
+                var returnType = ParseReturnType();
+                var parameters = ParseParameterList();
+                if (!Consume('Z') || returnType.Right.Length > 0)
+                {
+                    return FailType();
+                }
+
+                return new TypeName($"{returnType.Left} ({callingConvention}*", $")({parameters})", IsPointerOrReference: true);
+            }
+
+            var isPtr64 = Consume('E');
+            var pointeeCV = ParseCVQualifiers();
+            var pointee = ParseType();
+            if (pointee.Right.Length > 0)
+            {
+                return FailType();
+            }
+
+            var result = new StringBuilder(AppendKeyword(pointee.Left, pointeeCV));
+            result.Append(' ').Append(pointerKind);
+            if (isPtr64)
+            {
+                AppendKeyword(result, Ptr64);
+            }
+            AppendKeyword(result, pointerCV);
+
+            return new TypeName(result.ToString(), String.Empty, IsPointerOrReference: true);
+        }
+
+        private TypeName ParseTypeWithStorageClass()
+        {
+            if (!Consume('?'))
+            {
+                return ParseType();
+            }
+
+            var cv = ParseCVQualifiers();
+            var type = ParseType();
+            return type.IsPointerOrReference || type.Right.Length > 0 ? type : type with { Left = AppendKeyword(type.Left, cv) };
+        }
+
+        private TypeName ParseReturnType() => ParseTypeWithStorageClass();
+
+        private string ParseParameterList()
+        {
+            if (Consume('X'))
+            {
+                return "void";
+            }
+
+            var parameters = new List<string>();
+            while (!this.Failed)
+            {
+                if (Consume('@'))
+                {
+                    break;
+                }
+                else if (Consume('Z'))
+                {
+                    parameters.Add("...");
+                    break;
+                }
+
+                var start = this._pos;
+                var parameter = ParseType().ToString();
+
+                // Single-character types are cheaper to repeat than to refer back to, so only longer ones are remembered
+                if (this._pos - start > 1 && this._parameterTypes.Count < MaxBackReferences)
+                {
+                    this._parameterTypes.Add(parameter);
+                }
+
+                parameters.Add(parameter);
+            }
+
+            return String.Join(',', parameters);
+        }
+
+        private string ParseCallingConvention()
+        {
+            var keyword = Next() switch
+            {
+                'A' or 'B' => "__cdecl",
+                'C' or 'D' => "__pascal",
+                'E' or 'F' => "__thiscall",
+                'G' or 'H' => "__stdcall",
+                'I' or 'J' => "__fastcall",
+                'M' or 'N' => "__clrcall",
+                'Q' => "__vectorcall",
+                _ => Fail(),
+            };
+
+            return HasFlag(UndName.UNDNAME_NO_MS_KEYWORDS) ? String.Empty : Keyword(keyword);
+        }
+
+        private string ParseCVQualifiers()
+        {
+            return Next() switch
+            {
+                'A' => String.Empty,
+                'B' => "const",
+                'C' => "volatile",
+                'D' => "const volatile",
+                _ => Fail(),
+            };
+        }
+
+        private ulong ParseNumber(out bool isNegative)
+        {
+            isNegative = Consume('?');
+
+            var digit = Next();
+            if (IsDigit(digit))
+            {
+                return (ulong)(digit - '0') + 1;
+            }
+
+            // Anything else is hex, using A-P for 0-F, terminated by '@'
+            var value = 0UL;
+            for (; digit != '@'; digit = Next())
+            {
+                if (digit is < 'A' or > 'P' || value > (UInt64.MaxValue >> 4))
+                {
+                    Fail();
+                    return 0;
+                }
+
+                value = (value << 4) | (uint)(digit - 'A');
+            }
+
+            return value;
+        }
+
+        #endregion
+
+        #region Keywords and flags
+
+        private bool HasFlag(UndName flag) => (this._flags & flag) != 0;
+
+        private string Ptr64 => HasFlag(UndName.UNDNAME_NO_PTR64) || HasFlag(UndName.UNDNAME_NO_MS_KEYWORDS) ? String.Empty : Keyword("__ptr64");
+
+        private string Keyword(string keyword) => HasFlag(UndName.UNDNAME_NO_LEADING_UNDERSCORES) ? keyword.TrimStart('_') : keyword;
+
+        private string TagKeyword(string tag) => HasFlag(UndName.UNDNAME_NO_ECSU) ? String.Empty : tag;
+
+        private static string AppendKeyword(string text, string keyword) => keyword.Length == 0 ? text : $"{text} {keyword}";
+
+        private static void AppendKeyword(StringBuilder text, string keyword)
+        {
+            if (keyword.Length > 0)
+            {
+                text.Append(' ').Append(keyword);
+            }
+        }
+
+        #endregion
+
+        #region Reading the decorated name
+
+        private static bool IsDigit(char c) => c is >= '0' and <= '9';
+
+        private char Peek() => this._pos < this._name.Length ? this._name[this._pos] : '\0';
+
+        private char Next()
+        {
+            if (this._pos >= this._name.Length)
+            {
+                Fail();
+                return '\0';
+            }
+
+            return this._name[this._pos++];
+        }
+
+        private bool StartsWith(string prefix) => this._name.AsSpan(this._pos).StartsWith(prefix, StringComparison.Ordinal);
+
+        private bool Consume(char c)
+        {
+            if (Peek() == c && !this.AtEnd)
+            {
+                this._pos++;
+                return true;
+            }
+
+            return false;
+        }
+
+        private bool Consume(string prefix)
+        {
+            if (StartsWith(prefix))
+            {
+                this._pos += prefix.Length;
+                return true;
+            }
+
+            return false;
+        }
+
+        private string Fail()
+        {
+            this.Failed = true;
+            this._pos = this._name.Length;
+            return String.Empty;
+        }
+
+        private TypeName FailType() => TypeName.Simple(Fail());
+
+        #endregion
+    }
+}
@@ -0,0 +1,442 @@
+﻿using System.Reflection.PortableExecutable;
+using SizeBench.AnalysisEngine.PE;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.DIAInterop;
+
+// There is more than one way to read a PDB (DIA, or the managed reader in PDBInterop) but what SizeBench *does* with the raw data
+// should not depend on which reader produced it.  This class holds that shared logic, so both IDIAAdapter implementations make
+// the same decisions about which PDBs are analyzable, how sections and COFF Groups are merged and named, and so on.
+internal static class PDBAdapterCommon
+{
+    private static readonly string[] debugFastlinkSwitchNames = ["/debug:fastlink"];
+
+    #region Suitability checks
+
+    public static void ThrowIfMachineTypeNotSupported(uint machineType)
+    {
+        // See http://msdn.microsoft.com/en-us/library/windows/desktop/ms680313(v=vs.85).aspx
+        switch (machineType)
+        {
+            case 0x014c: // IMAGE_FILE_MACHINE_I386
+            case 0x8664: // IMAGE_FILE_MACHINE_AMD64
+            case 0x01c4: // IMAGE_FILE_MACHINE_ARM
+            case 0xAA64: // IMAGE_FILE_MACHINE_ARM64
+                break;
+            case 0: // Machine type not set in the PDB - ngen seems to do this, maybe other toolchains do too?
+                throw new BinaryNotAnalyzableException("This binary does not have a machine type set in the PDB.  SizeBench does not yet know how to analyze this code.  Is this an ngen'd binary?");
+            case 0xC0EE: // IMAGE_FILE_MACHINE_CEE, aka managed code
+                throw new BinaryNotAnalyzableException("This binary appears to contain managed code.  SizeBench does not yet know how to analyze managed code.");
+            case 0x3A64: // IMAGE_FILE_MACHINE_CHPE_X86
+                throw new BinaryNotAnalyzableException("This binary appears to be a CHPE binary.  SizeBench does not yet know how to analyze CHPE binaries.");
+            case 0xA641: // IMAGE_FILE_MACHINE_ARM64EC
+                throw new BinaryNotAnalyzableException("This binary appears to be a ARM64EC binary.  SizeBench does not yet know how to analyze ARM64EC binaries.");
+            case 0xA64E: // IMAGE_FILE_MACHINE_ARM64X
+                throw new BinaryNotAnalyzableException("This binary appears to be a ARM64X binary.  SizeBench does not yet know how to analyze ARM64X binaries.");
+
+            default:
+                throw new InvalidOperationException("Unknown machine type!");
+        }
+    }
+
+    public static void ThrowIfDebugSignatureMismatch(IPEFile peFile, Guid pdbGuid, uint pdbAge)
+    {
+        // If we found a debug signature, let's try to validate that it matches the PDB being loaded.  If not, then the user
+        // has selected a mismatched PDB/Binary pair which isn't a good idea - we'll likely discover weird mismatches later, so
+        // instead fail out very early here to make this clear.
+        if (peFile.DebugSignature != null)
+        {
+            if (peFile.DebugSignature.PdbGuid != pdbGuid)
+            {
+                throw new BinaryAndPDBSignatureMismatchException($"Binary and PDB do not match debug signatures, they appear to be from different builds.  SizeBench requires that a binary and PDB match exactly." + Environment.NewLine +
+                                                                 $"Binary guid={peFile.DebugSignature.PdbGuid}, PDB guid={pdbGuid}");
+            }
+
+            if (peFile.DebugSignature.Age != pdbAge)
+            {
+                throw new BinaryAndPDBSignatureMismatchException($"Binary and PDB do not match debug signatures, they appear to be from different builds.  SizeBench requires that a binary and PDB match exactly." + Environment.NewLine +
+                                                                 $"Binary age={peFile.DebugSignature.Age}, PDB age={pdbAge}");
+            }
+        }
+    }
+
+    public static void ThrowIfPDBNotSuitableForAnalysis(SessionDataCache dataCache,
+                                                        LinkerCommandLine? linkerCommandLine,
+                                                        bool areSymbolsStripped,
+                                                        bool isBBTedBinary,
+                                                        bool isPortablePdb,
+                                                        bool isFastLinkPdb)
+    {
+        if (areSymbolsStripped)
+        {
+            throw new PDBNotSuitableForAnalysisException("This PDB is stripped - it contains only public symbols.  This is not suitable for analysis purposes, a full PDB with private symbols is required.");
+        }
+
+        if (isBBTedBinary)
+        {
+            throw new PDBNotSuitableForAnalysisException("This PDB is for a binary that has gone through BBT - SizeBench doesn't yet support this.  Please use the pre-BBT'd binary and PDB, which your build system should be producing already.");
+        }
+
+        // Older linkers don't record the linker command line at all in a mini-PDB, so we'll catch that last here, to try to catch more specific failure
+        // cases with more specific error messages above.
+        if (linkerCommandLine is null)
+        {
+            throw new PDBNotSuitableForAnalysisException("Unable to find the linker command-line used, this binary was probably produced by using /debug:fastlink in your link command - please generate a full PDB with /debug:full for use with SizeBench.");
+        }
+
+        if (isPortablePdb)
+        {
+            throw new PDBNotSuitableForAnalysisException("This PDB is a 'Portable PDB', which has very different data than SizeBench was designed to analyze in traditional PDBs.");
+        }
+
+        if (isFastLinkPdb ||
+            linkerCommandLine.GetSwitchState(debugFastlinkSwitchNames, CommandLineSwitchState.SwitchNotFound, CommandLineOrderOfPrecedence.LastWins, StringComparison.OrdinalIgnoreCase) == CommandLineSwitchState.SwitchEnabled)
+        {
+            throw new PDBNotSuitableForAnalysisException("This PDB is a 'Mini PDB', also known as a 'fast link PDB' which is not suitable for static analysis purposes.  This PDB was probably produced by using /debug:fastlink in your link command - please generate a full PDB with /debug:full for use with SizeBench.");
+        }
+
+        if (linkerCommandLine.IsPGInstrumented)
+        {
+            throw new PDBNotSuitableForAnalysisException("This binary is a PGI binary, meaning it is instrumented for PGO training by using /ltcg:pgi or /[fast]genprofile on your linker command line.  This is not a useful kind of binary to analyze, and SizeBench has a lot of trouble parsing such binaries.  Please use a regular binary either before or after PGO training has been applied.");
+        }
+
+        if (linkerCommandLine is not MSVC_LINK_CommandLine)
+        {
+            throw new PDBNotSuitableForAnalysisException($"This binary was linked with '{linkerCommandLine.ToolName}'.  Currently, SizeBench requires linking with link.exe or lld-link.exe, as only those PDBs contain sufficient information.");
+        }
+
+        if (linkerCommandLine.IncrementallyLinked)
+        {
+            throw new PDBNotSuitableForAnalysisException("This binary is using incremental linking (such as /ltcg:incremental, or /debug without specifying /incremental:no).  This is not valid for SizeBench's static analysis purposes - please use /ltcg or /incremental:no or otherwise ensure a full link happens.");
+        }
+
+        dataCache.LinkerDetected = linkerCommandLine switch
+        {
+            LLD_LINK_CommandLine => Linker.LLD,
+            MSVC_LINK_CommandLine => Linker.MSVC,
+            _ => throw new InvalidOperationException("Unknown linker!")
+        };
+    }
+
+    #endregion
+
+    #region Initialization helpers
+
+    public static RVARange? GetXDataRVARangeFromCoffGroupsIfAvailable(Session session)
+    {
+        var sections = session.EnumerateBinarySectionsAndCOFFGroups(CancellationToken.None).Result;
+
+        // We are only looking for a COFF group named .xdata whose content parsing needs special handling.
+        // the other .xdata COFF group .xdata$x can be enumerated using DIA, hence not included in this range.
+        // This seems like it could be potentially wrong for [cppxdata] stuff that's in .rdata and/or .data (I still don't
+        // know why it can end up there sometimes) - but so far in practice this seems to be enough so I guess I'll just
+        // live with the mystery of why this is enough...
+        return (from bs in sections from COFFGroup cg in bs.COFFGroups.Where(cg => cg.Name == ".xdata") select RVARange.FromRVAAndSize(cg.RVA, cg.Size)).FirstOrDefault();
+    }
+
+    public static void InitializeRVARangesThatAreOnlyVirtualSize(SessionDataCache dataCache, byte bytesPerWord)
+    {
+        // We know that the COFF Groups are populated by this point, because we needed them to get the XDATA RVA Range.
+        // So using these doesn't incur any additional overhead in parsing stuff, just a bit of manipulation of the RVA Ranges
+        // to make the RVARangeSet of virtual RVA Ranges needed during symbol parsing (to know if a symbol is in on-disk space
+        // or only in virtual space in memory).
+        var fullyVirtualRVARanges = new List<RVARange>();
+        foreach (var cg in dataCache.AllCOFFGroups!)
+        {
+            if (cg.IsVirtualSizeOnly)
+            {
+                fullyVirtualRVARanges.Add(RVARange.FromRVAAndSize(cg.RVA, cg.VirtualSize, isVirtualSize: true));
+            }
+        }
+
+        dataCache.RVARangesThatAreOnlyVirtualSize = RVARangeSet.FromListOfRVARanges(fullyVirtualRVARanges, bytesPerWord);
+    }
+
+    public static void PreProcessSymbolsOrLoadFromCache(Session session, PEFile peFile, SessionDataCache dataCache, ILogger logger,
+                                                        Action<ILogger, CancellationToken> preProcessSymbols,
+                                                        Func<uint, uint, bool> symIndexIdIsAtRVA)
+    {
+        var cacheDirectory = session.SessionOptions.AnalysisCacheDirectory;
+        if (String.IsNullOrEmpty(cacheDirectory))
+        {
+            preProcessSymbols(logger, CancellationToken.None);
+            return;
+        }
+
+        var key = AnalysisCacheKey.Create(peFile, session.SessionOptions);
+        if (!AnalysisCacheFile.TryLoadPreProcessedSymbols(cacheDirectory, key, dataCache, logger, symIndexIdIsAtRVA))
+        {
+            preProcessSymbols(logger, CancellationToken.None);
+            AnalysisCacheFile.TrySavePreProcessedSymbols(cacheDirectory, key, dataCache, logger);
+        }
+    }
+
+    #endregion
+
+    #region Binary Sections
+
+    private sealed record class RawBinarySection(string name, int rva, int size, int virtualSize, SectionCharacteristics characteristics)
+    {
+        public string Name { get; set; } = name;
+        public uint Size { get; private set; } = (uint)size;
+        public uint VirtualSize { get; private set; } = (uint)virtualSize;
+        public uint RVAStart { get; } = (uint)rva;
+        public SectionCharacteristics Characteristics { get; } = characteristics;
+
+        public void ExpandToInclude(int rva, int size, int virtualSize)
+        {
+            // There might be padding between these so we can't just add the [virtual]size, we need to calculate the length as (new final RVA - original starting RVA)
+            var newSize = rva + size - this.RVAStart;
+            var newVirtualSize = rva + virtualSize - this.RVAStart;
+            this.Size = (uint)newSize;
+            this.VirtualSize = (uint)newVirtualSize;
+        }
+    }
+
+    public static List<BinarySection> CreateBinarySections(SessionDataCache dataCache, IPEFile peFile, List<RawCOFFGroup> coffGroups, uint fileAlignment, uint sectionAlignment)
+    {
+        var almostFinal = new List<RawBinarySection>(capacity: 20);
+
+        // Sometimes multiple sections in a binary can share a name - obfuscated code can do this, and it seems kernel-mode code sometimes chooses to as well.
+        // SizeBench doesn't really want to deal with the complexity of multiple sections with the same name, since we rather regularly key off of name in
+        // dictionary lookups, database storage for SKUCrawler, UI in the GUI tool and such.  Because sections are sorted by name, all identically-named
+        // sections will be adjacent anyway, so we'll just smush them together into one big section with that name.
+        //
+        // Additionally, some binaries have multiple sections with the same name but different characteristics - like sdbus.sys in Windows.  This is
+        // allowed, though it does generate the LNK4078 linker warning.  We don't want to merge those sections together because we depend on characteristics
+        // sometimes - so if the characteristics differ, we'll conjure up a new name to keep them unique.
+        RawBinarySection? pendingSection = null;
+        foreach (var section in peFile.PEReader.PEHeaders.SectionHeaders
+                                               .OrderBy(s => s.VirtualAddress))
+        {
+            if (pendingSection != null &&
+                pendingSection.Name == section.Name &&
+                pendingSection.Characteristics == section.SectionCharacteristics)
+            {
+                // If the name is identical to the one before this, merge the length.
+                pendingSection.ExpandToInclude(section.VirtualAddress, section.SizeOfRawData, section.VirtualSize);
+            }
+            else
+            {
+                if (pendingSection != null)
+                {
+                    almostFinal.Add(pendingSection);
+                    pendingSection = null;
+                }
+
+                pendingSection = new RawBinarySection(section.Name, section.VirtualAddress, section.SizeOfRawData, section.VirtualSize, section.SectionCharacteristics);
+            }
+        }
+
+        if (pendingSection != null)
+        {
+            almostFinal.Add(pendingSection);
+        }
+
+        var final = new List<BinarySection>();
+        var namesSeen = new List<string>(capacity: 10);
+
+        for (var i = 0; i < almostFinal.Count; i++)
+        {
+            var finalSection = almostFinal[i];
+
+            if (finalSection.Name.Length == 8)
+            {
+                // In some binaries, especially obfuscated ones, the section names can exceed the maximum length (8 characters) and be truncated by the linker.
+                // So for example, in mfcore.dll there are two sections called "?g_Encry" because both start with "?g_Encrypted".
+                // The linker has truncated this data, so the IMAGE_SECTION_HEADERS only contain the truncated data.  If we can find a COFF Group that has the same
+                // RVA and start of the name as a section, we'll prefer the COFF Group's name if it's longer.
+                foreach (var coffGroup in coffGroups)
+                {
+                    if (coffGroup.RVAStart == finalSection.RVAStart &&
+                        coffGroup.Name.Length > finalSection.Name.Length &&
+                        coffGroup.Name.StartsWith(finalSection.Name, StringComparison.Ordinal))
+                    {
+                        finalSection.Name = coffGroup.Name;
+                        break;
+                    }
+                }
+            }
+
+            if (namesSeen.Contains(finalSection.Name))
+            {
+                // These still have the same name - for that to be possible by the time we end up here, they must have differed in their characteristics, so
+                // the final name will take into account the characteristics as a differentiator to ensure unique names.
+                finalSection.Name += $" ({(uint)finalSection.Characteristics:X})";
+            }
+
+            final.Add(new BinarySection(dataCache, finalSection.Name, finalSection.Size, finalSection.VirtualSize, finalSection.RVAStart, fileAlignment, sectionAlignment, finalSection.Characteristics));
+            namesSeen.Add(finalSection.Name);
+        }
+
+        return final;
+    }
+
+    #endregion
+
+    #region COFF Groups
+
+    // lld-link sometimes leaves 'holes' between SymTagCoffGroup symbols that can be filled in by PE directories that we have already
+    // parsed, or by certain well-known tables like the .gfids/.giats tables.  We'll synthesize COFF Groups in this case, though arguably
+    // this is a bug in lld-link's PDB generation.
+    public static IEnumerable<RawCOFFGroup> SynthesizeCOFFGroupsMissingFromPDB(List<RVARange> coffGroupRangesFromPDB, IPEFile peFile)
+    {
+        var discoveredSet = RVARangeSet.FromListOfRVARanges(coffGroupRangesFromPDB, maxPaddingToMerge: 8);
+
+        foreach (var directory in peFile.PEDirectorySymbols)
+        {
+            var directoryRVARange = RVARange.FromRVAAndSize(directory.RVA, directory.Size);
+            if (!discoveredSet.AtLeastPartiallyOverlapsWith(directoryRVARange))
+            {
+                // We don't know what the characteristics ought to be, so we just won't specify any.
+                yield return new RawCOFFGroup(directory.COFFGroupFallbackName, directory.Size, directory.RVA, 0);
+            }
+        }
+
+        if (peFile.GFIDSTable != null)
+        {
+            var gfidsRange = RVARange.FromRVAAndSize(peFile.GFIDSTable.RVA, peFile.GFIDSTable.Size);
+            if (!discoveredSet.AtLeastPartiallyOverlapsWith(gfidsRange))
+            {
+                yield return new RawCOFFGroup(".gfids", peFile.GFIDSTable.Size, peFile.GFIDSTable.RVA, 0);
+            }
+        }
+
+        if (peFile.GIATSTable != null)
+        {
+            var giatsRange = RVARange.FromRVAAndSize(peFile.GIATSTable.RVA, peFile.GIATSTable.Size);
+            if (!discoveredSet.AtLeastPartiallyOverlapsWith(giatsRange))
+            {
+                yield return new RawCOFFGroup(".giats", peFile.GIATSTable.Size, peFile.GIATSTable.RVA, 0);
+            }
+        }
+
+        var i = 0;
+        foreach (var importThunksRange in peFile.DelayLoadImportThunksRVARanges)
+        {
+            if (!discoveredSet.AtLeastPartiallyOverlapsWith(importThunksRange))
+            {
+                var synthesizedName = i == 0 ? ".sizebench-synthesized-delay-load-import-thunks" : $".sizebench-synthesized-delay-load-import-thunks-{i}";
+                i++;
+                yield return new RawCOFFGroup(synthesizedName, importThunksRange.Size, importThunksRange.RVAStart, 0);
+            }
+        }
+
+        i = 0;
+        foreach (var importStringsRange in peFile.DelayLoadImportStringsRVARanges)
+        {
+            if (!discoveredSet.AtLeastPartiallyOverlapsWith(importStringsRange))
+            {
+                var synthesizedName = i == 0 ? ".sizebench-synthesized-delay-load-import-strings" : $".sizebench-synthesized-delay-load-import-strings-{i}";
+                i++;
+                yield return new RawCOFFGroup(synthesizedName, importStringsRange.Size, importStringsRange.RVAStart, 0);
+            }
+        }
+
+        i = 0;
+        foreach (var importModuleHandlesRange in peFile.DelayLoadModuleHandlesRVARanges)
+        {
+            if (!discoveredSet.AtLeastPartiallyOverlapsWith(importModuleHandlesRange))
+            {
+                var synthesizedName = i == 0 ? ".sizebench-synthesized-delay-load-module-handles" : $".sizebench-synthesized-delay-load-module-handles-{i}";
+                i++;
+                yield return new RawCOFFGroup(synthesizedName, importModuleHandlesRange.Size, importModuleHandlesRange.RVAStart, 0);
+            }
+        }
+    }
+
+    public static List<RawCOFFGroup> CompressRawCOFFGroups(IEnumerable<RawCOFFGroup> coffGroupsSortedByRVA)
+    {
+        var almostFinal = new List<RawCOFFGroup>();
+
+        // Some obfuscation technologies cause thousands or tens of thousands of COFF Groups to be created which are all
+        // extremely small (hundreds of bytes at the most).  This can cause pathologically bad performance in SizeBench and
+        // no consumer can possibly care about a specific one of these COFF Groups' size because their names are not intended to
+        // be for human consumption anyway.  So, we'll compress all of these into one COFF Group - the good news is we know that
+        // they all get put in a contiguous block within a section, so if we find one of these, we'll smush it together with all
+        // the other similar ones.
+        //
+        // Additionally, some binaries have identically named COFF Groups because they may have sections with identical names but
+        // different DataSectionFlags (characteristics).  We'll need to handle that here to ensure every COFF Group has a unique
+        // name since we key off the name in so many places.
+        var prefixToMerge = String.Empty;
+        RawCOFFGroup? pendingRawCG = null;
+        foreach (var coffGroup in coffGroupsSortedByRVA)
+        {
+            if (coffGroup.Name.Contains("$wbrd", StringComparison.Ordinal) ||
+                coffGroup.Name.StartsWith("?g_EncryptedSegment", StringComparison.Ordinal))
+            {
+                if (coffGroup.Name.StartsWith(prefixToMerge, StringComparison.Ordinal) && pendingRawCG != null)
+                {
+                    // If this is part of the existing section's wbrd COFF Group chunk, we'll merge it.
+                    pendingRawCG.ExpandToInclude(coffGroup.RVAStart, coffGroup.Length);
+                }
+                else
+                {
+                    // We've found the start of a new wbrd COFF Group chunk, so create the 'pseudo-CG' that we begin to merge
+
+                    // First yield the previous one, if there is one.  This way if .data$wbrd123 comes immediately before .rdata$wbrd123, we will yield
+                    // back the .data one.
+                    if (pendingRawCG != null)
+                    {
+                        almostFinal.Add(pendingRawCG);
+                        pendingRawCG = null;
+                        prefixToMerge = String.Empty;
+                    }
+
+                    if (coffGroup.Name.Contains("$wbrd", StringComparison.Ordinal))
+                    {
+                        prefixToMerge = coffGroup.Name[..(coffGroup.Name.IndexOf("$wbrd", StringComparison.Ordinal) + "$wbrd".Length)];
+                    }
+                    else if (coffGroup.Name.StartsWith("?g_EncryptedSegment", StringComparison.Ordinal))
+                    {
+                        // Example:
+                        // ?g_EncryptedSegmentSystemCall_160@WarbirdRuntime@@3U_ENCRYPTION_SEGMENT@1@C
+                        prefixToMerge = coffGroup.Name[..(coffGroup.Name.IndexOf('_', startIndex: "?g_E".Length) + "_".Length)];
+                    }
+                    pendingRawCG = new RawCOFFGroup(prefixToMerge + "<all>", coffGroup.Length, coffGroup.RVAStart, coffGroup.Characteristics);
+                }
+            }
+            else
+            {
+                if (pendingRawCG != null)
+                {
+                    almostFinal.Add(pendingRawCG);
+                    pendingRawCG = null;
+                    prefixToMerge = String.Empty;
+                }
+
+                almostFinal.Add(coffGroup);
+            }
+        }
+
+        if (pendingRawCG != null)
+        {
+            // In case the last thing we found was one of these COFF Groups, we still need to yield it back.
+            almostFinal.Add(pendingRawCG);
+        }
+
+        var final = new List<RawCOFFGroup>();
+        var namesSeen = new HashSet<string>(capacity: 10);
+
+        for (var i = 0; i < almostFinal.Count; i++)
+        {
+            var finalCG = almostFinal[i];
+
+            if (namesSeen.Contains(finalCG.Name))
+            {
+                // These still have the same name - for that to be possible by the time we end up here, they must have differed in their characteristics, so
+                // the final name will take into account the characteristics as a differentiator to ensure unique names.
+                finalCG = new RawCOFFGroup(finalCG.Name + $" ({(uint)finalCG.Characteristics:X})", finalCG.Length, finalCG.RVAStart, finalCG.Characteristics);
+            }
+
+            final.Add(finalCG);
+            namesSeen.Add(finalCG.Name);
+        }
+
+        return final;
+    }
+
+    #endregion
+}
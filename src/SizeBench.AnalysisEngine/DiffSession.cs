@@ -20,9 +20,12 @@ public sealed class DiffSession : IDiffSession
                                                  string afterBinaryPath, string afterPdbPath,
                                                  ILogger sessionLogger)
     {
+        // Most names are the same in both binaries, so each one only needs undecorating once.
+        var sessionOptions = new SessionOptions() { UndecoratedNameCache = new UndecoratedNameCache() };
+
 #pragma warning disable CA2000 // Dispose objects before losing scope - these get owned by the DiffSession and it disposes them.
-        var beforeOpenTask = Session.Create(beforeBinaryPath, beforePdbPath, sessionLogger);
-        var afterOpenTask = Session.Create(afterBinaryPath, afterPdbPath, sessionLogger);
+        var beforeOpenTask = Session.Create(beforeBinaryPath, beforePdbPath, sessionOptions, sessionLogger);
+        var afterOpenTask = Session.Create(afterBinaryPath, afterPdbPath, sessionOptions, sessionLogger);
 #pragma warning restore CA2000 // Dispose objects before losing scope
 
         var sessions = await Task.WhenAll(beforeOpenTask, afterOpenTask).ConfigureAwait(true);
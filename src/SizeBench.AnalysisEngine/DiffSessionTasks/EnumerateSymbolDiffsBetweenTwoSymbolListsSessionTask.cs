@@ -56,17 +56,26 @@ internal class EnumerateSymbolDiffsBetweenTwoSymbolListsSessionTask : DiffSessio
         // We'll group the symbols by type, to only attempt comparisons of symbols of the same type.
         // When comparing large symbol lists in large binaries this partitions the problem up
         // and speeds things up a ton.
-        var groupedBeforeSymbols = beforeSymbols.GroupBy(sym => sym.SymbolComparisonClass);
-        var groupedAfterSymbols = afterSymbols.GroupBy(sym => sym.SymbolComparisonClass);
+        //
+        // Within each type we then match in two passes.  Most symbols keep their name from one build to the next, so the first pass finds
+        // those with a hash lookup by name (or canonical name, for folded symbols) instead of scanning every 'after' symbol.  Only the
+        // symbols that pass can't match - typically the small fraction that were added, removed or renamed - fall back to comparing against
+        // every remaining 'after' symbol of the same type, since the rules for IsVeryLikelyTheSameAs don't always come down to a name.
+        var groupedBeforeSymbols = beforeSymbols.GroupBy(sym => sym.SymbolComparisonClass).ToList();
+        var afterSymbolIndicesByComparisonClass = Enumerable.Range(0, afterSymbols.Count).ToLookup(index => afterSymbols[index].SymbolComparisonClass);
+        var afterSymbolIsMatched = new bool[afterSymbols.Count];
 
         using (var beforeSymbolLoopLog = logger.StartTaskLog("Looping over 'before' symbols"))
         {
             foreach (var beforeSymbolTypeGroup in groupedBeforeSymbols)
             {
                 var beforeSymbolsOfThisType = beforeSymbolTypeGroup.ToList();
-                var afterGroup = groupedAfterSymbols.FirstOrDefault(group => group.Key == beforeSymbolTypeGroup.Key);
-                var afterSymbolsOfThisType = afterGroup?.ToList() ?? new List<ISymbol>();
-                foreach (var beforeSymbol in beforeSymbolsOfThisType)
+                var matchingAfterSymbols = MatchSymbolsOfOneType(beforeSymbolsOfThisType,
+                                                                 afterSymbols,
+                                                                 afterSymbolIndicesByComparisonClass[beforeSymbolTypeGroup.Key],
+                                                                 afterSymbolIsMatched);
+
+                for (var i = 0; i < beforeSymbolsOfThisType.Count; i++)
                 {
                     this.CancellationToken.ThrowIfCancellationRequested();
 
@@ -78,21 +87,13 @@ internal class EnumerateSymbolDiffsBetweenTwoSymbolListsSessionTask : DiffSessio
 
                     beforeSymbolsParsed++;
 
-                    // Find the matching symbol in 'after' - the rules for 'matching' are complex and depend on the symbol type so each
-                    // symbol type implements IsVeryLikelyTheSameAs independently.
-                    //
-                    // By removing the found matching symbol from the afterSymbols list, we gain two benefits - one is that each subsequent
-                    // loop of this foreach is faster by looking at less options, and second it means we tend to almost entirely exhaust the
-                    // afterSymbols list before getting into the second loop below, avoiding almost a full pass.
-                    var matchingAfterSymbol = afterSymbolsOfThisType.FirstOrDefault(beforeSymbol.IsVeryLikelyTheSameAs);
+                    var matchingAfterSymbol = matchingAfterSymbols[i];
                     if (matchingAfterSymbol != null)
                     {
-                        afterSymbolsOfThisType.Remove(matchingAfterSymbol); // Make the list smaller so the operation isn't a full two passes (one here, one in the loop below)
-                        afterSymbols.Remove(matchingAfterSymbol);
-                        afterSymbolsParsed++; // Because we removed one, let's keep the total marching towards "totalSymbolsToDiff"
+                        afterSymbolsParsed++; // Because this one is consumed here, let's keep the total marching towards "totalSymbolsToDiff"
                     }
 
-                    symbolDiffs.Add(SymbolDiffFactory.CreateSymbolDiff(beforeSymbol, matchingAfterSymbol, this.DataCache));
+                    symbolDiffs.Add(SymbolDiffFactory.CreateSymbolDiff(beforeSymbolsOfThisType[i], matchingAfterSymbol, this.DataCache));
                 }
             }
         }
@@ -102,10 +103,15 @@ internal class EnumerateSymbolDiffsBetweenTwoSymbolListsSessionTask : DiffSessio
         using (var afterSymbolLoopLog = logger.StartTaskLog("Looping over 'after' symbols"))
         {
             // Now catch any symbols that are in 'after' but weren't in 'before'
-            foreach (var afterSymbol in afterSymbols)
+            for (var afterIndex = 0; afterIndex < afterSymbols.Count; afterIndex++)
             {
                 this.CancellationToken.ThrowIfCancellationRequested();
 
+                if (afterSymbolIsMatched[afterIndex])
+                {
+                    continue;
+                }
+
                 if (afterSymbolsParsed >= nextLoggerOutput)
                 {
                     ReportProgress($"Parsed {afterSymbolsParsed:N0}/{afterSymbolsCount:N0} 'after' symbols into diffs.", afterSymbolsParsed + beforeSymbolsCount, totalSymbolsToDiff);
@@ -115,7 +121,7 @@ internal class EnumerateSymbolDiffsBetweenTwoSymbolListsSessionTask : DiffSessio
                 afterSymbolsParsed++;
 
                 // This one wasn't found in 'before' so it's new in the 'after'
-                symbolDiffs.Add(SymbolDiffFactory.CreateSymbolDiff(null, afterSymbol, this.DataCache));
+                symbolDiffs.Add(SymbolDiffFactory.CreateSymbolDiff(null, afterSymbols[afterIndex], this.DataCache));
             }
         }
 
@@ -126,4 +132,122 @@ internal class EnumerateSymbolDiffsBetweenTwoSymbolListsSessionTask : DiffSessio
 
         return symbolDiffs;
     }
+
+    // Returns the matching 'after' symbol for each of beforeSymbolsOfThisType (or null if there isn't one), and marks each 'after' symbol
+    // that gets matched in afterSymbolIsMatched so it can't be matched twice.
+    private ISymbol?[] MatchSymbolsOfOneType(List<ISymbol> beforeSymbolsOfThisType,
+                                             List<ISymbol> afterSymbols,
+                                             IEnumerable<int> afterSymbolIndicesOfThisType,
+                                             bool[] afterSymbolIsMatched)
+    {
+        var matchingAfterSymbols = new ISymbol?[beforeSymbolsOfThisType.Count];
+
+        // Each bucket is in 'after' order, so when several 'after' symbols share a name they're matched up in the order they appear, just
+        // as they would be by scanning the list.
+        var afterSymbolIndicesByName = new Dictionary<string, SymbolIndexBucket>(StringComparer.Ordinal);
+        foreach (var afterIndex in afterSymbolIndicesOfThisType)
+        {
+            var afterSymbol = afterSymbols[afterIndex];
+            AddToBucket(afterSymbolIndicesByName, afterSymbol.Name, afterIndex);
+            if (afterSymbol is Symbol { CanonicalName: var canonicalName } && !String.Equals(canonicalName, afterSymbol.Name, StringComparison.Ordinal))
+            {
+                AddToBucket(afterSymbolIndicesByName, canonicalName, afterIndex);
+            }
+        }
+
+        var anyLeftUnmatched = false;
+        for (var i = 0; i < beforeSymbolsOfThisType.Count; i++)
+        {
+            this.CancellationToken.ThrowIfCancellationRequested();
+
+            var beforeSymbol = beforeSymbolsOfThisType[i];
+            var afterIndex = FindInBucket(afterSymbolIndicesByName, beforeSymbol.Name, beforeSymbol, afterSymbols, afterSymbolIsMatched);
+            if (afterIndex < 0 && beforeSymbol is Symbol { CanonicalName: var canonicalName } && !String.Equals(canonicalName, beforeSymbol.Name, StringComparison.Ordinal))
+            {
+                afterIndex = FindInBucket(afterSymbolIndicesByName, canonicalName, beforeSymbol, afterSymbols, afterSymbolIsMatched);
+            }
+
+            if (afterIndex >= 0)
+            {
+                afterSymbolIsMatched[afterIndex] = true;
+                matchingAfterSymbols[i] = afterSymbols[afterIndex];
+            }
+            else
+            {
+                anyLeftUnmatched = true;
+            }
+        }
+
+        if (!anyLeftUnmatched)
+        {
+            return matchingAfterSymbols;
+        }
+
+        // Anything left over gets compared against every 'after' symbol of this type that's still unmatched, in 'after' order.
+        var unmatchedAfterIndices = afterSymbolIndicesOfThisType.Where(afterIndex => !afterSymbolIsMatched[afterIndex]).ToList();
+        for (var i = 0; i < beforeSymbolsOfThisType.Count && unmatchedAfterIndices.Count > 0; i++)
+        {
+            if (matchingAfterSymbols[i] != null)
+            {
+                continue;
+            }
+
+            this.CancellationToken.ThrowIfCancellationRequested();
+
+            var beforeSymbol = beforeSymbolsOfThisType[i];
+            var position = unmatchedAfterIndices.FindIndex(afterIndex => beforeSymbol.IsVeryLikelyTheSameAs(afterSymbols[afterIndex]));
+            if (position >= 0)
+            {
+                var afterIndex = unmatchedAfterIndices[position];
+                unmatchedAfterIndices.RemoveAt(position);
+                afterSymbolIsMatched[afterIndex] = true;
+                matchingAfterSymbols[i] = afterSymbols[afterIndex];
+            }
+        }
+
+        return matchingAfterSymbols;
+    }
+
+    private static void AddToBucket(Dictionary<string, SymbolIndexBucket> buckets, string name, int afterIndex)
+    {
+        if (!buckets.TryGetValue(name, out var bucket))
+        {
+            bucket = new SymbolIndexBucket();
+            buckets.Add(name, bucket);
+        }
+
+        bucket.Indices.Add(afterIndex);
+    }
+
+    private static int FindInBucket(Dictionary<string, SymbolIndexBucket> buckets, string name, ISymbol beforeSymbol, List<ISymbol> afterSymbols, bool[] afterSymbolIsMatched)
+    {
+        if (!buckets.TryGetValue(name, out var bucket))
+        {
+            return -1;
+        }
+
+        // Skip past the front of the bucket once it's all been matched, so a name shared by many symbols (like string literals often are)
+        // doesn't get rescanned from the start every time.
+        while (bucket.FirstPossiblyUnmatched < bucket.Indices.Count && afterSymbolIsMatched[bucket.Indices[bucket.FirstPossiblyUnmatched]])
+        {
+            bucket.FirstPossiblyUnmatched++;
+        }
+
+        for (var i = bucket.FirstPossiblyUnmatched; i < bucket.Indices.Count; i++)
+        {
+            var afterIndex = bucket.Indices[i];
+            if (!afterSymbolIsMatched[afterIndex] && beforeSymbol.IsVeryLikelyTheSameAs(afterSymbols[afterIndex]))
+            {
+                return afterIndex;
+            }
+        }
+
+        return -1;
+    }
+
+    private sealed class SymbolIndexBucket
+    {
+        public List<int> Indices { get; } = new List<int>();
+        public int FirstPossiblyUnmatched { get; set; }
+    }
 }
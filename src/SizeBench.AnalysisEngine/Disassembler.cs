@@ -0,0 +1,17 @@
+﻿namespace SizeBench.AnalysisEngine;
+
+public enum Disassembler
+{
+    /// <summary>
+    /// Disassemble with the debugger engine (DbgX).  This supports every architecture, and annotates instructions with source lines and
+    /// local variable names.
+    /// </summary>
+    DbgEng = 0,
+
+    /// <summary>
+    /// Disassemble with SizeBench's own decoder, straight from the bytes of the binary, which avoids starting the debugger engine.  This
+    /// supports x64 and ARM64, and annotates branch and data targets with symbol names but not with source lines or local variable names.
+    /// Other architectures fall back to <see cref="DbgEng"/>.
+    /// </summary>
+    Managed = 1,
+}
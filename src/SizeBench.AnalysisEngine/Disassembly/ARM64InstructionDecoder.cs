@@ -0,0 +1,1137 @@
+﻿using System.Buffers.Binary;
+using System.Globalization;
+
+namespace SizeBench.AnalysisEngine.Disassembly;
+
+// Decodes ARM64 instructions into the same text the debugger's disassembler prints ("ldr         x8,[x19,#0x18]").
+//
+// This covers the integer, load/store, branch and scalar floating-point instructions, which is what compilers emit for nearly all code.
+// Anything else (mostly Advanced SIMD vector instructions) decodes to "???" - every instruction is 4 bytes, so that never throws off the
+// instructions after it.
+//
+// Decoding is a pure function of the bytes, so any number of threads can decode at once.
+internal static class ARM64InstructionDecoder
+{
+    public const int InstructionLength = 4;
+
+    private static readonly string[] ConditionCodes = ["eq", "ne", "hs", "lo", "mi", "pl", "vs", "vc", "hi", "ls", "ge", "lt", "gt", "le", "al", "nv"];
+    private static readonly string[] Shifts = ["lsl", "lsr", "asr", "ror"];
+    private static readonly string[] Extends = ["uxtb", "uxth", "uxtw", "uxtx", "sxtb", "sxth", "sxtw", "sxtx"];
+
+    /// <summary>
+    /// Decodes the instruction at the start of <paramref name="code"/>.
+    /// </summary>
+    /// <param name="code">The bytes of the instruction - if there are fewer than 4 bytes, the result is an unknown instruction.</param>
+    /// <param name="rva">The RVA of the instruction, which PC-relative operands and branch targets are relative to.</param>
+    /// <param name="imageBase">The preferred load address of the binary, to print absolute addresses as the debugger would.</param>
+    /// <returns>The decoded instruction, which is always 4 bytes long (or shorter, at the end of the code), even if it couldn't be decoded.</returns>
+    public static DecodedInstruction Decode(ReadOnlySpan<byte> code, uint rva, ulong imageBase)
+    {
+        if (code.Length < InstructionLength)
+        {
+            return DecodedInstruction.Unknown(rva, Math.Max(code.Length, 1));
+        }
+
+        var instruction = BinaryPrimitives.ReadUInt32LittleEndian(code);
+        var decoded = (instruction >> 25 & 0xF) switch
+        {
+            0b1000 or 0b1001 => DecodeDataProcessingImmediate(instruction, rva, imageBase),
+            0b1010 or 0b1011 => DecodeBranchesAndSystem(instruction, rva, imageBase),
+            0b0100 or 0b0110 or 0b1100 or 0b1110 => DecodeLoadsAndStores(instruction, rva, imageBase),
+            0b0101 or 0b1101 => DecodeDataProcessingRegister(instruction),
+            0b0111 or 0b1111 => DecodeScalarFloatingPoint(instruction),
+            _ => null,
+        };
+
+        return decoded is null ? DecodedInstruction.Unknown(rva, InstructionLength) : decoded.Value with { RVA = rva };
+    }
+
+    #region Formatting
+
+    // The debugger uses the procedure-call-standard names for the registers with a special purpose.
+    private static string X(uint register, bool isStackPointer = false) => register switch
+    {
+        16 => "xip0",
+        17 => "xip1",
+        18 => "xpr",
+        29 => "fp",
+        30 => "lr",
+        31 => isStackPointer ? "sp" : "xzr",
+        _ => "x" + register.ToString(CultureInfo.InvariantCulture),
+    };
+
+    private static string W(uint register, bool isStackPointer = false) => register switch
+    {
+        31 => isStackPointer ? "wsp" : "wzr",
+        _ => "w" + register.ToString(CultureInfo.InvariantCulture),
+    };
+
+    private static string R(bool is64Bit, uint register, bool isStackPointer = false) => is64Bit ? X(register, isStackPointer) : W(register, isStackPointer);
+
+    // Scalar floating-point and SIMD registers, by size in bytes.
+    private static string V(int size, uint register) => size switch
+    {
+        1 => "b",
+        2 => "h",
+        4 => "s",
+        8 => "d",
+        _ => "q",
+    } + register.ToString(CultureInfo.InvariantCulture);
+
+    private static string Immediate(long value)
+    {
+        if (value is > -10 and < 10)
+        {
+            return "#" + value.ToString(CultureInfo.InvariantCulture);
+        }
+
+        return value < 0 ? "#-0x" + (-value).ToString("X", CultureInfo.InvariantCulture)
+                         : "#0x" + value.ToString("X", CultureInfo.InvariantCulture);
+    }
+
+    private static string UnsignedImmediate(ulong value)
+        => value < 10 ? "#" + value.ToString(CultureInfo.InvariantCulture) : "#0x" + value.ToString("X", CultureInfo.InvariantCulture);
+
+    private static string ShiftAmount(uint amount) => "#" + amount.ToString(CultureInfo.InvariantCulture);
+
+    private static long SignExtend(uint value, int bits) => (long)((ulong)value << (64 - bits)) >> (64 - bits);
+
+    private static uint Bits(uint instruction, int low, int count) => (instruction >> low) & ((1u << count) - 1);
+
+    private static bool Bit(uint instruction, int index) => ((instruction >> index) & 1) != 0;
+
+    private static DecodedInstruction Instruction(string mnemonic, params string[] operands)
+        => new DecodedInstruction(0, InstructionLength, mnemonic, String.Join(',', operands), InstructionFlow.Sequential, null, 0, 0);
+
+    // An instruction whose last operand is the address it branches to or loads from.
+    private static DecodedInstruction InstructionWithTarget(string mnemonic, InstructionFlow flow, uint rva, long offset, ulong imageBase, params string[] operandsBeforeTarget)
+    {
+        var target = rva + offset;
+        var targetText = DecodedInstruction.FormatAbsoluteAddress(imageBase + (ulong)target);
+        var prefix = operandsBeforeTarget.Length == 0 ? String.Empty : String.Join(',', operandsBeforeTarget) + ",";
+        return new DecodedInstruction(0,
+                                      InstructionLength,
+                                      mnemonic,
+                                      prefix + targetText,
+                                      flow,
+                                      target is >= 0 and <= UInt32.MaxValue ? (uint)target : null,
+                                      prefix.Length,
+                                      targetText.Length);
+    }
+
+    #endregion
+
+    #region Data processing - immediate
+
+    private static DecodedInstruction? DecodeDataProcessingImmediate(uint instruction, uint rva, ulong imageBase)
+    {
+        var is64Bit = Bit(instruction, 31);
+        var rd = Bits(instruction, 0, 5);
+        var rn = Bits(instruction, 5, 5);
+
+        switch (Bits(instruction, 23, 3))
+        {
+            case 0b000:
+            case 0b001:
+            {
+                var immediate = SignExtend((Bits(instruction, 5, 19) << 2) | Bits(instruction, 29, 2), 21);
+                if (Bit(instruction, 31))
+                {
+                    // ADRP works in 4KB pages - the binary is always loaded at a 64KB-aligned address, so the page of an RVA is the page of
+                    // the address it's loaded at.
+                    var pageOffset = (long)(rva & ~0xFFFu) - rva + (immediate << 12);
+                    return InstructionWithTarget("adrp", InstructionFlow.Sequential, rva, pageOffset, imageBase, X(rd));
+                }
+                return InstructionWithTarget("adr", InstructionFlow.Sequential, rva, immediate, imageBase, X(rd));
+            }
+            case 0b010:
+            {
+                var isSubtract = Bit(instruction, 30);
+                var setsFlags = Bit(instruction, 29);
+                var immediate = Bits(instruction, 10, 12);
+                var shift = Bit(instruction, 22) ? ",lsl #12" : String.Empty;
+                if (setsFlags && rd == 31)
+                {
+                    return Instruction(isSubtract ? "cmp" : "cmn", R(is64Bit, rn, isStackPointer: true), UnsignedImmediate(immediate) + shift);
+                }
+                if (!isSubtract && !setsFlags && immediate == 0 && shift.Length == 0 && (rd == 31 || rn == 31))
+                {
+                    return Instruction("mov", R(is64Bit, rd, isStackPointer: true), R(is64Bit, rn, isStackPointer: true));
+                }
+                return Instruction((isSubtract ? "sub" : "add") + (setsFlags ? "s" : String.Empty),
+                                   R(is64Bit, rd, isStackPointer: !setsFlags),
+                                   R(is64Bit, rn, isStackPointer: true),
+                                   UnsignedImmediate(immediate) + shift);
+            }
+            case 0b100:
+            {
+                if (!is64Bit && Bit(instruction, 22))
+                {
+                    return null;
+                }
+
+                var immediate = DecodeBitMask(Bit(instruction, 22), Bits(instruction, 16, 6), Bits(instruction, 10, 6), is64Bit);
+                var opc = Bits(instruction, 29, 2);
+                if (opc == 0b11 && rd == 31)
+                {
+                    return Instruction("tst", R(is64Bit, rn), UnsignedImmediate(immediate));
+                }
+                if (opc == 0b01 && rn == 31)
+                {
+                    return Instruction("mov", R(is64Bit, rd, isStackPointer: true), UnsignedImmediate(immediate));
+                }
+                var mnemonic = opc switch { 0b00 => "and", 0b01 => "orr", 0b10 => "eor", _ => "ands" };
+                return Instruction(mnemonic, R(is64Bit, rd, isStackPointer: opc != 0b11), R(is64Bit, rn), UnsignedImmediate(immediate));
+            }
+            case 0b101:
+            {
+                var opc = Bits(instruction, 29, 2);
+                var shift = (int)Bits(instruction, 21, 2) * 16;
+                var immediate = (ulong)Bits(instruction, 5, 16);
+                if (opc == 0b01 || (!is64Bit && shift >= 32))
+                {
+                    return null;
+                }
+                if (opc == 0b11)
+                {
+                    return Instruction("movk", R(is64Bit, rd), UnsignedImmediate(immediate) + (shift == 0 ? String.Empty : ",lsl " + ShiftAmount((uint)shift)));
+                }
+
+                // A zero with a shift is the one encoding that isn't written as a "mov", because it isn't the canonical way to write zero.
+                if (immediate == 0 && shift != 0)
+                {
+                    return Instruction(opc == 0b00 ? "movn" : "movz", R(is64Bit, rd), "#0,lsl " + ShiftAmount((uint)shift));
+                }
+
+                var value = immediate << shift;
+                if (opc == 0b10)
+                {
+                    return Instruction("mov", R(is64Bit, rd), UnsignedImmediate(value));
+                }
+                return Instruction("mov", R(is64Bit, rd), Immediate(is64Bit ? (long)~value : (int)~(uint)value));
+            }
+            case 0b110:
+                return DecodeBitfield(instruction, is64Bit, rd, rn);
+            case 0b111:
+            {
+                var rm = Bits(instruction, 16, 5);
+                var lsb = Bits(instruction, 10, 6);
+                return rn == rm ? Instruction("ror", R(is64Bit, rd), R(is64Bit, rn), ShiftAmount(lsb))
+                                : Instruction("extr", R(is64Bit, rd), R(is64Bit, rn), R(is64Bit, rm), ShiftAmount(lsb));
+            }
+            default:
+                return null;
+        }
+    }
+
+    private static DecodedInstruction? DecodeBitfield(uint instruction, bool is64Bit, uint rd, uint rn)
+    {
+        var opc = Bits(instruction, 29, 2);
+        var immr = Bits(instruction, 16, 6);
+        var imms = Bits(instruction, 10, 6);
+        var size = is64Bit ? 64u : 32u;
+
+        switch (opc)
+        {
+            case 0b00:
+                if (imms == size - 1)
+                {
+                    return Instruction("asr", R(is64Bit, rd), R(is64Bit, rn), ShiftAmount(immr));
+                }
+                if (immr == 0 && imms is 7 or 15 or 31)
+                {
+                    return Instruction(imms switch { 7 => "sxtb", 15 => "sxth", _ => "sxtw" }, R(is64Bit, rd), W(rn));
+                }
+                return imms < immr ? Instruction("sbfiz", R(is64Bit, rd), R(is64Bit, rn), ShiftAmount(size - immr), ShiftAmount(imms + 1))
+                                   : Instruction("sbfx", R(is64Bit, rd), R(is64Bit, rn), ShiftAmount(immr), ShiftAmount(imms - immr + 1));
+            case 0b01:
+                return imms < immr ? Instruction("bfi", R(is64Bit, rd), R(is64Bit, rn), ShiftAmount(size - immr), ShiftAmount(imms + 1))
+                                   : Instruction("bfxil", R(is64Bit, rd), R(is64Bit, rn), ShiftAmount(immr), ShiftAmount(imms - immr + 1));
+            case 0b10:
+                if (imms != size - 1 && imms + 1 == immr)
+                {
+                    return Instruction("lsl", R(is64Bit, rd), R(is64Bit, rn), ShiftAmount(size - 1 - imms));
+                }
+                if (imms == size - 1)
+                {
+                    return Instruction("lsr", R(is64Bit, rd), R(is64Bit, rn), ShiftAmount(immr));
+                }
+                if (!is64Bit && immr == 0 && imms is 7 or 15)
+                {
+                    return Instruction(imms == 7 ? "uxtb" : "uxth", W(rd), W(rn));
+                }
+                return imms < immr ? Instruction("ubfiz", R(is64Bit, rd), R(is64Bit, rn), ShiftAmount(size - immr), ShiftAmount(imms + 1))
+                                   : Instruction("ubfx", R(is64Bit, rd), R(is64Bit, rn), ShiftAmount(immr), ShiftAmount(imms - immr + 1));
+            default:
+                return null;
+        }
+    }
+
+    // The DecodeBitMasks pseudocode from the Arm Architecture Reference Manual, for the immediates of the logical instructions - a pattern
+    // of 2, 4, 8, 16, 32 or 64 bits, rotated and repeated to fill the register.
+    private static ulong DecodeBitMask(bool n, uint immr, uint imms, bool is64Bit)
+    {
+        var combined = (n ? 0x40u : 0u) | (~imms & 0x3F);
+        var length = 31 - System.Numerics.BitOperations.LeadingZeroCount(combined);
+        if (length < 1)
+        {
+            return 0;
+        }
+
+        var elementSize = 1 << length;
+        var levels = (uint)(elementSize - 1);
+        var s = imms & levels;
+        var r = immr & levels;
+        var element = s + 1 == 64 ? UInt64.MaxValue : (1UL << (int)(s + 1)) - 1;
+        if (r != 0)
+        {
+            var elementMask = elementSize == 64 ? UInt64.MaxValue : (1UL << elementSize) - 1;
+            element = ((element >> (int)r) | (element << (elementSize - (int)r))) & elementMask;
+        }
+
+        var result = element;
+        for (var i = elementSize; i < 64; i *= 2)
+        {
+            result |= result << i;
+        }
+
+        return is64Bit ? result : result & 0xFFFFFFFF;
+    }
+
+    #endregion
+
+    #region Branches, exceptions and system
+
+    private static DecodedInstruction? DecodeBranchesAndSystem(uint instruction, uint rva, ulong imageBase)
+    {
+        // B and BL
+        if ((instruction & 0x7C000000) == 0x14000000)
+        {
+            var offset = SignExtend(Bits(instruction, 0, 26), 26) * 4;
+            return Bit(instruction, 31) ? InstructionWithTarget("bl", InstructionFlow.Call, rva, offset, imageBase)
+                                        : InstructionWithTarget("b", InstructionFlow.Jump, rva, offset, imageBase);
+        }
+
+        // CBZ and CBNZ
+        if ((instruction & 0x7E000000) == 0x34000000)
+        {
+            var offset = SignExtend(Bits(instruction, 5, 19), 19) * 4;
+            return InstructionWithTarget(Bit(instruction, 24) ? "cbnz" : "cbz", InstructionFlow.ConditionalJump, rva, offset, imageBase, R(Bit(instruction, 31), Bits(instruction, 0, 5)));
+        }
+
+        // TBZ and TBNZ
+        if ((instruction & 0x7E000000) == 0x36000000)
+        {
+            var offset = SignExtend(Bits(instruction, 5, 14), 14) * 4;
+            var bitNumber = (Bits(instruction, 31, 1) << 5) | Bits(instruction, 19, 5);
+            return InstructionWithTarget(Bit(instruction, 24) ? "tbnz" : "tbz", InstructionFlow.ConditionalJump, rva, offset, imageBase,
+                                         R(bitNumber >= 32, Bits(instruction, 0, 5)), ShiftAmount(bitNumber));
+        }
+
+        // B.cond
+        if ((instruction & 0xFF000010) == 0x54000000)
+        {
+            var offset = SignExtend(Bits(instruction, 5, 19), 19) * 4;
+            return InstructionWithTarget("b" + ConditionCodes[Bits(instruction, 0, 4)], InstructionFlow.ConditionalJump, rva, offset, imageBase);
+        }
+
+        // Exceptions - BRK, SVC and friends
+        if ((instruction & 0xFF000000) == 0xD4000000)
+        {
+            var immediate = UnsignedImmediate(Bits(instruction, 5, 16));
+            return (Bits(instruction, 21, 3), Bits(instruction, 0, 5)) switch
+            {
+                (0b000, 0b00001) => Instruction("svc", immediate),
+                (0b001, 0b00000) => Instruction("brk", immediate),
+                (0b010, 0b00000) => Instruction("hlt", immediate),
+                _ => null,
+            };
+        }
+
+        // System - hints, barriers and system registers
+        if ((instruction & 0xFFC00000) == 0xD5000000)
+        {
+            return DecodeSystem(instruction);
+        }
+
+        // Branch to register - BR, BLR and RET, and their pointer-authenticated variants
+        if ((instruction & 0xFE000000) == 0xD6000000)
+        {
+            var rn = Bits(instruction, 5, 5);
+            var authentication = Bits(instruction, 10, 2) switch
+            {
+                0b10 => "aa",
+                0b11 => "ab",
+                _ => String.Empty,
+            };
+            switch (Bits(instruction, 21, 4))
+            {
+                case 0b0000:
+                    return new DecodedInstruction(0, InstructionLength, "br" + authentication, X(rn), InstructionFlow.Jump, null, 0, 0);
+                case 0b0001:
+                    return new DecodedInstruction(0, InstructionLength, "blr" + authentication, X(rn), InstructionFlow.Call, null, 0, 0);
+                case 0b0010:
+                    return new DecodedInstruction(0, InstructionLength, "ret" + authentication, rn == 30 || authentication.Length > 0 ? String.Empty : X(rn), InstructionFlow.Return, null, 0, 0);
+            }
+        }
+
+        return null;
+    }
+
+    private static DecodedInstruction? DecodeSystem(uint instruction)
+    {
+        var op0 = Bits(instruction, 19, 2);
+        var op1 = Bits(instruction, 16, 3);
+        var crn = Bits(instruction, 12, 4);
+        var crm = Bits(instruction, 8, 4);
+        var op2 = Bits(instruction, 5, 3);
+        var rt = Bits(instruction, 0, 5);
+        var isRead = Bit(instruction, 21);
+
+        if (!isRead && op0 == 0 && op1 == 0b011 && crn == 0b0010 && rt == 31)
+        {
+            var hint = (crm << 3) | op2;
+            return hint switch
+            {
+                0 => Instruction("nop"),
+                1 => Instruction("yield"),
+                2 => Instruction("wfe"),
+                3 => Instruction("wfi"),
+                4 => Instruction("sev"),
+                5 => Instruction("sevl"),
+                25 => Instruction("paciasp"),
+                27 => Instruction("pacibsp"),
+                29 => Instruction("autiasp"),
+                31 => Instruction("autibsp"),
+                _ => Instruction("hint", UnsignedImmediate(hint)),
+            };
+        }
+
+        if (!isRead && op0 == 0 && op1 == 0b011 && crn == 0b0011 && rt == 31 && op2 is 0b100 or 0b101 or 0b110)
+        {
+            if (op2 == 0b110)
+            {
+                return Instruction("isb");
+            }
+
+            var option = crm switch
+            {
+                0b0001 => "oshld",
+                0b0010 => "oshst",
+                0b0011 => "osh",
+                0b0101 => "nshld",
+                0b0110 => "nshst",
+                0b0111 => "nsh",
+                0b1001 => "ishld",
+                0b1010 => "ishst",
+                0b1011 => "ish",
+                0b1101 => "ld",
+                0b1110 => "st",
+                0b1111 => "sy",
+                _ => UnsignedImmediate(crm),
+            };
+            return Instruction(op2 == 0b100 ? "dsb" : "dmb", option);
+        }
+
+        if (op0 >= 2)
+        {
+            var systemRegister = (op0, op1, crn, crm, op2) switch
+            {
+                (3, 3, 4, 2, 0) => "nzcv",
+                (3, 3, 4, 4, 0) => "fpcr",
+                (3, 3, 4, 4, 1) => "fpsr",
+                (3, 3, 13, 0, 2) => "tpidr_el0",
+                (3, 3, 13, 0, 3) => "tpidrro_el0",
+                (3, 3, 14, 0, 1) => "cntpct_el0",
+                (3, 3, 14, 0, 2) => "cntvct_el0",
+                _ => String.Create(CultureInfo.InvariantCulture, $"s{op0}_{op1}_c{crn}_c{crm}_{op2}"),
+            };
+            return isRead ? Instruction("mrs", X(rt), systemRegister) : Instruction("msr", systemRegister, X(rt));
+        }
+
+        return null;
+    }
+
+    #endregion
+
+    #region Loads and stores
+
+    private static DecodedInstruction? DecodeLoadsAndStores(uint instruction, uint rva, ulong imageBase)
+    {
+        var rt = Bits(instruction, 0, 5);
+        var rn = Bits(instruction, 5, 5);
+        var isVector = Bit(instruction, 26);
+
+        // Load register (literal)
+        if ((instruction & 0x3B000000) == 0x18000000)
+        {
+            var offset = SignExtend(Bits(instruction, 5, 19), 19) * 4;
+            var (mnemonic, register) = (Bits(instruction, 30, 2), isVector) switch
+            {
+                (0b00, false) => ("ldr", W(rt)),
+                (0b01, false) => ("ldr", X(rt)),
+                (0b10, false) => ("ldrsw", X(rt)),
+                (0b11, false) => ("prfm", UnsignedImmediate(rt)),
+                (0b00, true) => ("ldr", V(4, rt)),
+                (0b01, true) => ("ldr", V(8, rt)),
+                (0b10, true) => ("ldr", V(16, rt)),
+                _ => (null, null),
+            };
+            return mnemonic is null ? null : InstructionWithTarget(mnemonic, InstructionFlow.Sequential, rva, offset, imageBase, register!);
+        }
+
+        // Load/store exclusive, acquire/release and compare-and-swap
+        if ((instruction & 0x3F000000) == 0x08000000)
+        {
+            return DecodeExclusive(instruction, rt, rn);
+        }
+
+        // Load/store pair
+        if ((instruction & 0x3A000000) == 0x28000000)
+        {
+            return DecodePair(instruction, rt, rn, isVector);
+        }
+
+        // Load/store register - every addressing mode except literal
+        if ((instruction & 0x3A000000) == 0x38000000)
+        {
+            return DecodeSingleRegister(instruction, rt, rn, isVector);
+        }
+
+        return null;
+    }
+
+    private static DecodedInstruction? DecodeExclusive(uint instruction, uint rt, uint rn)
+    {
+        var size = Bits(instruction, 30, 2);
+        var isLoad = Bit(instruction, 22);
+        var o0 = Bit(instruction, 15);
+        var rs = Bits(instruction, 16, 5);
+        var is64Bit = size == 0b11;
+        var sizeSuffix = size switch { 0b00 => "b", 0b01 => "h", _ => String.Empty };
+        var address = "[" + X(rn, isStackPointer: true) + "]";
+
+        switch ((Bit(instruction, 23), Bit(instruction, 21)))
+        {
+            case (false, false):
+                return isLoad ? Instruction((o0 ? "ldaxr" : "ldxr") + sizeSuffix, R(is64Bit, rt), address)
+                              : Instruction((o0 ? "stlxr" : "stxr") + sizeSuffix, W(rs), R(is64Bit, rt), address);
+            case (true, false):
+                return isLoad ? Instruction((o0 ? "ldar" : "ldlar") + sizeSuffix, R(is64Bit, rt), address)
+                              : Instruction((o0 ? "stlr" : "stllr") + sizeSuffix, R(is64Bit, rt), address);
+            case (true, true) when Bits(instruction, 10, 5) == 31:
+            {
+                var ordering = (isLoad ? "a" : String.Empty) + (o0 ? "l" : String.Empty);
+                return Instruction("cas" + ordering + sizeSuffix, R(is64Bit, rs), R(is64Bit, rt), address);
+            }
+            case (false, true) when size >= 0b10:
+            {
+                var rt2 = Bits(instruction, 10, 5);
+                return isLoad ? Instruction(o0 ? "ldaxp" : "ldxp", R(is64Bit, rt), R(is64Bit, rt2), address)
+                              : Instruction(o0 ? "stlxp" : "stxp", W(rs), R(is64Bit, rt), R(is64Bit, rt2), address);
+            }
+            default:
+                return null;
+        }
+    }
+
+    private static DecodedInstruction? DecodePair(uint instruction, uint rt, uint rn, bool isVector)
+    {
+        var opc = Bits(instruction, 30, 2);
+        var isLoad = Bit(instruction, 22);
+        var rt2 = Bits(instruction, 10, 5);
+        var indexing = Bits(instruction, 23, 2);
+
+        int size;
+        string mnemonic;
+        Func<uint, string> register;
+        if (isVector)
+        {
+            if (opc == 0b11)
+            {
+                return null;
+            }
+            size = 4 << (int)opc;
+            register = r => V(size, r);
+            mnemonic = isLoad ? "ldp" : "stp";
+        }
+        else
+        {
+            if (opc == 0b11 || (opc == 0b01 && !isLoad))
+            {
+                return null;
+            }
+            size = opc == 0b10 ? 8 : 4;
+            register = r => R(opc == 0b10 || opc == 0b01, r);
+            mnemonic = opc == 0b01 ? "ldpsw" : (isLoad ? "ldp" : "stp");
+        }
+
+        if (indexing == 0b00)
+        {
+            mnemonic = isLoad ? "ldnp" : "stnp";
+        }
+
+        var offset = SignExtend(Bits(instruction, 15, 7), 7) * size;
+        return Instruction(mnemonic, register(rt), register(rt2), FormatAddress(rn, offset, indexing switch { 0b01 => Indexing.PostIndex, 0b11 => Indexing.PreIndex, _ => Indexing.Offset }));
+    }
+
+    private enum Indexing
+    {
+        Offset,
+        PreIndex,
+        PostIndex,
+    }
+
+    private static string FormatAddress(uint rn, long offset, Indexing indexing)
+    {
+        var baseRegister = X(rn, isStackPointer: true);
+        return indexing switch
+        {
+            Indexing.PreIndex => "[" + baseRegister + "," + Immediate(offset) + "]!",
+            Indexing.PostIndex => "[" + baseRegister + "]," + Immediate(offset),
+            _ => offset == 0 ? "[" + baseRegister + "]" : "[" + baseRegister + "," + Immediate(offset) + "]",
+        };
+    }
+
+    private static DecodedInstruction? DecodeSingleRegister(uint instruction, uint rt, uint rn, bool isVector)
+    {
+        var size = Bits(instruction, 30, 2);
+        var opc = Bits(instruction, 22, 2);
+
+        // Atomic memory operations (LSE) - LDADD, SWP and friends
+        if (!Bit(instruction, 24) && Bit(instruction, 21) && Bits(instruction, 10, 2) == 0b00)
+        {
+            return isVector ? null : DecodeAtomic(instruction, rt, rn, size);
+        }
+
+        var names = GetLoadStoreNameAndRegister(size, opc, isVector, rt);
+        if (names is null)
+        {
+            return null;
+        }
+        var (mnemonic, register, accessSize) = names.Value;
+
+        if (Bit(instruction, 24))
+        {
+            // Unsigned, scaled, 12-bit offset
+            var offset = (long)Bits(instruction, 10, 12) * accessSize;
+            return Instruction(mnemonic, register, FormatAddress(rn, offset, Indexing.Offset));
+        }
+
+        if (Bit(instruction, 21))
+        {
+            if (Bits(instruction, 10, 2) != 0b10)
+            {
+                return null;
+            }
+
+            // Register offset
+            var rm = Bits(instruction, 16, 5);
+            var option = Bits(instruction, 13, 3);
+            var isShifted = Bit(instruction, 12);
+            var shiftAmount = (uint)System.Numerics.BitOperations.Log2((uint)accessSize);
+            var indexRegister = R((option & 0b011) == 0b011, rm);
+            var extend = option == 0b011 ? (isShifted ? "lsl" : null) : Extends[option];
+            var amount = isShifted ? " " + ShiftAmount(shiftAmount) : String.Empty;
+            var address = extend is null ? $"[{X(rn, isStackPointer: true)},{indexRegister}]"
+                                         : $"[{X(rn, isStackPointer: true)},{indexRegister},{extend}{amount}]";
+            return Instruction(mnemonic, register, address);
+        }
+
+        var immediate = SignExtend(Bits(instruction, 12, 9), 9);
+        return Bits(instruction, 10, 2) switch
+        {
+            0b00 => Instruction(mnemonic.Replace("ldr", "ldur", StringComparison.Ordinal).Replace("str", "stur", StringComparison.Ordinal).Replace("prfm", "prfum", StringComparison.Ordinal),
+                                register,
+                                FormatAddress(rn, immediate, Indexing.Offset)),
+            0b01 => Instruction(mnemonic, register, FormatAddress(rn, immediate, Indexing.PostIndex)),
+            0b11 => Instruction(mnemonic, register, FormatAddress(rn, immediate, Indexing.PreIndex)),
+            _ => Instruction(mnemonic.Replace("ldr", "ldtr", StringComparison.Ordinal).Replace("str", "sttr", StringComparison.Ordinal),
+                             register,
+                             FormatAddress(rn, immediate, Indexing.Offset)),
+        };
+    }
+
+    private static (string Mnemonic, string Register, int AccessSize)? GetLoadStoreNameAndRegister(uint size, uint opc, bool isVector, uint rt)
+    {
+        if (isVector)
+        {
+            // The 128-bit q registers are encoded as size 0 with the upper bit of opc set.
+            var accessSize = (opc & 0b10) != 0 ? (size == 0 ? 16 : 0) : 1 << (int)size;
+            if (accessSize == 0)
+            {
+                return null;
+            }
+            return ((opc & 1) != 0 ? "ldr" : "str", V(accessSize, rt), accessSize);
+        }
+
+        return (size, opc) switch
+        {
+            (0b00, 0b00) => ("strb", W(rt), 1),
+            (0b00, 0b01) => ("ldrb", W(rt), 1),
+            (0b00, 0b10) => ("ldrsb", X(rt), 1),
+            (0b00, 0b11) => ("ldrsb", W(rt), 1),
+            (0b01, 0b00) => ("strh", W(rt), 2),
+            (0b01, 0b01) => ("ldrh", W(rt), 2),
+            (0b01, 0b10) => ("ldrsh", X(rt), 2),
+            (0b01, 0b11) => ("ldrsh", W(rt), 2),
+            (0b10, 0b00) => ("str", W(rt), 4),
+            (0b10, 0b01) => ("ldr", W(rt), 4),
+            (0b10, 0b10) => ("ldrsw", X(rt), 4),
+            (0b11, 0b00) => ("str", X(rt), 8),
+            (0b11, 0b01) => ("ldr", X(rt), 8),
+            (0b11, 0b10) => ("prfm", UnsignedImmediate(rt), 8),
+            _ => null,
+        };
+    }
+
+    private static DecodedInstruction? DecodeAtomic(uint instruction, uint rt, uint rn, uint size)
+    {
+        var operation = (Bit(instruction, 15), Bits(instruction, 12, 3)) switch
+        {
+            (false, 0b000) => "ldadd",
+            (false, 0b001) => "ldclr",
+            (false, 0b010) => "ldeor",
+            (false, 0b011) => "ldset",
+            (false, 0b100) => "ldsmax",
+            (false, 0b101) => "ldsmin",
+            (false, 0b110) => "ldumax",
+            (false, 0b111) => "ldumin",
+            (true, 0b000) => "swp",
+            _ => null,
+        };
+        if (operation is null)
+        {
+            return null;
+        }
+
+        var ordering = (Bit(instruction, 23) ? "a" : String.Empty) + (Bit(instruction, 22) ? "l" : String.Empty);
+        var sizeSuffix = size switch { 0b00 => "b", 0b01 => "h", _ => String.Empty };
+        var is64Bit = size == 0b11;
+        return Instruction(operation + ordering + sizeSuffix, R(is64Bit, Bits(instruction, 16, 5)), R(is64Bit, rt), "[" + X(rn, isStackPointer: true) + "]");
+    }
+
+    #endregion
+
+    #region Data processing - register
+
+    private static DecodedInstruction? DecodeDataProcessingRegister(uint instruction)
+    {
+        var is64Bit = Bit(instruction, 31);
+        var rd = Bits(instruction, 0, 5);
+        var rn = Bits(instruction, 5, 5);
+        var rm = Bits(instruction, 16, 5);
+
+        if (!Bit(instruction, 28))
+        {
+            if (!Bit(instruction, 24))
+            {
+                return DecodeLogicalShiftedRegister(instruction, is64Bit, rd, rn, rm);
+            }
+            return Bit(instruction, 21) ? DecodeAddSubtractExtendedRegister(instruction, is64Bit, rd, rn, rm)
+                                        : DecodeAddSubtractShiftedRegister(instruction, is64Bit, rd, rn, rm);
+        }
+
+        if (Bit(instruction, 24))
+        {
+            return DecodeThreeSource(instruction, is64Bit, rd, rn, rm);
+        }
+
+        switch (Bits(instruction, 21, 3))
+        {
+            case 0b000:
+            {
+                var mnemonic = (Bit(instruction, 30) ? "sbc" : "adc") + (Bit(instruction, 29) ? "s" : String.Empty);
+                return Instruction(mnemonic, R(is64Bit, rd), R(is64Bit, rn), R(is64Bit, rm));
+            }
+            case 0b010:
+            {
+                var mnemonic = Bit(instruction, 30) ? "ccmp" : "ccmn";
+                var second = Bit(instruction, 11) ? UnsignedImmediate(rm) : R(is64Bit, rm);
+                return Instruction(mnemonic, R(is64Bit, rn), second, UnsignedImmediate(Bits(instruction, 0, 4)), ConditionCodes[Bits(instruction, 12, 4)]);
+            }
+            case 0b100:
+                return DecodeConditionalSelect(instruction, is64Bit, rd, rn, rm);
+            case 0b110:
+                return Bit(instruction, 30) ? DecodeOneSource(instruction, is64Bit, rd, rn) : DecodeTwoSource(instruction, is64Bit, rd, rn, rm);
+            default:
+                return null;
+        }
+    }
+
+    private static DecodedInstruction DecodeLogicalShiftedRegister(uint instruction, bool is64Bit, uint rd, uint rn, uint rm)
+    {
+        var opc = Bits(instruction, 29, 2);
+        var invert = Bit(instruction, 21);
+        var shiftType = Bits(instruction, 22, 2);
+        var amount = Bits(instruction, 10, 6);
+        var shift = amount == 0 && shiftType == 0 ? null : Shifts[shiftType] + " " + ShiftAmount(amount);
+
+        if (opc == 0b01 && rn == 31 && shift is null)
+        {
+            return Instruction(invert ? "mvn" : "mov", R(is64Bit, rd), R(is64Bit, rm));
+        }
+        if (opc == 0b11 && !invert && rd == 31)
+        {
+            return shift is null ? Instruction("tst", R(is64Bit, rn), R(is64Bit, rm)) : Instruction("tst", R(is64Bit, rn), R(is64Bit, rm), shift);
+        }
+
+        var mnemonic = (opc, invert) switch
+        {
+            (0b00, false) => "and",
+            (0b00, true) => "bic",
+            (0b01, false) => "orr",
+            (0b01, true) => "orn",
+            (0b10, false) => "eor",
+            (0b10, true) => "eon",
+            (_, false) => "ands",
+            (_, true) => "bics",
+        };
+        return shift is null ? Instruction(mnemonic, R(is64Bit, rd), R(is64Bit, rn), R(is64Bit, rm))
+                             : Instruction(mnemonic, R(is64Bit, rd), R(is64Bit, rn), R(is64Bit, rm), shift);
+    }
+
+    private static DecodedInstruction? DecodeAddSubtractShiftedRegister(uint instruction, bool is64Bit, uint rd, uint rn, uint rm)
+    {
+        var isSubtract = Bit(instruction, 30);
+        var setsFlags = Bit(instruction, 29);
+        var shiftType = Bits(instruction, 22, 2);
+        var amount = Bits(instruction, 10, 6);
+        if (shiftType == 0b11)
+        {
+            return null;
+        }
+
+        var shift = amount == 0 ? null : Shifts[shiftType] + " " + ShiftAmount(amount);
+        string mnemonic;
+        List<string> operands;
+        if (setsFlags && rd == 31)
+        {
+            mnemonic = isSubtract ? "cmp" : "cmn";
+            operands = [R(is64Bit, rn), R(is64Bit, rm)];
+        }
+        else if (isSubtract && rn == 31)
+        {
+            mnemonic = setsFlags ? "negs" : "neg";
+            operands = [R(is64Bit, rd), R(is64Bit, rm)];
+        }
+        else
+        {
+            mnemonic = (isSubtract ? "sub" : "add") + (setsFlags ? "s" : String.Empty);
+            operands = [R(is64Bit, rd), R(is64Bit, rn), R(is64Bit, rm)];
+        }
+
+        if (shift != null)
+        {
+            operands.Add(shift);
+        }
+        return Instruction(mnemonic, [.. operands]);
+    }
+
+    private static DecodedInstruction DecodeAddSubtractExtendedRegister(uint instruction, bool is64Bit, uint rd, uint rn, uint rm)
+    {
+        var isSubtract = Bit(instruction, 30);
+        var setsFlags = Bit(instruction, 29);
+        var option = Bits(instruction, 13, 3);
+        var amount = Bits(instruction, 10, 3);
+
+        // When the stack pointer is involved, the extend that's a no-op for the register size is written as "lsl", or left out entirely.
+        var usesStackPointer = rd == 31 && !setsFlags || rn == 31;
+        string? extend = Extends[option];
+        if (usesStackPointer && option == (is64Bit ? 0b011u : 0b010u))
+        {
+            extend = amount == 0 ? null : "lsl";
+        }
+        if (extend != null && amount != 0)
+        {
+            extend += " " + ShiftAmount(amount);
+        }
+
+        var source = R(is64Bit && (option & 0b011) == 0b011, rm);
+        var operands = new List<string>();
+        string mnemonic;
+        if (setsFlags && rd == 31)
+        {
+            mnemonic = isSubtract ? "cmp" : "cmn";
+        }
+        else
+        {
+            mnemonic = (isSubtract ? "sub" : "add") + (setsFlags ? "s" : String.Empty);
+            operands.Add(R(is64Bit, rd, isStackPointer: !setsFlags));
+        }
+        operands.Add(R(is64Bit, rn, isStackPointer: true));
+        operands.Add(source);
+        if (extend != null)
+        {
+            operands.Add(extend);
+        }
+        return Instruction(mnemonic, [.. operands]);
+    }
+
+    private static DecodedInstruction? DecodeConditionalSelect(uint instruction, bool is64Bit, uint rd, uint rn, uint rm)
+    {
+        if (Bit(instruction, 29))
+        {
+            return null;
+        }
+
+        var condition = Bits(instruction, 12, 4);
+        var invertedCondition = ConditionCodes[condition ^ 1];
+        var canUseAlias = condition < 0b1110;
+        switch ((Bit(instruction, 30), Bits(instruction, 10, 2)))
+        {
+            case (false, 0b00):
+                return Instruction("csel", R(is64Bit, rd), R(is64Bit, rn), R(is64Bit, rm), ConditionCodes[condition]);
+            case (false, 0b01):
+                if (canUseAlias && rn == 31 && rm == 31)
+                {
+                    return Instruction("cset", R(is64Bit, rd), invertedCondition);
+                }
+                if (canUseAlias && rn == rm)
+                {
+                    return Instruction("cinc", R(is64Bit, rd), R(is64Bit, rn), invertedCondition);
+                }
+                return Instruction("csinc", R(is64Bit, rd), R(is64Bit, rn), R(is64Bit, rm), ConditionCodes[condition]);
+            case (true, 0b00):
+                if (canUseAlias && rn == 31 && rm == 31)
+                {
+                    return Instruction("csetm", R(is64Bit, rd), invertedCondition);
+                }
+                if (canUseAlias && rn == rm)
+                {
+                    return Instruction("cinv", R(is64Bit, rd), R(is64Bit, rn), invertedCondition);
+                }
+                return Instruction("csinv", R(is64Bit, rd), R(is64Bit, rn), R(is64Bit, rm), ConditionCodes[condition]);
+            case (true, 0b01):
+                if (canUseAlias && rn == rm)
+                {
+                    return Instruction("cneg", R(is64Bit, rd), R(is64Bit, rn), invertedCondition);
+                }
+                return Instruction("csneg", R(is64Bit, rd), R(is64Bit, rn), R(is64Bit, rm), ConditionCodes[condition]);
+            default:
+                return null;
+        }
+    }
+
+    private static DecodedInstruction? DecodeTwoSource(uint instruction, bool is64Bit, uint rd, uint rn, uint rm)
+    {
+        var mnemonic = Bits(instruction, 10, 6) switch
+        {
+            0b000010 => "udiv",
+            0b000011 => "sdiv",
+            0b001000 => "lsl",
+            0b001001 => "lsr",
+            0b001010 => "asr",
+            0b001011 => "ror",
+            _ => null,
+        };
+        return mnemonic is null ? null : Instruction(mnemonic, R(is64Bit, rd), R(is64Bit, rn), R(is64Bit, rm));
+    }
+
+    private static DecodedInstruction? DecodeOneSource(uint instruction, bool is64Bit, uint rd, uint rn)
+    {
+        var mnemonic = Bits(instruction, 10, 6) switch
+        {
+            0b000000 => "rbit",
+            0b000001 => "rev16",
+            0b000010 => is64Bit ? "rev32" : "rev",
+            0b000011 when is64Bit => "rev",
+            0b000100 => "clz",
+            0b000101 => "cls",
+            _ => null,
+        };
+        return mnemonic is null ? null : Instruction(mnemonic, R(is64Bit, rd), R(is64Bit, rn));
+    }
+
+    private static DecodedInstruction? DecodeThreeSource(uint instruction, bool is64Bit, uint rd, uint rn, uint rm)
+    {
+        var ra = Bits(instruction, 10, 5);
+        var isSubtract = Bit(instruction, 15);
+        switch (Bits(instruction, 21, 3))
+        {
+            case 0b000:
+                if (ra == 31)
+                {
+                    return Instruction(isSubtract ? "mneg" : "mul", R(is64Bit, rd), R(is64Bit, rn), R(is64Bit, rm));
+                }
+                return Instruction(isSubtract ? "msub" : "madd", R(is64Bit, rd), R(is64Bit, rn), R(is64Bit, rm), R(is64Bit, ra));
+            case 0b001:
+            case 0b101:
+            {
+                var signedness = Bits(instruction, 21, 3) == 0b001 ? "s" : "u";
+                if (ra == 31)
+                {
+                    return Instruction(signedness + (isSubtract ? "mnegl" : "mull"), X(rd), W(rn), W(rm));
+                }
+                return Instruction(signedness + (isSubtract ? "msubl" : "maddl"), X(rd), W(rn), W(rm), X(ra));
+            }
+            case 0b010:
+                return Instruction("smulh", X(rd), X(rn), X(rm));
+            case 0b110:
+                return Instruction("umulh", X(rd), X(rn), X(rm));
+            default:
+                return null;
+        }
+    }
+
+    #endregion
+
+    #region Scalar floating-point
+
+    private static DecodedInstruction? DecodeScalarFloatingPoint(uint instruction)
+    {
+        // Advanced SIMD vector instructions aren't decoded - only the scalar floating-point ones, which all have bit 28 set and bit 30 clear.
+        if ((instruction & 0x5F000000) != 0x1E000000 && (instruction & 0x5F000000) != 0x1F000000)
+        {
+            return null;
+        }
+
+        var size = Bits(instruction, 22, 2) switch
+        {
+            0b00 => 4,
+            0b01 => 8,
+            0b11 => 2,
+            _ => 0,
+        };
+        if (size == 0)
+        {
+            return null;
+        }
+
+        var rd = Bits(instruction, 0, 5);
+        var rn = Bits(instruction, 5, 5);
+        var rm = Bits(instruction, 16, 5);
+
+        if (Bit(instruction, 24))
+        {
+            var ra = Bits(instruction, 10, 5);
+            var mnemonic = (Bit(instruction, 21), Bit(instruction, 15)) switch
+            {
+                (false, false) => "fmadd",
+                (false, true) => "fmsub",
+                (true, false) => "fnmadd",
+                (true, true) => "fnmsub",
+            };
+            return Instruction(mnemonic, V(size, rd), V(size, rn), V(size, rm), V(size, ra));
+        }
+
+        if (!Bit(instruction, 21))
+        {
+            return null;
+        }
+
+        switch (Bits(instruction, 10, 2))
+        {
+            case 0b10:
+            {
+                var mnemonic = Bits(instruction, 12, 4) switch
+                {
+                    0b0000 => "fmul",
+                    0b0001 => "fdiv",
+                    0b0010 => "fadd",
+                    0b0011 => "fsub",
+                    0b0100 => "fmax",
+                    0b0101 => "fmin",
+                    0b0110 => "fmaxnm",
+                    0b0111 => "fminnm",
+                    0b1000 => "fnmul",
+                    _ => null,
+                };
+                return mnemonic is null ? null : Instruction(mnemonic, V(size, rd), V(size, rn), V(size, rm));
+            }
+            case 0b11:
+                return Instruction("fcsel", V(size, rd), V(size, rn), V(size, rm), ConditionCodes[Bits(instruction, 12, 4)]);
+            case 0b01:
+                return null;
+        }
+
+        if (Bits(instruction, 10, 5) == 0b10000)
+        {
+            var opcode = Bits(instruction, 15, 6);
+            if (opcode is >= 0b000100 and <= 0b000111)
+            {
+                var destinationSize = (opcode & 0b11) switch { 0b00 => 4, 0b01 => 8, 0b11 => 2, _ => 0 };
+                return destinationSize == 0 ? null : Instruction("fcvt", V(destinationSize, rd), V(size, rn));
+            }
+
+            var mnemonic = opcode switch
+            {
+                0b000000 => "fmov",
+                0b000001 => "fabs",
+                0b000010 => "fneg",
+                0b000011 => "fsqrt",
+                0b001000 => "frintn",
+                0b001001 => "frintp",
+                0b001010 => "frintm",
+                0b001011 => "frintz",
+                0b001100 => "frinta",
+                0b001110 => "frintx",
+                0b001111 => "frinti",
+                _ => null,
+            };
+            return mnemonic is null ? null : Instruction(mnemonic, V(size, rd), V(size, rn));
+        }
+
+        if (Bits(instruction, 10, 6) == 0b001000)
+        {
+            var withZero = Bit(instruction, 3);
+            var mnemonic = Bit(instruction, 4) ? "fcmpe" : "fcmp";
+            return Instruction(mnemonic, V(size, rn), withZero ? "#0.0" : V(size, rm));
+        }
+
+        if (Bits(instruction, 10, 3) == 0b100 && rn == 0)
+        {
+            return Instruction("fmov", V(size, rd), "#" + ExpandFloatingPointImmediate(Bits(instruction, 13, 8)).ToString("0.0###########", CultureInfo.InvariantCulture));
+        }
+
+        if (Bits(instruction, 10, 6) == 0)
+        {
+            return DecodeFloatingPointIntegerConversion(instruction, size, rd, rn);
+        }
+
+        return null;
+    }
+
+    private static DecodedInstruction? DecodeFloatingPointIntegerConversion(uint instruction, int size, uint rd, uint rn)
+    {
+        var is64Bit = Bit(instruction, 31);
+        var mnemonic = (Bits(instruction, 19, 2), Bits(instruction, 16, 3)) switch
+        {
+            (0b00, 0b000) => "fcvtns",
+            (0b00, 0b001) => "fcvtnu",
+            (0b00, 0b010) => "scvtf",
+            (0b00, 0b011) => "ucvtf",
+            (0b00, 0b100) => "fcvtas",
+            (0b00, 0b101) => "fcvtau",
+            (0b00, 0b110) => "fmov",
+            (0b00, 0b111) => "fmov",
+            (0b01, 0b000) => "fcvtps",
+            (0b01, 0b001) => "fcvtpu",
+            (0b10, 0b000) => "fcvtms",
+            (0b10, 0b001) => "fcvtmu",
+            (0b11, 0b000) => "fcvtzs",
+            (0b11, 0b001) => "fcvtzu",
+            _ => null,
+        };
+        if (mnemonic is null)
+        {
+            return null;
+        }
+
+        // scvtf, ucvtf and the fmov that moves a general-purpose register into a floating-point register are the only ones that go that way.
+        var toFloatingPoint = Bits(instruction, 16, 3) is 0b010 or 0b011 or 0b111;
+        return toFloatingPoint ? Instruction(mnemonic, V(size, rd), R(is64Bit, rn))
+                               : Instruction(mnemonic, R(is64Bit, rd), V(size, rn));
+    }
+
+    // The VFPExpandImm pseudocode - an 8-bit immediate is a sign, a 3-bit exponent from -3 to 4, and a 4-bit fraction.
+    private static double ExpandFloatingPointImmediate(uint imm8)
+    {
+        var sign = (imm8 & 0x80) != 0 ? -1.0 : 1.0;
+        var exponent = (int)(((imm8 >> 4) & 0x7) ^ 0x4) - 3;
+        var mantissa = (16 + (imm8 & 0xF)) / 16.0;
+        return sign * mantissa * Math.Pow(2, exponent);
+    }
+
+    #endregion
+}
@@ -0,0 +1,51 @@
+﻿namespace SizeBench.AnalysisEngine.Disassembly;
+
+internal enum InstructionFlow : byte
+{
+    Sequential,
+    Call,
+    Jump,
+    ConditionalJump,
+    Return,
+}
+
+// One instruction, as decoded by X64InstructionDecoder or ARM64InstructionDecoder.  The text is in the same style the debugger prints, so
+// disassembly from either backend reads (and diffs) the same way.
+//
+// When the instruction refers to another address in the binary - a branch target, or a RIP-relative/PC-relative load - TargetRVA is that
+// address and TargetTextStart/TargetTextLength locate the raw address within Operands, so it can be swapped out for a symbol name once
+// the target has been looked up.
+internal readonly record struct DecodedInstruction(uint RVA,
+                                                   int Length,
+                                                   string Mnemonic,
+                                                   string Operands,
+                                                   InstructionFlow Flow,
+                                                   uint? TargetRVA,
+                                                   int TargetTextStart,
+                                                   int TargetTextLength)
+{
+    // What the debugger prints for bytes it can't decode.
+    public const string UnknownMnemonic = "???";
+
+    public bool IsUnknown => ReferenceEquals(this.Mnemonic, UnknownMnemonic);
+
+    public static DecodedInstruction Unknown(uint rva, int length)
+        => new DecodedInstruction(rva, length, UnknownMnemonic, String.Empty, InstructionFlow.Sequential, null, 0, 0);
+
+    // The debugger lines up the operands at column 12, unless the mnemonic (with any prefixes, like "lock cmpxchg16b") is too long for that.
+    public string ToDisplayString() => ToDisplayString(this.Operands);
+
+    public string ToDisplayString(string operands)
+    {
+        if (operands.Length == 0)
+        {
+            return this.Mnemonic;
+        }
+
+        return (this.Mnemonic.Length < 12 ? this.Mnemonic.PadRight(12) : this.Mnemonic + " ") + operands;
+    }
+
+    // How the debugger prints an address it has no symbol for - 64-bit addresses get a ` between the high and low halves.
+    public static string FormatAbsoluteAddress(ulong address)
+        => address > UInt32.MaxValue ? $"{address >> 32:x8}`{address & 0xFFFFFFFF:x8}" : $"{address:x8}";
+}
@@ -0,0 +1,173 @@
+﻿using System.Globalization;
+using System.IO;
+using System.Text;
+using SizeBench.AnalysisEngine.PE;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.Disassembly;
+
+// Disassembles functions in-process, straight from the bytes of the mapped binary, instead of starting up the debugger engine for it (see
+// SessionOptions.Disassembler).  The output is in the debugger's style, with branch targets and RIP/PC-relative operands annotated with
+// the symbol at that address, so either backend can feed the same diffs and analyses.
+//
+// Decoding only reads bytes, so DecodeRange can be called from any number of threads at once - which is what makes it practical to decode
+// an entire binary.  Looking up the symbols for targets has to go to the DIA thread, so that's done once per distinct target, after
+// decoding.
+internal static class ManagedDisassembler
+{
+    public static bool SupportsMachineType(MachineType machineType)
+        => machineType is MachineType.x64 or MachineType.ARM64;
+
+    public static List<DecodedInstruction> DecodeRange(ReadOnlySpan<byte> code, uint rva, MachineType machineType, ulong imageBase)
+    {
+        var instructions = new List<DecodedInstruction>(capacity: code.Length / 4);
+        var offset = 0;
+
+        while (offset < code.Length)
+        {
+            var instructionRVA = rva + (uint)offset;
+            var instruction = machineType switch
+            {
+                MachineType.x64 => X64InstructionDecoder.Decode(code[offset..], instructionRVA, imageBase),
+                MachineType.ARM64 => ARM64InstructionDecoder.Decode(code[offset..], instructionRVA, imageBase),
+                _ => throw new ArgumentOutOfRangeException(nameof(machineType), $"The managed disassembler does not support {machineType} - callers should check SupportsMachineType first.  This is a bug in SizeBench's implementation, not your usage of it.")
+            };
+
+            instructions.Add(instruction);
+            offset += instruction.Length;
+        }
+
+        return instructions;
+    }
+
+    public static async Task<string> DisassembleAsync(Session session, PEFile peFile, IFunctionCodeSymbol function, DisassembleFunctionOptions options, ILogger taskLog, CancellationToken token)
+    {
+        // The debugger names the module after the file, with any dots other than the extension's turned into underscores.
+        var moduleName = Path.GetFileNameWithoutExtension(peFile.BinaryPath).Replace('.', '_');
+        var functionNameForDisassemblyOutput = options.ReplaceFunctionNameWith ?? function.FormattedName.IncludeParentType;
+
+        var instructionsByBlock = new List<List<DecodedInstruction>>(capacity: function.BlockCount);
+        foreach (var block in function.Blocks)
+        {
+            token.ThrowIfCancellationRequested();
+            instructionsByBlock.Add(peFile.DisassembleRange(new RVARange(block.RVA, block.RVAEnd)));
+        }
+
+        var targetNames = await ResolveTargetNames(session, function, functionNameForDisassemblyOutput, options, instructionsByBlock, taskLog, token).ConfigureAwait(true);
+
+        var sb = new StringBuilder(5000);
+        foreach (var instructions in instructionsByBlock)
+        {
+            foreach (var instruction in instructions)
+            {
+                sb.AppendLine(FormatInstruction(instruction, moduleName, peFile.PreferredLoadAddress, targetNames, options.StripAbsoluteAddressForFunctionLocalReferences));
+            }
+        }
+
+        taskLog.Log($"Disassembled {instructionsByBlock.Sum(instructions => instructions.Count):N0} instructions, referring to {targetNames.Count:N0} distinct targets.");
+        return sb.ToString();
+    }
+
+    private static async Task<Dictionary<uint, (string? Name, bool IsInThisFunction)>> ResolveTargetNames(Session session,
+                                                                                                            IFunctionCodeSymbol function,
+                                                                                                            string functionNameForDisassemblyOutput,
+                                                                                                            DisassembleFunctionOptions options,
+                                                                                                            List<List<DecodedInstruction>> instructionsByBlock,
+                                                                                                            ILogger taskLog,
+                                                                                                            CancellationToken token)
+    {
+        var targetNames = new Dictionary<uint, (string? Name, bool IsInThisFunction)>();
+
+        foreach (var instructions in instructionsByBlock)
+        {
+            foreach (var instruction in instructions)
+            {
+                if (instruction.TargetRVA is not uint targetRVA || targetNames.ContainsKey(targetRVA))
+                {
+                    continue;
+                }
+
+                token.ThrowIfCancellationRequested();
+
+                if (DoesFunctionContainRVA(function, targetRVA))
+                {
+                    targetNames.Add(targetRVA, (FormatOffsetName(functionNameForDisassemblyOutput, targetRVA, function.PrimaryBlock.RVA), true));
+                    continue;
+                }
+
+                var symbol = await session.LoadSymbolByRVA(targetRVA, token, taskLog).ConfigureAwait(true);
+                var name = symbol switch
+                {
+                    null => null,
+                    IFunctionCodeSymbol targetFunction => targetFunction.FormattedName.IncludeParentType,
+                    CodeBlockSymbol block => FormatOffsetName(block.ParentFunction.FormattedName.IncludeParentType, targetRVA, block.ParentFunction.PrimaryBlock.RVA),
+                    _ => symbol.Name,
+                };
+
+                if (name != null && options.ReplaceFunctionNameWith != null &&
+                    options.FunctionsThatShareAnRVAWithDisassembledFunction.Any(f => f.FormattedName.IncludeParentType == name))
+                {
+                    name = options.ReplaceFunctionNameWith;
+                }
+
+                targetNames.Add(targetRVA, (name, false));
+            }
+        }
+
+        return targetNames;
+    }
+
+    private static string FormatOffsetName(string name, uint rva, uint functionStartRVA)
+    {
+        if (rva == functionStartRVA)
+        {
+            return name;
+        }
+
+        var offset = (long)rva - functionStartRVA;
+        return offset > 0 ? $"{name}+0x{offset.ToString("x", CultureInfo.InvariantCulture)}"
+                          : $"{name}-0x{(-offset).ToString("x", CultureInfo.InvariantCulture)}";
+    }
+
+    private static string FormatInstruction(DecodedInstruction instruction,
+                                            string moduleName,
+                                            ulong imageBase,
+                                            Dictionary<uint, (string? Name, bool IsInThisFunction)> targetNames,
+                                            bool stripAbsoluteAddressForFunctionLocalReferences)
+    {
+        if (instruction.TargetRVA is not uint targetRVA ||
+            !targetNames.TryGetValue(targetRVA, out var target) ||
+            target.Name is null)
+        {
+            return instruction.ToDisplayString();
+        }
+
+        var operands = instruction.Operands;
+        var annotated = new StringBuilder(operands.Length + moduleName.Length + target.Name.Length + 4);
+        annotated.Append(operands.AsSpan(0, instruction.TargetTextStart));
+        annotated.Append(moduleName).Append('!').Append(target.Name);
+
+        if (!(target.IsInThisFunction && stripAbsoluteAddressForFunctionLocalReferences))
+        {
+            // Next to a symbol name the debugger prints the address without leading zeroes or the ` separator.
+            annotated.Append(" (").Append((imageBase + targetRVA).ToString("x", CultureInfo.InvariantCulture)).Append(')');
+        }
+
+        annotated.Append(operands.AsSpan(instruction.TargetTextStart + instruction.TargetTextLength));
+        return instruction.ToDisplayString(annotated.ToString());
+    }
+
+    private static bool DoesFunctionContainRVA(IFunctionCodeSymbol function, uint rva)
+    {
+        foreach (var block in function.Blocks)
+        {
+            if (rva >= block.RVA && rva <= block.RVAEnd)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
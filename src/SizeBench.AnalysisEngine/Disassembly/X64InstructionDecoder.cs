@@ -0,0 +1,1614 @@
+﻿using System.Globalization;
+using System.Text;
+
+namespace SizeBench.AnalysisEngine.Disassembly;
+
+// Decodes x64 instructions into the same text the debugger's disassembler prints (MASM syntax - "mov         rax,qword ptr [rcx+8]").
+//
+// This covers the general-purpose instructions, SSE through SSE4 and the common AVX ones, which is what compilers emit for nearly all
+// code.  Anything else (x87, AVX-512, system instructions) decodes to "???" - when the length of the instruction can still be worked out it
+// is skipped entirely, so decoding stays in sync with the instruction stream.
+//
+// Decoding is a pure function of the bytes, so any number of threads can decode at once.
+internal static class X64InstructionDecoder
+{
+    public const int MaxInstructionLength = 15;
+
+    private static readonly string[] Registers64 = ["rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"];
+    private static readonly string[] Registers32 = ["eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi", "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d"];
+    private static readonly string[] Registers16 = ["ax", "cx", "dx", "bx", "sp", "bp", "si", "di", "r8w", "r9w", "r10w", "r11w", "r12w", "r13w", "r14w", "r15w"];
+    private static readonly string[] Registers8 = ["al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil", "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b"];
+    private static readonly string[] LegacyHighByteRegisters = ["ah", "ch", "dh", "bh"];
+    private static readonly string[] SegmentRegisters = ["es", "cs", "ss", "ds", "fs", "gs", "?", "?"];
+
+    private static readonly string[] ConditionCodes = ["o", "no", "b", "ae", "e", "ne", "be", "a", "s", "ns", "p", "np", "l", "ge", "le", "g"];
+    private static readonly string[] ArithmeticGroup = ["add", "or", "adc", "sbb", "and", "sub", "xor", "cmp"];
+    private static readonly string[] ShiftGroup = ["rol", "ror", "rcl", "rcr", "shl", "shr", "shl", "sar"];
+
+    // The 66 0F xx integer SSE instructions that all take the form "op xmm,xmm/m128" - without the 66 prefix, they're the MMX equivalent.
+    private static readonly Dictionary<byte, string> PackedIntegerInstructions = new Dictionary<byte, string>()
+    {
+        [0x60] = "punpcklbw", [0x61] = "punpcklwd", [0x62] = "punpckldq", [0x63] = "packsswb", [0x64] = "pcmpgtb", [0x65] = "pcmpgtw",
+        [0x66] = "pcmpgtd", [0x67] = "packuswb", [0x68] = "punpckhbw", [0x69] = "punpckhwd", [0x6A] = "punpckhdq", [0x6B] = "packssdw",
+        [0x6C] = "punpcklqdq", [0x6D] = "punpckhqdq", [0x74] = "pcmpeqb", [0x75] = "pcmpeqw", [0x76] = "pcmpeqd",
+        [0xD1] = "psrlw", [0xD2] = "psrld", [0xD3] = "psrlq", [0xD4] = "paddq", [0xD5] = "pmullw", [0xD8] = "psubusb", [0xD9] = "psubusw",
+        [0xDA] = "pminub", [0xDB] = "pand", [0xDC] = "paddusb", [0xDD] = "paddusw", [0xDE] = "pmaxub", [0xDF] = "pandn", [0xE0] = "pavgb",
+        [0xE1] = "psraw", [0xE2] = "psrad", [0xE3] = "pavgw", [0xE4] = "pmulhuw", [0xE5] = "pmulhw", [0xE8] = "psubsb", [0xE9] = "psubsw",
+        [0xEA] = "pminsw", [0xEB] = "por", [0xEC] = "paddsb", [0xED] = "paddsw", [0xEE] = "pmaxsw", [0xEF] = "pxor", [0xF1] = "psllw",
+        [0xF2] = "pslld", [0xF3] = "psllq", [0xF4] = "pmuludq", [0xF5] = "pmaddwd", [0xF6] = "psadbw", [0xF8] = "psubb", [0xF9] = "psubw",
+        [0xFA] = "psubd", [0xFB] = "psubq", [0xFC] = "paddb", [0xFD] = "paddw", [0xFE] = "paddd",
+    };
+
+    // The 66 0F 38 xx instructions that take the form "op xmm,xmm/m128".
+    private static readonly Dictionary<byte, string> ThreeByte38Instructions = new Dictionary<byte, string>()
+    {
+        [0x00] = "pshufb", [0x01] = "phaddw", [0x02] = "phaddd", [0x04] = "pmaddubsw", [0x08] = "psignb", [0x0B] = "pmulhrsw", [0x10] = "pblendvb",
+        [0x17] = "ptest", [0x1C] = "pabsb", [0x1D] = "pabsw", [0x1E] = "pabsd", [0x20] = "pmovsxbw", [0x21] = "pmovsxbd", [0x22] = "pmovsxbq",
+        [0x23] = "pmovsxwd", [0x24] = "pmovsxwq", [0x25] = "pmovsxdq", [0x28] = "pmuldq", [0x29] = "pcmpeqq", [0x2B] = "packusdw",
+        [0x30] = "pmovzxbw", [0x31] = "pmovzxbd", [0x32] = "pmovzxbq", [0x33] = "pmovzxwd", [0x34] = "pmovzxwq", [0x35] = "pmovzxdq",
+        [0x37] = "pcmpgtq", [0x38] = "pminsb", [0x39] = "pminsd", [0x3A] = "pminuw", [0x3B] = "pminud", [0x3C] = "pmaxsb", [0x3D] = "pmaxsd",
+        [0x3E] = "pmaxuw", [0x3F] = "pmaxud", [0x40] = "pmulld", [0xDC] = "aesenc", [0xDD] = "aesenclast", [0xDE] = "aesdec", [0xDF] = "aesdeclast",
+    };
+
+    // The 66 0F 3A xx instructions that take the form "op xmm,xmm/m128,imm8".
+    private static readonly Dictionary<byte, string> ThreeByte3AInstructions = new Dictionary<byte, string>()
+    {
+        [0x08] = "roundps", [0x09] = "roundpd", [0x0A] = "roundss", [0x0B] = "roundsd", [0x0C] = "blendps", [0x0D] = "blendpd", [0x0E] = "pblendw",
+        [0x0F] = "palignr", [0x21] = "insertps", [0x40] = "dpps", [0x41] = "dppd", [0x44] = "pclmulqdq", [0x60] = "pcmpestrm", [0x61] = "pcmpestri",
+        [0x62] = "pcmpistrm", [0x63] = "pcmpistri",
+    };
+
+    /// <summary>
+    /// Decodes the instruction at the start of <paramref name="code"/>.
+    /// </summary>
+    /// <param name="code">The bytes of the instruction, and whatever follows it - at most <see cref="MaxInstructionLength"/> bytes are read.</param>
+    /// <param name="rva">The RVA of the first byte, which RIP-relative operands and branch targets are relative to.</param>
+    /// <param name="imageBase">The preferred load address of the binary, to print absolute addresses as the debugger would.</param>
+    /// <returns>The decoded instruction, which is always at least one byte long even if it couldn't be decoded.</returns>
+    public static DecodedInstruction Decode(ReadOnlySpan<byte> code, uint rva, ulong imageBase)
+    {
+        var decoder = new Decoder(code.Length > MaxInstructionLength ? code[..MaxInstructionLength] : code, rva, imageBase);
+        return decoder.Decode();
+    }
+
+    private static string FormatHex(ulong value)
+    {
+        if (value < 10)
+        {
+            return value.ToString(CultureInfo.InvariantCulture);
+        }
+
+        // MASM requires a leading 0 for a hex number that would otherwise start with a letter.
+        var hex = value.ToString("X", CultureInfo.InvariantCulture);
+        return (hex[0] > '9' ? "0" : String.Empty) + hex + "h";
+    }
+
+    private static string GetPointerSize(int size) => size switch
+    {
+        0 => String.Empty,
+        1 => "byte ptr ",
+        2 => "word ptr ",
+        4 => "dword ptr ",
+        8 => "qword ptr ",
+        10 => "tbyte ptr ",
+        16 => "xmmword ptr ",
+        32 => "ymmword ptr ",
+        _ => throw new ArgumentOutOfRangeException(nameof(size)),
+    };
+
+    private static ulong TruncateToSize(ulong value, int size) => size switch
+    {
+        1 => value & 0xFF,
+        2 => value & 0xFFFF,
+        4 => value & 0xFFFFFFFF,
+        _ => value,
+    };
+
+    private ref struct Decoder
+    {
+        // Marks where a RIP-relative address or branch target goes in the operands, since it can't be computed until the whole instruction
+        // (including any immediate after it) has been decoded.
+        private const string TargetPlaceholder = "\u0001";
+
+        private readonly ReadOnlySpan<byte> _code;
+        private readonly uint _rva;
+        private readonly ulong _imageBase;
+        private int _position;
+        private bool _failed;
+
+        // Prefixes
+        private bool _lock;
+        private bool _rep;
+        private bool _repne;
+        private bool _operandSizeOverride;
+        private bool _addressSizeOverride;
+        private int _segment;
+        private byte _rex;
+
+        // VEX, which only matters for the few instructions that use the extra register operand or 256-bit length.
+        private bool _vex;
+        private int _vexMap;
+        private int _vexRegister;
+        private bool _vexLength256;
+
+        // ModR/M
+        private bool _hasModRM;
+        private int _mod;
+        private int _reg;
+        private int _rm;
+        private string _memory;
+
+        private long _relativeTargetDisplacement;
+        private bool _hasRelativeTarget;
+
+        private string _mnemonic;
+        private readonly StringBuilder _operands;
+        private InstructionFlow _flow;
+
+        public Decoder(ReadOnlySpan<byte> code, uint rva, ulong imageBase)
+        {
+            this._code = code;
+            this._rva = rva;
+            this._imageBase = imageBase;
+            this._segment = -1;
+            this._memory = String.Empty;
+            this._mnemonic = String.Empty;
+            this._operands = new StringBuilder(32);
+        }
+
+        private readonly bool RexW => (this._rex & 0x8) != 0;
+        private readonly int RexR => (this._rex & 0x4) << 1;
+        private readonly int RexX => (this._rex & 0x2) << 2;
+        private readonly int RexB => (this._rex & 0x1) << 3;
+
+        // The size of a general-purpose operand that isn't fixed by the opcode.
+        private readonly int OperandSize => this.RexW ? 8 : (this._operandSizeOverride ? 2 : 4);
+
+        // The prefix that selects between the ps/pd/ss/sd (or none/66/F3/F2) forms of an SSE instruction - the last of F2/F3 wins over 66.
+        private readonly int MandatoryPrefix => this._repne ? 0xF2 : (this._rep ? 0xF3 : (this._operandSizeOverride ? 0x66 : 0));
+
+        public DecodedInstruction Decode()
+        {
+            ReadPrefixes();
+
+            if (!this._failed)
+            {
+                var opcode = ReadByte();
+                if (!this._failed)
+                {
+                    if (this._vex)
+                    {
+                        DecodeVex(opcode);
+                    }
+                    else if (opcode == 0x0F)
+                    {
+                        DecodeTwoByte(ReadByte());
+                    }
+                    else
+                    {
+                        DecodeOneByte(opcode);
+                    }
+                }
+            }
+
+            if (this._failed || this._mnemonic.Length == 0)
+            {
+                return DecodedInstruction.Unknown(this._rva, this._failed ? 1 : this._position);
+            }
+
+            var mnemonic = this._mnemonic;
+            if (this._lock)
+            {
+                mnemonic = "lock " + mnemonic;
+            }
+
+            var operands = this._operands.ToString();
+            uint? targetRVA = null;
+            int targetStart = 0, targetLength = 0;
+            if (this._hasRelativeTarget)
+            {
+                var target = this._rva + this._position + this._relativeTargetDisplacement;
+                var targetText = DecodedInstruction.FormatAbsoluteAddress(this._imageBase + (ulong)target);
+                targetStart = operands.IndexOf(TargetPlaceholder, StringComparison.Ordinal);
+                targetLength = targetText.Length;
+                operands = operands.Replace(TargetPlaceholder, targetText, StringComparison.Ordinal);
+                if (target is >= 0 and <= UInt32.MaxValue)
+                {
+                    targetRVA = (uint)target;
+                }
+            }
+
+            return new DecodedInstruction(this._rva, this._position, mnemonic, operands, this._flow, targetRVA, targetStart, targetLength);
+        }
+
+        #region Reading bytes
+
+        private byte ReadByte()
+        {
+            if (this._position >= this._code.Length)
+            {
+                this._failed = true;
+                return 0;
+            }
+
+            return this._code[this._position++];
+        }
+
+        private byte PeekByte() => this._position < this._code.Length ? this._code[this._position] : (byte)0;
+
+        private ushort ReadUInt16() => (ushort)(ReadByte() | (ReadByte() << 8));
+
+        private uint ReadUInt32() => ReadUInt16() | ((uint)ReadUInt16() << 16);
+
+        private ulong ReadUInt64() => ReadUInt32() | ((ulong)ReadUInt32() << 32);
+
+        #endregion
+
+        #region Prefixes
+
+        private void ReadPrefixes()
+        {
+            while (!this._failed)
+            {
+                var b = PeekByte();
+                switch (b)
+                {
+                    case 0xF0: this._lock = true; break;
+                    case 0xF2: this._repne = true; this._rep = false; break;
+                    case 0xF3: this._rep = true; this._repne = false; break;
+                    case 0x66: this._operandSizeOverride = true; break;
+                    case 0x67: this._addressSizeOverride = true; break;
+                    case 0x26: this._segment = 0; break;
+                    case 0x2E: this._segment = 1; break;
+                    case 0x36: this._segment = 2; break;
+                    case 0x3E: this._segment = 3; break;
+                    case 0x64: this._segment = 4; break;
+                    case 0x65: this._segment = 5; break;
+                    default:
+                        if (b is >= 0x40 and <= 0x4F)
+                        {
+                            // REX only counts if it's immediately before the opcode - otherwise it's ignored.
+                            ReadByte();
+                            this._rex = b;
+                            if (PeekByte() is 0xF0 or 0xF2 or 0xF3 or 0x66 or 0x67 or 0x26 or 0x2E or 0x36 or 0x3E or 0x64 or 0x65 or (>= 0x40 and <= 0x4F))
+                            {
+                                this._rex = 0;
+                                continue;
+                            }
+                        }
+                        else if (b is 0xC4 or 0xC5)
+                        {
+                            ReadVexPrefix(b);
+                        }
+                        return;
+                }
+
+                ReadByte();
+            }
+        }
+
+        private void ReadVexPrefix(byte vexByte)
+        {
+            ReadByte();
+            var first = ReadByte();
+            var rex = (byte)0x40;
+            int map;
+            byte second;
+            if (vexByte == 0xC5)
+            {
+                rex |= (byte)((first & 0x80) == 0 ? 0x4 : 0);
+                map = 1;
+                second = first;
+            }
+            else
+            {
+                rex |= (byte)((first & 0x80) == 0 ? 0x4 : 0);
+                rex |= (byte)((first & 0x40) == 0 ? 0x2 : 0);
+                rex |= (byte)((first & 0x20) == 0 ? 0x1 : 0);
+                map = first & 0x1F;
+                second = ReadByte();
+                rex |= (byte)((second & 0x80) != 0 ? 0x8 : 0);
+            }
+
+            this._vex = true;
+            this._rex = rex;
+            this._vexRegister = (~second >> 3) & 0xF;
+            this._vexLength256 = (second & 0x4) != 0;
+            switch (second & 0x3)
+            {
+                case 1: this._operandSizeOverride = true; break;
+                case 2: this._rep = true; break;
+                case 3: this._repne = true; break;
+            }
+
+            // The opcode map replaces the 0F, 0F 38 or 0F 3A escape bytes - anything else is left for DecodeVex to reject.
+            this._vexMap = map;
+        }
+
+        #endregion
+
+        #region ModR/M and operands
+
+        private void ReadModRM()
+        {
+            var modrm = ReadByte();
+            this._hasModRM = true;
+            this._mod = modrm >> 6;
+            this._reg = ((modrm >> 3) & 7) | this.RexR;
+            this._rm = modrm & 7;
+
+            if (this._mod == 3)
+            {
+                this._rm |= this.RexB;
+                return;
+            }
+
+            var addressRegisters = this._addressSizeOverride ? Registers32 : Registers64;
+            string? baseRegister = null;
+            string? indexRegister = null;
+            var scale = 1;
+            long displacement = 0;
+            var ripRelative = false;
+
+            if (this._rm == 4)
+            {
+                var sib = ReadByte();
+                scale = 1 << (sib >> 6);
+                var index = ((sib >> 3) & 7) | this.RexX;
+                var baseField = sib & 7;
+                if (index != 4)
+                {
+                    indexRegister = addressRegisters[index];
+                }
+
+                if (baseField == 5 && this._mod == 0)
+                {
+                    displacement = (int)ReadUInt32();
+                }
+                else
+                {
+                    baseRegister = addressRegisters[baseField | this.RexB];
+                }
+            }
+            else if (this._rm == 5 && this._mod == 0)
+            {
+                ripRelative = true;
+                displacement = (int)ReadUInt32();
+            }
+            else
+            {
+                baseRegister = addressRegisters[this._rm | this.RexB];
+            }
+
+            if (this._mod == 1)
+            {
+                displacement = (sbyte)ReadByte();
+            }
+            else if (this._mod == 2)
+            {
+                displacement = (int)ReadUInt32();
+            }
+
+            var segment = this._segment is 4 or 5 ? SegmentRegisters[this._segment] + ":" : String.Empty;
+            if (ripRelative)
+            {
+                this._hasRelativeTarget = true;
+                this._relativeTargetDisplacement = displacement;
+                this._memory = segment + "[" + TargetPlaceholder + "]";
+                return;
+            }
+
+            var sb = new StringBuilder(24);
+            sb.Append(segment).Append('[');
+            if (baseRegister != null)
+            {
+                sb.Append(baseRegister);
+            }
+            if (indexRegister != null)
+            {
+                if (baseRegister != null)
+                {
+                    sb.Append('+');
+                }
+                sb.Append(indexRegister);
+                if (scale > 1)
+                {
+                    sb.Append('*').Append(scale);
+                }
+            }
+            if (baseRegister is null && indexRegister is null)
+            {
+                sb.Append(FormatHex((uint)displacement));
+            }
+            else if (displacement != 0)
+            {
+                sb.Append(displacement < 0 ? '-' : '+').Append(FormatHex((ulong)Math.Abs(displacement)));
+            }
+            sb.Append(']');
+            this._memory = sb.ToString();
+        }
+
+        private readonly bool IsMemory => this._hasModRM && this._mod != 3;
+
+        private static string Gpr(int register, int size, bool hasRex) => size switch
+        {
+            8 => Registers64[register],
+            4 => Registers32[register],
+            2 => Registers16[register],
+            _ => !hasRex && register is >= 4 and <= 7 ? LegacyHighByteRegisters[register - 4] : Registers8[register],
+        };
+
+        private readonly string Gpr(int register, int size) => Gpr(register, size, this._rex != 0);
+
+        private readonly string RegOperand(int size) => Gpr(this._reg, size);
+
+        private readonly string RmOperand(int size) => this.IsMemory ? GetPointerSize(size) + this._memory : Gpr(this._rm, size);
+
+        // For lea and the prefetches, which have no size.
+        private readonly string RmAddress() => this._memory;
+
+        private readonly string Xmm(int register) => (this._vexLength256 ? "ymm" : "xmm") + register.ToString(CultureInfo.InvariantCulture);
+
+        private readonly string XmmReg() => Xmm(this._reg);
+
+        private readonly string XmmRm(int memorySize) => this.IsMemory ? GetPointerSize(this._vexLength256 && memorySize == 16 ? 32 : memorySize) + this._memory : Xmm(this._rm);
+
+        private readonly string MmReg() => "mm" + (this._reg & 7).ToString(CultureInfo.InvariantCulture);
+
+        private readonly string MmRm() => this.IsMemory ? GetPointerSize(8) + this._memory : "mm" + (this._rm & 7).ToString(CultureInfo.InvariantCulture);
+
+        private void SetInstruction(string mnemonic, params string[] operands)
+        {
+            this._mnemonic = mnemonic;
+            for (var i = 0; i < operands.Length; i++)
+            {
+                if (i > 0)
+                {
+                    this._operands.Append(',');
+                }
+                this._operands.Append(operands[i]);
+            }
+        }
+
+        private string ReadUnsignedImmediate(int size)
+        {
+            ulong value = size switch
+            {
+                1 => ReadByte(),
+                2 => ReadUInt16(),
+                _ => ReadUInt32(),
+            };
+            return FormatHex(value);
+        }
+
+        // An immediate of immediateSize bytes, sign-extended to fit an operand of operandSize bytes.
+        private string ReadImmediate(int immediateSize, int operandSize)
+        {
+            long value = immediateSize switch
+            {
+                1 => (sbyte)ReadByte(),
+                2 => (short)ReadUInt16(),
+                _ => (int)ReadUInt32(),
+            };
+            return FormatHex(TruncateToSize((ulong)value, operandSize));
+        }
+
+        // Iz - a 16-bit immediate for 16-bit operands, and a 32-bit immediate (sign-extended if needed) for the rest.
+        private string ReadImmediateZ(int operandSize) => ReadImmediate(operandSize == 2 ? 2 : 4, operandSize);
+
+        private string ReadRelativeTarget(int size)
+        {
+            this._relativeTargetDisplacement = size == 1 ? (sbyte)ReadByte() : (int)ReadUInt32();
+            this._hasRelativeTarget = true;
+            return TargetPlaceholder;
+        }
+
+        #endregion
+
+        #region One-byte opcodes
+
+        private void DecodeOneByte(byte opcode)
+        {
+            var operandSize = this.OperandSize;
+
+            if (opcode < 0x40 && (opcode & 7) < 6)
+            {
+                var mnemonic = ArithmeticGroup[opcode >> 3];
+                switch (opcode & 7)
+                {
+                    case 0: ReadModRM(); SetInstruction(mnemonic, RmOperand(1), RegOperand(1)); break;
+                    case 1: ReadModRM(); SetInstruction(mnemonic, RmOperand(operandSize), RegOperand(operandSize)); break;
+                    case 2: ReadModRM(); SetInstruction(mnemonic, RegOperand(1), RmOperand(1)); break;
+                    case 3: ReadModRM(); SetInstruction(mnemonic, RegOperand(operandSize), RmOperand(operandSize)); break;
+                    case 4: SetInstruction(mnemonic, "al", ReadImmediate(1, 1)); break;
+                    case 5: SetInstruction(mnemonic, Gpr(0, operandSize), ReadImmediateZ(operandSize)); break;
+                }
+                return;
+            }
+
+            switch (opcode)
+            {
+                case >= 0x50 and <= 0x57:
+                    SetInstruction("push", Gpr((opcode & 7) | this.RexB, this._operandSizeOverride ? 2 : 8));
+                    return;
+                case >= 0x58 and <= 0x5F:
+                    SetInstruction("pop", Gpr((opcode & 7) | this.RexB, this._operandSizeOverride ? 2 : 8));
+                    return;
+                case 0x63:
+                    ReadModRM();
+                    SetInstruction("movsxd", RegOperand(operandSize), RmOperand(4));
+                    return;
+                case 0x68:
+                    SetInstruction("push", ReadImmediateZ(this._operandSizeOverride ? 2 : 8));
+                    return;
+                case 0x69:
+                    ReadModRM();
+                    SetInstruction("imul", RegOperand(operandSize), RmOperand(operandSize), ReadImmediateZ(operandSize));
+                    return;
+                case 0x6A:
+                    SetInstruction("push", ReadImmediate(1, this._operandSizeOverride ? 2 : 8));
+                    return;
+                case 0x6B:
+                    ReadModRM();
+                    SetInstruction("imul", RegOperand(operandSize), RmOperand(operandSize), ReadImmediate(1, operandSize));
+                    return;
+                case >= 0x70 and <= 0x7F:
+                    this._flow = InstructionFlow.ConditionalJump;
+                    SetInstruction("j" + ConditionCodes[opcode & 0xF], ReadRelativeTarget(1));
+                    return;
+                case 0x80:
+                case 0x81:
+                case 0x83:
+                {
+                    ReadModRM();
+                    var size = opcode == 0x80 ? 1 : operandSize;
+                    var immediate = opcode == 0x81 ? ReadImmediateZ(size) : ReadImmediate(1, size);
+                    SetInstruction(ArithmeticGroup[this._reg & 7], RmOperand(size), immediate);
+                    return;
+                }
+                case 0x84:
+                case 0x85:
+                {
+                    ReadModRM();
+                    var size = opcode == 0x84 ? 1 : operandSize;
+                    SetInstruction("test", RmOperand(size), RegOperand(size));
+                    return;
+                }
+                case 0x86:
+                case 0x87:
+                {
+                    ReadModRM();
+                    var size = opcode == 0x86 ? 1 : operandSize;
+                    SetInstruction("xchg", RmOperand(size), RegOperand(size));
+                    return;
+                }
+                case 0x88: ReadModRM(); SetInstruction("mov", RmOperand(1), RegOperand(1)); return;
+                case 0x89: ReadModRM(); SetInstruction("mov", RmOperand(operandSize), RegOperand(operandSize)); return;
+                case 0x8A: ReadModRM(); SetInstruction("mov", RegOperand(1), RmOperand(1)); return;
+                case 0x8B: ReadModRM(); SetInstruction("mov", RegOperand(operandSize), RmOperand(operandSize)); return;
+                case 0x8C: ReadModRM(); SetInstruction("mov", RmOperand(this.IsMemory ? 2 : operandSize), SegmentRegisters[this._reg & 7]); return;
+                case 0x8D:
+                    ReadModRM();
+                    if (!this.IsMemory)
+                    {
+                        return;
+                    }
+                    SetInstruction("lea", RegOperand(operandSize), RmAddress());
+                    return;
+                case 0x8E: ReadModRM(); SetInstruction("mov", SegmentRegisters[this._reg & 7], RmOperand(2)); return;
+                case 0x8F:
+                    ReadModRM();
+                    if ((this._reg & 7) == 0)
+                    {
+                        SetInstruction("pop", RmOperand(this._operandSizeOverride ? 2 : 8));
+                    }
+                    return;
+                case 0x90:
+                    if (this.RexB != 0)
+                    {
+                        SetInstruction("xchg", Gpr(8, operandSize), Gpr(0, operandSize));
+                    }
+                    else
+                    {
+                        SetInstruction(this._rep ? "pause" : "nop");
+                    }
+                    return;
+                case >= 0x91 and <= 0x97:
+                    SetInstruction("xchg", Gpr((opcode & 7) | this.RexB, operandSize), Gpr(0, operandSize));
+                    return;
+                case 0x98: SetInstruction(operandSize == 8 ? "cdqe" : (operandSize == 2 ? "cbw" : "cwde")); return;
+                case 0x99: SetInstruction(operandSize == 8 ? "cqo" : (operandSize == 2 ? "cwd" : "cdq")); return;
+                case 0x9C: SetInstruction(this._operandSizeOverride ? "pushf" : "pushfq"); return;
+                case 0x9D: SetInstruction(this._operandSizeOverride ? "popf" : "popfq"); return;
+                case 0x9E: SetInstruction("sahf"); return;
+                case 0x9F: SetInstruction("lahf"); return;
+                case >= 0xA0 and <= 0xA3:
+                {
+                    // The only instructions with a full 64-bit address in them, rather than a displacement.
+                    var size = (opcode & 1) == 0 ? 1 : operandSize;
+                    var address = GetPointerSize(size) + "[" + FormatHex(this._addressSizeOverride ? ReadUInt32() : ReadUInt64()) + "]";
+                    if (opcode <= 0xA1)
+                    {
+                        SetInstruction("mov", Gpr(0, size), address);
+                    }
+                    else
+                    {
+                        SetInstruction("mov", address, Gpr(0, size));
+                    }
+                    return;
+                }
+                case 0xA8: SetInstruction("test", "al", ReadImmediate(1, 1)); return;
+                case 0xA9: SetInstruction("test", Gpr(0, operandSize), ReadImmediateZ(operandSize)); return;
+                case >= 0xA4 and <= 0xA7:
+                case >= 0xAA and <= 0xAF:
+                    DecodeStringInstruction(opcode, operandSize);
+                    return;
+                case >= 0xB0 and <= 0xB7:
+                    SetInstruction("mov", Gpr((opcode & 7) | this.RexB, 1), ReadImmediate(1, 1));
+                    return;
+                case >= 0xB8 and <= 0xBF:
+                    SetInstruction("mov",
+                                   Gpr((opcode & 7) | this.RexB, operandSize),
+                                   operandSize == 8 ? FormatHex(ReadUInt64()) : ReadUnsignedImmediate(operandSize));
+                    return;
+                case 0xC0:
+                case 0xC1:
+                case 0xD0:
+                case 0xD1:
+                case 0xD2:
+                case 0xD3:
+                {
+                    ReadModRM();
+                    var size = (opcode & 1) == 0 ? 1 : operandSize;
+                    var count = opcode switch
+                    {
+                        0xC0 or 0xC1 => ReadImmediate(1, 1),
+                        0xD0 or 0xD1 => "1",
+                        _ => "cl",
+                    };
+                    SetInstruction(ShiftGroup[this._reg & 7], RmOperand(size), count);
+                    return;
+                }
+                case 0xC2:
+                    this._flow = InstructionFlow.Return;
+                    SetInstruction("ret", ReadUnsignedImmediate(2));
+                    return;
+                case 0xC3:
+                    this._flow = InstructionFlow.Return;
+                    SetInstruction(this._rep ? "rep ret" : "ret");
+                    return;
+                case 0xC6:
+                    ReadModRM();
+                    if ((this._reg & 7) == 0)
+                    {
+                        SetInstruction("mov", RmOperand(1), ReadImmediate(1, 1));
+                    }
+                    return;
+                case 0xC7:
+                    ReadModRM();
+                    if ((this._reg & 7) == 0)
+                    {
+                        SetInstruction("mov", RmOperand(operandSize), ReadImmediateZ(operandSize));
+                    }
+                    return;
+                case 0xC8:
+                {
+                    var frameSize = ReadUnsignedImmediate(2);
+                    SetInstruction("enter", frameSize, ReadUnsignedImmediate(1));
+                    return;
+                }
+                case 0xC9: SetInstruction("leave"); return;
+                case 0xCC: SetInstruction("int", "3"); return;
+                case 0xCD: SetInstruction("int", ReadUnsignedImmediate(1)); return;
+                case >= 0xE0 and <= 0xE3:
+                {
+                    this._flow = InstructionFlow.ConditionalJump;
+                    var mnemonic = opcode switch
+                    {
+                        0xE0 => "loopne",
+                        0xE1 => "loope",
+                        0xE2 => "loop",
+                        _ => this._addressSizeOverride ? "jecxz" : "jrcxz",
+                    };
+                    SetInstruction(mnemonic, ReadRelativeTarget(1));
+                    return;
+                }
+                case 0xE8:
+                    this._flow = InstructionFlow.Call;
+                    SetInstruction("call", ReadRelativeTarget(4));
+                    return;
+                case 0xE9:
+                    this._flow = InstructionFlow.Jump;
+                    SetInstruction("jmp", ReadRelativeTarget(4));
+                    return;
+                case 0xEB:
+                    this._flow = InstructionFlow.Jump;
+                    SetInstruction("jmp", ReadRelativeTarget(1));
+                    return;
+                case 0xF4: SetInstruction("hlt"); return;
+                case 0xF5: SetInstruction("cmc"); return;
+                case 0xF6:
+                case 0xF7:
+                {
+                    ReadModRM();
+                    var size = opcode == 0xF6 ? 1 : operandSize;
+                    switch (this._reg & 7)
+                    {
+                        case 0:
+                        case 1:
+                            SetInstruction("test", RmOperand(size), size == 1 ? ReadImmediate(1, 1) : ReadImmediateZ(size));
+                            break;
+                        case 2: SetInstruction("not", RmOperand(size)); break;
+                        case 3: SetInstruction("neg", RmOperand(size)); break;
+                        case 4: SetInstruction("mul", RmOperand(size)); break;
+                        case 5: SetInstruction("imul", RmOperand(size)); break;
+                        case 6: SetInstruction("div", RmOperand(size)); break;
+                        case 7: SetInstruction("idiv", RmOperand(size)); break;
+                    }
+                    return;
+                }
+                case 0xF8: SetInstruction("clc"); return;
+                case 0xF9: SetInstruction("stc"); return;
+                case 0xFA: SetInstruction("cli"); return;
+                case 0xFB: SetInstruction("sti"); return;
+                case 0xFC: SetInstruction("cld"); return;
+                case 0xFD: SetInstruction("std"); return;
+                case 0xFE:
+                    ReadModRM();
+                    switch (this._reg & 7)
+                    {
+                        case 0: SetInstruction("inc", RmOperand(1)); break;
+                        case 1: SetInstruction("dec", RmOperand(1)); break;
+                    }
+                    return;
+                case 0xFF:
+                    ReadModRM();
+                    switch (this._reg & 7)
+                    {
+                        case 0: SetInstruction("inc", RmOperand(operandSize)); break;
+                        case 1: SetInstruction("dec", RmOperand(operandSize)); break;
+                        case 2:
+                            this._flow = InstructionFlow.Call;
+                            SetInstruction("call", RmOperand(8));
+                            break;
+                        case 4:
+                            this._flow = InstructionFlow.Jump;
+                            SetInstruction("jmp", RmOperand(8));
+                            break;
+                        case 6: SetInstruction("push", RmOperand(this._operandSizeOverride ? 2 : 8)); break;
+                    }
+                    return;
+                case >= 0xD8 and <= 0xDF:
+                    // x87 - not worth decoding since compilers haven't used it for x64 in decades, but its length is easy to get right.
+                    ReadModRM();
+                    return;
+            }
+        }
+
+        private void DecodeStringInstruction(byte opcode, int operandSize)
+        {
+            var size = (opcode & 1) == 0 ? 1 : operandSize;
+            var pointerSize = GetPointerSize(size);
+            var destination = pointerSize + (this._addressSizeOverride ? "[edi]" : "[rdi]");
+            var source = pointerSize + (this._addressSizeOverride ? "[esi]" : "[rsi]");
+            var isCompare = opcode is 0xA6 or 0xA7 or 0xAE or 0xAF;
+            var repPrefix = this._rep ? (isCompare ? "repe " : "rep ") : (this._repne ? "repne " : String.Empty);
+
+            switch (opcode)
+            {
+                case 0xA4:
+                case 0xA5: SetInstruction(repPrefix + "movs", destination, source); break;
+                case 0xA6:
+                case 0xA7: SetInstruction(repPrefix + "cmps", source, destination); break;
+                case 0xAA:
+                case 0xAB: SetInstruction(repPrefix + "stos", destination); break;
+                case 0xAC:
+                case 0xAD: SetInstruction(repPrefix + "lods", source); break;
+                case 0xAE:
+                case 0xAF: SetInstruction(repPrefix + "scas", destination); break;
+            }
+        }
+
+        #endregion
+
+        #region Two-byte (0F) opcodes
+
+        private static string ScalarOrPackedSuffix(int mandatoryPrefix) => mandatoryPrefix switch
+        {
+            0x66 => "pd",
+            0xF3 => "ss",
+            0xF2 => "sd",
+            _ => "ps",
+        };
+
+        private static int ScalarOrPackedSize(int mandatoryPrefix) => mandatoryPrefix switch
+        {
+            0xF3 => 4,
+            0xF2 => 8,
+            _ => 16,
+        };
+
+        private void DecodeTwoByte(byte opcode)
+        {
+            if (this._failed)
+            {
+                return;
+            }
+
+            var operandSize = this.OperandSize;
+            var prefix = this.MandatoryPrefix;
+
+            switch (opcode)
+            {
+                case 0x01:
+                    ReadModRM();
+                    if (this._mod == 3 && (this._reg & 7) == 2 && (this._rm & 7) == 0)
+                    {
+                        SetInstruction("xgetbv");
+                    }
+                    else if (this._mod == 3 && (this._reg & 7) == 7 && (this._rm & 7) == 1)
+                    {
+                        SetInstruction("rdtscp");
+                    }
+                    return;
+                case 0x05: SetInstruction("syscall"); return;
+                case 0x0B: SetInstruction("ud2"); return;
+                case 0x0D:
+                    ReadModRM();
+                    SetInstruction((this._reg & 7) == 1 ? "prefetchw" : "prefetch", RmAddress());
+                    return;
+                case 0x18:
+                {
+                    ReadModRM();
+                    var hint = this._reg & 7;
+                    if (hint < 4)
+                    {
+                        SetInstruction(hint == 0 ? "prefetchnta" : "prefetcht" + (hint - 1).ToString(CultureInfo.InvariantCulture), GetPointerSize(1) + RmAddress());
+                    }
+                    else
+                    {
+                        SetInstruction("nop", RmOperand(operandSize));
+                    }
+                    return;
+                }
+                case >= 0x19 and <= 0x1F:
+                    ReadModRM();
+                    SetInstruction("nop", RmOperand(operandSize));
+                    return;
+                case 0x31: SetInstruction("rdtsc"); return;
+                case 0x38: DecodeThreeByte38(ReadByte()); return;
+                case 0x3A: DecodeThreeByte3A(ReadByte()); return;
+                case >= 0x40 and <= 0x4F:
+                    ReadModRM();
+                    SetInstruction("cmov" + ConditionCodes[opcode & 0xF], RegOperand(operandSize), RmOperand(operandSize));
+                    return;
+                case >= 0x80 and <= 0x8F:
+                    this._flow = InstructionFlow.ConditionalJump;
+                    SetInstruction("j" + ConditionCodes[opcode & 0xF], ReadRelativeTarget(4));
+                    return;
+                case >= 0x90 and <= 0x9F:
+                    ReadModRM();
+                    SetInstruction("set" + ConditionCodes[opcode & 0xF], RmOperand(1));
+                    return;
+                case 0xA2: SetInstruction("cpuid"); return;
+                case 0xA3:
+                case 0xAB:
+                case 0xB3:
+                case 0xBB:
+                {
+                    ReadModRM();
+                    var mnemonic = opcode switch { 0xA3 => "bt", 0xAB => "bts", 0xB3 => "btr", _ => "btc" };
+                    SetInstruction(mnemonic, RmOperand(operandSize), RegOperand(operandSize));
+                    return;
+                }
+                case 0xA4:
+                case 0xAC:
+                    ReadModRM();
+                    SetInstruction(opcode == 0xA4 ? "shld" : "shrd", RmOperand(operandSize), RegOperand(operandSize), ReadUnsignedImmediate(1));
+                    return;
+                case 0xA5:
+                case 0xAD:
+                    ReadModRM();
+                    SetInstruction(opcode == 0xA5 ? "shld" : "shrd", RmOperand(operandSize), RegOperand(operandSize), "cl");
+                    return;
+                case 0xAE:
+                    ReadModRM();
+                    if (!this.IsMemory)
+                    {
+                        switch (this._reg & 7)
+                        {
+                            case 5: SetInstruction("lfence"); break;
+                            case 6: SetInstruction("mfence"); break;
+                            case 7: SetInstruction("sfence"); break;
+                        }
+                    }
+                    else
+                    {
+                        switch (this._reg & 7)
+                        {
+                            case 0: SetInstruction("fxsave", RmAddress()); break;
+                            case 1: SetInstruction("fxrstor", RmAddress()); break;
+                            case 2: SetInstruction("ldmxcsr", RmOperand(4)); break;
+                            case 3: SetInstruction("stmxcsr", RmOperand(4)); break;
+                            case 7: SetInstruction("clflush", GetPointerSize(1) + RmAddress()); break;
+                        }
+                    }
+                    return;
+                case 0xAF:
+                    ReadModRM();
+                    SetInstruction("imul", RegOperand(operandSize), RmOperand(operandSize));
+                    return;
+                case 0xB0:
+                case 0xB1:
+                {
+                    ReadModRM();
+                    var size = opcode == 0xB0 ? 1 : operandSize;
+                    SetInstruction("cmpxchg", RmOperand(size), RegOperand(size));
+                    return;
+                }
+                case 0xB6:
+                case 0xB7:
+                case 0xBE:
+                case 0xBF:
+                    ReadModRM();
+                    SetInstruction(opcode < 0xBE ? "movzx" : "movsx", RegOperand(operandSize), RmOperand((opcode & 1) == 0 ? 1 : 2));
+                    return;
+                case 0xB8:
+                    ReadModRM();
+                    if (prefix == 0xF3)
+                    {
+                        SetInstruction("popcnt", RegOperand(operandSize), RmOperand(operandSize));
+                    }
+                    return;
+                case 0xBA:
+                {
+                    ReadModRM();
+                    var mnemonic = (this._reg & 7) switch { 4 => "bt", 5 => "bts", 6 => "btr", 7 => "btc", _ => null };
+                    var immediate = ReadUnsignedImmediate(1);
+                    if (mnemonic != null)
+                    {
+                        SetInstruction(mnemonic, RmOperand(operandSize), immediate);
+                    }
+                    return;
+                }
+                case 0xBC:
+                case 0xBD:
+                {
+                    ReadModRM();
+                    var mnemonic = prefix == 0xF3 ? (opcode == 0xBC ? "tzcnt" : "lzcnt") : (opcode == 0xBC ? "bsf" : "bsr");
+                    SetInstruction(mnemonic, RegOperand(operandSize), RmOperand(operandSize));
+                    return;
+                }
+                case 0xC0:
+                case 0xC1:
+                {
+                    ReadModRM();
+                    var size = opcode == 0xC0 ? 1 : operandSize;
+                    SetInstruction("xadd", RmOperand(size), RegOperand(size));
+                    return;
+                }
+                case 0xC3:
+                    ReadModRM();
+                    SetInstruction("movnti", RmOperand(this.RexW ? 8 : 4), RegOperand(this.RexW ? 8 : 4));
+                    return;
+                case 0xC7:
+                    ReadModRM();
+                    if ((this._reg & 7) == 1 && this.IsMemory)
+                    {
+                        // The debugger calls a 16-byte memory operand an "oword" here, unlike for SSE where it's an "xmmword".
+                        SetInstruction(this.RexW ? "cmpxchg16b" : "cmpxchg8b", (this.RexW ? "oword ptr " : "qword ptr ") + this._memory);
+                    }
+                    return;
+                case >= 0xC8 and <= 0xCF:
+                    SetInstruction("bswap", Gpr((opcode & 7) | this.RexB, operandSize));
+                    return;
+                case >= 0x10 and <= 0x17:
+                    DecodeSseMove(opcode);
+                    return;
+                case (>= 0x28 and <= 0x2F) or (>= 0x50 and <= 0x5F) or 0xC2 or 0xC6 or 0xE6:
+                    DecodeSseFloatingPoint(opcode);
+                    return;
+                default:
+                    DecodeSimdInteger(opcode);
+                    return;
+            }
+        }
+
+        // 0F 10 through 0F 17 - the SSE moves between registers and memory.
+        private void DecodeSseMove(byte opcode)
+        {
+            var operandSize = this.OperandSize;
+            var prefix = this.MandatoryPrefix;
+
+            switch (opcode)
+            {
+                case 0x10:
+                case 0x11:
+                {
+                    ReadModRM();
+                    var mnemonic = prefix switch
+                    {
+                        0x66 => "movupd",
+                        0xF3 => "movss",
+                        0xF2 => "movsd",
+                        _ => "movups",
+                    };
+                    var size = ScalarOrPackedSize(prefix);
+                    if (opcode == 0x10)
+                    {
+                        SetInstruction(mnemonic, XmmReg(), XmmRm(size));
+                    }
+                    else
+                    {
+                        SetInstruction(mnemonic, XmmRm(size), XmmReg());
+                    }
+                    return;
+                }
+                case 0x12:
+                case 0x13:
+                case 0x16:
+                case 0x17:
+                {
+                    ReadModRM();
+                    var high = opcode >= 0x16;
+                    string mnemonic;
+                    if (prefix == 0xF2 && opcode == 0x12)
+                    {
+                        SetInstruction("movddup", XmmReg(), XmmRm(8));
+                        return;
+                    }
+                    else if (prefix == 0xF3 && opcode is 0x12 or 0x16)
+                    {
+                        SetInstruction(opcode == 0x12 ? "movsldup" : "movshdup", XmmReg(), XmmRm(16));
+                        return;
+                    }
+                    else if (!this.IsMemory && prefix == 0 && opcode is 0x12 or 0x16)
+                    {
+                        mnemonic = high ? "movlhps" : "movhlps";
+                    }
+                    else
+                    {
+                        mnemonic = (high ? "movh" : "movl") + (prefix == 0x66 ? "pd" : "ps");
+                    }
+
+                    if ((opcode & 1) == 0)
+                    {
+                        SetInstruction(mnemonic, XmmReg(), XmmRm(8));
+                    }
+                    else
+                    {
+                        SetInstruction(mnemonic, XmmRm(8), XmmReg());
+                    }
+                    return;
+                }
+                case 0x14:
+                case 0x15:
+                    ReadModRM();
+                    SetInstruction((opcode == 0x14 ? "unpckl" : "unpckh") + (prefix == 0x66 ? "pd" : "ps"), XmmReg(), XmmRm(16));
+                    return;
+            }
+        }
+
+        // The SSE floating-point arithmetic, comparisons and conversions.
+        private void DecodeSseFloatingPoint(byte opcode)
+        {
+            var operandSize = this.OperandSize;
+            var prefix = this.MandatoryPrefix;
+
+            switch (opcode)
+            {
+                case 0x28:
+                case 0x29:
+                {
+                    ReadModRM();
+                    var mnemonic = prefix == 0x66 ? "movapd" : "movaps";
+                    if (opcode == 0x28)
+                    {
+                        SetInstruction(mnemonic, XmmReg(), XmmRm(16));
+                    }
+                    else
+                    {
+                        SetInstruction(mnemonic, XmmRm(16), XmmReg());
+                    }
+                    return;
+                }
+                case 0x2A:
+                    ReadModRM();
+                    if (prefix is 0xF2 or 0xF3)
+                    {
+                        SetInstruction("cvtsi2" + (prefix == 0xF3 ? "ss" : "sd"), XmmReg(), RmOperand(this.RexW ? 8 : 4));
+                    }
+                    return;
+                case 0x2B:
+                    ReadModRM();
+                    SetInstruction(prefix == 0x66 ? "movntpd" : "movntps", XmmRm(16), XmmReg());
+                    return;
+                case 0x2C:
+                case 0x2D:
+                    ReadModRM();
+                    if (prefix is 0xF2 or 0xF3)
+                    {
+                        var mnemonic = (opcode == 0x2C ? "cvtt" : "cvt") + (prefix == 0xF3 ? "ss2si" : "sd2si");
+                        SetInstruction(mnemonic, RegOperand(this.RexW ? 8 : 4), XmmRm(prefix == 0xF3 ? 4 : 8));
+                    }
+                    return;
+                case 0x2E:
+                case 0x2F:
+                    ReadModRM();
+                    SetInstruction((opcode == 0x2E ? "ucomis" : "comis") + (prefix == 0x66 ? "d" : "s"), XmmReg(), XmmRm(prefix == 0x66 ? 8 : 4));
+                    return;
+                case 0x50:
+                    ReadModRM();
+                    SetInstruction(prefix == 0x66 ? "movmskpd" : "movmskps", RegOperand(4), Xmm(this._rm));
+                    return;
+                case 0x51:
+                case 0x58:
+                case 0x59:
+                case 0x5C:
+                case 0x5D:
+                case 0x5E:
+                case 0x5F:
+                {
+                    ReadModRM();
+                    var operation = opcode switch
+                    {
+                        0x51 => "sqrt",
+                        0x58 => "add",
+                        0x59 => "mul",
+                        0x5C => "sub",
+                        0x5D => "min",
+                        0x5E => "div",
+                        _ => "max",
+                    };
+                    SetInstruction(operation + ScalarOrPackedSuffix(prefix), XmmReg(), XmmRm(ScalarOrPackedSize(prefix)));
+                    return;
+                }
+                case >= 0x54 and <= 0x57:
+                {
+                    ReadModRM();
+                    var operation = opcode switch
+                    {
+                        0x54 => "and",
+                        0x55 => "andn",
+                        0x56 => "or",
+                        _ => "xor",
+                    };
+                    SetInstruction(operation + (prefix == 0x66 ? "pd" : "ps"), XmmReg(), XmmRm(16));
+                    return;
+                }
+                case 0x5A:
+                {
+                    ReadModRM();
+                    var (mnemonic, size) = prefix switch
+                    {
+                        0x66 => ("cvtpd2ps", 16),
+                        0xF3 => ("cvtss2sd", 4),
+                        0xF2 => ("cvtsd2ss", 8),
+                        _ => ("cvtps2pd", 8),
+                    };
+                    SetInstruction(mnemonic, XmmReg(), XmmRm(size));
+                    return;
+                }
+                case 0x5B:
+                    ReadModRM();
+                    SetInstruction(prefix switch { 0x66 => "cvtps2dq", 0xF3 => "cvttps2dq", _ => "cvtdq2ps" }, XmmReg(), XmmRm(16));
+                    return;
+                case 0xC2:
+                    ReadModRM();
+                    SetInstruction("cmp" + ScalarOrPackedSuffix(prefix), XmmReg(), XmmRm(ScalarOrPackedSize(prefix)), ReadUnsignedImmediate(1));
+                    return;
+                case 0xC6:
+                    ReadModRM();
+                    SetInstruction(prefix == 0x66 ? "shufpd" : "shufps", XmmReg(), XmmRm(16), ReadUnsignedImmediate(1));
+                    return;
+                case 0xE6:
+                    ReadModRM();
+                    if (prefix != 0)
+                    {
+                        SetInstruction(prefix switch { 0x66 => "cvttpd2dq", 0xF3 => "cvtdq2pd", _ => "cvtpd2dq" }, XmmReg(), XmmRm(prefix == 0xF3 ? 8 : 16));
+                    }
+                    return;
+            }
+        }
+
+        // The SSE2 integer instructions, and anything else left over in the two-byte opcode map.
+        private void DecodeSimdInteger(byte opcode)
+        {
+            var operandSize = this.OperandSize;
+            var prefix = this.MandatoryPrefix;
+
+            switch (opcode)
+            {
+                case 0x6E:
+                    ReadModRM();
+                    SetInstruction(this.RexW ? "movq" : "movd", prefix == 0x66 ? XmmReg() : MmReg(), RmOperand(this.RexW ? 8 : 4));
+                    return;
+                case 0x6F:
+                case 0x7F:
+                {
+                    ReadModRM();
+                    if (prefix is 0x66 or 0xF3)
+                    {
+                        var mnemonic = prefix == 0x66 ? "movdqa" : "movdqu";
+                        if (opcode == 0x6F)
+                        {
+                            SetInstruction(mnemonic, XmmReg(), XmmRm(16));
+                        }
+                        else
+                        {
+                            SetInstruction(mnemonic, XmmRm(16), XmmReg());
+                        }
+                    }
+                    else if (opcode == 0x6F)
+                    {
+                        SetInstruction("movq", MmReg(), MmRm());
+                    }
+                    else
+                    {
+                        SetInstruction("movq", MmRm(), MmReg());
+                    }
+                    return;
+                }
+                case 0x70:
+                {
+                    ReadModRM();
+                    if (prefix == 0)
+                    {
+                        SetInstruction("pshufw", MmReg(), MmRm(), ReadUnsignedImmediate(1));
+                        return;
+                    }
+
+                    var mnemonic = prefix switch { 0x66 => "pshufd", 0xF3 => "pshufhw", _ => "pshuflw" };
+                    SetInstruction(mnemonic, XmmReg(), XmmRm(16), ReadUnsignedImmediate(1));
+                    return;
+                }
+                case 0x71:
+                case 0x72:
+                case 0x73:
+                {
+                    ReadModRM();
+                    var element = opcode switch { 0x71 => "w", 0x72 => "d", _ => "q" };
+                    var mnemonic = (this._reg & 7) switch
+                    {
+                        2 => "psrl" + element,
+                        3 when opcode == 0x73 => "psrldq",
+                        4 when opcode != 0x73 => "psra" + element,
+                        6 => "psll" + element,
+                        7 when opcode == 0x73 => "pslldq",
+                        _ => null,
+                    };
+                    var immediate = ReadUnsignedImmediate(1);
+                    if (mnemonic != null)
+                    {
+                        SetInstruction(mnemonic, prefix == 0x66 ? Xmm(this._rm) : "mm" + (this._rm & 7).ToString(CultureInfo.InvariantCulture), immediate);
+                    }
+                    return;
+                }
+                case 0x77: SetInstruction("emms"); return;
+                case 0x7E:
+                    ReadModRM();
+                    if (prefix == 0xF3)
+                    {
+                        SetInstruction("movq", XmmReg(), XmmRm(8));
+                    }
+                    else
+                    {
+                        SetInstruction(this.RexW ? "movq" : "movd", RmOperand(this.RexW ? 8 : 4), prefix == 0x66 ? XmmReg() : MmReg());
+                    }
+                    return;
+                case 0xC4:
+                    ReadModRM();
+                    SetInstruction("pinsrw", prefix == 0x66 ? XmmReg() : MmReg(), this.IsMemory ? RmOperand(2) : Gpr(this._rm, 4), ReadUnsignedImmediate(1));
+                    return;
+                case 0xC5:
+                    ReadModRM();
+                    SetInstruction("pextrw", RegOperand(4), prefix == 0x66 ? Xmm(this._rm) : "mm" + (this._rm & 7).ToString(CultureInfo.InvariantCulture), ReadUnsignedImmediate(1));
+                    return;
+                case 0xD6:
+                    ReadModRM();
+                    if (prefix == 0x66)
+                    {
+                        SetInstruction("movq", XmmRm(8), XmmReg());
+                    }
+                    return;
+                case 0xD7:
+                    ReadModRM();
+                    SetInstruction("pmovmskb", RegOperand(4), prefix == 0x66 ? Xmm(this._rm) : "mm" + (this._rm & 7).ToString(CultureInfo.InvariantCulture));
+                    return;
+                case 0xE7:
+                    ReadModRM();
+                    if (prefix == 0x66)
+                    {
+                        SetInstruction("movntdq", XmmRm(16), XmmReg());
+                    }
+                    else
+                    {
+                        SetInstruction("movntq", MmRm(), MmReg());
+                    }
+                    return;
+            }
+
+            if (PackedIntegerInstructions.TryGetValue(opcode, out var packedMnemonic))
+            {
+                ReadModRM();
+                if (prefix == 0x66)
+                {
+                    SetInstruction(packedMnemonic, XmmReg(), XmmRm(16));
+                }
+                else
+                {
+                    SetInstruction(packedMnemonic, MmReg(), MmRm());
+                }
+                return;
+            }
+
+            // Nearly every other two-byte opcode has a ModR/M byte, so consuming one keeps the stream in sync more often than not.
+            ReadModRM();
+        }
+
+        private void DecodeThreeByte38(byte opcode)
+        {
+            if (this._failed)
+            {
+                return;
+            }
+
+            ReadModRM();
+            var prefix = this.MandatoryPrefix;
+
+            if (prefix == 0xF2 && opcode is 0xF0 or 0xF1)
+            {
+                SetInstruction("crc32", RegOperand(this.RexW ? 8 : 4), RmOperand(opcode == 0xF0 ? 1 : this.OperandSize));
+            }
+            else if (prefix != 0xF2 && opcode is 0xF0 or 0xF1)
+            {
+                if (opcode == 0xF0)
+                {
+                    SetInstruction("movbe", RegOperand(this.OperandSize), RmOperand(this.OperandSize));
+                }
+                else
+                {
+                    SetInstruction("movbe", RmOperand(this.OperandSize), RegOperand(this.OperandSize));
+                }
+            }
+            else if (prefix == 0x66 && ThreeByte38Instructions.TryGetValue(opcode, out var mnemonic))
+            {
+                SetInstruction(mnemonic, XmmReg(), XmmRm(16));
+            }
+        }
+
+        private void DecodeThreeByte3A(byte opcode)
+        {
+            if (this._failed)
+            {
+                return;
+            }
+
+            ReadModRM();
+            var immediate = ReadUnsignedImmediate(1);
+            if (this.MandatoryPrefix != 0x66)
+            {
+                return;
+            }
+
+            switch (opcode)
+            {
+                case 0x14: SetInstruction("pextrb", this.IsMemory ? RmOperand(1) : Gpr(this._rm, 4), XmmReg(), immediate); return;
+                case 0x16: SetInstruction(this.RexW ? "pextrq" : "pextrd", RmOperand(this.RexW ? 8 : 4), XmmReg(), immediate); return;
+                case 0x17: SetInstruction("extractps", RmOperand(4), XmmReg(), immediate); return;
+                case 0x20: SetInstruction("pinsrb", XmmReg(), this.IsMemory ? RmOperand(1) : Gpr(this._rm, 4), immediate); return;
+                case 0x22: SetInstruction(this.RexW ? "pinsrq" : "pinsrd", XmmReg(), RmOperand(this.RexW ? 8 : 4), immediate); return;
+            }
+
+            if (ThreeByte3AInstructions.TryGetValue(opcode, out var mnemonic))
+            {
+                SetInstruction(mnemonic, XmmReg(), XmmRm(16), immediate);
+            }
+        }
+
+        #endregion
+
+        #region VEX
+
+        // The VEX forms of the SSE instructions above, which name the extra source register in VEX.vvvv - "vaddps xmm0,xmm1,xmm2".  Only the
+        // common ones compilers emit for /arch:AVX and /arch:AVX2 are decoded, but the length of every VEX instruction is found so that the
+        // instructions after it decode correctly.
+        private void DecodeVex(byte opcode)
+        {
+            if (this._vexMap is < 1 or > 3)
+            {
+                this._failed = true;
+                return;
+            }
+
+            var prefix = this.MandatoryPrefix;
+            var source1 = Xmm(this._vexRegister);
+
+            if (this._vexMap == 1 && opcode == 0x77)
+            {
+                SetInstruction(this._vexLength256 ? "vzeroall" : "vzeroupper");
+                return;
+            }
+
+            ReadModRM();
+
+            if (this._vexMap == 3)
+            {
+                var immediate = ReadUnsignedImmediate(1);
+                if (prefix == 0x66 && ThreeByte3AInstructions.TryGetValue(opcode, out var mnemonic3A))
+                {
+                    SetInstruction("v" + mnemonic3A, XmmReg(), source1, XmmRm(16), immediate);
+                }
+                return;
+            }
+
+            if (this._vexMap == 2)
+            {
+                if (prefix == 0x66 && ThreeByte38Instructions.TryGetValue(opcode, out var mnemonic38))
+                {
+                    SetInstruction("v" + mnemonic38, XmmReg(), source1, XmmRm(16));
+                }
+                return;
+            }
+
+            switch (opcode)
+            {
+                case 0x10:
+                case 0x11:
+                {
+                    var mnemonic = prefix switch { 0x66 => "vmovupd", 0xF3 => "vmovss", 0xF2 => "vmovsd", _ => "vmovups" };
+                    var size = ScalarOrPackedSize(prefix);
+                    var isScalarRegisterMove = prefix is 0xF2 or 0xF3 && !this.IsMemory;
+                    if (opcode == 0x10)
+                    {
+                        if (isScalarRegisterMove)
+                        {
+                            SetInstruction(mnemonic, XmmReg(), source1, Xmm(this._rm));
+                        }
+                        else
+                        {
+                            SetInstruction(mnemonic, XmmReg(), XmmRm(size));
+                        }
+                    }
+                    else if (isScalarRegisterMove)
+                    {
+                        SetInstruction(mnemonic, Xmm(this._rm), source1, XmmReg());
+                    }
+                    else
+                    {
+                        SetInstruction(mnemonic, XmmRm(size), XmmReg());
+                    }
+                    return;
+                }
+                case 0x28:
+                    SetInstruction(prefix == 0x66 ? "vmovapd" : "vmovaps", XmmReg(), XmmRm(16));
+                    return;
+                case 0x29:
+                    SetInstruction(prefix == 0x66 ? "vmovapd" : "vmovaps", XmmRm(16), XmmReg());
+                    return;
+                case 0x2A:
+                    if (prefix is 0xF2 or 0xF3)
+                    {
+                        SetInstruction("vcvtsi2" + (prefix == 0xF3 ? "ss" : "sd"), XmmReg(), source1, RmOperand(this.RexW ? 8 : 4));
+                    }
+                    return;
+                case 0x2C:
+                case 0x2D:
+                    if (prefix is 0xF2 or 0xF3)
+                    {
+                        SetInstruction((opcode == 0x2C ? "vcvtt" : "vcvt") + (prefix == 0xF3 ? "ss2si" : "sd2si"), RegOperand(this.RexW ? 8 : 4), XmmRm(prefix == 0xF3 ? 4 : 8));
+                    }
+                    return;
+                case 0x2E:
+                case 0x2F:
+                    SetInstruction((opcode == 0x2E ? "vucomis" : "vcomis") + (prefix == 0x66 ? "d" : "s"), XmmReg(), XmmRm(prefix == 0x66 ? 8 : 4));
+                    return;
+                case 0x51:
+                case 0x58:
+                case 0x59:
+                case 0x5C:
+                case 0x5D:
+                case 0x5E:
+                case 0x5F:
+                {
+                    var operation = opcode switch { 0x51 => "vsqrt", 0x58 => "vadd", 0x59 => "vmul", 0x5C => "vsub", 0x5D => "vmin", 0x5E => "vdiv", _ => "vmax" };
+                    var isPackedSquareRoot = opcode == 0x51 && prefix is 0 or 0x66;
+                    if (isPackedSquareRoot)
+                    {
+                        SetInstruction(operation + ScalarOrPackedSuffix(prefix), XmmReg(), XmmRm(16));
+                    }
+                    else
+                    {
+                        SetInstruction(operation + ScalarOrPackedSuffix(prefix), XmmReg(), source1, XmmRm(ScalarOrPackedSize(prefix)));
+                    }
+                    return;
+                }
+                case >= 0x54 and <= 0x57:
+                {
+                    var operation = opcode switch { 0x54 => "vand", 0x55 => "vandn", 0x56 => "vor", _ => "vxor" };
+                    SetInstruction(operation + (prefix == 0x66 ? "pd" : "ps"), XmmReg(), source1, XmmRm(16));
+                    return;
+                }
+                case 0x5A:
+                    if (prefix is 0xF2 or 0xF3)
+                    {
+                        SetInstruction(prefix == 0xF3 ? "vcvtss2sd" : "vcvtsd2ss", XmmReg(), source1, XmmRm(prefix == 0xF3 ? 4 : 8));
+                    }
+                    return;
+                case 0x6E:
+                    if (prefix == 0x66)
+                    {
+                        SetInstruction(this.RexW ? "vmovq" : "vmovd", XmmReg(), RmOperand(this.RexW ? 8 : 4));
+                    }
+                    return;
+                case 0x7E:
+                    if (prefix == 0x66)
+                    {
+                        SetInstruction(this.RexW ? "vmovq" : "vmovd", RmOperand(this.RexW ? 8 : 4), XmmReg());
+                    }
+                    else if (prefix == 0xF3)
+                    {
+                        SetInstruction("vmovq", XmmReg(), XmmRm(8));
+                    }
+                    return;
+                case 0x6F:
+                case 0x7F:
+                    if (prefix is 0x66 or 0xF3)
+                    {
+                        var mnemonic = prefix == 0x66 ? "vmovdqa" : "vmovdqu";
+                        if (opcode == 0x6F)
+                        {
+                            SetInstruction(mnemonic, XmmReg(), XmmRm(16));
+                        }
+                        else
+                        {
+                            SetInstruction(mnemonic, XmmRm(16), XmmReg());
+                        }
+                    }
+                    return;
+                case >= 0x70 and <= 0x73:
+                case 0xC2:
+                case 0xC4:
+                case 0xC5:
+                case 0xC6:
+                {
+                    var immediate = ReadUnsignedImmediate(1);
+                    if (opcode == 0x70 && prefix == 0x66)
+                    {
+                        SetInstruction("vpshufd", XmmReg(), XmmRm(16), immediate);
+                    }
+                    else if (opcode == 0xC6)
+                    {
+                        SetInstruction(prefix == 0x66 ? "vshufpd" : "vshufps", XmmReg(), source1, XmmRm(16), immediate);
+                    }
+                    return;
+                }
+                case 0xD6:
+                    if (prefix == 0x66)
+                    {
+                        SetInstruction("vmovq", XmmRm(8), XmmReg());
+                    }
+                    return;
+                case 0xD7:
+                    if (prefix == 0x66)
+                    {
+                        SetInstruction("vpmovmskb", RegOperand(4), Xmm(this._rm));
+                    }
+                    return;
+                case 0xE7:
+                    if (prefix == 0x66)
+                    {
+                        SetInstruction("vmovntdq", XmmRm(16), XmmReg());
+                    }
+                    return;
+            }
+
+            if (prefix == 0x66 && PackedIntegerInstructions.TryGetValue(opcode, out var packedMnemonic))
+            {
+                SetInstruction("v" + packedMnemonic, XmmReg(), source1, XmmRm(16));
+            }
+        }
+
+        #endregion
+    }
+}
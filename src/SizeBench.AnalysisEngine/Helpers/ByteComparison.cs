@@ -0,0 +1,54 @@
+﻿using System.Numerics;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+using System.Runtime.Intrinsics;
+
+namespace SizeBench.AnalysisEngine.Helpers;
+
+internal static class ByteComparison
+{
+    /// <summary>
+    /// Returns how many positions hold the same byte in both spans, comparing only up to the length of the shorter span.
+    /// </summary>
+    /// <remarks>
+    /// This is used to measure how similar two functions or pieces of data are, which can mean comparing a lot of bytes when looking at every
+    /// template instantiation in a large binary.  So it compares 32 or 16 bytes at a time when the hardware allows, turning each comparison
+    /// into a bitmask and counting its set bits.
+    /// </remarks>
+    public static int CountEqualBytes(ReadOnlySpan<byte> first, ReadOnlySpan<byte> second)
+    {
+        var length = Math.Min(first.Length, second.Length);
+        ref var firstStart = ref MemoryMarshal.GetReference(first);
+        ref var secondStart = ref MemoryMarshal.GetReference(second);
+        var equalCount = 0;
+        var i = 0;
+
+        if (Vector256.IsHardwareAccelerated)
+        {
+            for (; i <= length - Vector256<byte>.Count; i += Vector256<byte>.Count)
+            {
+                var equal = Vector256.Equals(Vector256.LoadUnsafe(ref firstStart, (nuint)i), Vector256.LoadUnsafe(ref secondStart, (nuint)i));
+                equalCount += BitOperations.PopCount(equal.ExtractMostSignificantBits());
+            }
+        }
+
+        if (Vector128.IsHardwareAccelerated)
+        {
+            for (; i <= length - Vector128<byte>.Count; i += Vector128<byte>.Count)
+            {
+                var equal = Vector128.Equals(Vector128.LoadUnsafe(ref firstStart, (nuint)i), Vector128.LoadUnsafe(ref secondStart, (nuint)i));
+                equalCount += BitOperations.PopCount(equal.ExtractMostSignificantBits());
+            }
+        }
+
+        for (; i < length; i++)
+        {
+            if (Unsafe.Add(ref firstStart, i) == Unsafe.Add(ref secondStart, i))
+            {
+                equalCount++;
+            }
+        }
+
+        return equalCount;
+    }
+}
@@ -0,0 +1,141 @@
+﻿namespace SizeBench.AnalysisEngine.Helpers;
+
+// MinHash signatures of the bytes of a function, for finding functions that are nearly the same without comparing every pair of them.
+//
+// A function's bytes are broken into overlapping shingles of ShingleLength bytes each, hashed with a rolling hash so each shingle costs the
+// same no matter how long it is.  The signature keeps, for each of SignatureLength different hash functions, the smallest hash of any shingle -
+// and the fraction of positions where two signatures agree is an estimate of the Jaccard similarity of the two functions' sets of shingles.
+//
+// For locality-sensitive hashing the signature is cut into BandCount bands of RowsPerBand values each.  Two functions that agree on every value
+// in any one band are candidates to be compared.  With 16 bands of 4 rows, functions that are 80% similar become candidates more than 99.9% of
+// the time, while functions that are 30% similar only do about 12% of the time (and are then rejected once their signatures are compared).
+internal static class CodeBytesMinHash
+{
+    public const int ShingleLength = 8;
+    public const int SignatureLength = 64;
+    public const int RowsPerBand = 4;
+    public const int BandCount = SignatureLength / RowsPerBand;
+
+    // The FNV-1a 64-bit prime works well as the base of a polynomial rolling hash over bytes.
+    private const ulong RollingHashBase = 0x100000001B3;
+    private static readonly ulong RollingHashBaseToTheShingleLengthMinusOne = PowerOf(RollingHashBase, ShingleLength - 1);
+
+    // Fixed seeds (rather than random ones) so a function always gets the same signature, run after run.
+    private static readonly ulong[] Seeds = CreateSeeds();
+
+    public static ulong[] CreateEmptySignature()
+    {
+        var signature = new ulong[SignatureLength];
+        Array.Fill(signature, UInt64.MaxValue);
+        return signature;
+    }
+
+    /// <summary>
+    /// Adds every shingle in <paramref name="bytes"/> to <paramref name="signature"/>.  This can be called once per block of a function with
+    /// the same signature, to get one signature for the whole function.
+    /// </summary>
+    public static void AddBytes(ReadOnlySpan<byte> bytes, ulong[] signature)
+    {
+        if (bytes.IsEmpty)
+        {
+            return;
+        }
+
+        // Anything shorter than one shingle is its own (only) shingle.
+        if (bytes.Length < ShingleLength)
+        {
+            var shortHash = 0ul;
+            foreach (var b in bytes)
+            {
+                shortHash = (shortHash * RollingHashBase) + b;
+            }
+
+            AddShingle(shortHash, signature);
+            return;
+        }
+
+        var hash = 0ul;
+        for (var i = 0; i < ShingleLength; i++)
+        {
+            hash = (hash * RollingHashBase) + bytes[i];
+        }
+        AddShingle(hash, signature);
+
+        for (var i = ShingleLength; i < bytes.Length; i++)
+        {
+            hash = ((hash - (bytes[i - ShingleLength] * RollingHashBaseToTheShingleLengthMinusOne)) * RollingHashBase) + bytes[i];
+            AddShingle(hash, signature);
+        }
+    }
+
+    /// <returns>The fraction of the signatures that agree, from 0.0 (nothing in common) to 1.0 (very likely identical).</returns>
+    public static float EstimateSimilarity(IReadOnlyList<ulong> first, IReadOnlyList<ulong> second)
+    {
+        var agree = 0;
+        for (var i = 0; i < SignatureLength; i++)
+        {
+            if (first[i] == second[i])
+            {
+                agree++;
+            }
+        }
+
+        return agree / (float)SignatureLength;
+    }
+
+    public static ulong BandKey(IReadOnlyList<ulong> signature, int band)
+    {
+        var key = (ulong)band;
+        for (var i = band * RowsPerBand; i < (band + 1) * RowsPerBand; i++)
+        {
+            key = Mix(key ^ signature[i]);
+        }
+
+        return key;
+    }
+
+    private static void AddShingle(ulong shingleHash, ulong[] signature)
+    {
+        for (var i = 0; i < SignatureLength; i++)
+        {
+            var hash = Mix(shingleHash ^ Seeds[i]);
+            if (hash < signature[i])
+            {
+                signature[i] = hash;
+            }
+        }
+    }
+
+    // The finalizer from SplitMix64 - cheap, and every bit of the input affects every bit of the output, which is what makes each seed act as
+    // an independent hash function.
+    private static ulong Mix(ulong value)
+    {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+        return value ^ (value >> 31);
+    }
+
+    private static ulong[] CreateSeeds()
+    {
+        var seeds = new ulong[SignatureLength];
+        var state = 0x5A17EB0E5EEDul;
+        for (var i = 0; i < seeds.Length; i++)
+        {
+            state += 0x9E3779B97F4A7C15;
+            seeds[i] = Mix(state);
+        }
+
+        return seeds;
+    }
+
+    private static ulong PowerOf(ulong value, int exponent)
+    {
+        var result = 1ul;
+        for (var i = 0; i < exponent; i++)
+        {
+            result *= value;
+        }
+
+        return result;
+    }
+}
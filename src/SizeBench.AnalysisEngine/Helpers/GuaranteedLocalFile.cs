@@ -24,7 +24,7 @@ internal sealed partial class GuaranteedLocalFile : IDisposable
         this.OriginalPath = originalPath;
 
         //TODO: SKUCrawler: this copying locally is a big perf hit - consider having an option on the Session to disable this, which SKUCrawler can turn on, but the GUI can leave off.
-        //                  SKUCrawler must of course leave it on for "forceLocalCopy" which is used by the 'strip force integrity bit' code.
+        //                  Binaries are memory-mapped in place now, so this only applies to PDBs.
         if (!forceLocalCopy && IsLocalPath(originalPath))
         {
             this._guaranteedLocalPath = this.OriginalPath;
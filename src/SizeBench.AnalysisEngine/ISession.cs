@@ -67,6 +67,57 @@ public interface ISession : ISessionWithProgress
 
     #endregion
 
+    #region Stream symbols in Compiland, COFF Group, Lib, Contribution, Binary Section, Source File
+
+    // These find the same symbols, in the same order, as the EnumerateSymbolsIn* methods above - but instead of building up the whole list
+    // before returning, they hand back symbols as they're found, and only find more as the caller asks for them.  For very large binaries
+    // this lets a caller process (or write out) symbols without ever holding all of them in a list at once.
+    //
+    // The DIA thread is not held while the caller is working on what it's been given, so it's fine to call other methods on the session
+    // while streaming.
+
+    IAsyncEnumerable<ISymbol> StreamSymbolsInCompiland(Compiland compiland,
+                                                       CancellationToken token);
+    IAsyncEnumerable<ISymbol> StreamSymbolsInCompiland(Compiland compiland,
+                                                       SymbolEnumerationOptions options,
+                                                       CancellationToken token);
+    IAsyncEnumerable<ISymbol> StreamSymbolsInCompiland(Compiland compiland,
+                                                       SymbolEnumerationOptions options,
+                                                       CancellationToken token,
+                                                       ILogger? parentLogger);
+
+    IAsyncEnumerable<ISymbol> StreamSymbolsInCOFFGroup(COFFGroup coffGroup,
+                                                       CancellationToken token);
+    IAsyncEnumerable<ISymbol> StreamSymbolsInCOFFGroup(COFFGroup coffGroup,
+                                                       CancellationToken token,
+                                                       ILogger? parentLogger);
+
+    IAsyncEnumerable<ISymbol> StreamSymbolsInLib(Library library,
+                                                 CancellationToken token);
+    IAsyncEnumerable<ISymbol> StreamSymbolsInLib(Library library,
+                                                 CancellationToken token,
+                                                 ILogger? parentLogger);
+
+    IAsyncEnumerable<ISymbol> StreamSymbolsInContribution(Contribution contribution,
+                                                          CancellationToken token);
+    IAsyncEnumerable<ISymbol> StreamSymbolsInContribution(Contribution contribution,
+                                                          CancellationToken token,
+                                                          ILogger? parentLogger);
+
+    IAsyncEnumerable<ISymbol> StreamSymbolsInBinarySection(BinarySection section,
+                                                           CancellationToken token);
+    IAsyncEnumerable<ISymbol> StreamSymbolsInBinarySection(BinarySection section,
+                                                           CancellationToken token,
+                                                           ILogger? parentLogger);
+
+    IAsyncEnumerable<ISymbol> StreamSymbolsInSourceFile(SourceFile sourceFile,
+                                                        CancellationToken token);
+    IAsyncEnumerable<ISymbol> StreamSymbolsInSourceFile(SourceFile sourceFile,
+                                                        CancellationToken token,
+                                                        ILogger? parentLogger);
+
+    #endregion
+
     Task<IReadOnlyCollection<Library>> EnumerateLibs(CancellationToken token);
     Task<IReadOnlyCollection<Library>> EnumerateLibs(CancellationToken token, ILogger? parentLogger);
 
@@ -77,6 +128,11 @@ public interface ISession : ISessionWithProgress
     Task<SymbolPlacement> LookupSymbolPlacementInBinary(ISymbol symbol, CancellationToken token);
     Task<SymbolPlacement> LookupSymbolPlacementInBinary(ISymbol symbol, LookupSymbolPlacementOptions options, CancellationToken token);
 
+    // Placing many symbols at once is much faster than looking each one up separately.  The placements come back in the same order as the
+    // symbols were passed in.
+    Task<IReadOnlyList<SymbolPlacement>> LookupSymbolPlacementsInBinary(IEnumerable<ISymbol> symbols, CancellationToken token);
+    Task<IReadOnlyList<SymbolPlacement>> LookupSymbolPlacementsInBinary(IEnumerable<ISymbol> symbols, LookupSymbolPlacementOptions options, CancellationToken token);
+
     Task<ISymbol?> LoadSymbolByRVA(uint rva);
     Task<ISymbol?> LoadSymbolByRVA(uint rva, CancellationToken token, ILogger? parentLogger);
 
@@ -106,6 +162,9 @@ public interface ISession : ISessionWithProgress
     Task<IReadOnlyList<TemplateFoldabilityItem>> EnumerateTemplateFoldabilityItems(CancellationToken token);
     Task<IReadOnlyList<TemplateFoldabilityItem>> EnumerateTemplateFoldabilityItems(CancellationToken token, ILogger? parentLogger);
 
+    Task<IReadOnlyList<NearDuplicateFunctionCluster>> EnumerateNearDuplicateFunctions(CancellationToken token);
+    Task<IReadOnlyList<NearDuplicateFunctionCluster>> EnumerateNearDuplicateFunctions(CancellationToken token, ILogger? parentLogger);
+
     Task<string> DisassembleFunction(IFunctionCodeSymbol functionSymbol, DisassembleFunctionOptions options, CancellationToken token);
 
     Task<IReadOnlyList<AnnotationSymbol>> EnumerateAnnotations(CancellationToken token);
@@ -118,5 +177,9 @@ public interface ISession : ISessionWithProgress
 
     float CompareSimilarityOfCodeBytesInBinary(IFunctionCodeSymbol firstSymbol, IFunctionCodeSymbol secondSymbol);
 
+    IReadOnlyList<ulong> FingerprintCodeBytesInBinary(IFunctionCodeSymbol functionSymbol);
+
     bool CompareData(long RVA1, long RVA2, uint length);
+
+    int HashData(long RVA, uint length);
 }
@@ -0,0 +1,85 @@
+﻿namespace SizeBench.AnalysisEngine.PDBInterop;
+
+// The subset of CodeView symbol record kinds (SYM_ENUM_e in cvinfo.h) that SizeBench needs to understand.  Anything else
+// is skipped over as a record we don't care about.
+internal enum CodeViewSymbolKind : ushort
+{
+    S_END = 0x0006,
+    S_THUNK32 = 0x1102,
+    S_BLOCK32 = 0x1103,
+    S_LABEL32 = 0x1105,
+    S_LDATA32 = 0x110C,
+    S_GDATA32 = 0x110D,
+    S_PUB32 = 0x110E,
+    S_LPROC32 = 0x110F,
+    S_GPROC32 = 0x1110,
+    S_COMPILE2 = 0x1116,
+    S_SEPCODE = 0x1132,
+    S_SECTION = 0x1136,
+    S_COFFGROUP = 0x1137,
+    S_COMPILE3 = 0x113C,
+    S_ENVBLOCK = 0x113D,
+    S_LPROC32_ID = 0x1146,
+    S_GPROC32_ID = 0x1147,
+    S_PROC_ID_END = 0x114F,
+    S_INLINESITE = 0x114D,
+    S_INLINESITE_END = 0x114E,
+}
+
+// One symbol record - the Data does not include the 2-byte length or 2-byte kind that prefix each record.
+internal readonly ref struct CodeViewSymbolRecord
+{
+    public CodeViewSymbolKind Kind { get; }
+    public int Offset { get; }
+    public ReadOnlySpan<byte> Data { get; }
+
+    public CodeViewSymbolRecord(CodeViewSymbolKind kind, int offset, ReadOnlySpan<byte> data)
+    {
+        this.Kind = kind;
+        this.Offset = offset;
+        this.Data = data;
+    }
+
+    public SpanReader CreateReader() => new SpanReader(this.Data);
+}
+
+// Walks a buffer of back-to-back symbol records, as found in a module's symbol stream or in the global symbol records stream.
+// This is a ref struct so it can hand out spans over the stream without copying every record.
+internal ref struct CodeViewSymbolRecordEnumerator
+{
+    private readonly ReadOnlySpan<byte> _data;
+    private int _nextOffset;
+
+    public CodeViewSymbolRecord Current { get; private set; }
+
+    public CodeViewSymbolRecordEnumerator(ReadOnlySpan<byte> data, int startOffset)
+    {
+        this._data = data;
+        this._nextOffset = startOffset;
+        this.Current = default;
+    }
+
+    public readonly CodeViewSymbolRecordEnumerator GetEnumerator() => this;
+
+    public bool MoveNext()
+    {
+        // Each record is at least a 2-byte length and a 2-byte kind, the length covers the kind and the data but not the length itself.
+        if (this._nextOffset + 4 > this._data.Length)
+        {
+            return false;
+        }
+
+        var reader = new SpanReader(this._data[this._nextOffset..]);
+        var recordLength = reader.ReadUInt16();
+        var kind = (CodeViewSymbolKind)reader.ReadUInt16();
+
+        if (recordLength < sizeof(ushort) || this._nextOffset + sizeof(ushort) + recordLength > this._data.Length)
+        {
+            return false;
+        }
+
+        this.Current = new CodeViewSymbolRecord(kind, this._nextOffset, this._data.Slice(this._nextOffset + 4, recordLength - sizeof(ushort)));
+        this._nextOffset += sizeof(ushort) + recordLength;
+        return true;
+    }
+}
@@ -0,0 +1,183 @@
+﻿using System.Diagnostics;
+
+namespace SizeBench.AnalysisEngine.PDBInterop;
+
+[DebuggerDisplay("PDB Module {ModuleName}, SymbolStream={SymbolStreamIndex}")]
+internal sealed class PDBModuleInfo
+{
+    public string ModuleName { get; }
+    public string ObjFileName { get; }
+    public ushort SymbolStreamIndex { get; }
+    public uint SymbolByteSize { get; }
+
+    public PDBModuleInfo(string moduleName, string objFileName, ushort symbolStreamIndex, uint symbolByteSize)
+    {
+        this.ModuleName = moduleName;
+        this.ObjFileName = objFileName;
+        this.SymbolStreamIndex = symbolStreamIndex;
+        this.SymbolByteSize = symbolByteSize;
+    }
+}
+
+internal readonly record struct PDBSectionContribution(ushort Section, uint Offset, uint Size, uint Characteristics, ushort ModuleIndex);
+
+// Stream 3 of every PDB - the "Debug Info" stream, which is the table of contents for everything else.  It lists each module (compiland)
+// and where its symbols are, the section contributions, and the indices of all the other interesting streams.
+internal sealed class DBIStream
+{
+    public const ushort StreamIndex = 3;
+
+    private const uint SectionContributionsVersion60 = 0xEFFE0000 + 19970605;
+    private const uint SectionContributionsVersion2 = 0xEFFE0000 + 20140516;
+
+    // These are the indices into the "optional debug header" substream, which is just an array of stream indices.
+    private const int OptionalDebugHeader_OmapToSrc = 3;
+    private const int OptionalDebugHeader_OmapFromSrc = 4;
+    private const int OptionalDebugHeader_SectionHdr = 5;
+
+    private readonly ushort[] _optionalDebugStreams;
+
+    public uint Age { get; }
+    public ushort GlobalSymbolStreamIndex { get; }
+    public ushort PublicSymbolStreamIndex { get; }
+    public ushort SymbolRecordStreamIndex { get; }
+    public ushort Machine { get; }
+    public bool IsIncrementallyLinked { get; }
+    public bool ArePrivateSymbolsStripped { get; }
+    public IReadOnlyList<PDBModuleInfo> Modules { get; }
+    public IReadOnlyList<PDBSectionContribution> SectionContributions { get; }
+
+    public ushort SectionHeaderStreamIndex => GetOptionalDebugStream(OptionalDebugHeader_SectionHdr);
+    public bool HasOmapStreams => GetOptionalDebugStream(OptionalDebugHeader_OmapToSrc) != MSFFile.NilStreamIndex ||
+                                  GetOptionalDebugStream(OptionalDebugHeader_OmapFromSrc) != MSFFile.NilStreamIndex;
+
+    public DBIStream(MSFFile msf)
+    {
+        var data = msf.ReadStream(StreamIndex);
+        if (data.Length < 64)
+        {
+            throw new PDBNotSuitableForAnalysisException("The PDB's DBI stream is missing or truncated - this may be a stripped or corrupt PDB.");
+        }
+
+        var reader = new SpanReader(data);
+        var versionSignature = reader.ReadInt32();
+        if (versionSignature != -1)
+        {
+            throw new PDBNotSuitableForAnalysisException("The PDB's DBI stream is in a very old format that is not supported.");
+        }
+
+        reader.Skip(sizeof(uint)); // VersionHeader
+        this.Age = reader.ReadUInt32();
+        this.GlobalSymbolStreamIndex = reader.ReadUInt16();
+        reader.Skip(sizeof(ushort)); // BuildNumber
+        this.PublicSymbolStreamIndex = reader.ReadUInt16();
+        reader.Skip(sizeof(ushort)); // PdbDllVersion
+        this.SymbolRecordStreamIndex = reader.ReadUInt16();
+        reader.Skip(sizeof(ushort)); // PdbDllRbld
+        var moduleInfoSize = reader.ReadInt32();
+        var sectionContributionSize = reader.ReadInt32();
+        var sectionMapSize = reader.ReadInt32();
+        var sourceInfoSize = reader.ReadInt32();
+        var typeServerMapSize = reader.ReadInt32();
+        reader.Skip(sizeof(uint)); // MFCTypeServerIndex
+        var optionalDebugHeaderSize = reader.ReadInt32();
+        var ecSubstreamSize = reader.ReadInt32();
+        var flags = reader.ReadUInt16();
+        this.Machine = reader.ReadUInt16();
+        reader.Skip(sizeof(uint)); // Padding
+
+        // Everything after the header is these substreams back-to-back, so if they add up to more than there is, this isn't a DBI stream we
+        // can trust any part of.
+        var substreamsSize = (long)moduleInfoSize + sectionContributionSize + sectionMapSize + sourceInfoSize + typeServerMapSize + ecSubstreamSize;
+        if (moduleInfoSize < 0 || sectionContributionSize < 0 || sectionMapSize < 0 || sourceInfoSize < 0 || typeServerMapSize < 0 ||
+            ecSubstreamSize < 0 || optionalDebugHeaderSize < 0 || substreamsSize > reader.BytesRemaining)
+        {
+            throw new PDBNotSuitableForAnalysisException("The PDB's DBI stream has substreams that run past its end, this PDB may be truncated or corrupt.");
+        }
+
+        this.IsIncrementallyLinked = (flags & 0x1) != 0;
+        this.ArePrivateSymbolsStripped = (flags & 0x2) != 0;
+
+        var substreamStart = reader.Position;
+        this.Modules = ParseModuleInfo(data.AsSpan(substreamStart, moduleInfoSize));
+        substreamStart += moduleInfoSize;
+
+        this.SectionContributions = ParseSectionContributions(data.AsSpan(substreamStart, sectionContributionSize));
+        substreamStart += sectionContributionSize + sectionMapSize + sourceInfoSize + typeServerMapSize + ecSubstreamSize;
+
+        var optionalDebugHeader = new SpanReader(data.AsSpan(substreamStart, Math.Min(optionalDebugHeaderSize, data.Length - substreamStart)));
+        this._optionalDebugStreams = new ushort[optionalDebugHeader.Length / sizeof(ushort)];
+        for (var i = 0; i < this._optionalDebugStreams.Length; i++)
+        {
+            this._optionalDebugStreams[i] = optionalDebugHeader.ReadUInt16();
+        }
+    }
+
+    private ushort GetOptionalDebugStream(int index)
+        => index < this._optionalDebugStreams.Length ? this._optionalDebugStreams[index] : MSFFile.NilStreamIndex;
+
+    private static List<PDBModuleInfo> ParseModuleInfo(ReadOnlySpan<byte> substream)
+    {
+        var modules = new List<PDBModuleInfo>(capacity: 1000);
+        var reader = new SpanReader(substream);
+
+        // Each ModInfo is a fixed 64-byte header (which embeds the module's first section contribution, which we don't need since
+        // we get all of them from the section contributions substream) followed by two strings, padded to a 4-byte boundary.
+        while (reader.BytesRemaining >= 64)
+        {
+            reader.Skip(sizeof(uint)); // Unused1
+            reader.Skip(28); // SectionContribEntry
+            reader.Skip(sizeof(ushort)); // Flags
+            var symbolStreamIndex = reader.ReadUInt16();
+            var symbolByteSize = reader.ReadUInt32();
+            reader.Skip(sizeof(uint)); // C11ByteSize
+            reader.Skip(sizeof(uint)); // C13ByteSize
+            reader.Skip(sizeof(ushort)); // SourceFileCount
+            reader.Skip(sizeof(ushort)); // Padding
+            reader.Skip(sizeof(uint)); // Unused2
+            reader.Skip(sizeof(uint)); // SourceFileNameIndex
+            reader.Skip(sizeof(uint)); // PdbFilePathNameIndex
+            var moduleName = reader.ReadNullTerminatedString();
+            var objFileName = reader.ReadNullTerminatedString();
+            reader.AlignTo(4);
+
+            modules.Add(new PDBModuleInfo(moduleName, objFileName, symbolStreamIndex, symbolByteSize));
+        }
+
+        return modules;
+    }
+
+    private static List<PDBSectionContribution> ParseSectionContributions(ReadOnlySpan<byte> substream)
+    {
+        if (substream.Length < sizeof(uint))
+        {
+            return new List<PDBSectionContribution>();
+        }
+
+        var reader = new SpanReader(substream);
+        var version = reader.ReadUInt32();
+        var entrySize = version switch
+        {
+            SectionContributionsVersion60 => 28,
+            SectionContributionsVersion2 => 32, // V2 appends the COFF section index, which we don't need.
+            _ => throw new PDBNotSuitableForAnalysisException($"The PDB's section contributions are in an unknown format (0x{version:X}).")
+        };
+
+        var contributions = new List<PDBSectionContribution>(capacity: reader.BytesRemaining / entrySize);
+        while (reader.BytesRemaining >= entrySize)
+        {
+            var entryStart = reader.Position;
+            var section = reader.ReadUInt16();
+            reader.Skip(sizeof(ushort)); // Padding
+            var offset = reader.ReadUInt32();
+            var size = reader.ReadUInt32();
+            var characteristics = reader.ReadUInt32();
+            var moduleIndex = reader.ReadUInt16();
+            reader.Position = entryStart + entrySize;
+
+            contributions.Add(new PDBSectionContribution(section, offset, size, characteristics, moduleIndex));
+        }
+
+        return contributions;
+    }
+}
@@ -0,0 +1,172 @@
+﻿using System.Buffers.Binary;
+using System.IO;
+using Microsoft.Win32.SafeHandles;
+
+namespace SizeBench.AnalysisEngine.PDBInterop;
+
+// A PDB is a "Multi-Stream File" (MSF) - a tiny file system of fixed-size blocks, with a directory that maps each numbered stream
+// onto the blocks that hold its bytes.  This class knows just enough about that container format to hand back the bytes of any
+// stream, everything about what those bytes mean lives in the stream-specific readers (PDBInfoStream, DBIStream, and so on).
+//
+// Only the "big MSF" (MSF 7.00) format is supported, which is what every toolchain has produced for many, many years.
+internal sealed class MSFFile : IDisposable
+{
+    private static ReadOnlySpan<byte> BigMSFMagic => "Microsoft C/C++ MSF 7.00\r\n\u001ADS\0\0\0"u8;
+
+    public const ushort NilStreamIndex = 0xFFFF;
+    private const uint NilStreamSize = 0xFFFFFFFF;
+
+    private SafeFileHandle? _fileHandle;
+    private readonly uint[] _streamSizes;
+    private readonly uint[][] _streamBlocks;
+
+    public uint BlockSize { get; }
+    public int StreamCount => this._streamSizes.Length;
+
+    public MSFFile(string pdbPath)
+    {
+        this._fileHandle = File.OpenHandle(pdbPath, FileMode.Open, FileAccess.Read, FileShare.Read, FileOptions.RandomAccess);
+
+        try
+        {
+            Span<byte> superBlock = stackalloc byte[BigMSFMagic.Length + (6 * sizeof(uint))];
+            if (RandomAccess.Read(this._fileHandle, superBlock, 0) != superBlock.Length ||
+                !superBlock[..BigMSFMagic.Length].SequenceEqual(BigMSFMagic))
+            {
+                throw new PDBNotSuitableForAnalysisException($"'{pdbPath}' does not appear to be a PDB in the MSF 7.00 format, which is the only format supported by the managed PDB reader.");
+            }
+
+            var fields = superBlock[BigMSFMagic.Length..];
+            this.BlockSize = BinaryPrimitives.ReadUInt32LittleEndian(fields);
+            var numberOfDirectoryBytes = BinaryPrimitives.ReadUInt32LittleEndian(fields[(3 * sizeof(uint))..]);
+            var blockMapAddress = BinaryPrimitives.ReadUInt32LittleEndian(fields[(5 * sizeof(uint))..]);
+
+            if (this.BlockSize is not (512 or 1024 or 2048 or 4096 or 8192 or 16384 or 32768))
+            {
+                throw new PDBNotSuitableForAnalysisException($"'{pdbPath}' has an unexpected MSF block size of {this.BlockSize}, it may be corrupt.");
+            }
+
+            // The block map is a list of the blocks that make up the stream directory - the directory itself can be larger than one
+            // block, and need not be contiguous.
+            var directoryBlockCount = BlocksNeededFor(numberOfDirectoryBytes);
+            var blockMap = ReadBytes((long)blockMapAddress * this.BlockSize, directoryBlockCount * sizeof(uint));
+            var directoryBlocks = new uint[directoryBlockCount];
+            for (var i = 0; i < directoryBlocks.Length; i++)
+            {
+                directoryBlocks[i] = BinaryPrimitives.ReadUInt32LittleEndian(blockMap.AsSpan(i * sizeof(uint)));
+            }
+
+            var directory = ReadBlocks(directoryBlocks, numberOfDirectoryBytes);
+            var reader = new SpanReader(directory);
+
+            var streamCount = reader.ReadUInt32();
+            if (streamCount > reader.BytesRemaining / sizeof(uint))
+            {
+                throw new PDBNotSuitableForAnalysisException($"'{pdbPath}' has a stream directory that claims more streams than it has room for, it may be corrupt.");
+            }
+
+            this._streamSizes = new uint[streamCount];
+            this._streamBlocks = new uint[streamCount][];
+
+            for (var i = 0; i < streamCount; i++)
+            {
+                this._streamSizes[i] = reader.ReadUInt32();
+            }
+
+            for (var i = 0; i < streamCount; i++)
+            {
+                var blockCount = this._streamSizes[i] == NilStreamSize ? 0 : BlocksNeededFor(this._streamSizes[i]);
+                if (blockCount > reader.BytesRemaining / sizeof(uint))
+                {
+                    throw new PDBNotSuitableForAnalysisException($"'{pdbPath}' has a stream directory that runs out before listing every stream's blocks, it may be corrupt.");
+                }
+
+                var blocks = new uint[blockCount];
+                for (var blockIndex = 0; blockIndex < blockCount; blockIndex++)
+                {
+                    blocks[blockIndex] = reader.ReadUInt32();
+                }
+                this._streamBlocks[i] = blocks;
+            }
+        }
+        catch
+        {
+            this._fileHandle.Dispose();
+            this._fileHandle = null;
+            throw;
+        }
+    }
+
+    public bool StreamExists(ushort streamIndex)
+        => streamIndex != NilStreamIndex &&
+           streamIndex < this._streamSizes.Length &&
+           this._streamSizes[streamIndex] != NilStreamSize;
+
+    public byte[] ReadStream(ushort streamIndex)
+    {
+        ObjectDisposedException.ThrowIf(this._fileHandle is null, this);
+
+        if (!StreamExists(streamIndex))
+        {
+            return [];
+        }
+
+        return ReadBlocks(this._streamBlocks[streamIndex], this._streamSizes[streamIndex]);
+    }
+
+    private int BlocksNeededFor(uint byteCount) => (int)(((long)byteCount + this.BlockSize - 1) / this.BlockSize);
+
+    private byte[] ReadBlocks(uint[] blocks, uint byteCount)
+    {
+        var result = new byte[byteCount];
+        var destination = result.AsSpan();
+
+        // Streams are very often laid out in consecutive blocks, so we coalesce runs of adjacent blocks into a single read to
+        // cut down on the number of syscalls for large streams like the TPI or the symbol records stream.
+        var blockIndex = 0;
+        while (destination.Length > 0)
+        {
+            var runLength = 1;
+            while (blockIndex + runLength < blocks.Length && blocks[blockIndex + runLength] == blocks[blockIndex] + runLength)
+            {
+                runLength++;
+            }
+
+            var bytesInRun = (int)Math.Min((long)runLength * this.BlockSize, destination.Length);
+            ReadExactly(destination[..bytesInRun], (long)blocks[blockIndex] * this.BlockSize);
+
+            destination = destination[bytesInRun..];
+            blockIndex += runLength;
+        }
+
+        return result;
+    }
+
+    private byte[] ReadBytes(long fileOffset, int byteCount)
+    {
+        var result = new byte[byteCount];
+        ReadExactly(result, fileOffset);
+        return result;
+    }
+
+    private void ReadExactly(Span<byte> destination, long fileOffset)
+    {
+        while (destination.Length > 0)
+        {
+            var bytesRead = RandomAccess.Read(this._fileHandle!, destination, fileOffset);
+            if (bytesRead == 0)
+            {
+                throw new PDBNotSuitableForAnalysisException("The PDB ended unexpectedly while reading one of its streams, it may be truncated or corrupt.");
+            }
+
+            destination = destination[bytesRead..];
+            fileOffset += bytesRead;
+        }
+    }
+
+    public void Dispose()
+    {
+        this._fileHandle?.Dispose();
+        this._fileHandle = null;
+    }
+}
@@ -0,0 +1,817 @@
+﻿using System.Reflection.PortableExecutable;
+using System.Runtime.InteropServices;
+using Dia2Lib;
+using SizeBench.AnalysisEngine.DIAInterop;
+using SizeBench.AnalysisEngine.PE;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.PDBInterop;
+
+// An IDIAAdapter that reads the PDB directly with managed code instead of going through msdia140.dll.  This avoids COM, the
+// single STA thread's marshaling costs, and DIA's lazy-loading for the things SizeBench asks for most often at startup - the
+// sections, COFF Groups, section contributions and the RVA -> symbol index.
+//
+// The managed reader does not (yet) understand the type system, source files, inline sites or separated code blocks, so the parts of
+// IDIAAdapter that depend on those throw NotSupportedException.  Public symbol names are undecorated by MSVCNameUndecorator, and the
+// few it can't undecorate keep their decorated names.  Callers that need any of that should use the DIA reader, which remains the
+// default - see SessionOptions.PDBReader.
+internal sealed class ManagedPDBAdapter : IDIAAdapter, IDisposable
+{
+    private ManagedPDBFile? _pdbFile;
+    private Session? _session;
+    private PEFile? _peFile;
+    private SessionDataCache? _cache;
+    private uint _fileAlignment;
+    private uint _sectionAlignment;
+    private readonly int _affinitizedThreadId;
+
+    private void ThrowIfOnWrongThread()
+    {
+        if (Environment.CurrentManagedThreadId != this._affinitizedThreadId)
+        {
+            throw new InvalidOperationException($"This operation is not permitted on this thread.  This object expects to only be used on ManagedThreadId {this._affinitizedThreadId}, but it is being called on ManagedThreadId {Environment.CurrentManagedThreadId}.  This is a bug in SizeBench, not in your usage of it.");
+        }
+    }
+
+    // There are several fields of this type that we want to access a lot without checking for null or using "!" everywhere, so these properties let us do that safely.
+    // These can only be null during/after disposal, so these properties all throw if we're disposing.
+    private ManagedPDBFile PDBFile
+    {
+        get
+        {
+            ThrowIfDisposingOrDisposed();
+            return this._pdbFile!;
+        }
+    }
+
+    private SessionDataCache DataCache
+    {
+        get
+        {
+            ThrowIfDisposingOrDisposed();
+            return this._cache!;
+        }
+    }
+
+    private bool SupportsCodeSymbols { get; }
+    private bool SupportsDataSymbols { get; }
+
+    private Session Session
+    {
+        get
+        {
+            ThrowIfDisposingOrDisposed();
+            return this._session!;
+        }
+    }
+
+    private PEFile PEFile
+    {
+        get
+        {
+            ThrowIfDisposingOrDisposed();
+            return this._peFile!;
+        }
+    }
+
+    #region Construction, opening, all the startup-y things
+
+    internal ManagedPDBAdapter(Session session, string pdbPath)
+    {
+        this._session = session;
+        this._cache = session.DataCache;
+        this._affinitizedThreadId = Environment.CurrentManagedThreadId;
+        this.SupportsCodeSymbols = session.SessionOptions.SymbolSourcesSupported.HasFlag(SymbolSourcesSupported.Code);
+        this.SupportsDataSymbols = session.SessionOptions.SymbolSourcesSupported.HasFlag(SymbolSourcesSupported.DataSymbols);
+
+        this._pdbFile = new ManagedPDBFile(pdbPath);
+
+        PDBAdapterCommon.ThrowIfMachineTypeNotSupported(this._pdbFile.DBI.Machine);
+    }
+
+    internal void Initialize(PEFile peFile, ILogger logger)
+    {
+        ThrowIfOnWrongThread();
+        ThrowIfDisposingOrDisposed();
+
+        this._peFile = peFile;
+        this._fileAlignment = peFile.FileAlignment;
+        this._sectionAlignment = peFile.SectionAlignment;
+
+        PDBAdapterCommon.ThrowIfPDBNotSuitableForAnalysis(this.DataCache,
+                                                          GetLinkerCommandLine(),
+                                                          areSymbolsStripped: this.PDBFile.DBI.ArePrivateSymbolsStripped,
+                                                          isBBTedBinary: this.PDBFile.DBI.HasOmapStreams,
+                                                          // The managed reader only understands MSF PDBs, so if we got this far it can't be a Portable PDB, and
+                                                          // /DEBUG:FASTLINK PDBs are caught by the linker command line check.
+                                                          isPortablePdb: false,
+                                                          isFastLinkPdb: false);
+
+        PDBAdapterCommon.ThrowIfDebugSignatureMismatch(peFile, this.PDBFile.InfoStream.Guid, this.PDBFile.InfoStream.Age);
+
+        var xdataRVARangeFromCoffGroupsIfAvailable = PDBAdapterCommon.GetXDataRVARangeFromCoffGroupsIfAvailable(this.Session);
+
+        PDBAdapterCommon.InitializeRVARangesThatAreOnlyVirtualSize(this.DataCache, this._peFile.BytesPerWord);
+
+        FindAllDisambiguatingVTablePublicSymbolNamesByRVA(logger, CancellationToken.None);
+
+        {
+            using var preProcessLog = logger.StartTaskLog("Pre-processing appropriate symbols");
+            PDBAdapterCommon.PreProcessSymbolsOrLoadFromCache(this.Session, peFile, this.DataCache, preProcessLog, PreProcessSymbols,
+                                                              (symIndexId, rva) => this.PDBFile.TryGetSymbol(symIndexId, out var pdbSymbol) && pdbSymbol.RVA == rva);
+        }
+
+        // It is important that this comes after RVARangesThatAreOnlyVirtualSize is set up, as some of the EH Symbols may need
+        // to parse Public Symbols, and before we can do that, we better know what's virtual or real size or else we might
+        // start setting up the DataCache with bad data.
+        {
+            using var ehParsingLog = logger.StartTaskLog("Parsing Exception Handling symbols");
+            peFile.ParseEHSymbols(this.Session, this, xdataRVARangeFromCoffGroupsIfAvailable, ehParsingLog);
+            ehParsingLog.Log($"Found {this.DataCache.PDataSymbolsByRVA.Count:N0} PDATA symbols and {this.DataCache.XDataSymbolsByRVA.Count:N0} XDATA symbols.");
+        }
+
+        this.DataCache.RsrcSymbolsByRVA = peFile.RsrcSymbols;
+        this.DataCache.RsrcHasBeenInitialized = true;
+        this.DataCache.OtherPESymbolsByRVA = peFile.OtherPESymbols;
+        this.DataCache.OtherPESymbolsRVARanges = peFile.OtherPESymbolsRVARanges;
+        this.DataCache.OtherPESymbolsHaveBeenInitialized = true;
+    }
+
+    private LinkerCommandLine? GetLinkerCommandLine()
+    {
+        var modules = this.PDBFile.DBI.Modules;
+        for (var moduleIndex = 0; moduleIndex < modules.Count; moduleIndex++)
+        {
+            if (modules[moduleIndex].ModuleName == ManagedPDBFile.LinkerModuleName)
+            {
+                return FindCommandLineForCompilandByID(ManagedPDBFile.CompilandSymIndexIdFromModuleIndex(moduleIndex)) as LinkerCommandLine;
+            }
+        }
+
+        return null;
+    }
+
+    #endregion
+
+    private bool IsSymbolSourceSupported(PDBSymbol symbol)
+    {
+        return symbol.Kind switch
+        {
+            PDBSymbolKind.Function or
+            PDBSymbolKind.Thunk => this.SupportsCodeSymbols,
+            PDBSymbolKind.Data => this.SupportsDataSymbols,
+            PDBSymbolKind.PublicSymbol => symbol.IsCode ? this.SupportsCodeSymbols : this.SupportsDataSymbols,
+            _ => true,
+        };
+    }
+
+    private static SymTagEnum SymTagFromKind(PDBSymbolKind kind)
+    {
+        return kind switch
+        {
+            PDBSymbolKind.Function => SymTagEnum.SymTagFunction,
+            PDBSymbolKind.Thunk => SymTagEnum.SymTagThunk,
+            PDBSymbolKind.Data => SymTagEnum.SymTagData,
+            PDBSymbolKind.PublicSymbol => SymTagEnum.SymTagPublicSymbol,
+            _ => throw new InvalidOperationException($"Unknown PDB symbol kind {kind}.  This is a bug in SizeBench's implementation, not your usage of it.")
+        };
+    }
+
+    #region Finding Binary Sections
+
+    public IEnumerable<BinarySection> FindBinarySections(IPEFile peFile, ILogger parentLogger, CancellationToken token)
+    {
+        ThrowIfOnWrongThread();
+
+        if (this.DataCache.AllBinarySections is null)
+        {
+            // We need the COFF Group names because some section names are too short due to PE file limitations and the COFF Group contains the full
+            // name.  This happens especially with some types of code obfuscation.
+            var coffGroups = FindCompressedRawCOFFGroups(peFile, parentLogger, token);
+
+            this.DataCache.AllBinarySections = PDBAdapterCommon.CreateBinarySections(this.DataCache, peFile, coffGroups, this._fileAlignment, this._sectionAlignment);
+        }
+
+        return this.DataCache.AllBinarySections;
+    }
+
+    public List<IMAGE_SECTION_HEADER> FindAllImageSectionHeadersFromPDB(CancellationToken token)
+    {
+        ThrowIfOnWrongThread();
+
+        return new List<IMAGE_SECTION_HEADER>(this.PDBFile.SectionHeaders);
+    }
+
+    #endregion
+
+    #region Finding COFF Groups
+
+    private List<RawCOFFGroup> FindCompressedRawCOFFGroups(IPEFile peFile, ILogger parentLogger, CancellationToken token)
+    {
+        var coffGroupsFromPDB = this.PDBFile.COFFGroups;
+        var rawCOFFGroups = new List<RawCOFFGroup>(capacity: coffGroupsFromPDB.Count + 10);
+        var coffGroupRangesFromPDB = new List<RVARange>(capacity: coffGroupsFromPDB.Count);
+
+        foreach (var coffGroup in coffGroupsFromPDB)
+        {
+            token.ThrowIfCancellationRequested();
+            rawCOFFGroups.Add(new RawCOFFGroup(coffGroup.Name, coffGroup.Length, coffGroup.RVA, (SectionCharacteristics)coffGroup.Characteristics));
+            coffGroupRangesFromPDB.Add(RVARange.FromRVAAndSize(coffGroup.RVA, coffGroup.Length));
+        }
+
+        rawCOFFGroups.AddRange(PDBAdapterCommon.SynthesizeCOFFGroupsMissingFromPDB(coffGroupRangesFromPDB, peFile));
+
+        return PDBAdapterCommon.CompressRawCOFFGroups(rawCOFFGroups.WithLogging(parentLogger, "COFF Groups")
+                                                                   .OrderBy(cg => cg.RVAStart));
+    }
+
+    public IEnumerable<COFFGroup> FindCOFFGroups(IPEFile peFile, ILogger parentLogger, CancellationToken token)
+    {
+        ThrowIfOnWrongThread();
+
+        if (this.DataCache.AllCOFFGroups is null)
+        {
+            this.DataCache.AllCOFFGroups = FindCompressedRawCOFFGroups(peFile, parentLogger, token)
+                                           .Select(cg => new COFFGroup(this.DataCache, cg.Name, cg.Length, cg.RVAStart, this._fileAlignment, this._sectionAlignment, cg.Characteristics))
+                                           .ToList();
+        }
+
+        return this.DataCache.AllCOFFGroups;
+    }
+
+    #endregion
+
+    #region Finding Section Contributions
+
+    public IEnumerable<RawSectionContribution> FindSectionContributions(ILogger parentLogger, CancellationToken token)
+    {
+        ThrowIfOnWrongThread();
+
+        var modules = this.PDBFile.DBI.Modules;
+        var sectionHeaders = this.PDBFile.SectionHeaders;
+
+        return this.PDBFile.DBI.SectionContributions
+                               .Where(sc => sc.ModuleIndex < modules.Count && sc.Section >= 1 && sc.Section <= sectionHeaders.Count)
+                               .WithCancellation(token)
+                               .WithLogging(parentLogger, "Section Contributions")
+                               .Select(sc =>
+                               {
+                                   var module = modules[sc.ModuleIndex];
+                                   return new RawSectionContribution(module.ObjFileName,
+                                                                     module.ModuleName,
+                                                                     ManagedPDBFile.CompilandSymIndexIdFromModuleIndex(sc.ModuleIndex),
+                                                                     sectionHeaders[sc.Section - 1].VirtualAddress + sc.Offset,
+                                                                     sc.Size);
+                               });
+    }
+
+    #endregion
+
+    #region Finding Data Symbols
+
+    public IEnumerable<StaticDataSymbol> FindAllStaticDataSymbolsWithinCompiland(Compiland compiland, CancellationToken cancellationToken)
+    {
+        ThrowIfOnWrongThread();
+
+        if (!this.SupportsDataSymbols)
+        {
+            return Array.Empty<StaticDataSymbol>();
+        }
+
+        // Usually when enumerating a bunch of symbols there will be hundreds or thousands of them so we'll pre-size capacity to 100 to do less
+        // constant reallocations early.
+        var allSymbols = new List<StaticDataSymbol>(capacity: 100);
+
+        foreach (var compilandSymIndexId in compiland.SymIndexIds)
+        {
+            foreach (var pdbSymbol in this.PDBFile.GetDataSymbolsInCompiland(compilandSymIndexId))
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+                allSymbols.Add(FindSymbolBySymIndexId<StaticDataSymbol>(pdbSymbol.SymIndexId, cancellationToken));
+            }
+        }
+
+        return allSymbols;
+    }
+
+    // The DIAWorkerPool is made of DIA sessions, so there's nothing to split this up across - the caller looks at each compiland instead.
+    public List<StaticDataSymbol>? FindStaticDataSymbolsThatMayBeDuplicates(HashSet<Compiland> compilands, ILogger logger, CancellationToken cancellationToken)
+        => null;
+
+    #endregion
+
+    #region Finding Public Symbols
+
+    public SortedList<uint, List<string>> FindAllDisambiguatingVTablePublicSymbolNamesByRVA(ILogger parentLogger, CancellationToken cancellationToken)
+    {
+        ThrowIfOnWrongThread();
+
+        if (this.DataCache.AllDisambiguatingVTablePublicSymbolNamesByRVA is null)
+        {
+            var disambiguatingVTableNamesByRVA = new Dictionary<uint, List<string>>();
+
+            foreach (var pdbSymbol in this.PDBFile.Symbols)
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+
+                // Every vftable's decorated name starts with ??_7, so there's no need to undecorate anything else to find them.
+                if (pdbSymbol.Kind != PDBSymbolKind.PublicSymbol || !pdbSymbol.Name.StartsWith("??_7", StringComparison.Ordinal))
+                {
+                    continue;
+                }
+
+                var publicSymName = this.DataCache.UndecoratedNames.GetUndecoratedName(pdbSymbol.Name);
+                if (publicSymName is null || !publicSymName.Contains("`vftable'{for", StringComparison.Ordinal))
+                {
+                    continue;
+                }
+
+                // The "const " prefix is not useful to anything we do with vtable names, so we strip it if present.
+                if (publicSymName.StartsWith("const ", StringComparison.Ordinal))
+                {
+                    publicSymName = publicSymName["const ".Length..];
+                }
+
+                ref var namesList = ref CollectionsMarshal.GetValueRefOrAddDefault(disambiguatingVTableNamesByRVA, pdbSymbol.RVA, out _);
+                namesList ??= new List<string>();
+                namesList.Add(publicSymName);
+            }
+
+            this.DataCache.AllDisambiguatingVTablePublicSymbolNamesByRVA = new SortedList<uint, List<string>>(disambiguatingVTableNamesByRVA);
+        }
+
+        return this.DataCache.AllDisambiguatingVTablePublicSymbolNamesByRVA;
+    }
+
+    #endregion
+
+    #region Finding Symbols By SymIndexId
+
+    public TSymbol FindSymbolBySymIndexId<TSymbol>(uint symIndexId, CancellationToken token) where TSymbol : class, ISymbol
+    {
+        ThrowIfOnWrongThread();
+
+        if (this.DataCache.AllSymbolsBySymIndexId.TryGetValue(symIndexId, out var symbol))
+        {
+            AnalysisEngineEventSource.Log.SymbolCacheHit();
+            return symbol as TSymbol ?? throw new InvalidOperationException($"We were asked to parse a {typeof(TSymbol).Name}, but we got back a {symbol.GetType().Name} instead, that seems like a mistake.");
+        }
+
+        AnalysisEngineEventSource.Log.SymbolCacheMiss();
+        if (!this.PDBFile.TryGetSymbol(symIndexId, out var pdbSymbol))
+        {
+            throw new ArgumentException($"SymIndexId {symIndexId} does not refer to a symbol that the managed PDB reader knows how to parse.  This is a bug in SizeBench's implementation, not your usage of it.", nameof(symIndexId));
+        }
+
+        var parsedSymbol = ParseSymbol(pdbSymbol, token);
+        return parsedSymbol as TSymbol ?? throw new InvalidOperationException($"We were asked to parse a {typeof(TSymbol).Name}, but we got back a {parsedSymbol.GetType().Name} instead, that seems like a mistake.");
+    }
+
+    private ISymbol ParseSymbol(PDBSymbol pdbSymbol, CancellationToken cancellationToken)
+    {
+        try
+        {
+            return pdbSymbol.Kind switch
+            {
+                PDBSymbolKind.Function => GetOrCreateFunctionSymbol(pdbSymbol).PrimaryBlock,
+                PDBSymbolKind.Thunk => new ThunkSymbol(this.DataCache, pdbSymbol.Name, pdbSymbol.RVA, pdbSymbol.Length, pdbSymbol.SymIndexId),
+                PDBSymbolKind.Data => ParseDataSymbol(pdbSymbol, cancellationToken),
+                PDBSymbolKind.PublicSymbol => ParsePublicSymbol(pdbSymbol),
+                _ => throw new InvalidOperationException($"We shouldn't ever be parsing symbols of this type ({pdbSymbol.Kind}) at this point.  This is a bug in SizeBench's implementation, not your use of it."),
+            };
+        }
+        catch (Exception ex)
+        {
+            // We try to capture some additional diagnostics when we fail to parse a symbol, because this can happen in a deep stack that doesn't have the symbol's name, and the name
+            // is incredibly valuable in determining what to look at, especially when a customer reports a bug that isn't able to share source/binary/pdb.
+            throw new InvalidOperationException($"Failed to parse symbol '{pdbSymbol.Name}', which is a {pdbSymbol.Kind}.  See the inner exception for more details.", ex);
+        }
+    }
+
+    private IFunctionCodeSymbol GetOrCreateFunctionSymbol(PDBSymbol pdbSymbol)
+    {
+        if (this.DataCache.AllFunctionSymbolsBySymIndexIdOfPrimaryBlock.TryGetValue(pdbSymbol.SymIndexId, out var parsedSymbol))
+        {
+            return parsedSymbol;
+        }
+
+        return new SimpleFunctionCodeSymbol(this.DataCache, pdbSymbol.Name, pdbSymbol.RVA, pdbSymbol.Length, pdbSymbol.SymIndexId);
+    }
+
+    private StaticDataSymbol ParseDataSymbol(PDBSymbol pdbSymbol, CancellationToken cancellationToken)
+    {
+        var symbolLength = TryGetSymbolLengthForSpecialSymbols(pdbSymbol.Name, out var specialSymbolLength) ? specialSymbolLength : this.PDBFile.TPI.GetTypeSize(pdbSymbol.TypeIndex);
+
+        Compiland? referencedIn = null;
+        if (pdbSymbol.CompilandSymIndexId != 0)
+        {
+            if (this.DataCache.AllCompilands is null)
+            {
+                // This has the side-effect of updating cache.AllCompilands
+                _ = this.Session.EnumerateCompilands(cancellationToken).Result;
+            }
+
+            this.DataCache.CompilandsBySymIndexId.TryGetValue(pdbSymbol.CompilandSymIndexId, out referencedIn);
+        }
+
+        IFunctionCodeSymbol? functionParent = null;
+        if (pdbSymbol.ParentFunctionSymIndexId != 0 && this.SupportsCodeSymbols)
+        {
+            functionParent = GetOrCreateFunctionSymbol(this.PDBFile.GetSymbol(pdbSymbol.ParentFunctionSymIndexId));
+        }
+
+        var dataKind = functionParent is not null ? DataKind.DataIsStaticLocal :
+                       pdbSymbol.IsGlobal ? DataKind.DataIsGlobal :
+                       DataKind.DataIsFileStatic;
+
+        return new StaticDataSymbol(this.DataCache,
+                                    pdbSymbol.Name,
+                                    pdbSymbol.RVA,
+                                    symbolLength,
+                                    this.DataCache.RVARangesThatAreOnlyVirtualSize!.FullyContains(pdbSymbol.RVA, symbolLength),
+                                    pdbSymbol.SymIndexId,
+                                    dataKind,
+                                    type: null,
+                                    referencedIn,
+                                    functionParent);
+    }
+
+    private PublicSymbol ParsePublicSymbol(PDBSymbol pdbSymbol)
+    {
+        // String literals undecorate to `string', and like the DIA-based reader we then look up the real string data.  Every string literal's
+        // decorated name starts with "??_C@", which is quicker to check than the undecorated name.
+        if (pdbSymbol.Name.StartsWith("??_C@", StringComparison.Ordinal))
+        {
+            var stringData = this.PEFile.LoadStringByRVA(pdbSymbol.RVA, pdbSymbol.Length, out var isUnicodeString)
+                                        .Replace("\n", @"\n", StringComparison.Ordinal)
+                                        .Replace("\r", @"\r", StringComparison.Ordinal)
+                                        .Replace("\t", @"\t", StringComparison.Ordinal);
+
+            return new StringSymbol(this.DataCache,
+                                    "`string'",
+                                    stringData,
+                                    isUnicodeString,
+                                    pdbSymbol.RVA,
+                                    pdbSymbol.Length,
+                                    this.DataCache.RVARangesThatAreOnlyVirtualSize!.FullyContains(pdbSymbol.RVA, pdbSymbol.Length),
+                                    pdbSymbol.SymIndexId,
+                                    targetRva: 0);
+        }
+
+        return new PublicSymbol(this.DataCache,
+                                this.DataCache.UndecoratedNames.GetUndecoratedName(pdbSymbol.Name) ?? pdbSymbol.Name,
+                                pdbSymbol.RVA,
+                                pdbSymbol.Length,
+                                this.DataCache.RVARangesThatAreOnlyVirtualSize!.FullyContains(pdbSymbol.RVA, pdbSymbol.Length),
+                                pdbSymbol.SymIndexId,
+                                targetRva: 0);
+    }
+
+    private bool TryGetSymbolLengthForSpecialSymbols(string symbolName, out uint specialSymbolLength)
+    {
+        const uint sizeOfRVA = 4; // RVAs are always 4 bytes, regardless of bitness of the binary
+
+        // These 3 symbols are special and inserted by the linker - they're arrays of RVAs, and the count of entries is stored as the
+        // value of a peer absolute symbol.
+        var countSymbolName = symbolName switch
+        {
+            "__guard_fids_table" => "__guard_fids_count",
+            "__guard_iat_table" => "__guard_iat_count",
+            "__guard_longjmp_table" => "__guard_longjmp_count",
+            _ => null
+        };
+
+        if (countSymbolName != null && this.PDBFile.TryGetAbsolutePublicSymbolValue(countSymbolName, out var count))
+        {
+            specialSymbolLength = count * sizeOfRVA;
+            return true;
+        }
+
+        specialSymbolLength = 0;
+        return false;
+    }
+
+    #endregion
+
+    #region Finding Symbol By RVA, and in an RVA Range
+
+    public ISymbol? FindSymbolByRVA(uint rva, bool allowFindingNearest, CancellationToken cancellationToken)
+    {
+        ThrowIfOnWrongThread();
+
+        // If this RVA is home to multiple COMDAT-folded symbols, we want to find the one we counted as primary, that we attributed all the bytes to.
+        if (this.DataCache.AllCanonicalNames!.TryGetValue(rva, out var nameCanonicalization))
+        {
+            return FindSymbolBySymIndexId<ISymbol>(nameCanonicalization.CanonicalSymIndexID, cancellationToken);
+        }
+
+        var pdbSymbol = this.PDBFile.FindSymbolByRVA(rva, allowFindingNearest);
+
+        if (pdbSymbol is null || !IsSymbolSourceSupported(pdbSymbol))
+        {
+            return null;
+        }
+
+        return FindSymbolBySymIndexId<ISymbol>(pdbSymbol.SymIndexId, cancellationToken);
+    }
+
+    public IEnumerable<(ISymbol symbol, uint amountOfRVARangeExplored)> FindSymbolsInRVARange(RVARange range, CancellationToken cancellationToken)
+    {
+        ThrowIfOnWrongThread();
+
+        Symbol? previousNonFoldedSymbolYielded = null;
+
+        if (this.DataCache.TryFindSymIndicesInRVARange(range, out var symIndicesByRVA, out var minIdx, out var maxIdx))
+        {
+            for (var i = minIdx; i <= maxIdx; i++)
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+
+                // We know the symIndices are already filtered by supported symbol sources, so we don't have to check that here.
+                foreach (var symIndex in symIndicesByRVA.SymIndicesAt(i))
+                {
+                    var symbol = FindSymbolBySymIndexId<Symbol>(symIndex, cancellationToken);
+
+                    // It's possible the symbol we get has an RVA start in the range, but extends beyond the range - if so, we don't
+                    // want to yield it here.
+                    if (symbol.RVAEnd > range.RVAEnd)
+                    {
+                        continue;
+                    }
+
+                    // If this symbol is 'within' the previous one, we don't need to return it as all the space is already accounted for.
+                    if (previousNonFoldedSymbolYielded is not null &&
+                        previousNonFoldedSymbolYielded.RVA <= symbol.RVA)
+                    {
+                        if (previousNonFoldedSymbolYielded.RVAEnd >= symbol.RVAEnd)
+                        {
+                            continue;
+                        }
+
+                        if (symbol is PublicSymbol && this.DataCache.LabelExistsAtRVA(symbol.RVA))
+                        {
+                            continue;
+                        }
+                    }
+
+                    yield return (symbol, symbol.RVAEnd - range.RVAStart);
+                    previousNonFoldedSymbolYielded = symbol;
+
+                    if (this.DataCache.AllCanonicalNames!.TryGetValue(symbol.RVA, out var nameCanonicalization))
+                    {
+                        foreach ((var foldedSymIndexId, _, _) in nameCanonicalization.NamesBySymIndexID)
+                        {
+                            if (foldedSymIndexId == symbol.SymIndexId)
+                            {
+                                continue; // We already yielded this one to the caller, we only want to find other SymIndexIDs folded at this RVA
+                            }
+
+                            var foldedSymbol = FindSymbolBySymIndexId<ISymbol>(foldedSymIndexId, cancellationToken);
+
+                            // Note the subtle use of "symbol.RVAEnd" instead of "foldedSymbol.RVAEnd" - this is because folded symbols have 0 size, so their RVAEnd == RVA, which means the
+                            // progress would go backwards from the "symbol" if we use that here.
+                            yield return (foldedSymbol, symbol.RVAEnd - range.RVAStart);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    private void PreProcessSymbols(ILogger logger, CancellationToken cancellationToken)
+    {
+        ThrowIfOnWrongThread();
+
+        var rvaToSymIndexIDs = new Dictionary<uint, List<uint>>();
+        var nameCanonicalizationsByRVA = new Dictionary<uint, NameCanonicalization>();
+
+        using (logger.StartTaskLog("Walking symbols by RVA"))
+        {
+            // It is important that PublicSymbols are considered last, for the same reason as in the DIA-based reader - each NameCanonicalization
+            // will discard public symbol names once it has seen any non-public name, and that only works if the public ones come after.
+            foreach (var publicSymbolsPass in new[] { false, true })
+            {
+                foreach (var pdbSymbol in this.PDBFile.Symbols)
+                {
+                    cancellationToken.ThrowIfCancellationRequested();
+
+                    if ((pdbSymbol.Kind == PDBSymbolKind.PublicSymbol) != publicSymbolsPass ||
+                        !IsSymbolSourceSupported(pdbSymbol))
+                    {
+                        continue;
+                    }
+
+                    ref var list = ref CollectionsMarshal.GetValueRefOrAddDefault(rvaToSymIndexIDs, pdbSymbol.RVA, out _);
+                    list ??= new List<uint>();
+                    list.Add(pdbSymbol.SymIndexId);
+
+                    ProcessOneSymbolForCanonicalNameSearch(pdbSymbol, nameCanonicalizationsByRVA);
+                }
+            }
+        }
+
+        using (logger.StartTaskLog("Sorting and pruning canonical name list"))
+        {
+            // Remove any entries where the RVA had just one symbol, to reduce burden on people enumerating these later - that way a TryGetValue(rvaWithNothingFolded) will return false.
+            var resultsAsSortedList = new SortedList<uint, NameCanonicalization>(capacity: nameCanonicalizationsByRVA.Count);
+            foreach (var resultEntry in nameCanonicalizationsByRVA.OrderBy(static x => x.Key))
+            {
+                if (resultEntry.Value.NamesBySymIndexID.Count > 1)
+                {
+                    resultEntry.Value.Canonicalize();
+                    resultsAsSortedList.Add(resultEntry.Key, resultEntry.Value);
+                }
+            }
+
+            resultsAsSortedList.TrimExcess();
+            this.DataCache.AllCanonicalNames = resultsAsSortedList;
+        }
+
+        this.DataCache.InitializeRVARanges(rvaToSymIndexIDs, this.SupportsCodeSymbols ? new HashSet<uint>(this.PDBFile.RVAsOfLabels) : new HashSet<uint>());
+    }
+
+    private void ProcessOneSymbolForCanonicalNameSearch(PDBSymbol pdbSymbol, Dictionary<uint, NameCanonicalization> results)
+    {
+        if (pdbSymbol.RVA == 0)
+        {
+            return;
+        }
+
+        var symTag = SymTagFromKind(pdbSymbol.Kind);
+
+        ref var nameCanonicalization = ref CollectionsMarshal.GetValueRefOrAddDefault(results, pdbSymbol.RVA, out _);
+        nameCanonicalization ??= new NameCanonicalization();
+
+        if (!nameCanonicalization.IsNameEvenGoingToBeConsidered(symTag))
+        {
+            return;
+        }
+
+        // Each name needs to be the one its symbol will end up with, so the canonical name matches the symbol's Name.  Functions get the same
+        // formatting their SimpleFunctionCodeSymbol will give them - without types there's no parent type or signature to add, so this is just the
+        // name itself, but it goes through the same path for consistency.  Public symbols are undecorated just like ParsePublicSymbol does, and
+        // that's only worth doing now that we know the name is going to be considered.
+        var symbolName = pdbSymbol.Kind switch
+        {
+            PDBSymbolKind.Function => FunctionCodeFormattedName.GetFormattedName(FunctionCodeNameFormatting.IncludeUniqueSignatureWithNoPrefixes,
+                                                                                  isStatic: false, isIntroVirtual: false, functionType: null, parentType: null,
+                                                                                  pdbSymbol.Name, argumentNames: null, isVirtual: false, isSealed: false),
+            PDBSymbolKind.PublicSymbol => this.DataCache.UndecoratedNames.GetUndecoratedName(pdbSymbol.Name) ?? pdbSymbol.Name,
+            _ => pdbSymbol.Name,
+        };
+
+        nameCanonicalization.AddName(pdbSymbol.SymIndexId, symTag, name: symbolName);
+    }
+
+    #endregion
+
+    #region Finding command line for a compiland
+
+    public CommandLine FindCommandLineForCompilandByID(uint compilandSymIndexId)
+    {
+        ThrowIfOnWrongThread();
+
+        var details = this.PDBFile.GetCompilandDetails(compilandSymIndexId);
+        return CommandLine.FromLanguageAndToolName(details.Language, details.ToolName, details.FrontEndVersion, details.BackEndVersion, details.CommandLine);
+    }
+
+    #endregion
+
+    #region Loading Public Symbol By Target RVA
+
+    // S_PUB32 records don't carry a target RVA - DIA computes it for incremental linking thunks by decoding the jmp, which we don't try
+    // to replicate here.
+    public uint? LoadPublicSymbolTargetRVAIfPossible(uint rva)
+    {
+        ThrowIfDisposingOrDisposed();
+        ThrowIfOnWrongThread();
+
+        return null;
+    }
+
+    #endregion
+
+    #region RVA -> Name
+
+    public string SymbolNameFromRva(uint rva)
+    {
+        ThrowIfOnWrongThread();
+        return this.PDBFile.FindSymbolByRVA(rva, allowFindingNearest: true)?.Name ?? String.Empty;
+    }
+
+    public uint SymbolRvaFromName(string name, bool preferFunction)
+    {
+        ThrowIfOnWrongThread();
+
+        PDBSymbol? bestCandidate = null;
+        foreach (var pdbSymbol in this.PDBFile.FindSymbolsByName(name))
+        {
+            if (!preferFunction || pdbSymbol.Kind == PDBSymbolKind.Function)
+            {
+                return pdbSymbol.RVA;
+            }
+
+            bestCandidate ??= pdbSymbol;
+        }
+
+        return bestCandidate?.RVA ?? UInt32.MaxValue;
+    }
+
+    public CompilandLanguage LanguageOfSymbolAtRva(uint rva)
+    {
+        ThrowIfOnWrongThread();
+
+        return this.PDBFile.TryFindModuleIndexContributingRVA(rva, out var moduleIndex)
+            ? this.PDBFile.GetCompilandDetails(ManagedPDBFile.CompilandSymIndexIdFromModuleIndex(moduleIndex)).Language
+            : CompilandLanguage.Unknown;
+    }
+
+    #endregion
+
+    #region Not supported by the managed reader
+
+    private static NotSupportedException NotSupportedByManagedReader(string operation)
+        => new NotSupportedException($"{operation} is not supported by the managed PDB reader.  Open the session with {nameof(PDBReader)}.{nameof(PDBReader.DIA)} to use this.");
+
+    public IEnumerable<SourceFile> FindSourceFiles(ILogger logger, CancellationToken token)
+        => throw NotSupportedByManagedReader("Finding source files");
+
+    public Dictionary<(SourceFile sourceFile, Compiland compiland), List<RVARange>> FindRVARangesForSourceFilesAndCompilands(IReadOnlyList<SourceFile> sourceFiles, ILogger logger, CancellationToken token)
+        => throw NotSupportedByManagedReader("Finding source files");
+
+    public IEnumerable<MemberDataSymbol> FindAllMemberDataSymbolsWithinUDT(UserDefinedTypeSymbol udt, CancellationToken cancellationToken)
+        => throw NotSupportedByManagedReader("Parsing types");
+
+    public IEnumerable<(uint typeId, uint offset)> FindAllBaseTypeIDsForUDT(UserDefinedTypeSymbol udt)
+        => throw NotSupportedByManagedReader("Parsing types");
+
+    public IEnumerable<IFunctionCodeSymbol> FindAllFunctionsWithinUDT(uint symIndexId, CancellationToken cancellationToken)
+        => throw NotSupportedByManagedReader("Parsing types");
+
+    public IEnumerable<IFunctionCodeSymbol> FindAllTemplatedFunctions(CancellationToken cancellationToken)
+        => throw NotSupportedByManagedReader("Finding templated functions");
+
+    public IEnumerable<UserDefinedTypeSymbol> FindAllUserDefinedTypes(ILogger logger, CancellationToken token)
+        => throw NotSupportedByManagedReader("Parsing types");
+
+    public IEnumerable<UserDefinedTypeSymbol> FindUserDefinedTypesByName(ILogger logger, string name, CancellationToken token)
+        => throw NotSupportedByManagedReader("Parsing types");
+
+    public HashSet<string>? FindNamesOfUserDefinedTypesWithVirtualFunctions(ILogger logger, CancellationToken token)
+        => throw NotSupportedByManagedReader("Parsing types");
+
+    public IEnumerable<AnnotationSymbol> FindAllAnnotations(ILogger parentLogger, CancellationToken token)
+        => throw NotSupportedByManagedReader("Finding annotations");
+
+    public byte FindCountOfVTablesWithin(uint symIndexId)
+        => throw NotSupportedByManagedReader("Parsing types");
+
+    public TSymbol FindTypeSymbolBySymIndexId<TSymbol>(uint symIndexId, CancellationToken cancellationToken) where TSymbol : TypeSymbol
+        => throw NotSupportedByManagedReader("Parsing types");
+
+    public List<InlineSiteSymbol>? FindAllInlineSitesForBlock(CodeBlockSymbol codeBlock, CancellationToken cancellationToken)
+        => throw NotSupportedByManagedReader("Finding inline sites");
+
+    public List<InlineSiteSymbol> FindAllInlineSites(CancellationToken cancellationToken)
+        => throw NotSupportedByManagedReader("Finding inline sites");
+
+    #endregion
+
+    #region IDisposable
+
+    private void ThrowIfDisposingOrDisposed() => ObjectDisposedException.ThrowIf(this.IsDisposing || this.IsDisposed, GetType().Name);
+
+    private bool IsDisposing;
+    private bool IsDisposed;
+
+    private void Dispose(bool disposing)
+    {
+        if (this.IsDisposing || this.IsDisposed)
+        {
+            return;
+        }
+
+        this.IsDisposing = true;
+
+        if (disposing)
+        {
+            this._pdbFile?.Dispose();
+            this._pdbFile = null;
+            this._cache = null;
+            this._session = null;
+            this._peFile = null;
+        }
+
+        this.IsDisposing = false;
+        this.IsDisposed = true;
+    }
+
+    public void Dispose()
+    {
+        Dispose(disposing: true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
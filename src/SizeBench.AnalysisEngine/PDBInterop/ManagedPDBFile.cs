@@ -0,0 +1,653 @@
+﻿using System.Diagnostics;
+using System.Runtime.InteropServices;
+using SizeBench.AnalysisEngine.DIAInterop;
+using SizeBench.AnalysisEngine.PE;
+
+namespace SizeBench.AnalysisEngine.PDBInterop;
+
+internal enum PDBSymbolKind
+{
+    Function,
+    Thunk,
+    Data,
+    PublicSymbol,
+}
+
+[DebuggerDisplay("PDBSymbol {Kind} {Name}, RVA=0x{RVA:X}, Length={Length}")]
+internal sealed class PDBSymbol
+{
+    public uint SymIndexId { get; }
+    public PDBSymbolKind Kind { get; }
+    public string Name { get; }
+    public uint RVA { get; }
+    public uint Length { get; internal set; }
+    public uint TypeIndex { get; }
+
+    // The symIndexId of the compiland this came from, or 0 if it came from the global symbol records stream.
+    public uint CompilandSymIndexId { get; }
+
+    // For static locals, the symIndexId of the function they're in - otherwise 0.
+    public uint ParentFunctionSymIndexId { get; }
+    public bool IsGlobal { get; }
+
+    // For PublicSymbols, whether the linker thinks this is in code (CVPSF_CODE) - used to honor SymbolSourcesSupported.
+    public bool IsCode { get; }
+
+    public PDBSymbol(uint symIndexId, PDBSymbolKind kind, string name, uint rva, uint length, uint typeIndex,
+                     uint compilandSymIndexId, uint parentFunctionSymIndexId, bool isGlobal, bool isCode)
+    {
+        this.SymIndexId = symIndexId;
+        this.Kind = kind;
+        this.Name = name;
+        this.RVA = rva;
+        this.Length = length;
+        this.TypeIndex = typeIndex;
+        this.CompilandSymIndexId = compilandSymIndexId;
+        this.ParentFunctionSymIndexId = parentFunctionSymIndexId;
+        this.IsGlobal = isGlobal;
+        this.IsCode = isCode;
+    }
+}
+
+internal sealed class PDBCompilandDetails
+{
+    public CompilandLanguage Language { get; init; } = CompilandLanguage.Unknown;
+    public string ToolName { get; init; } = String.Empty;
+    public Version FrontEndVersion { get; init; } = new Version(0, 0);
+    public Version BackEndVersion { get; init; } = new Version(0, 0);
+    public string CommandLine { get; set; } = String.Empty;
+}
+
+internal readonly record struct PDBCOFFGroup(string Name, uint RVA, uint Length, uint Characteristics);
+
+internal readonly record struct PDBSectionContributionRange(uint RVA, uint Size, int ModuleIndex);
+
+// This ties together all the individual stream readers to produce the flat model of a PDB that the ManagedPDBAdapter works from.
+// Symbol records are walked exactly once up-front, and everything SizeBench needs is pulled out of them into plain objects, so that
+// later queries are simple lookups rather than re-walks of the streams - and the lookups that are asked for over and over (by RVA, by
+// name, by compiland) have an index built for them once, so that none of them have to scan every symbol.
+//
+// Nothing in this layer (this class, the stream readers, and SpanReader) calls into the OS beyond reading the file, so it parses PDBs
+// the same on any platform - it's the ManagedPDBAdapter and the Session around it that are still Windows-only.
+//
+// SymIndexIds are synthesized here to mimic DIA: compilands are numbered 1..N in DBI module order, and symbols are numbered
+// after that in the order they're discovered.  They're stable for a given PDB, which is all SizeBench needs from them.
+internal sealed class ManagedPDBFile : IDisposable
+{
+    public const string LinkerModuleName = "* Linker *";
+
+    private MSFFile? _msf;
+    private readonly IMAGE_SECTION_HEADER[] _sectionHeaders;
+    private readonly List<PDBSymbol> _symbols = new List<PDBSymbol>(capacity: 10_000);
+    private readonly Dictionary<string, uint> _absolutePublicSymbolValues = new Dictionary<string, uint>(StringComparer.Ordinal);
+    private readonly HashSet<uint> _rvasOfLabels = new HashSet<uint>();
+    private readonly HashSet<(uint rva, string name)> _dataSymbolsSeen = new HashSet<(uint rva, string name)>();
+    private readonly List<PDBCOFFGroup> _coffGroups = new List<PDBCOFFGroup>(capacity: 100);
+    private readonly PDBCompilandDetails[] _compilandDetails;
+    private readonly List<PDBSymbol>[] _dataSymbolsByModuleIndex;
+
+    // Every symbol sorted by RVA (ties stay in SymIndexId order), and alongside it the highest end RVA of any symbol at or before each
+    // index - that's what lets a "nearest symbol" search stop walking backwards as soon as nothing further back could cover the RVA.
+    private PDBSymbol[] _symbolsByRVA = Array.Empty<PDBSymbol>();
+    private uint[] _maxEndRVAThroughIndex = Array.Empty<uint>();
+
+    // These are only needed by a few less common queries, so they're built the first time they're asked for.
+    private Dictionary<string, List<PDBSymbol>>? _symbolsByName;
+    private PDBSectionContributionRange[]? _sectionContributionsByRVA;
+
+    public PDBInfoStream InfoStream { get; }
+    public DBIStream DBI { get; }
+    public TPIStream TPI { get; }
+
+    public IReadOnlyList<PDBSymbol> Symbols => this._symbols;
+    public IReadOnlySet<uint> RVAsOfLabels => this._rvasOfLabels;
+    public IReadOnlyList<PDBCOFFGroup> COFFGroups => this._coffGroups;
+    public IReadOnlyList<IMAGE_SECTION_HEADER> SectionHeaders => this._sectionHeaders;
+    public bool HasLinkerModule { get; }
+
+    public ManagedPDBFile(string pdbPath)
+    {
+        this._msf = new MSFFile(pdbPath);
+
+        try
+        {
+            this.InfoStream = new PDBInfoStream(this._msf);
+            this.DBI = new DBIStream(this._msf);
+            this.TPI = new TPIStream(this._msf);
+            this._sectionHeaders = ReadSectionHeaders(this._msf, this.DBI.SectionHeaderStreamIndex);
+            this._compilandDetails = new PDBCompilandDetails[this.DBI.Modules.Count];
+            this._dataSymbolsByModuleIndex = new List<PDBSymbol>[this.DBI.Modules.Count];
+
+            for (var moduleIndex = 0; moduleIndex < this.DBI.Modules.Count; moduleIndex++)
+            {
+                var module = this.DBI.Modules[moduleIndex];
+                this.HasLinkerModule |= module.ModuleName == LinkerModuleName;
+                this._dataSymbolsByModuleIndex[moduleIndex] = new List<PDBSymbol>();
+                this._compilandDetails[moduleIndex] = ParseModuleSymbols(module, CompilandSymIndexIdFromModuleIndex(moduleIndex));
+            }
+
+            ParseGlobalSymbolRecords();
+            ComputePublicSymbolLengths();
+            BuildRVAIndex();
+        }
+        catch (ArgumentOutOfRangeException ex)
+        {
+            // SpanReader throws this when a record is too short for the fields its kind must have.
+            this._msf.Dispose();
+            this._msf = null;
+            throw new PDBNotSuitableForAnalysisException("The PDB has a symbol record that is shorter than its kind requires, this PDB may be corrupt.", ex);
+        }
+        catch
+        {
+            this._msf.Dispose();
+            this._msf = null;
+            throw;
+        }
+    }
+
+    public static uint CompilandSymIndexIdFromModuleIndex(int moduleIndex) => (uint)moduleIndex + 1;
+    public static int ModuleIndexFromCompilandSymIndexId(uint compilandSymIndexId) => (int)compilandSymIndexId - 1;
+    public bool IsCompilandSymIndexId(uint symIndexId) => symIndexId >= 1 && symIndexId <= this.DBI.Modules.Count;
+
+    public PDBCompilandDetails GetCompilandDetails(uint compilandSymIndexId) => this._compilandDetails[ModuleIndexFromCompilandSymIndexId(compilandSymIndexId)];
+
+    public PDBSymbol GetSymbol(uint symIndexId) => this._symbols[(int)(symIndexId - this.DBI.Modules.Count - 1)];
+
+    public bool TryGetSymbol(uint symIndexId, out PDBSymbol symbol)
+    {
+        var index = (long)symIndexId - this.DBI.Modules.Count - 1;
+        if (index < 0 || index >= this._symbols.Count)
+        {
+            symbol = null!;
+            return false;
+        }
+
+        symbol = this._symbols[(int)index];
+        return true;
+    }
+
+    // The data symbols that came from this compiland's module stream, in the order they appear there.  Globals that only appear in the
+    // global symbol records stream don't belong to any compiland, so they're never in here.
+    public IReadOnlyList<PDBSymbol> GetDataSymbolsInCompiland(uint compilandSymIndexId)
+        => IsCompilandSymIndexId(compilandSymIndexId) ? this._dataSymbolsByModuleIndex[ModuleIndexFromCompilandSymIndexId(compilandSymIndexId)] : Array.Empty<PDBSymbol>();
+
+    // Some linker-generated symbols are "absolute" - they don't live at an address, their value *is* the data, like __guard_fids_count.
+    public bool TryGetAbsolutePublicSymbolValue(string name, out uint value) => this._absolutePublicSymbolValues.TryGetValue(name, out value);
+
+    private bool TryGetRVA(ushort segment, uint offset, out uint rva)
+    {
+        if (segment == 0 || segment > this._sectionHeaders.Length)
+        {
+            rva = 0;
+            return false;
+        }
+
+        rva = this._sectionHeaders[segment - 1].VirtualAddress + offset;
+        return true;
+    }
+
+    private uint NextSymIndexId => (uint)(this.DBI.Modules.Count + this._symbols.Count + 1);
+
+    #region Module symbol streams
+
+    private PDBCompilandDetails ParseModuleSymbols(PDBModuleInfo module, uint compilandSymIndexId)
+    {
+        var details = new PDBCompilandDetails();
+
+        if (!this._msf!.StreamExists(module.SymbolStreamIndex))
+        {
+            return details;
+        }
+
+        var stream = this._msf.ReadStream(module.SymbolStreamIndex);
+        var symbolBytes = stream.AsSpan(0, (int)Math.Min(module.SymbolByteSize, (uint)stream.Length));
+        var isLinkerModule = module.ModuleName == LinkerModuleName;
+
+        // Each scope-opening record (procedures, blocks, thunks, inline sites) pushes onto this stack and is popped by the matching
+        // S_END.  We only need to know the innermost enclosing *function*, so that's what gets pushed (or 0 for non-function scopes
+        // at module level).
+        var scopeStack = new Stack<uint>();
+        var commandLine = String.Empty;
+
+        // The first 4 bytes are the CodeView signature (CV_SIGNATURE_C13), the records start after that.
+        foreach (var record in new CodeViewSymbolRecordEnumerator(symbolBytes, startOffset: sizeof(uint)))
+        {
+            var reader = record.CreateReader();
+            var enclosingFunction = scopeStack.Count > 0 ? scopeStack.Peek() : 0u;
+
+            switch (record.Kind)
+            {
+                case CodeViewSymbolKind.S_COMPILE3:
+                {
+                    var flags = reader.ReadUInt32();
+                    reader.Skip(sizeof(ushort)); // Machine
+                    var frontEndVersion = new Version(reader.ReadUInt16(), reader.ReadUInt16(), reader.ReadUInt16(), reader.ReadUInt16());
+                    var backEndVersion = new Version(reader.ReadUInt16(), reader.ReadUInt16(), reader.ReadUInt16(), reader.ReadUInt16());
+                    details = CreateCompilandDetails(flags, frontEndVersion, backEndVersion, reader.ReadNullTerminatedString());
+                    break;
+                }
+                case CodeViewSymbolKind.S_COMPILE2:
+                {
+                    var flags = reader.ReadUInt32();
+                    reader.Skip(sizeof(ushort)); // Machine
+                    var frontEndVersion = new Version(reader.ReadUInt16(), reader.ReadUInt16(), reader.ReadUInt16(), 0);
+                    var backEndVersion = new Version(reader.ReadUInt16(), reader.ReadUInt16(), reader.ReadUInt16(), 0);
+                    details = CreateCompilandDetails(flags, frontEndVersion, backEndVersion, reader.ReadNullTerminatedString());
+                    break;
+                }
+                case CodeViewSymbolKind.S_ENVBLOCK:
+                {
+                    reader.Skip(sizeof(byte)); // Flags
+                    while (reader.BytesRemaining > 0)
+                    {
+                        var key = reader.ReadNullTerminatedString();
+                        if (key.Length == 0)
+                        {
+                            break;
+                        }
+
+                        var value = reader.ReadNullTerminatedString();
+                        if (key == "cmd")
+                        {
+                            commandLine = value;
+                        }
+                    }
+                    break;
+                }
+                case CodeViewSymbolKind.S_COFFGROUP:
+                {
+                    var length = reader.ReadUInt32();
+                    var characteristics = reader.ReadUInt32();
+                    var offset = reader.ReadUInt32();
+                    var segment = reader.ReadUInt16();
+                    var name = reader.ReadNullTerminatedString();
+
+                    // Length of a COFF Group can be 0 legitimately (like an empty .edata), but we don't want to track those since they can share
+                    // an RVA with a "real" COFF Group and that's confusing - this mirrors what the DIA-based reader does.
+                    if (isLinkerModule && length > 0 && TryGetRVA(segment, offset, out var rva))
+                    {
+                        this._coffGroups.Add(new PDBCOFFGroup(name, rva, length, characteristics));
+                    }
+                    break;
+                }
+                case CodeViewSymbolKind.S_GPROC32:
+                case CodeViewSymbolKind.S_LPROC32:
+                case CodeViewSymbolKind.S_GPROC32_ID:
+                case CodeViewSymbolKind.S_LPROC32_ID:
+                {
+                    reader.Skip(sizeof(uint) * 3); // Parent, End, Next
+                    var length = reader.ReadUInt32();
+                    reader.Skip(sizeof(uint) * 2); // DbgStart, DbgEnd
+                    var typeIndex = reader.ReadUInt32();
+                    var offset = reader.ReadUInt32();
+                    var segment = reader.ReadUInt16();
+                    reader.Skip(sizeof(byte)); // Flags
+                    var name = reader.ReadNullTerminatedString();
+
+                    var functionSymIndexId = 0u;
+                    if (TryGetRVA(segment, offset, out var rva))
+                    {
+                        functionSymIndexId = NextSymIndexId;
+                        var isGlobal = record.Kind is CodeViewSymbolKind.S_GPROC32 or CodeViewSymbolKind.S_GPROC32_ID;
+                        this._symbols.Add(new PDBSymbol(functionSymIndexId, PDBSymbolKind.Function, name, rva, length, typeIndex,
+                                                        compilandSymIndexId, parentFunctionSymIndexId: 0, isGlobal, isCode: true));
+                    }
+
+                    scopeStack.Push(functionSymIndexId);
+                    break;
+                }
+                case CodeViewSymbolKind.S_THUNK32:
+                {
+                    reader.Skip(sizeof(uint) * 3); // Parent, End, Next
+                    var offset = reader.ReadUInt32();
+                    var segment = reader.ReadUInt16();
+                    var length = reader.ReadUInt16();
+                    reader.Skip(sizeof(byte)); // Ordinal
+                    var name = reader.ReadNullTerminatedString();
+
+                    if (TryGetRVA(segment, offset, out var rva))
+                    {
+                        this._symbols.Add(new PDBSymbol(NextSymIndexId, PDBSymbolKind.Thunk, name, rva, length, typeIndex: 0,
+                                                        compilandSymIndexId, parentFunctionSymIndexId: 0, isGlobal: false, isCode: true));
+                    }
+
+                    scopeStack.Push(enclosingFunction);
+                    break;
+                }
+                case CodeViewSymbolKind.S_BLOCK32:
+                case CodeViewSymbolKind.S_SEPCODE:
+                case CodeViewSymbolKind.S_INLINESITE:
+                    scopeStack.Push(enclosingFunction);
+                    break;
+                case CodeViewSymbolKind.S_END:
+                case CodeViewSymbolKind.S_PROC_ID_END:
+                case CodeViewSymbolKind.S_INLINESITE_END:
+                    if (scopeStack.Count > 0)
+                    {
+                        scopeStack.Pop();
+                    }
+                    break;
+                case CodeViewSymbolKind.S_LABEL32:
+                {
+                    var offset = reader.ReadUInt32();
+                    var segment = reader.ReadUInt16();
+                    if (TryGetRVA(segment, offset, out var rva) && rva != 0)
+                    {
+                        this._rvasOfLabels.Add(rva);
+                    }
+                    break;
+                }
+                case CodeViewSymbolKind.S_GDATA32:
+                case CodeViewSymbolKind.S_LDATA32:
+                    ParseDataSymbol(ref reader, record.Kind == CodeViewSymbolKind.S_GDATA32, compilandSymIndexId, enclosingFunction);
+                    break;
+            }
+        }
+
+        details.CommandLine = commandLine;
+        return details;
+    }
+
+    private static PDBCompilandDetails CreateCompilandDetails(uint flags, Version frontEndVersion, Version backEndVersion, string toolName)
+    {
+        var language = (CompilandLanguage)(flags & 0xFF);
+
+        if (language == CompilandLanguage.CV_CFL_C &&
+            toolName.StartsWith("zig", StringComparison.Ordinal))
+        {
+            language = CompilandLanguage.SizeBench_Zig;
+        }
+
+        return new PDBCompilandDetails()
+        {
+            Language = language,
+            ToolName = toolName,
+            FrontEndVersion = frontEndVersion,
+            BackEndVersion = backEndVersion,
+        };
+    }
+
+    private void ParseDataSymbol(ref SpanReader reader, bool isGlobal, uint compilandSymIndexId, uint parentFunctionSymIndexId)
+    {
+        var typeIndex = reader.ReadUInt32();
+        var offset = reader.ReadUInt32();
+        var segment = reader.ReadUInt16();
+        var name = reader.ReadNullTerminatedString();
+
+        // Globals can appear both in a module's stream and in the global symbol records, and we only want each once.
+        if (TryGetRVA(segment, offset, out var rva) && this._dataSymbolsSeen.Add((rva, name)))
+        {
+            var symbol = new PDBSymbol(NextSymIndexId, PDBSymbolKind.Data, name, rva, length: 0, typeIndex,
+                                       compilandSymIndexId, parentFunctionSymIndexId, isGlobal, isCode: false);
+            this._symbols.Add(symbol);
+
+            if (compilandSymIndexId != 0)
+            {
+                this._dataSymbolsByModuleIndex[ModuleIndexFromCompilandSymIndexId(compilandSymIndexId)].Add(symbol);
+            }
+        }
+    }
+
+    #endregion
+
+    #region Global symbol records
+
+    private void ParseGlobalSymbolRecords()
+    {
+        if (!this._msf!.StreamExists(this.DBI.SymbolRecordStreamIndex))
+        {
+            return;
+        }
+
+        var stream = this._msf.ReadStream(this.DBI.SymbolRecordStreamIndex);
+
+        foreach (var record in new CodeViewSymbolRecordEnumerator(stream, startOffset: 0))
+        {
+            var reader = record.CreateReader();
+
+            switch (record.Kind)
+            {
+                case CodeViewSymbolKind.S_PUB32:
+                {
+                    var flags = reader.ReadUInt32();
+                    var offset = reader.ReadUInt32();
+                    var segment = reader.ReadUInt16();
+                    var name = reader.ReadNullTerminatedString();
+
+                    if (segment == 0)
+                    {
+                        this._absolutePublicSymbolValues.TryAdd(name, offset);
+                    }
+                    else if (TryGetRVA(segment, offset, out var rva))
+                    {
+                        const uint CVPSF_CODE = 0x1;
+                        this._symbols.Add(new PDBSymbol(NextSymIndexId, PDBSymbolKind.PublicSymbol, name, rva, length: 0, typeIndex: 0,
+                                                        compilandSymIndexId: 0, parentFunctionSymIndexId: 0, isGlobal: true, isCode: (flags & CVPSF_CODE) != 0));
+                    }
+                    break;
+                }
+                case CodeViewSymbolKind.S_GDATA32:
+                case CodeViewSymbolKind.S_LDATA32:
+                    ParseDataSymbol(ref reader, record.Kind == CodeViewSymbolKind.S_GDATA32, compilandSymIndexId: 0, parentFunctionSymIndexId: 0);
+                    break;
+            }
+        }
+    }
+
+    // Public symbols don't record their length, so like DIA we infer it as the distance to the next thing we know starts at a higher RVA
+    // in the same section (or to the end of the section).
+    private void ComputePublicSymbolLengths()
+    {
+        var starts = new List<uint>(capacity: this._symbols.Count + this._sectionHeaders.Length);
+        foreach (var symbol in this._symbols)
+        {
+            starts.Add(symbol.RVA);
+        }
+
+        foreach (var section in this._sectionHeaders)
+        {
+            starts.Add(section.VirtualAddress + section.VirtualSize);
+        }
+
+        starts.Sort();
+
+        var startsSpan = CollectionsMarshal.AsSpan(starts);
+        foreach (var symbol in this._symbols)
+        {
+            if (symbol.Kind != PDBSymbolKind.PublicSymbol)
+            {
+                continue;
+            }
+
+            // Find the first start strictly greater than this symbol's RVA - if RVA+1 is itself a start, any match is as good as another.
+            var index = startsSpan.BinarySearch(symbol.RVA + 1);
+            if (index < 0)
+            {
+                index = ~index;
+            }
+
+            if (index < startsSpan.Length)
+            {
+                symbol.Length = startsSpan[index] - symbol.RVA;
+            }
+        }
+    }
+
+    #endregion
+
+    #region Indexed lookups
+
+    private void BuildRVAIndex()
+    {
+        // _symbols is already in SymIndexId order, and a stable sort keeps it that way within each RVA.
+        this._symbolsByRVA = this._symbols.OrderBy(static s => s.RVA).ToArray();
+        this._maxEndRVAThroughIndex = new uint[this._symbolsByRVA.Length];
+
+        var maxEndRVA = 0u;
+        for (var i = 0; i < this._symbolsByRVA.Length; i++)
+        {
+            maxEndRVA = Math.Max(maxEndRVA, this._symbolsByRVA[i].RVA + this._symbolsByRVA[i].Length);
+            this._maxEndRVAThroughIndex[i] = maxEndRVA;
+        }
+    }
+
+    // The index of the first symbol in _symbolsByRVA whose RVA is >= rva, or the length of the array if there isn't one.
+    private int LowerBoundInSymbolsByRVA(uint rva)
+    {
+        int low = 0, high = this._symbolsByRVA.Length;
+        while (low < high)
+        {
+            var mid = low + ((high - low) / 2);
+            if (this._symbolsByRVA[mid].RVA < rva)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+
+        return low;
+    }
+
+    // Like DIA's findSymbolByRVA, an exact match is preferred, and failing that the closest symbol that starts before the RVA and covers it.
+    public PDBSymbol? FindSymbolByRVA(uint rva, bool allowFindingNearest)
+    {
+        var firstAtOrAfter = LowerBoundInSymbolsByRVA(rva);
+
+        PDBSymbol? exactPublicSymbol = null;
+        for (var i = firstAtOrAfter; i < this._symbolsByRVA.Length && this._symbolsByRVA[i].RVA == rva; i++)
+        {
+            // Public symbols are the least descriptive, so keep looking for something better at the same RVA.
+            if (this._symbolsByRVA[i].Kind != PDBSymbolKind.PublicSymbol)
+            {
+                return this._symbolsByRVA[i];
+            }
+
+            exactPublicSymbol = this._symbolsByRVA[i];
+        }
+
+        if (exactPublicSymbol != null || !allowFindingNearest)
+        {
+            return exactPublicSymbol;
+        }
+
+        // Walk backwards from the closest start below the RVA - within one RVA the first symbol (in SymIndexId order) that covers it wins,
+        // and once nothing at or before an index ends past the RVA, nothing further back can cover it either.
+        PDBSymbol? nearest = null;
+        for (var i = firstAtOrAfter - 1; i >= 0 && this._maxEndRVAThroughIndex[i] > rva; i--)
+        {
+            var candidate = this._symbolsByRVA[i];
+            if (nearest != null && candidate.RVA != nearest.RVA)
+            {
+                break;
+            }
+
+            if (rva < candidate.RVA + candidate.Length)
+            {
+                nearest = candidate;
+            }
+        }
+
+        return nearest;
+    }
+
+    // Every symbol with exactly this name, in SymIndexId order.
+    public IReadOnlyList<PDBSymbol> FindSymbolsByName(string name)
+    {
+        if (this._symbolsByName is null)
+        {
+            var symbolsByName = new Dictionary<string, List<PDBSymbol>>(capacity: this._symbols.Count, StringComparer.Ordinal);
+            foreach (var symbol in this._symbols)
+            {
+                ref var list = ref CollectionsMarshal.GetValueRefOrAddDefault(symbolsByName, symbol.Name, out _);
+                list ??= new List<PDBSymbol>(capacity: 1);
+                list.Add(symbol);
+            }
+
+            this._symbolsByName = symbolsByName;
+        }
+
+        return this._symbolsByName.TryGetValue(name, out var symbols) ? symbols : Array.Empty<PDBSymbol>();
+    }
+
+    // Which module contributed the bytes at this RVA, going by the DBI section contributions.
+    public bool TryFindModuleIndexContributingRVA(uint rva, out int moduleIndex)
+    {
+        var contributions = this._sectionContributionsByRVA ??= BuildSectionContributionsByRVA();
+
+        // Find the last contribution starting at or before the RVA - contributions don't overlap, but empty ones can share a start with a
+        // real one, so look back through any others that start at the same place too.
+        int low = 0, high = contributions.Length;
+        while (low < high)
+        {
+            var mid = low + ((high - low) / 2);
+            if (contributions[mid].RVA <= rva)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+
+        for (var i = low - 1; i >= 0 && contributions[i].RVA == contributions[low - 1].RVA; i--)
+        {
+            if (rva < contributions[i].RVA + contributions[i].Size)
+            {
+                moduleIndex = contributions[i].ModuleIndex;
+                return true;
+            }
+        }
+
+        moduleIndex = -1;
+        return false;
+    }
+
+    private PDBSectionContributionRange[] BuildSectionContributionsByRVA()
+    {
+        var ranges = new List<PDBSectionContributionRange>(capacity: this.DBI.SectionContributions.Count);
+        foreach (var sc in this.DBI.SectionContributions)
+        {
+            if (sc.Section < 1 || sc.Section > this._sectionHeaders.Length || sc.ModuleIndex >= this.DBI.Modules.Count)
+            {
+                continue;
+            }
+
+            ranges.Add(new PDBSectionContributionRange(this._sectionHeaders[sc.Section - 1].VirtualAddress + sc.Offset, sc.Size, sc.ModuleIndex));
+        }
+
+        // Stable, so that if two ever did overlap the one listed first in the DBI stream would still win, as it would with a linear scan.
+        return ranges.OrderBy(static r => r.RVA).ToArray();
+    }
+
+    #endregion
+
+    private static IMAGE_SECTION_HEADER[] ReadSectionHeaders(MSFFile msf, ushort sectionHeaderStreamIndex)
+    {
+        var data = msf.ReadStream(sectionHeaderStreamIndex);
+        var sizeOfOneHeader = Marshal.SizeOf<IMAGE_SECTION_HEADER>();
+        var headers = new IMAGE_SECTION_HEADER[data.Length / sizeOfOneHeader];
+
+        unsafe
+        {
+            fixed (byte* bp = data)
+            {
+                for (var i = 0; i < headers.Length; i++)
+                {
+                    headers[i] = Marshal.PtrToStructure<IMAGE_SECTION_HEADER>((IntPtr)(bp + (i * sizeOfOneHeader)));
+                }
+            }
+        }
+
+        return headers;
+    }
+
+    public void Dispose()
+    {
+        this._msf?.Dispose();
+        this._msf = null;
+    }
+}
@@ -0,0 +1,26 @@
+﻿namespace SizeBench.AnalysisEngine.PDBInterop;
+
+// Stream 1 of every PDB - this holds the identity of the PDB (the GUID and age that a binary's debug directory must match).
+internal sealed class PDBInfoStream
+{
+    public const ushort StreamIndex = 1;
+
+    public uint Version { get; }
+    public Guid Guid { get; }
+    public uint Age { get; }
+
+    public PDBInfoStream(MSFFile msf)
+    {
+        var data = msf.ReadStream(StreamIndex);
+        if (data.Length < 28)
+        {
+            throw new PDBNotSuitableForAnalysisException("The PDB info stream is missing or truncated, this PDB may be corrupt.");
+        }
+
+        var reader = new SpanReader(data);
+        this.Version = reader.ReadUInt32();
+        reader.Skip(sizeof(uint)); // Signature - a timestamp that nothing uses anymore, the Guid superseded it long ago.
+        this.Age = reader.ReadUInt32();
+        this.Guid = reader.ReadGuid();
+    }
+}
@@ -0,0 +1,113 @@
+﻿using System.Buffers.Binary;
+using System.Text;
+
+namespace SizeBench.AnalysisEngine.PDBInterop;
+
+// A small forward-only cursor over little-endian PDB data.  Everything in a PDB is little-endian regardless of the target machine,
+// so there's no need to ever consider the other byte order.
+internal ref struct SpanReader
+{
+    private readonly ReadOnlySpan<byte> _data;
+
+    public int Position { get; set; }
+
+    public SpanReader(ReadOnlySpan<byte> data)
+    {
+        this._data = data;
+        this.Position = 0;
+    }
+
+    public readonly int Length => this._data.Length;
+    public readonly int BytesRemaining => this._data.Length - this.Position;
+
+    public byte ReadByte() => this._data[this.Position++];
+
+    public ushort ReadUInt16()
+    {
+        var value = BinaryPrimitives.ReadUInt16LittleEndian(this._data[this.Position..]);
+        this.Position += sizeof(ushort);
+        return value;
+    }
+
+    public short ReadInt16() => (short)ReadUInt16();
+
+    public uint ReadUInt32()
+    {
+        var value = BinaryPrimitives.ReadUInt32LittleEndian(this._data[this.Position..]);
+        this.Position += sizeof(uint);
+        return value;
+    }
+
+    public int ReadInt32() => (int)ReadUInt32();
+
+    public ulong ReadUInt64()
+    {
+        var value = BinaryPrimitives.ReadUInt64LittleEndian(this._data[this.Position..]);
+        this.Position += sizeof(ulong);
+        return value;
+    }
+
+    public Guid ReadGuid()
+    {
+        var value = new Guid(this._data.Slice(this.Position, 16));
+        this.Position += 16;
+        return value;
+    }
+
+    public ReadOnlySpan<byte> ReadBytes(int count)
+    {
+        var value = this._data.Slice(this.Position, count);
+        this.Position += count;
+        return value;
+    }
+
+    public void Skip(int count) => this.Position += count;
+
+    public void AlignTo(int alignment) => this.Position = (this.Position + alignment - 1) & ~(alignment - 1);
+
+    // Reads a null-terminated UTF-8 string, as used by every modern (post-VC 7.0) CodeView record.  If the data runs out before a
+    // terminator is found, whatever remains is treated as the string, as some records are padded out and some are not.
+    public string ReadNullTerminatedString()
+    {
+        var remaining = this._data[this.Position..];
+        var terminator = remaining.IndexOf((byte)0);
+        if (terminator < 0)
+        {
+            this.Position = this._data.Length;
+            return Encoding.UTF8.GetString(remaining);
+        }
+
+        this.Position += terminator + 1;
+        return Encoding.UTF8.GetString(remaining[..terminator]);
+    }
+
+    // CodeView "numeric leaves" store small values inline, and larger values as a leaf kind followed by the value.
+    public ulong ReadNumericLeaf()
+    {
+        var leaf = ReadUInt16();
+        if (leaf < LF_NUMERIC)
+        {
+            return leaf;
+        }
+
+        return leaf switch
+        {
+            LF_CHAR => (ulong)(sbyte)ReadByte(),
+            LF_SHORT => (ulong)ReadInt16(),
+            LF_USHORT => ReadUInt16(),
+            LF_LONG => (ulong)ReadInt32(),
+            LF_ULONG => ReadUInt32(),
+            LF_QUADWORD or LF_UQUADWORD => ReadUInt64(),
+            _ => throw new InvalidOperationException($"Unsupported CodeView numeric leaf 0x{leaf:X}.  This is a bug in SizeBench's implementation, not your usage of it.")
+        };
+    }
+
+    private const ushort LF_NUMERIC = 0x8000;
+    private const ushort LF_CHAR = 0x8000;
+    private const ushort LF_SHORT = 0x8001;
+    private const ushort LF_USHORT = 0x8002;
+    private const ushort LF_LONG = 0x8003;
+    private const ushort LF_ULONG = 0x8004;
+    private const ushort LF_QUADWORD = 0x8009;
+    private const ushort LF_UQUADWORD = 0x800A;
+}
@@ -0,0 +1,222 @@
+﻿namespace SizeBench.AnalysisEngine.PDBInterop;
+
+// Stream 2 of every PDB - the type records.  SizeBench's managed reader only needs to answer "how many bytes is this type?" so
+// that data symbols can be sized, so this is a deliberately small subset of the full type system: it doesn't construct any
+// TypeSymbols, it just indexes the records well enough to compute sizes (including resolving forward references to their
+// definitions, since a global of type "struct Foo" usually refers to the forward-declared record).
+internal sealed class TPIStream
+{
+    public const ushort StreamIndex = 2;
+
+    private const ushort LF_MODIFIER = 0x1001;
+    private const ushort LF_POINTER = 0x1002;
+    private const ushort LF_PROCEDURE = 0x1008;
+    private const ushort LF_MFUNCTION = 0x1009;
+    private const ushort LF_ARRAY = 0x1503;
+    private const ushort LF_CLASS = 0x1504;
+    private const ushort LF_STRUCTURE = 0x1505;
+    private const ushort LF_UNION = 0x1506;
+    private const ushort LF_ENUM = 0x1507;
+    private const ushort LF_INTERFACE = 0x1519;
+
+    private const ushort PropertyForwardRef = 0x0080;
+    private const ushort PropertyHasUniqueName = 0x0200;
+
+    private readonly byte[] _data;
+    private readonly uint _typeIndexBegin;
+    private readonly int[] _recordOffsets;
+    private readonly Dictionary<string, uint> _definitionsByName = new Dictionary<string, uint>(StringComparer.Ordinal);
+    private readonly Dictionary<uint, uint> _sizeCache = new Dictionary<uint, uint>();
+
+    public TPIStream(MSFFile msf)
+    {
+        this._data = msf.ReadStream(StreamIndex);
+        if (this._data.Length < 56)
+        {
+            this._recordOffsets = [];
+            return;
+        }
+
+        var reader = new SpanReader(this._data);
+        reader.Skip(sizeof(uint)); // Version
+        var headerSize = reader.ReadUInt32();
+        this._typeIndexBegin = reader.ReadUInt32();
+        var typeIndexEnd = reader.ReadUInt32();
+        var typeRecordBytes = reader.ReadUInt32();
+
+        this._recordOffsets = new int[typeIndexEnd - this._typeIndexBegin];
+        reader.Position = (int)headerSize;
+        var end = (int)Math.Min(headerSize + typeRecordBytes, (uint)this._data.Length);
+
+        for (var i = 0; i < this._recordOffsets.Length && reader.Position + 4 <= end; i++)
+        {
+            this._recordOffsets[i] = reader.Position;
+            var recordLength = reader.ReadUInt16();
+            var leaf = reader.ReadUInt16();
+
+            if (leaf is LF_CLASS or LF_STRUCTURE or LF_UNION or LF_ENUM or LF_INTERFACE)
+            {
+                IndexDefinitionIfNotForwardRef(this._recordOffsets[i], this._typeIndexBegin + (uint)i);
+            }
+
+            reader.Position = this._recordOffsets[i] + sizeof(ushort) + recordLength;
+        }
+    }
+
+    public uint GetTypeSize(uint typeIndex)
+    {
+        if (typeIndex < this._typeIndexBegin)
+        {
+            return GetSimpleTypeSize(typeIndex);
+        }
+
+        if (this._sizeCache.TryGetValue(typeIndex, out var cachedSize))
+        {
+            return cachedSize;
+        }
+
+        // Seed the cache before recursing so that a malformed cycle in the type graph terminates with a size of 0 instead of a stack overflow.
+        this._sizeCache[typeIndex] = 0;
+        var size = ComputeTypeSize(typeIndex);
+        this._sizeCache[typeIndex] = size;
+        return size;
+    }
+
+    private uint ComputeTypeSize(uint typeIndex)
+    {
+        var recordIndex = typeIndex - this._typeIndexBegin;
+        if (recordIndex >= this._recordOffsets.Length)
+        {
+            return 0;
+        }
+
+        var reader = new SpanReader(this._data);
+        reader.Position = this._recordOffsets[recordIndex];
+        reader.Skip(sizeof(ushort)); // Record length
+        var leaf = reader.ReadUInt16();
+
+        switch (leaf)
+        {
+            case LF_MODIFIER:
+                return GetTypeSize(reader.ReadUInt32());
+            case LF_POINTER:
+            {
+                reader.Skip(sizeof(uint)); // Pointee type
+                var attributes = reader.ReadUInt32();
+                return (attributes >> 13) & 0x3F;
+            }
+            case LF_ARRAY:
+                reader.Skip(sizeof(uint) * 2); // Element type and index type
+                return (uint)reader.ReadNumericLeaf();
+            case LF_CLASS:
+            case LF_STRUCTURE:
+            case LF_INTERFACE:
+            {
+                reader.Skip(sizeof(ushort)); // Count
+                var properties = reader.ReadUInt16();
+                reader.Skip(sizeof(uint) * 3); // Field list, derived from, vshape
+                var size = (uint)reader.ReadNumericLeaf();
+                return (properties & PropertyForwardRef) != 0 ? ResolveForwardRefSize(ref reader, properties) : size;
+            }
+            case LF_UNION:
+            {
+                reader.Skip(sizeof(ushort)); // Count
+                var properties = reader.ReadUInt16();
+                reader.Skip(sizeof(uint)); // Field list
+                var size = (uint)reader.ReadNumericLeaf();
+                return (properties & PropertyForwardRef) != 0 ? ResolveForwardRefSize(ref reader, properties) : size;
+            }
+            case LF_ENUM:
+            {
+                reader.Skip(sizeof(ushort)); // Count
+                reader.Skip(sizeof(ushort)); // Properties
+                return GetTypeSize(reader.ReadUInt32());
+            }
+            case LF_PROCEDURE:
+            case LF_MFUNCTION:
+            default:
+                return 0;
+        }
+    }
+
+    private uint ResolveForwardRefSize(ref SpanReader reader, ushort properties)
+    {
+        var name = reader.ReadNullTerminatedString();
+        if ((properties & PropertyHasUniqueName) != 0)
+        {
+            name = reader.ReadNullTerminatedString();
+        }
+
+        return this._definitionsByName.TryGetValue(name, out var definitionTypeIndex) ? GetTypeSize(definitionTypeIndex) : 0;
+    }
+
+    private void IndexDefinitionIfNotForwardRef(int recordOffset, uint typeIndex)
+    {
+        var reader = new SpanReader(this._data);
+        reader.Position = recordOffset + sizeof(ushort);
+        var leaf = reader.ReadUInt16();
+        reader.Skip(sizeof(ushort)); // Count
+        var properties = reader.ReadUInt16();
+
+        if ((properties & PropertyForwardRef) != 0)
+        {
+            return;
+        }
+
+        switch (leaf)
+        {
+            case LF_CLASS:
+            case LF_STRUCTURE:
+            case LF_INTERFACE:
+                reader.Skip(sizeof(uint) * 3);
+                reader.ReadNumericLeaf();
+                break;
+            case LF_UNION:
+                reader.Skip(sizeof(uint));
+                reader.ReadNumericLeaf();
+                break;
+            case LF_ENUM:
+                reader.Skip(sizeof(uint) * 2);
+                break;
+        }
+
+        var name = reader.ReadNullTerminatedString();
+        if ((properties & PropertyHasUniqueName) != 0)
+        {
+            name = reader.ReadNullTerminatedString();
+        }
+
+        // The first definition wins, just like forward references resolve in the linker.
+        this._definitionsByName.TryAdd(name, typeIndex);
+    }
+
+    // Type indices below 0x1000 are "simple types" whose meaning is encoded in the index itself - the low byte is the kind of type,
+    // the next nibble is the pointer mode (if any).
+    private static uint GetSimpleTypeSize(uint typeIndex)
+    {
+        var mode = (typeIndex >> 8) & 0xF;
+        if (mode != 0)
+        {
+            return mode switch
+            {
+                1 or 2 => 2, // Near and far 16-bit pointers
+                3 or 4 => 4, // Huge 16:16 and near 32-bit pointers
+                5 => 6, // Far 16:32 pointers
+                6 => 8, // Near 64-bit pointers
+                7 => 16, // Near 128-bit pointers
+                _ => 0
+            };
+        }
+
+        return (typeIndex & 0xFF) switch
+        {
+            0x10 or 0x20 or 0x68 or 0x69 or 0x70 or 0x7C or 0x30 => 1, // char, uchar, int8, uint8, rchar, char8, bool8
+            0x11 or 0x21 or 0x72 or 0x73 or 0x71 or 0x7A or 0x31 or 0x46 => 2, // short, ushort, int16, uint16, wchar, char16, bool16, real16
+            0x12 or 0x22 or 0x74 or 0x75 or 0x7B or 0x32 or 0x40 or 0x08 => 4, // long, ulong, int32, uint32, char32, bool32, real32, HRESULT
+            0x13 or 0x23 or 0x76 or 0x77 or 0x33 or 0x41 => 8, // quad, uquad, int64, uint64, bool64, real64
+            0x42 => 10, // real80
+            0x14 or 0x24 or 0x78 or 0x79 => 16, // octa, uocta, int128, uint128
+            _ => 0 // void, and anything more exotic
+        };
+    }
+}
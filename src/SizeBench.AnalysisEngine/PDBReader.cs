@@ -0,0 +1,19 @@
+﻿namespace SizeBench.AnalysisEngine;
+
+public enum PDBReader
+{
+    /// <summary>
+    /// Read the PDB with msdia140.dll.  This supports every feature of SizeBench.
+    /// </summary>
+    DIA = 0,
+
+    /// <summary>
+    /// Read the PDB with SizeBench's own managed reader, which is faster to open a session with but does not yet support types, source files,
+    /// or inline sites.  Operations that need those will throw <see cref="NotSupportedException"/>.
+    /// <para>
+    /// This does not make SizeBench work off Windows - only the PDB file format parsing is platform-neutral, the session around it still
+    /// needs Windows (see "PDB readers" in docs/Analysis Engine internals.md).
+    /// </para>
+    /// </summary>
+    Managed = 1,
+}
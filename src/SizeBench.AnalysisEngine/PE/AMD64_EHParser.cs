@@ -30,9 +30,9 @@ internal sealed unsafe class AMD64_EHParser : EHSymbolParser
     #endregion
 
     public AMD64_EHParser(IDIAAdapter diaAdapter,
-                          byte* libraryBaseAddress,
+                          MappedPEImage image,
                           PEFile peFile,
-                          SymbolSourcesSupported symbolSourcesSupported) : base(diaAdapter, libraryBaseAddress, peFile, symbolSourcesSupported)
+                          SymbolSourcesSupported symbolSourcesSupported) : base(diaAdapter, image, peFile, symbolSourcesSupported)
     {
         this.__GSHandlerCheck_EHRva = diaAdapter.SymbolRvaFromName("__GSHandlerCheck_EH", true);
         this.__GSHandlerCheck_EH4Rva = diaAdapter.SymbolRvaFromName("__GSHandlerCheck_EH4", true);
@@ -47,11 +47,9 @@ internal sealed unsafe class AMD64_EHParser : EHSymbolParser
         this.__GSHandlerCheckRva = diaAdapter.SymbolRvaFromName("__GSHandlerCheck", true);
     }
 
-    private void ParseOneXData(Symbol? targetSymbol, uint targetStartRva, uint unwindInfoStartRva)
+    private void ParseOneXData(uint targetStartRva, uint unwindInfoStartRva, DecodedXDataList decoded)
     {
-        Debug.Assert(targetSymbol is null || (targetStartRva >= targetSymbol.RVA && targetStartRva <= targetSymbol.RVAEnd));
-
-        var pRawXdata = this.LibraryBaseAddress + unwindInfoStartRva;
+        var pRawXdata = this.Image.GetPointerByRVA(unwindInfoStartRva);
         var unwindInfoStart = pRawXdata;
         var versionAndFlags = *pRawXdata;
         var flags = (UNWIND_INFO_Flags)(versionAndFlags >> 3); // Upper 5 bits are flags
@@ -99,34 +97,34 @@ internal sealed unsafe class AMD64_EHParser : EHSymbolParser
 
         if (flags.HasFlag(UNWIND_INFO_Flags.UNW_FLAG_CHAININFO))
         {
-            ParseOneChainInfo(targetSymbol, targetStartRva, unwindInfoStartRva, pAfterUnwindCodes, unwindInfoStart);
+            ParseOneChainInfo(targetStartRva, unwindInfoStartRva, pAfterUnwindCodes, unwindInfoStart, decoded);
         }
         else if (flags == 0)
         {
             // Just a simple [unwind]
-            AddXData(new UnwindInfoSymbol(targetSymbol, targetStartRva, unwindInfoStartRva, (uint)(pAfterUnwindCodes - unwindInfoStart), this.SymbolSourcesSupported));
+            decoded.Add(XDataKind.UnwindInfo, targetStartRva, targetStartRva, unwindInfoStartRva, (uint)(pAfterUnwindCodes - unwindInfoStart));
         }
         else
         {
             var exceptionHandlerRva = *((uint*)pAfterUnwindCodes);
-            ParseOneExceptionHandler(targetSymbol, targetStartRva, unwindInfoStartRva, pAfterUnwindCodes, exceptionHandlerRva, unwindInfoStart);
+            ParseOneExceptionHandler(targetStartRva, targetStartRva, unwindInfoStartRva, pAfterUnwindCodes, exceptionHandlerRva, unwindInfoStart, decoded);
         }
     }
 
-    private void ParseOneChainInfo(Symbol? targetSymbol, uint targetStartRva, uint unwindInfoStartRva, byte* pAfterUnwindCodes, byte* unwindInfoStart)
+    private void ParseOneChainInfo(uint targetStartRva, uint unwindInfoStartRva, byte* pAfterUnwindCodes, byte* unwindInfoStart, DecodedXDataList decoded)
     {
         var rfChain = Marshal.PtrToStructure<RUNTIME_FUNCTION>(new IntPtr(pAfterUnwindCodes));
         pAfterUnwindCodes += Marshal.SizeOf<RUNTIME_FUNCTION>();
 
-        AddXData(new ChainUnwindInfoSymbol(targetSymbol, targetStartRva, unwindInfoStartRva, (uint)(pAfterUnwindCodes - unwindInfoStart), this.SymbolSourcesSupported));
+        decoded.Add(XDataKind.ChainUnwindInfo, targetStartRva, targetStartRva, unwindInfoStartRva, (uint)(pAfterUnwindCodes - unwindInfoStart));
 
-        var targetSymbolForChain = GetTargetSymbolForRVA(rfChain.FunctionStartRva);
-        ParseOneXData(targetSymbolForChain, rfChain.FunctionStartRva, rfChain.UnwindInfoRva);
+        // The rest of the chain is named after the function it chains to.
+        ParseOneXData(rfChain.FunctionStartRva, rfChain.UnwindInfoRva, decoded);
     }
 
     protected override SortedList<uint, PDataSymbol> ParsePDataForArchitecture(SessionDataCache cache)
     {
-        var pdataFunctions = ParsePDATA<RUNTIME_FUNCTION>(this.LibraryBaseAddress, cache);
+        var pdataFunctions = ParsePDATA<RUNTIME_FUNCTION>(cache);
 
         // There's no pdata, so we're done
         if (pdataFunctions is null)
@@ -134,19 +132,10 @@ internal sealed unsafe class AMD64_EHParser : EHSymbolParser
             return new SortedList<uint, PDataSymbol>();
         }
 
-        //TODO: Perf: We can be more efficient here.  We know every RUNTIME_FUNCTION will become a
-        //            PDataSymbol, so why not just allocate all of them in bulk here (one big array)
-        //            then fill them in with their FunctionStartRVA.  Then ParseOneRUNTIME_FUNCTION
-        //            wouldn't end up allocating individual PDataSymbol objects tens of thousands of
-        //            times.
-
-        var pdataSymbols = new SortedList<uint, PDataSymbol>(capacity: pdataFunctions.Length);
         var sizeOfRUNTIMEFUNCTION = (uint)Marshal.SizeOf<RUNTIME_FUNCTION>();
 
-        for (var i = 0; i < pdataFunctions.Length; i++)
+        return DecodePDataInParallel(pdataFunctions, cache, (pdataEntry, pdataEntryRva) =>
         {
-            var pdataEntry = pdataFunctions[i];
-
             // BBT can create chained PDATA entries, but SizeBench hasn't been taught how to parse these yet.
             if ((pdataEntry.UnwindInfoRva & 0x1) == 0x1)
             {
@@ -158,25 +147,14 @@ internal sealed unsafe class AMD64_EHParser : EHSymbolParser
                 pdataEntry.FunctionEndRva == 0 &&
                 pdataEntry.UnwindInfoRva == 0)
             {
-                continue;
+                return null;
             }
 
-            var pdataEntryRva = cache.PDataRVARange.RVAStart + (uint)(i * sizeOfRUNTIMEFUNCTION);
-            pdataSymbols.Add(pdataEntryRva, new PDataSymbol(pdataEntry.FunctionStartRva, pdataEntry.UnwindInfoRva, pdataEntryRva, sizeOfRUNTIMEFUNCTION, this.SymbolSourcesSupported));
-        }
-
-        return pdataSymbols;
+            return new PDataSymbol(pdataEntry.FunctionStartRva, pdataEntry.UnwindInfoRva, pdataEntryRva, sizeOfRUNTIMEFUNCTION, this.SymbolSourcesSupported);
+        });
     }
 
-    protected override void ParseXDataForArchitecture(RVARange? XDataRVARange, SessionDataCache cache)
-    {
-        foreach (var pds in cache.PDataSymbolsByRVA.Values)
-        {
-            var targetSymbol = GetTargetSymbolForRVA(pds.TargetStartRVA);
-            pds.UpdateTargetSymbol(targetSymbol);
-            ParseOneXData(targetSymbol, pds.TargetStartRVA, pds.UnwindInfoStartRva);
-        }
-    }
+    protected override void DecodeXDataForArchitecture(PDataSymbol pds, DecodedXDataList decoded) => ParseOneXData(pds.TargetStartRVA, pds.UnwindInfoStartRva, decoded);
 
     protected override uint GetGSDataSizeAdjusted(GS_UNWIND_Flags gsdata)
     {
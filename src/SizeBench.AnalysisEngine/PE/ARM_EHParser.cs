@@ -35,9 +35,9 @@ internal sealed unsafe class ARM_EHParser : EHSymbolParser
     #endregion
 
     public ARM_EHParser(IDIAAdapter diaAdapter,
-                        byte* libraryBaseAddress,
+                        MappedPEImage image,
                         PEFile peFile,
-                        SymbolSourcesSupported symbolSourcesSupported) : base(diaAdapter, libraryBaseAddress, peFile, symbolSourcesSupported)
+                        SymbolSourcesSupported symbolSourcesSupported) : base(diaAdapter, image, peFile, symbolSourcesSupported)
     {
         this.__GSHandlerCheck_EHRva = diaAdapter.SymbolRvaFromName("__GSHandlerCheck_EH", true);
         this.__GSHandlerCheck_EH4Rva = diaAdapter.SymbolRvaFromName("__GSHandlerCheck_EH4", true);
@@ -52,7 +52,7 @@ internal sealed unsafe class ARM_EHParser : EHSymbolParser
 
     protected override SortedList<uint, PDataSymbol> ParsePDataForArchitecture(SessionDataCache cache)
     {
-        var pdataFunctions = ParsePDATA<ARM_RUNTIME_FUNCTION>(this.LibraryBaseAddress, cache);
+        var pdataFunctions = ParsePDATA<ARM_RUNTIME_FUNCTION>(cache);
 
         // There's no pdata, so we're done
         if (pdataFunctions is null)
@@ -60,63 +60,42 @@ internal sealed unsafe class ARM_EHParser : EHSymbolParser
             return new SortedList<uint, PDataSymbol>();
         }
 
-        //TODO: Perf: We can be more efficient here.  We know every RUNTIME_FUNCTION will become a
-        //            PDataSymbol, so why not just allocate all of them in bulk here (one big array)
-        //            then fill them in with their FunctionStartRVA.  Then ParseOneRUNTIME_FUNCTION
-        //            wouldn't end up allocating individual PDataSymbol objects tens of thousands of
-        //            times.
-
-        var pdataSymbols = new SortedList<uint, PDataSymbol>(capacity: pdataFunctions.Length);
         var sizeOfRUNTIMEFUNCTION = (uint)Marshal.SizeOf<ARM_RUNTIME_FUNCTION>();
 
-        for (var i = 0; i < pdataFunctions.Length; i++)
+        return DecodePDataInParallel(pdataFunctions, cache, (pdataEntry, pdataEntryRva) =>
         {
-            var pdataEntry = pdataFunctions[i];
-
             // Some pdata tables contain these "empty" entries - they don't seem to hurt anything, just skip over them.
             // Not sure if this holds good for ARM, but keeping this code since we saw this in AMD64 and it does not seem to hurt anything.
             if (pdataEntry.FunctionStartRva == 0 &&
                 pdataEntry.EHMetadata == 0)
             {
-                continue;
+                return null;
             }
 
-            var pdataEntryRva = cache.PDataRVARange.RVAStart + (uint)(i * sizeOfRUNTIMEFUNCTION);
-
             var flags = (PDataFlags)(pdataEntry.EHMetadata & 0x3);
             var adjustedFunctionStartRva = GetAdjustedRva(pdataEntry.FunctionStartRva);
 
             if (flags == PDataFlags.EXCEPTION_INFO) // The remaining bits of EHMetadata in this pdata record point to an xdata record  
             {
-                pdataSymbols.Add(pdataEntryRva, new PDataSymbol(adjustedFunctionStartRva, pdataEntry.EHMetadata, pdataEntryRva, (uint)Marshal.SizeOf<ARM_RUNTIME_FUNCTION>(), this.SymbolSourcesSupported));
+                return new PDataSymbol(adjustedFunctionStartRva, pdataEntry.EHMetadata, pdataEntryRva, sizeOfRUNTIMEFUNCTION, this.SymbolSourcesSupported);
             }
             else if (flags == PDataFlags.FORWARDER)
             {
-                pdataSymbols.Add(pdataEntryRva, new ForwarderPDataSymbol(adjustedFunctionStartRva, pdataEntryRva, (uint)Marshal.SizeOf<ARM_RUNTIME_FUNCTION>(), this.SymbolSourcesSupported));
+                return new ForwarderPDataSymbol(adjustedFunctionStartRva, pdataEntryRva, sizeOfRUNTIMEFUNCTION, this.SymbolSourcesSupported);
             }
             else
             {
-                pdataSymbols.Add(pdataEntryRva, new PackedUnwindDataPDataSymbol(adjustedFunctionStartRva, pdataEntryRva, (uint)Marshal.SizeOf<ARM_RUNTIME_FUNCTION>(), this.SymbolSourcesSupported));
+                return new PackedUnwindDataPDataSymbol(adjustedFunctionStartRva, pdataEntryRva, sizeOfRUNTIMEFUNCTION, this.SymbolSourcesSupported);
             }
-        }
-
-        return pdataSymbols;
+        });
     }
 
-    protected override void ParseXDataForArchitecture(RVARange? XDataRVARange, SessionDataCache cache)
+    protected override void DecodeXDataForArchitecture(PDataSymbol pds, DecodedXDataList decoded)
     {
-        foreach (var pds in cache.PDataSymbolsByRVA.Values)
+        // ForwarderPDataSymbol and PackedUnwindDataPDataSymbol instances do not generate xdata, so we only do this for PDataSymbol (the base type)
+        if (pds.GetType() == typeof(PDataSymbol))
         {
-            var adjustedFunctionStartRva = GetAdjustedRva(pds.TargetStartRVA);
-            var targetSymbol = GetTargetSymbolForRVA(adjustedFunctionStartRva);
-
-            pds.UpdateTargetSymbol(targetSymbol);
-
-            // ForwarderPDataSymbol and PackedUnwindDataPDataSymbol instances do not generate xdata, so we only do this for PDataSymbol (the base type)
-            if (pds.GetType() == typeof(PDataSymbol))
-            {
-                ParseOneXData(targetSymbol, pds.TargetStartRVA, pds.UnwindInfoStartRva);
-            }
+            ParseOneXData(pds.TargetStartRVA, pds.UnwindInfoStartRva, decoded);
         }
     }
 
@@ -158,9 +137,9 @@ internal sealed unsafe class ARM_EHParser : EHSymbolParser
     // |                                                                                                                                                     |
     // -------------------------------------------------------------------------------------------------------------------------------------------------------
 
-    private void ParseOneXData(Symbol? targetSymbol, uint functionStartRva, uint ehMetadata)
+    private void ParseOneXData(uint functionStartRva, uint ehMetadata, DecodedXDataList decoded)
     {
-        var pRawXdata = (uint*)(this.LibraryBaseAddress + ehMetadata);
+        var pRawXdata = (uint*)this.Image.GetPointerByRVA(ehMetadata);
         var unwindInfoStart = (byte*)pRawXdata;
 
         var version = (byte)((*pRawXdata >> 18) & 0x3); // Skip 18 bits of Function length, bottom 2 bits are the version
@@ -176,16 +155,16 @@ internal sealed unsafe class ARM_EHParser : EHSymbolParser
         {
             var pExceptionHandlerRva = unwindInfoStart + GetXdataRecordSize(unwindInfoStart) - 4;
             var exceptionHandlerRva = GetAdjustedRva(*((uint*)pExceptionHandlerRva));
-            ParseOneExceptionHandler(targetSymbol, GetAdjustedRva(functionStartRva), ehMetadata, pExceptionHandlerRva, exceptionHandlerRva, unwindInfoStart);
+            ParseOneExceptionHandler(GetAdjustedRva(functionStartRva), GetAdjustedRva(functionStartRva), ehMetadata, pExceptionHandlerRva, exceptionHandlerRva, unwindInfoStart, decoded);
         }
         else
         {
             // Just a simple [unwind]
-            AddXData(new UnwindInfoSymbol(targetSymbol, GetAdjustedRva(functionStartRva), ehMetadata, GetXdataRecordSize(unwindInfoStart), this.SymbolSourcesSupported));
+            decoded.Add(XDataKind.UnwindInfo, GetAdjustedRva(functionStartRva), GetAdjustedRva(functionStartRva), ehMetadata, GetXdataRecordSize(unwindInfoStart));
         }
     }
 
-    private uint GetAdjustedRva(uint rva)
+    protected override uint GetAdjustedRva(uint rva)
     {
         if (this.MachineType == MachineType.ARM)
         {
@@ -1,4 +1,5 @@
 ﻿using System.Diagnostics;
+using System.Runtime.ExceptionServices;
 using System.Runtime.InteropServices;
 using SizeBench.AnalysisEngine.DIAInterop;
 using SizeBench.AnalysisEngine.Symbols;
@@ -94,12 +95,94 @@ internal abstract unsafe class EHSymbolParser
 
     #endregion
 
+    #region Decoded XDATA
+
+    protected enum XDataKind : byte
+    {
+        UnwindInfo,
+        ChainUnwindInfo,
+        CppXdata,
+        StateUnwindMap,
+        TryMap,
+        HandlerMap,
+        IpToStateMap,
+        SeparatedIpToStateMap,
+    }
+
+    // One XDATA structure, decoded from the image but not yet turned into an XDataSymbol - naming the symbol means finding its target
+    // symbol, which needs DIA, so that waits until everything decoded in parallel is merged back together on the DIA thread.
+    protected struct DecodedXData
+    {
+        public XDataKind Kind;
+        public uint TargetLookupRva; // The RVA to find the target symbol at, which isn't always the same as TargetStartRva
+        public uint TargetStartRva;
+        public uint Rva;
+        public uint Size;
+        public SepIPToStateMap4? SeparatedIpToStateMap;
+
+        // Non-zero if this structure starts a group that is shared by several functions (like a FuncInfo and everything it points to).
+        // The group is this many structures long, counting this one, and is skipped entirely if something is already at this RVA - so it
+        // belongs to the first function that uses it, just as it did when XDATA was parsed one function at a time.
+        public int GroupLength;
+    }
+
+    // The XDATA structures decoded for one or more PDATA entries, in the order they were found.
+    protected sealed class DecodedXDataList
+    {
+        private readonly List<DecodedXData> _items = new List<DecodedXData>();
+
+        public DecodedXDataList(bool canUseDIA)
+        {
+            this.CanUseDIA = canUseDIA;
+        }
+
+        // Only true when decoding on the DIA thread.  Elsewhere, an entry that needs DIA to decode sets NeedsDIAThread, and is decoded
+        // again when the results are merged.
+        public bool CanUseDIA { get; }
+        public bool NeedsDIAThread { get; set; }
+
+        public int Count => this._items.Count;
+
+        public void Add(XDataKind kind, uint targetLookupRva, uint targetStartRva, uint rva, uint size, SepIPToStateMap4? separatedIpToStateMap = null)
+        {
+            this._items.Add(new DecodedXData()
+            {
+                Kind = kind,
+                TargetLookupRva = targetLookupRva,
+                TargetStartRva = targetStartRva,
+                Rva = rva,
+                Size = size,
+                SeparatedIpToStateMap = separatedIpToStateMap
+            });
+        }
+
+        public int BeginGroup() => this._items.Count;
+
+        public void EndGroup(int groupStart) => CollectionsMarshal.AsSpan(this._items)[groupStart].GroupLength = this._items.Count - groupStart;
+
+        public ReadOnlySpan<DecodedXData> Slice(int start, int length) => CollectionsMarshal.AsSpan(this._items).Slice(start, length);
+
+        public void RemoveFrom(int start) => this._items.RemoveRange(start, this._items.Count - start);
+    }
+
+    private struct XDataDecodeOutcome
+    {
+        public int FirstItem;
+        public int ItemCount;
+        public bool DecodeOnDIAThread;
+    }
+
+    #endregion
+
+    // Below this many entries per chunk, splitting up the PDATA table costs more than decoding it in parallel saves.
+    private const int MinimumPDataEntriesPerChunk = 1024;
+
     protected PEFile PEFile { get; }
     protected MachineType MachineType => this.PEFile.MachineType;
     protected SymbolSourcesSupported SymbolSourcesSupported { get; }
     private SortedList<uint, XDataSymbol> XdataSymbols { get; } = new SortedList<uint, XDataSymbol>();
     private readonly IDIAAdapter _diaAdapter;
-    protected byte* LibraryBaseAddress { get; }
+    protected MappedPEImage Image { get; }
     protected List<uint> NoLanguageSpecificDataHandlers { get; }
 
     protected uint? _cxxFrameHandlerRva { get; set; }
@@ -115,12 +198,12 @@ internal abstract unsafe class EHSymbolParser
     protected uint? __GSHandlerCheckRva { get; set; }
 
     protected EHSymbolParser(IDIAAdapter diaAdapter,
-                             byte* libraryBaseAddress,
+                             MappedPEImage image,
                              PEFile peFile,
                              SymbolSourcesSupported symbolSourcesSupported)
     {
         this._diaAdapter = diaAdapter;
-        this.LibraryBaseAddress = libraryBaseAddress;
+        this.Image = image;
         this.PEFile = peFile;
         this.SymbolSourcesSupported = symbolSourcesSupported;
 
@@ -157,9 +240,12 @@ internal abstract unsafe class EHSymbolParser
     }
 
     protected abstract SortedList<uint, PDataSymbol> ParsePDataForArchitecture(SessionDataCache cache);
-    protected abstract void ParseXDataForArchitecture(RVARange? XDataRVARange, SessionDataCache cache);
+    protected abstract void DecodeXDataForArchitecture(PDataSymbol pds, DecodedXDataList decoded);
     protected abstract uint GetGSDataSizeAdjusted(GS_UNWIND_Flags gsdata);
 
+    // Some architectures encode extra bits in the low bits of code RVAs, this strips them off.
+    protected virtual uint GetAdjustedRva(uint rva) => rva;
+
     internal void Parse(RVARange? XDataRVARange, SessionDataCache cache, ILogger logger)
     {
         // First we parse PDATA because we may need it fully completed before we begin wandering into XDATA (such as if the XDATA
@@ -180,7 +266,7 @@ internal abstract unsafe class EHSymbolParser
         {
             using (logger.StartTaskLog("Parsing XDATA"))
             {
-                ParseXDataForArchitecture(XDataRVARange, cache);
+                ParseXData(cache);
 
                 var xdataRanges = new List<RVARange>();
 
@@ -220,7 +306,164 @@ internal abstract unsafe class EHSymbolParser
         }
     }
 
-    protected Symbol? GetTargetSymbolForRVA(uint rva)
+    private void ParseXData(SessionDataCache cache)
+    {
+        var pdataSymbols = cache.PDataSymbolsByRVA.Values;
+        var outcomes = new XDataDecodeOutcome[pdataSymbols.Count];
+        var decodedByChunk = new DecodedXDataList[GetChunkCount(pdataSymbols.Count)];
+
+        // Decoding XDATA only reads the image, so it can be spread across every core.  Each chunk of PDATA entries decodes into its own
+        // list, and nothing is shared until the merge below.
+        ForEachChunk(pdataSymbols.Count, (chunk, start, end) =>
+        {
+            var decoded = new DecodedXDataList(canUseDIA: false);
+            for (var i = start; i < end; i++)
+            {
+                ref var outcome = ref outcomes[i];
+                outcome.FirstItem = decoded.Count;
+
+#pragma warning disable CA1031 // Do not catch general exception types - the entry is decoded again on the DIA thread, where the same exception is thrown, in order.
+                try
+                {
+                    DecodeXDataForArchitecture(pdataSymbols[i], decoded);
+                }
+                catch (Exception)
+                {
+                    decoded.NeedsDIAThread = true;
+                }
+#pragma warning restore CA1031 // Do not catch general exception types
+
+                if (decoded.NeedsDIAThread)
+                {
+                    decoded.RemoveFrom(outcome.FirstItem);
+                    decoded.NeedsDIAThread = false;
+                    outcome.DecodeOnDIAThread = true;
+                }
+
+                outcome.ItemCount = decoded.Count - outcome.FirstItem;
+            }
+
+            decodedByChunk[chunk] = decoded;
+        });
+
+        // Now back on the DIA thread, the decoded structures are turned into symbols in PDATA order.  Many structures (chained unwind info,
+        // funclets) point back to the same few functions, so each target is only looked up once.
+        var targetSymbolsByRVA = new Dictionary<uint, Symbol?>();
+        var i = 0;
+        for (var chunk = 0; chunk < decodedByChunk.Length; chunk++)
+        {
+            var decoded = decodedByChunk[chunk];
+            for (var end = GetChunkEnd(pdataSymbols.Count, decodedByChunk.Length, chunk); i < end; i++)
+            {
+                var pds = pdataSymbols[i];
+                pds.UpdateTargetSymbol(GetTargetSymbolForRVA(GetAdjustedRva(pds.TargetStartRVA), targetSymbolsByRVA));
+
+                if (outcomes[i].DecodeOnDIAThread)
+                {
+                    var decodedOnDIAThread = new DecodedXDataList(canUseDIA: true);
+                    DecodeXDataForArchitecture(pds, decodedOnDIAThread);
+                    AddDecodedXData(decodedOnDIAThread.Slice(0, decodedOnDIAThread.Count), targetSymbolsByRVA);
+                }
+                else
+                {
+                    AddDecodedXData(decoded.Slice(outcomes[i].FirstItem, outcomes[i].ItemCount), targetSymbolsByRVA);
+                }
+            }
+        }
+    }
+
+    private void AddDecodedXData(ReadOnlySpan<DecodedXData> decoded, Dictionary<uint, Symbol?> targetSymbolsByRVA)
+    {
+        for (var i = 0; i < decoded.Length; i++)
+        {
+            if (decoded[i].GroupLength > 0 && this.XdataSymbols.ContainsKey(decoded[i].Rva))
+            {
+                i += decoded[i].GroupLength - 1;
+                continue;
+            }
+
+            AddXData(CreateXDataSymbol(decoded[i], GetTargetSymbolForRVA(decoded[i].TargetLookupRva, targetSymbolsByRVA)));
+        }
+    }
+
+    private XDataSymbol CreateXDataSymbol(in DecodedXData decoded, Symbol? targetSymbol)
+    {
+        return decoded.Kind switch
+        {
+            XDataKind.UnwindInfo => new UnwindInfoSymbol(targetSymbol, decoded.TargetStartRva, decoded.Rva, decoded.Size, this.SymbolSourcesSupported),
+            XDataKind.ChainUnwindInfo => new ChainUnwindInfoSymbol(targetSymbol, decoded.TargetStartRva, decoded.Rva, decoded.Size, this.SymbolSourcesSupported),
+            XDataKind.CppXdata => new CppXdataSymbol(targetSymbol, decoded.TargetStartRva, decoded.Rva, decoded.Size, this.SymbolSourcesSupported),
+            XDataKind.StateUnwindMap => new StateUnwindMapSymbol(targetSymbol, decoded.TargetStartRva, decoded.Rva, decoded.Size, this.SymbolSourcesSupported),
+            XDataKind.TryMap => new TryMapSymbol(targetSymbol, decoded.TargetStartRva, decoded.Rva, decoded.Size, this.SymbolSourcesSupported),
+            XDataKind.HandlerMap => new HandlerMapSymbol(targetSymbol, decoded.TargetStartRva, decoded.Rva, decoded.Size, this.SymbolSourcesSupported),
+            XDataKind.IpToStateMap => new IpToStateMapSymbol(targetSymbol, decoded.TargetStartRva, decoded.Rva, decoded.Size, this.SymbolSourcesSupported),
+            XDataKind.SeparatedIpToStateMap => new SeparatedIpToStateMapSymbol(targetSymbol, decoded.TargetStartRva, decoded.Rva, decoded.SeparatedIpToStateMap!.Value, this.SymbolSourcesSupported),
+            _ => throw new InvalidOperationException($"Unknown {nameof(XDataKind)} {decoded.Kind}.  This is a bug in SizeBench's implementation, not your usage of it.")
+        };
+    }
+
+    /// <summary>
+    /// Decodes the PDATA table in parallel, one contiguous chunk of entries per task, into an array indexed just like the table.  The table
+    /// is sorted by RVA, so the resulting SortedList is filled by appending alone.
+    /// </summary>
+    /// <param name="decodeOneEntry">Given an entry and its RVA, returns the PDataSymbol for it or null if it should be skipped.  This is
+    /// called from many threads at once.</param>
+    protected static SortedList<uint, PDataSymbol> DecodePDataInParallel<T>(T[] pdataFunctions, SessionDataCache cache, Func<T, uint, PDataSymbol?> decodeOneEntry) where T : struct
+    {
+        var sizeOfEntry = (uint)Marshal.SizeOf<T>();
+        var pdataSymbolsInTableOrder = new PDataSymbol?[pdataFunctions.Length];
+
+        ForEachChunk(pdataFunctions.Length, (_, start, end) =>
+        {
+            for (var i = start; i < end; i++)
+            {
+                pdataSymbolsInTableOrder[i] = decodeOneEntry(pdataFunctions[i], cache.PDataRVARange.RVAStart + (uint)(i * sizeOfEntry));
+            }
+        });
+
+        var pdataSymbols = new SortedList<uint, PDataSymbol>(capacity: pdataFunctions.Length);
+        foreach (var pds in pdataSymbolsInTableOrder)
+        {
+            if (pds != null)
+            {
+                pdataSymbols.Add(pds.RVA, pds);
+            }
+        }
+
+        return pdataSymbols;
+    }
+
+    private static int GetChunkCount(int count) => Math.Clamp(count / MinimumPDataEntriesPerChunk, 1, Environment.ProcessorCount * 4);
+
+    private static int GetChunkEnd(int count, int chunkCount, int chunk) => (int)((long)count * (chunk + 1) / chunkCount);
+
+    private static void ForEachChunk(int count, Action<int, int, int> decodeChunk)
+    {
+        var chunkCount = GetChunkCount(count);
+        try
+        {
+            Parallel.For(0, chunkCount, chunk => decodeChunk(chunk, chunk == 0 ? 0 : GetChunkEnd(count, chunkCount, chunk - 1), GetChunkEnd(count, chunkCount, chunk)));
+        }
+        catch (AggregateException ex)
+        {
+            // Callers expect the same exceptions they'd get from decoding one entry at a time, not an AggregateException.
+            ExceptionDispatchInfo.Capture(ex.InnerExceptions[0]).Throw();
+            throw;
+        }
+    }
+
+    private Symbol? GetTargetSymbolForRVA(uint rva, Dictionary<uint, Symbol?> targetSymbolsByRVA)
+    {
+        if (!targetSymbolsByRVA.TryGetValue(rva, out var targetSymbol))
+        {
+            targetSymbol = GetTargetSymbolForRVA(rva);
+            targetSymbolsByRVA.Add(rva, targetSymbol);
+        }
+
+        return targetSymbol;
+    }
+
+    private Symbol? GetTargetSymbolForRVA(uint rva)
     {
         var targetSymbol = this._diaAdapter.FindSymbolByRVA(rva, allowFindingNearest: true, CancellationToken.None);
 
@@ -236,7 +479,7 @@ internal abstract unsafe class EHSymbolParser
         }
     }
 
-    protected T[] ParsePDATA<T>(byte* libraryBaseAddress, SessionDataCache cache)
+    protected T[] ParsePDATA<T>(SessionDataCache cache)
     {
         var exceptionDirectory = this.PEFile.ExceptionDirectory;
         var arr = Array.Empty<T>();
@@ -251,13 +494,13 @@ internal abstract unsafe class EHSymbolParser
 
         if (cache.SymbolSourcesSupported.HasFlag(SymbolSourcesSupported.PDATA))
         {
-            var pdataAddress = new IntPtr(libraryBaseAddress + exceptionDirectory.RelativeVirtualAddress);
+            var pdataAddress = new IntPtr(this.Image.GetPointerByRVA(exceptionDirectory.RelativeVirtualAddress));
             arr = new T[exceptionDirectory.Size / Marshal.SizeOf<T>()];
             var handle = GCHandle.Alloc(arr, GCHandleType.Pinned);
             try
             {
                 var arrPtr = handle.AddrOfPinnedObject();
-                PInvokes.memcpy(arrPtr, pdataAddress, new UIntPtr((uint)exceptionDirectory.Size));
+                Buffer.MemoryCopy((void*)pdataAddress, (void*)arrPtr, exceptionDirectory.Size, exceptionDirectory.Size);
             }
             finally
             {
@@ -274,9 +517,9 @@ internal abstract unsafe class EHSymbolParser
         return arr;
     }
 
-    protected void AddXData(XDataSymbol xds) => this.XdataSymbols.TryAdd(xds.RVA, xds);
+    private void AddXData(XDataSymbol xds) => this.XdataSymbols.TryAdd(xds.RVA, xds);
 
-    protected void ParseOneExceptionHandler(Symbol? targetSymbol, uint rfStartRva, uint rfUnwindInfoRva, byte* pExceptionHandlerRva, uint exceptionHandlerRva, byte* unwindInfoStart)
+    protected void ParseOneExceptionHandler(uint targetLookupRva, uint rfStartRva, uint rfUnwindInfoRva, byte* pExceptionHandlerRva, uint exceptionHandlerRva, byte* unwindInfoStart, DecodedXDataList decoded)
     {
         var pLSData = pExceptionHandlerRva + 4;
         uint sizeOfLanguageSpecificData = 0;
@@ -299,6 +542,13 @@ internal abstract unsafe class EHSymbolParser
         if (!isGSEH && !isGSEH4 && !isCxx && !isCxx2 && !isCxx3 && !isCxx4 && !isCsh && !isGSSEH && !isGSH &&
             !this.NoLanguageSpecificDataHandlers.Contains(exceptionHandlerRva))
         {
+            // Everything from here on needs DIA, so this entry has to be decoded again on the DIA thread.
+            if (!decoded.CanUseDIA)
+            {
+                decoded.NeedsDIAThread = true;
+                return;
+            }
+
             var symbolLanguage = this._diaAdapter.LanguageOfSymbolAtRva(rfStartRva);
 
             // Code built by MASM seems to end up with really strange xdata - if we end up here, but the symbol is from a compiland with language == MASM, we'll just
@@ -325,12 +575,11 @@ internal abstract unsafe class EHSymbolParser
             // we know how to parse.
             //
             // Looking up the symbol for exceptionHandlerRva is expensive so we try to avoid it unless we're in this 'about to die' path.
-            // It's safe to look at the Result directly and force sync, since we know this code in the EHSymbolParser
-            // can only run on the DIA thread.
+            // It's safe to look at the Result directly and force sync, since we only get this far when decoding on the DIA thread.
             var exceptionHandlerPublicSymbolTargetRVA = this._diaAdapter.LoadPublicSymbolTargetRVAIfPossible(exceptionHandlerRva);
             if (exceptionHandlerPublicSymbolTargetRVA is not null)
             {
-                ParseOneExceptionHandler(targetSymbol, rfStartRva, rfUnwindInfoRva, pExceptionHandlerRva, exceptionHandlerPublicSymbolTargetRVA.Value, unwindInfoStart);
+                ParseOneExceptionHandler(targetLookupRva, rfStartRva, rfUnwindInfoRva, pExceptionHandlerRva, exceptionHandlerPublicSymbolTargetRVA.Value, unwindInfoStart, decoded);
                 return;
             }
 
@@ -342,7 +591,7 @@ internal abstract unsafe class EHSymbolParser
         if (isGSEH || isCxx || isCxx2 || isCxx3)
         {
             var cppxdataRva = (uint)(*(int*)pLSData);
-            var cppxdataPtr = (int*)(this.LibraryBaseAddress + cppxdataRva);
+            var cppxdataPtr = (int*)this.Image.GetPointerByRVA(cppxdataRva);
             var CppXdata = (FUNCINFO*)cppxdataPtr;
 
             if (CppXdata->dwMagic != CxxDataMagic.EH_MAGIC_NUMBER3)
@@ -350,11 +599,10 @@ internal abstract unsafe class EHSymbolParser
                 throw new InvalidOperationException("New CxxDataMagic found, need to write a parser!  This is a bug in SizeBench's implementation, not your use of it.");
             }
 
-            if (!this.XdataSymbols.ContainsKey(cppxdataRva))
-            {
-                // Because of the check above, we know we have EH_MAGIC_NUMBER3 here, so parse it as v3.
-                ParseCppXdataV3(targetSymbol, rfStartRva, CppXdata, cppxdataRva);
-            }
+            // Because of the check above, we know we have EH_MAGIC_NUMBER3 here, so parse it as v3.
+            var groupStart = decoded.BeginGroup();
+            ParseCppXdataV3(targetLookupRva, rfStartRva, CppXdata, cppxdataRva, decoded);
+            decoded.EndGroup(groupStart);
 
             sizeOfLanguageSpecificData = 4; // size of the FuncInfoRva
         }
@@ -362,10 +610,9 @@ internal abstract unsafe class EHSymbolParser
         {
             var cppxdataRva = (uint)(*(int*)pLSData);
 
-            if (!this.XdataSymbols.ContainsKey(cppxdataRva))
-            {
-                ParseCppXdataV4(targetSymbol, rfStartRva, cppxdataRva);
-            }
+            var groupStart = decoded.BeginGroup();
+            ParseCppXdataV4(targetLookupRva, rfStartRva, cppxdataRva, decoded);
+            decoded.EndGroup(groupStart);
 
             sizeOfLanguageSpecificData = 4; // size of the FuncInfo4 Rva
         }
@@ -402,37 +649,37 @@ internal abstract unsafe class EHSymbolParser
             sizeOfGSData = sizeof(uint) + GetGSDataSizeAdjusted(gsdata);
         }
 
-        AddXData(new UnwindInfoSymbol(targetSymbol, rfStartRva, rfUnwindInfoRva, (uint)(pLSData - unwindInfoStart + sizeOfLanguageSpecificData + sizeOfGSData), this.SymbolSourcesSupported));
+        decoded.Add(XDataKind.UnwindInfo, targetLookupRva, rfStartRva, rfUnwindInfoRva, (uint)(pLSData - unwindInfoStart + sizeOfLanguageSpecificData + sizeOfGSData));
     }
 
-    protected void ParseCppXdataV3(Symbol? targetSymbol, uint runtimeFuncionStartRva, FUNCINFO* CppXdata, uint cppxdataRva)
+    protected void ParseCppXdataV3(uint targetLookupRva, uint runtimeFuncionStartRva, FUNCINFO* CppXdata, uint cppxdataRva, DecodedXDataList decoded)
     {
         // [cppxdata]
-        AddXData(new CppXdataSymbol(targetSymbol, runtimeFuncionStartRva, cppxdataRva, (uint)Marshal.SizeOf<FUNCINFO>(), this.SymbolSourcesSupported));
+        decoded.Add(XDataKind.CppXdata, targetLookupRva, runtimeFuncionStartRva, cppxdataRva, (uint)Marshal.SizeOf<FUNCINFO>());
 
         // [stateUnwindMap], if one is present
         if (CppXdata->dwMaxState > 0 && CppXdata->pumeRva > 0)
         {
-            AddXData(new StateUnwindMapSymbol(targetSymbol, runtimeFuncionStartRva, CppXdata->pumeRva, (uint)(CppXdata->dwMaxState * Marshal.SizeOf<UnwindMapEntry>()), this.SymbolSourcesSupported));
+            decoded.Add(XDataKind.StateUnwindMap, targetLookupRva, runtimeFuncionStartRva, CppXdata->pumeRva, (uint)(CppXdata->dwMaxState * Marshal.SizeOf<UnwindMapEntry>()));
         }
 
         // [tryMap], if one is present
         if (CppXdata->dwTryBlocks > 0 && CppXdata->ptbmeRva > 0)
         {
-            AddXData(new TryMapSymbol(targetSymbol, runtimeFuncionStartRva, CppXdata->ptbmeRva, (uint)(CppXdata->dwTryBlocks * Marshal.SizeOf<TryBlockMapEntry>()), this.SymbolSourcesSupported));
+            decoded.Add(XDataKind.TryMap, targetLookupRva, runtimeFuncionStartRva, CppXdata->ptbmeRva, (uint)(CppXdata->dwTryBlocks * Marshal.SizeOf<TryBlockMapEntry>()));
 
-            var tryBlockMap = (TryBlockMapEntry*)(this.LibraryBaseAddress + CppXdata->ptbmeRva);
+            var tryBlockMap = (TryBlockMapEntry*)this.Image.GetPointerByRVA(CppXdata->ptbmeRva);
             // [handlerMap]
             if (tryBlockMap->nCatches > 0 && tryBlockMap->handlerArrayRVA > 0)
             {
-                AddXData(new HandlerMapSymbol(targetSymbol, runtimeFuncionStartRva, tryBlockMap->handlerArrayRVA, (uint)(tryBlockMap->nCatches * Marshal.SizeOf<HandlerType>()), this.SymbolSourcesSupported));
+                decoded.Add(XDataKind.HandlerMap, targetLookupRva, runtimeFuncionStartRva, tryBlockMap->handlerArrayRVA, (uint)(tryBlockMap->nCatches * Marshal.SizeOf<HandlerType>()));
             }
         }
 
         // [ip2StateMap]
         if (CppXdata->dwIPToStateEntries > 0 && CppXdata->ip2statemeRva > 0)
         {
-            AddXData(new IpToStateMapSymbol(targetSymbol, runtimeFuncionStartRva, CppXdata->ip2statemeRva, (uint)(CppXdata->dwIPToStateEntries * Marshal.SizeOf<IpToStateMapEntry>()), this.SymbolSourcesSupported));
+            decoded.Add(XDataKind.IpToStateMap, targetLookupRva, runtimeFuncionStartRva, CppXdata->ip2statemeRva, (uint)(CppXdata->dwIPToStateEntries * Marshal.SizeOf<IpToStateMapEntry>()));
         }
     }
 
@@ -505,11 +752,12 @@ internal abstract unsafe class EHSymbolParser
 
     protected readonly struct UWMap4
     {
-        public UWMap4(FuncInfo4 funcInfo, byte* imageBase)
+        public UWMap4(FuncInfo4 funcInfo, MappedPEImage image)
         {
             if (funcInfo.dispUnwindMap != 0)
             {
-                var buffer = imageBase + funcInfo.dispUnwindMap;
+                var bufferStart = image.GetPointerByRVA(funcInfo.dispUnwindMap);
+                var buffer = bufferStart;
                 this.NumEntries = ReadUnsigned(&buffer);
                 this.Entries = new UnwindMapEntry4[this.NumEntries];
                 for (var i = 0; i < this.NumEntries; i++)
@@ -517,7 +765,7 @@ internal abstract unsafe class EHSymbolParser
                     this.Entries[i] = new UnwindMapEntry4(&buffer);
                 }
 
-                this.Size = (uint)(buffer - (imageBase + funcInfo.dispUnwindMap));
+                this.Size = (uint)(buffer - bufferStart);
             }
             else
             {
@@ -552,11 +800,12 @@ internal abstract unsafe class EHSymbolParser
 
     protected readonly struct TryBlockMap4
     {
-        public TryBlockMap4(FuncInfo4 funcInfo, byte* imageBase)
+        public TryBlockMap4(FuncInfo4 funcInfo, MappedPEImage image)
         {
             if (funcInfo.dispTryBlockMap != 0)
             {
-                var buffer = imageBase + funcInfo.dispTryBlockMap;
+                var bufferStart = image.GetPointerByRVA(funcInfo.dispTryBlockMap);
+                var buffer = bufferStart;
                 this.NumTryBlocks = ReadUnsigned(&buffer);
                 this.Entries = new TryBlockMapEntry4[this.NumTryBlocks];
                 for (var i = 0; i < this.NumTryBlocks; i++)
@@ -564,7 +813,7 @@ internal abstract unsafe class EHSymbolParser
                     this.Entries[i] = new TryBlockMapEntry4(&buffer);
                 }
 
-                this.Size = (uint)(buffer - (imageBase + funcInfo.dispTryBlockMap));
+                this.Size = (uint)(buffer - bufferStart);
             }
             else
             {
@@ -671,11 +920,12 @@ internal abstract unsafe class EHSymbolParser
 
     protected readonly struct HandlerMap4
     {
-        public HandlerMap4(TryBlockMapEntry4 tryMap, byte* imageBase)
+        public HandlerMap4(TryBlockMapEntry4 tryMap, MappedPEImage image)
         {
             if (tryMap.dispHandlerArray != 0)
             {
-                var buffer = imageBase + tryMap.dispHandlerArray;
+                var bufferStart = image.GetPointerByRVA(tryMap.dispHandlerArray);
+                var buffer = bufferStart;
                 this.NumHandlers = ReadUnsigned(&buffer);
                 this.Handlers = new HandlerMapEntry4[this.NumHandlers];
                 for (var i = 0; i < this.NumHandlers; i++)
@@ -683,7 +933,7 @@ internal abstract unsafe class EHSymbolParser
                     this.Handlers[i] = new HandlerMapEntry4(&buffer);
                 }
 
-                this.Size = (uint)(buffer - (imageBase + tryMap.dispHandlerArray));
+                this.Size = (uint)(buffer - bufferStart);
             }
             else
             {
@@ -713,11 +963,12 @@ internal abstract unsafe class EHSymbolParser
 
     protected readonly struct IPToStateMap4
     {
-        public IPToStateMap4(SepIPToStateMapEntry4 mapEntry, byte* imageBase)
+        public IPToStateMap4(SepIPToStateMapEntry4 mapEntry, MappedPEImage image)
         {
             var functionStart = mapEntry.addrStartRVA;
 
-            var buffer = imageBase + mapEntry.dispOfIPMap;
+            var bufferStart = image.GetPointerByRVA(mapEntry.dispOfIPMap);
+            var buffer = bufferStart;
             this.NumEntries = ReadUnsigned(&buffer);
             this.Entries = new IPToStateMapEntry4[this.NumEntries];
             uint prevIp = 0;
@@ -727,7 +978,7 @@ internal abstract unsafe class EHSymbolParser
                 prevIp = (uint)(this.Entries[i].Ip - functionStart);
             }
 
-            this.Size = (uint)(buffer - (imageBase + mapEntry.dispOfIPMap));
+            this.Size = (uint)(buffer - bufferStart);
         }
 
         public uint NumEntries { get; }
@@ -744,41 +995,41 @@ internal abstract unsafe class EHSymbolParser
 
         public uint Size { get; }
 
-        internal SepIPToStateMapEntry4(int addrStartRVA, int dispOfIPMap, byte* imageBase)
+        internal SepIPToStateMapEntry4(int addrStartRVA, int dispOfIPMap, MappedPEImage image)
         {
             this.addrStartRVA = addrStartRVA;
             this.dispOfIPMap = dispOfIPMap;
             this.stateMap = null;
             this.Size = 0;
-            this.stateMap = new IPToStateMap4(this, imageBase);
+            this.stateMap = new IPToStateMap4(this, image);
             this.Size = this.stateMap.Value.Size;
         }
 
-        internal SepIPToStateMapEntry4(byte** buffer, byte* imageBase)
+        internal SepIPToStateMapEntry4(byte** buffer, MappedPEImage image)
         {
             var bufferStart = *buffer;
             this.addrStartRVA = ReadInt(buffer);
             this.dispOfIPMap = ReadInt(buffer);
             this.stateMap = null;
             this.Size = 0;
-            this.stateMap = new IPToStateMap4(this, imageBase);
+            this.stateMap = new IPToStateMap4(this, image);
             this.Size = (uint)(*buffer - bufferStart) + this.stateMap.Value.Size;
         }
     }
 
     internal readonly struct SepIPToStateMap4
     {
-        internal SepIPToStateMap4(bool isSeparated, int dispIPToStateMapOrSepIPToStateMap, byte* imageBase, uint functionStart)
+        internal SepIPToStateMap4(bool isSeparated, int dispIPToStateMapOrSepIPToStateMap, MappedPEImage image, uint functionStart)
         {
             if (isSeparated)
             {
-                var segBufferStart = imageBase + dispIPToStateMapOrSepIPToStateMap;
+                var segBufferStart = image.GetPointerByRVA(dispIPToStateMapOrSepIPToStateMap);
                 var segBuffer = segBufferStart;
                 this.NumEntries = ReadUnsigned(&segBuffer);
                 this.Entries = new SepIPToStateMapEntry4[this.NumEntries];
                 for (var i = 0; i < this.NumEntries; i++)
                 {
-                    this.Entries[i] = new SepIPToStateMapEntry4(&segBuffer, imageBase);
+                    this.Entries[i] = new SepIPToStateMapEntry4(&segBuffer, image);
                 }
                 this.Size = (uint)(segBuffer - segBufferStart);
             }
@@ -786,7 +1037,7 @@ internal abstract unsafe class EHSymbolParser
             {
                 this.NumEntries = 1;
                 this.Entries = new SepIPToStateMapEntry4[1];
-                this.Entries[0] = new SepIPToStateMapEntry4((int)functionStart, dispIPToStateMapOrSepIPToStateMap, imageBase);
+                this.Entries[0] = new SepIPToStateMapEntry4((int)functionStart, dispIPToStateMapOrSepIPToStateMap, image);
                 this.Size = 0;
             }
         }
@@ -862,7 +1113,7 @@ internal abstract unsafe class EHSymbolParser
         return result;
     }
 
-    private static uint DecompFuncInfo(byte* buffer, ref FuncInfo4 FuncInfoDe, byte* imageBase, uint functionStart)
+    private static uint DecompFuncInfo(byte* buffer, ref FuncInfo4 FuncInfoDe, MappedPEImage image, uint functionStart)
     {
         var buffer_start = buffer;
 
@@ -885,7 +1136,7 @@ internal abstract unsafe class EHSymbolParser
         }
 
         FuncInfoDe.dispIPtoStateMap = ReadInt(&buffer);
-        FuncInfoDe.SeparatedIP2StateMap = new SepIPToStateMap4(FuncInfoDe.isSeparated, FuncInfoDe.dispIPtoStateMap, imageBase, functionStart);
+        FuncInfoDe.SeparatedIP2StateMap = new SepIPToStateMap4(FuncInfoDe.isSeparated, FuncInfoDe.dispIPtoStateMap, image, functionStart);
 
         if (FuncInfoDe.isCatch)
         {
@@ -895,43 +1146,45 @@ internal abstract unsafe class EHSymbolParser
         return (uint)(buffer - buffer_start);
     }
 
-    protected void ParseCppXdataV4(Symbol? targetSymbol, uint runtimeFunctionStartRva, uint cppxdataRva)
+    protected void ParseCppXdataV4(uint targetLookupRva, uint runtimeFunctionStartRva, uint cppxdataRva, DecodedXDataList decoded)
     {
         var fi4 = new FuncInfo4();
-        var buffer = this.LibraryBaseAddress + cppxdataRva;
-        var lengthOfFuncInfo4 = DecompFuncInfo(buffer, ref fi4, this.LibraryBaseAddress, runtimeFunctionStartRva);
+        var buffer = this.Image.GetPointerByRVA(cppxdataRva);
+        var lengthOfFuncInfo4 = DecompFuncInfo(buffer, ref fi4, this.Image, runtimeFunctionStartRva);
 
-        AddXData(new CppXdataSymbol(targetSymbol, runtimeFunctionStartRva, cppxdataRva, lengthOfFuncInfo4, this.SymbolSourcesSupported));
+        decoded.Add(XDataKind.CppXdata, targetLookupRva, runtimeFunctionStartRva, cppxdataRva, lengthOfFuncInfo4);
 
         // [stateUnwindMap], if one is present
         if (fi4.UnwindMap)
         {
             var unwindMapRva = (uint)fi4.dispUnwindMap;
-            AddXData(new StateUnwindMapSymbol(targetSymbol, runtimeFunctionStartRva, unwindMapRva, new UWMap4(fi4, this.LibraryBaseAddress).Size, this.SymbolSourcesSupported));
+            decoded.Add(XDataKind.StateUnwindMap, targetLookupRva, runtimeFunctionStartRva, unwindMapRva, new UWMap4(fi4, this.Image).Size);
         }
 
         // [tryMap], if one is present
         if (fi4.TryBlockMap)
         {
             var tryBlockMapRva = (uint)fi4.dispTryBlockMap;
-            if (!this.XdataSymbols.ContainsKey(tryBlockMapRva))
-            {
-                var tryBlockMap = new TryBlockMap4(fi4, this.LibraryBaseAddress);
-                AddXData(new TryMapSymbol(targetSymbol, runtimeFunctionStartRva, tryBlockMapRva, tryBlockMap.Size, this.SymbolSourcesSupported));
+            var tryBlockMap = new TryBlockMap4(fi4, this.Image);
 
-                if (tryBlockMap.Entries != null)
+            // The try map and its handler maps can be shared with other functions, in which case they belong to the first one.
+            var groupStart = decoded.BeginGroup();
+            decoded.Add(XDataKind.TryMap, targetLookupRva, runtimeFunctionStartRva, tryBlockMapRva, tryBlockMap.Size);
+
+            if (tryBlockMap.Entries != null)
+            {
+                foreach (var tryBlock in tryBlockMap.Entries)
                 {
-                    foreach (var tryBlock in tryBlockMap.Entries)
+                    // [handlerMap], if present
+                    if (tryBlock.dispHandlerArray != 0)
                     {
-                        // [handlerMap], if present
-                        if (tryBlock.dispHandlerArray != 0)
-                        {
-                            var handlerMapRva = (uint)tryBlock.dispHandlerArray;
-                            AddXData(new HandlerMapSymbol(targetSymbol, runtimeFunctionStartRva, handlerMapRva, new HandlerMap4(tryBlock, this.LibraryBaseAddress).Size, this.SymbolSourcesSupported));
-                        }
+                        var handlerMapRva = (uint)tryBlock.dispHandlerArray;
+                        decoded.Add(XDataKind.HandlerMap, targetLookupRva, runtimeFunctionStartRva, handlerMapRva, new HandlerMap4(tryBlock, this.Image).Size);
                     }
                 }
             }
+
+            decoded.EndGroup(groupStart);
         }
 
         // [ip2StateMap], if one is present.
@@ -942,13 +1195,13 @@ internal abstract unsafe class EHSymbolParser
             // If this is separated code (PGO'd), then we will also have a SeparatedIpToStateMap table
             if (fi4.isSeparated)
             {
-                AddXData(new SeparatedIpToStateMapSymbol(targetSymbol, runtimeFunctionStartRva, (uint)fi4.dispIPtoStateMap, fi4.SeparatedIP2StateMap.Value, this.SymbolSourcesSupported));
+                decoded.Add(XDataKind.SeparatedIpToStateMap, targetLookupRva, runtimeFunctionStartRva, (uint)fi4.dispIPtoStateMap, fi4.SeparatedIP2StateMap.Value.Size, fi4.SeparatedIP2StateMap.Value);
             }
 
             foreach (var ip2StateMap in fi4.SeparatedIP2StateMap.Value.Entries)
             {
                 var ipToStateMapRva = (uint)ip2StateMap.dispOfIPMap;
-                AddXData(new IpToStateMapSymbol(targetSymbol, (uint)ip2StateMap.addrStartRVA, ipToStateMapRva, new IPToStateMap4(ip2StateMap, this.LibraryBaseAddress).Size, this.SymbolSourcesSupported));
+                decoded.Add(XDataKind.IpToStateMap, targetLookupRva, (uint)ip2StateMap.addrStartRVA, ipToStateMapRva, new IPToStateMap4(ip2StateMap, this.Image).Size);
             }
         }
     }
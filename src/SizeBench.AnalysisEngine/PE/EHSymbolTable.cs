@@ -5,21 +5,21 @@ namespace SizeBench.AnalysisEngine.PE;
 
 internal static class EHSymbolTable
 {
-    internal static unsafe void Parse(byte* libraryBaseAddress, SessionDataCache dataCache, IDIAAdapter diaAdapter, PEFile peFile, RVARange? XDataRVARange, ILogger logger)
+    internal static void Parse(MappedPEImage image, SessionDataCache dataCache, IDIAAdapter diaAdapter, PEFile peFile, RVARange? XDataRVARange, ILogger logger)
     {
         EHSymbolParser ehParser;
         switch (peFile.MachineType)
         {
             case MachineType.x64:
                 ehParser = new AMD64_EHParser(diaAdapter,
-                                              libraryBaseAddress,
+                                              image,
                                               peFile,
                                               dataCache.SymbolSourcesSupported);
                 break;
             case MachineType.ARM:
             case MachineType.ARM64:
                 ehParser = new ARM_EHParser(diaAdapter,
-                                            libraryBaseAddress,
+                                            image,
                                             peFile,
                                             dataCache.SymbolSourcesSupported);
                 break;
@@ -0,0 +1,210 @@
+﻿using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Reflection.PortableExecutable;
+using System.Runtime.InteropServices;
+using System.Security.Cryptography;
+
+namespace SizeBench.AnalysisEngine.PE;
+
+// A read-only memory-mapped view of a PE file on disk, which knows how to translate RVAs into the file's layout by walking the section
+// headers itself - the same translation the OS loader does when it maps an image, but without ever asking the loader to do it.  This
+// means the binary is never copied, never written to, and doesn't have to be something the OS is willing to load (so things like the
+// FORCE_INTEGRITY bit or a boot application subsystem don't matter).
+//
+// The only thing the loader does that a file mapping can't is materialize the zero-filled tail of a section whose VirtualSize exceeds its
+// SizeOfRawData (uninitialized data, typically).  Those RVAs are served from a single shared zero-filled buffer that's allocated on first use.
+internal sealed unsafe class MappedPEImage : IDisposable
+{
+    private readonly MemoryMappedFile _mappedFile;
+    private readonly MemoryMappedViewAccessor _view;
+    private readonly byte* _fileBase;
+    private readonly long _fileLength;
+    private readonly uint _sizeOfImage;
+
+    // One region for the headers, then one per section, sorted by RVA so lookups can binary search.
+    private readonly MappedRegion[] _regions;
+    private readonly uint[] _regionStarts;
+
+    private readonly uint _largestZeroFilledTail;
+    private byte* _zeroFilledTail;
+
+    // The EH parsers read the image from several threads at once, so the tail must only be allocated once.
+    private readonly Lock _zeroFilledTailLock = new Lock();
+
+    public PEReader PEReader { get; }
+
+    public MappedPEImage(string path)
+    {
+        var fileStream = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.Read | FileShare.Delete, bufferSize: 1, FileOptions.RandomAccess);
+        try
+        {
+            this._fileLength = fileStream.Length;
+            this._mappedFile = MemoryMappedFile.CreateFromFile(fileStream, mapName: null, capacity: 0, MemoryMappedFileAccess.Read, HandleInheritability.None, leaveOpen: false);
+        }
+        catch
+        {
+            fileStream.Dispose();
+            throw;
+        }
+
+        this._view = this._mappedFile.CreateViewAccessor(0, 0, MemoryMappedFileAccess.Read);
+
+        byte* viewBase = null;
+        this._view.SafeMemoryMappedViewHandle.AcquirePointer(ref viewBase);
+        this._fileBase = viewBase + this._view.PointerOffset;
+
+        this.PEReader = new PEReader(this._fileBase, (int)Math.Min(this._fileLength, Int32.MaxValue), isLoadedImage: false);
+        AnalysisEngineEventSource.Log.BytesMapped(this._fileLength);
+
+        var peHeader = this.PEReader.PEHeaders.PEHeader!;
+        this._sizeOfImage = (uint)peHeader.SizeOfImage;
+
+        var sections = this.PEReader.PEHeaders.SectionHeaders.OrderBy(section => section.VirtualAddress).ToArray();
+        this._regions = new MappedRegion[sections.Length + 1];
+        this._regionStarts = new uint[sections.Length + 1];
+
+        // The loader maps the headers at the same offset they have in the file.
+        var firstSectionStart = sections.Length > 0 ? (uint)sections[0].VirtualAddress : this._sizeOfImage;
+        this._regions[0] = new MappedRegion(0, firstSectionStart, (ulong)peHeader.SizeOfHeaders, 0, this._fileLength);
+
+        for (var i = 0; i < sections.Length; i++)
+        {
+            // Each section occupies the address space up to the next one (VirtualSize rounded up to SectionAlignment), and anything beyond
+            // its raw data is zero.
+            var virtualEnd = (i + 1 < sections.Length) ? (uint)sections[i + 1].VirtualAddress : this._sizeOfImage;
+            this._regions[i + 1] = new MappedRegion((uint)sections[i].VirtualAddress, virtualEnd, (ulong)sections[i].SizeOfRawData, sections[i].PointerToRawData, this._fileLength);
+        }
+
+        for (var i = 0; i < this._regions.Length; i++)
+        {
+            this._regionStarts[i] = this._regions[i].VirtualStart;
+            this._largestZeroFilledTail = Math.Max(this._largestZeroFilledTail, this._regions[i].VirtualEnd - this._regions[i].RawEnd);
+        }
+    }
+
+    /// <summary>
+    /// Returns a pointer to the byte at the given RVA, as it would appear if the image were mapped by the loader.  Callers may read forward
+    /// from this pointer only within the same section.
+    /// </summary>
+    public byte* GetPointerByRVA(long rva)
+    {
+        var region = FindRegion(rva);
+        if (rva < region.RawEnd)
+        {
+            return this._fileBase + region.FileOffset + (rva - region.VirtualStart);
+        }
+
+        return GetZeroFilledTail() + (rva - region.RawEnd);
+    }
+
+    /// <summary>
+    /// Returns the bytes for an RVA range.  This is zero-copy unless the range straddles the end of a section's raw data and its
+    /// zero-filled tail (or crosses into another section), in which case the bytes are assembled into a new buffer.
+    /// </summary>
+    public ReadOnlySpan<byte> GetBytesByRVA(long rva, int length)
+    {
+        if (length <= 0)
+        {
+            return ReadOnlySpan<byte>.Empty;
+        }
+
+        if (GetContiguousLengthAt(rva) >= length)
+        {
+            return new ReadOnlySpan<byte>(GetPointerByRVA(rva), length);
+        }
+
+        var bytes = new byte[length];
+        var copied = 0;
+        while (copied < length)
+        {
+            var chunkLength = (int)Math.Min(GetContiguousLengthAt(rva + copied), length - copied);
+            new ReadOnlySpan<byte>(GetPointerByRVA(rva + copied), chunkLength).CopyTo(bytes.AsSpan(copied));
+            copied += chunkLength;
+        }
+
+        return bytes;
+    }
+
+    // A hash of the entire file as it is on disk, which changes if even one byte of the binary does.
+    public byte[] ComputeFileSHA256()
+    {
+        using var stream = new UnmanagedMemoryStream(this._fileBase, this._fileLength);
+        return SHA256.HashData(stream);
+    }
+
+    // How many bytes starting at this RVA can be read from the pointer returned by GetPointerByRVA before the backing memory changes.
+    private long GetContiguousLengthAt(long rva)
+    {
+        var region = FindRegion(rva);
+        return rva < region.RawEnd ? region.RawEnd - rva : region.VirtualEnd - rva;
+    }
+
+    private MappedRegion FindRegion(long rva)
+    {
+        if (rva < 0 || rva >= this._sizeOfImage)
+        {
+            throw new ArgumentOutOfRangeException(nameof(rva), $"RVA 0x{rva:X} is outside of the image, which is 0x{this._sizeOfImage:X} bytes long.  This is a bug in SizeBench's implementation, not your usage of it.");
+        }
+
+        var index = Array.BinarySearch(this._regionStarts, (uint)rva);
+        return this._regions[index >= 0 ? index : ~index - 1];
+    }
+
+    private byte* GetZeroFilledTail()
+    {
+        lock (this._zeroFilledTailLock)
+        {
+            if (this._zeroFilledTail is null)
+            {
+                this._zeroFilledTail = (byte*)NativeMemory.AllocZeroed(Math.Max(this._largestZeroFilledTail, 1));
+            }
+
+            return this._zeroFilledTail;
+        }
+    }
+
+    private readonly struct MappedRegion
+    {
+        public MappedRegion(uint virtualStart, uint virtualEnd, ulong sizeOfRawData, long fileOffset, long fileLength)
+        {
+            this.VirtualStart = virtualStart;
+            this.VirtualEnd = Math.Max(virtualStart, virtualEnd);
+            this.FileOffset = fileOffset;
+
+            // Raw data can be truncated by the end of the file (or be entirely absent), and never extends past the region.
+            var rawSizeInFile = (ulong)Math.Max(0, fileLength - fileOffset);
+            this.RawEnd = (uint)Math.Min(this.VirtualStart + Math.Min(sizeOfRawData, rawSizeInFile), this.VirtualEnd);
+        }
+
+        public uint VirtualStart { get; }
+        public uint VirtualEnd { get; }
+        public uint RawEnd { get; }
+        public long FileOffset { get; }
+    }
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    public void Dispose()
+    {
+        if (!this._isDisposed)
+        {
+            this.PEReader.Dispose();
+            this._view.SafeMemoryMappedViewHandle.ReleasePointer();
+            this._view.Dispose();
+            this._mappedFile.Dispose();
+            AnalysisEngineEventSource.Log.BytesUnmapped(this._fileLength);
+
+            if (this._zeroFilledTail is not null)
+            {
+                NativeMemory.Free(this._zeroFilledTail);
+                this._zeroFilledTail = null;
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    #endregion
+}
@@ -1,11 +1,10 @@
-﻿using System.ComponentModel;
-using System.Diagnostics;
+﻿using System.Diagnostics;
 using System.Globalization;
 using System.IO;
-using System.IO.MemoryMappedFiles;
 using System.Reflection.PortableExecutable;
 using System.Runtime.InteropServices;
 using SizeBench.AnalysisEngine.DIAInterop;
+using SizeBench.AnalysisEngine.Disassembly;
 using SizeBench.AnalysisEngine.Helpers;
 using SizeBench.AnalysisEngine.Symbols;
 using SizeBench.Logging;
@@ -21,18 +20,13 @@ internal sealed partial class PEFile : IPEFile
     private const ushort MAGIC_TE = 0x5A56; // "VZ" for "terse executable"
     private const ushort MAGIC_LX = 0x584C; // "LX" for IBM OS/2 2.0 "linear executable"
 
-    private readonly IntPtr _library = IntPtr.Zero;
-    private readonly unsafe byte* _libraryBaseAddress = null;
+    private readonly MappedPEImage _image;
     private readonly ulong _libraryPreferredLoadAddress;
     private RVARangeSet? _delayLoadImportThunksRVARangeSet;
     private RVARangeSet? _delayLoadImportStringsRVARangeSet;
     private RVARangeSet? _delayLoadModuleHandlesRVARangeSet;
 
-    // The TempFile will only exist if _hasForceIntegrityBitSet == true, or we're
-    // trying to analyze a binary with a subsystem that can't be LoadLibrary'd
-    private readonly bool _hasForceIntegrityBitSet;
-    private readonly SubSystemType _imageSubsystem;
-    internal GuaranteedLocalFile GuaranteedLocalCopyOfBinary { get; }
+    internal string BinaryPath { get; }
 
 
     // This property is controlled by the "/filealign:<x>" option to link.exe
@@ -69,19 +63,20 @@ internal sealed partial class PEFile : IPEFile
     public ISymbol? GFIDSTable { get; private set; }
     public ISymbol? GIATSTable { get; private set; }
 
-    public PEReader PEReader { get; }
+    public PEReader PEReader => this._image.PEReader;
 
     private PEHeader PEHeader => this.PEReader.PEHeaders.PEHeader!;
 
     /// <summary>
-    /// Loads the PE file into memory, strips integrity bit if it must, and so on.
+    /// Maps the PE file into memory (read-only, directly from its original location) and parses the parts of it SizeBench cares about.
     /// </summary>
-    /// <param name="originalBinaryPathMayBeRemote">The path to the binary - this should be a local path for perf, but that is up to the caller.  We assume it's local and read/write-able.</param>
+    /// <param name="originalBinaryPathMayBeRemote">The path to the binary - this should be a local path for perf, but that is up to the caller.  It is never copied or modified.</param>
     /// <param name="symbolSourcesSupported">Which kinds of symbols we should attempt to parse out of the PE file</param>
     /// <param name="logger">Where to log things</param>
     public unsafe PEFile(string originalBinaryPathMayBeRemote, SymbolSourcesSupported symbolSourcesSupported, ILogger logger)
     {
         this.SymbolSourcesSupported = symbolSourcesSupported;
+        this.BinaryPath = originalBinaryPathMayBeRemote;
 
         using var taskLog = logger.StartTaskLog("Parse PE File");
         Span<byte> bytes = stackalloc byte[4096];
@@ -115,53 +110,15 @@ internal sealed partial class PEFile : IPEFile
                 // Read the "magic" bytes to determine if this is a PE file or something ancient like a New Executable (NE).
                 var magic = *(ushort*)pBytes;
                 ThrowIfUnsupportedMagic(magic, logger);
-
-                var ntHeaderPtr = new IntPtr(pBytes);
-                var headers32 = Marshal.PtrToStructure<IMAGE_NT_HEADERS32>(ntHeaderPtr);
-                this._hasForceIntegrityBitSet = headers32.OptionalHeader.DllCharacteristics.HasFlag(DllCharacteristicsType.IMAGE_DLLCHARACTERISTICS_FORCE_INTEGRITY);
-                this._imageSubsystem = headers32.OptionalHeader.Subsystem;
             }
         }
 
-        var shouldForceLocalCopy = this._hasForceIntegrityBitSet ||
-                                   HasSubsystemThatCannotLoadLibrary(this._imageSubsystem);
-
-        this.GuaranteedLocalCopyOfBinary = new GuaranteedLocalFile(originalBinaryPathMayBeRemote, taskLog, shouldForceLocalCopy, openDeleteOnCloseStreamImmediately: false);
-
-        if (this._hasForceIntegrityBitSet)
-        {
-            taskLog.Log("IMAGE_DLLCHARACTERISTICS_FORCE_INTEGRITY is set, unsetting this bit to allow us to load it.");
-            StripForceIntegrityBit(taskLog);
-        }
-
-        if (HasSubsystemThatCannotLoadLibrary(this._imageSubsystem))
-        {
-            taskLog.Log($"This binary has a Subsystem that cannot successfully be used with LoadLibraryExW (It has {this._imageSubsystem}).  Rewriting this to another subsystem just for analysis purposes.");
-            RewriteSubsystem(taskLog);
-        }
-
-        this.GuaranteedLocalCopyOfBinary.OpenDeleteOnCloseStreamIfCopiedLocally();
-
-        this._library = LoadBinaryIntoMemory(taskLog);
-
-        // The lower 32 bits of the handle returned by LoadLibraryEx are for use by the kernel, we should just strip them off to get the real
-        // base address.
-        // In experimental testing, it seems that LOAD_LIBRARY_AS_IMAGE_RESOURCE ends up adding +2 to the _library we just received, but this
-        // could change for lots of reasons, so let's just mask it off.
-        //
-        // See here: http://blogs.msdn.com/b/oldnewthing/archive/2005/10/05/477802.aspx
-        //
-        this._libraryBaseAddress = (byte*)((ulong)this._library.ToInt64() & 0xFFFFFFFFFFFF0000);
-
-        taskLog.Log($"{Path.GetFileName(this.GuaranteedLocalCopyOfBinary.OriginalPath)} library loaded at Base Address = 0x{((long)this._libraryBaseAddress):X}");
-
-        var _pntHeaders = new IntPtr(PInvokes.ImageNtHeader(this._libraryBaseAddress));
-
-        // I have to know how long the image is now that the OS loader has put it into memory, so before I can instantaite the PEReader,
-        // manually marshal out the NT headers and find the SizeOfImage that way.
-        var headers32OnlyUsedForSize = Marshal.PtrToStructure<IMAGE_NT_HEADERS32>(_pntHeaders);
+        // The image is mapped straight from the file rather than handed to the OS loader, so RVAs are translated to file offsets by
+        // MappedPEImage using the section headers.  This avoids any need to copy the binary somewhere writable to strip bits the loader
+        // would object to (like IMAGE_DLLCHARACTERISTICS_FORCE_INTEGRITY or a boot application subsystem).
+        this._image = new MappedPEImage(originalBinaryPathMayBeRemote);
 
-        this.PEReader = new PEReader(this._libraryBaseAddress, size: (int)headers32OnlyUsedForSize.OptionalHeader.SizeOfImage, isLoadedImage: true);
+        taskLog.Log($"{Path.GetFileName(this.BinaryPath)} mapped into memory, {this.PEReader.PEHeaders.SectionHeaders.Length} sections");
 
         this.MachineType = this.PEReader.PEHeaders.CoffHeader.Machine switch
         {
@@ -172,9 +129,8 @@ internal sealed partial class PEFile : IPEFile
             _ => throw new InvalidOperationException($"SizeBench does not know how to deal with MachineType={this.PEReader.PEHeaders.CoffHeader.Machine} binaries at this time.")
         };
 
-        // We do need to load the _libraryPreferredLoadAddress here and not where we look at the headers earlier - because the
-        // OptionalHeader.ImageBase will be different based on where the loader really put us in memory.  This is important for
-        // when we want to do things like load vtable addresses later (we need to subtract the right _libraryPreferredLoadAddress)
+        // Since nothing is ever relocated, any address stored in the binary (like a vtable entry) is relative to the ImageBase in the
+        // OptionalHeader, which is what we'll need to subtract to turn those into RVAs later.
         this._libraryPreferredLoadAddress = this.PEHeader.ImageBase;
         this.FileAlignment = (uint)this.PEHeader.FileAlignment;
         this.SectionAlignment = (uint)this.PEHeader.SectionAlignment;
@@ -183,12 +139,12 @@ internal sealed partial class PEFile : IPEFile
         if (this.PEHeader!.Magic == PEMagic.PE32Plus)
         {
             this.BytesPerWord = 8;
-            taskLog.Log($"{Path.GetFileName(this.GuaranteedLocalCopyOfBinary.OriginalPath)} is 64-bit, preferred load address=0x{this._libraryPreferredLoadAddress:X}");
+            taskLog.Log($"{Path.GetFileName(this.BinaryPath)} is 64-bit, preferred load address=0x{this._libraryPreferredLoadAddress:X}");
         }
         else
         {
             this.BytesPerWord = 4;
-            taskLog.Log($"{Path.GetFileName(this.GuaranteedLocalCopyOfBinary.OriginalPath)} is 32-bit, preferred load address=0x{this._libraryPreferredLoadAddress:X}");
+            taskLog.Log($"{Path.GetFileName(this.BinaryPath)} is 32-bit, preferred load address=0x{this._libraryPreferredLoadAddress:X}");
         }
 
         // Parse out the various data directories in the optional header, if they're present.
@@ -306,9 +262,6 @@ internal sealed partial class PEFile : IPEFile
         }
     }
 
-    private static bool HasSubsystemThatCannotLoadLibrary(SubSystemType subsystem)
-        => subsystem == SubSystemType.IMAGE_SUBSYSTEM_WINDOWS_BOOT_APPLICATION;
-
     private void AddDirectorySymbolIfPresent(DirectoryEntry dataDirectory, string name)
     {
         if (dataDirectory.RelativeVirtualAddress != 0)
@@ -676,7 +629,7 @@ internal sealed partial class PEFile : IPEFile
             this.DebugDirectories.Capacity = numDirectories;
             log.Log($"Found {numDirectories} IMAGE_DEBUG_DIRECTORY entries");
 
-            var pDebugDirectory = this._libraryBaseAddress + this.DebugDirectory.RelativeVirtualAddress;
+            var pDebugDirectory = GetDataMemberPtrByRVA(this.DebugDirectory.RelativeVirtualAddress);
             var debugDirectory = Marshal.PtrToStructure<IMAGE_DEBUG_DIRECTORY>((IntPtr)pDebugDirectory);
             var sizeOfDebugDirectory = Marshal.SizeOf<IMAGE_DEBUG_DIRECTORY>();
 
@@ -709,7 +662,7 @@ internal sealed partial class PEFile : IPEFile
                 {
                     log.Log("Found CodeView debug directory, looking for RSDS data");
 
-                    var rsdsPtr = new IntPtr(this._libraryBaseAddress + directory.AddressOfRawData);
+                    var rsdsPtr = new IntPtr(GetDataMemberPtrByRVA(directory.AddressOfRawData));
 
                     if (Marshal.ReadInt32(rsdsPtr) == (int)IMAGE_DEBUG_TYPE_MAGIC.RSDS_SIGNATURE)
                     {
@@ -729,166 +682,6 @@ internal sealed partial class PEFile : IPEFile
         }
     }
 
-    private unsafe IntPtr LoadBinaryIntoMemory(ILogger taskLog)
-    {
-        var library = PInvokes.LoadLibraryExW(this.GuaranteedLocalCopyOfBinary.GuaranteedLocalPath, IntPtr.Zero, PInvokes.LoadLibraryFlags.LOAD_LIBRARY_AS_IMAGE_RESOURCE | PInvokes.LoadLibraryFlags.LOAD_IGNORE_CODE_AUTHZ_LEVEL);
-
-        if (library == IntPtr.Zero)
-        {
-            taskLog.Log($"LoadLibraryEx failed for {this.GuaranteedLocalCopyOfBinary.GuaranteedLocalPath}{(this.GuaranteedLocalCopyOfBinary.CopiedLocally ? " (original path: " + this.GuaranteedLocalCopyOfBinary.OriginalPath + ")" : "")}", LogLevel.Error);
-            throw new Win32Exception(Marshal.GetLastWin32Error());
-        }
-
-        return library;
-    }
-
-    private void StripForceIntegrityBit(ILogger taskLog)
-    {
-        using (var memoryMappedFile = MemoryMappedFile.CreateFromFile(this.GuaranteedLocalCopyOfBinary.GuaranteedLocalPath, FileMode.Open, null, 0, MemoryMappedFileAccess.ReadWrite))
-        {
-            IMAGE_DOS_HEADER dosHeader;
-            using (var dosHeaderStream = memoryMappedFile.CreateViewStream(offset: 0, size: Marshal.SizeOf<IMAGE_DOS_HEADER>()))
-            using (var dosHeaderReader = new BinaryReader(dosHeaderStream))
-            {
-                var dosHeaderBytes = dosHeaderReader.ReadBytes(Marshal.SizeOf<IMAGE_DOS_HEADER>());
-                var handle = GCHandle.Alloc(dosHeaderBytes, GCHandleType.Pinned);
-                dosHeader = Marshal.PtrToStructure<IMAGE_DOS_HEADER>(handle.AddrOfPinnedObject());
-                Debug.Assert(dosHeader.isValid);
-            }
-
-            // Conveniently, the DllCharacteristics bit that we're interested in unsetting is in a part of the optional header that's at the same
-            // offset for 32-bit and 64-bit binaries so we'll just use the 32-bit header structure and it'll be ok.
-            IMAGE_NT_HEADERS32 headers32;
-            using (var ntHeadersStream = memoryMappedFile.CreateViewStream(offset: dosHeader.e_lfanew, size: Marshal.SizeOf<IMAGE_NT_HEADERS32>()))
-            using (var ntHeadersReader = new BinaryReader(ntHeadersStream))
-            using (var ntHeadersWriter = new BinaryWriter(ntHeadersStream))
-            {
-                var headers32Bytes = ntHeadersReader.ReadBytes(Marshal.SizeOf<IMAGE_NT_HEADERS32>());
-                var handle = GCHandle.Alloc(headers32Bytes, GCHandleType.Pinned);
-                headers32 = Marshal.PtrToStructure<IMAGE_NT_HEADERS32>(handle.AddrOfPinnedObject());
-
-                // We should have only ever gotten into this function if this bit is set.
-                Debug.Assert(headers32.OptionalHeader.DllCharacteristics.HasFlag(DllCharacteristicsType.IMAGE_DLLCHARACTERISTICS_FORCE_INTEGRITY));
-
-                // Seek to the beginning of the OptionalHeader first
-                ntHeadersWriter.Seek(Marshal.OffsetOf<IMAGE_NT_HEADERS32>(nameof(IMAGE_NT_HEADERS32.OptionalHeader)).ToInt32(), SeekOrigin.Begin);
-                // Then seek into the DllCharacteristics field
-                ntHeadersWriter.Seek(Marshal.OffsetOf<IMAGE_OPTIONAL_HEADER32>(nameof(IMAGE_OPTIONAL_HEADER32.DllCharacteristics)).ToInt32(), SeekOrigin.Current);
-                var dllCharacteristicsWithoutForceIntegrity = (ushort)((ushort)headers32.OptionalHeader.DllCharacteristics & (ushort)~DllCharacteristicsType.IMAGE_DLLCHARACTERISTICS_FORCE_INTEGRITY);
-                ntHeadersWriter.Write(dllCharacteristicsWithoutForceIntegrity);
-            }
-        }
-
-        UpdateChecksumAfterMutatingBinary(taskLog);
-    }
-
-    private void RewriteSubsystem(ILogger taskLog)
-    {
-        using (var memoryMappedFile = MemoryMappedFile.CreateFromFile(this.GuaranteedLocalCopyOfBinary.GuaranteedLocalPath, FileMode.Open, null, 0, MemoryMappedFileAccess.ReadWrite))
-        {
-            IMAGE_DOS_HEADER dosHeader;
-            using (var dosHeaderStream = memoryMappedFile.CreateViewStream(offset: 0, size: Marshal.SizeOf<IMAGE_DOS_HEADER>()))
-            using (var dosHeaderReader = new BinaryReader(dosHeaderStream))
-            {
-                var dosHeaderBytes = dosHeaderReader.ReadBytes(Marshal.SizeOf<IMAGE_DOS_HEADER>());
-                var handle = GCHandle.Alloc(dosHeaderBytes, GCHandleType.Pinned);
-                dosHeader = Marshal.PtrToStructure<IMAGE_DOS_HEADER>(handle.AddrOfPinnedObject());
-                Debug.Assert(dosHeader.isValid);
-            }
-
-            // Conveniently, the fields that we're interested in changing are part of the optional header that's at the same
-            // offset for 32-bit and 64-bit binaries so we'll just use the 32-bit header structure and it'll be ok.
-            IMAGE_NT_HEADERS32 headers32;
-            using (var ntHeadersStream = memoryMappedFile.CreateViewStream(offset: dosHeader.e_lfanew, size: Marshal.SizeOf<IMAGE_NT_HEADERS32>()))
-            using (var ntHeadersReader = new BinaryReader(ntHeadersStream))
-            using (var ntHeadersWriter = new BinaryWriter(ntHeadersStream))
-            {
-                var headers32Bytes = ntHeadersReader.ReadBytes(Marshal.SizeOf<IMAGE_NT_HEADERS32>());
-                var handle = GCHandle.Alloc(headers32Bytes, GCHandleType.Pinned);
-                headers32 = Marshal.PtrToStructure<IMAGE_NT_HEADERS32>(handle.AddrOfPinnedObject());
-
-                // We should have only ever gotten into this function if the subsystem is one we don't expect to successfully LoadLibrary.
-                Debug.Assert(HasSubsystemThatCannotLoadLibrary(headers32.OptionalHeader.Subsystem));
-
-                // Seek to the beginning of the OptionalHeader first
-                ntHeadersWriter.Seek(Marshal.OffsetOf<IMAGE_NT_HEADERS32>(nameof(IMAGE_NT_HEADERS32.OptionalHeader)).ToInt32(), SeekOrigin.Begin);
-                // Then seek into the Subsystem field
-                ntHeadersWriter.Seek(Marshal.OffsetOf<IMAGE_OPTIONAL_HEADER32>(nameof(IMAGE_OPTIONAL_HEADER32.Subsystem)).ToInt32(), SeekOrigin.Current);
-                ntHeadersWriter.Write((ushort)SubSystemType.IMAGE_SUBSYSTEM_WINDOWS_CUI);
-
-                // We also need to rewrite the OS version and image version since they can be 0 which still triggers ERROR_BAD_EXE_FORMAT in LoadLibrary
-                ntHeadersWriter.Seek(Marshal.OffsetOf<IMAGE_NT_HEADERS32>(nameof(IMAGE_NT_HEADERS32.OptionalHeader)).ToInt32(), SeekOrigin.Begin);
-                ntHeadersWriter.Seek(Marshal.OffsetOf<IMAGE_OPTIONAL_HEADER32>(nameof(IMAGE_OPTIONAL_HEADER32.MajorOperatingSystemVersion)).ToInt32(), SeekOrigin.Current);
-                // The 4 bytes here are major version (2 bytes) and minor version (2 bytes).
-                // We'll just pick 10.00 somewhat arbitrarily (this matches what Windows OS binaries set for Win10+)
-                ntHeadersWriter.Write((ushort)10);
-                ntHeadersWriter.Write((ushort)0);
-
-                ntHeadersWriter.Seek(Marshal.OffsetOf<IMAGE_NT_HEADERS32>(nameof(IMAGE_NT_HEADERS32.OptionalHeader)).ToInt32(), SeekOrigin.Begin);
-                ntHeadersWriter.Seek(Marshal.OffsetOf<IMAGE_OPTIONAL_HEADER32>(nameof(IMAGE_OPTIONAL_HEADER32.MajorImageVersion)).ToInt32(), SeekOrigin.Current);
-                // Similarly these 4 bytes are major/minor image version.  We'll just pick 10.00 again.
-                ntHeadersWriter.Write((ushort)10);
-                ntHeadersWriter.Write((ushort)0);
-
-                // We also rewrite the characteristics to allow it to load - perhaps we should only do this if characteristics is 0?
-                ntHeadersWriter.Seek(Marshal.OffsetOf<IMAGE_NT_HEADERS32>(nameof(IMAGE_NT_HEADERS32.OptionalHeader)).ToInt32(), SeekOrigin.Begin);
-                ntHeadersWriter.Seek(Marshal.OffsetOf<IMAGE_OPTIONAL_HEADER32>(nameof(IMAGE_OPTIONAL_HEADER32.DllCharacteristics)).ToInt32(), SeekOrigin.Current);
-                ntHeadersWriter.Write((ushort)DllCharacteristicsType.IMAGE_DLLCHARACTERISTICS_HIGH_ENTROPY_VA |
-                                      (ushort)DllCharacteristicsType.IMAGE_DLLCHARACTERISTICS_DYNAMIC_BASE |
-                                      (ushort)DllCharacteristicsType.IMAGE_DLLCHARACTERISTICS_NX_COMPAT);
-            }
-        }
-
-        UpdateChecksumAfterMutatingBinary(taskLog);
-    }
-
-    private void UpdateChecksumAfterMutatingBinary(ILogger taskLog)
-    {
-        // Calculate the new checksum since we changed the header
-        var result = PInvokes.MapFileAndCheckSumW(this.GuaranteedLocalCopyOfBinary.GuaranteedLocalPath, out var _ /* originalChecksum - unused */, out var newChecksum);
-
-        if (result != PInvokes.MapFileAndCheckSumWResult.CHECKSUM_SUCCESS)
-        {
-            // Sometimes even if we fail to change the checksum we can still load things, so we'll log this as a warning and just continue trying to
-            // load stuff into memory.  Maybe it'll work.
-            taskLog.Log($"Unable to change the checksum after writing out the change to IMAGE_DLLCHARACTERISTICS_FORCE_INTEGRITY.  Error was: {result}", LogLevel.Warning);
-            return;
-        }
-
-        // Write the new checksum into the file
-        using var memoryMappedFile = MemoryMappedFile.CreateFromFile(this.GuaranteedLocalCopyOfBinary.GuaranteedLocalPath, FileMode.Open, null, 0, MemoryMappedFileAccess.ReadWrite);
-        IMAGE_DOS_HEADER dosHeader;
-        using (var dosHeaderStream = memoryMappedFile.CreateViewStream(offset: 0, size: Marshal.SizeOf<IMAGE_DOS_HEADER>()))
-        using (var dosHeaderReader = new BinaryReader(dosHeaderStream))
-        {
-            var dosHeaderBytes = dosHeaderReader.ReadBytes(Marshal.SizeOf<IMAGE_DOS_HEADER>());
-            var handle = GCHandle.Alloc(dosHeaderBytes, GCHandleType.Pinned);
-            dosHeader = Marshal.PtrToStructure<IMAGE_DOS_HEADER>(handle.AddrOfPinnedObject());
-            Debug.Assert(dosHeader.isValid);
-        }
-
-        // Conveniently, the CheckSum field that we're interested in unsetting is in a part of the optional header that's at the same
-        // offset for 32-bit and 64-bit binaries so we'll just use the 32-bit header structure and it'll be ok.
-        IMAGE_NT_HEADERS32 headers32;
-        using (var ntHeadersStream = memoryMappedFile.CreateViewStream(offset: dosHeader.e_lfanew, size: Marshal.SizeOf<IMAGE_NT_HEADERS32>()))
-        using (var ntHeadersReader = new BinaryReader(ntHeadersStream))
-        using (var ntHeadersWriter = new BinaryWriter(ntHeadersStream))
-        {
-            var headers32Bytes = ntHeadersReader.ReadBytes(Marshal.SizeOf<IMAGE_NT_HEADERS32>());
-            var handle = GCHandle.Alloc(headers32Bytes, GCHandleType.Pinned);
-            headers32 = Marshal.PtrToStructure<IMAGE_NT_HEADERS32>(handle.AddrOfPinnedObject());
-
-            // By the time we get here, this bit should be unset!
-            Debug.Assert(false == headers32.OptionalHeader.DllCharacteristics.HasFlag(DllCharacteristicsType.IMAGE_DLLCHARACTERISTICS_FORCE_INTEGRITY));
-
-            // Seek to the beginning of the OptionalHeader first
-            ntHeadersWriter.Seek(Marshal.OffsetOf<IMAGE_NT_HEADERS32>(nameof(IMAGE_NT_HEADERS32.OptionalHeader)).ToInt32(), SeekOrigin.Begin);
-            // Then seek into the CheckSum field
-            ntHeadersWriter.Seek(Marshal.OffsetOf<IMAGE_OPTIONAL_HEADER32>(nameof(IMAGE_OPTIONAL_HEADER32.CheckSum)).ToInt32(), SeekOrigin.Current);
-            ntHeadersWriter.Write(newChecksum);
-        }
-    }
-
     /// <summary>
     /// Parses the table of Exception Handling symbols in the binary, referred to as PDATA (Procedure Data) and
     /// XDATA (eXception Data).
@@ -906,7 +699,7 @@ internal sealed partial class PEFile : IPEFile
     {
         unsafe
         {
-            EHSymbolTable.Parse(this._libraryBaseAddress, session.DataCache, diaAdapter, this, XDataRVARange, logger);
+            EHSymbolTable.Parse(this._image, session.DataCache, diaAdapter, this, XDataRVARange, logger);
         }
 
         if (session.DataCache.PDataHasBeenInitialized == false || session.DataCache.XDataHasBeenInitialized == false)
@@ -969,7 +762,7 @@ internal sealed partial class PEFile : IPEFile
             return;
         }
 
-        var rsrcSectionStart = this._libraryBaseAddress + this.RsrcRange.RVAStart;
+        var rsrcSectionStart = GetDataMemberPtrByRVA(this.RsrcRange.RVAStart);
 
         var directory = Marshal.PtrToStructure<IMAGE_RESOURCE_DIRECTORY>(new IntPtr(GetDataMemberPtrByRVA(directoryRVAStart)));
         var directorySize = (uint)Marshal.SizeOf<IMAGE_RESOURCE_DIRECTORY>() +
@@ -1212,7 +1005,7 @@ internal sealed partial class PEFile : IPEFile
 
     #endregion
 
-    private unsafe byte* GetDataMemberPtrByRVA(long RVA) => this._libraryBaseAddress + RVA;
+    private unsafe byte* GetDataMemberPtrByRVA(long RVA) => this._image.GetPointerByRVA(RVA);
 
     public uint LoadUInt32ByRVAThatIsPreferredBaseRelative(long RVA)
     {
@@ -1263,39 +1056,42 @@ internal sealed partial class PEFile : IPEFile
     {
         unsafe
         {
-            var pRVA = GetDataMemberPtrByRVA(RVA);
-
-            // We select all the flags, to try every test possible to discount this as Unicode,
-            // except we exclude IS_TEXT_UNICODE_NULL_BYTES because sometimes string symbols over-report
-            // their size (LLD has been observed to do this), so it ends up putting two strings in the binary
-            // with only one symbol representing them.  This means we get a null byte between the two strings,
-            // but we can't really do any better than discovering this as one null-embedded string, and it's
-            // better than having IsTextUnicode tell us this string is Unicode so we marshal it as garbage.
-            var flags = (IsTextUnicodeFlags)(0xFFFF & ~((int)IsTextUnicodeFlags.IS_TEXT_UNICODE_NULL_BYTES));
-            isUnicodeString = IsTextUnicode(pRVA, (int)length, ref flags);
-
-            if (isUnicodeString)
-            {
-                // Not all strings are null-terminated, but for those that are we don't want the null terminator in the output so we'll cut that off
-                if (*(char*)(pRVA + length - 2) == 0)
-                {
-                    return Marshal.PtrToStringUni((IntPtr)pRVA, (int)(length - 2) / 2) ?? String.Empty;
-                }
-                else
-                {
-                    return Marshal.PtrToStringUni((IntPtr)pRVA, (int)length / 2) ?? String.Empty;
-                }
-            }
-            else
+            // Go through GetBytesByRVA rather than the raw pointer since a string could straddle the end of a section's raw data, and the
+            // pointer is only good up to there.
+            fixed (byte* pRVA = this._image.GetBytesByRVA(RVA, (int)length))
             {
-                // Not all strings are null-terminated, but for those that are we don't want the null terminator in the output so we'll cut that off
-                if (*(sbyte*)(pRVA + length - 1) == 0)
+                // We select all the flags, to try every test possible to discount this as Unicode,
+                // except we exclude IS_TEXT_UNICODE_NULL_BYTES because sometimes string symbols over-report
+                // their size (LLD has been observed to do this), so it ends up putting two strings in the binary
+                // with only one symbol representing them.  This means we get a null byte between the two strings,
+                // but we can't really do any better than discovering this as one null-embedded string, and it's
+                // better than having IsTextUnicode tell us this string is Unicode so we marshal it as garbage.
+                var flags = (IsTextUnicodeFlags)(0xFFFF & ~((int)IsTextUnicodeFlags.IS_TEXT_UNICODE_NULL_BYTES));
+                isUnicodeString = IsTextUnicode(pRVA, (int)length, ref flags);
+
+                if (isUnicodeString)
                 {
-                    return Marshal.PtrToStringAnsi((IntPtr)pRVA, (int)length - 1) ?? String.Empty;
+                    // Not all strings are null-terminated, but for those that are we don't want the null terminator in the output so we'll cut that off
+                    if (*(char*)(pRVA + length - 2) == 0)
+                    {
+                        return Marshal.PtrToStringUni((IntPtr)pRVA, (int)(length - 2) / 2) ?? String.Empty;
+                    }
+                    else
+                    {
+                        return Marshal.PtrToStringUni((IntPtr)pRVA, (int)length / 2) ?? String.Empty;
+                    }
                 }
                 else
                 {
-                    return Marshal.PtrToStringAnsi((IntPtr)pRVA, (int)length) ?? String.Empty;
+                    // Not all strings are null-terminated, but for those that are we don't want the null terminator in the output so we'll cut that off
+                    if (*(sbyte*)(pRVA + length - 1) == 0)
+                    {
+                        return Marshal.PtrToStringAnsi((IntPtr)pRVA, (int)length - 1) ?? String.Empty;
+                    }
+                    else
+                    {
+                        return Marshal.PtrToStringAnsi((IntPtr)pRVA, (int)length) ?? String.Empty;
+                    }
                 }
             }
         }
@@ -1303,24 +1099,22 @@ internal sealed partial class PEFile : IPEFile
 
     public bool CompareData(long RVA1, long RVA2, uint length)
     {
-        unsafe
-        {
-            var ptr1 = GetDataMemberPtrByRVA(RVA1);
-            var ptr2 = GetDataMemberPtrByRVA(RVA2);
-            for (var i = 0; i < length; i++)
-            {
-                var val1 = ptr1 + i;
-                var val2 = ptr2 + i;
-                if (*val1 != *val2)
-                {
-                    return false;
-                }
-            }
-        }
+        // SequenceEqual is vectorized, so this is far faster than a byte-at-a-time loop for large tables.
+        return this._image.GetBytesByRVA(RVA1, (int)length).SequenceEqual(this._image.GetBytesByRVA(RVA2, (int)length));
+    }
 
-        return true;
+    // Equal bytes always hash the same, so this can be used to bucket data before confirming duplicates with CompareData.  HashCode is
+    // xxHash32 underneath, and is randomly seeded per-process, so these must never be persisted.
+    public int HashData(long RVA, uint length)
+    {
+        var hash = new HashCode();
+        hash.AddBytes(this._image.GetBytesByRVA(RVA, (int)length));
+        return hash.ToHashCode();
     }
 
+    // Unlike HashData this is stable across processes, so it's suitable for recognizing the same binary in a persisted cache.
+    internal byte[] ComputeFileSHA256() => this._image.ComputeFileSHA256();
+
     internal float CompareSimilarityOfBytesInBinary(IReadOnlyList<RVARange> ranges1, IReadOnlyList<RVARange> ranges2)
     {
         long bytesSame = 0;
@@ -1331,29 +1125,37 @@ internal sealed partial class PEFile : IPEFile
             throw new ArgumentException("The two passed-in lists of RVA Ranges must be of equal length.  This is a bug in SizeBench's implementation, not your use of it", nameof(ranges1));
         }
 
-        unsafe
+        for (var i = 0; i < ranges1.Count; i++)
         {
-            for (var i = 0; i < ranges1.Count; i++)
-            {
-                var ptr1 = GetDataMemberPtrByRVA(ranges1[i].RVAStart);
-                var ptr2 = GetDataMemberPtrByRVA(ranges2[i].RVAStart);
-                long lengthToCompare = Math.Min(ranges1[i].Size, ranges2[i].Size);
-                for (var byteIndex = 0; byteIndex < lengthToCompare; byteIndex++)
-                {
-                    var val1 = ptr1 + byteIndex;
-                    var val2 = ptr2 + byteIndex;
-                    if (*val1 == *val2)
-                    {
-                        bytesSame++;
-                    }
-                }
-                bytesCompared += Math.Max(ranges1[i].Size, ranges2[i].Size);
-            }
+            var lengthToCompare = (int)Math.Min(ranges1[i].Size, ranges2[i].Size);
+            bytesSame += ByteComparison.CountEqualBytes(this._image.GetBytesByRVA(ranges1[i].RVAStart, lengthToCompare),
+                                                        this._image.GetBytesByRVA(ranges2[i].RVAStart, lengthToCompare));
+            bytesCompared += Math.Max(ranges1[i].Size, ranges2[i].Size);
         }
 
         return bytesSame / (float)bytesCompared;
     }
 
+    // A MinHash signature of the bytes in these ranges - see CodeBytesMinHash for how to compare two of them.
+    internal ulong[] ComputeMinHashOfBytesInBinary(IReadOnlyList<RVARange> ranges)
+    {
+        var signature = CodeBytesMinHash.CreateEmptySignature();
+
+        foreach (var range in ranges)
+        {
+            CodeBytesMinHash.AddBytes(this._image.GetBytesByRVA(range.RVAStart, (int)range.Size), signature);
+        }
+
+        return signature;
+    }
+
+    internal ulong PreferredLoadAddress => this._libraryPreferredLoadAddress;
+
+    // The instructions in this range, decoded in-process - see ManagedDisassembler.  This only reads the mapped bytes, so it's safe to
+    // call from any thread.
+    internal List<DecodedInstruction> DisassembleRange(RVARange range)
+        => ManagedDisassembler.DecodeRange(this._image.GetBytesByRVA(range.RVAStart, (int)range.Size), range.RVAStart, this.MachineType, this._libraryPreferredLoadAddress);
+
     #region IDisposable Support
 
     private bool _isDisposed; // To detect redundant calls
@@ -1362,16 +1164,8 @@ internal sealed partial class PEFile : IPEFile
     {
         if (!this._isDisposed)
         {
-            // PEReader can be null if we fail to begin loading the binary (such as for a New Executable)
-            this.PEReader?.Dispose();
-
-            // Only free the library if we ever got it loaded
-            if (this._library != IntPtr.Zero)
-            {
-                PInvokes.FreeLibrary(this._library);
-            }
-
-            this.GuaranteedLocalCopyOfBinary?.Dispose();
+            // The image can be null if we fail to begin loading the binary (such as for a New Executable)
+            this._image?.Dispose();
 
             this._isDisposed = true;
         }
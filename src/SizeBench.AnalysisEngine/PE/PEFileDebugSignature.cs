@@ -1,4 +1,7 @@
-﻿namespace SizeBench.AnalysisEngine.PE;
+﻿using System.IO;
+using System.Reflection.PortableExecutable;
+
+namespace SizeBench.AnalysisEngine.PE;
 
 public sealed record class PEFileDebugSignature
 {
@@ -12,4 +15,36 @@ public sealed record class PEFileDebugSignature
         this.Age = age;
         this.PdbPath = pdbPath;
     }
+
+    /// <summary>
+    /// Reads just the debug signature out of a binary, without opening a <see cref="Session"/> or parsing anything else in the binary.  This is
+    /// cheap enough to call on every binary in a large folder, to find out which ones have changed since they were last looked at.
+    /// </summary>
+    /// <param name="binaryPath">The path to the binary.</param>
+    /// <returns>The binary's signature - if the binary has no CodeView debug directory, the PdbGuid is Guid.Empty, as it is for <see cref="IPEFile.DebugSignature"/>.</returns>
+    public static PEFileDebugSignature ReadFromBinary(string binaryPath)
+    {
+        using var stream = new FileStream(binaryPath, FileMode.Open, FileAccess.Read, FileShare.Read);
+        using var peReader = new PEReader(stream);
+
+        // Like PEFile, only the first CodeView directory is looked at.
+        foreach (var directory in peReader.ReadDebugDirectory())
+        {
+            if (directory.Type == DebugDirectoryEntryType.CodeView)
+            {
+                try
+                {
+                    var codeView = peReader.ReadCodeViewDebugDirectoryData(directory);
+                    return new PEFileDebugSignature(codeView.Guid, (uint)codeView.Age, codeView.Path);
+                }
+                catch (BadImageFormatException)
+                {
+                    // Not RSDS data (such as an old NB10 signature), which PEFile doesn't understand either.
+                    break;
+                }
+            }
+        }
+
+        return new PEFileDebugSignature(Guid.Empty, 0, String.Empty);
+    }
 }
@@ -1,7 +1,6 @@
 ﻿using System.Diagnostics;
 using System.Diagnostics.CodeAnalysis;
 using System.Runtime.InteropServices;
-using System.Security;
 
 namespace SizeBench.AnalysisEngine.PE;
 
@@ -1821,73 +1820,3 @@ internal readonly struct IMAGE_LOAD_CONFIG_DIRECTORY32_V5
     [FieldOffset(184)]
     public readonly uint CastGuardOsDeterminedFailureMode;
 }
-
-internal static partial class PInvokes
-{
-    #region LoadLibraryEx / FreeLibrary
-
-    [Flags]
-    internal enum LoadLibraryFlags : uint
-    {
-        DONT_RESOLVE_DLL_REFERENCES = 0x00000001,
-        LOAD_IGNORE_CODE_AUTHZ_LEVEL = 0x00000010,
-        LOAD_LIBRARY_AS_DATAFILE = 0x00000002,
-        LOAD_LIBRARY_AS_DATAFILE_EXCLUSIVE = 0x00000040,
-        LOAD_LIBRARY_AS_IMAGE_RESOURCE = 0x00000020,
-        LOAD_WITH_ALTERED_SEARCH_PATH = 0x00000008,
-        LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR = 0x00000100,
-        LOAD_LIBRARY_SEARCH_SYSTEM32 = 0x00000800,
-
-    }
-
-    [DefaultDllImportSearchPaths(DllImportSearchPath.SafeDirectories)]
-    [LibraryImport("Kernelbase.dll", SetLastError = true, StringMarshalling = StringMarshalling.Utf16)]
-    public static partial IntPtr LoadLibraryExW([MarshalAs(UnmanagedType.LPWStr)] string lpFileName, IntPtr reserved, LoadLibraryFlags flags);
-
-    [DefaultDllImportSearchPaths(DllImportSearchPath.SafeDirectories)]
-    [LibraryImport("kernel32.dll", SetLastError = true)]
-    [return: MarshalAs(UnmanagedType.Bool)]
-    internal static unsafe partial bool FreeLibrary(IntPtr hModule);
-
-    #endregion
-
-    #region DbgHelp - note we use the copy in SizeBench from DbgX, NOT the OS version
-
-    [DefaultDllImportSearchPaths(DllImportSearchPath.SafeDirectories)]
-    [LibraryImport(@"amd64\dbghelp.dll", EntryPoint = "ImageNtHeader")]
-    [SuppressUnmanagedCodeSecurity]
-    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvStdcall)])]
-    internal static unsafe partial void* ImageNtHeader(void* Base);
-
-    #endregion
-
-    #region MSVCRT
-
-    [DefaultDllImportSearchPaths(DllImportSearchPath.SafeDirectories)]
-    [LibraryImport("msvcrt.dll", EntryPoint = "memcpy", SetLastError = false)]
-    [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
-    public static partial IntPtr memcpy(IntPtr dest, IntPtr src, UIntPtr count);
-
-    #endregion
-
-    #region Imagehlp
-
-    internal enum MapFileAndCheckSumWResult : uint
-    {
-        CHECKSUM_SUCCESS = 0,
-        CHECKSUM_MAP_FAILURE = 2,
-        CHECKSUM_MAPVIEW_FAILURE = 3,
-        CHECKSUM_OPEN_FAILURE = 1,
-        CHECKSUM_UNICODE_FAILURE = 4
-    }
-
-    [DefaultDllImportSearchPaths(DllImportSearchPath.SafeDirectories)]
-    [LibraryImport("imagehlp.dll", EntryPoint = "MapFileAndCheckSumW")]
-    [UnmanagedCallConv(CallConvs = new Type[] { typeof(System.Runtime.CompilerServices.CallConvStdcall) })]
-    internal static partial MapFileAndCheckSumWResult MapFileAndCheckSumW([MarshalAs(UnmanagedType.LPWStr)] string filename,
-                                                                         [MarshalAs(UnmanagedType.U4)] out uint originalHeaderChecksum,
-                                                                         [MarshalAs(UnmanagedType.U4)] out uint newChecksum);
-
-    #endregion
-
-}
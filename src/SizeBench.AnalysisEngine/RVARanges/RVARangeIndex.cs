@@ -0,0 +1,92 @@
+﻿namespace SizeBench.AnalysisEngine;
+
+// An immutable index from RVA ranges back to whatever owns them (a COFF Group, a compiland, a source file...), for finding which owner
+// contains a given range without walking every range of every owner.
+//
+// Owners are given in priority order, and a lookup returns the first owner (in that order) with a range that contains the whole queried
+// range - the same answer a linear scan over the owners would give, even when ranges overlap.  Ranges are kept sorted by their start as
+// struct-of-arrays, along with the largest end seen so far at each index, so a lookup is a binary search followed by a backwards walk that
+// stops as soon as no earlier range can reach far enough - which for ranges that don't overlap is almost always right away.
+internal sealed class RVARangeIndex<T> where T : class
+{
+    private readonly uint[] _starts;
+    private readonly uint[] _ends;
+    private readonly uint[] _largestEndSoFar;
+    private readonly int[] _ownerIndices;
+    private readonly T[] _owners;
+
+    public RVARangeIndex(IEnumerable<T> ownersInPriorityOrder, Func<T, IEnumerable<RVARange>> rangesOfOwner)
+    {
+        ArgumentNullException.ThrowIfNull(ownersInPriorityOrder);
+        ArgumentNullException.ThrowIfNull(rangesOfOwner);
+
+        this._owners = ownersInPriorityOrder.ToArray();
+
+        var ranges = new List<(uint Start, uint End, int OwnerIndex)>(this._owners.Length);
+        for (var ownerIndex = 0; ownerIndex < this._owners.Length; ownerIndex++)
+        {
+            foreach (var range in rangesOfOwner(this._owners[ownerIndex]))
+            {
+                ranges.Add((range.RVAStart, range.RVAEnd, ownerIndex));
+            }
+        }
+
+        ranges.Sort(static (a, b) => a.Start != b.Start ? a.Start.CompareTo(b.Start) : a.OwnerIndex.CompareTo(b.OwnerIndex));
+
+        this._starts = new uint[ranges.Count];
+        this._ends = new uint[ranges.Count];
+        this._largestEndSoFar = new uint[ranges.Count];
+        this._ownerIndices = new int[ranges.Count];
+        var largestEnd = 0u;
+        for (var i = 0; i < ranges.Count; i++)
+        {
+            this._starts[i] = ranges[i].Start;
+            this._ends[i] = ranges[i].End;
+            this._ownerIndices[i] = ranges[i].OwnerIndex;
+            largestEnd = Math.Max(largestEnd, ranges[i].End);
+            this._largestEndSoFar[i] = largestEnd;
+        }
+    }
+
+    public int Count => this._starts.Length;
+
+    /// <summary>
+    /// Finds the first owner with a range that starts at or before <paramref name="rvaStart"/> and ends at or after <paramref name="rvaEnd"/>.
+    /// </summary>
+    /// <returns>The owner, or null if no range contains the queried one.</returns>
+    public T? FindFirstOwnerContaining(uint rvaStart, uint rvaEnd)
+    {
+        var bestOwnerIndex = Int32.MaxValue;
+
+        // Every range at or before this index starts at or before rvaStart, and none after it does.
+        for (var i = UpperBound(rvaStart) - 1; i >= 0 && this._largestEndSoFar[i] >= rvaEnd; i--)
+        {
+            if (this._ends[i] >= rvaEnd && this._ownerIndices[i] < bestOwnerIndex)
+            {
+                bestOwnerIndex = this._ownerIndices[i];
+            }
+        }
+
+        return bestOwnerIndex == Int32.MaxValue ? null : this._owners[bestOwnerIndex];
+    }
+
+    // The index of the first range that starts after rva, or Count if there isn't one.
+    private int UpperBound(uint rva)
+    {
+        int lo = 0, hi = this._starts.Length;
+        while (lo < hi)
+        {
+            var mid = lo + ((hi - lo) >> 1);
+            if (this._starts[mid] <= rva)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+
+        return lo;
+    }
+}
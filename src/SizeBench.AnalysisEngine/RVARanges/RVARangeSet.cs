@@ -2,93 +2,101 @@
 
 namespace SizeBench.AnalysisEngine;
 
+// A set of non-overlapping, non-adjacent RVA Ranges kept sorted by RVAStart.  Because nothing in the set overlaps, sorting by start also
+// sorts by end, so any point or overlap query only ever needs to look at the one range that starts closest to (at or before) the RVA of
+// interest - which is a binary search.  These sets get probed once per symbol in some hot loops (XDATA, other PE symbols, virtual-size-only
+// ranges) so that matters a lot on large binaries.
+//
+// Coalescing happens when building the set from a list (see FromListOfRVARanges), so callers adding ranges one at a time are still
+// expected to not add anything adjacent or overlapping.
 internal sealed class RVARangeSet : IEnumerable<RVARange>
 {
-    private readonly HashSet<RVARange> _rvaRanges;
+    private readonly List<RVARange> _rvaRanges;
 
     public RVARangeSet()
     {
-        this._rvaRanges = new HashSet<RVARange>(capacity: 7);
+        this._rvaRanges = new List<RVARange>(capacity: 7);
     }
 
     public RVARangeSet(int capacity)
     {
-        this._rvaRanges = new HashSet<RVARange>(capacity);
+        this._rvaRanges = new List<RVARange>(capacity);
     }
 
     public int Count => this._rvaRanges.Count;
 
     public void Add(RVARange range)
     {
-        foreach (var r in this._rvaRanges)
+        // Ranges are very commonly added in sorted order (FromListOfRVARanges does this), so this is usually an append.
+        var insertAt = IndexOfLastRangeStartingAtOrBefore(range.RVAStart) + 1;
+
+        if ((insertAt > 0 && OverlapsOrIsAdjacent(this._rvaRanges[insertAt - 1], range)) ||
+            (insertAt < this._rvaRanges.Count && OverlapsOrIsAdjacent(range, this._rvaRanges[insertAt])))
         {
-            if (r.IsAdjacentTo(range) || r.Contains(range) || range.Contains(r))
-            {
-                throw new ArgumentException("Don't add an adjacent or overlapping range to the set, instead coalesce them at the caller.  As an example, if you have (100, 200) in the set and you want to add (200, 300) you should instead have inserted (100,300) to begin with.");
-            }
+            throw new ArgumentException("Don't add an adjacent or overlapping range to the set, instead coalesce them at the caller.  As an example, if you have (100, 200) in the set and you want to add (200, 300) you should instead have inserted (100,300) to begin with.");
         }
 
-        this._rvaRanges.Add(range);
+        this._rvaRanges.Insert(insertAt, range);
     }
 
     public bool Contains(uint rva)
     {
-        foreach (var range in this._rvaRanges)
-        {
-            if (range.Contains(rva))
-            {
-                return true;
-            }
-        }
-
-        return false;
+        var index = IndexOfLastRangeStartingAtOrBefore(rva);
+        return index >= 0 && this._rvaRanges[index].RVAEnd >= rva;
     }
 
     public bool FullyContains(uint rva, uint size)
     {
-        foreach (var range in this._rvaRanges)
-        {
-            if (range.Contains(rva, size))
-            {
-                return true;
-            }
-        }
-
-        return false;
+        var index = IndexOfLastRangeStartingAtOrBefore(rva);
+        return index >= 0 && this._rvaRanges[index].Contains(rva, size);
     }
 
     public bool FullyContains(RVARange range)
     {
-        foreach (var r in this._rvaRanges)
-        {
-            if (r.Contains(range))
-            {
-                return true;
-            }
-        }
-
-        return false;
+        var index = IndexOfLastRangeStartingAtOrBefore(range.RVAStart);
+        return index >= 0 && this._rvaRanges[index].Contains(range);
     }
 
     public void UnionWith(RVARangeSet rvaRangeSet)
     {
         ArgumentNullException.ThrowIfNull(rvaRangeSet);
 
-        foreach (var range in rvaRangeSet._rvaRanges)
+        // Both sets are sorted, so this is a merge.  Any overlap or adjacency between the two sets will show up between two neighbors in the
+        // merged order, so that's the only place we need to look.  We build the merged list on the side so a throw leaves this set untouched.
+        var merged = new List<RVARange>(this._rvaRanges.Count + rvaRangeSet._rvaRanges.Count);
+        var ours = 0;
+        var theirs = 0;
+        while (ours < this._rvaRanges.Count || theirs < rvaRangeSet._rvaRanges.Count)
         {
-            foreach (var r in this._rvaRanges)
+            RVARange next;
+            if (theirs == rvaRangeSet._rvaRanges.Count ||
+                (ours < this._rvaRanges.Count && this._rvaRanges[ours].RVAStart <= rvaRangeSet._rvaRanges[theirs].RVAStart))
+            {
+                next = this._rvaRanges[ours++];
+            }
+            else
             {
-                if (r != range &&
-                    (r.IsAdjacentTo(range) ||
-                     r.Contains(range) ||
-                     range.Contains(r)))
+                next = rvaRangeSet._rvaRanges[theirs++];
+            }
+
+            if (merged.Count > 0)
+            {
+                if (merged[^1] == next)
+                {
+                    continue; // The same range being in both sets is fine, it's a set.
+                }
+
+                if (OverlapsOrIsAdjacent(merged[^1], next))
                 {
                     throw new ArgumentException("Don't union in something that will add an overlapping or adjacent range.  Coalesce them at the caller or make this code more resilient so coalescing is done in RVARangeSet.");
                 }
             }
+
+            merged.Add(next);
         }
 
-        this._rvaRanges.UnionWith(rvaRangeSet._rvaRanges);
+        this._rvaRanges.Clear();
+        this._rvaRanges.AddRange(merged);
     }
 
     public bool AtLeastPartiallyOverlapsWith(RVARange incoming)
@@ -96,24 +104,45 @@ internal sealed class RVARangeSet : IEnumerable<RVARange>
         // There's three cases here.  Imagine this scenario:
         // RVARangeSet contains: (0, 100) and (200, 300)
         // We need to return 'true' for these three cases:
-        // 1) AtLeastPartiallyOverlapsWith(50, 150), via range.Contains(rvaStart)
-        // 2) AtLeastPartiallyOverlapsWith(150, 250), via range.Contains(rvaEnd)
-        // 3) AtLeastPartiallyOverlapsWith(150, 350), via (150,350).Contains(range) because it'll contain (200,300)
+        // 1) AtLeastPartiallyOverlapsWith(50, 150), since (0, 100) contains the start
+        // 2) AtLeastPartiallyOverlapsWith(150, 250), since (200, 300) contains the end
+        // 3) AtLeastPartiallyOverlapsWith(150, 350), since it contains (200,300)
+        //
+        // All three are covered by finding the last range that starts at or before incoming's end, and checking if that range ends at or
+        // after incoming's start.  Any earlier range ends even earlier, so if that one doesn't reach incoming, nothing does.
+        var index = IndexOfLastRangeStartingAtOrBefore(incoming.RVAEnd);
+        return index >= 0 && this._rvaRanges[index].RVAEnd >= incoming.RVAStart;
+    }
+
+    public IEnumerator<RVARange> GetEnumerator() => this._rvaRanges.GetEnumerator();
+
+    IEnumerator IEnumerable.GetEnumerator() => GetEnumerator();
 
-        foreach (var range in this._rvaRanges)
+    // Returns -1 if every range in the set starts after this RVA.
+    private int IndexOfLastRangeStartingAtOrBefore(uint rva)
+    {
+        var lo = 0;
+        var hi = this._rvaRanges.Count - 1;
+        while (lo <= hi)
         {
-            if (range.Contains(incoming.RVAStart) || range.Contains(incoming.RVAEnd) || incoming.Contains(range))
+            var mid = lo + ((hi - lo) >> 1);
+            if (this._rvaRanges[mid].RVAStart <= rva)
+            {
+                lo = mid + 1;
+            }
+            else
             {
-                return true;
+                hi = mid - 1;
             }
         }
 
-        return false;
+        return hi;
     }
 
-    public IEnumerator<RVARange> GetEnumerator() => this._rvaRanges.GetEnumerator();
-
-    IEnumerator IEnumerable.GetEnumerator() => GetEnumerator();
+    // "Adjacent" here matches RVARange.IsAdjacentTo with its default padding: (100, 200) and (201, 300) are adjacent, but (100, 200) and
+    // (202, 300) are not.  Callers must ensure earlier starts at or before later.
+    private static bool OverlapsOrIsAdjacent(RVARange earlier, RVARange later)
+        => (ulong)later.RVAStart <= (ulong)earlier.RVAEnd + 1;
 
     public static List<RVARange> CoalesceRVARangesFromList(List<RVARange> ranges, uint maxPaddingToMerge = 1)
     {
@@ -0,0 +1,133 @@
+﻿using System.IO;
+using System.Runtime.InteropServices;
+
+namespace SizeBench.AnalysisEngine;
+
+// An immutable index from RVA to the symIndexIds of every symbol that starts at that RVA.  This is queried once per section, COFF Group,
+// contribution, etc. when enumerating symbols so it needs to be fast on very large binaries.
+//
+// It's laid out as a struct-of-arrays: a sorted array of distinct RVAs, and all the symIndexIds flattened into one array with offsets
+// marking where each RVA's symIndexIds begin.  That way lookups are a pair of binary searches over a dense uint[], and there's no per-RVA
+// List<uint> to chase through memory.
+internal sealed class SymIndicesByRVA
+{
+    private readonly uint[] _rvas;
+    private readonly int[] _symIndexOffsets; // _rvas.Length + 1 entries, the last is the total count of symIndexIds
+    private readonly uint[] _symIndices;
+
+    public SymIndicesByRVA(Dictionary<uint, List<uint>> symIndexIDsByRVA)
+    {
+        ArgumentNullException.ThrowIfNull(symIndexIDsByRVA);
+
+        this._rvas = new uint[symIndexIDsByRVA.Count];
+        var totalSymIndices = 0;
+        var i = 0;
+        foreach (var kvp in symIndexIDsByRVA)
+        {
+            this._rvas[i++] = kvp.Key;
+            totalSymIndices += kvp.Value.Count;
+        }
+
+        Array.Sort(this._rvas);
+
+        this._symIndexOffsets = new int[this._rvas.Length + 1];
+        this._symIndices = new uint[totalSymIndices];
+        var offset = 0;
+        for (i = 0; i < this._rvas.Length; i++)
+        {
+            this._symIndexOffsets[i] = offset;
+            var symIndices = symIndexIDsByRVA[this._rvas[i]];
+            symIndices.CopyTo(this._symIndices, offset);
+            offset += symIndices.Count;
+        }
+        this._symIndexOffsets[this._rvas.Length] = offset;
+    }
+
+    private SymIndicesByRVA(uint[] rvas, int[] symIndexOffsets, uint[] symIndices)
+    {
+        this._rvas = rvas;
+        this._symIndexOffsets = symIndexOffsets;
+        this._symIndices = symIndices;
+    }
+
+    public int Count => this._rvas.Length;
+
+    public uint RVAAt(int index) => this._rvas[index];
+
+    public ArraySegment<uint> SymIndicesAt(int index)
+        => new ArraySegment<uint>(this._symIndices, this._symIndexOffsets[index], this._symIndexOffsets[index + 1] - this._symIndexOffsets[index]);
+
+    /// <summary>
+    /// Finds the indices (suitable for <see cref="RVAAt(int)"/> and <see cref="SymIndicesAt(int)"/>) of the first and last RVA that fall
+    /// within <paramref name="range"/>, inclusive.
+    /// </summary>
+    /// <returns>false if no RVA in this index falls within the range.</returns>
+    public bool TryFindIndexRange(RVARange range, out int minIdx, out int maxIdx)
+    {
+        minIdx = LowerBound(range.RVAStart);
+        if (minIdx == this._rvas.Length || this._rvas[minIdx] > range.RVAEnd)
+        {
+            minIdx = maxIdx = 0;
+            return false;
+        }
+
+        // RVAEnd is inclusive, so we want the last RVA <= RVAEnd - which is one before the first RVA > RVAEnd.
+        maxIdx = range.RVAEnd == UInt32.MaxValue ? this._rvas.Length - 1 : LowerBound(range.RVAEnd + 1) - 1;
+        return true;
+    }
+
+    #region Serialization
+
+    // The arrays are written out as-is so that reading them back is a few bulk copies rather than rebuilding the index symbol by symbol.
+    internal void WriteTo(BinaryWriter writer)
+    {
+        writer.Write(this._rvas.Length);
+        writer.Write(this._symIndices.Length);
+        writer.Write(MemoryMarshal.AsBytes(this._rvas.AsSpan()));
+        writer.Write(MemoryMarshal.AsBytes(this._symIndexOffsets.AsSpan()));
+        writer.Write(MemoryMarshal.AsBytes(this._symIndices.AsSpan()));
+    }
+
+    internal static SymIndicesByRVA ReadFrom(BinaryReader reader)
+    {
+        var rvaCount = reader.ReadInt32();
+        var symIndexCount = reader.ReadInt32();
+        var bytesRemaining = reader.BaseStream.Length - reader.BaseStream.Position;
+        if (rvaCount < 0 || symIndexCount < 0 || ((2L * rvaCount) + 1 + symIndexCount) * sizeof(uint) > bytesRemaining)
+        {
+            throw new InvalidDataException("The serialized symIndexId index has a length that doesn't fit in what was serialized.");
+        }
+
+        var rvas = new uint[rvaCount];
+        var symIndexOffsets = new int[rvaCount + 1];
+        var symIndices = new uint[symIndexCount];
+        reader.BaseStream.ReadExactly(MemoryMarshal.AsBytes(rvas.AsSpan()));
+        reader.BaseStream.ReadExactly(MemoryMarshal.AsBytes(symIndexOffsets.AsSpan()));
+        reader.BaseStream.ReadExactly(MemoryMarshal.AsBytes(symIndices.AsSpan()));
+
+        // Lookups trust these invariants, so a damaged file must not get past here.
+        if (symIndexOffsets[0] != 0 || symIndexOffsets[rvaCount] != symIndexCount)
+        {
+            throw new InvalidDataException("The serialized symIndexId index has offsets that don't cover the symIndexIds.");
+        }
+
+        for (var i = 0; i < rvaCount; i++)
+        {
+            if (symIndexOffsets[i] > symIndexOffsets[i + 1] || (i > 0 && rvas[i - 1] >= rvas[i]))
+            {
+                throw new InvalidDataException("The serialized symIndexId index is not sorted.");
+            }
+        }
+
+        return new SymIndicesByRVA(rvas, symIndexOffsets, symIndices);
+    }
+
+    #endregion
+
+    // The index of the first RVA >= rva, or Count if there isn't one.
+    private int LowerBound(uint rva)
+    {
+        var index = Array.BinarySearch(this._rvas, rva);
+        return index >= 0 ? index : ~index;
+    }
+}
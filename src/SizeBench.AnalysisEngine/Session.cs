@@ -5,7 +5,9 @@ using System.IO;
 using System.Runtime.CompilerServices;
 using SizeBench.AnalysisEngine.DebuggerInterop;
 using SizeBench.AnalysisEngine.DIAInterop;
+using SizeBench.AnalysisEngine.Disassembly;
 using SizeBench.AnalysisEngine.Helpers;
+using SizeBench.AnalysisEngine.PDBInterop;
 using SizeBench.AnalysisEngine.PE;
 using SizeBench.AnalysisEngine.SessionTasks;
 using SizeBench.AnalysisEngine.Symbols;
@@ -23,7 +25,7 @@ public sealed class Session : ISession
     public string PdbPath => this._guaranteedLocalPDBFile?.OriginalPath ?? "No pdb opened yet";
 
     private readonly string _originalBinaryPathMayBeRemote;
-    public string BinaryPath => this._peFile?.GuaranteedLocalCopyOfBinary.OriginalPath ?? "No binary opened yet";
+    public string BinaryPath => this._peFile?.BinaryPath ?? "No binary opened yet";
 
     public byte BytesPerWord => this._peFile?.BytesPerWord ?? 0;
 
@@ -99,7 +101,10 @@ public sealed class Session : ISession
     private readonly QueuedTaskScheduler _taskScheduler;
     private readonly TaskFactory _taskFactory;
     private int _diaManagedThreadId;
-    private DIAAdapter? _diaAdapter;
+    private IDIAAdapter? _diaAdapter;
+
+    // Extra DIA sessions on the same PDB, each on its own thread, for the parts of analysis that can be split up - see DIAWorkerPool.
+    internal DIAWorkerPool? DIAWorkerPool { get; private set; }
 
     #endregion
 
@@ -139,7 +144,10 @@ public sealed class Session : ISession
     {
         this._logger = sessionLogger;
         this.SessionOptions = options;
-        this.DataCache = new SessionDataCache(options.SymbolSourcesSupported);
+        this.DataCache = new SessionDataCache(options.SymbolSourcesSupported, options.SymbolCacheMemoryBudgetInBytes, options.PoolSymbolNames)
+        {
+            UndecoratedNames = options.UndecoratedNameCache ?? new UndecoratedNameCache()
+        };
 
         Debug.Assert(File.Exists(pdbPath));
         this._originalPDBPathMayBeRemote = pdbPath;
@@ -163,14 +171,29 @@ public sealed class Session : ISession
         this.ProgressReporter?.Report(new SessionTaskProgress("Copying PDB file locally if necessary.", 0, null));
         this._guaranteedLocalPDBFile = new GuaranteedLocalFile(this._originalPDBPathMayBeRemote, initializeDiaThreadLog);
 
-        this._diaAdapter = new DIAAdapter(this, this._guaranteedLocalPDBFile.GuaranteedLocalPath);
+        DIAAdapter? diaAdapter = null;
+        ManagedPDBAdapter? managedPDBAdapter = null;
+        if (this.SessionOptions.PDBReader == PDBReader.Managed)
+        {
+            this._diaAdapter = managedPDBAdapter = new ManagedPDBAdapter(this, this._guaranteedLocalPDBFile.GuaranteedLocalPath);
+        }
+        else
+        {
+            this._diaAdapter = diaAdapter = new DIAAdapter(this, this._guaranteedLocalPDBFile.GuaranteedLocalPath);
+
+            if (this.SessionOptions.DIAWorkerCount > 0)
+            {
+                this.DIAWorkerPool = new DIAWorkerPool(this._guaranteedLocalPDBFile.GuaranteedLocalPath, this.SessionOptions.DIAWorkerCount);
+            }
+        }
         this._taskParameters = new SessionTaskParameters(this, this._diaAdapter, this.DataCache);
 
         this._peFile = new PEFile(this._originalBinaryPathMayBeRemote, this.SessionOptions.SymbolSourcesSupported, initializeDiaThreadLog);
         this.DataCache.BytesPerWord = this._peFile.BytesPerWord;
         this.DataCache.RsrcRVARange = this._peFile.RsrcRange;
 
-        this._diaAdapter.Initialize(this._peFile, initializeDiaThreadLog);
+        diaAdapter?.Initialize(this._peFile, initializeDiaThreadLog);
+        managedPDBAdapter?.Initialize(this._peFile, initializeDiaThreadLog);
     }
 
     #endregion
@@ -184,6 +207,9 @@ public sealed class Session : ISession
     public bool CompareData(long RVA1, long RVA2, uint length)
         => this._peFile!.CompareData(RVA1, RVA2, length);
 
+    public int HashData(long RVA, uint length)
+        => this._peFile!.HashData(RVA, length);
+
     public float CompareSimilarityOfCodeBytesInBinary(IFunctionCodeSymbol firstSymbol, IFunctionCodeSymbol secondSymbol)
     {
         ArgumentNullException.ThrowIfNull(firstSymbol);
@@ -210,6 +236,19 @@ public sealed class Session : ISession
         return this._peFile!.CompareSimilarityOfBytesInBinary(firstRanges, secondRanges);
     }
 
+    public IReadOnlyList<ulong> FingerprintCodeBytesInBinary(IFunctionCodeSymbol functionSymbol)
+    {
+        ArgumentNullException.ThrowIfNull(functionSymbol);
+
+        var ranges = new List<RVARange>();
+        foreach (var block in functionSymbol.Blocks)
+        {
+            ranges.Add(new RVARange(block.RVA, block.RVAEnd));
+        }
+
+        return this._peFile!.ComputeMinHashOfBytesInBinary(ranges);
+    }
+
     #region Debug Helpers
 
     // Things in this region are meant to help when debugging SizeBench, since the debugger can't do LINQ queries so it is hard
@@ -246,9 +285,15 @@ public sealed class Session : ISession
 
         this._taskScheduler.Dispose();
 
+        this.DIAWorkerPool?.Dispose();
+        this.DIAWorkerPool = null;
+
         this._peFile?.Dispose();
         this._peFile = null;
 
+        var names = this.DataCache.Names;
+        this._logger.Log($"Name pool: {names.DuplicateNamesFound:N0} of the {names.NamesLookedUp:N0} symbol names seen were duplicates of one of {names.DistinctNameCount:N0} distinct names, sharing them saved roughly {names.ApproximateBytesSaved / 1024:N0} KB ({names.ApproximateDuplicateBytes / 1024:N0} KB of duplicates, less {names.ApproximatePoolBytes / 1024:N0} KB for the pool itself).");
+
         this.DataCache.Dispose();
 
         if (this._debuggerAdapter != null)
@@ -258,7 +303,7 @@ public sealed class Session : ISession
 
         if (disposing)
         {
-            this._diaAdapter?.Dispose();
+            (this._diaAdapter as IDisposable)?.Dispose();
         }
 
         this._guaranteedLocalPDBFile?.Dispose();
@@ -474,6 +519,98 @@ public sealed class Session : ISession
 
     #endregion
 
+    #region Stream Symbols in Compiland, COFF Group, Lib, Contribution, Binary Section, Source File
+
+    public IAsyncEnumerable<ISymbol> StreamSymbolsInCompiland(Compiland compiland, CancellationToken token)
+        => StreamSymbolsInCompiland(compiland, new SymbolEnumerationOptions(), token, null);
+
+    public IAsyncEnumerable<ISymbol> StreamSymbolsInCompiland(Compiland compiland, SymbolEnumerationOptions options, CancellationToken token)
+        => StreamSymbolsInCompiland(compiland, options, token, null);
+
+    public IAsyncEnumerable<ISymbol> StreamSymbolsInCompiland(Compiland compiland, SymbolEnumerationOptions options, CancellationToken token, ILogger? parentLogger)
+    {
+        ArgumentNullException.ThrowIfNull(compiland);
+
+        var task = new EnumerateSymbolsInCompilandSessionTask(this._taskParameters!,
+                                                              token,
+                                                              this.ProgressReporter,
+                                                              compiland,
+                                                              options);
+        return StreamSymbolsFromDIAThread(task.ExecuteStreaming, parentLogger, token);
+    }
+
+    public IAsyncEnumerable<ISymbol> StreamSymbolsInCOFFGroup(COFFGroup coffGroup, CancellationToken token)
+        => StreamSymbolsInCOFFGroup(coffGroup, token, null);
+
+    public IAsyncEnumerable<ISymbol> StreamSymbolsInCOFFGroup(COFFGroup coffGroup, CancellationToken token, ILogger? parentLogger)
+    {
+        ArgumentNullException.ThrowIfNull(coffGroup);
+
+        var task = new EnumerateSymbolsInCOFFGroupSessionTask(this._taskParameters!,
+                                                              token,
+                                                              this.ProgressReporter,
+                                                              coffGroup);
+        return StreamSymbolsFromDIAThread(task.ExecuteStreaming, parentLogger, token);
+    }
+
+    public IAsyncEnumerable<ISymbol> StreamSymbolsInBinarySection(BinarySection section, CancellationToken token)
+        => StreamSymbolsInBinarySection(section, token, null);
+
+    public IAsyncEnumerable<ISymbol> StreamSymbolsInBinarySection(BinarySection section, CancellationToken token, ILogger? parentLogger)
+    {
+        ArgumentNullException.ThrowIfNull(section);
+
+        var task = new EnumerateSymbolsInBinarySectionSessionTask(this._taskParameters!,
+                                                                  token,
+                                                                  this.ProgressReporter,
+                                                                  section);
+        return StreamSymbolsFromDIAThread(task.ExecuteStreaming, parentLogger, token);
+    }
+
+    public IAsyncEnumerable<ISymbol> StreamSymbolsInLib(Library library, CancellationToken token)
+        => StreamSymbolsInLib(library, token, null);
+
+    public IAsyncEnumerable<ISymbol> StreamSymbolsInLib(Library library, CancellationToken token, ILogger? parentLogger)
+    {
+        ArgumentNullException.ThrowIfNull(library);
+
+        var task = new EnumerateSymbolsInLibSessionTask(this._taskParameters!,
+                                                        token,
+                                                        this.ProgressReporter,
+                                                        library);
+        return StreamSymbolsFromDIAThread(task.ExecuteStreaming, parentLogger, token);
+    }
+
+    public IAsyncEnumerable<ISymbol> StreamSymbolsInContribution(Contribution contribution, CancellationToken token)
+        => StreamSymbolsInContribution(contribution, token, null);
+
+    public IAsyncEnumerable<ISymbol> StreamSymbolsInContribution(Contribution contribution, CancellationToken token, ILogger? parentLogger)
+    {
+        ArgumentNullException.ThrowIfNull(contribution);
+
+        var task = new EnumerateSymbolsInContributionSessionTask(this._taskParameters!,
+                                                                 token,
+                                                                 this.ProgressReporter,
+                                                                 contribution);
+        return StreamSymbolsFromDIAThread(task.ExecuteStreaming, parentLogger, token);
+    }
+
+    public IAsyncEnumerable<ISymbol> StreamSymbolsInSourceFile(SourceFile sourceFile, CancellationToken token)
+        => StreamSymbolsInSourceFile(sourceFile, token, null);
+
+    public IAsyncEnumerable<ISymbol> StreamSymbolsInSourceFile(SourceFile sourceFile, CancellationToken token, ILogger? parentLogger)
+    {
+        ArgumentNullException.ThrowIfNull(sourceFile);
+
+        var task = new EnumerateSymbolsInSourceFileSessionTask(this._taskParameters!,
+                                                               token,
+                                                               this.ProgressReporter,
+                                                               sourceFile);
+        return StreamSymbolsFromDIAThread(task.ExecuteStreaming, parentLogger, token);
+    }
+
+    #endregion
+
     #region Lookup a symbol's placement in the binary
 
     public Task<SymbolPlacement> LookupSymbolPlacementInBinary(ISymbol symbol,
@@ -506,6 +643,34 @@ public sealed class Session : ISession
         return PerformSessionTaskOnDIAThread(task, token);
     }
 
+    public Task<IReadOnlyList<SymbolPlacement>> LookupSymbolPlacementsInBinary(IEnumerable<ISymbol> symbols,
+                                                                               CancellationToken token)
+        => LookupSymbolPlacementsInBinaryCore(symbols, options: null, token);
+
+    public Task<IReadOnlyList<SymbolPlacement>> LookupSymbolPlacementsInBinary(IEnumerable<ISymbol> symbols,
+                                                                               LookupSymbolPlacementOptions options,
+                                                                               CancellationToken token)
+    {
+        ArgumentNullException.ThrowIfNull(options);
+
+        return LookupSymbolPlacementsInBinaryCore(symbols, options, token);
+    }
+
+    private async Task<IReadOnlyList<SymbolPlacement>> LookupSymbolPlacementsInBinaryCore(IEnumerable<ISymbol> symbols,
+                                                                                          LookupSymbolPlacementOptions? options,
+                                                                                          CancellationToken token)
+    {
+        ArgumentNullException.ThrowIfNull(symbols);
+
+        var task = new LookupSymbolPlacementsInBinarySessionTask(symbols.ToList(),
+                                                                 options,
+                                                                 this._taskParameters!,
+                                                                 token,
+                                                                 this.ProgressReporter);
+
+        return await PerformSessionTaskOnDIAThread(task, token).ConfigureAwait(true);
+    }
+
     #endregion
 
     #region Load single symbol by RVA, or all the symbols folded to an RVA
@@ -624,6 +789,27 @@ public sealed class Session : ISession
 
     #endregion
 
+    #region Near-Duplicate Functions
+
+    public Task<IReadOnlyList<NearDuplicateFunctionCluster>> EnumerateNearDuplicateFunctions(CancellationToken token)
+        => EnumerateNearDuplicateFunctions(token, null);
+
+    public async Task<IReadOnlyList<NearDuplicateFunctionCluster>> EnumerateNearDuplicateFunctions(CancellationToken token, ILogger? parentLogger)
+    {
+        if (this.DataCache.AllNearDuplicateFunctionClusters is null)
+        {
+            var task = new EnumerateNearDuplicateFunctionsSessionTask(this._taskParameters!,
+                this.ProgressReporter,
+                token);
+
+            this.DataCache.AllNearDuplicateFunctionClusters = await PerformSessionTaskOnDIAThread(task, token, parentLogger).ConfigureAwait(true);
+        }
+
+        return this.DataCache.AllNearDuplicateFunctionClusters;
+    }
+
+    #endregion
+
     #region Type Layout
 
     public Task<IReadOnlyList<TypeLayoutItem>> LoadAllTypeLayouts(CancellationToken token)
@@ -765,6 +951,11 @@ public sealed class Session : ISession
         ArgumentNullException.ThrowIfNull(functionSymbol);
         ArgumentNullException.ThrowIfNull(options);
 
+        if (this.SessionOptions.Disassembler == Disassembler.Managed && ManagedDisassembler.SupportsMachineType(this._peFile!.MachineType))
+        {
+            return await DisassembleFunctionWithManagedDisassembler(functionSymbol, options, token).ConfigureAwait(true);
+        }
+
         try
         {
             await EnsureDebuggerAdapter(token).ConfigureAwait(true);
@@ -788,6 +979,16 @@ public sealed class Session : ISession
         return disassembly;
     }
 
+    private async Task<string> DisassembleFunctionWithManagedDisassembler(IFunctionCodeSymbol functionSymbol, DisassembleFunctionOptions options, CancellationToken token)
+    {
+        var logEntry = $"Disassembling {functionSymbol.FullName}";
+        using var taskLog = this._logger.StartTaskLog(logEntry);
+        this.ProgressReporter?.Report(new SessionTaskProgress(logEntry, 0, null));
+
+        // Decoding happens right here, only looking up the symbols that instructions refer to goes over to the DIA thread.
+        return await ManagedDisassembler.DisassembleAsync(this, this._peFile!, functionSymbol, options, taskLog, token).ConfigureAwait(true);
+    }
+
     #endregion
 
     #region Annotations
@@ -837,6 +1038,58 @@ public sealed class Session : ISession
         return results;
     }
 
+    // How many symbols are pulled from DIA each time a stream goes back to the DIA thread.  Big enough that the hop to the DIA thread is
+    // cheap relative to the work, small enough that a slow consumer isn't holding onto much.
+    internal const int SymbolStreamBatchSize = 1000;
+
+    // Enumeration of symbols has to happen on the DIA thread, but the consumer of a stream is somewhere else and may be slow (writing to
+    // a database, say).  So the enumerator is advanced on the DIA thread one batch at a time, and only when the consumer has finished the
+    // previous batch - that bounds how far ahead of the consumer we get, and leaves the DIA thread free in between batches so the consumer
+    // can call back into this Session while it's streaming.
+    private async IAsyncEnumerable<ISymbol> StreamSymbolsFromDIAThread(Func<ILogger, IEnumerable<ISymbol>> executeStreaming,
+                                                                      ILogger? parentLogger,
+                                                                      [EnumeratorCancellation] CancellationToken token)
+    {
+        IEnumerator<ISymbol>? symbols = null;
+        var batch = new List<ISymbol>(SymbolStreamBatchSize);
+        var reachedEnd = false;
+
+        try
+        {
+            while (!reachedEnd)
+            {
+                batch.Clear();
+                await PerformWorkOnDIAThread(() =>
+                {
+                    symbols ??= executeStreaming(parentLogger ?? this._logger).GetEnumerator();
+                    while (batch.Count < SymbolStreamBatchSize)
+                    {
+                        if (!symbols.MoveNext())
+                        {
+                            reachedEnd = true;
+                            break;
+                        }
+                        batch.Add(symbols.Current);
+                    }
+                }, token).ConfigureAwait(true);
+
+                foreach (var symbol in batch)
+                {
+                    yield return symbol;
+                }
+            }
+        }
+        finally
+        {
+            // Disposing the enumerator closes the task log and anything DIA was in the middle of enumerating, so that needs the DIA thread
+            // too - unless the Session is already going away, in which case it's about to be cleaned up regardless.
+            if (symbols is not null && !this.IsDisposing && !this.IsDisposed)
+            {
+                await PerformWorkOnDIAThread(symbols.Dispose, CancellationToken.None).ConfigureAwait(true);
+            }
+        }
+    }
+
     private async Task PerformWorkOnDIAThread(Action action, CancellationToken token)
     {
         ThrowIfDisposingOrDisposed();
@@ -0,0 +1,111 @@
+﻿namespace SizeBench.AnalysisEngine;
+
+// Every name we get from DIA is a freshly allocated string, even when it's a name we've seen thousands of times already - every
+// parameter named "this", every inline site of the same function, every pointer type to the same type from a different compiland,
+// and so on.  On very large PDBs those duplicates add up to a lot of memory that lives as long as the session does, since the symbols
+// holding onto them are cached.
+//
+// So symbols pass their names through this pool as they're constructed, and keep the one shared copy instead of their own.  The
+// duplicate DIA handed back is then short-lived garbage rather than something the session keeps alive.
+//
+// With a SymbolCacheBudget, the pool ages along with the SymbolCaches so it doesn't keep every name the session has ever seen alive after
+// the symbols that used them have been let go.  Names are kept in two generations, like the symbols: a name looked up from the previous
+// generation moves back into the current one, and when the budget starts a new generation, the previous generation's names are forgotten.
+// A forgotten name that's still held by a symbol stays alive in that symbol - the next symbol with that name just gets its own copy, which
+// then becomes the pooled one.
+//
+// The pool isn't free - each distinct name costs a set entry, plus the set's unused capacity - so ApproximateBytesSaved is what's left of
+// the duplicates' size after that, which on a binary with few repeated names can be negative.
+//
+// Like the rest of the SessionDataCache this is only touched from the DIA thread, so it is not thread-safe.
+internal sealed class NamePool : IGenerationalSymbolCache
+{
+    // A string on a 64-bit runtime is a 16-byte object header + method table pointer, a 4-byte length, and 2 bytes per char plus a
+    // null terminator - rounded up to 8 bytes.  This is just for reporting how much we saved, so approximate is fine.
+    private const int StringOverheadInBytes = 16 + 4 + 2;
+
+    // Each slot in a HashSet<string> is an entry (a 4-byte hash code, a 4-byte next index, and the 8-byte reference) plus a 4-byte bucket,
+    // and there are as many slots as the set's capacity, used or not.
+    private const int BytesPerHashSetSlot = 4 + 4 + 8 + 4;
+
+    private readonly bool _isEnabled;
+    private HashSet<string> _names = new HashSet<string>(StringComparer.Ordinal);
+    private HashSet<string>? _previousNames;
+
+    // A disabled pool hands every name straight back, which is only for measuring what the pool saves - see SessionOptions.PoolSymbolNames.
+    public NamePool(SymbolCacheBudget? budget = null, bool isEnabled = true)
+    {
+        this._isEnabled = isEnabled;
+        if (budget != null)
+        {
+            this._previousNames = new HashSet<string>(StringComparer.Ordinal);
+            budget.Register(this);
+        }
+    }
+
+    public int DistinctNameCount => this._names.Count + (this._previousNames?.Count ?? 0);
+
+    public long NamesLookedUp { get; private set; }
+
+    public long DuplicateNamesFound { get; private set; }
+
+    // How much the duplicates that were dropped in favor of a pooled name would have taken up.
+    public long ApproximateDuplicateBytes { get; private set; }
+
+    // What the sets themselves take up, at their current capacity.
+    public long ApproximatePoolBytes
+        => BytesPerHashSetSlot * ((long)this._names.EnsureCapacity(0) + (this._previousNames?.EnsureCapacity(0) ?? 0));
+
+    public long ApproximateBytesSaved => this.ApproximateDuplicateBytes - this.ApproximatePoolBytes;
+
+    public string Intern(string name)
+    {
+        this.NamesLookedUp++;
+
+        if (!this._isEnabled)
+        {
+            return name;
+        }
+
+        if (!this._names.TryGetValue(name, out var pooledName))
+        {
+            // A name from the previous generation that's still being looked up moves back into the current one, so it stays shared.
+            if (this._previousNames != null && this._previousNames.TryGetValue(name, out pooledName))
+            {
+                this._previousNames.Remove(pooledName);
+            }
+            else
+            {
+                pooledName = name;
+            }
+
+            this._names.Add(pooledName);
+        }
+
+        if (!ReferenceEquals(pooledName, name))
+        {
+            this.DuplicateNamesFound++;
+            this.ApproximateDuplicateBytes += (StringOverheadInBytes + (2L * name.Length) + 7) & ~7L;
+        }
+
+        return pooledName;
+    }
+
+    public void Clear()
+    {
+        this._names.Clear();
+        this._previousNames?.Clear();
+    }
+
+    int IGenerationalSymbolCache.StartNewGeneration()
+    {
+        // The previous generation's set is emptied and reused as the new current one, so its capacity isn't reallocated every generation.
+        var forgotten = this._previousNames!;
+        forgotten.Clear();
+        this._previousNames = this._names;
+        this._names = forgotten;
+
+        // Names aren't symbols, so none of this counts towards SymbolCacheBudget.SymbolsEvicted.
+        return 0;
+    }
+}
@@ -0,0 +1,33 @@
+﻿using System.ComponentModel.DataAnnotations;
+using System.Diagnostics;
+using SizeBench.AnalysisEngine.Symbols;
+
+namespace SizeBench.AnalysisEngine;
+
+// A group of functions whose code bytes are nearly the same, found by comparing every function in the binary (not just instantiations of the
+// same template).  These are candidates for sharing one implementation - for example by hoisting the parts that don't depend on a template
+// argument out into a non-templated helper.
+[DebuggerDisplay("Near-duplicate functions: {Functions.Count} like {Functions[0].FullName}")]
+public sealed class NearDuplicateFunctionCluster
+{
+    // The largest function comes first, and is the one every other function was compared against.
+    public IReadOnlyList<IFunctionCodeSymbol> Functions { get; }
+
+    public uint TotalSize { get; }
+
+    [DisplayFormat(DataFormatString = "{0:P1}")] // Format as percentage
+    public float EstimatedSimilarity { get; }
+
+    // If every function but the first were folded into the first, the similar part of each of them would no longer be needed.
+    public uint EstimatedSavingsIfFolded { get; }
+
+    internal NearDuplicateFunctionCluster(IReadOnlyList<IFunctionCodeSymbol> functions,
+                                          float estimatedSimilarity,
+                                          uint estimatedSavingsIfFolded)
+    {
+        this.Functions = functions;
+        this.TotalSize = (uint)functions.Sum(static f => f.Size);
+        this.EstimatedSimilarity = estimatedSimilarity;
+        this.EstimatedSavingsIfFolded = estimatedSavingsIfFolded;
+    }
+}
@@ -89,18 +89,32 @@ internal sealed class SessionDataCache : IDisposable
     internal List<DuplicateDataItem>? AllDuplicateDataItems { get; set; }
     internal List<WastefulVirtualItem>? AllWastefulVirtualItems { get; set; }
     internal List<TemplateFoldabilityItem>? AllTemplateFoldabilityItems { get; set; }
+    internal List<NearDuplicateFunctionCluster>? AllNearDuplicateFunctionClusters { get; set; }
     internal List<AnnotationSymbol>? AllAnnotations { get; set; }
 
     internal SortedList<uint, NameCanonicalization>? AllCanonicalNames { get; set; }
 
+    // Ages along with the symbol caches when there's a SymbolCacheBudget - see NamePool.
+    internal NamePool Names { get; }
+
+    // Unlike Names, this may be shared with another Session - see UndecoratedNameCache.
+    internal UndecoratedNameCache UndecoratedNames { get; init; } = new UndecoratedNameCache();
+
     #region Symbols of specific types, and the big cache with all symbols
 
-    public Dictionary<uint, TypeSymbol> AllTypesBySymIndexId { get; } = new Dictionary<uint, TypeSymbol>(capacity: 1_000);
-    public Dictionary<uint, AnnotationSymbol> AllAnnotationsBySymIndexId { get; } = new Dictionary<uint, AnnotationSymbol>();
-    public Dictionary<uint, ISymbol> AllSymbolsBySymIndexId { get; } = new Dictionary<uint, ISymbol>(capacity: 10_000);
-    public Dictionary<uint, MemberDataSymbol> AllMemberDataSymbolsBySymIndexId { get; } = new Dictionary<uint, MemberDataSymbol>(capacity: 1_000);
-    public Dictionary<uint, ParameterDataSymbol> AllParameterDataSymbolsbySymIndexId { get; } = new Dictionary<uint, ParameterDataSymbol>(capacity: 1_000);
-    public Dictionary<uint, IFunctionCodeSymbol> AllFunctionSymbolsBySymIndexIdOfPrimaryBlock { get; } = new Dictionary<uint, IFunctionCodeSymbol>(capacity: 1_000);
+    // These can all be held to a budget (see SymbolCache), since anything evicted can be parsed again from its SymIndexId.  Null when the
+    // Session has no budget, which is the default.
+    internal SymbolCacheBudget? SymbolCacheBudget { get; }
+
+    public SymbolCache<TypeSymbol> AllTypesBySymIndexId { get; }
+    public SymbolCache<AnnotationSymbol> AllAnnotationsBySymIndexId { get; }
+    public SymbolCache<ISymbol> AllSymbolsBySymIndexId { get; }
+    public SymbolCache<MemberDataSymbol> AllMemberDataSymbolsBySymIndexId { get; }
+    public SymbolCache<ParameterDataSymbol> AllParameterDataSymbolsbySymIndexId { get; }
+    public SymbolCache<IFunctionCodeSymbol> AllFunctionSymbolsBySymIndexIdOfPrimaryBlock { get; }
+
+    // Not held to the budget, since having any inline sites in here means every one of them has been parsed - see
+    // DIAAdapter.FindAllInlineSites.
     public Dictionary<uint, InlineSiteSymbol> AllInlineSiteSymbolsBySymIndexId { get; } = new Dictionary<uint, InlineSiteSymbol>(capacity: 100);
 
     internal UserDefinedTypeSymbol[]? AllUserDefinedTypes { get; set; }
@@ -135,7 +149,7 @@ internal sealed class SessionDataCache : IDisposable
 
     #region Pre-Processed Symbol Info
 
-    private List<(uint rva, List<uint> symIndices)>? _allSymIndexIDsByRVA;
+    private SymIndicesByRVA? _allSymIndexIDsByRVA;
     private HashSet<uint>? _rvasOfLabelSymbols;
 
     public bool LabelExistsAtRVA(uint rva) => this._rvasOfLabelSymbols?.Contains(rva) ?? false;
@@ -152,56 +166,32 @@ internal sealed class SessionDataCache : IDisposable
             return;
         }
 
-        this._allSymIndexIDsByRVA = new List<(uint, List<uint>)>(symIndexIDsByRVA.Count);
-        foreach (var kvp in symIndexIDsByRVA.OrderBy(x => x.Key))
-        {
-            this._allSymIndexIDsByRVA!.Add((kvp.Key, kvp.Value));
-        }
+        this._allSymIndexIDsByRVA = new SymIndicesByRVA(symIndexIDsByRVA);
     }
 
-    internal bool TryFindSymIndicesInRVARange(RVARange range, [NotNullWhen(true)] out List<(uint rva, List<uint> symIndices)>? symIndicesByRVA, out int minIdx, out int maxIdx)
+    // Used when the pre-processed symbol info comes from an analysis cache file rather than from walking the PDB.
+    internal void InitializeRVARanges(SymIndicesByRVA? symIndicesByRVA, HashSet<uint> rvasOfLabelSymbols)
     {
-        // If we have nothing or the very first RVA is beyond the end of the range we're looking for, then we've found nothing.
-        if (this._allSymIndexIDsByRVA is null || this._allSymIndexIDsByRVA[0].rva > range.RVAEnd)
-        {
-            symIndicesByRVA = null;
-            minIdx = maxIdx = 0;
-            return false;
-        }
-
-        var minIdxFound = false;
-        minIdx = 0;
-        maxIdx = this._allSymIndexIDsByRVA.Count - 1;
+        this._rvasOfLabelSymbols = rvasOfLabelSymbols;
+        this._allSymIndexIDsByRVA = symIndicesByRVA is null || symIndicesByRVA.Count == 0 ? null : symIndicesByRVA;
+    }
 
-        // This is a linear walk, but we could probably make it even faster by using a binary search.
-        for (var i = 0; i < this._allSymIndexIDsByRVA.Count; i++)
-        {
-            var r = this._allSymIndexIDsByRVA[i];
-            if (!minIdxFound && range.Contains(r.rva))
-            {
-                minIdx = i;
-                minIdxFound = true;
-            }
-
-            if (r.rva > range.RVAEnd)
-            {
-                maxIdx = i - 1;
-                break;
-            }
-        }
+    internal SymIndicesByRVA? AllSymIndexIDsByRVA => this._allSymIndexIDsByRVA;
+    internal IReadOnlyCollection<uint> RVAsOfLabelSymbols => this._rvasOfLabelSymbols ?? (IReadOnlyCollection<uint>)[];
 
-        // We may find that our range is between two RVAs - if so, we found nothing.
-        if (!minIdxFound || (minIdx == maxIdx && !range.Contains(this._allSymIndexIDsByRVA[minIdx].rva)))
+    internal bool TryFindSymIndicesInRVARange(RVARange range, [NotNullWhen(true)] out SymIndicesByRVA? symIndicesByRVA, out int minIdx, out int maxIdx)
+    {
+        if (this._allSymIndexIDsByRVA is null || !this._allSymIndexIDsByRVA.TryFindIndexRange(range, out minIdx, out maxIdx))
         {
             symIndicesByRVA = null;
             minIdx = maxIdx = 0;
             return false;
         }
 
-        System.Diagnostics.Debug.Assert(!minIdxFound || minIdx == 0 || this._allSymIndexIDsByRVA[minIdx - 1].rva <= range.RVAStart);
-        System.Diagnostics.Debug.Assert(this._allSymIndexIDsByRVA[minIdx].rva >= range.RVAStart);
-        System.Diagnostics.Debug.Assert(this._allSymIndexIDsByRVA[maxIdx].rva <= range.RVAEnd);
-        System.Diagnostics.Debug.Assert(maxIdx == this._allSymIndexIDsByRVA.Count - 1 || this._allSymIndexIDsByRVA[maxIdx + 1].rva > range.RVAEnd);
+        System.Diagnostics.Debug.Assert(minIdx == 0 || this._allSymIndexIDsByRVA.RVAAt(minIdx - 1) < range.RVAStart);
+        System.Diagnostics.Debug.Assert(this._allSymIndexIDsByRVA.RVAAt(minIdx) >= range.RVAStart);
+        System.Diagnostics.Debug.Assert(this._allSymIndexIDsByRVA.RVAAt(maxIdx) <= range.RVAEnd);
+        System.Diagnostics.Debug.Assert(maxIdx == this._allSymIndexIDsByRVA.Count - 1 || this._allSymIndexIDsByRVA.RVAAt(maxIdx + 1) > range.RVAEnd);
 
         symIndicesByRVA = this._allSymIndexIDsByRVA;
         return true;
@@ -209,11 +199,44 @@ internal sealed class SessionDataCache : IDisposable
 
     #endregion
 
+    #region Indexes for looking up where a symbol is placed
+
+    // Built the first time a symbol's placement is looked up, then shared by every lookup after that - without these, each lookup walked every
+    // COFF Group, and every range of every compiland and source file.  These are only ever touched from the DIA thread, like the rest of the
+    // cache, so they don't need any locking.
+    private RVARangeIndex<COFFGroup>? _coffGroupsByRVA;
+    private RVARangeIndex<Compiland>? _compilandsByRVA;
+    private RVARangeIndex<SourceFile>? _sourceFilesByRVA;
+
+    internal RVARangeIndex<COFFGroup> GetCOFFGroupsByRVA(IEnumerable<COFFGroup> allCOFFGroups)
+        => this._coffGroupsByRVA ??= new RVARangeIndex<COFFGroup>(allCOFFGroups, static cg => [new RVARange(cg.RVA, cg.RVA + cg.VirtualSize)]);
+
+    internal RVARangeIndex<Compiland> GetCompilandsByRVA(IEnumerable<Compiland> allCompilands)
+        => this._compilandsByRVA ??= new RVARangeIndex<Compiland>(allCompilands, static c => c.SectionContributions.Values.SelectMany(csc => csc.RVARanges));
+
+    internal RVARangeIndex<SourceFile> GetSourceFilesByRVA(IEnumerable<SourceFile> allSourceFiles)
+        => this._sourceFilesByRVA ??= new RVARangeIndex<SourceFile>(allSourceFiles, static sf => sf.SectionContributions.Values.SelectMany(sfsc => sfsc.RVARanges));
+
+    #endregion
+
     internal RVARangeSet? RVARangesThatAreOnlyVirtualSize { get; set; }
 
-    internal SessionDataCache(SymbolSourcesSupported symbolSourcesSupported = SymbolSourcesSupported.All)
+    internal SessionDataCache(SymbolSourcesSupported symbolSourcesSupported = SymbolSourcesSupported.All, long symbolCacheMemoryBudgetInBytes = 0, bool poolSymbolNames = true)
     {
         this.SymbolSourcesSupported = symbolSourcesSupported;
+
+        if (symbolCacheMemoryBudgetInBytes > 0)
+        {
+            this.SymbolCacheBudget = new SymbolCacheBudget(symbolCacheMemoryBudgetInBytes);
+        }
+
+        this.AllTypesBySymIndexId = new SymbolCache<TypeSymbol>(capacity: 1_000, this.SymbolCacheBudget);
+        this.AllAnnotationsBySymIndexId = new SymbolCache<AnnotationSymbol>(capacity: 0, this.SymbolCacheBudget);
+        this.AllSymbolsBySymIndexId = new SymbolCache<ISymbol>(capacity: 10_000, this.SymbolCacheBudget);
+        this.AllMemberDataSymbolsBySymIndexId = new SymbolCache<MemberDataSymbol>(capacity: 1_000, this.SymbolCacheBudget);
+        this.AllParameterDataSymbolsbySymIndexId = new SymbolCache<ParameterDataSymbol>(capacity: 1_000, this.SymbolCacheBudget);
+        this.AllFunctionSymbolsBySymIndexIdOfPrimaryBlock = new SymbolCache<IFunctionCodeSymbol>(capacity: 1_000, this.SymbolCacheBudget);
+        this.Names = new NamePool(this.SymbolCacheBudget, isEnabled: poolSymbolNames);
     }
 
     #region IDisposable Support
@@ -233,6 +256,9 @@ internal sealed class SessionDataCache : IDisposable
             this._sourceFilesByFilename = null;
             this._allSymIndexIDsByRVA = null;
             this._rvasOfLabelSymbols = null;
+            this._coffGroupsByRVA = null;
+            this._compilandsByRVA = null;
+            this._sourceFilesByRVA = null;
 
             this.AllBinarySections = null;
             this.AllCOFFGroups = null;
@@ -242,6 +268,7 @@ internal sealed class SessionDataCache : IDisposable
             this.AllDuplicateDataItems = null;
             this.AllWastefulVirtualItems = null;
             this.AllTemplateFoldabilityItems = null;
+            this.AllNearDuplicateFunctionClusters = null;
             this.AllAnnotations = null;
             this.AllCanonicalNames = null;
 
@@ -251,6 +278,7 @@ internal sealed class SessionDataCache : IDisposable
             this.AllMemberDataSymbolsBySymIndexId.Clear();
             this.AllParameterDataSymbolsbySymIndexId.Clear();
             this.AllFunctionSymbolsBySymIndexIdOfPrimaryBlock.Clear();
+            this.Names.Clear();
             this.AllUserDefinedTypes = null;
             this.AllUserDefinedTypeGroupings = null;
             this.AllDisambiguatingVTablePublicSymbolNamesByRVA = null;
@@ -331,6 +331,22 @@ public sealed class SourceFile
         return false;
     }
 
+    // The same ranges ContainsExecutableCodeAtRVA looks through, for building an index over many source files while they're still being constructed.
+    internal IEnumerable<RVARange> ExecutableCodeRVARangesRegardlessOfFinalConstructionState()
+    {
+        for (var i = 0; i < this._sectionContributionsAsList.Count; i++)
+        {
+            var kvp = this._sectionContributionsAsList[i];
+            if ((kvp.Key.Characteristics & SectionCharacteristics.MemExecute) == SectionCharacteristics.MemExecute)
+            {
+                foreach (var range in kvp.Value.RVARangesRegardlessOfFinalConstructionState)
+                {
+                    yield return range;
+                }
+            }
+        }
+    }
+
     internal bool Contains(uint rva, uint size)
     {
         foreach (var contribution in this._sectionContributions)
@@ -0,0 +1,173 @@
+﻿using System.Diagnostics.CodeAnalysis;
+
+namespace SizeBench.AnalysisEngine;
+
+// Lets a SymbolCacheBudget age every cache that shares it at once, whatever type of symbol each one holds.
+internal interface IGenerationalSymbolCache
+{
+    // Returns how many symbols stopped being held strongly.
+    int StartNewGeneration();
+}
+
+// The symbols of one type that a Session has parsed, by SymIndexId - see SessionDataCache.
+//
+// Without a budget this is just a Dictionary.  With one (see SessionOptions.SymbolCacheMemoryBudgetInBytes), symbols are kept in two
+// generations: the current generation holds its symbols strongly, the previous one only weakly.  Once the Session's caches have taken in a
+// budget's worth of symbols between them, every cache's current generation becomes its previous one, and whatever in the old previous
+// generation has been collected is forgotten.  A symbol that's found in the previous generation moves back into the current one, so the
+// symbols in use stay, and the rest are free to be collected unless something outside the cache still holds them.  This approximates LRU
+// without having to keep every symbol in a list ordered by use.
+//
+// Evicted symbols are kept weakly rather than dropped so that a symbol is never parsed a second time while the first copy is still alive
+// somewhere - code that compares symbols by reference, or keeps them in a HashSet, would otherwise see two copies of one symbol.  Once
+// nothing holds a symbol, looking it up misses, and the caller parses it from the PDB again by its SymIndexId just like the first time.
+//
+// Like the rest of the SessionDataCache, this is only used from the DIA thread, so it does no locking.
+internal sealed class SymbolCache<TSymbol> : IGenerationalSymbolCache where TSymbol : class
+{
+    private readonly SymbolCacheBudget? _budget;
+    private readonly Dictionary<uint, TSymbol> _current;
+    private readonly Dictionary<uint, WeakReference<TSymbol>>? _previous;
+
+    public SymbolCache(int capacity = 0, SymbolCacheBudget? budget = null)
+    {
+        this._current = new Dictionary<uint, TSymbol>(capacity);
+        if (budget != null)
+        {
+            this._budget = budget;
+            this._previous = new Dictionary<uint, WeakReference<TSymbol>>();
+            budget.Register(this);
+        }
+    }
+
+    // Includes symbols in the previous generation that may since have been collected, so this is an upper bound once there's a budget.
+    public int Count => this._current.Count + (this._previous?.Count ?? 0);
+
+    public TSymbol this[uint symIndexId]
+    {
+        get => TryGetValue(symIndexId, out var symbol) ? symbol : throw new KeyNotFoundException($"No symbol with SymIndexId {symIndexId} is in the cache.");
+        set
+        {
+            this._previous?.Remove(symIndexId);
+            var isNew = !this._current.ContainsKey(symIndexId);
+            this._current[symIndexId] = value;
+            if (isNew)
+            {
+                this._budget?.SymbolAdded();
+            }
+        }
+    }
+
+    // Unlike TryGetValue, this doesn't count as using the symbol, so it doesn't move it into the current generation.
+    public bool ContainsKey(uint symIndexId)
+        => this._current.ContainsKey(symIndexId) ||
+           (this._previous != null && this._previous.TryGetValue(symIndexId, out var weakSymbol) && weakSymbol.TryGetTarget(out _));
+
+    public bool TryGetValue(uint symIndexId, [MaybeNullWhen(false)] out TSymbol symbol)
+    {
+        if (this._current.TryGetValue(symIndexId, out symbol))
+        {
+            return true;
+        }
+
+        if (this._previous != null && this._previous.Remove(symIndexId, out var weakSymbol) && weakSymbol.TryGetTarget(out symbol))
+        {
+            this._current.Add(symIndexId, symbol);
+            this._budget!.SymbolAdded();
+            return true;
+        }
+
+        symbol = null;
+        return false;
+    }
+
+    public void Add(uint symIndexId, TSymbol symbol)
+    {
+        if (this._previous != null && this._previous.TryGetValue(symIndexId, out var weakSymbol))
+        {
+            if (weakSymbol.TryGetTarget(out _))
+            {
+                throw new ArgumentException($"A symbol with SymIndexId {symIndexId} is already in the cache.", nameof(symIndexId));
+            }
+
+            // The earlier copy was collected, so this one is its replacement.
+            this._previous.Remove(symIndexId);
+        }
+
+        this._current.Add(symIndexId, symbol);
+        this._budget?.SymbolAdded();
+    }
+
+    public void Clear()
+    {
+        this._current.Clear();
+        this._previous?.Clear();
+    }
+
+    int IGenerationalSymbolCache.StartNewGeneration()
+    {
+        var previous = this._previous!;
+
+        // Removing while enumerating is fine for a Dictionary, as long as nothing is added.
+        foreach (var (symIndexId, weakSymbol) in previous)
+        {
+            if (!weakSymbol.TryGetTarget(out _))
+            {
+                previous.Remove(symIndexId);
+            }
+        }
+
+        foreach (var (symIndexId, symbol) in this._current)
+        {
+            previous[symIndexId] = new WeakReference<TSymbol>(symbol);
+        }
+
+        var evicted = this._current.Count;
+        this._current.Clear();
+        return evicted;
+    }
+}
+
+// Holds all of a Session's SymbolCaches to one memory budget between them, and ages its NamePool along with them.
+internal sealed class SymbolCacheBudget
+{
+    // There's no cheap way to measure how much memory a symbol takes, so the budget is turned into a number of symbols with a rough
+    // average.  Most symbols are a name (interned in the NamePool, so often shared), a few numbers, and references to other symbols.
+    internal const int EstimatedBytesPerSymbol = 256;
+
+    private readonly List<IGenerationalSymbolCache> _caches = new List<IGenerationalSymbolCache>();
+    private long _symbolsAddedThisGeneration;
+
+    public long SymbolsPerGeneration { get; }
+
+    // How many times symbols have been moved from a current generation to a previous one - they may well still be alive, and be promoted
+    // back, but this shows how hard the budget is working.
+    public long SymbolsEvicted { get; private set; }
+
+    public SymbolCacheBudget(long memoryBudgetInBytes)
+    {
+        ArgumentOutOfRangeException.ThrowIfNegativeOrZero(memoryBudgetInBytes);
+        this.SymbolsPerGeneration = Math.Max(1, memoryBudgetInBytes / EstimatedBytesPerSymbol);
+    }
+
+    internal void Register(IGenerationalSymbolCache cache) => this._caches.Add(cache);
+
+    internal void SymbolAdded()
+    {
+        this._symbolsAddedThisGeneration++;
+        if (this._symbolsAddedThisGeneration < this.SymbolsPerGeneration)
+        {
+            return;
+        }
+
+        long evicted = 0;
+        foreach (var cache in this._caches)
+        {
+            evicted += cache.StartNewGeneration();
+        }
+
+        this._symbolsAddedThisGeneration = 0;
+        this.SymbolsEvicted += evicted;
+        AnalysisEngineEventSource.Log.SymbolsEvicted(evicted);
+    }
+}
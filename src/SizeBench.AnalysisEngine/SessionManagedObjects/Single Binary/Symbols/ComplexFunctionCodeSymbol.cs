@@ -75,7 +75,7 @@ public sealed class ComplexFunctionCodeSymbol : IFunctionCodeSymbol
         }
 #endif
 
-        this.FunctionName = name;
+        this.FunctionName = cache.Names.Intern(name);
         this.AccessModifier = accessModifier;
         this.IsIntroVirtual = isIntroVirtual;
         this.IsPure = isPure;
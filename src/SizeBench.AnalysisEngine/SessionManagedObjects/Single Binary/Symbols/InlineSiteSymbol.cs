@@ -29,7 +29,7 @@ public sealed class InlineSiteSymbol
         }
 #endif
 
-        this.Name = name;
+        this.Name = cache.Names.Intern(name);
         this.RVARanges = rvaRanges;
         this.SymIndexId = symIndexId;
         this.BlockInlinedInto = blockInlinedInto;
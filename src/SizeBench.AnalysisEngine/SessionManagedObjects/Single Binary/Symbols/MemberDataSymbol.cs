@@ -30,7 +30,7 @@ public sealed class MemberDataSymbol
         }
 #endif
 
-        this.Name = name;
+        this.Name = cache.Names.Intern(name);
         this.Size = size;
         this.IsStaticMember = isStaticMember;
         this.IsBitField = isBitField;
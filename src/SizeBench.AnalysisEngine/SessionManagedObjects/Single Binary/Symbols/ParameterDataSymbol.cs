@@ -20,7 +20,7 @@ public sealed class ParameterDataSymbol
         }
 #endif
 
-        this.Name = name;
+        this.Name = cache.Names.Intern(name);
         this.Type = type;
 
         cache.AllParameterDataSymbolsbySymIndexId.Add(symIndexId, this);
@@ -76,7 +76,7 @@ public sealed class SimpleFunctionCodeSymbol : CodeBlockSymbol, IFunctionCodeSym
         }
 #endif
 
-        this.FunctionName = name;
+        this.FunctionName = cache.Names.Intern(name);
         this.AccessModifier = accessModifier;
         this.IsIntroVirtual = isIntroVirtual;
         this.IsPure = isPure;
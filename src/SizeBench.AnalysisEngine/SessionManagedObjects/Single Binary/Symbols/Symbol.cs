@@ -44,7 +44,7 @@ public class Symbol : ISymbol
                 throw new ObjectFullyConstructedAlreadyException();
             }
 
-            this._name = value;
+            this._name = this.DataCache.Names.Intern(value);
             this._nameFinalized = true;
         }
     }
@@ -71,7 +71,7 @@ public class Symbol : ISymbol
                 throw new ObjectFullyConstructedAlreadyException();
             }
 
-            this._canonicalName = value;
+            this._canonicalName = this.DataCache.Names.Intern(value);
             this._canonicalNameFinalized = true;
         }
     }
@@ -104,6 +104,7 @@ public class Symbol : ISymbol
 #endif
         this.DataCache = cache;
 
+        name = cache.Names.Intern(name);
         this._canonicalName = name;
         this._canonicalNameFinalized = namesAreFinalized;
         this._name = name;
@@ -113,7 +114,7 @@ public class Symbol : ISymbol
 
         if (this.DataCache.AllCanonicalNames!.TryGetValue(rva, out var nameCanonicalization))
         {
-            this._canonicalName = nameCanonicalization.CanonicalName;
+            this._canonicalName = cache.Names.Intern(nameCanonicalization.CanonicalName);
             this.IsCOMDATFolded = nameCanonicalization.CanonicalSymIndexID != symIndexId; // If we're a symIndexId *other than* the canonical one, we're COMDAT folded to that canonical one
         }
         else
@@ -138,6 +139,7 @@ public class Symbol : ISymbol
         }
 
         cache.AllSymbolsBySymIndexId.Add(symIndexId, this);
+        AnalysisEngineEventSource.Log.SymbolParsed();
     }
 
 #pragma warning disable CA1062 // Validate arguments of public methods - this function is just too hot for perf to afford to null-check each time, so we'll let it crash if anyone passes null in.
@@ -20,11 +20,12 @@ public abstract class TypeSymbol
         }
 #endif
 
-        this.Name = name;
+        this.Name = cache.Names.Intern(name);
         this.InstanceSize = instanceSize;
         this.SymIndexId = symIndexId;
 
         cache.AllTypesBySymIndexId.Add(symIndexId, this);
+        AnalysisEngineEventSource.Log.SymbolParsed();
     }
 
     // Does this type have a layout of data members, base types, etc...?
@@ -0,0 +1,30 @@
+﻿using System.Collections.Concurrent;
+using SizeBench.AnalysisEngine.DIAInterop;
+
+namespace SizeBench.AnalysisEngine;
+
+// Remembers the undecorated form of every decorated name we've undecorated, so that each name is only undecorated once and every symbol with
+// that name shares one copy of the result.  A DiffSession's before and after binaries have mostly the same names, so both of its Sessions
+// share one of these - unlike the NamePool, it's thread-safe, since each Session uses it from its own DIA thread.
+internal sealed class UndecoratedNameCache
+{
+    private readonly ConcurrentDictionary<(string DecoratedName, UndName Flags), string?> _undecoratedNames = new ConcurrentDictionary<(string, UndName), string?>();
+
+    public int Count => this._undecoratedNames.Count;
+
+    /// <summary>
+    /// Undecorates a name with <see cref="MSVCNameUndecorator"/>, or returns the result from the last time it was asked for the same name and flags.
+    /// </summary>
+    /// <returns>The undecorated name, or null if the name isn't decorated or <see cref="MSVCNameUndecorator"/> can't undecorate it - in which
+    /// case the caller should fall back to asking DIA.</returns>
+    public string? GetUndecoratedName(string? decoratedName, UndName flags = UndName.UNDNAME_COMPLETE)
+    {
+        // Names that aren't decorated are common (every C function, for one), and don't need to take up space in here.
+        if (String.IsNullOrEmpty(decoratedName) || decoratedName[0] != '?')
+        {
+            return null;
+        }
+
+        return this._undecoratedNames.GetOrAdd((decoratedName, flags), static key => MSVCNameUndecorator.Undecorate(key.DecoratedName, key.Flags));
+    }
+}
@@ -3,4 +3,31 @@
 public sealed record class SessionOptions
 {
     public SymbolSourcesSupported SymbolSourcesSupported { get; init; } = SymbolSourcesSupported.All;
+
+    public PDBReader PDBReader { get; init; } = PDBReader.DIA;
+
+    // Which backend Session.DisassembleFunction uses.
+    public Disassembler Disassembler { get; init; } = Disassembler.DbgEng;
+
+    // When set, the results of pre-processing every symbol in the PDB are saved to (and on later opens of the same binary and PDB,
+    // loaded from) a cache file in this directory.  Null disables the cache, which is the default.
+    public string? AnalysisCacheDirectory { get; init; }
+
+    // How many additional DIA sessions to open on the PDB, each on its own thread, so that walks over the whole PDB can be split up between
+    // them.  Each one loads the PDB again, so this trades memory for speed.  0, the default, does all DIA work on one thread.  This has no
+    // effect with PDBReader.Managed.
+    public int DIAWorkerCount { get; init; }
+
+    // Roughly how much memory the symbols parsed from the PDB may hold on to before the least recently used ones are let go - they're parsed
+    // again if they're needed later.  For long-lived sessions on very large binaries.  0, the default, keeps every symbol for the life of
+    // the Session.
+    public long SymbolCacheMemoryBudgetInBytes { get; init; }
+
+    // Lets a DiffSession have its two Sessions share the work of undecorating names, since most names appear in both binaries.  Null, the
+    // default, gives the Session one of its own.
+    internal UndecoratedNameCache? UndecoratedNameCache { get; init; }
+
+    // Turning this off gives every symbol its own copy of its name, as DIA returned it.  This is only so SessionOpenBenchmarks can measure
+    // what the NamePool saves, there's no reason to turn it off otherwise.
+    internal bool PoolSymbolNames { get; init; } = true;
 }
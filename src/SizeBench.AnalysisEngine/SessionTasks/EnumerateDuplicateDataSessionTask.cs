@@ -36,13 +36,16 @@ internal sealed class EnumerateDuplicateDataSessionTask : SessionTask<List<Dupli
 
         var compilands = this.DataCache.AllCompilands!;
 
-        var dataSymbols = FindDataSymbolsInCompilands(compilands);
+        // With DIA workers, only the symbols that could be duplicates come back - which is all the loop below needs, since a symbol that's
+        // alone in its name and size group is never compared against anything unless it's in XDATA.
+        var dataSymbols = this.DIAAdapter.FindStaticDataSymbolsThatMayBeDuplicates(compilands, logger, this.CancellationToken) ??
+                          FindDataSymbolsInCompilands(compilands);
 
         const int loggerOutputVelocity = 100;
         uint nextLoggerOutput = loggerOutputVelocity;
         var symbolsEnumerated = 0;
         var duplicates = new List<DuplicateDataItem>();
-        var possibleDupes = new List<StaticDataSymbol>();
+        var candidatesByContentHash = new Dictionary<int, ContentHashBucket>();
         var duplicatesInThisNameAndSizeGroup = new List<DuplicateDataItem>();
         var possibleDupesInXData = new List<ValueTuple<ISymbol, StaticDataSymbol>>();
 
@@ -52,12 +55,19 @@ internal sealed class EnumerateDuplicateDataSessionTask : SessionTask<List<Dupli
 
         foreach (var nameAndSizeGroup in sortedAndFilteredDataSymbols)
         {
-            possibleDupes.Clear();
+            candidatesByContentHash.Clear();
             duplicatesInThisNameAndSizeGroup.Clear();
 
+            // Most names are unique, and a symbol alone in its group can't be a duplicate, so don't bother reading its bytes to hash them.
+            var groupHasMultipleSymbols = nameAndSizeGroup.Skip(1).Any();
+
             // The query above groups everything by the (name, size, virtualsize), so we know every nameAndSizeGroup here has the same name, 
             // the same Size, and the same VirtualSize, which are all pre-requisites for considering any of this data to be duplicative.
             // So now we can just look within this grouping to see if they have different RVAs and the same data bytes.
+            //
+            // Some headers stamp out thousands of statics with the same name and size (but different contents), so comparing each symbol
+            // against every other in the group gets quadratic.  Instead we hash each symbol's bytes once and only compare against symbols
+            // with the same hash - those are almost always true duplicates, CompareData is just there to guard against hash collisions.
             foreach (var rawSymbol in nameAndSizeGroup)
             {
                 symbolsEnumerated++;
@@ -80,26 +90,34 @@ internal sealed class EnumerateDuplicateDataSessionTask : SessionTask<List<Dupli
                     continue;
                 }
 
+                var contentHash = groupHasMultipleSymbols ? this.Session.HashData(rawSymbol.RVA, rawSymbol.Size) : 0;
+                if (!candidatesByContentHash.TryGetValue(contentHash, out var bucket))
+                {
+                    bucket = new ContentHashBucket();
+                    candidatesByContentHash.Add(contentHash, bucket);
+                }
+
                 StaticDataSymbol? newDupe = null;
-                var dupe = duplicatesInThisNameAndSizeGroup.FirstOrDefault(ddi => SymbolsAreTrulyDuplicates(ddi.Symbol, rawSymbol));
+                var dupe = bucket.Duplicates.FirstOrDefault(ddi => SymbolsAreTrulyDuplicates(ddi.Symbol, rawSymbol));
                 if (dupe != null && rawSymbol.CompilandReferencedIn != null)
                 {
                     dupe.AddReferencedCompilandIfNecessary(rawSymbol.CompilandReferencedIn, rawSymbol.RVA);
                 }
-                else if (null != (newDupe = possibleDupes.FirstOrDefault(s => SymbolsAreTrulyDuplicates(s, rawSymbol))) &&
+                else if (null != (newDupe = bucket.PossibleDupes.FirstOrDefault(s => SymbolsAreTrulyDuplicates(s, rawSymbol))) &&
                          newDupe.CompilandReferencedIn != null &&
                          rawSymbol.CompilandReferencedIn != null)
                 {
-                    possibleDupes.Remove(newDupe);
+                    bucket.PossibleDupes.Remove(newDupe);
                     dupe = new DuplicateDataItem(newDupe, newDupe.CompilandReferencedIn);
                     dupe.AddReferencedCompilandIfNecessary(rawSymbol.CompilandReferencedIn, rawSymbol.RVA);
+                    bucket.Duplicates.Add(dupe);
                     duplicatesInThisNameAndSizeGroup.Add(dupe);
                 }
                 else
                 {
-                    // We don't yet have a DuplicateDataItem for this (Name,Size) combo, but this may be found to be a dupe later so let's just keep track of it
-                    // while we iterate through this nameAndSizeGroup.
-                    possibleDupes.Add(rawSymbol);
+                    // We don't yet have a DuplicateDataItem for this (Name,Size,contents) combo, but this may be found to be a dupe later so let's just
+                    // keep track of it while we iterate through this nameAndSizeGroup.
+                    bucket.PossibleDupes.Add(rawSymbol);
                 }
             }
 
@@ -108,15 +126,16 @@ internal sealed class EnumerateDuplicateDataSessionTask : SessionTask<List<Dupli
 
         // Ok, we've finished looking at all the symbols in the normal fashion - but now we need to look at any we found in XDATA - these need to have some special logic to look up their
         // real name and location of the bytes in the binary, since DIA can't see them properly.
-        foreach (var nameAndSizeGroup in possibleDupesInXData.GroupBy(s => (s.Item1.Name, s.Item1.Size)).ToList())
+        // As above, only symbols whose bytes hash the same can be duplicates, so we only compare within those buckets.
+        foreach (var nameSizeAndContentsGroup in possibleDupesInXData.GroupBy(s => (s.Item1.Name, s.Item1.Size, this.Session.HashData(s.Item1.RVA, s.Item1.Size))).ToList())
         {
-            foreach (var rawSymbol in nameAndSizeGroup)
+            foreach (var rawSymbol in nameSizeAndContentsGroup)
             {
                 this.CancellationToken.ThrowIfCancellationRequested();
 
-                var dupesOfThisXDataSymbol = nameAndSizeGroup.Where(xds => rawSymbol.Item1.RVA != xds.Item1.RVA &&
-                                                                           (rawSymbol.Item1.Size == xds.Item1.Size || rawSymbol.Item1.VirtualSize == xds.Item1.VirtualSize) &&
-                                                                           this.Session.CompareData(rawSymbol.Item1.RVA, xds.Item1.RVA, rawSymbol.Item1.Size)).ToList();
+                var dupesOfThisXDataSymbol = nameSizeAndContentsGroup.Where(xds => rawSymbol.Item1.RVA != xds.Item1.RVA &&
+                                                                                   (rawSymbol.Item1.Size == xds.Item1.Size || rawSymbol.Item1.VirtualSize == xds.Item1.VirtualSize) &&
+                                                                                   this.Session.CompareData(rawSymbol.Item1.RVA, xds.Item1.RVA, rawSymbol.Item1.Size)).ToList();
 
                 if (dupesOfThisXDataSymbol.Count > 0)
                 {
@@ -183,4 +202,11 @@ internal sealed class EnumerateDuplicateDataSessionTask : SessionTask<List<Dupli
         return lastSeenSymbol.RVA != rawSymbol.RVA &&
                this.Session.CompareData(lastSeenSymbol.RVA, rawSymbol.RVA, rawSymbol.Size);
     }
+
+    // Everything within one (name, size, virtual size) group whose bytes hash to the same value.
+    private sealed class ContentHashBucket
+    {
+        public List<StaticDataSymbol> PossibleDupes { get; } = new List<StaticDataSymbol>();
+        public List<DuplicateDataItem> Duplicates { get; } = new List<DuplicateDataItem>();
+    }
 }
@@ -0,0 +1,174 @@
+﻿using System.Reflection.PortableExecutable;
+using SizeBench.AnalysisEngine.Helpers;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.SessionTasks;
+
+// Template foldability only compares functions that are instantiations of the same template, so it can't find a function that was copy-pasted,
+// or two templates that ended up generating the same code.  This looks at every function in the binary instead - each one is fingerprinted with
+// a MinHash signature of its code bytes, and locality-sensitive hashing on those signatures finds the pairs worth comparing, so the cost grows
+// roughly linearly with the number of functions instead of with the number of pairs of them.
+internal sealed class EnumerateNearDuplicateFunctionsSessionTask : SessionTask<List<NearDuplicateFunctionCluster>>
+{
+    // Functions smaller than this are mostly thunks and tiny accessors, which look alike by construction and would swamp the results.
+    internal const uint MinimumFunctionSize = 32;
+
+    // How similar two functions' signatures must be for them to end up in the same cluster.
+    internal const float MinimumEstimatedSimilarity = 0.8f;
+
+    private readonly SessionTaskParameters _sessionTaskParameters;
+
+    public EnumerateNearDuplicateFunctionsSessionTask(SessionTaskParameters parameters,
+                                                      IProgress<SessionTaskProgress>? progressReporter,
+                                                      CancellationToken token)
+                                                      : base(parameters, progressReporter, token)
+    {
+        this._sessionTaskParameters = parameters;
+        this.TaskName = "Find Near-Duplicate Functions";
+    }
+
+    protected override List<NearDuplicateFunctionCluster> ExecuteCore(ILogger logger)
+    {
+        if (this.DataCache.AllNearDuplicateFunctionClusters != null)
+        {
+            logger.Log("Found near-duplicate functions in the cache, re-using them, hooray!");
+            return this.DataCache.AllNearDuplicateFunctionClusters;
+        }
+
+        var functions = FindFunctionsToCompare(logger);
+
+        const int loggerOutputVelocity = 1000;
+        var signatures = new IReadOnlyList<ulong>[functions.Count];
+        using (var fingerprintLog = logger.StartTaskLog("Fingerprint code bytes of each function"))
+        {
+            for (var i = 0; i < functions.Count; i++)
+            {
+                if (i % loggerOutputVelocity == 0)
+                {
+                    this.CancellationToken.ThrowIfCancellationRequested();
+                    ReportProgress($"Fingerprinted {i:N0}/{functions.Count:N0} functions.", (uint)i, (uint)functions.Count);
+                }
+
+                signatures[i] = this.Session.FingerprintCodeBytesInBinary(functions[i]);
+            }
+        }
+
+        this.CancellationToken.ThrowIfCancellationRequested();
+        ReportProgress($"Looking for near-duplicates among {functions.Count:N0} functions.", (uint)functions.Count, (uint)functions.Count);
+
+        var clusterOf = ClusterSimilarSignatures(signatures);
+
+        var clusters = new List<NearDuplicateFunctionCluster>();
+        foreach (var membersOfCluster in Enumerable.Range(0, functions.Count).GroupBy(i => Find(clusterOf, i)).Where(static g => g.Count() > 1))
+        {
+            clusters.Add(CreateCluster(membersOfCluster.OrderByDescending(i => functions[i].Size).ThenBy(i => functions[i].PrimaryBlock.RVA).ToList(), functions, signatures));
+        }
+
+        clusters.Sort(static (a, b) => b.EstimatedSavingsIfFolded.CompareTo(a.EstimatedSavingsIfFolded));
+
+        logger.Log($"Finished finding {clusters.Count:N0} clusters of near-duplicate functions among {functions.Count:N0} functions.");
+        this.DataCache.AllNearDuplicateFunctionClusters = clusters;
+
+        return this.DataCache.AllNearDuplicateFunctionClusters;
+    }
+
+    private List<IFunctionCodeSymbol> FindFunctionsToCompare(ILogger logger)
+    {
+        var binarySections = new EnumerateBinarySectionsAndCOFFGroupsSessionTask(this._sessionTaskParameters, this.CancellationToken).Execute(logger);
+
+        var functions = new List<IFunctionCodeSymbol>();
+        foreach (var section in binarySections.Where(static bs => (bs.Characteristics & SectionCharacteristics.MemExecute) == SectionCharacteristics.MemExecute))
+        {
+            ReportProgress($"Finding functions in {section.Name}.", 0, null);
+            var symbols = new EnumerateSymbolsInBinarySectionSessionTask(this._sessionTaskParameters, this.CancellationToken, this.ProgressReporter, section).Execute(logger);
+
+            foreach (var symbol in symbols)
+            {
+                // Each function is counted once, by its primary block, and anything already COMDAT-folded is left out since the linker has
+                // already done everything that could be done for it.
+                if (symbol is CodeBlockSymbol block &&
+                    !block.IsCOMDATFolded &&
+                    ReferenceEquals(block.ParentFunction.PrimaryBlock, block) &&
+                    block.ParentFunction.Size >= MinimumFunctionSize)
+                {
+                    functions.Add(block.ParentFunction);
+                }
+            }
+        }
+
+        logger.Log($"Found {functions.Count:N0} functions of at least {MinimumFunctionSize} bytes to compare.");
+        return functions;
+    }
+
+    // Returns a union-find forest over the functions, where functions in the same tree are near-duplicates.
+    private int[] ClusterSimilarSignatures(IReadOnlyList<ulong>[] signatures)
+    {
+        var clusterOf = new int[signatures.Length];
+        for (var i = 0; i < clusterOf.Length; i++)
+        {
+            clusterOf[i] = i;
+        }
+
+        // Each band's bucket remembers only the first function that landed in it, and later arrivals are compared against that one.  This keeps
+        // the comparisons linear even when thousands of functions share a bucket (as many small, similar functions do), and since every function
+        // gets up to BandCount chances to join a cluster, it very rarely misses one.
+        var firstFunctionInBucket = new Dictionary<(int Band, ulong Key), int>(capacity: signatures.Length * CodeBytesMinHash.BandCount);
+        for (var i = 0; i < signatures.Length; i++)
+        {
+            if (i % 1000 == 0)
+            {
+                this.CancellationToken.ThrowIfCancellationRequested();
+            }
+
+            for (var band = 0; band < CodeBytesMinHash.BandCount; band++)
+            {
+                var bucket = (band, CodeBytesMinHash.BandKey(signatures[i], band));
+                if (!firstFunctionInBucket.TryGetValue(bucket, out var candidate))
+                {
+                    firstFunctionInBucket.Add(bucket, i);
+                    continue;
+                }
+
+                var candidateCluster = Find(clusterOf, candidate);
+                var thisCluster = Find(clusterOf, i);
+                if (candidateCluster != thisCluster &&
+                    CodeBytesMinHash.EstimateSimilarity(signatures[i], signatures[candidate]) >= MinimumEstimatedSimilarity)
+                {
+                    clusterOf[thisCluster] = candidateCluster;
+                }
+            }
+        }
+
+        return clusterOf;
+    }
+
+    private static int Find(int[] clusterOf, int i)
+    {
+        while (clusterOf[i] != i)
+        {
+            // Path halving, so the trees stay shallow as clusters are merged.
+            clusterOf[i] = clusterOf[clusterOf[i]];
+            i = clusterOf[i];
+        }
+
+        return i;
+    }
+
+    private static NearDuplicateFunctionCluster CreateCluster(List<int> membersLargestFirst, List<IFunctionCodeSymbol> functions, IReadOnlyList<ulong>[] signatures)
+    {
+        var representative = membersLargestFirst[0];
+        var totalSimilarity = 0.0f;
+        var estimatedSavings = 0.0f;
+        for (var i = 1; i < membersLargestFirst.Count; i++)
+        {
+            var similarity = CodeBytesMinHash.EstimateSimilarity(signatures[representative], signatures[membersLargestFirst[i]]);
+            totalSimilarity += similarity;
+            estimatedSavings += functions[membersLargestFirst[i]].Size * similarity;
+        }
+
+        return new NearDuplicateFunctionCluster(membersLargestFirst.Select(i => functions[i]).ToList(),
+                                                totalSimilarity / (membersLargestFirst.Count - 1),
+                                                (uint)estimatedSavings);
+    }
+}
@@ -36,8 +36,6 @@ internal sealed class EnumerateSourceFilesSessionTask : SessionTask<List<SourceF
 
         List<SourceFile>? sourceFiles;
         uint sourceFilesParsed = 0;
-        const int loggerOutputVelocity = 100;
-        var nextLoggerOutput = loggerOutputVelocity;
 
         using (var parseSourceFilesFromDiaLogger = logger.StartTaskLog("Parsing source files"))
         {
@@ -55,21 +53,20 @@ internal sealed class EnumerateSourceFilesSessionTask : SessionTask<List<SourceF
             }
 
             this._totalNumberOfItemsToReportProgressOn = (uint)(sourceFiles.Count + this.DataCache.PDataSymbolsByRVA.Count + this.DataCache.XDataSymbolsByRVA.Count);
+            this.CancellationToken.ThrowIfCancellationRequested();
 
-            foreach (var sourceFile in sourceFiles)
-            {
-                this.CancellationToken.ThrowIfCancellationRequested();
-                if (sourceFilesParsed >= nextLoggerOutput)
-                {
-                    ReportProgress($"Parsed {sourceFilesParsed:N0}/{sourceFiles.Count:N0} source files.", sourceFilesParsed, this._totalNumberOfItemsToReportProgressOn);
-                    nextLoggerOutput += loggerOutputVelocity;
-                }
+            // DIA can only be used from this thread, so all the line numbers are gathered up front in one walk of the line number table.  After
+            // that, turning them into contributions only touches the SourceFile each one belongs to, so the source files can be parsed in parallel.
+            ReportProgress($"Finding line numbers for {sourceFiles.Count:N0} source files.", sourceFilesParsed, this._totalNumberOfItemsToReportProgressOn);
+            var rangesBySourceFileAndCompiland = this.DIAAdapter.FindRVARangesForSourceFilesAndCompilands(sourceFiles, parseSourceFilesFromDiaLogger, this.CancellationToken);
+            var coffGroupsByRVA = BuildCOFFGroupIndex(this.DataCache.AllCOFFGroups!);
 
-                ParseSourceFile(sourceFile, this.DataCache.AllCOFFGroups!);
-                sourceFilesParsed++;
-            }
+            Parallel.For(0, sourceFiles.Count, new ParallelOptions() { CancellationToken = this.CancellationToken, MaxDegreeOfParallelism = Environment.ProcessorCount }, i =>
+            {
+                ParseSourceFile(sourceFiles[i], rangesBySourceFileAndCompiland, coffGroupsByRVA);
+            });
+            sourceFilesParsed = (uint)sourceFiles.Count;
 
-            // One final progress report so the log shows this as "120/120" instead of "100/120" due to the throttling of progress messages in the loop
             ReportProgress($"Parsed {sourceFilesParsed:N0}/{sourceFiles.Count:N0} source files.", sourceFilesParsed, this._totalNumberOfItemsToReportProgressOn);
         }
 
@@ -110,37 +107,27 @@ internal sealed class EnumerateSourceFilesSessionTask : SessionTask<List<SourceF
         return this.DataCache.AllSourceFiles;
     }
 
-    private void ParseSourceFile(SourceFile sourceFile,
-                                 List<COFFGroup> coffGroups)
+    // Matches the COFF Group a range of code is in, including the slop at its tail for alignment - this used to be a walk over every COFF Group for
+    // every range, which adds up with thousands of source files.
+    private static RVARangeIndex<COFFGroup> BuildCOFFGroupIndex(List<COFFGroup> coffGroups)
+        => new RVARangeIndex<COFFGroup>(coffGroups, static cg => [cg.IsVirtualSizeOnly ?
+                                                                      new RVARange(cg.RVA, (cg.RVA + cg.VirtualSize + cg.TailSlopVirtualSizeAlignment) - 1) :
+                                                                      new RVARange(cg.RVA, (cg.RVA + cg.Size + cg.TailSlopSizeAlignment) - 1)]);
+
+    private static void ParseSourceFile(SourceFile sourceFile,
+                                        Dictionary<(SourceFile sourceFile, Compiland compiland), List<RVARange>> rangesBySourceFileAndCompiland,
+                                        RVARangeIndex<COFFGroup> coffGroupsByRVA)
     {
         foreach (var compilandUsingThisSourceFile in sourceFile._compilands)
         {
-            foreach (var range in this.DIAAdapter.FindRVARangesForSourceFileAndCompiland(sourceFile, compilandUsingThisSourceFile, this.CancellationToken))
+            if (!rangesBySourceFileAndCompiland.TryGetValue((sourceFile, compilandUsingThisSourceFile), out var ranges))
             {
-                this.CancellationToken.ThrowIfCancellationRequested();
-                COFFGroup? coffGroup = null;
-                //TODO: PERF: We may want to enumerate all the ranges eagerly, then we could order them by RVAStart to cache the COFF Group lookup since many symbols
-                //            will surely come from the same COFF Group in many cases, and right now we're doing this lookup logic per-range.
-                for (var i = 0; i < coffGroups.Count; i++)
-                {
-                    var cg = coffGroups[i];
-                    if (cg.IsVirtualSizeOnly)
-                    {
-                        if (range.RVAStart >= cg.RVA && range.RVAEnd <= (cg.RVA + cg.VirtualSize + cg.TailSlopVirtualSizeAlignment) - 1)
-                        {
-                            coffGroup = cg;
-                            break;
-                        }
-                    }
-                    else
-                    {
-                        if (range.RVAStart >= cg.RVA && range.RVAEnd <= (cg.RVA + cg.Size + cg.TailSlopSizeAlignment) - 1)
-                        {
-                            coffGroup = cg;
-                            break;
-                        }
-                    }
-                }
+                continue;
+            }
+
+            foreach (var range in ranges)
+            {
+                var coffGroup = coffGroupsByRVA.FindFirstOwnerContaining(range.RVAStart, range.RVAEnd);
 
                 if (coffGroup is null)
                 {
@@ -195,7 +182,10 @@ internal sealed class EnumerateSourceFilesSessionTask : SessionTask<List<SourceF
                 sourceFileXDataContributions.Add(sf, new List<RVARange>());
             }
 
-            SourceFile? sourceFile = null;
+            // Finding the source file for each symbol is independent of every other symbol, so that part is done in parallel - putting the ranges
+            // together afterwards is done in order, which keeps adjacent symbols merging into one range.
+            var xdataSymbols = this.DataCache.XDataSymbolsByRVA.Values;
+            var sourceFilesContainingTargets = FindSourceFilesContainingTargetRVAs(sourceFilesWithExecutableCode, xdataSymbols.Count, i => xdataSymbols[i].TargetStartRVA);
 
             uint xdataSymbolsAttributed = 0;
             const int loggerOutputVelocity = 1000;
@@ -214,17 +204,9 @@ internal sealed class EnumerateSourceFilesSessionTask : SessionTask<List<SourceF
                 // the same source file, to reduce the number of RVA ranges being created - otherwise we'd be dumb
                 // and have one RVARange per XData symbol.
 
-                var targetStartRVA = xdataSymbol.Value.TargetStartRVA;
                 var xdataRange = RVARange.FromRVAAndSize(xdataSymbol.Value.RVA, xdataSymbol.Value.Size);
 
-                // We also know that XDATA symbols come grouped together, and RVA ranges for source files are already
-                // grouped so we can avoid finding the source file containing an RVA if the existing one we found already
-                // contains that RVA...this will be the case most of the time so checking for that is a significant
-                // perf win.
-                if (sourceFile is null || !sourceFile.ContainsExecutableCodeAtRVA(targetStartRVA))
-                {
-                    sourceFile = FindSourceFileContainingRVA(sourceFilesWithExecutableCode, targetStartRVA);
-                }
+                var sourceFile = sourceFilesContainingTargets[xdataSymbolsAttributed];
 
                 // At this point, it can rarely be the case that sourceFile is still null.  To avoid a crash and let
                 // the majority of other operations complete, if this is null we'll just live with that and not attribute
@@ -232,9 +214,10 @@ internal sealed class EnumerateSourceFilesSessionTask : SessionTask<List<SourceF
                 if (sourceFile != null)
                 {
                     var expandedExistingRVARange = false;
-                    for (var i = 0; i < sourceFileXDataContributions[sourceFile].Count; i++)
+                    for (var i = sourceFileXDataContributions[sourceFile].Count - 1; i >= 0; i--)
                     {
-                        // If we're contiguous with an existing range, just expand it to avoid explosion of RVA ranges.
+                        // If we're contiguous with an existing range, just expand it to avoid explosion of RVA ranges.  Symbols are in RVA
+                        // order, so the range we're adjacent to is almost always the last one - which is why this looks from the end.
                         if (sourceFileXDataContributions[sourceFile][i].IsAdjacentTo(xdataRange))
                         {
                             sourceFileXDataContributions[sourceFile][i] = sourceFileXDataContributions[sourceFile][i].CombineWith(xdataRange);
@@ -305,7 +288,9 @@ internal sealed class EnumerateSourceFilesSessionTask : SessionTask<List<SourceF
                 sourceFilePDataContributions.Add(sf, new List<RVARange>());
             }
 
-            SourceFile? sourceFile = null;
+            // As with XDATA, the source files are found in parallel and the ranges are put together in order.
+            var pdataSymbols = this.DataCache.PDataSymbolsByRVA.Values;
+            var sourceFilesContainingTargets = FindSourceFilesContainingTargetRVAs(sourceFilesWithExecutableCode, pdataSymbols.Count, i => pdataSymbols[i].TargetStartRVA);
 
             uint pdataSymbolsAttributed = 0;
             const int loggerOutputVelocity = 1000;
@@ -324,17 +309,9 @@ internal sealed class EnumerateSourceFilesSessionTask : SessionTask<List<SourceF
                 // the same source file, to reduce the number of RVA ranges being created - otherwise we'd be dumb
                 // and have one RVARange per PData symbol (12 bytes) - blech.
 
-                var targetStartRVA = pdataSymbol.Value.TargetStartRVA;
                 var pdataRange = RVARange.FromRVAAndSize(pdataSymbol.Value.RVA, pdataSymbol.Value.Size);
 
-                // We also know that PDATA symbols come grouped together, and RVA ranges for source files are already
-                // grouped so we can avoid finding the source file containing an RVA if the existing one we found already
-                // contains that RVA...this will be the case most of the time so checking for that is a significant
-                // perf win.
-                if (sourceFile is null || !sourceFile.ContainsExecutableCodeAtRVA(targetStartRVA))
-                {
-                    sourceFile = FindSourceFileContainingRVA(sourceFilesWithExecutableCode, targetStartRVA);
-                }
+                var sourceFile = sourceFilesContainingTargets[pdataSymbolsAttributed];
 
                 // At this point, it can rarely be the case that sourceFile is still null.  To avoid a crash and let
                 // the majority of other operations complete, if this is null we'll just live with that and not attribute
@@ -342,7 +319,7 @@ internal sealed class EnumerateSourceFilesSessionTask : SessionTask<List<SourceF
                 if (sourceFile != null)
                 {
                     var expandedExistingRVARange = false;
-                    for (var i = 0; i < sourceFilePDataContributions[sourceFile].Count; i++)
+                    for (var i = sourceFilePDataContributions[sourceFile].Count - 1; i >= 0; i--)
                     {
                         // If we're contiguous with an existing range, just expand it to avoid explosion of RVA ranges.
                         if (sourceFilePDataContributions[sourceFile][i].IsAdjacentTo(pdataRange))
@@ -385,17 +362,19 @@ internal sealed class EnumerateSourceFilesSessionTask : SessionTask<List<SourceF
         }
     }
 
-    private static SourceFile? FindSourceFileContainingRVA(List<SourceFile> sourceFiles, uint rva)
+    private SourceFile?[] FindSourceFilesContainingTargetRVAs(List<SourceFile> sourceFilesWithExecutableCode, int symbolCount, Func<int, uint> targetRVAOfSymbol)
     {
-        for (var i = 0; i < sourceFiles.Count; i++)
+        // Built here rather than once up front, since attributing XDATA adds ranges to source files before PDATA is attributed.
+        var sourceFilesByExecutableCodeRVA = new RVARangeIndex<SourceFile>(sourceFilesWithExecutableCode,
+                                                                           static sf => sf.ExecutableCodeRVARangesRegardlessOfFinalConstructionState());
+
+        var sourceFiles = new SourceFile?[symbolCount];
+        Parallel.For(0, symbolCount, new ParallelOptions() { CancellationToken = this.CancellationToken, MaxDegreeOfParallelism = Environment.ProcessorCount }, i =>
         {
-            if (sourceFiles[i].ContainsExecutableCodeAtRVA(rva))
-            {
-                return sourceFiles[i];
-            }
-        }
+            var targetRVA = targetRVAOfSymbol(i);
+            sourceFiles[i] = sourceFilesByExecutableCodeRVA.FindFirstOwnerContaining(targetRVA, targetRVA);
+        });
 
-        return null;
+        return sourceFiles;
     }
-
 }
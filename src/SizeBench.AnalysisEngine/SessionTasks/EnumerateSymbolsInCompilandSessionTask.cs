@@ -23,6 +23,15 @@ internal class EnumerateSymbolsInCompilandSessionTask : SessionTask<List<ISymbol
         this._options = options ?? new SymbolEnumerationOptions();
     }
 
+    public IEnumerable<ISymbol> ExecuteStreaming(ILogger sessionLogger)
+    {
+        var rvaRanges = this._compiland.SectionContributions.Values
+                            .Where(sc => !this._options.OnlyCodeSymbols ||
+                                         (sc.BinarySection.Characteristics & SectionCharacteristics.MemExecute) == SectionCharacteristics.MemExecute)
+                            .SelectMany(sc => sc.RVARanges);
+        return EnumerateSymbolsInRVARangeSessionTask.StreamSymbolsInRVARanges(this._sessionTaskParameters, this.CancellationToken, this.TaskName, rvaRanges, sessionLogger);
+    }
+
     protected override List<ISymbol> ExecuteCore(ILogger logger)
     {
         var symbolsEnumerated = new List<ISymbol>();
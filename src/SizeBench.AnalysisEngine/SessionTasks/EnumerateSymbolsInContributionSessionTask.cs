@@ -19,6 +19,12 @@ internal class EnumerateSymbolsInContributionSessionTask : SessionTask<List<ISym
         this._contribution = contribution;
     }
 
+    public IEnumerable<ISymbol> ExecuteStreaming(ILogger sessionLogger)
+    {
+        var rvaRanges = this._contribution.RVARanges;
+        return EnumerateSymbolsInRVARangeSessionTask.StreamSymbolsInRVARanges(this._sessionTaskParameters, this.CancellationToken, this.TaskName, rvaRanges, sessionLogger);
+    }
+
     protected override List<ISymbol> ExecuteCore(ILogger logger)
     {
         var symbolsEnumerated = new List<ISymbol>();
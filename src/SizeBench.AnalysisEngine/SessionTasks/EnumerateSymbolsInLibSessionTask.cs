@@ -19,6 +19,12 @@ internal class EnumerateSymbolsInLibSessionTask : SessionTask<List<ISymbol>>
         this._lib = lib;
     }
 
+    public IEnumerable<ISymbol> ExecuteStreaming(ILogger sessionLogger)
+    {
+        var rvaRanges = this._lib.SectionContributions.Values.SelectMany(sc => sc.RVARanges);
+        return EnumerateSymbolsInRVARangeSessionTask.StreamSymbolsInRVARanges(this._sessionTaskParameters, this.CancellationToken, this.TaskName, rvaRanges, sessionLogger);
+    }
+
     protected override List<ISymbol> ExecuteCore(ILogger logger)
     {
         var symbolsEnumerated = new List<ISymbol>();
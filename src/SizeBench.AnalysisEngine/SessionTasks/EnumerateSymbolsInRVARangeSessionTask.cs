@@ -18,6 +18,77 @@ internal class EnumerateSymbolsInRVARangeSessionTask : SessionTask<List<ISymbol>
     }
 
     protected override List<ISymbol> ExecuteCore(ILogger logger)
+    {
+        var symbolsEnumerated = new List<ISymbol>(50);
+        symbolsEnumerated.AddRange(EnumerateSymbols(logger));
+
+        logger.Log($"Symbol enumeration completed, discovered {symbolsEnumerated.Count} symbols.");
+
+#if DEBUG
+        SanityCheckSymbolSizesFillTheRVARange(symbolsEnumerated);
+#endif
+
+        return symbolsEnumerated;
+    }
+
+    /// <summary>
+    /// The streaming counterpart to <see cref="SessionTask{T}.Execute(ILogger, bool, bool)"/> - symbols are produced one at a time as the
+    /// caller asks for them, and the task log stays open until the caller finishes (or abandons) the enumeration.
+    /// </summary>
+    public IEnumerable<ISymbol> ExecuteStreaming(ILogger sessionLogger)
+    {
+        using var taskLogger = sessionLogger.StartTaskLog(this.TaskName);
+        this.LogEntryForProgress = taskLogger.StartProgressLogEntry("Starting Up...");
+
+        AnalysisEngineEventSource.Log.StreamingSessionTaskStart(this.TaskName);
+        try
+        {
+            foreach (var symbol in EnumerateSymbols(taskLogger))
+            {
+                yield return symbol;
+            }
+        }
+        finally
+        {
+            AnalysisEngineEventSource.Log.StreamingSessionTaskStop(this.TaskName);
+        }
+    }
+
+    /// <summary>
+    /// Streams the symbols in each of <paramref name="rvaRanges"/> in turn, for the tasks that enumerate symbols in something made up of many
+    /// RVA ranges (a compiland, a lib, ...).
+    /// </summary>
+    internal static IEnumerable<ISymbol> StreamSymbolsInRVARanges(SessionTaskParameters parameters,
+                                                                 CancellationToken token,
+                                                                 string taskName,
+                                                                 IEnumerable<RVARange> rvaRanges,
+                                                                 ILogger sessionLogger)
+    {
+        using var taskLogger = sessionLogger.StartTaskLog(taskName);
+
+        AnalysisEngineEventSource.Log.StreamingSessionTaskStart(taskName);
+        try
+        {
+            foreach (var rvaRange in rvaRanges)
+            {
+                // Like the non-streaming tasks we don't report progress on each RVA Range since it can be very noisy in the logs and doesn't
+                // have a lot of value - the caller can see progress for itself as the symbols arrive.
+                var enumRVARange = new EnumerateSymbolsInRVARangeSessionTask(parameters, token, progress: null, rvaRange);
+                foreach (var symbol in enumRVARange.EnumerateSymbols(taskLogger))
+                {
+                    yield return symbol;
+                }
+            }
+        }
+        finally
+        {
+            AnalysisEngineEventSource.Log.StreamingSessionTaskStop(taskName);
+        }
+    }
+
+    // Symbols come out in the same order EnumerateSymbolsIn* has always returned them - the hand-parsed PE symbols first, then DIA's in RVA
+    // order.  This is lazy so that ExecuteStreaming only does as much work as the caller has asked for so far.
+    private IEnumerable<ISymbol> EnumerateSymbols(ILogger logger)
     {
         this.CancellationToken.ThrowIfCancellationRequested();
 
@@ -29,8 +100,6 @@ internal class EnumerateSymbolsInRVARangeSessionTask : SessionTask<List<ISymbol>
             throw new InvalidOperationException("It is not valid to attempt to enumerate symbols in an RVA range before the PE symbols have been parsed, as that is necessary to ensure all types of symbols are found.  This is a bug in SizeBench's implementation, not your usage of it.");
         }
 
-        var symbolsEnumerated = new List<ISymbol>(50);
-
         const int loggerOutputVelocity = 100;
         var nextLoggerOutput = loggerOutputVelocity;
 
@@ -65,7 +134,7 @@ internal class EnumerateSymbolsInRVARangeSessionTask : SessionTask<List<ISymbol>
                     // ok, at this point the RVA is within the range, and the size of the
                     // symbol does not overflow to beyond the range, so we're sure the full
                     // symbol fits in the RVA range.
-                    symbolsEnumerated.Add(newSymbol);
+                    yield return newSymbol;
                 }
             }
             canSkipDIAEnumeration = true;
@@ -88,7 +157,7 @@ internal class EnumerateSymbolsInRVARangeSessionTask : SessionTask<List<ISymbol>
                     // ok, at this point the RVA is within the range, and the size of the
                     // symbol does not overflow to beyond the range, so we're sure the full
                     // symbol fits in the RVA range.
-                    symbolsEnumerated.Add(newSymbol);
+                    yield return newSymbol;
                 }
             }
             canSkipDIAEnumeration = true;
@@ -117,7 +186,7 @@ internal class EnumerateSymbolsInRVARangeSessionTask : SessionTask<List<ISymbol>
                     // ok, at this point the RVA is within the range, and the size of the
                     // symbol does not overflow to beyond the range, so we're sure the full
                     // symbol fits in the RVA range.
-                    symbolsEnumerated.Add(newSymbol);
+                    yield return newSymbol;
                 }
             }
         }
@@ -138,7 +207,7 @@ internal class EnumerateSymbolsInRVARangeSessionTask : SessionTask<List<ISymbol>
                     // ok, at this point the RVA is within the range, and the size of the
                     // symbol does not overflow to beyond the range, so we're sure the full
                     // symbol fits in the RVA range.
-                    symbolsEnumerated.Add(newSymbol);
+                    yield return newSymbol;
                 }
             }
         }
@@ -147,27 +216,23 @@ internal class EnumerateSymbolsInRVARangeSessionTask : SessionTask<List<ISymbol>
         // is no point in going through that range from a DIA standpoint. 
         if (!canSkipDIAEnumeration)
         {
-            EnumerateDIASymbols(logger, nextLoggerOutput, loggerOutputVelocity, symbolsEnumerated);
+            foreach (var symbol in EnumerateDIASymbols(logger, nextLoggerOutput, loggerOutputVelocity))
+            {
+                yield return symbol;
+            }
         }
-
-        logger.Log($"Symbol enumeration completed, discovered {symbolsEnumerated.Count} symbols.");
-
-#if DEBUG
-        SanityCheckSymbolSizesFillTheRVARange(symbolsEnumerated);
-#endif
-
-        return symbolsEnumerated;
     }
 
-    private void EnumerateDIASymbols(ILogger logger, int nextLoggerOutput, int loggerOutputVelocity, List<ISymbol> symbolsEnumerated)
+    private IEnumerable<ISymbol> EnumerateDIASymbols(ILogger logger, int nextLoggerOutput, int loggerOutputVelocity)
     {
         var otherPESymbolsByRVA = this.DataCache.OtherPESymbolsByRVA;
+        var symbolsEnumerated = 0;
 
         foreach ((var symbol, var amountOfRVARangeExplored) in this.DIAAdapter.FindSymbolsInRVARange(this._rvaRange, this.CancellationToken))
         {
             if (this.CancellationToken.IsCancellationRequested)
             {
-                logger.Log($"Cancellation requested after enumerating {symbolsEnumerated.Count} symbols, stopping now.");
+                logger.Log($"Cancellation requested after enumerating {symbolsEnumerated} symbols, stopping now.");
                 this.CancellationToken.ThrowIfCancellationRequested();
             }
 
@@ -175,12 +240,13 @@ internal class EnumerateSymbolsInRVARangeSessionTask : SessionTask<List<ISymbol>
             // ignored, as we can better control those symbols to have useful names, ordinals for import thunks, and so on.
             if (false == otherPESymbolsByRVA.ContainsKey(symbol.RVA))
             {
-                symbolsEnumerated.Add(symbol);
+                symbolsEnumerated++;
+                yield return symbol;
             }
 
-            if (symbolsEnumerated.Count > nextLoggerOutput)
+            if (symbolsEnumerated > nextLoggerOutput)
             {
-                ReportProgress($"Enumerated {symbolsEnumerated.Count:N0} symbols.", amountOfRVARangeExplored, this._rvaRange.VirtualSize);
+                ReportProgress($"Enumerated {symbolsEnumerated:N0} symbols.", amountOfRVARangeExplored, this._rvaRange.VirtualSize);
                 nextLoggerOutput += loggerOutputVelocity;
             }
         }
@@ -19,6 +19,12 @@ internal class EnumerateSymbolsInSourceFileSessionTask : SessionTask<List<ISymbo
         this._sourceFile = sourceFile;
     }
 
+    public IEnumerable<ISymbol> ExecuteStreaming(ILogger sessionLogger)
+    {
+        var rvaRanges = this._sourceFile.SectionContributions.Values.SelectMany(sc => sc.RVARanges);
+        return EnumerateSymbolsInRVARangeSessionTask.StreamSymbolsInRVARanges(this._sessionTaskParameters, this.CancellationToken, this.TaskName, rvaRanges, sessionLogger);
+    }
+
     protected override List<ISymbol> ExecuteCore(ILogger logger)
     {
         var symbolsEnumerated = new List<ISymbol>();
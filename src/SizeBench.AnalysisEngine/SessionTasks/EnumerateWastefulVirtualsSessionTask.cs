@@ -5,6 +5,11 @@ namespace SizeBench.AnalysisEngine.SessionTasks;
 
 internal sealed class EnumerateWastefulVirtualsSessionTask : SessionTask<List<WastefulVirtualItem>>
 {
+    // When DIA workers have looked ahead at which types have virtual functions, this is the names of those types.  A type whose name isn't
+    // in here has no virtual functions, so its functions only matter if it derives from a type that does.  Null means every type has to be
+    // assumed to have virtual functions.
+    private HashSet<string>? _namesOfTypesWithVirtualFunctions;
+
     public EnumerateWastefulVirtualsSessionTask(SessionTaskParameters parameters,
                                                 CancellationToken token,
                                                 IProgress<SessionTaskProgress>? progressReporter)
@@ -46,6 +51,18 @@ internal sealed class EnumerateWastefulVirtualsSessionTask : SessionTask<List<Wa
 
         var classesWorthLoadingFunctionsFor = udts.Where(x => x.DerivedTypeCount > 0 || x.BaseTypes?.Length > 0).ToList();
 
+        using (var taskLog = logger.StartTaskLog("Finding types with virtual functions"))
+        {
+            this._namesOfTypesWithVirtualFunctions = this.DIAAdapter.FindNamesOfUserDefinedTypesWithVirtualFunctions(taskLog, this.CancellationToken);
+        }
+
+        if (this._namesOfTypesWithVirtualFunctions != null)
+        {
+            // A type with no virtual functions of its own is only looked at as a possible override of something in a type it derives from,
+            // so if nothing it derives from has virtual functions either then it plays no part in this analysis.
+            classesWorthLoadingFunctionsFor = classesWorthLoadingFunctionsFor.Where(x => MayHaveVirtualFunctions(x) || DerivesFromTypeThatMayHaveVirtualFunctions(x)).ToList();
+        }
+
         using (var taskLog = logger.StartTaskLog("Loading all functions"))
         {
             LoadAllFunctionsIntoTypes(classesWorthLoadingFunctionsFor);
@@ -72,7 +89,7 @@ internal sealed class EnumerateWastefulVirtualsSessionTask : SessionTask<List<Wa
         uint nextLoggerOutput = loggerOutputVelocity;
         var udtsEnumerated = 0;
 
-        var classesWithVirtualsWorthExploring = classesWorthLoadingFunctionsFor.Where(x => x.Functions.Any(IsVirtualFunction)).ToList();
+        var classesWithVirtualsWorthExploring = classesWorthLoadingFunctionsFor.Where(x => MayHaveVirtualFunctions(x) && x.Functions.Any(IsVirtualFunction)).ToList();
 
         foreach (var udt in classesWithVirtualsWorthExploring)
         {
@@ -251,9 +268,31 @@ internal sealed class EnumerateWastefulVirtualsSessionTask : SessionTask<List<Wa
     private static bool IsPureVirtualFunction(IFunctionCodeSymbol function)
         => function.IsPure && IsVirtualFunction(function);
 
-    private static bool BaseTypeContainsVirtualFunction(UserDefinedTypeSymbol thisClass, string functionFormattedName)
+    private bool MayHaveVirtualFunctions(UserDefinedTypeSymbol udt)
+        => this._namesOfTypesWithVirtualFunctions is null || this._namesOfTypesWithVirtualFunctions.Contains(udt.Name);
+
+    private bool DerivesFromTypeThatMayHaveVirtualFunctions(UserDefinedTypeSymbol udt)
     {
-        if (thisClass.Functions != null &&
+        if (udt.BaseTypes is null)
+        {
+            return false;
+        }
+
+        foreach (var baseType in udt.BaseTypes.AsSpan())
+        {
+            if (MayHaveVirtualFunctions(baseType._baseTypeSymbol) || DerivesFromTypeThatMayHaveVirtualFunctions(baseType._baseTypeSymbol))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    private bool BaseTypeContainsVirtualFunction(UserDefinedTypeSymbol thisClass, string functionFormattedName)
+    {
+        if (MayHaveVirtualFunctions(thisClass) &&
+            thisClass.Functions != null &&
             thisClass.Functions.Any(f => IsVirtualFunction(f) &&
                                          f.FormattedName.GetFormattedName(WastefulVirtualItem.NameFormattingForWastedOverrides).Equals(functionFormattedName, StringComparison.Ordinal)))
         {
@@ -296,7 +335,12 @@ internal sealed class EnumerateWastefulVirtualsSessionTask : SessionTask<List<Wa
 
     private void LoadFunctionsForOneTypeAndAllItsBaseTypes(UserDefinedTypeSymbol udt)
     {
-        udt.EnsureFunctionsLoaded(this.CancellationToken);
+        // A base type's functions are only looked at for its virtual functions.
+        if (MayHaveVirtualFunctions(udt) || DerivesFromTypeThatMayHaveVirtualFunctions(udt))
+        {
+            udt.EnsureFunctionsLoaded(this.CancellationToken);
+        }
+
         if (udt.BaseTypes != null)
         {
             foreach (var baseType in udt.BaseTypes.AsSpan())
@@ -0,0 +1,90 @@
+﻿using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+
+namespace SizeBench.AnalysisEngine.SessionTasks;
+
+// Looks up the placement of many symbols at once.  Every lookup needs the same sections, COFF Groups, compilands and source files, so those
+// are enumerated once and then each symbol is placed with the RVA indexes in the SessionDataCache, rather than walking every COFF Group,
+// compiland and source file for each symbol.
+internal sealed class LookupSymbolPlacementsInBinarySessionTask : SessionTask<List<SymbolPlacement>>
+{
+    private readonly SessionTaskParameters _sessionTaskParameters;
+    private readonly IReadOnlyList<ISymbol> _symbols;
+    private readonly bool _shouldLookupSectionAndCOFFGroup;
+    private readonly bool _shouldLookupLibAndCompiland;
+    private readonly bool _shouldLookupSourceFile;
+
+    public LookupSymbolPlacementsInBinarySessionTask(IReadOnlyList<ISymbol> symbols,
+                                                     LookupSymbolPlacementOptions? options,
+                                                     SessionTaskParameters parameters,
+                                                     CancellationToken token,
+                                                     IProgress<SessionTaskProgress>? progress)
+        : base(parameters, progress, token)
+    {
+        this.TaskName = $"Lookup placement in the binary of {symbols.Count:N0} symbols";
+        this._sessionTaskParameters = parameters;
+        this._symbols = symbols;
+        this._shouldLookupSectionAndCOFFGroup = options?.IncludeBinarySectionAndCOFFGroup ?? true;
+        this._shouldLookupLibAndCompiland = options?.IncludeLibAndCompiland ?? true;
+        this._shouldLookupSourceFile = options?.IncludeSourceFile ?? true;
+    }
+
+    protected override List<SymbolPlacement> ExecuteCore(ILogger logger)
+    {
+        ReportProgress("Finding binary sections and COFF groups in the binary to find symbols' locations", 0, null);
+        RVARangeIndex<COFFGroup>? coffGroupsByRVA = null;
+        if (this._shouldLookupSectionAndCOFFGroup)
+        {
+            var binarySections = new EnumerateBinarySectionsAndCOFFGroupsSessionTask(this._sessionTaskParameters, this.CancellationToken).Execute(logger);
+            coffGroupsByRVA = this.DataCache.GetCOFFGroupsByRVA(binarySections.SelectMany(bs => bs.COFFGroups));
+        }
+
+        ReportProgress("Finding libs and compilands in the binary to find symbols' locations", 0, null);
+        RVARangeIndex<Compiland>? compilandsByRVA = null;
+        if (this._shouldLookupLibAndCompiland)
+        {
+            var libs = new EnumerateLibsAndCompilandsSessionTask(this._sessionTaskParameters, this.CancellationToken, this.ProgressReporter).Execute(logger);
+            compilandsByRVA = this.DataCache.GetCompilandsByRVA(libs.SelectMany(l => l.Compilands.Values));
+        }
+
+        ReportProgress("Finding source files in the binary to find symbols' locations", 0, null);
+        RVARangeIndex<SourceFile>? sourceFilesByRVA = null;
+        if (this._shouldLookupSourceFile)
+        {
+            var sourceFiles = new EnumerateSourceFilesSessionTask(this._sessionTaskParameters, this.CancellationToken, this.ProgressReporter).Execute(logger);
+            sourceFilesByRVA = this.DataCache.GetSourceFilesByRVA(sourceFiles);
+        }
+
+        const int loggerOutputVelocity = 1000;
+        var placements = new List<SymbolPlacement>(capacity: this._symbols.Count);
+        for (var i = 0; i < this._symbols.Count; i++)
+        {
+            if (i % loggerOutputVelocity == 0)
+            {
+                this.CancellationToken.ThrowIfCancellationRequested();
+                ReportProgress($"Found the location of {i:N0}/{this._symbols.Count:N0} symbols", (uint)i, (uint)this._symbols.Count);
+            }
+
+            placements.Add(PlaceSymbol(this._symbols[i], coffGroupsByRVA, compilandsByRVA, sourceFilesByRVA));
+        }
+
+        ReportProgress($"Found the location of {this._symbols.Count:N0} symbols", (uint)this._symbols.Count, (uint)this._symbols.Count);
+        logger.Log($"Finished finding the location of {this._symbols.Count:N0} symbols in the binary.");
+
+        return placements;
+    }
+
+    private static SymbolPlacement PlaceSymbol(ISymbol symbol,
+                                               RVARangeIndex<COFFGroup>? coffGroupsByRVA,
+                                               RVARangeIndex<Compiland>? compilandsByRVA,
+                                               RVARangeIndex<SourceFile>? sourceFilesByRVA)
+    {
+        // These match what the COFF Group, Compiland and SourceFile each consider "contained" - a COFF Group's end is one past its last byte,
+        // while the RVARanges of compilands and source files have inclusive ends.
+        var coffGroup = coffGroupsByRVA?.FindFirstOwnerContaining(symbol.RVA, symbol.RVAEnd);
+        var compiland = compilandsByRVA?.FindFirstOwnerContaining(symbol.RVA, unchecked(symbol.RVA + symbol.VirtualSize - 1));
+        var sourceFile = sourceFilesByRVA?.FindFirstOwnerContaining(symbol.RVA, unchecked(symbol.RVA + symbol.VirtualSize - 1));
+
+        return new SymbolPlacement(coffGroup?.Section, coffGroup, compiland?.Lib, compiland, sourceFile);
+    }
+}
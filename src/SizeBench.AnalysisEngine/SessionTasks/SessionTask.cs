@@ -48,7 +48,15 @@ internal abstract class SessionTask
             ReportProgress("Starting Up...", 0, null);
         }
 
-        ExecuteCoreWithoutResults(taskLogger);
+        AnalysisEngineEventSource.Log.SessionTaskStart(this.TaskName);
+        try
+        {
+            ExecuteCoreWithoutResults(taskLogger);
+        }
+        finally
+        {
+            AnalysisEngineEventSource.Log.SessionTaskStop(this.TaskName);
+        }
     }
 
     protected virtual void ExecuteCoreWithoutResults(ILogger logger)
@@ -86,7 +94,15 @@ internal abstract class SessionTask<T> : SessionTask
             ReportProgress("Starting Up...", 0, null);
         }
 
-        return ExecuteCore(taskLogger);
+        AnalysisEngineEventSource.Log.SessionTaskStart(this.TaskName);
+        try
+        {
+            return ExecuteCore(taskLogger);
+        }
+        finally
+        {
+            AnalysisEngineEventSource.Log.SessionTaskStop(this.TaskName);
+        }
     }
 
     protected abstract T ExecuteCore(ILogger logger);
@@ -0,0 +1,145 @@
+﻿using System.IO;
+
+namespace SizeBench.SKUCrawler.Tests;
+
+[TestClass]
+public sealed class ColumnarFileMergerTests
+{
+    private string TestDirectory = String.Empty;
+
+    [TestInitialize]
+    public void TestInitialize()
+    {
+        this.TestDirectory = Path.Combine(Path.GetTempPath(), nameof(ColumnarFileMergerTests), Path.GetRandomFileName());
+        Directory.CreateDirectory(this.TestDirectory);
+    }
+
+    [TestCleanup]
+    public void TestCleanup()
+    {
+        if (Directory.Exists(this.TestDirectory))
+        {
+            Directory.Delete(this.TestDirectory, recursive: true);
+        }
+    }
+
+    [TestMethod]
+    public void IDsAreOffsetPastEarlierFilesAndSymbolsAreShared()
+    {
+        var first = WriteBatch("batch1.sbcol", complete: true,
+            binaries: [[1L, "a.dll", 100L], [2L, "b.dll", 200L]],
+            sections: [[1L, 1L, ".text"], [2L, 2L, ".text"], [3L, 2L, ".data"]],
+            symbols: [[1L, "Foo", "Foo", 8L], [2L, "Bar", "Bar", 4L]],
+            duplicateData: [[1L, 1L, 1L, 8L], [2L, 2L, 2L, 4L]]);
+        var second = WriteBatch("batch2.sbcol", complete: true,
+            binaries: [[1L, "c.dll", 300L]],
+            sections: [[1L, 1L, ".rdata"]],
+            symbols: [[1L, "Bar", "Bar", 4L], [2L, "Baz", "Baz", 4L], [3L, "Foo", "Foo", 16L]],
+            duplicateData: [[1L, 1L, 2L, 4L], [2L, 1L, 1L, 4L], [3L, 1L, 3L, 16L]]);
+
+        var merged = Path.Combine(this.TestDirectory, "merged.sbcol");
+        Assert.AreEqual(2, ColumnarFileMerger.Merge([first, second], merged, TextWriter.Null));
+
+        var rowsByTable = ReadAllRows(merged);
+        ColumnarFileTests.AssertRowsAreEqual([[1L, "a.dll", 100L], [2L, "b.dll", 200L], [3L, "c.dll", 300L]], rowsByTable["Binaries"], "Binaries");
+        ColumnarFileTests.AssertRowsAreEqual([[1L, 1L, ".text"], [2L, 2L, ".text"], [3L, 2L, ".data"], [4L, 3L, ".rdata"]], rowsByTable["Sections"], "Sections");
+
+        // Bar of size 4 is in both files, so it's only in the merged file once - but Foo of size 16 isn't the same symbol as Foo of size 8.
+        ColumnarFileTests.AssertRowsAreEqual([[1L, "Foo", "Foo", 8L], [2L, "Bar", "Bar", 4L], [3L, "Baz", "Baz", 4L], [4L, "Foo", "Foo", 16L]],
+                                             rowsByTable["Symbols"], "Symbols");
+        ColumnarFileTests.AssertRowsAreEqual([[1L, 1L, 1L, 8L], [2L, 2L, 2L, 4L], [3L, 3L, 3L, 4L], [4L, 3L, 2L, 4L], [5L, 3L, 4L, 16L]],
+                                             rowsByTable["DuplicateData"], "DuplicateData");
+    }
+
+    [TestMethod]
+    public void IncompleteFilesAreSkipped()
+    {
+        var complete = WriteBatch("batch1.sbcol", complete: true,
+            binaries: [[1L, "a.dll", 100L]],
+            sections: [[1L, 1L, ".text"]],
+            symbols: [[1L, "Foo", "Foo", 8L]],
+            duplicateData: [[1L, 1L, 1L, 8L]]);
+        var incomplete = WriteBatch("batch2.sbcol", complete: false,
+            binaries: [[1L, "b.dll", 200L]],
+            sections: [[1L, 1L, ".text"]],
+            symbols: [[1L, "Bar", "Bar", 4L]],
+            duplicateData: [[1L, 1L, 1L, 4L]]);
+
+        var merged = Path.Combine(this.TestDirectory, "merged.sbcol");
+        using var log = new StringWriter();
+        Assert.AreEqual(1, ColumnarFileMerger.Merge([incomplete, complete], merged, log));
+        Assert.Contains("Skipping batch2.sbcol", log.ToString());
+
+        var rowsByTable = ReadAllRows(merged);
+        ColumnarFileTests.AssertRowsAreEqual([[1L, "a.dll", 100L]], rowsByTable["Binaries"], "Binaries");
+        ColumnarFileTests.AssertRowsAreEqual([[1L, "Foo", "Foo", 8L]], rowsByTable["Symbols"], "Symbols");
+        ColumnarFileTests.AssertRowsAreEqual([[1L, 1L, 1L, 8L]], rowsByTable["DuplicateData"], "DuplicateData");
+        Assert.IsFalse(File.Exists(merged + ".inprogress"));
+    }
+
+    [TestMethod]
+    public void MergingNothingMakesAnEmptyFile()
+    {
+        var merged = Path.Combine(this.TestDirectory, "merged.sbcol");
+        Assert.AreEqual(0, ColumnarFileMerger.Merge([], merged, TextWriter.Null));
+        Assert.IsEmpty(ReadAllRows(merged));
+    }
+
+    // Writes a file with a few of the tables a ColumnarCrawlResultSink writes, with the rows of each table split over two row groups so
+    // an ID column's offset has to carry over from one row group to the next - and with the symbols last, the way they can be when the
+    // sink writes out a row group of another table before the symbols it refers to.
+    private string WriteBatch(string fileName, bool complete, object[][] binaries, object[][] sections, object[][] symbols, object[][] duplicateData)
+    {
+        var path = Path.Combine(this.TestDirectory, fileName);
+        using var writer = new ColumnarFileWriter(path);
+        WriteInTwoRowGroups(writer, new ColumnarTable("Binaries", new Int64Column("BinaryID"), new StringColumn("Name"), new Int64Column("Size")), binaries);
+        WriteInTwoRowGroups(writer, new ColumnarTable("Sections", new Int64Column("BinarySectionID"), new Int64Column("BinaryID"), new StringColumn("SectionName")), sections);
+        WriteInTwoRowGroups(writer, new ColumnarTable("DuplicateData", new Int64Column("DuplicateDataID"), new Int64Column("BinaryID"), new Int64Column("SymbolID"),
+                                                      new Int64Column("WastedSize")), duplicateData);
+        WriteInTwoRowGroups(writer, new ColumnarTable(ColumnarCrawlResultSink.SymbolsTableName, new Int64Column("SymbolID"), new StringColumn("SymbolName"),
+                                                      new StringColumn("SymbolDetemplatedName"), new Int64Column("Size")), symbols);
+        if (complete)
+        {
+            writer.Complete();
+        }
+
+        return path;
+    }
+
+    private static void WriteInTwoRowGroups(ColumnarFileWriter writer, ColumnarTable table, object[][] rows)
+    {
+        for (var i = 0; i < rows.Length; i++)
+        {
+            var row = table.AddRow();
+            foreach (var value in rows[i])
+            {
+                row = value is long integer ? row.Add(integer) : row.Add((string)value);
+            }
+
+            if (i == rows.Length / 2)
+            {
+                writer.WriteRowGroup(table);
+            }
+        }
+
+        writer.WriteRowGroup(table);
+    }
+
+    private static Dictionary<string, List<object?[]>> ReadAllRows(string path)
+    {
+        var rowsByTable = new Dictionary<string, List<object?[]>>();
+        using var reader = new ColumnarFileReader(path);
+        while (reader.ReadRowGroup() is ColumnarTable rowGroup)
+        {
+            if (!rowsByTable.TryGetValue(rowGroup.Name, out var rows))
+            {
+                rows = new List<object?[]>();
+                rowsByTable.Add(rowGroup.Name, rows);
+            }
+
+            rows.AddRange(ColumnarFileTests.ReadRows(rowGroup));
+        }
+
+        return rowsByTable;
+    }
+}
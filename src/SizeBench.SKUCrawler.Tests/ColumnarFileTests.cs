@@ -0,0 +1,371 @@
+﻿using System.IO;
+
+namespace SizeBench.SKUCrawler.Tests;
+
+[TestClass]
+public sealed class ColumnarFileTests
+{
+    private string TestDirectory = String.Empty;
+
+    [TestInitialize]
+    public void TestInitialize()
+    {
+        this.TestDirectory = Path.Combine(Path.GetTempPath(), nameof(ColumnarFileTests), Path.GetRandomFileName());
+        Directory.CreateDirectory(this.TestDirectory);
+    }
+
+    [TestCleanup]
+    public void TestCleanup()
+    {
+        if (Directory.Exists(this.TestDirectory))
+        {
+            Directory.Delete(this.TestDirectory, recursive: true);
+        }
+    }
+
+    [TestMethod]
+    public void EveryTableTheSinkWritesRoundTrips()
+    {
+        using var sink = new ColumnarCrawlResultSink(Path.Combine(this.TestDirectory, "batch"), this.TestDirectory,
+                                                     includeWastefulVirtuals: true, includeCodeSymbols: true, includeDuplicateDataItems: true);
+        var path = Path.Combine(this.TestDirectory, "AllTables.sbcol");
+        var expectedRowsByTable = sink.Tables.ToDictionary(table => table.Name, _ => new List<object?[]>());
+
+        // Two row groups per table, interleaved with every other table's, the way the sink writes them when a crawl is big enough.
+        using (var writer = new ColumnarFileWriter(path))
+        {
+            for (var rowGroup = 0; rowGroup < 2; rowGroup++)
+            {
+                foreach (var table in sink.Tables)
+                {
+                    for (var row = 0; row < 50; row++)
+                    {
+                        expectedRowsByTable[table.Name].Add(AddGeneratedRow(table, (rowGroup * 50) + row));
+                    }
+
+                    writer.WriteRowGroup(table);
+                    Assert.AreEqual(0, table.RowCount);
+                }
+            }
+
+            writer.Complete();
+        }
+
+        var rowGroupsRead = 0;
+        var actualRowsByTable = new Dictionary<string, List<object?[]>>();
+        using (var reader = new ColumnarFileReader(path))
+        {
+            while (reader.ReadRowGroup() is ColumnarTable rowGroup)
+            {
+                rowGroupsRead++;
+                var definition = sink.Tables.Single(table => table.Name == rowGroup.Name);
+                CollectionAssert.AreEqual(definition.Columns.Select(column => (column.Name, column.Kind)).ToList(),
+                                          rowGroup.Columns.Select(column => (column.Name, column.Kind)).ToList());
+
+                if (!actualRowsByTable.TryGetValue(rowGroup.Name, out var actualRows))
+                {
+                    actualRows = new List<object?[]>();
+                    actualRowsByTable.Add(rowGroup.Name, actualRows);
+                }
+
+                actualRows.AddRange(ReadRows(rowGroup));
+            }
+        }
+
+        Assert.AreEqual(sink.Tables.Count * 2, rowGroupsRead);
+        Assert.HasCount(sink.Tables.Count, actualRowsByTable);
+        foreach (var (tableName, expectedRows) in expectedRowsByTable)
+        {
+            AssertRowsAreEqual(expectedRows, actualRowsByTable[tableName], tableName);
+        }
+    }
+
+    [TestMethod]
+    public void IntegersRoundTripWhateverTheDifferenceBetweenRows()
+    {
+        long[] values = [0, 1, 2, 3, 2, -1, -1_000_000, 1_000_000, Int64.MaxValue, Int64.MinValue, Int64.MaxValue, -1, 0, 0, 0, 5];
+        var table = new ColumnarTable("Integers", new Int64Column("Value"));
+        foreach (var value in values)
+        {
+            table.AddRow().Add(value);
+        }
+
+        var path = Path.Combine(this.TestDirectory, "Integers.sbcol");
+        using (var writer = new ColumnarFileWriter(path))
+        {
+            writer.WriteRowGroup(table);
+            writer.Complete();
+        }
+
+        var rowGroup = ReadSingleRowGroup(path);
+        var column = rowGroup.GetColumn<Int64Column>("Value");
+        Assert.AreEqual(values.Length, rowGroup.RowCount);
+        for (var row = 0; row < values.Length; row++)
+        {
+            Assert.AreEqual(values[row], column[row]);
+        }
+    }
+
+    [TestMethod]
+    public void StringsKeepNullsAndEmptyStringsApart()
+    {
+        string?[] values = [null, "", "text", null, "", "text", "été 漢字", null];
+        var table = new ColumnarTable("Strings", new StringColumn("Value"));
+        foreach (var value in values)
+        {
+            table.AddRow().Add(value);
+        }
+
+        var path = Path.Combine(this.TestDirectory, "Strings.sbcol");
+        using (var writer = new ColumnarFileWriter(path))
+        {
+            writer.WriteRowGroup(table);
+            writer.Complete();
+        }
+
+        var rowGroup = ReadSingleRowGroup(path);
+        var column = rowGroup.GetColumn<StringColumn>("Value");
+        Assert.AreEqual(values.Length, rowGroup.RowCount);
+        for (var row = 0; row < values.Length; row++)
+        {
+            Assert.AreEqual(values[row], column[row]);
+        }
+    }
+
+    [TestMethod]
+    public void EachRowGroupHasItsOwnStringDictionary()
+    {
+        // Enough distinct strings that the indices into the dictionary take three bytes, and the second row group shares only some of the
+        // first one's strings - so its dictionary has to start over, and indices from the first can't leak into it.
+        var table = new ColumnarTable("Names", new Int64Column("ID"), new StringColumn("Name"));
+        var expectedRows = new List<object?[]>();
+        var path = Path.Combine(this.TestDirectory, "Names.sbcol");
+        using (var writer = new ColumnarFileWriter(path))
+        {
+            for (var i = 0; i < 20_000; i++)
+            {
+                var name = i % 100 == 0 ? null : $"name{i}";
+                table.AddRow().Add(i).Add(name);
+                expectedRows.Add([(long)i, name]);
+            }
+
+            writer.WriteRowGroup(table);
+
+            for (var i = 0; i < 300; i++)
+            {
+                var name = i % 3 == 0 ? $"name{19_999 - i}" : $"other{i}";
+                table.AddRow().Add(20_000 + i).Add(name);
+                expectedRows.Add([20_000L + i, name]);
+            }
+
+            writer.WriteRowGroup(table);
+            writer.Complete();
+        }
+
+        var actualRows = new List<object?[]>();
+        using (var reader = new ColumnarFileReader(path))
+        {
+            while (reader.ReadRowGroup() is ColumnarTable rowGroup)
+            {
+                actualRows.AddRange(ReadRows(rowGroup));
+            }
+        }
+
+        AssertRowsAreEqual(expectedRows, actualRows, "Names");
+    }
+
+    [TestMethod]
+    public void IncompleteRowsAreNotWritten()
+    {
+        var table = new ColumnarTable("Partial", new Int64Column("ID"), new StringColumn("Name"), new Int64Column("Size"));
+        table.AddRow().Add(1).Add("one").Add(10);
+        table.AddRow().Add(2).Add("two");
+        table.AddRow().Add(3).Add("three").Add(30);
+        table.AddRow().Add(4);
+
+        var path = Path.Combine(this.TestDirectory, "Partial.sbcol");
+        using (var writer = new ColumnarFileWriter(path))
+        {
+            writer.WriteRowGroup(table);
+            writer.Complete();
+        }
+
+        AssertRowsAreEqual([[1L, "one", 10L], [3L, "three", 30L]], ReadRows(ReadSingleRowGroup(path)), "Partial");
+    }
+
+    [TestMethod]
+    public void RowGroupsOfOtherTablesCanBeSkipped()
+    {
+        var wanted = new ColumnarTable("Wanted", new Int64Column("ID"));
+        var unwanted = new ColumnarTable("Unwanted", new StringColumn("Name"));
+        var path = Path.Combine(this.TestDirectory, "Skipping.sbcol");
+        using (var writer = new ColumnarFileWriter(path))
+        {
+            unwanted.AddRow().Add("a");
+            writer.WriteRowGroup(unwanted);
+            wanted.AddRow().Add(1);
+            writer.WriteRowGroup(wanted);
+            unwanted.AddRow().Add("b");
+            writer.WriteRowGroup(unwanted);
+            wanted.AddRow().Add(2);
+            writer.WriteRowGroup(wanted);
+            writer.Complete();
+        }
+
+        var idsRead = new List<long>();
+        using (var reader = new ColumnarFileReader(path))
+        {
+            while (reader.ReadRowGroup(tableName => tableName == "Wanted") is ColumnarTable rowGroup)
+            {
+                Assert.AreEqual("Wanted", rowGroup.Name);
+                idsRead.Add(rowGroup.GetColumn<Int64Column>("ID")[0]);
+            }
+        }
+
+        CollectionAssert.AreEqual(new List<long>() { 1, 2 }, idsRead);
+    }
+
+    [TestMethod]
+    public void FileThatWasNeverCompletedIsRejected()
+    {
+        var path = Path.Combine(this.TestDirectory, "Incomplete.sbcol");
+        var table = new ColumnarTable("Table", new Int64Column("ID"));
+        using (var writer = new ColumnarFileWriter(path))
+        {
+            table.AddRow().Add(1);
+            writer.WriteRowGroup(table);
+        }
+
+        using var reader = new ColumnarFileReader(path);
+        Assert.IsNotNull(reader.ReadRowGroup());
+        Assert.ThrowsExactly<InvalidDataException>(() => reader.ReadRowGroup());
+    }
+
+    [TestMethod]
+    public void FileTruncatedPartWayThroughARowGroupIsRejected()
+    {
+        var path = WriteOneRowGroupFile("Truncated.sbcol");
+        var bytes = File.ReadAllBytes(path);
+        File.WriteAllBytes(path, bytes[..^5]);
+
+        using var reader = new ColumnarFileReader(path);
+        Assert.ThrowsExactly<InvalidDataException>(() => reader.ReadRowGroup());
+    }
+
+    [TestMethod]
+    public void DataAfterTheEndMarkerIsRejected()
+    {
+        var path = WriteOneRowGroupFile("Trailing.sbcol");
+        using (var stream = new FileStream(path, FileMode.Append))
+        {
+            stream.WriteByte(42);
+        }
+
+        using var reader = new ColumnarFileReader(path);
+        Assert.IsNotNull(reader.ReadRowGroup());
+        Assert.ThrowsExactly<InvalidDataException>(() => reader.ReadRowGroup());
+    }
+
+    [TestMethod]
+    public void FilesThatAreNotColumnarOrAreAnotherVersionAreRejected()
+    {
+        var notColumnar = Path.Combine(this.TestDirectory, "NotColumnar.sbcol");
+        File.WriteAllText(notColumnar, "SQLite format 3");
+        Assert.ThrowsExactly<InvalidDataException>(() => new ColumnarFileReader(notColumnar));
+
+        var empty = Path.Combine(this.TestDirectory, "Empty.sbcol");
+        File.WriteAllBytes(empty, []);
+        Assert.ThrowsExactly<InvalidDataException>(() => new ColumnarFileReader(empty));
+
+        var nextVersion = WriteOneRowGroupFile("NextVersion.sbcol");
+        var bytes = File.ReadAllBytes(nextVersion);
+        BitConverter.GetBytes(ColumnarFileWriter.FormatVersion + 1).CopyTo(bytes, sizeof(uint));
+        File.WriteAllBytes(nextVersion, bytes);
+        Assert.ThrowsExactly<InvalidDataException>(() => new ColumnarFileReader(nextVersion));
+    }
+
+    private string WriteOneRowGroupFile(string fileName)
+    {
+        var path = Path.Combine(this.TestDirectory, fileName);
+        var table = new ColumnarTable("Table", new Int64Column("ID"), new StringColumn("Name"));
+        using var writer = new ColumnarFileWriter(path);
+        for (var i = 0; i < 100; i++)
+        {
+            table.AddRow().Add(i).Add($"name{i % 10}");
+        }
+
+        writer.WriteRowGroup(table);
+        writer.Complete();
+        return path;
+    }
+
+    // Fills in every column of a new row with something that depends on the row number, so the deltas between rows go up and down, and
+    // strings repeat, are sometimes null, and sometimes empty.
+    private static object?[] AddGeneratedRow(ColumnarTable table, int rowNumber)
+    {
+        var values = new object?[table.Columns.Count];
+        var row = table.AddRow();
+        for (var i = 0; i < values.Length; i++)
+        {
+            if (table.Columns[i].Kind == ColumnarColumnKind.Int64)
+            {
+                var value = (rowNumber % 4) switch
+                {
+                    0 => rowNumber + i,
+                    1 => -rowNumber * 1000L,
+                    2 => i % 2 == 0 ? Int64.MaxValue - rowNumber : Int64.MinValue + rowNumber,
+                    _ => 0L,
+                };
+                row = row.Add(value);
+                values[i] = value;
+            }
+            else
+            {
+                var value = (rowNumber % 5) switch
+                {
+                    0 => null,
+                    1 => String.Empty,
+                    _ => $"{table.Columns[i].Name} {rowNumber % 7}",
+                };
+                row = row.Add(value);
+                values[i] = value;
+            }
+        }
+
+        return values;
+    }
+
+    private static ColumnarTable ReadSingleRowGroup(string path)
+    {
+        using var reader = new ColumnarFileReader(path);
+        var rowGroup = reader.ReadRowGroup();
+        Assert.IsNotNull(rowGroup);
+        Assert.IsNull(reader.ReadRowGroup());
+        return rowGroup;
+    }
+
+    internal static List<object?[]> ReadRows(ColumnarTable rowGroup)
+    {
+        var rows = new List<object?[]>(rowGroup.RowCount);
+        for (var row = 0; row < rowGroup.RowCount; row++)
+        {
+            rows.Add(rowGroup.Columns.Select(column => column switch
+            {
+                Int64Column integers => (object?)integers[row],
+                StringColumn strings => strings[row],
+                _ => throw new InvalidOperationException($"Unknown column type {column.GetType().Name}"),
+            }).ToArray());
+        }
+
+        return rows;
+    }
+
+    internal static void AssertRowsAreEqual(List<object?[]> expectedRows, List<object?[]> actualRows, string tableName)
+    {
+        Assert.HasCount(expectedRows.Count, actualRows, tableName);
+        for (var row = 0; row < expectedRows.Count; row++)
+        {
+            CollectionAssert.AreEqual(expectedRows[row], actualRows[row], $"Row {row} of {tableName}");
+        }
+    }
+}
@@ -0,0 +1,41 @@
+﻿namespace SizeBench.SKUCrawler.Tests;
+
+[TestClass]
+public sealed class CrawlWorkerProtocolTests
+{
+    private static readonly ProductBinary Binary = new ProductBinary(@"C:\Some Product\bin\thing.dll", @"C:\Some Product\symbols\thing.pdb");
+
+    [TestMethod]
+    public void WorkItemsRoundTrip()
+    {
+        var parsed = CrawlWorkerProtocol.ParseWorkItem(CrawlWorkerProtocol.FormatWorkItem(new CrawlWorkItem(Binary, SizeInBytes: 1234)));
+
+        Assert.AreEqual(Binary.BinaryPath, parsed.Binary.BinaryPath);
+        Assert.AreEqual(Binary.PdbPath, parsed.Binary.PdbPath);
+        Assert.IsNull(parsed.AbandonedBecause);
+    }
+
+    [TestMethod]
+    public void AbandonedWorkItemsRoundTrip()
+    {
+        foreach (var reason in new[] { WorkItemOutcome.ExceededTimeLimit, WorkItemOutcome.ExceededMemoryLimit, WorkItemOutcome.WorkerExited })
+        {
+            var item = new CrawlWorkItem(Binary, SizeInBytes: 1234, AbandonedBecause: reason, TimesRequeued: 2);
+            var parsed = CrawlWorkerProtocol.ParseWorkItem(CrawlWorkerProtocol.FormatWorkItem(item));
+
+            Assert.AreEqual(Binary.BinaryPath, parsed.Binary.BinaryPath);
+            Assert.AreEqual(Binary.PdbPath, parsed.Binary.PdbPath);
+            Assert.AreEqual(reason, parsed.AbandonedBecause);
+        }
+    }
+
+    [TestMethod]
+    [DataRow("")]
+    [DataRow("analyze|only-a-binary.dll")]
+    [DataRow("analyze|a.dll|a.pdb|extra")]
+    [DataRow("abandoned|NotAReason|a.dll|a.pdb")]
+    [DataRow("abandoned|a.dll|a.pdb")]
+    [DataRow("something|a.dll|a.pdb")]
+    public void MalformedWorkItemsThrow(string line)
+        => Assert.ThrowsExactly<InvalidOperationException>(() => CrawlWorkerProtocol.ParseWorkItem(line));
+}
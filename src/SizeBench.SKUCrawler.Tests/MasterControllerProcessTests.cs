@@ -0,0 +1,132 @@
+﻿using SizeBench.Logging;
+
+namespace SizeBench.SKUCrawler.Tests;
+
+[TestClass]
+public sealed class MasterControllerProcessTests
+{
+    // These workers are never started, the tests just feed them the lines a worker process would have written.
+    private static CrawlWorker CreateWorker() => new CrawlWorker(1, String.Empty, (_, _) => { }, (_, _) => { });
+
+    private static CrawlWorkItem CreateItem(string name, long sizeInBytes = 100, WorkItemOutcome? abandonedBecause = null, int timesRequeued = 0)
+        => new CrawlWorkItem(new ProductBinary($@"C:\bin\{name}.dll", $@"C:\bin\{name}.pdb"), sizeInBytes, abandonedBecause, timesRequeued);
+
+    private static void FinishItem(CrawlWorker worker, CrawlWorkItem item)
+    {
+        worker.BeginItem(item);
+        worker.HandleOutputLine(CrawlWorkerProtocol.BinaryFinishedMessage);
+    }
+
+    private static List<CrawlWorkItem> DequeueAll(MasterControllerProcess master)
+    {
+        var items = new List<CrawlWorkItem>();
+        while (master.TryDequeue(out var item))
+        {
+            items.Add(item);
+        }
+        return items;
+    }
+
+    [TestMethod]
+    public void LargestBinariesAreDequeuedFirst()
+    {
+        var master = new MasterControllerProcess();
+        master.Enqueue(CreateItem("small", sizeInBytes: 10));
+        master.Enqueue(CreateItem("large", sizeInBytes: 1000));
+        master.Enqueue(CreateItem("medium", sizeInBytes: 100));
+
+        var items = DequeueAll(master);
+
+        CollectionAssert.AreEqual(new[] { @"C:\bin\large.dll", @"C:\bin\medium.dll", @"C:\bin\small.dll" }, items.Select(item => item.Binary.BinaryPath).ToArray());
+    }
+
+    [TestMethod]
+    public void AbandonedBinariesAreDequeuedBeforeEvenTheLargestBinaries()
+    {
+        var master = new MasterControllerProcess();
+        master.Enqueue(CreateItem("large", sizeInBytes: Int64.MaxValue));
+        master.Enqueue(CreateItem("abandoned", sizeInBytes: 10, abandonedBecause: WorkItemOutcome.ExceededTimeLimit));
+
+        var items = DequeueAll(master);
+
+        Assert.HasCount(2, items);
+        Assert.AreEqual(WorkItemOutcome.ExceededTimeLimit, items[0].AbandonedBecause);
+        Assert.IsNull(items[1].AbandonedBecause);
+    }
+
+    [TestMethod]
+    public void UnsavedWorkIsRequeuedAndCountedEachTime()
+    {
+        var master = new MasterControllerProcess();
+        var worker = CreateWorker();
+        FinishItem(worker, CreateItem("first"));
+        FinishItem(worker, CreateItem("second", timesRequeued: 1));
+
+        master.RequeueUnsavedWork(worker);
+        var requeued = DequeueAll(master);
+
+        Assert.HasCount(2, requeued);
+        Assert.AreEqual(1, requeued.Single(item => item.Binary.BinaryPath.EndsWith("first.dll", StringComparison.Ordinal)).TimesRequeued);
+        Assert.AreEqual(2, requeued.Single(item => item.Binary.BinaryPath.EndsWith("second.dll", StringComparison.Ordinal)).TimesRequeued);
+        Assert.IsTrue(requeued.All(item => item.AbandonedBecause is null));
+        Assert.IsEmpty(master.AbandonedBinaries);
+    }
+
+    [TestMethod]
+    public void CheckpointClearsUnsavedWork()
+    {
+        var master = new MasterControllerProcess();
+        var worker = CreateWorker();
+        FinishItem(worker, CreateItem("saved"));
+        worker.HandleOutputLine(CrawlWorkerProtocol.CheckpointMessage);
+        FinishItem(worker, CreateItem("unsaved"));
+
+        master.RequeueUnsavedWork(worker);
+        var requeued = DequeueAll(master);
+
+        Assert.HasCount(1, requeued);
+        Assert.AreEqual(@"C:\bin\unsaved.dll", requeued[0].Binary.BinaryPath);
+
+        // And once it's been requeued, it's not this worker's unsaved work any more.
+        master.RequeueUnsavedWork(worker);
+        Assert.IsFalse(master.TryDequeue(out _));
+    }
+
+    [TestMethod]
+    public void BinaryInUnsavedWorkTooManyTimesIsAbandoned()
+    {
+        var master = new MasterControllerProcess();
+        var worker = CreateWorker();
+        FinishItem(worker, CreateItem("belowCutoff", timesRequeued: MasterControllerProcess.MaxTimesRequeued - 1));
+        FinishItem(worker, CreateItem("atCutoff", timesRequeued: MasterControllerProcess.MaxTimesRequeued));
+
+        master.RequeueUnsavedWork(worker);
+        var requeued = DequeueAll(master);
+
+        Assert.HasCount(2, requeued);
+        Assert.AreEqual(@"C:\bin\atCutoff.dll", requeued[0].Binary.BinaryPath);
+        Assert.AreEqual(WorkItemOutcome.WorkerExited, requeued[0].AbandonedBecause);
+        Assert.AreEqual(@"C:\bin\belowCutoff.dll", requeued[1].Binary.BinaryPath);
+        Assert.IsNull(requeued[1].AbandonedBecause);
+        Assert.AreEqual(MasterControllerProcess.MaxTimesRequeued, requeued[1].TimesRequeued);
+
+        Assert.HasCount(1, master.AbandonedBinaries);
+        Assert.AreEqual(@"C:\bin\atCutoff.dll", master.AbandonedBinaries.Single().BinaryPath);
+
+        // Abandoning it isn't an error from a worker, it's written down in the results like any other binary that failed.
+        master.ProcessAllDeferredWorkerErrors(new NoOpLogger());
+    }
+
+    [TestMethod]
+    public void AbandonedBinaryInUnsavedWorkTooManyTimesIsAWorkerError()
+    {
+        var master = new MasterControllerProcess();
+        var worker = CreateWorker();
+        FinishItem(worker, CreateItem("abandoned", abandonedBecause: WorkItemOutcome.ExceededMemoryLimit, timesRequeued: MasterControllerProcess.MaxTimesRequeued));
+
+        master.RequeueUnsavedWork(worker);
+
+        Assert.IsFalse(master.TryDequeue(out _));
+        Assert.ThrowsExactly<InvalidOperationException>(() => master.ProcessAllDeferredWorkerErrors(new NoOpLogger()));
+    }
+}
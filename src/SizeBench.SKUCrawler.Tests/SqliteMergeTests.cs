@@ -0,0 +1,241 @@
+﻿using System.Globalization;
+using System.IO;
+using Microsoft.Data.Sqlite;
+using SizeBench.AnalysisEngine;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+using SizeBench.SKUCrawler.CrawlFolder;
+using SizeBench.TestDataCommon;
+
+namespace SizeBench.SKUCrawler.Tests;
+
+[TestClass]
+public sealed class SqliteMergeTests
+{
+    private const string TimestampOfMaster = "merge-test";
+    private const int BinariesPerBatch = 2;
+
+    private string TestDirectory = String.Empty;
+
+    [TestInitialize]
+    public void TestInitialize()
+    {
+        this.TestDirectory = Path.Combine(Path.GetTempPath(), nameof(SqliteMergeTests), Path.GetRandomFileName());
+        Directory.CreateDirectory(this.TestDirectory);
+    }
+
+    [TestCleanup]
+    public void TestCleanup()
+    {
+        if (Directory.Exists(this.TestDirectory))
+        {
+            Directory.Delete(this.TestDirectory, recursive: true);
+        }
+    }
+
+    // 1 is merged on its own, 3 leaves the last batch without a pair on the first level, and 5 leaves an intermediate database without a
+    // pair on a later level too.
+    [TestMethod]
+    [DataRow(1)]
+    [DataRow(2)]
+    [DataRow(3)]
+    [DataRow(5)]
+    public void EveryForeignKeyResolvesAfterMerging(int batchCount)
+    {
+        for (var batchNumber = 1; batchNumber <= batchCount; batchNumber++)
+        {
+            WriteBatch(batchNumber, includeOptionalTables: true);
+        }
+
+        using var connection = MergeAndOpen();
+
+        Assert.AreEqual(batchCount * BinariesPerBatch, QueryCount(connection, "SELECT COUNT(*) FROM Binaries"));
+        AssertForeignKeysResolve(connection);
+
+        // A key can resolve and still point at the wrong row, if an offset was wrong - so everything that refers to two tables has to find
+        // both of them in the same binary, and every binary has to have all of its rows.
+        Assert.AreEqual(0, QueryCount(connection, "SELECT COUNT(*) FROM COFFGroups AS cg INNER JOIN Sections AS s ON s.BinarySectionID = cg.BinarySectionID WHERE s.BinaryID <> cg.BinaryID"));
+        Assert.AreEqual(0, QueryCount(connection, "SELECT COUNT(*) FROM Compilands AS c INNER JOIN Libs AS l ON l.BinaryLibID = c.BinaryLibID WHERE l.BinaryID <> c.BinaryID"));
+        Assert.AreEqual(0, QueryCount(connection, "SELECT COUNT(*) FROM SymbolLocations AS sl " +
+                                                  "INNER JOIN Compilands AS c ON c.BinaryCompilandID = sl.BinaryCompilandID " +
+                                                  "INNER JOIN SourceFiles AS sf ON sf.SourceFileID = sl.SourceFileID " +
+                                                  "WHERE c.BinaryID <> sf.BinaryID"));
+        foreach (var table in new[] { "Sections", "COFFGroups", "Libs", "Compilands", "SourceFiles", "DuplicateData", "SymbolLocations", "PerfStats", "CrawlManifest" })
+        {
+            Assert.AreEqual(batchCount * BinariesPerBatch, QueryCount(connection, $"SELECT COUNT(DISTINCT BinaryID) FROM ({RowsByBinaryID(table)})"), table);
+            Assert.AreEqual(QueryCount(connection, $"SELECT MIN(RowCount) FROM (SELECT COUNT(*) AS RowCount FROM ({RowsByBinaryID(table)}) GROUP BY BinaryID)"),
+                            QueryCount(connection, $"SELECT MAX(RowCount) FROM (SELECT COUNT(*) AS RowCount FROM ({RowsByBinaryID(table)}) GROUP BY BinaryID)"), table);
+        }
+    }
+
+    [TestMethod]
+    public void SymbolsSharedAcrossBatchesAreStoredOnce()
+    {
+        const int batchCount = 3;
+        for (var batchNumber = 1; batchNumber <= batchCount; batchNumber++)
+        {
+            WriteBatch(batchNumber, includeOptionalTables: true);
+        }
+
+        using var connection = MergeAndOpen();
+
+        // The two symbols every binary has, and the one each batch has in both of its binaries.
+        Assert.AreEqual(2 + batchCount, QueryCount(connection, "SELECT COUNT(*) FROM Symbols"));
+        Assert.AreEqual(1, QueryCount(connection, "SELECT COUNT(*) FROM Symbols WHERE SymbolName = 'SharedData' AND Size = 16"));
+        Assert.AreEqual(1, QueryCount(connection, "SELECT COUNT(*) FROM Symbols WHERE SymbolName = 'SharedFunction' AND Size = 32"));
+
+        Assert.AreEqual(batchCount * BinariesPerBatch,
+                        QueryCount(connection, "SELECT COUNT(*) FROM DuplicateData AS ddi INNER JOIN Symbols AS s ON s.SymbolID = ddi.SymbolID WHERE s.SymbolName = 'SharedData'"));
+        Assert.AreEqual(batchCount * BinariesPerBatch,
+                        QueryCount(connection, "SELECT COUNT(*) FROM SymbolLocations AS sl INNER JOIN Symbols AS s ON s.SymbolID = sl.SymbolID WHERE s.SymbolName = 'SharedFunction'"));
+
+        for (var batchNumber = 1; batchNumber <= batchCount; batchNumber++)
+        {
+            Assert.AreEqual(1, QueryCount(connection, $"SELECT COUNT(*) FROM Symbols WHERE SymbolName = 'Batch{batchNumber}Function'"));
+            Assert.AreEqual(BinariesPerBatch,
+                            QueryCount(connection, $"SELECT COUNT(*) FROM SymbolLocations AS sl INNER JOIN Symbols AS s ON s.SymbolID = sl.SymbolID WHERE s.SymbolName = 'Batch{batchNumber}Function'"));
+        }
+    }
+
+    [TestMethod]
+    public void BatchesWithoutTheOptionalTablesStillMerge()
+    {
+        WriteBatch(1, includeOptionalTables: true);
+        WriteBatch(2, includeOptionalTables: false);
+        WriteBatch(3, includeOptionalTables: true);
+
+        using var connection = MergeAndOpen();
+
+        Assert.AreEqual(3 * BinariesPerBatch, QueryCount(connection, "SELECT COUNT(*) FROM Binaries"));
+        AssertForeignKeysResolve(connection);
+
+        const string binariesFromBatch2 = "(SELECT BinaryID FROM Binaries WHERE Name LIKE 'batch2-%')";
+        Assert.AreEqual(2 * BinariesPerBatch, QueryCount(connection, "SELECT COUNT(*) FROM DuplicateData"));
+        Assert.AreEqual(0, QueryCount(connection, $"SELECT COUNT(*) FROM DuplicateData WHERE BinaryID IN {binariesFromBatch2}"));
+        Assert.AreEqual(0, QueryCount(connection, $"SELECT COUNT(*) FROM CrawlManifest WHERE BinaryID IN {binariesFromBatch2}"));
+        Assert.AreEqual(2 * BinariesPerBatch, QueryCount(connection, "SELECT COUNT(*) FROM CrawlManifest"));
+        Assert.AreEqual(0, QueryCount(connection, "SELECT COUNT(*) FROM SymbolLocations AS sl INNER JOIN Compilands AS c ON c.BinaryCompilandID = sl.BinaryCompilandID " +
+                                                 $"WHERE c.BinaryID IN {binariesFromBatch2}"));
+
+        // What batch 2 does have is still there.
+        Assert.AreEqual(QueryCount(connection, "SELECT COUNT(*) FROM Sections WHERE BinaryID = (SELECT MIN(BinaryID) FROM Binaries)"),
+                        QueryCount(connection, $"SELECT COUNT(*) FROM Sections WHERE BinaryID = (SELECT MIN(BinaryID) FROM {binariesFromBatch2})"));
+    }
+
+    // Writes a batch database the way a worker does, with two binaries built from the same test data - so within the batch their symbols
+    // are shared, and across batches it's up to the merge.  Without the optional tables, the batch also has no CrawlManifest table, like
+    // one from before the manifest existed.
+    private void WriteBatch(int batchNumber, bool includeOptionalTables)
+    {
+        using var logger = new NoOpLogger();
+        using var sink = new SqliteCrawlResultSink(Path.Combine(this.TestDirectory, $"SizeBench.SKUCrawler-{TimestampOfMaster}-batch{batchNumber}-000"),
+                                                   binaryRoot: String.Empty,
+                                                   includeWastefulVirtuals: includeOptionalTables,
+                                                   includeCodeSymbols: includeOptionalTables,
+                                                   includeDuplicateDataItems: includeOptionalTables);
+        var generators = new List<SingleBinaryDataGenerator>();
+        try
+        {
+            var results = new List<ProductBinaryAnalysisResults>();
+            for (var i = 0; i < BinariesPerBatch; i++)
+            {
+                var generator = new SingleBinaryDataGenerator();
+                generators.Add(generator);
+                results.Add(CreateResults(generator, $"batch{batchNumber}-{i}.dll", batchNumber));
+            }
+
+            sink.Open(logger);
+            sink.Write(results, logger);
+            sink.Complete(logger);
+        }
+        finally
+        {
+            foreach (var generator in generators)
+            {
+                generator.Dispose();
+            }
+        }
+
+        if (!includeOptionalTables)
+        {
+            using var connection = Open(sink.OutputPath);
+            using var command = connection.CreateCommand();
+            command.CommandText = $"DROP TABLE {CrawlManifest.TableName}";
+            command.ExecuteNonQuery();
+        }
+    }
+
+    private static ProductBinaryAnalysisResults CreateResults(SingleBinaryDataGenerator generator, string binaryName, int batchNumber)
+    {
+        var sharedData = new StaticDataSymbol(generator.DataCache, "SharedData", rva: 0, size: 16, isVirtualSize: false, symIndexId: generator._nextSymIndexId++,
+                                              dataKind: DataKind.DataIsFileStatic, type: null, referencedIn: null, functionParent: null);
+        var duplicateData = new DuplicateDataItem(sharedData, generator.A1Compiland);
+        duplicateData.AddReferencedCompilandIfNecessary(generator.A2Compiland, 16);
+
+        return new ProductBinaryAnalysisResults(binaryName)
+        {
+            fullBinarySize = 1000,
+            sections = generator.Sections,
+            libs = generator.Libs,
+            sourceFiles = generator.SourceFiles,
+            duplicateDataItems = [duplicateData],
+            codeSymbolsInAllSourceFiles = new Dictionary<(Compiland compiland, SourceFile sourceFile), List<SKUCrawlerSymbol>>()
+            {
+                [(generator.A1Compiland, generator.A1CppSourceFile)] =
+                [
+                    new SKUCrawlerSymbol() { Name = "SharedFunction", Size = 32 },
+                    new SKUCrawlerSymbol() { Name = $"Batch{batchNumber}Function", Size = 4 },
+                ],
+            },
+            manifestEntry = new CrawlManifestEntry(Guid.NewGuid(), PdbAge: 1, BinarySHA256: binaryName),
+        };
+    }
+
+    private SqliteConnection MergeAndOpen()
+    {
+        Program.MergeDatabases(new CrawlFolderArguments() { OutputFolder = this.TestDirectory, TimestampOfMaster = TimestampOfMaster });
+
+        // Nothing the merge made along the way should be left behind, just the batches and what they were merged into.
+        Assert.IsEmpty(Directory.EnumerateDirectories(this.TestDirectory));
+        Assert.IsTrue(Directory.EnumerateFiles(this.TestDirectory).All(file => file.EndsWith(".db", StringComparison.Ordinal)));
+
+        return Open(Path.Combine(this.TestDirectory, "merged.db"));
+    }
+
+    private static SqliteConnection Open(string path)
+    {
+        var connection = new SqliteConnection(new SqliteConnectionStringBuilder()
+        {
+            DataSource = path,
+            Pooling = false
+        }.ToString());
+        connection.Open();
+        return connection;
+    }
+
+    private static long QueryCount(SqliteConnection connection, string query)
+    {
+        using var command = connection.CreateCommand();
+        command.CommandText = query;
+        return Convert.ToInt64(command.ExecuteScalar(), CultureInfo.InvariantCulture);
+    }
+
+    // Each table's rows with the binary they belong to, for the tables that only say that through another table.
+    private static string RowsByBinaryID(string table) => table switch
+    {
+        "SymbolLocations" => "SELECT c.BinaryID FROM SymbolLocations AS sl INNER JOIN Compilands AS c ON c.BinaryCompilandID = sl.BinaryCompilandID",
+        _ => $"SELECT BinaryID FROM {table}",
+    };
+
+    // The merged schema declares every foreign key, so SQLite can check them all - it returns one row for each that doesn't resolve.
+    private static void AssertForeignKeysResolve(SqliteConnection connection)
+    {
+        using var command = connection.CreateCommand();
+        command.CommandText = "PRAGMA foreign_key_check";
+        using var reader = command.ExecuteReader();
+        if (reader.Read())
+        {
+            Assert.Fail($"{reader.GetString(0)} row {reader.GetInt64(1)} refers to a row in {reader.GetString(2)} that doesn't exist.");
+        }
+    }
+}
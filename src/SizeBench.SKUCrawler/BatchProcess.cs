@@ -1,114 +1,141 @@
 ﻿using System.Diagnostics;
 using System.Globalization;
 using System.IO;
-using System.Text.RegularExpressions;
-using System.Threading.Channels;
-using Microsoft.Data.Sqlite;
 using SizeBench.AnalysisEngine;
 using SizeBench.AnalysisEngine.Symbols;
 using SizeBench.AsyncInfrastructure;
 using SizeBench.Logging;
-using SizeBench.Threading.Tasks.Schedulers;
 
 namespace SizeBench.SKUCrawler;
 
 internal sealed class BatchProcess
 {
-    // At least in SKUCrawler we want to 'fold up' all the BlockSymbols from a function up into the Function.
-    // At some point it'd be good to have a way to do this in the Analysis Engine for other customers, as BlockSymbols suck
-    // for diffing in the GUI too - but that needs a lot more thought because it breaks something important by allowing a
-    // single symbol to contribute to multiple COFF Groups and how to visualize that in the UI and represent that in the
-    // object model is hard.  So for now, to unblock SKUCrawler progress, this 'folding up blocks' functionality is here.
-    private sealed class SKUCrawlerSymbol
-    {
-        public string Name = String.Empty;
-        public string? DetemplatedName;
-        public uint Size;
-        public SKUCrawlerSymbol() { }
-        public SKUCrawlerSymbol(ISymbol sym)
-        {
-            if (sym is CodeBlockSymbol)
-            {
-                throw new ArgumentException("Don't try to construct a SKUCrawlerSymbol from a block", nameof(sym));
-            }
-
-            this.Name = sym.Name;
-            this.DetemplatedName = null;
-            this.Size = sym.Size;
-        }
-    }
-
     private readonly string _logFilenameBase;
 
     public string BinaryRoot { get; set; } = String.Empty;
     public bool IncludeWastefulVirtuals { get; set; }
     public bool IncludeCodeSymbols { get; set; }
     public bool IncludeDuplicateDataItems { get; set; }
+    public CrawlOutputFormat OutputFormat { get; set; }
 
-    private string DbFilename => $"{this._logFilenameBase}.db";
+    private readonly int _workerNumber;
 
-    private sealed class ProductBinaryAnalysisResults
+    internal static readonly Dictionary<ToolLanguage, string> ToolLanguageFriendlyNames = new Dictionary<ToolLanguage, string>();
+
+    public BatchProcess(int workerNumber, string logFilenameBase)
     {
-        public ProductBinaryAnalysisResults(string binaryPath)
+        this._workerNumber = workerNumber;
+        this._logFilenameBase = logFilenameBase;
+
+        ToolLanguageFriendlyNames.Clear();
+        foreach (var toolLanguage in EnumHelper<ToolLanguage>.GetValues())
         {
-            this.binaryPath = binaryPath;
+            ToolLanguageFriendlyNames.Add(toolLanguage, EnumHelper<ToolLanguage>.GetDisplayValue(toolLanguage));
         }
 
-        public readonly string binaryPath;
-        public long fullBinarySize;
-        public long openingTookMs;
-        public IReadOnlyList<BinarySection>? sections;
-        public long sectionEnumerationTookMs;
-        public IReadOnlyCollection<Library>? libs;
-        public long libEnumerationTookMs;
-        public IReadOnlyList<SourceFile>? sourceFiles;
-        public long sourceFileEnumerationTookMs;
-        public IReadOnlyList<DuplicateDataItem>? duplicateDataItems;
-        public long ddiEnumerationTookMs;
-        public IReadOnlyList<WastefulVirtualItem>? wastefulVirtualItems;
-        public long wviEnumerationTookMs;
-        public IReadOnlyList<AnnotationSymbol>? annotations;
-        public long annotationEnumerationTookMs;
-        public Dictionary<(Compiland compiland, SourceFile sourceFile), List<SKUCrawlerSymbol>>? codeSymbolsInAllSourceFiles;
-        public long codeSymbolsInSourceFilesEnumerationTookMs;
-        public Exception? errorDuringProcessing;
     }
-    private readonly Channel<ProductBinaryAnalysisResults> _databaseWriteChannel = Channel.CreateUnbounded<ProductBinaryAnalysisResults>
-        (new UnboundedChannelOptions() { SingleReader = true, SingleWriter = false });
-
-    private readonly int _batchNumber;
-    private readonly List<ProductBinary> _productBinariesInThisBatch;
 
-    private static readonly Dictionary<ToolLanguage, string> ToolLanguageFriendlyNames = new Dictionary<ToolLanguage, string>();
+    // Runs this process as one of the master's workers - analyzing the work items it sends, one at a time, until it sends an empty line or
+    // closes stdin.  See CrawlWorkerProtocol for the details.
+    //
+    // Results go into one output file per checkpoint, each only complete once the checkpoint is reached, so that when the master has to kill
+    // this worker it knows exactly which binaries need to be done again.
+    public Task AnalyzeWorkItemsFromMasterAsync(IApplicationLogger appLogger, TextReader workItems, TextWriter toMaster, int binariesPerCheckpoint, TimeSpan checkpointInterval)
+    {
+        // Analysis blocks on AsyncPump, so this gets a thread of its own rather than tying up one from the thread pool.
+        return Task.Factory.StartNew(() => AnalyzeWorkItemsFromMaster(appLogger, workItems, toMaster, binariesPerCheckpoint, checkpointInterval),
+                                     CancellationToken.None, TaskCreationOptions.LongRunning, TaskScheduler.Default);
+    }
 
-    public BatchProcess(int batchNumber, List<ProductBinary> productBinariesInThisBatch, string logFilenameBase)
+    private void AnalyzeWorkItemsFromMaster(IApplicationLogger appLogger, TextReader workItems, TextWriter toMaster, int binariesPerCheckpoint, TimeSpan checkpointInterval)
     {
-        this._batchNumber = batchNumber;
-        this._productBinariesInThisBatch = productBinariesInThisBatch;
-        this._logFilenameBase = logFilenameBase;
+        var sessionOptions = CreateSessionOptions();
+        var checkpointNumber = 0;
+        var binariesSinceCheckpoint = 0;
+        var binariesAnalyzed = 0;
+        var checkpointWatch = new Stopwatch();
+        ICrawlResultSink? sink = null;
 
-        ToolLanguageFriendlyNames.Clear();
-        foreach (var toolLanguage in EnumHelper<ToolLanguage>.GetValues())
+        try
         {
-            ToolLanguageFriendlyNames.Add(toolLanguage, EnumHelper<ToolLanguage>.GetDisplayValue(toolLanguage));
-        }
+            while (workItems.ReadLine() is string line && line.Length > 0)
+            {
+                var workItem = CrawlWorkerProtocol.ParseWorkItem(line);
+                binariesAnalyzed++;
+
+                ProductBinaryAnalysisResults results;
+                if (workItem.AbandonedBecause is WorkItemOutcome reason)
+                {
+                    toMaster.WriteLine($"{DateTime.Now.ToString("HH:mm:ss", CultureInfo.InvariantCulture)} Worker={this._workerNumber:000}: {binariesAnalyzed:000}: Recording that {workItem.Binary.BinaryPath} was abandoned ({reason})");
+                    results = new ProductBinaryAnalysisResults(workItem.Binary.BinaryPath)
+                    {
+                        fullBinarySize = File.Exists(workItem.Binary.BinaryPath) ? new FileInfo(workItem.Binary.BinaryPath).Length : 0,
+                        errorDuringProcessing = CrawlWorkerProtocol.CreateExceptionForAbandonedBinary(reason),
+                    };
+                }
+                else
+                {
+                    toMaster.WriteLine($"{DateTime.Now.ToString("HH:mm:ss", CultureInfo.InvariantCulture)} Worker={this._workerNumber:000}: {binariesAnalyzed:000}: Analyzing {workItem.Binary.BinaryPath}");
+                    results = AnalyzeOneBinaryOnThisThread(appLogger.CreateSessionLog(workItem.Binary.BinaryPath), workItem.Binary.BinaryPath, workItem.Binary.PdbPath, sessionOptions);
+                }
+
+                if (sink is null)
+                {
+                    sink = OpenSink(appLogger, checkpointNumber);
+                    checkpointWatch.Restart();
+                }
+
+                sink.Write([results], appLogger);
+                toMaster.WriteLine(CrawlWorkerProtocol.BinaryFinishedMessage);
+                binariesSinceCheckpoint++;
+
+                if (binariesSinceCheckpoint >= binariesPerCheckpoint || checkpointWatch.Elapsed >= checkpointInterval)
+                {
+                    CompleteCheckpoint(sink, appLogger, toMaster);
+                    sink = null;
+                    checkpointNumber++;
+                    binariesSinceCheckpoint = 0;
+                }
+            }
 
+            if (sink != null)
+            {
+                CompleteCheckpoint(sink, appLogger, toMaster);
+                sink = null;
+            }
+        }
+        finally
+        {
+            // Only reached with a sink still open if something went wrong, in which case its partial output is thrown away - the master
+            // will send everything since the last checkpoint to another worker.
+            sink?.Dispose();
+        }
     }
 
-    public async Task AnalyzeBatchAsync(IApplicationLogger appLogger)
+    private ICrawlResultSink OpenSink(IApplicationLogger appLogger, int checkpointNumber)
     {
-        //TODO: SKUCrawler: check if Parallel.ForEachAsync might be a simpler way of writing this code, once on .NET 6
-        using var taskScheduler = new QueuedTaskScheduler(threadCount: Environment.ProcessorCount * 10);
-        var taskFactory = new TaskFactory(taskScheduler);
-        var tasks = new List<Task>(100);
+        var sink = CreateSink($"{this._logFilenameBase}-{checkpointNumber:000}");
+        using (var taskLog = appLogger.StartTaskLog($"Ensure {this.OutputFormat} output exists at {sink.OutputPath} and is open"))
+        {
+            sink.Open(taskLog);
+        }
 
-        using (var taskLog = appLogger.StartTaskLog("Ensure SQLite database exists and conenction is open"))
+        return sink;
+    }
+
+    private static void CompleteCheckpoint(ICrawlResultSink sink, IApplicationLogger appLogger, TextWriter toMaster)
+    {
+        using (appLogger.StartTaskLog("Write binary information to " + sink.OutputPath))
         {
-            EnsureDatabaseCreated(taskLog);
+            sink.Complete(appLogger);
         }
 
-        var databaseWriterTask = Task.Factory.StartNew(() => WriteToDatabaseAsync(appLogger).GetAwaiter().GetResult(), CancellationToken.None, TaskCreationOptions.LongRunning, TaskScheduler.Default);
+        sink.Dispose();
+        toMaster.WriteLine(CrawlWorkerProtocol.CheckpointMessage);
+    }
 
+    private SessionOptions CreateSessionOptions()
+    {
         var symbolSourcesSupported = SymbolSourcesSupported.None;
         if (this.IncludeCodeSymbols || this.IncludeWastefulVirtuals)
         {
@@ -119,33 +146,16 @@ internal sealed class BatchProcess
             symbolSourcesSupported |= SymbolSourcesSupported.DataSymbols | SymbolSourcesSupported.XDATA;
         }
 
-        var sessionOptions = new SessionOptions() { SymbolSourcesSupported = symbolSourcesSupported };
-
-        for (var i = 0; i < this._productBinariesInThisBatch.Count; i++)
-        {
-            var binary = this._productBinariesInThisBatch[i];
-            var log = appLogger.CreateSessionLog(binary.BinaryPath);
-            var binaryNumber = i + 1;
-            tasks.Add(taskFactory.StartNew(async () =>
-            {
-                await Console.Out.WriteLineAsync($"{DateTime.Now.ToString("HH:mm:ss", CultureInfo.InvariantCulture)} Batch={this._batchNumber:000}, TID={Environment.CurrentManagedThreadId:000}: {binaryNumber:00}/{this._productBinariesInThisBatch.Count}: Analyzing {binary.BinaryPath}");
-                AnalyzeOneBinaryOnThreadPool(log, binary.BinaryPath, binary.PdbPath, sessionOptions);
-            }, CancellationToken.None, TaskCreationOptions.LongRunning, taskScheduler));
-        }
-
-        await taskFactory.ContinueWhenAll(tasks.ToArray(),
-                                          _ => this._databaseWriteChannel.Writer.Complete());
-
-        await databaseWriterTask;
+        return new SessionOptions() { SymbolSourcesSupported = symbolSourcesSupported };
     }
 
-    private void AnalyzeOneBinaryOnThreadPool(ILogger log, string binaryPath, string pdbPath, SessionOptions sessionOptions)
+    private ProductBinaryAnalysisResults AnalyzeOneBinaryOnThisThread(ILogger log, string binaryPath, string pdbPath, SessionOptions sessionOptions)
     {
+        var results = new ProductBinaryAnalysisResults(binaryPath);
+
         AsyncPump.Run(
             async delegate
             {
-                var results = new ProductBinaryAnalysisResults(binaryPath);
-
                 try
                 {
                     if (!File.Exists(binaryPath))
@@ -169,6 +179,9 @@ internal sealed class BatchProcess
                     openingWatch.Stop();
                     results.openingTookMs = openingWatch.ElapsedMilliseconds;
                     await AnalyzeOneBinary(results, session, log);
+
+                    // Only binaries that analyzed successfully go in the manifest, since they're the only ones a later crawl can carry forward.
+                    results.manifestEntry = CrawlManifestEntry.Compute(binaryPath);
                 }
                 catch (BinaryNotAnalyzableException bnae)
                 {
@@ -183,11 +196,9 @@ internal sealed class BatchProcess
                     log.LogException($"Failed to analyze {binaryPath}", ex);
                     results.errorDuringProcessing = ex;
                 }
-                finally
-                {
-                    this._databaseWriteChannel.Writer.TryWrite(results);
-                }
             });
+
+        return results;
     }
 
     private async Task AnalyzeOneBinary(ProductBinaryAnalysisResults results, Session session, ILogger log)
@@ -365,758 +376,13 @@ internal sealed class BatchProcess
         results.codeSymbolsInSourceFilesEnumerationTookMs = symbolsInSourceFilesWatch.ElapsedMilliseconds;
     }
 
-    private async Task WriteToDatabaseAsync(IApplicationLogger logger)
+    private ICrawlResultSink CreateSink(string outputFilenameBase)
     {
-        using var taskLog = logger.StartTaskLog("Write binary information to database");
-        using var connection = new SqliteConnection(new SqliteConnectionStringBuilder()
+        return this.OutputFormat switch
         {
-            DataSource = this.DbFilename
-        }.ToString());
-        await connection.OpenAsync();
-
-        {
-            // Disable on-disk journaling for perf
-            var pragmaCommand = connection.CreateCommand();
-            pragmaCommand.CommandText = "PRAGMA journal_mode = MEMORY;";
-            await pragmaCommand.ExecuteNonQueryAsync();
-        }
-
-#pragma warning disable CA1849 // Call async methods when in an async method - the async version returns DbTransaction, we need a SqliteTransaction.
-        using var transaction = connection.BeginTransaction();
-#pragma warning restore CA1849 // Call async methods when in an async method
-
-        while (await this._databaseWriteChannel.Reader.WaitToReadAsync().ConfigureAwait(false))
-        {
-            while (this._databaseWriteChannel.Reader.TryRead(out var databaseWrite))
-            {
-                try
-                {
-                    var compilandsToDatabaseIDs = new Dictionary<Compiland, int>();
-                    var symbolsToDatabaseIDs = new Dictionary<uint, Dictionary<string, int>>();
-
-                    var binaryID = InsertBinary(connection, transaction, databaseWrite);
-
-                    InsertPerfStats(connection, transaction, binaryID, databaseWrite);
-
-                    if (databaseWrite.sections != null)
-                    {
-                        foreach (var section in databaseWrite.sections)
-                        {
-                            InsertSectionAndCOFFGroupsInThatSection(connection, transaction, binaryID, section);
-                        }
-                    }
-
-                    if (databaseWrite.libs != null)
-                    {
-                        foreach (var lib in databaseWrite.libs)
-                        {
-                            InsertLibAndCompilands(connection, transaction, binaryID, lib, compilandsToDatabaseIDs);
-                        }
-                    }
-
-                    var sourceFilesToDatabaseIDs = new Dictionary<SourceFile, int>();
-
-                    // We need to establish an ID for the 'null' source file since some annotations do not have a source file but still need to
-                    // get their foreign key set up.
-                    var sourceFileNullID = -1;
-
-                    if (databaseWrite.sourceFiles != null)
-                    {
-                        sourceFileNullID = InsertSourceFile(connection, transaction, binaryID, null, sourceFilesToDatabaseIDs);
-
-                        foreach (var sf in databaseWrite.sourceFiles)
-                        {
-                            InsertSourceFile(connection, transaction, binaryID, sf, sourceFilesToDatabaseIDs);
-                        }
-                    }
-
-                    if (this.IncludeDuplicateDataItems && databaseWrite.duplicateDataItems != null)
-                    {
-                        foreach (var ddi in databaseWrite.duplicateDataItems)
-                        {
-                            InsertDuplicateDataItem(connection, transaction, binaryID, symbolsToDatabaseIDs, ddi);
-                        }
-                    }
-
-                    if (this.IncludeWastefulVirtuals && databaseWrite.wastefulVirtualItems != null)
-                    {
-                        foreach (var wvi in databaseWrite.wastefulVirtualItems)
-                        {
-                            InsertWastefulVirtualItems(connection, transaction, binaryID, wvi);
-                        }
-                    }
-
-                    if (databaseWrite.annotations != null)
-                    {
-                        foreach (var annotation in databaseWrite.annotations)
-                        {
-                            InsertAnnotation(connection, transaction, binaryID, sourceFilesToDatabaseIDs, sourceFileNullID, annotation);
-                        }
-                    }
-
-                    if (this.IncludeCodeSymbols && databaseWrite.codeSymbolsInAllSourceFiles != null)
-                    {
-                        foreach (var symbolsInCompilandAndSourceFile in databaseWrite.codeSymbolsInAllSourceFiles)
-                        {
-                            InsertSymbolsInSourceFileAndCompiland(connection, transaction,
-                                                                  compilandsToDatabaseIDs[symbolsInCompilandAndSourceFile.Key.compiland],
-                                                                  sourceFilesToDatabaseIDs[symbolsInCompilandAndSourceFile.Key.sourceFile],
-                                                                  symbolsToDatabaseIDs, symbolsInCompilandAndSourceFile.Value);
-                        }
-                    }
-
-                    if (databaseWrite.errorDuringProcessing != null)
-                    {
-                        InsertError(connection, transaction, binaryID, databaseWrite.errorDuringProcessing);
-                    }
-                }
-    #pragma warning disable CA1031 // Do not catch general exception types - if we throw trying to write one binary, maybe we can still write most of them, let's keep going
-                catch (Exception ex)
-    #pragma warning restore CA1031 // Do not catch general exception types
-                {
-                    Program.LogExceptionAndReportToStdErr("Database write threw an exception!", ex, logger);
-                }
-            }
-        }
-
-        await transaction.CommitAsync();
-    }
-
-    private const string _BinariesTable = "Binaries";
-    private const string _PerfStatsTable = "PerfStats";
-    private const string _SectionTableName = "Sections";
-    private const string _COFFGroupTableName = "COFFGroups";
-    private const string _LibsTableName = "Libs";
-    private const string _CompilandsTableName = "Compilands";
-    private const string _DuplicateDataTableName = "DuplicateData";
-    private const string _WastefulVirtualsTypeTableName = "WastefulVirtualTypes";
-    private const string _WastefulVirtualsFunctionTableName = "WastefulVirtualFunctions";
-    private const string _SourceFilesTableName = "SourceFiles";
-    private const string _AnnotationsTableName = "Annotations";
-    private const string _SymbolsTableName = "Symbols";
-    private const string _SymbolLocationsTableName = "SymbolLocations";
-    private const string _ErrorsTableName = "Errors";
-
-    private int InsertBinary(SqliteConnection connection, SqliteTransaction transaction, ProductBinaryAnalysisResults results)
-    {
-        var binaryName = !String.IsNullOrEmpty(this.BinaryRoot)
-                       ? Regex.Replace(results.binaryPath, "^" + this.BinaryRoot.Replace(@"\", @"\\", StringComparison.Ordinal), String.Empty, RegexOptions.IgnoreCase).TrimStart('\\')
-                       : Path.GetFileName(results.binaryPath);
-
-        using var command = connection.CreateCommand();
-        command.Transaction = transaction;
-        command.CommandText = $"INSERT INTO {_BinariesTable} " +
-                              $"(Name, Size) " +
-                              $"VALUES " +
-                              $"(@Name, @Size)";
-
-        command.Parameters.AddWithValue("@Name", binaryName);
-        command.Parameters.AddWithValue("@Size", results.fullBinarySize);
-        command.ExecuteNonQuery();
-
-        command.CommandText = "select last_insert_rowid()";
-        return Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture);
-    }
-
-    private static void InsertPerfStats(SqliteConnection connection, SqliteTransaction transaction, int binaryID, ProductBinaryAnalysisResults results)
-    {
-        using var command = connection.CreateCommand();
-        command.Transaction = transaction;
-        command.CommandText =
-                            $"INSERT INTO {_PerfStatsTable} " +
-                            $"(BinaryID, OpeningTookMs, SectionsTookMs, LibsTookMs, SourceFilesTookMs, DDITookMs, WVITookMs, AnnotationsTookMs, SymbolsInCompilandsTookMs) " +
-                            $"VALUES " +
-                            $"(@BinaryID, @OpeningTookMs, @SectionsTookMs, @LibsTookMs, @SourceFilesTookMs, @DDITookMs, @WVITookMs, @AnnotationsTookMs, @SymbolsInCompilandsTookMs)";
-
-        command.Parameters.AddWithValue("@BinaryID", binaryID);
-        command.Parameters.AddWithValue("@OpeningTookMs", results.openingTookMs);
-        command.Parameters.AddWithValue("@SectionsTookMs", results.sectionEnumerationTookMs);
-        command.Parameters.AddWithValue("@LibsTookMs", results.libEnumerationTookMs);
-        command.Parameters.AddWithValue("@SourceFilesTookMs", results.sourceFileEnumerationTookMs);
-        command.Parameters.AddWithValue("@DDITookMs", results.ddiEnumerationTookMs);
-        command.Parameters.AddWithValue("@WVITookMs", results.wviEnumerationTookMs);
-        command.Parameters.AddWithValue("@AnnotationsTookMs", results.annotationEnumerationTookMs);
-        command.Parameters.AddWithValue("@SymbolsInCompilandsTookMs", results.codeSymbolsInSourceFilesEnumerationTookMs);
-        command.ExecuteNonQuery();
-    }
-
-    private static void InsertSectionAndCOFFGroupsInThatSection(SqliteConnection connection, SqliteTransaction transaction, int binaryID, BinarySection section)
-    {
-        var sectionID = 0;
-        using (var command = connection.CreateCommand())
-        {
-            command.Transaction = transaction;
-            command.CommandText =
-                            $"INSERT INTO {_SectionTableName} " +
-                            $"(BinaryID, SectionName, Size, VirtualSize) " +
-                            $"VALUES " +
-                            $"(@BinaryID, @SectionName, @Size, @VirtualSize)";
-
-            command.Parameters.AddWithValue("@BinaryID", binaryID);
-            command.Parameters.AddWithValue("@SectionName", section.Name);
-            command.Parameters.AddWithValue("@Size", section.Size);
-            command.Parameters.AddWithValue("@VirtualSize", section.VirtualSize);
-            command.ExecuteNonQuery();
-
-            command.CommandText = "select last_insert_rowid()";
-            sectionID = Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture);
-        }
-
-        using (var command = connection.CreateCommand())
-        {
-            command.Transaction = transaction;
-            command.CommandText =
-                            $"INSERT INTO {_COFFGroupTableName} " +
-                            $"(BinaryID, BinarySectionID, COFFGroupName, Size, VirtualSize) " +
-                            $"VALUES " +
-                            $"(@BinaryID, @BinarySectionID, @COFFGroupName, @Size, @VirtualSize)";
-
-            command.Parameters.AddWithValue("@BinaryID", binaryID);
-            command.Parameters.AddWithValue("@BinarySectionID", sectionID);
-            command.Parameters.AddWithValue("@COFFGroupName", String.Empty);
-            command.Parameters.AddWithValue("@Size", 0);
-            command.Parameters.AddWithValue("@VirtualSize", 0);
-
-            foreach (var cg in section.COFFGroups)
-            {
-                command.Parameters["@COFFGroupName"].Value = cg.Name;
-                command.Parameters["@Size"].Value = cg.Size;
-                command.Parameters["@VirtualSize"].Value = cg.VirtualSize;
-                command.ExecuteNonQuery();
-            }
-        }
-    }
-
-    private static void InsertLibAndCompilands(SqliteConnection connection, SqliteTransaction transaction, int binaryID, Library lib, Dictionary<Compiland, int> compilandsToDatabaseIDs)
-    {
-        var libID = 0;
-        using (var command = connection.CreateCommand())
-        {
-            command.Transaction = transaction;
-            command.CommandText =
-                            $"INSERT INTO {_LibsTableName} " +
-                            $"(BinaryID, LibName, Size) " +
-                            $"VALUES " +
-                            $"(@BinaryID, @LibName, @Size)";
-
-            command.Parameters.AddWithValue("@BinaryID", binaryID);
-            command.Parameters.AddWithValue("@LibName", lib.Name);
-            command.Parameters.AddWithValue("@Size", lib.Size);
-            command.ExecuteNonQuery();
-
-            command.CommandText = "select last_insert_rowid()";
-            libID = Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture);
-        }
-
-        using (var command = connection.CreateCommand())
-        {
-            command.Transaction = transaction;
-            command.CommandText =
-                            $"INSERT INTO {_CompilandsTableName} " +
-                            $"(BinaryID, BinaryLibID, CompilandName, Size, CommandLine, RTTIEnabled, Language, FrontEndVersion, BackEndVersion) " +
-                            $"VALUES " +
-                            $"(@BinaryID, @BinaryLibID, @CompilandName, @Size, @CommandLine, @RTTIEnabled, @Language, @FrontEndVersion, @BackEndVersion)";
-
-            command.Parameters.AddWithValue("@BinaryID", binaryID);
-            command.Parameters.AddWithValue("@BinaryLibID", libID);
-            command.Parameters.AddWithValue("@CompilandName", String.Empty);
-            command.Parameters.AddWithValue("@Size", 0);
-            command.Parameters.AddWithValue("@CommandLine", String.Empty);
-            command.Parameters.AddWithValue("@RTTIEnabled", 0);
-            command.Parameters.AddWithValue("@Language", String.Empty);
-            command.Parameters.AddWithValue("@FrontEndVersion", String.Empty);
-            command.Parameters.AddWithValue("@BackEndVersion", String.Empty);
-
-
-            foreach (var compiland in lib.Compilands.Values)
-            {
-                command.CommandText =
-                            $"INSERT INTO {_CompilandsTableName} " +
-                            $"(BinaryID, BinaryLibID, CompilandName, Size, CommandLine, RTTIEnabled, Language, FrontEndVersion, BackEndVersion) " +
-                            $"VALUES " +
-                            $"(@BinaryID, @BinaryLibID, @CompilandName, @Size, @CommandLine, @RTTIEnabled, @Language, @FrontEndVersion, @BackEndVersion)";
-
-                command.Parameters["@CompilandName"].Value = compiland.Name;
-                command.Parameters["@Size"].Value = compiland.Size;
-                command.Parameters["@CommandLine"].Value = compiland.CommandLine;
-                command.Parameters["@RTTIEnabled"].Value = compiland.RTTIEnabled ? 1 : 0;
-                command.Parameters["@Language"].Value = ToolLanguageFriendlyNames[compiland.ToolLanguage];
-                command.Parameters["@FrontEndVersion"].Value = compiland.ToolFrontEndVersion.ToString();
-                command.Parameters["@BackEndVersion"].Value = compiland.ToolBackEndVersion.ToString();
-                command.ExecuteNonQuery();
-
-                command.CommandText = "select last_insert_rowid()";
-                compilandsToDatabaseIDs.Add(compiland, Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture));
-            }
-        }
-    }
-
-    private static int InsertSourceFile(SqliteConnection connection, SqliteTransaction transaction, int binaryID, SourceFile? sourceFile, Dictionary<SourceFile, int> sourceFilesToDatabaseIDs)
-    {
-        using var command = connection.CreateCommand();
-        command.Transaction = transaction;
-        command.CommandText =
-                        $"INSERT INTO {_SourceFilesTableName} " +
-                        $"(BinaryID, SourceFileName, Size) " +
-                        $"VALUES " +
-                        $"(@BinaryID, @SourceFileName, @Size)";
-
-        command.Parameters.AddWithValue("@BinaryID", binaryID);
-        command.Parameters.AddWithValue("@SourceFileName", sourceFile?.Name ?? "unknown source file");
-        command.Parameters.AddWithValue("@Size", sourceFile?.Size ?? 0);
-        command.ExecuteNonQuery();
-
-        command.CommandText = "select last_insert_rowid()";
-        var newID = Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture);
-
-        if (sourceFile != null)
-        {
-            sourceFilesToDatabaseIDs.Add(sourceFile, newID);
-        }
-
-        return newID;
-    }
-
-    private static int InsertSymbol(SqliteConnection connection, SqliteTransaction transaction, Dictionary<uint, Dictionary<string, int>> symbolsToDatabaseIDs, SKUCrawlerSymbol skuSymbol)
-    {
-        if (symbolsToDatabaseIDs.TryGetValue(skuSymbol.Size, out var symbolsOfCorrectSize))
-        {
-            if (symbolsOfCorrectSize != null && symbolsOfCorrectSize.TryGetValue(skuSymbol.Name, out var existingSymbolID))
-            {
-                return existingSymbolID;
-            }
-        }
-
-        // No symbol with this name and size exists, so we'll insert it now.  This keeps the database from having tons of copies of the SymbolName string, and makes it easier
-        // to query across binaries for like symbols, when looking for SKU-wide opportunities across binaries and files.
-        using var command = connection.CreateCommand();
-        command.Transaction = transaction;
-        command.CommandText =
-                        $"INSERT INTO {_SymbolsTableName} " +
-                        $"(SymbolName, SymbolDetemplatedName, Size) " +
-                        $"VALUES " +
-                        $"(@SymbolName, @SymbolDetemplatedName, @Size)";
-
-        command.Parameters.AddWithValue("@SymbolName", skuSymbol.Name);
-        if (skuSymbol.DetemplatedName != null)
-        {
-            command.Parameters.AddWithValue("@SymbolDetemplatedName", skuSymbol.DetemplatedName);
-        }
-        else
-        {
-            command.Parameters.AddWithValue("@SymbolDetemplatedName", DBNull.Value);
-        }
-
-        command.Parameters.AddWithValue("@Size", skuSymbol.Size);
-        command.ExecuteNonQuery();
-
-        command.CommandText = "select last_insert_rowid()";
-        var symbolIDJustInserted = Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture);
-
-        if (symbolsOfCorrectSize != null)
-        {
-            symbolsOfCorrectSize.Add(skuSymbol.Name, symbolIDJustInserted);
-        }
-        else
-        {
-            var newSymbolsOfCorrectSize = new Dictionary<string, int>(StringComparer.Ordinal)
-                {
-                    { skuSymbol.Name, symbolIDJustInserted }
-                };
-            symbolsToDatabaseIDs.Add(skuSymbol.Size, newSymbolsOfCorrectSize);
-        }
-
-        return symbolIDJustInserted;
-    }
-
-    private static void InsertDuplicateDataItem(SqliteConnection connection, SqliteTransaction transaction, int binaryID, Dictionary<uint, Dictionary<string, int>> symbolsToDatabaseIDs, DuplicateDataItem ddi)
-    {
-        var symbolID = InsertSymbol(connection, transaction, symbolsToDatabaseIDs, new SKUCrawlerSymbol(ddi.Symbol));
-
-        using var command = connection.CreateCommand();
-        command.Transaction = transaction;
-        command.CommandText =
-                        $"INSERT INTO {_DuplicateDataTableName} " +
-                        $"(BinaryID, SymbolID, WastedSize) " +
-                        $"VALUES " +
-                        $"(@BinaryID, @SymbolID, @WastedSize)";
-
-        command.Parameters.AddWithValue("@BinaryID", binaryID);
-        command.Parameters.AddWithValue("@SymbolID", symbolID);
-        command.Parameters.AddWithValue("@WastedSize", ddi.WastedSize);
-        command.ExecuteNonQuery();
-    }
-
-    private static void InsertWastefulVirtualItems(SqliteConnection connection, SqliteTransaction transaction, int binaryID, WastefulVirtualItem wvi)
-    {
-        var wastefulVirtualTypeID = 0;
-        using (var command = connection.CreateCommand())
-        {
-            command.Transaction = transaction;
-            command.CommandText =
-                            $"INSERT INTO {_WastefulVirtualsTypeTableName} " +
-                            $"(BinaryID, TypeName, IsCOMType, WastePerSlot, WastedSize) " +
-                            $"VALUES " +
-                            $"(@BinaryID, @TypeName, @IsCOMType, @WastePerSlot, @WastedSize)";
-
-            command.Parameters.AddWithValue("@BinaryID", binaryID);
-            command.Parameters.AddWithValue("@TypeName", wvi.UserDefinedType.Name);
-            command.Parameters.AddWithValue("@IsCOMType", wvi.IsCOMType ? 0 : 1);
-            command.Parameters.AddWithValue("@WastePerSlot", wvi.WastePerSlot);
-            command.Parameters.AddWithValue("@WastedSize", wvi.WastedSize);
-            command.ExecuteNonQuery();
-
-            command.CommandText = "select last_insert_rowid()";
-            wastefulVirtualTypeID = Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture);
-        }
-
-        using (var command = connection.CreateCommand())
-        {
-            command.Transaction = transaction;
-            command.CommandText =
-                            $"INSERT INTO {_WastefulVirtualsFunctionTableName} " +
-                            $"(WastefulVirtualTypeID, FunctionName, WastedSize) " +
-                            $"VALUES " +
-                            $"(@WastefulVirtualTypeID, @FunctionName, @WastedSize)";
-
-            command.Parameters.AddWithValue("@WastefulVirtualTypeID", wastefulVirtualTypeID);
-            command.Parameters.AddWithValue("@FunctionName", String.Empty);
-            command.Parameters.AddWithValue("@WastedSize", wvi.WastePerSlot);
-
-            foreach (var func in wvi.WastedOverridesNonPureWithNoOverrides.Concat(wvi.WastedOverridesPureWithExactlyOneOverride))
-            {
-                command.Parameters["@FunctionName"].Value = func.FormattedName.IncludeParentType;
-                command.ExecuteNonQuery();
-            }
-        }
-    }
-
-    private static void InsertAnnotation(SqliteConnection connection, SqliteTransaction transaction, int binaryID, Dictionary<SourceFile, int> sourceFileToIDMapping,
-                                         int sourceFileNullID, AnnotationSymbol annotation)
-    {
-        var sourceFileID = annotation.SourceFile is null ? sourceFileNullID : sourceFileToIDMapping[annotation.SourceFile];
-
-        using var command = connection.CreateCommand();
-        command.Transaction = transaction;
-        command.CommandText =
-                        $"INSERT INTO {_AnnotationsTableName} " +
-                        $"(BinaryID, SourceFileID, LineNumber, IsInlinedOrAnnotatingInlineSite, AnnotationText) " +
-                        $"VALUES " +
-                        $"(@BinaryID, @SourceFileID, @LineNumber, @IsInlinedOrAnnotatingInlineSite, @AnnotationText)";
-
-        command.Parameters.AddWithValue("@BinaryID", binaryID);
-        command.Parameters.AddWithValue("@SourceFileID", sourceFileID);
-        command.Parameters.AddWithValue("@LineNumber", annotation.LineNumber);
-        command.Parameters.AddWithValue("@IsInlinedOrAnnotatingInlineSite", annotation.IsInlinedOrAnnotatingInlineSite);
-        command.Parameters.AddWithValue("@AnnotationText", annotation.Text);
-        command.ExecuteNonQuery();
-    }
-
-    private static void InsertSymbolsInSourceFileAndCompiland(SqliteConnection connection, SqliteTransaction transaction, int binaryCompilandID, int sourceFileID,
-                                                              Dictionary<uint, Dictionary<string, int>> symbolsToIDMapping, List<SKUCrawlerSymbol> symbols)
-    {
-        foreach (var symbol in symbols)
-        {
-            var symbolID = InsertSymbol(connection, transaction, symbolsToIDMapping, symbol);
-
-            using var command = connection.CreateCommand();
-            command.Transaction = transaction;
-            command.CommandText =
-                            $"INSERT INTO {_SymbolLocationsTableName} " +
-                            $"(BinaryCompilandID, SourceFileID, SymbolID) " +
-                            $"VALUES " +
-                            $"(@BinaryCompilandID, @SourceFileID, @SymbolID)";
-
-            command.Parameters.AddWithValue("@BinaryCompilandID", binaryCompilandID);
-            command.Parameters.AddWithValue("@SourceFileID", sourceFileID);
-            command.Parameters.AddWithValue("@SymbolID", symbolID);
-            command.ExecuteNonQuery();
-        }
-    }
-
-    private static void InsertError(SqliteConnection connection, SqliteTransaction transaction, int binaryID, Exception error)
-    {
-        using var command = connection.CreateCommand();
-        command.Transaction = transaction;
-        command.CommandText =
-                            $"INSERT INTO {_ErrorsTableName} " +
-                            $"(BinaryID, ExceptionType, ExceptionMessage, ExceptionDetails) " +
-                            $"VALUES " +
-                            $"(@BinaryID, @ExceptionType, @ExceptionMessage, @ExceptionDetails)";
-
-        command.Parameters.AddWithValue("@BinaryID", binaryID);
-        command.Parameters.AddWithValue("@ExceptionType", error.GetType().Name);
-        command.Parameters.AddWithValue("@ExceptionMessage", error.Message);
-        command.Parameters.AddWithValue("@ExceptionDetails", error.GetFormattedTextForLogging(String.Empty, Environment.NewLine));
-        command.ExecuteNonQuery();
-    }
-
-    private void EnsureDatabaseCreated(ILogger logger)
-    {
-        logger.Log($"Creating new DB file {this.DbFilename}");
-        try
-        {
-            using var connection = new SqliteConnection(new SqliteConnectionStringBuilder()
-            {
-                DataSource = this.DbFilename
-            }.ToString());
-            connection.Open();
-
-            var createTableQuery = $"CREATE TABLE {_BinariesTable} (" +
-                                       "BinaryID INTEGER PRIMARY KEY, " +
-                                       "Name TEXT, " +
-                                       "Size INT " +
-                                       ")";
-
-            SqliteCommand command;
-            using (command = new SqliteCommand(createTableQuery, connection))
-            {
-                command.ExecuteNonQuery();
-            }
-
-            createTableQuery = $"CREATE TABLE {_PerfStatsTable} (" +
-                                "BinaryID INT NOT NULL, " +
-                                "OpeningTookMs INT NOT NULL, " +
-                                "SectionsTookMs INT NOT NULL, " +
-                                "LibsTookMs INT NOT NULL, " +
-                                "SourceFilesTookMs INT NOT NULL, " +
-                                "DDITookMs INT NOT NULL, " +
-                                "WVITookMs INT NOT NULL, " +
-                                "AnnotationsTookMs INT NOT NULL, " +
-                                "SymbolsInCompilandsTookMs INT NOT NULL, " +
-                                "CONSTRAINT fk_binaries " +
-                                "  FOREIGN KEY (BinaryID) " +
-                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
-                                ")";
-
-            using (command = new SqliteCommand(createTableQuery, connection))
-            {
-                command.ExecuteNonQuery();
-            }
-
-            createTableQuery = $"CREATE TABLE {_SectionTableName} (" +
-                                "BinarySectionID INTEGER PRIMARY KEY, " +
-                                "BinaryID INT NOT NULL, " +
-                                "SectionName TEXT, " +
-                                "Size INT," +
-                                "VirtualSize INT, " +
-                                "CONSTRAINT fk_binaries " +
-                                "  FOREIGN KEY (BinaryID) " +
-                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
-                                ")";
-            using (command = new SqliteCommand(createTableQuery, connection))
-            {
-                command.ExecuteNonQuery();
-            }
-
-            createTableQuery = $"CREATE TABLE {_COFFGroupTableName} (" +
-                                "BinaryCOFFGroupID INTEGER PRIMARY KEY, " +
-                                "BinaryID INT NOT NULL, " +
-                                "BinarySectionID INT NOT NULL, " +
-                                "COFFGroupName TEXT, " +
-                                "Size INT," +
-                                "VirtualSize INT, " +
-                                "CONSTRAINT fk_binaries " +
-                                "  FOREIGN KEY (BinaryID) " +
-                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
-                                "CONSTRAINT fk_binarySections " +
-                                "  FOREIGN KEY (BinarySectionID) " +
-                               $"  REFERENCES {_SectionTableName}(BinarySectionID) " +
-                                ")";
-
-            using (command = new SqliteCommand(createTableQuery, connection))
-            {
-                command.ExecuteNonQuery();
-            }
-
-            createTableQuery = $"CREATE TABLE {_LibsTableName} (" +
-                                "BinaryLibID INTEGER PRIMARY KEY, " +
-                                "BinaryID INT NOT NULL, " +
-                                "LibName TEXT, " +
-                                "Size INT," +
-                                "CONSTRAINT fk_binaries " +
-                                "  FOREIGN KEY (BinaryID) " +
-                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
-                                ")";
-
-            using (command = new SqliteCommand(createTableQuery, connection))
-            {
-                command.ExecuteNonQuery();
-            }
-
-            createTableQuery = $"CREATE TABLE {_CompilandsTableName} (" +
-                                "BinaryCompilandID INTEGER PRIMARY KEY, " +
-                                "BinaryID INT NOT NULL, " +
-                                "BinaryLibID INT NOT NULL, " +
-                                "CompilandName TEXT, " +
-                                "Size INT," +
-                                "CommandLine TEXT, " +
-                                "RTTIEnabled INT, " +
-                                "Language TEXT, " +
-                                "FrontEndVersion TEXT, " +
-                                "BackEndVersion TEXT, " +
-                                "CONSTRAINT fk_binaries " +
-                                "  FOREIGN KEY (BinaryID) " +
-                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
-                                "CONSTRAINT fk_binaryLibs " +
-                                "  FOREIGN KEY (BinaryLibID) " +
-                               $"  REFERENCES {_LibsTableName}(BinaryLibID) " +
-                                ")";
-
-            using (command = new SqliteCommand(createTableQuery, connection))
-            {
-                command.ExecuteNonQuery();
-            }
-
-            //TODO: SKUCrawler: consider recording section/COFFGroup contributions of each lib/compiland too
-
-            createTableQuery = $"CREATE TABLE {_SymbolsTableName} (" +
-                                    "SymbolID INTEGER PRIMARY KEY, " +
-                                    "SymbolName TEXT NOT NULL, " +
-                                    "SymbolDetemplatedName TEXT, " +
-                                    "Size INT NOT NULL " +
-                                    ")";
-
-            using (command = new SqliteCommand(createTableQuery, connection))
-            {
-                command.ExecuteNonQuery();
-            }
-
-            if (this.IncludeDuplicateDataItems)
-            {
-                createTableQuery = $"CREATE TABLE {_DuplicateDataTableName} (" +
-                                    "DuplicateDataID INTEGER PRIMARY KEY, " +
-                                    "BinaryID INT NOT NULL, " +
-                                    "SymbolID INT NOT NULL, " +
-                                    "WastedSize INT," +
-                                    "CONSTRAINT fk_binaries " +
-                                    "  FOREIGN KEY (BinaryID) " +
-                                   $"  REFERENCES {_BinariesTable}(BinaryID) " +
-                                    "CONSTRAINT fk_symbols " +
-                                    "  FOREIGN KEY (SymbolID) " +
-                                   $"  REFERENCES {_SymbolsTableName}(SymbolID) " +
-                                    ")";
-
-                using (command = new SqliteCommand(createTableQuery, connection))
-                {
-                    command.ExecuteNonQuery();
-                }
-            }
-
-            if (this.IncludeWastefulVirtuals)
-            {
-                createTableQuery = $"CREATE TABLE {_WastefulVirtualsTypeTableName} (" +
-                                    "WastefulVirtualTypeID INTEGER PRIMARY KEY, " +
-                                    "BinaryID INT NOT NULL, " +
-                                    "TypeName TEXT, " +
-                                    "IsCOMType INT, " +
-                                    "WastePerSlot INT," +
-                                    "WastedSize INT," +
-                                    "CONSTRAINT fk_binaries " +
-                                    "  FOREIGN KEY (BinaryID) " +
-                                   $"  REFERENCES {_BinariesTable}(BinaryID) " +
-                                    ")";
-
-                using (command = new SqliteCommand(createTableQuery, connection))
-                {
-                    command.ExecuteNonQuery();
-                }
-
-                createTableQuery = $"CREATE TABLE {_WastefulVirtualsFunctionTableName} (" +
-                                    "WastefulVirtualFunctionID INTEGER PRIMARY KEY, " +
-                                    "WastefulVirtualTypeID INT NOT NULL, " +
-                                    "FunctionName TEXT, " +
-                                    "WastedSize INT, " +
-                                    "CONSTRAINT fk_wastefulVirtualTypes " +
-                                    "  FOREIGN KEY (WastefulVirtualTypeID) " +
-                                   $"  REFERENCES {_WastefulVirtualsTypeTableName}(WastefulVirtualTypeID) " +
-                                    ")";
-
-                using (command = new SqliteCommand(createTableQuery, connection))
-                {
-                    command.ExecuteNonQuery();
-                }
-            }
-
-            createTableQuery = $"CREATE TABLE {_SourceFilesTableName} (" +
-                                "SourceFileID INTEGER PRIMARY KEY, " +
-                                "BinaryID INT NOT NULL, " +
-                                "SourceFileName TEXT, " +
-                                "Size INT, " +
-                                "CONSTRAINT fk_binaries " +
-                                "  FOREIGN KEY (BinaryID) " +
-                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
-                                ")";
-
-            using (command = new SqliteCommand(createTableQuery, connection))
-            {
-                command.ExecuteNonQuery();
-            }
-
-            createTableQuery = $"CREATE TABLE {_AnnotationsTableName} (" +
-                                "AnnotationID INTEGER PRIMARY KEY, " +
-                                "BinaryID INT NOT NULL, " +
-                                "SourceFileID INT NOT NULL, " +
-                                "LineNumber INT NOT NULL, " +
-                                "IsInlinedOrAnnotatingInlineSite INT NOT NULL, " +
-                                "AnnotationText TEXT, " +
-                                "CONSTRAINT fk_binaries " +
-                                "  FOREIGN KEY (BinaryID) " +
-                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
-                                "CONSTRAINT fk_sourceFiles " +
-                                "  FOREIGN KEY (SourceFileID) " +
-                               $"  REFERENCES {_SourceFilesTableName}(SourceFileID) " +
-                                ")";
-
-            using (command = new SqliteCommand(createTableQuery, connection))
-            {
-                command.ExecuteNonQuery();
-            }
-
-            if (this.IncludeCodeSymbols)
-            {
-                createTableQuery = $"CREATE TABLE {_SymbolLocationsTableName} (" +
-                                    "SymbolLocationID INTEGER PRIMARY KEY, " +
-                                    "BinaryCompilandID INT NOT NULL, " +
-                                    "SourceFileID INT NOT NULL, " +
-                                    "SymbolID INT NOT NULL, " +
-                                    "CONSTRAINT fk_binaryCompilands " +
-                                    "  FOREIGN KEY (BinaryCompilandID) " +
-                                   $"  REFERENCES {_CompilandsTableName}(BinaryCompilandID) " +
-                                    "CONSTRAINT fk_sourceFiles " +
-                                    "  FOREIGN KEY (SourceFileID) " +
-                                   $"  REFERENCES {_SourceFilesTableName}(SourceFileID) " +
-                                    "CONSTRAINT fk_symbols " +
-                                    "  FOREIGN KEY (SymbolID) " +
-                                   $"  REFERENCES {_SymbolsTableName}(SymbolID) " +
-                                    ")";
-
-                using (command = new SqliteCommand(createTableQuery, connection))
-                {
-                    command.ExecuteNonQuery();
-                }
-            }
-
-            createTableQuery = $"CREATE TABLE {_ErrorsTableName} (" +
-                                "ErrorID INTEGER PRIMARY KEY, " +
-                                "BinaryID INT NOT NULL, " +
-                                "ExceptionType TEXT, " +
-                                "ExceptionMessage TEXT, " +
-                                "ExceptionDetails TEXT, " +
-                                "CONSTRAINT fk_binaries " +
-                                "  FOREIGN KEY (BinaryID) " +
-                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
-                                ")";
-
-            using (command = new SqliteCommand(createTableQuery, connection))
-            {
-                command.ExecuteNonQuery();
-            }
-        }
-        catch (Exception ex)
-        {
-            logger.LogException("Failed to setup the DB!", ex);
-            throw;
-        }
+            CrawlOutputFormat.SQLite => new SqliteCrawlResultSink(outputFilenameBase, this.BinaryRoot, this.IncludeWastefulVirtuals, this.IncludeCodeSymbols, this.IncludeDuplicateDataItems),
+            CrawlOutputFormat.Columnar => new ColumnarCrawlResultSink(outputFilenameBase, this.BinaryRoot, this.IncludeWastefulVirtuals, this.IncludeCodeSymbols, this.IncludeDuplicateDataItems),
+            _ => throw new InvalidOperationException($"Unknown output format {this.OutputFormat}.  This is a bug in SizeBench's implementation, not your usage of it."),
+        };
     }
 }
@@ -0,0 +1,345 @@
+﻿using SizeBench.AnalysisEngine;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+
+namespace SizeBench.SKUCrawler;
+
+// Writes the same tables and columns as SqliteCrawlResultSink, but to a ColumnarFileWriter instead of one INSERT per row.  IDs that SQLite
+// would hand out as rowids are counted up here instead, starting from 1 just like SQLite does, so the foreign keys line up the same way.
+//
+// Rows are buffered in memory per table, and each table is written out as a row group once it has built up enough rows that the
+// per-column dictionaries and deltas have something to work with.
+internal sealed class ColumnarCrawlResultSink : ICrawlResultSink
+{
+    internal const int RowsPerRowGroup = 64 * 1024;
+    internal const string SymbolsTableName = "Symbols";
+
+    private readonly string _logFilenameBase;
+    private ColumnarFileWriter? _writer;
+
+    private readonly ColumnarTable _binaries = new ColumnarTable("Binaries",
+        new Int64Column("BinaryID"), new StringColumn("Name"), new Int64Column("Size"));
+    private readonly ColumnarTable _perfStats = new ColumnarTable("PerfStats",
+        new Int64Column("BinaryID"), new Int64Column("OpeningTookMs"), new Int64Column("SectionsTookMs"), new Int64Column("LibsTookMs"),
+        new Int64Column("SourceFilesTookMs"), new Int64Column("DDITookMs"), new Int64Column("WVITookMs"), new Int64Column("AnnotationsTookMs"),
+        new Int64Column("SymbolsInCompilandsTookMs"));
+    private readonly ColumnarTable _sections = new ColumnarTable("Sections",
+        new Int64Column("BinarySectionID"), new Int64Column("BinaryID"), new StringColumn("SectionName"), new Int64Column("Size"), new Int64Column("VirtualSize"));
+    private readonly ColumnarTable _coffGroups = new ColumnarTable("COFFGroups",
+        new Int64Column("BinaryCOFFGroupID"), new Int64Column("BinaryID"), new Int64Column("BinarySectionID"), new StringColumn("COFFGroupName"),
+        new Int64Column("Size"), new Int64Column("VirtualSize"));
+    private readonly ColumnarTable _libs = new ColumnarTable("Libs",
+        new Int64Column("BinaryLibID"), new Int64Column("BinaryID"), new StringColumn("LibName"), new Int64Column("Size"));
+    private readonly ColumnarTable _compilands = new ColumnarTable("Compilands",
+        new Int64Column("BinaryCompilandID"), new Int64Column("BinaryID"), new Int64Column("BinaryLibID"), new StringColumn("CompilandName"),
+        new Int64Column("Size"), new StringColumn("CommandLine"), new Int64Column("RTTIEnabled"), new StringColumn("Language"),
+        new StringColumn("FrontEndVersion"), new StringColumn("BackEndVersion"));
+    private readonly ColumnarTable _symbols = new ColumnarTable(SymbolsTableName,
+        new Int64Column("SymbolID"), new StringColumn("SymbolName"), new StringColumn("SymbolDetemplatedName"), new Int64Column("Size"));
+    private readonly ColumnarTable _duplicateData = new ColumnarTable("DuplicateData",
+        new Int64Column("DuplicateDataID"), new Int64Column("BinaryID"), new Int64Column("SymbolID"), new Int64Column("WastedSize"));
+    private readonly ColumnarTable _wastefulVirtualTypes = new ColumnarTable("WastefulVirtualTypes",
+        new Int64Column("WastefulVirtualTypeID"), new Int64Column("BinaryID"), new StringColumn("TypeName"), new Int64Column("IsCOMType"),
+        new Int64Column("WastePerSlot"), new Int64Column("WastedSize"));
+    private readonly ColumnarTable _wastefulVirtualFunctions = new ColumnarTable("WastefulVirtualFunctions",
+        new Int64Column("WastefulVirtualFunctionID"), new Int64Column("WastefulVirtualTypeID"), new StringColumn("FunctionName"), new Int64Column("WastedSize"));
+    private readonly ColumnarTable _sourceFiles = new ColumnarTable("SourceFiles",
+        new Int64Column("SourceFileID"), new Int64Column("BinaryID"), new StringColumn("SourceFileName"), new Int64Column("Size"));
+    private readonly ColumnarTable _annotations = new ColumnarTable("Annotations",
+        new Int64Column("AnnotationID"), new Int64Column("BinaryID"), new Int64Column("SourceFileID"), new Int64Column("LineNumber"),
+        new Int64Column("IsInlinedOrAnnotatingInlineSite"), new StringColumn("AnnotationText"));
+    private readonly ColumnarTable _symbolLocations = new ColumnarTable("SymbolLocations",
+        new Int64Column("SymbolLocationID"), new Int64Column("BinaryCompilandID"), new Int64Column("SourceFileID"), new Int64Column("SymbolID"));
+    private readonly ColumnarTable _crawlManifest = new ColumnarTable(CrawlManifest.TableName,
+        new Int64Column("BinaryID"), new StringColumn("PdbGuid"), new Int64Column("PdbAge"), new StringColumn("BinarySHA256"), new Int64Column("CrawlOptions"));
+    private readonly ColumnarTable _errors = new ColumnarTable("Errors",
+        new Int64Column("ErrorID"), new Int64Column("BinaryID"), new StringColumn("ExceptionType"), new StringColumn("ExceptionMessage"),
+        new StringColumn("ExceptionDetails"));
+
+    private readonly ColumnarTable[] _allTables;
+
+    private long _nextBinaryID = 1;
+    private long _nextSectionID = 1;
+    private long _nextCOFFGroupID = 1;
+    private long _nextLibID = 1;
+    private long _nextCompilandID = 1;
+    private long _nextSymbolID = 1;
+    private long _nextDuplicateDataID = 1;
+    private long _nextWastefulVirtualTypeID = 1;
+    private long _nextWastefulVirtualFunctionID = 1;
+    private long _nextSourceFileID = 1;
+    private long _nextAnnotationID = 1;
+    private long _nextSymbolLocationID = 1;
+    private long _nextErrorID = 1;
+
+    public string BinaryRoot { get; }
+    public bool IncludeWastefulVirtuals { get; }
+    public bool IncludeCodeSymbols { get; }
+    public bool IncludeDuplicateDataItems { get; }
+
+    public string OutputPath => $"{this._logFilenameBase}.sbcol";
+
+    // Every table this writes, whether or not it has any rows yet.
+    internal IReadOnlyList<ColumnarTable> Tables => this._allTables;
+
+    public ColumnarCrawlResultSink(string logFilenameBase, string binaryRoot, bool includeWastefulVirtuals, bool includeCodeSymbols, bool includeDuplicateDataItems)
+    {
+        this._logFilenameBase = logFilenameBase;
+        this.BinaryRoot = binaryRoot;
+        this.IncludeWastefulVirtuals = includeWastefulVirtuals;
+        this.IncludeCodeSymbols = includeCodeSymbols;
+        this.IncludeDuplicateDataItems = includeDuplicateDataItems;
+
+        this._allTables = [this._binaries, this._perfStats, this._sections, this._coffGroups, this._libs, this._compilands, this._symbols,
+                           this._duplicateData, this._wastefulVirtualTypes, this._wastefulVirtualFunctions, this._sourceFiles,
+                           this._annotations, this._symbolLocations, this._crawlManifest, this._errors];
+    }
+
+    public void Open(ILogger logger)
+    {
+        logger.Log($"Creating new columnar file {this.OutputPath}");
+        this._writer = new ColumnarFileWriter(this.OutputPath);
+    }
+
+    public void Write(IReadOnlyList<ProductBinaryAnalysisResults> results, ILogger logger)
+    {
+        if (this._writer is null)
+        {
+            throw new InvalidOperationException("The columnar file must be opened before writing to it.  This is a bug in SizeBench's implementation, not your usage of it.");
+        }
+
+        foreach (var result in results)
+        {
+            try
+            {
+                AddBinary(result);
+            }
+#pragma warning disable CA1031 // Do not catch general exception types - if we throw trying to write one binary, maybe we can still write most of them, let's keep going
+            catch (Exception ex)
+#pragma warning restore CA1031 // Do not catch general exception types
+            {
+                Program.LogExceptionAndReportToStdErr("Columnar file write threw an exception!", ex, logger);
+            }
+        }
+
+        foreach (var table in this._allTables)
+        {
+            if (table.RowCount >= RowsPerRowGroup)
+            {
+                this._writer.WriteRowGroup(table);
+            }
+        }
+    }
+
+    public void Complete(ILogger logger)
+    {
+        if (this._writer is null)
+        {
+            return;
+        }
+
+        foreach (var table in this._allTables)
+        {
+            this._writer.WriteRowGroup(table);
+        }
+
+        this._writer.Complete();
+    }
+
+    private void AddBinary(ProductBinaryAnalysisResults results)
+    {
+        var compilandIDs = new Dictionary<Compiland, long>();
+        var sourceFileIDs = new Dictionary<SourceFile, long>();
+        var symbolIDs = new Dictionary<uint, Dictionary<string, long>>();
+
+        var binaryID = this._nextBinaryID++;
+        this._binaries.AddRow().Add(binaryID).Add(results.GetBinaryName(this.BinaryRoot)).Add(results.fullBinarySize);
+
+        this._perfStats.AddRow().Add(binaryID)
+                                .Add(results.openingTookMs)
+                                .Add(results.sectionEnumerationTookMs)
+                                .Add(results.libEnumerationTookMs)
+                                .Add(results.sourceFileEnumerationTookMs)
+                                .Add(results.ddiEnumerationTookMs)
+                                .Add(results.wviEnumerationTookMs)
+                                .Add(results.annotationEnumerationTookMs)
+                                .Add(results.codeSymbolsInSourceFilesEnumerationTookMs);
+
+        if (results.sections != null)
+        {
+            foreach (var section in results.sections)
+            {
+                var sectionID = this._nextSectionID++;
+                this._sections.AddRow().Add(sectionID).Add(binaryID).Add(section.Name).Add(section.Size).Add(section.VirtualSize);
+
+                foreach (var cg in section.COFFGroups)
+                {
+                    this._coffGroups.AddRow().Add(this._nextCOFFGroupID++).Add(binaryID).Add(sectionID).Add(cg.Name).Add(cg.Size).Add(cg.VirtualSize);
+                }
+            }
+        }
+
+        if (results.libs != null)
+        {
+            foreach (var lib in results.libs)
+            {
+                var libID = this._nextLibID++;
+                this._libs.AddRow().Add(libID).Add(binaryID).Add(lib.Name).Add((long)lib.Size);
+
+                foreach (var compiland in lib.Compilands.Values)
+                {
+                    var compilandID = this._nextCompilandID++;
+                    this._compilands.AddRow().Add(compilandID)
+                                             .Add(binaryID)
+                                             .Add(libID)
+                                             .Add(compiland.Name)
+                                             .Add((long)compiland.Size)
+                                             .Add(compiland.CommandLine)
+                                             .Add(compiland.RTTIEnabled ? 1 : 0)
+                                             .Add(BatchProcess.ToolLanguageFriendlyNames[compiland.ToolLanguage])
+                                             .Add(compiland.ToolFrontEndVersion.ToString())
+                                             .Add(compiland.ToolBackEndVersion.ToString());
+                    compilandIDs.Add(compiland, compilandID);
+                }
+            }
+        }
+
+        // Like the SQLite database, there's a row for the 'null' source file so annotations without a source file still have a SourceFileID.
+        var sourceFileNullID = -1L;
+
+        if (results.sourceFiles != null)
+        {
+            sourceFileNullID = this._nextSourceFileID++;
+            this._sourceFiles.AddRow().Add(sourceFileNullID).Add(binaryID).Add("unknown source file").Add(0);
+
+            foreach (var sf in results.sourceFiles)
+            {
+                var sourceFileID = this._nextSourceFileID++;
+                this._sourceFiles.AddRow().Add(sourceFileID).Add(binaryID).Add(sf.Name).Add(sf.Size);
+                sourceFileIDs.Add(sf, sourceFileID);
+            }
+        }
+
+        if (this.IncludeDuplicateDataItems && results.duplicateDataItems != null)
+        {
+            foreach (var ddi in results.duplicateDataItems)
+            {
+                var symbolID = AddSymbol(symbolIDs, new SKUCrawlerSymbol(ddi.Symbol));
+                this._duplicateData.AddRow().Add(this._nextDuplicateDataID++).Add(binaryID).Add(symbolID).Add(ddi.WastedSize);
+            }
+        }
+
+        if (this.IncludeWastefulVirtuals && results.wastefulVirtualItems != null)
+        {
+            foreach (var wvi in results.wastefulVirtualItems)
+            {
+                var wastefulVirtualTypeID = this._nextWastefulVirtualTypeID++;
+                this._wastefulVirtualTypes.AddRow().Add(wastefulVirtualTypeID)
+                                                   .Add(binaryID)
+                                                   .Add(wvi.UserDefinedType.Name)
+                                                   .Add(wvi.IsCOMType ? 0 : 1) // Matches what the SQLite database has always recorded
+                                                   .Add(wvi.WastePerSlot)
+                                                   .Add(wvi.WastedSize);
+
+                foreach (var func in wvi.WastedOverridesNonPureWithNoOverrides.Concat(wvi.WastedOverridesPureWithExactlyOneOverride))
+                {
+                    this._wastefulVirtualFunctions.AddRow().Add(this._nextWastefulVirtualFunctionID++)
+                                                           .Add(wastefulVirtualTypeID)
+                                                           .Add(func.FormattedName.IncludeParentType)
+                                                           .Add(wvi.WastePerSlot);
+                }
+            }
+        }
+
+        if (results.annotations != null)
+        {
+            foreach (var annotation in results.annotations)
+            {
+                var sourceFileID = annotation.SourceFile is null ? sourceFileNullID : sourceFileIDs[annotation.SourceFile];
+                this._annotations.AddRow().Add(this._nextAnnotationID++)
+                                          .Add(binaryID)
+                                          .Add(sourceFileID)
+                                          .Add(annotation.LineNumber)
+                                          .Add(annotation.IsInlinedOrAnnotatingInlineSite ? 1 : 0)
+                                          .Add(annotation.Text);
+            }
+        }
+
+        if (this.IncludeCodeSymbols && results.codeSymbolsInAllSourceFiles != null)
+        {
+            foreach (var symbolsInCompilandAndSourceFile in results.codeSymbolsInAllSourceFiles)
+            {
+                var compilandID = compilandIDs[symbolsInCompilandAndSourceFile.Key.compiland];
+                var sourceFileID = sourceFileIDs[symbolsInCompilandAndSourceFile.Key.sourceFile];
+                foreach (var symbol in symbolsInCompilandAndSourceFile.Value)
+                {
+                    var symbolID = AddSymbol(symbolIDs, symbol);
+                    this._symbolLocations.AddRow().Add(this._nextSymbolLocationID++).Add(compilandID).Add(sourceFileID).Add(symbolID);
+                }
+            }
+        }
+
+        if (results.manifestEntry != null)
+        {
+            this._crawlManifest.AddRow().Add(binaryID)
+                                        .Add(results.manifestEntry.PdbGuid.ToString())
+                                        .Add(results.manifestEntry.PdbAge)
+                                        .Add(results.manifestEntry.BinarySHA256)
+                                        .Add((long)CrawlManifest.GetOptions(this.IncludeWastefulVirtuals, this.IncludeCodeSymbols, this.IncludeDuplicateDataItems));
+        }
+
+        if (results.errorDuringProcessing != null)
+        {
+            var error = results.errorDuringProcessing;
+            this._errors.AddRow().Add(this._nextErrorID++)
+                                 .Add(binaryID)
+                                 .Add(error.GetType().Name)
+                                 .Add(error.Message)
+                                 .Add(error.GetFormattedTextForLogging(String.Empty, Environment.NewLine));
+        }
+    }
+
+    // Symbols are shared by every row in this binary with the same name and size, the same way SqliteCrawlResultSink shares them.
+    private long AddSymbol(Dictionary<uint, Dictionary<string, long>> symbolIDs, SKUCrawlerSymbol skuSymbol)
+    {
+        if (!symbolIDs.TryGetValue(skuSymbol.Size, out var symbolsOfCorrectSize))
+        {
+            symbolsOfCorrectSize = new Dictionary<string, long>(StringComparer.Ordinal);
+            symbolIDs.Add(skuSymbol.Size, symbolsOfCorrectSize);
+        }
+
+        if (!symbolsOfCorrectSize.TryGetValue(skuSymbol.Name, out var symbolID))
+        {
+            symbolID = this._nextSymbolID++;
+            this._symbols.AddRow().Add(symbolID).Add(skuSymbol.Name).Add(skuSymbol.DetemplatedName).Add(skuSymbol.Size);
+            symbolsOfCorrectSize.Add(skuSymbol.Name, symbolID);
+        }
+
+        return symbolID;
+    }
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    private void Dispose(bool disposing)
+    {
+        if (!this._isDisposed)
+        {
+            if (disposing)
+            {
+                this._writer?.Dispose();
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    public void Dispose()
+    {
+        Dispose(true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
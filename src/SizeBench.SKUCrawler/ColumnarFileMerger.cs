@@ -0,0 +1,157 @@
+﻿using System.IO;
+
+namespace SizeBench.SKUCrawler;
+
+// Merges the .sbcol files from every worker checkpoint into one, the same way Program.MergeDatabases merges the SQLite batches into
+// merged.db: the IDs from each file are offset past the largest ID of the same kind in the files merged before it, and symbols are
+// de-duplicated across files by name and size.  An ID column is named for the ID it holds, whichever table it's in (the BinaryID in
+// Sections is the same kind of ID as the one in Binaries), so the offsets go by column name rather than needing to know every table's
+// foreign keys.
+//
+// Row groups are copied across one at a time, so the only thing that grows with the size of the crawl is the map of every symbol seen
+// so far - the same thing merged.db needs an index for.
+//
+// A file that wasn't completely written is from a worker that was killed part way through a checkpoint, and everything in it was sent
+// to another worker to analyze again - so it's skipped, rather than merged in twice.
+internal static class ColumnarFileMerger
+{
+    private const string SymbolIDColumnName = "SymbolID";
+
+    // Returns how many of the files were merged in.
+    public static int Merge(IEnumerable<string> filesToMerge, string mergedFileName, TextWriter log)
+    {
+        var largestIDs = new Dictionary<string, long>(StringComparer.Ordinal);
+        var mergedSymbolIDs = new Dictionary<(long Size, string? Name), long>();
+        var mergedSymbols = new ColumnarTable(ColumnarCrawlResultSink.SymbolsTableName,
+            new Int64Column(SymbolIDColumnName), new StringColumn("SymbolName"), new StringColumn("SymbolDetemplatedName"), new Int64Column("Size"));
+        var filesMerged = 0;
+
+        // Written under another name until it's done, so a merge that fails part way doesn't leave behind something that looks finished.
+        var inProgressFileName = mergedFileName + ".inprogress";
+        try
+        {
+            using (var writer = new ColumnarFileWriter(inProgressFileName))
+            {
+                foreach (var fileName in filesToMerge)
+                {
+                    // Reading the symbols first also reads to the end of the file, so an incomplete file is found before any of it is merged.
+                    var symbols = TryReadSymbols(fileName, log);
+                    if (symbols is null)
+                    {
+                        continue;
+                    }
+
+                    log.WriteLine($"Merging in {Path.GetFileName(fileName)}");
+
+                    var symbolIDMapping = new Dictionary<long, long>(symbols.Count);
+                    foreach (var (symbolID, name, detemplatedName, size) in symbols)
+                    {
+                        if (!mergedSymbolIDs.TryGetValue((size, name), out var mergedSymbolID))
+                        {
+                            mergedSymbolID = mergedSymbolIDs.Count + 1;
+                            mergedSymbolIDs.Add((size, name), mergedSymbolID);
+                            mergedSymbols.AddRow().Add(mergedSymbolID).Add(name).Add(detemplatedName).Add(size);
+                            if (mergedSymbols.RowCount >= ColumnarCrawlResultSink.RowsPerRowGroup)
+                            {
+                                writer.WriteRowGroup(mergedSymbols);
+                            }
+                        }
+
+                        symbolIDMapping[symbolID] = mergedSymbolID;
+                    }
+
+                    largestIDs = MergeInRowGroups(fileName, writer, largestIDs, symbolIDMapping);
+                    filesMerged++;
+                }
+
+                writer.WriteRowGroup(mergedSymbols);
+                writer.Complete();
+            }
+
+            File.Move(inProgressFileName, mergedFileName, overwrite: true);
+        }
+        finally
+        {
+            File.Delete(inProgressFileName);
+        }
+
+        return filesMerged;
+    }
+
+    private static List<(long SymbolID, string? Name, string? DetemplatedName, long Size)>? TryReadSymbols(string fileName, TextWriter log)
+    {
+        var symbols = new List<(long SymbolID, string? Name, string? DetemplatedName, long Size)>();
+
+        try
+        {
+            using var reader = new ColumnarFileReader(fileName);
+            while (reader.ReadRowGroup(tableName => tableName == ColumnarCrawlResultSink.SymbolsTableName) is ColumnarTable rowGroup)
+            {
+                var symbolIDs = rowGroup.GetColumn<Int64Column>(SymbolIDColumnName);
+                var names = rowGroup.GetColumn<StringColumn>("SymbolName");
+                var detemplatedNames = rowGroup.GetColumn<StringColumn>("SymbolDetemplatedName");
+                var sizes = rowGroup.GetColumn<Int64Column>("Size");
+                for (var row = 0; row < rowGroup.RowCount; row++)
+                {
+                    symbols.Add((symbolIDs[row], names[row], detemplatedNames[row], sizes[row]));
+                }
+            }
+        }
+        catch (InvalidDataException ex)
+        {
+            log.WriteLine($"Skipping {Path.GetFileName(fileName)}, it can't be merged: {ex.Message}");
+            return null;
+        }
+
+        return symbols;
+    }
+
+    // Copies every row group except the symbols into the merged file, and returns the largest IDs of each kind once this file is merged in.
+    private static Dictionary<string, long> MergeInRowGroups(string fileName, ColumnarFileWriter writer, Dictionary<string, long> offsets,
+                                                             Dictionary<long, long> symbolIDMapping)
+    {
+        // Every ID in the file is offset by the largest ID before it, not by whatever earlier row groups in this same file got up to.
+        var largestIDs = new Dictionary<string, long>(offsets, StringComparer.Ordinal);
+
+        using var reader = new ColumnarFileReader(fileName);
+        while (reader.ReadRowGroup(tableName => tableName != ColumnarCrawlResultSink.SymbolsTableName) is ColumnarTable rowGroup)
+        {
+            foreach (var column in rowGroup.Columns)
+            {
+                if (column is not Int64Column ids || !column.Name.EndsWith("ID", StringComparison.Ordinal))
+                {
+                    continue;
+                }
+
+                if (column.Name == SymbolIDColumnName)
+                {
+                    for (var row = 0; row < rowGroup.RowCount; row++)
+                    {
+                        if (!symbolIDMapping.TryGetValue(ids[row], out var mergedSymbolID))
+                        {
+                            throw new InvalidDataException($"A row of {rowGroup.Name} in {fileName} refers to SymbolID {ids[row]}, which is not in its Symbols table.");
+                        }
+
+                        ids[row] = mergedSymbolID;
+                    }
+
+                    continue;
+                }
+
+                var offset = offsets.GetValueOrDefault(column.Name);
+                var largestID = largestIDs.GetValueOrDefault(column.Name);
+                for (var row = 0; row < rowGroup.RowCount; row++)
+                {
+                    ids[row] += offset;
+                    largestID = Math.Max(largestID, ids[row]);
+                }
+
+                largestIDs[column.Name] = largestID;
+            }
+
+            writer.WriteRowGroup(rowGroup);
+        }
+
+        return largestIDs;
+    }
+}
@@ -0,0 +1,184 @@
+﻿using System.IO;
+using System.IO.Compression;
+using System.Text;
+
+namespace SizeBench.SKUCrawler;
+
+// Reads back what a ColumnarFileWriter wrote - see there for the layout.  Each row group comes back as its own ColumnarTable, holding
+// just that row group's rows, in the order they're in the file.  Anything that isn't a complete file in the layout the writer uses,
+// including a file the writer never got to call Complete on, throws an InvalidDataException.
+internal sealed class ColumnarFileReader : IDisposable
+{
+    private readonly string _path;
+    private readonly FileStream _fileStream;
+    private readonly BinaryReader _reader;
+    private bool _reachedEndOfFile;
+
+    // Reused by every column so decompressing a row group doesn't allocate a new buffer each time.
+    private byte[] _compressedPayload = [];
+
+    public ColumnarFileReader(string path)
+    {
+        this._path = path;
+        this._fileStream = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.Read);
+        this._reader = new BinaryReader(this._fileStream, Encoding.UTF8);
+
+        try
+        {
+            if (this._fileStream.Length < sizeof(uint) + sizeof(int) || this._reader.ReadUInt32() != ColumnarFileWriter.FileMagic)
+            {
+                throw new InvalidDataException($"{path} is not a columnar file written by SizeBench.SKUCrawler.");
+            }
+
+            var formatVersion = this._reader.ReadInt32();
+            if (formatVersion != ColumnarFileWriter.FormatVersion)
+            {
+                throw new InvalidDataException($"{path} is in version {formatVersion} of the columnar format, but only version {ColumnarFileWriter.FormatVersion} can be read.");
+            }
+        }
+        catch
+        {
+            Dispose();
+            throw;
+        }
+    }
+
+    /// <summary>
+    /// Reads the next row group in the file, skipping over any for tables that <paramref name="includeTable"/> doesn't want without
+    /// decompressing them.
+    /// </summary>
+    /// <returns>The row group's rows, or null once the end of the file has been reached.</returns>
+    public ColumnarTable? ReadRowGroup(Predicate<string>? includeTable = null)
+    {
+        ObjectDisposedException.ThrowIf(this._isDisposed, this);
+
+        try
+        {
+            while (!this._reachedEndOfFile)
+            {
+                var rowGroup = ReadOneRowGroup(includeTable);
+                if (rowGroup != null)
+                {
+                    return rowGroup;
+                }
+            }
+
+            return null;
+        }
+        catch (EndOfStreamException ex)
+        {
+            throw new InvalidDataException($"{this._path} ends part way through a row group - it was not completely written.", ex);
+        }
+        catch (FormatException ex)
+        {
+            throw new InvalidDataException($"{this._path} has a malformed count or length in it.", ex);
+        }
+    }
+
+    // Returns null if this was the end of the file, or a row group that was skipped.
+    private ColumnarTable? ReadOneRowGroup(Predicate<string>? includeTable)
+    {
+        var marker = this._reader.ReadByte();
+        if (marker == ColumnarFileWriter.EndOfFileMarker)
+        {
+            if (this._fileStream.Position != this._fileStream.Length)
+            {
+                throw new InvalidDataException($"{this._path} has data after its end marker.");
+            }
+
+            this._reachedEndOfFile = true;
+            return null;
+        }
+        else if (marker != ColumnarFileWriter.RowGroupMarker)
+        {
+            throw new InvalidDataException($"{this._path} has an unknown marker {marker} at offset {this._fileStream.Position - 1}, where a row group should start.");
+        }
+
+        var tableName = this._reader.ReadString();
+        var rowCount = this._reader.Read7BitEncodedInt();
+        var columnCount = this._reader.Read7BitEncodedInt();
+        if (rowCount < 0 || columnCount <= 0)
+        {
+            throw new InvalidDataException($"A row group of {tableName} in {this._path} claims to have {rowCount} rows in {columnCount} columns.");
+        }
+
+        var include = includeTable?.Invoke(tableName) ?? true;
+        var columns = include ? new ColumnarColumn[columnCount] : null;
+        for (var i = 0; i < columnCount; i++)
+        {
+            var columnName = this._reader.ReadString();
+            var kind = (ColumnarColumnKind)this._reader.ReadByte();
+            var payloadLength = this._reader.Read7BitEncodedInt64();
+            if (payloadLength < 0 || payloadLength > this._fileStream.Length - this._fileStream.Position)
+            {
+                throw new EndOfStreamException();
+            }
+
+            if (columns is null)
+            {
+                this._fileStream.Seek(payloadLength, SeekOrigin.Current);
+                continue;
+            }
+
+            columns[i] = ColumnarColumn.Create(columnName, kind);
+            ReadPayload(columns[i], (int)payloadLength, rowCount);
+        }
+
+        if (columns is null)
+        {
+            return null;
+        }
+
+        var table = new ColumnarTable(tableName, columns);
+        table.RowsWereReadIntoColumns(rowCount);
+        return table;
+    }
+
+    private void ReadPayload(ColumnarColumn column, int payloadLength, int rowCount)
+    {
+        if (this._compressedPayload.Length < payloadLength)
+        {
+            this._compressedPayload = new byte[payloadLength];
+        }
+
+        this._reader.BaseStream.ReadExactly(this._compressedPayload, 0, payloadLength);
+
+        using var compressed = new MemoryStream(this._compressedPayload, 0, payloadLength, writable: false);
+        using var decompressor = new BrotliStream(compressed, CompressionMode.Decompress);
+        using var payloadReader = new BinaryReader(decompressor, Encoding.UTF8);
+        try
+        {
+            column.ReadValues(payloadReader, rowCount);
+        }
+        catch (EndOfStreamException ex)
+        {
+            throw new InvalidDataException($"Column {column.Name} in {this._path} has fewer than the {rowCount} values its row group should have.", ex);
+        }
+    }
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    private void Dispose(bool disposing)
+    {
+        if (!this._isDisposed)
+        {
+            if (disposing)
+            {
+                this._reader.Dispose();
+                this._fileStream.Dispose();
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    public void Dispose()
+    {
+        Dispose(true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
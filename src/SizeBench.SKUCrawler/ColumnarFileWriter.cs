@@ -0,0 +1,115 @@
+﻿using System.IO;
+using System.IO.Compression;
+using System.Text;
+
+namespace SizeBench.SKUCrawler;
+
+// Writes ColumnarTables to a compressed, column-oriented file.  The layout is:
+//
+//     "SBCF" magic, int32 format version
+//     any number of row groups, each of which is:
+//         byte 1, table name, row count, column count
+//         for each column: column name, ColumnarColumnKind byte, payload length, payload
+//     byte 0
+//
+// Names are length-prefixed UTF8 strings (as BinaryWriter.Write(string) writes them), counts and lengths are 7-bit encoded, and each
+// payload is a column's values for that row group as ColumnarColumn.WriteValues writes them, compressed with Brotli.  A table may have
+// any number of row groups, and they can be interleaved with other tables' row groups - a reader appends each row group's rows to the
+// table with that name.  Tables with no rows don't appear in the file at all.
+internal sealed class ColumnarFileWriter : IDisposable
+{
+    internal const uint FileMagic = 0x46434253; // "SBCF", for "SizeBench Columnar File"
+    internal const int FormatVersion = 1;
+    internal const byte RowGroupMarker = 1;
+    internal const byte EndOfFileMarker = 0;
+
+    private readonly FileStream _fileStream;
+    private readonly BinaryWriter _writer;
+
+    // Reused by every column so compressing a row group doesn't allocate a new buffer each time.
+    private readonly MemoryStream _compressedPayload = new MemoryStream();
+
+    public ColumnarFileWriter(string path)
+    {
+        this._fileStream = new FileStream(path, FileMode.Create, FileAccess.Write, FileShare.Read);
+        this._writer = new BinaryWriter(this._fileStream, Encoding.UTF8);
+        this._writer.Write(FileMagic);
+        this._writer.Write(FormatVersion);
+    }
+
+    /// <summary>
+    /// Writes every row buffered in <paramref name="table"/> as one row group, then clears the table to start buffering the next one.
+    /// </summary>
+    public void WriteRowGroup(ColumnarTable table)
+    {
+        ObjectDisposedException.ThrowIf(this._isDisposed, this);
+
+        if (table.RowCount == 0)
+        {
+            return;
+        }
+
+        // Every column must have exactly RowCount values.
+        table.DiscardIncompleteRow();
+
+        this._writer.Write(RowGroupMarker);
+        this._writer.Write(table.Name);
+        this._writer.Write7BitEncodedInt(table.RowCount);
+        this._writer.Write7BitEncodedInt(table.Columns.Count);
+
+        foreach (var column in table.Columns)
+        {
+            this._compressedPayload.SetLength(0);
+            using (var compressor = new BrotliStream(this._compressedPayload, CompressionLevel.Fastest, leaveOpen: true))
+            using (var payloadWriter = new BinaryWriter(compressor, Encoding.UTF8, leaveOpen: true))
+            {
+                column.WriteValues(payloadWriter);
+            }
+
+            this._writer.Write(column.Name);
+            this._writer.Write((byte)column.Kind);
+            this._writer.Write7BitEncodedInt64(this._compressedPayload.Length);
+            this._writer.Write(this._compressedPayload.GetBuffer(), 0, (int)this._compressedPayload.Length);
+        }
+
+        table.Clear();
+    }
+
+    /// <summary>
+    /// Marks the end of the file.  A file without this was not completely written, and should not be trusted.
+    /// </summary>
+    public void Complete()
+    {
+        ObjectDisposedException.ThrowIf(this._isDisposed, this);
+
+        this._writer.Write(EndOfFileMarker);
+        this._writer.Flush();
+    }
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    private void Dispose(bool disposing)
+    {
+        if (!this._isDisposed)
+        {
+            if (disposing)
+            {
+                this._writer.Dispose();
+                this._fileStream.Dispose();
+                this._compressedPayload.Dispose();
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    public void Dispose()
+    {
+        Dispose(true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
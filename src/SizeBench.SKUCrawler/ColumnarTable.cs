@@ -0,0 +1,312 @@
+﻿using System.IO;
+
+namespace SizeBench.SKUCrawler;
+
+internal enum ColumnarColumnKind : byte
+{
+    Int64 = 1,
+    String = 2,
+}
+
+// A table's rows are buffered column by column, and written out by a ColumnarFileWriter as a row group whenever the sink decides
+// enough of them have built up.  Rows are added with AddRow, filling in every column in order:
+//
+//     table.AddRow().Add(binaryID).Add(name).Add(size);
+//
+// A row only counts once its last column has been filled in - if something throws part of the way through a row, the columns that
+// were filled in are thrown away by the next AddRow, so the columns can never end up with different numbers of values.
+internal sealed class ColumnarTable
+{
+    private readonly ColumnarColumn[] _columns;
+
+    public string Name { get; }
+    public IReadOnlyList<ColumnarColumn> Columns => this._columns;
+    public int RowCount { get; private set; }
+
+    public ColumnarTable(string name, params ColumnarColumn[] columns)
+    {
+        ArgumentOutOfRangeException.ThrowIfZero(columns.Length);
+
+        this.Name = name;
+        this._columns = columns;
+    }
+
+    public RowBuilder AddRow()
+    {
+        DiscardIncompleteRow();
+        return new RowBuilder(this, 0);
+    }
+
+    internal void DiscardIncompleteRow()
+    {
+        foreach (var column in this._columns)
+        {
+            column.Truncate(this.RowCount);
+        }
+    }
+
+    internal void Clear()
+    {
+        foreach (var column in this._columns)
+        {
+            column.Clear();
+        }
+
+        this.RowCount = 0;
+    }
+
+    // For a ColumnarFileReader, once it has read a whole row group's values straight into the columns.
+    internal void RowsWereReadIntoColumns(int rowCount)
+    {
+        foreach (var column in this._columns)
+        {
+            if (column.Count != rowCount)
+            {
+                throw new InvalidDataException($"Column {column.Name} of {this.Name} has {column.Count} values, but the row group has {rowCount} rows.");
+            }
+        }
+
+        this.RowCount = rowCount;
+    }
+
+    internal TColumn GetColumn<TColumn>(string name) where TColumn : ColumnarColumn
+    {
+        foreach (var column in this._columns)
+        {
+            if (column.Name == name && column is TColumn typedColumn)
+            {
+                return typedColumn;
+            }
+        }
+
+        throw new InvalidDataException($"The {this.Name} table has no {typeof(TColumn).Name} named {name}.");
+    }
+
+    internal readonly struct RowBuilder
+    {
+        private readonly ColumnarTable _table;
+        private readonly int _columnIndex;
+
+        public RowBuilder(ColumnarTable table, int columnIndex)
+        {
+            this._table = table;
+            this._columnIndex = columnIndex;
+        }
+
+        public RowBuilder Add(long value)
+        {
+            if (NextColumn() is not Int64Column column)
+            {
+                throw new InvalidOperationException($"Column {this._columnIndex} of {this._table.Name} does not hold integers.  This is a bug in SizeBench's implementation, not your usage of it.");
+            }
+
+            column.Add(value);
+            return Advance();
+        }
+
+        public RowBuilder Add(string? value)
+        {
+            if (NextColumn() is not StringColumn column)
+            {
+                throw new InvalidOperationException($"Column {this._columnIndex} of {this._table.Name} does not hold strings.  This is a bug in SizeBench's implementation, not your usage of it.");
+            }
+
+            column.Add(value);
+            return Advance();
+        }
+
+        private ColumnarColumn NextColumn()
+        {
+            if (this._table is null || this._columnIndex >= this._table._columns.Length)
+            {
+                throw new InvalidOperationException($"Too many values were added to a row of {this._table?.Name}.  This is a bug in SizeBench's implementation, not your usage of it.");
+            }
+
+            return this._table._columns[this._columnIndex];
+        }
+
+        private RowBuilder Advance()
+        {
+            if (this._columnIndex + 1 == this._table._columns.Length)
+            {
+                this._table.RowCount++;
+            }
+
+            return new RowBuilder(this._table, this._columnIndex + 1);
+        }
+    }
+}
+
+internal abstract class ColumnarColumn
+{
+    public string Name { get; }
+    public abstract ColumnarColumnKind Kind { get; }
+
+    protected ColumnarColumn(string name)
+    {
+        this.Name = name;
+    }
+
+    internal static ColumnarColumn Create(string name, ColumnarColumnKind kind)
+    {
+        return kind switch
+        {
+            ColumnarColumnKind.Int64 => new Int64Column(name),
+            ColumnarColumnKind.String => new StringColumn(name),
+            _ => throw new InvalidDataException($"Column {name} is of unknown kind {(byte)kind}."),
+        };
+    }
+
+    internal abstract int Count { get; }
+
+    // Writes this column's values for the current row group, uncompressed - the ColumnarFileWriter takes care of compressing them.
+    internal abstract void WriteValues(BinaryWriter writer);
+
+    // The reverse of WriteValues - appends rowCount values, read from what WriteValues wrote, already decompressed.
+    internal abstract void ReadValues(BinaryReader reader, int rowCount);
+
+    internal abstract void Truncate(int rowCount);
+
+    internal abstract void Clear();
+}
+
+// Integers are written as the difference from the previous row, zigzag-encoded so small negative differences stay small, then as a
+// 7-bit encoded varint.  Most integer columns are IDs that go up by one per row, or a foreign key that repeats for many rows in a row,
+// so most values end up being a single byte before compression even gets a look at them.
+internal sealed class Int64Column : ColumnarColumn
+{
+    private readonly List<long> _values = new List<long>();
+
+    public Int64Column(string name) : base(name) { }
+
+    public override ColumnarColumnKind Kind => ColumnarColumnKind.Int64;
+
+    internal long this[int row]
+    {
+        get => this._values[row];
+        set => this._values[row] = value;
+    }
+
+    internal override int Count => this._values.Count;
+
+    internal void Add(long value) => this._values.Add(value);
+
+    internal override void WriteValues(BinaryWriter writer)
+    {
+        var previous = 0L;
+        foreach (var value in this._values)
+        {
+            var delta = unchecked(value - previous);
+            writer.Write7BitEncodedInt64((delta << 1) ^ (delta >> 63));
+            previous = value;
+        }
+    }
+
+    internal override void ReadValues(BinaryReader reader, int rowCount)
+    {
+        var previous = 0L;
+        for (var i = 0; i < rowCount; i++)
+        {
+            var zigzag = reader.Read7BitEncodedInt64();
+            var delta = (long)((ulong)zigzag >> 1) ^ -(zigzag & 1);
+            previous = unchecked(previous + delta);
+            this._values.Add(previous);
+        }
+    }
+
+    internal override void Truncate(int rowCount)
+    {
+        if (this._values.Count > rowCount)
+        {
+            this._values.RemoveRange(rowCount, this._values.Count - rowCount);
+        }
+    }
+
+    internal override void Clear() => this._values.Clear();
+}
+
+// Strings are dictionary-encoded: each row group has a list of the distinct strings in that column, and each row is just an index into
+// that list, where 0 means null.  Names of libs, compilands, source files and symbols repeat a lot within a batch, so this is where most
+// of the savings over one INSERT per row come from.
+internal sealed class StringColumn : ColumnarColumn
+{
+    private readonly Dictionary<string, int> _dictionaryIndices = new Dictionary<string, int>(StringComparer.Ordinal);
+    private readonly List<string> _dictionary = new List<string>();
+    private readonly List<int> _indices = new List<int>();
+
+    public StringColumn(string name) : base(name) { }
+
+    public override ColumnarColumnKind Kind => ColumnarColumnKind.String;
+
+    internal string? this[int row] => this._indices[row] == 0 ? null : this._dictionary[this._indices[row] - 1];
+
+    internal override int Count => this._indices.Count;
+
+    internal void Add(string? value)
+    {
+        if (value is null)
+        {
+            this._indices.Add(0);
+            return;
+        }
+
+        if (!this._dictionaryIndices.TryGetValue(value, out var index))
+        {
+            this._dictionary.Add(value);
+            index = this._dictionary.Count;
+            this._dictionaryIndices.Add(value, index);
+        }
+
+        this._indices.Add(index);
+    }
+
+    internal override void WriteValues(BinaryWriter writer)
+    {
+        writer.Write7BitEncodedInt(this._dictionary.Count);
+        foreach (var value in this._dictionary)
+        {
+            writer.Write(value);
+        }
+
+        foreach (var index in this._indices)
+        {
+            writer.Write7BitEncodedInt(index);
+        }
+    }
+
+    internal override void ReadValues(BinaryReader reader, int rowCount)
+    {
+        var dictionary = new string[reader.Read7BitEncodedInt()];
+        for (var i = 0; i < dictionary.Length; i++)
+        {
+            dictionary[i] = reader.ReadString();
+        }
+
+        for (var i = 0; i < rowCount; i++)
+        {
+            var index = reader.Read7BitEncodedInt();
+            if (index < 0 || index > dictionary.Length)
+            {
+                throw new InvalidDataException($"Row {i} of column {this.Name} refers to string {index}, but there are only {dictionary.Length}.");
+            }
+
+            Add(index == 0 ? null : dictionary[index - 1]);
+        }
+    }
+
+    internal override void Truncate(int rowCount)
+    {
+        // Anything these rows added to the dictionary is left there - it's harmless to have an unused entry.
+        if (this._indices.Count > rowCount)
+        {
+            this._indices.RemoveRange(rowCount, this._indices.Count - rowCount);
+        }
+    }
+
+    internal override void Clear()
+    {
+        this._dictionaryIndices.Clear();
+        this._dictionary.Clear();
+        this._indices.Clear();
+    }
+}
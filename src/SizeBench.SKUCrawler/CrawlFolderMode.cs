@@ -22,11 +22,19 @@ internal sealed class CrawlFolderArguments : ApplicationArguments
     public bool IncludeWastefulVirtuals { get; set; }
     public bool IncludeCodeSymbols { get; set; }
     public bool IncludeDuplicateDataItems { get; set; }
+    public CrawlOutputFormat OutputFormat { get; set; } = CrawlOutputFormat.SQLite;
+    public string? PreviousCrawlDatabase { get; set; }
 
+    // A worker checkpoints its output (finishing off one output file and starting the next) after this many binaries, or after
+    // CheckpointInterval, whichever comes first - so if a worker has to be killed, at most this much work has to be done again.
     public int BatchSize { get; } = 25; // Make this customizable later if we need to
+    public TimeSpan CheckpointInterval { get; } = TimeSpan.FromMinutes(5);
 
-    public string TimestampOfMaster { get; set; }
+    public int WorkerCount { get; set; } = Environment.ProcessorCount;
+    public TimeSpan BinaryTimeLimit { get; set; } = TimeSpan.FromHours(1);
+    public long BinaryMemoryLimitInBytes { get; set; } // 0 means no limit
 
+    public string TimestampOfMaster { get; set; }
 
     public CrawlFolderArguments()
     {
@@ -73,20 +81,78 @@ internal sealed class CrawlFolderArguments : ApplicationArguments
             {
                 this.IncludeDuplicateDataItems = true;
             }
+            else if (args[i].Equals("/outputFormat", StringComparison.OrdinalIgnoreCase) && i + 1 < args.Length)
+            {
+                if (!Enum.TryParse<CrawlOutputFormat>(args[i + 1], ignoreCase: true, out var outputFormat) || !Enum.IsDefined(outputFormat))
+                {
+                    Program.PrintArgumentErrorThenHelpAndExit($"/outputFormat must be one of: {String.Join(", ", Enum.GetNames<CrawlOutputFormat>())}");
+                }
+
+                this.OutputFormat = outputFormat;
+                i++; // Skip the outputFormat value
+            }
+            else if (args[i].Equals("/previousCrawl", StringComparison.OrdinalIgnoreCase) && i + 1 < args.Length)
+            {
+                this.PreviousCrawlDatabase = args[i + 1];
+                i++; // Skip the previousCrawl value
+            }
+            else if (args[i].Equals("/workers", StringComparison.OrdinalIgnoreCase) && i + 1 < args.Length)
+            {
+                this.WorkerCount = ParsePositiveInteger("/workers", args[i + 1]);
+                i++; // Skip the workers value
+            }
+            else if (args[i].Equals("/binaryTimeLimitMinutes", StringComparison.OrdinalIgnoreCase) && i + 1 < args.Length)
+            {
+                this.BinaryTimeLimit = TimeSpan.FromMinutes(ParsePositiveInteger("/binaryTimeLimitMinutes", args[i + 1]));
+                i++; // Skip the binaryTimeLimitMinutes value
+            }
+            else if (args[i].Equals("/binaryMemoryLimitMB", StringComparison.OrdinalIgnoreCase) && i + 1 < args.Length)
+            {
+                this.BinaryMemoryLimitInBytes = ParsePositiveInteger("/binaryMemoryLimitMB", args[i + 1]) * 1024L * 1024L;
+                i++; // Skip the binaryMemoryLimitMB value
+            }
+        }
+
+        if (this.PreviousCrawlDatabase != null)
+        {
+            if (!File.Exists(this.PreviousCrawlDatabase))
+            {
+                Program.PrintArgumentErrorThenHelpAndExit($"/previousCrawl database {this.PreviousCrawlDatabase} does not exist");
+            }
+            else if (this.OutputFormat != CrawlOutputFormat.SQLite)
+            {
+                Program.PrintArgumentErrorThenHelpAndExit("/previousCrawl can only be used with /outputFormat sqlite, since results are carried forward into merged.db");
+            }
         }
 
         return !String.IsNullOrEmpty(this.CrawlRoot);
     }
 
+    private static int ParsePositiveInteger(string argumentName, string value)
+    {
+        if (!Int32.TryParse(value, NumberStyles.None, CultureInfo.InvariantCulture, out var result) || result <= 0)
+        {
+            Program.PrintArgumentErrorThenHelpAndExit($"{argumentName} must be a positive whole number");
+        }
+
+        return result;
+    }
+
+    // Each worker's output is split into one file per checkpoint, named -batch{worker}-{checkpoint}, so these still sort after the
+    // carried-forward batch0.db.
     public override IEnumerable<FileInfo> GetDatabaseFilesToMerge()
         => new DirectoryInfo(this.OutputFolder).EnumerateFileSystemInfos($"SizeBench.SKUCrawler-{this.TimestampOfMaster}-batch*.db").OrderBy(fsi => fsi.Name).Cast<FileInfo>();
 
+    public IEnumerable<FileInfo> GetColumnarFilesToMerge()
+        => new DirectoryInfo(this.OutputFolder).EnumerateFileSystemInfos($"SizeBench.SKUCrawler-{this.TimestampOfMaster}-batch*.sbcol").OrderBy(fsi => fsi.Name).Cast<FileInfo>();
+
     public string CommandLineArgsForBatch(int batchNumber)
     {
         return $"/batch /batchNumber {batchNumber} /timestampOfMaster \"{this.TimestampOfMaster}\" /outputFolder \"{this.OutputFolder}\"" +
                $" {(this.IncludeWastefulVirtuals ? "/includeWastefulVirtuals" : "")}" +
                $" {(this.IncludeCodeSymbols ? "/includeCodeSymbols" : "")}" +
                $" {(this.IncludeDuplicateDataItems ? "/includeDuplicateData" : "")}" +
+               $" /outputFormat {this.OutputFormat}" +
                $" /folderRoot \"{this.CrawlRoot}\"";
     }
 }
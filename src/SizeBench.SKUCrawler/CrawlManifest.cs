@@ -0,0 +1,162 @@
+﻿using System.Globalization;
+using System.IO;
+using System.Security.Cryptography;
+using Microsoft.Data.Sqlite;
+using SizeBench.AnalysisEngine.PE;
+using SizeBench.Logging;
+using SizeBench.SKUCrawler.CrawlFolder;
+
+namespace SizeBench.SKUCrawler;
+
+// Which of the optional parts of the analysis a binary's results include - results are only carried forward into a crawl that asks for the
+// same ones, since otherwise the carried-forward binaries would be missing data (or have extra data) compared to the ones crawled again.
+[Flags]
+internal enum CrawlManifestOptions
+{
+    None = 0x0,
+    WastefulVirtuals = 0x1,
+    CodeSymbols = 0x2,
+    DuplicateData = 0x4,
+}
+
+// Identifies exactly which build of a binary some results were computed from.  The PDB's GUID and age change every time the binary is linked,
+// and the hash of the binary catches one that was patched or re-signed without being linked again.
+internal sealed record class CrawlManifestEntry(Guid PdbGuid, uint PdbAge, string BinarySHA256)
+{
+    public static CrawlManifestEntry Compute(string binaryPath)
+    {
+        var signature = PEFileDebugSignature.ReadFromBinary(binaryPath);
+
+        using var stream = new FileStream(binaryPath, FileMode.Open, FileAccess.Read, FileShare.Read);
+        return new CrawlManifestEntry(signature.PdbGuid, signature.Age, Convert.ToHexString(SHA256.HashData(stream)));
+    }
+}
+
+// Every crawl database records a CrawlManifestEntry for each binary it analyzed successfully, so that the next crawl of the same folder can
+// tell which binaries are unchanged and copy their results forward instead of opening a Session for them again.
+internal static class CrawlManifest
+{
+    public const string TableName = "CrawlManifest";
+
+    public static CrawlManifestOptions GetOptions(bool includeWastefulVirtuals, bool includeCodeSymbols, bool includeDuplicateDataItems)
+    {
+        var options = CrawlManifestOptions.None;
+
+        if (includeWastefulVirtuals)
+        {
+            options |= CrawlManifestOptions.WastefulVirtuals;
+        }
+        if (includeCodeSymbols)
+        {
+            options |= CrawlManifestOptions.CodeSymbols;
+        }
+        if (includeDuplicateDataItems)
+        {
+            options |= CrawlManifestOptions.DuplicateData;
+        }
+
+        return options;
+    }
+
+    /// <summary>
+    /// Compares each binary against the manifest in the previous crawl's database.
+    /// </summary>
+    /// <returns>The binaries that are new or have changed since the previous crawl, in the same order they were passed in.</returns>
+    /// <param name="unchangedBinaryIDs">The BinaryIDs, in the previous crawl's database, of every binary that is unchanged and can be carried forward.</param>
+    public static List<ProductBinary> FindChangedBinaries(CrawlFolderArguments crawlArgs, List<ProductBinary> productBinaries, ILogger logger, out List<long> unchangedBinaryIDs)
+    {
+        var previousManifest = LoadPreviousManifest(crawlArgs.PreviousCrawlDatabase!,
+                                                    GetOptions(crawlArgs.IncludeWastefulVirtuals, crawlArgs.IncludeCodeSymbols, crawlArgs.IncludeDuplicateDataItems),
+                                                    logger);
+
+        // Hashing every binary means reading every byte of them, which is still far cheaper than analyzing them - but it's all I/O, so it's
+        // worth doing in parallel.
+        var previousBinaryIDs = new long?[productBinaries.Count];
+        if (previousManifest.Count > 0)
+        {
+            Parallel.For(0, productBinaries.Count, new ParallelOptions() { MaxDegreeOfParallelism = Environment.ProcessorCount }, i =>
+            {
+                var binaryPath = productBinaries[i].BinaryPath;
+                if (!previousManifest.TryGetValue(ProductBinaryAnalysisResults.GetBinaryName(binaryPath, crawlArgs.CrawlRoot ?? String.Empty), out var previous))
+                {
+                    return;
+                }
+
+                try
+                {
+                    if (CrawlManifestEntry.Compute(binaryPath) == previous.Entry)
+                    {
+                        previousBinaryIDs[i] = previous.BinaryID;
+                    }
+                }
+                catch (Exception ex) when (ex is IOException or UnauthorizedAccessException or BadImageFormatException)
+                {
+                    // Crawl it again - whatever's wrong with it will be recorded as an error by the batch that tries to analyze it.
+                }
+            });
+        }
+
+        var changedBinaries = new List<ProductBinary>(productBinaries.Count);
+        unchangedBinaryIDs = new List<long>(previousManifest.Count);
+        for (var i = 0; i < productBinaries.Count; i++)
+        {
+            if (previousBinaryIDs[i] is long previousBinaryID)
+            {
+                unchangedBinaryIDs.Add(previousBinaryID);
+            }
+            else
+            {
+                changedBinaries.Add(productBinaries[i]);
+            }
+        }
+
+        var output = $"{unchangedBinaryIDs.Count} of {productBinaries.Count} binaries are unchanged since the previous crawl, {changedBinaries.Count} will be analyzed";
+        Console.Out.WriteLine(output);
+        logger.Log(output);
+
+        return changedBinaries;
+    }
+
+    private static Dictionary<string, (long BinaryID, CrawlManifestEntry Entry)> LoadPreviousManifest(string previousCrawlDatabase, CrawlManifestOptions options, ILogger logger)
+    {
+        var previousManifest = new Dictionary<string, (long BinaryID, CrawlManifestEntry Entry)>(StringComparer.OrdinalIgnoreCase);
+
+        // Pooling is off so nothing is holding the file open later, in case the previous crawl's merged.db is about to be replaced by this one's.
+        using var connection = new SqliteConnection(new SqliteConnectionStringBuilder()
+        {
+            DataSource = previousCrawlDatabase,
+            Mode = SqliteOpenMode.ReadOnly,
+            Pooling = false
+        }.ToString());
+        connection.Open();
+
+        using var command = connection.CreateCommand();
+        command.CommandText = $"SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND tbl_name = '{TableName}'";
+        if (Convert.ToInt64(command.ExecuteScalar(), CultureInfo.InvariantCulture) == 0)
+        {
+            logger.Log($"{previousCrawlDatabase} has no {TableName} table, it must be from an older version of SKUCrawler - every binary will be analyzed.");
+            return previousManifest;
+        }
+
+        // Binaries that failed to analyze last time are left out, so they get another chance - the failure may have been something transient,
+        // and if not it'll just be recorded again.
+        command.CommandText = "SELECT binaries.Name, manifest.BinaryID, manifest.PdbGuid, manifest.PdbAge, manifest.BinarySHA256 " +
+                             $"FROM {TableName} AS manifest " +
+                              "INNER JOIN Binaries AS binaries ON binaries.BinaryID = manifest.BinaryID " +
+                              "WHERE manifest.CrawlOptions = @CrawlOptions " +
+                              "AND NOT EXISTS (SELECT 1 FROM Errors AS errors WHERE errors.BinaryID = manifest.BinaryID)";
+        command.Parameters.AddWithValue("@CrawlOptions", (int)options);
+
+        using var reader = command.ExecuteReader();
+        while (reader.Read())
+        {
+            var entry = new CrawlManifestEntry(Guid.Parse(reader.GetString(2)), (uint)reader.GetInt64(3), reader.GetString(4));
+
+            // If the same name somehow appears twice, the first one wins - carrying both forward would duplicate the binary.
+            previousManifest.TryAdd(reader.GetString(0), (reader.GetInt64(1), entry));
+        }
+
+        logger.Log($"Loaded {previousManifest.Count} entries from the {TableName} in {previousCrawlDatabase}");
+        return previousManifest;
+    }
+}
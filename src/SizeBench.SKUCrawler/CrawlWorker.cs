@@ -0,0 +1,237 @@
+﻿using System.Diagnostics;
+using System.IO;
+using System.Text;
+
+namespace SizeBench.SKUCrawler;
+
+// The master's handle on one worker process - it hands the worker one work item at a time, and holds it to the per-binary time and
+// memory limits while it works.  See CrawlWorkerProtocol for what goes back and forth.
+internal sealed class CrawlWorker : IDisposable
+{
+    private static readonly TimeSpan LimitPollingInterval = TimeSpan.FromSeconds(1);
+
+    private readonly Process _process;
+    private readonly Lock _stateLock = new Lock();
+    private readonly List<CrawlWorkItem> _itemsSinceLastCheckpoint = new List<CrawlWorkItem>();
+    private readonly Action<CrawlWorker, string> _onOutputLine;
+    private readonly Action<CrawlWorker, string> _onErrorLine;
+    private CrawlWorkItem? _currentItem;
+    private TaskCompletionSource? _currentItemFinished;
+
+    public int WorkerNumber { get; }
+    public string CommandLine { get; }
+
+    public CrawlWorkItem? CurrentItem
+    {
+        get
+        {
+            lock (this._stateLock)
+            {
+                return this._currentItem;
+            }
+        }
+    }
+
+    // Doesn't start the process - that's what Start is for.
+    internal CrawlWorker(int workerNumber, string commandLine, Action<CrawlWorker, string> onOutputLine, Action<CrawlWorker, string> onErrorLine)
+    {
+        this.WorkerNumber = workerNumber;
+        this.CommandLine = commandLine;
+        this._onOutputLine = onOutputLine;
+        this._onErrorLine = onErrorLine;
+
+        var psi = new ProcessStartInfo("SizeBench.SKUCrawler.exe", commandLine)
+        {
+            CreateNoWindow = true,
+            WindowStyle = ProcessWindowStyle.Hidden,
+            UseShellExecute = false,
+            RedirectStandardInput = true,
+            RedirectStandardOutput = true,
+            RedirectStandardError = true,
+            // No BOM, or it would end up at the start of the first work item.
+            StandardInputEncoding = new UTF8Encoding(encoderShouldEmitUTF8Identifier: false),
+        };
+
+        this._process = new Process()
+        {
+            StartInfo = psi,
+            EnableRaisingEvents = true
+        };
+        this._process.OutputDataReceived += WorkerProcess_OutputDataReceived;
+        this._process.ErrorDataReceived += WorkerProcess_ErrorDataReceived;
+    }
+
+    public static CrawlWorker Start(int workerNumber, string commandLine, Action<CrawlWorker, string> onOutputLine, Action<CrawlWorker, string> onErrorLine)
+    {
+        var worker = new CrawlWorker(workerNumber, commandLine, onOutputLine, onErrorLine);
+        worker._process.Start();
+        worker._process.StandardInput.AutoFlush = true;
+        worker._process.BeginOutputReadLine();
+        worker._process.BeginErrorReadLine();
+        return worker;
+    }
+
+    // How much memory the worker is using right now - between work items, this is what it's holding onto from the binaries before.
+    public long PrivateMemoryInBytes
+    {
+        get
+        {
+            this._process.Refresh();
+            return this._process.PrivateMemorySize64;
+        }
+    }
+
+    // The memory limit is per binary, so it's held against how much the worker grows while analyzing this item - not everything it was
+    // already holding onto from earlier binaries, or the results it has buffered up for the next checkpoint.
+    public async Task<WorkItemOutcome> ProcessAsync(CrawlWorkItem item, TimeSpan timeLimit, long memoryLimitInBytes)
+    {
+        long memoryAtStartInBytes = 0;
+        if (memoryLimitInBytes > 0)
+        {
+            try
+            {
+                memoryAtStartInBytes = this.PrivateMemoryInBytes;
+            }
+            catch (InvalidOperationException)
+            {
+                // Already exited - that's reported below, like any other exit.
+            }
+        }
+
+        var finished = BeginItem(item);
+
+        var exited = this._process.WaitForExitAsync();
+        try
+        {
+            await this._process.StandardInput.WriteLineAsync(CrawlWorkerProtocol.FormatWorkItem(item)).ConfigureAwait(false);
+        }
+        catch (IOException)
+        {
+            // The pipe is broken because the worker has already exited - that's reported below, like any other exit.
+        }
+
+        var elapsed = Stopwatch.StartNew();
+        while (true)
+        {
+            var completedTask = await Task.WhenAny(finished.Task, exited, Task.Delay(LimitPollingInterval)).ConfigureAwait(false);
+
+            // Exiting also flushes out any last output, so the worker may well have finished this item just before it went away.
+            if (finished.Task.IsCompleted)
+            {
+                return WorkItemOutcome.Finished;
+            }
+            else if (completedTask == exited)
+            {
+                return WorkItemOutcome.WorkerExited;
+            }
+            else if (elapsed.Elapsed > timeLimit)
+            {
+                return WorkItemOutcome.ExceededTimeLimit;
+            }
+            else if (memoryLimitInBytes > 0 && this.PrivateMemoryInBytes - memoryAtStartInBytes > memoryLimitInBytes)
+            {
+                return WorkItemOutcome.ExceededMemoryLimit;
+            }
+        }
+    }
+
+    internal TaskCompletionSource BeginItem(CrawlWorkItem item)
+    {
+        var finished = new TaskCompletionSource(TaskCreationOptions.RunContinuationsAsynchronously);
+        lock (this._stateLock)
+        {
+            this._currentItem = item;
+            this._currentItemFinished = finished;
+        }
+
+        return finished;
+    }
+
+    // Everything this worker finished that isn't on disk yet - if the worker is being given up on, these need to be done again.
+    public List<CrawlWorkItem> TakeItemsSinceLastCheckpoint()
+    {
+        lock (this._stateLock)
+        {
+            var items = new List<CrawlWorkItem>(this._itemsSinceLastCheckpoint);
+            this._itemsSinceLastCheckpoint.Clear();
+            return items;
+        }
+    }
+
+    // Tells the worker there's nothing more to do, so it writes out its results and exits.  Returns false if it didn't exit cleanly.
+    public async Task<bool> FinishAsync()
+    {
+        try
+        {
+            this._process.StandardInput.Close();
+        }
+        catch (IOException)
+        {
+            // Already gone - the exit code says how that went.
+        }
+
+        await this._process.WaitForExitAsync().ConfigureAwait(false);
+        return this._process.ExitCode == 0;
+    }
+
+    public void Kill()
+    {
+        try
+        {
+            this._process.Kill(entireProcessTree: true);
+            this._process.WaitForExit();
+        }
+        catch (InvalidOperationException)
+        {
+            // It already exited on its own.
+        }
+    }
+
+    private void WorkerProcess_OutputDataReceived(object sender, DataReceivedEventArgs e)
+    {
+        if (!String.IsNullOrEmpty(e.Data))
+        {
+            HandleOutputLine(e.Data);
+        }
+    }
+
+    internal void HandleOutputLine(string line)
+    {
+        if (line == CrawlWorkerProtocol.BinaryFinishedMessage)
+        {
+            TaskCompletionSource? finished;
+            lock (this._stateLock)
+            {
+                if (this._currentItem != null)
+                {
+                    this._itemsSinceLastCheckpoint.Add(this._currentItem);
+                }
+                this._currentItem = null;
+                finished = this._currentItemFinished;
+                this._currentItemFinished = null;
+            }
+            finished?.TrySetResult();
+        }
+        else if (line == CrawlWorkerProtocol.CheckpointMessage)
+        {
+            lock (this._stateLock)
+            {
+                this._itemsSinceLastCheckpoint.Clear();
+            }
+        }
+        else
+        {
+            this._onOutputLine(this, line);
+        }
+    }
+
+    private void WorkerProcess_ErrorDataReceived(object sender, DataReceivedEventArgs e)
+    {
+        if (!String.IsNullOrEmpty(e.Data))
+        {
+            this._onErrorLine(this, e.Data);
+        }
+    }
+
+    public void Dispose() => this._process.Dispose();
+}
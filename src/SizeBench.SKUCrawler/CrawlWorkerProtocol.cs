@@ -0,0 +1,89 @@
+﻿using System.IO;
+using SizeBench.SKUCrawler.CrawlFolder;
+
+namespace SizeBench.SKUCrawler;
+
+internal enum WorkItemOutcome
+{
+    Finished,
+    ExceededTimeLimit,
+    ExceededMemoryLimit,
+    WorkerExited,
+}
+
+// One binary for a worker to analyze.  If AbandonedBecause is set, the binary was already tried and the worker trying it had to be killed
+// (or died), so the worker that gets this item just records that as the binary's error instead of trying again.
+internal sealed record class CrawlWorkItem(ProductBinary Binary, long SizeInBytes, WorkItemOutcome? AbandonedBecause = null, int TimesRequeued = 0)
+{
+    public static CrawlWorkItem Create(ProductBinary binary)
+    {
+        long size = 0;
+        try
+        {
+            size = new FileInfo(binary.BinaryPath).Length + new FileInfo(binary.PdbPath).Length;
+        }
+        catch (IOException)
+        {
+            // The worker will report the missing file, it doesn't matter where in the queue that happens.
+        }
+
+        return new CrawlWorkItem(binary, size);
+    }
+}
+
+// How the master and its workers talk to each other.  The master writes one work item per line to a worker's stdin, and only sends the
+// next once the worker says it has finished the last - so the master always knows which binary each worker is on.  An empty line (or
+// closing stdin) tells the worker to write out what it has and exit.
+//
+// The worker's stdout is mostly progress for the console, with these messages mixed in:
+//   BinaryFinished - the current work item has been analyzed and handed to the result sink.
+//   Checkpoint     - everything handed to the result sink so far is complete on disk, so if this worker has to be killed later, none of
+//                    it needs to be done again.
+internal static class CrawlWorkerProtocol
+{
+    public const string BinaryFinishedMessage = "##SKUCrawlerWorker:BinaryFinished";
+    public const string CheckpointMessage = "##SKUCrawlerWorker:Checkpoint";
+
+    private const string AnalyzeVerb = "analyze";
+    private const string AbandonedVerb = "abandoned";
+
+    // '|' can't appear in a Windows path, so it's safe as a separator - the same as the binary list uses.
+    public static string FormatWorkItem(CrawlWorkItem item)
+        => item.AbandonedBecause is WorkItemOutcome reason
+           ? $"{AbandonedVerb}|{reason}|{item.Binary.BinaryPath}|{item.Binary.PdbPath}"
+           : $"{AnalyzeVerb}|{item.Binary.BinaryPath}|{item.Binary.PdbPath}";
+
+    public static CrawlWorkItem ParseWorkItem(string line)
+    {
+        var parts = line.Split('|');
+
+        if (parts.Length == 3 && parts[0] == AnalyzeVerb)
+        {
+            return new CrawlWorkItem(new ProductBinary(binaryPath: parts[1], pdbPath: parts[2]), 0);
+        }
+        else if (parts.Length == 4 && parts[0] == AbandonedVerb && Enum.TryParse<WorkItemOutcome>(parts[1], out var reason))
+        {
+            return new CrawlWorkItem(new ProductBinary(binaryPath: parts[2], pdbPath: parts[3]), 0, reason);
+        }
+
+        throw new InvalidOperationException($"Worker received a malformed work item: '{line}'.  This is a bug in SizeBench's implementation, not your usage of it.");
+    }
+
+    public static string DescribeOutcome(WorkItemOutcome outcome, CrawlFolderArguments crawlArgs)
+        => outcome switch
+        {
+            WorkItemOutcome.ExceededTimeLimit => $"Analysis was abandoned after exceeding the per-binary time limit of {crawlArgs.BinaryTimeLimit}",
+            WorkItemOutcome.ExceededMemoryLimit => $"Analysis was abandoned after exceeding the per-binary memory limit of {crawlArgs.BinaryMemoryLimitInBytes / (1024 * 1024):N0} MB",
+            WorkItemOutcome.WorkerExited => "The worker process analyzing this binary exited unexpectedly",
+            _ => outcome.ToString(),
+        };
+
+    // The exception recorded as the binary's error, so abandoned binaries show up in the Errors table like any other failure.
+    public static Exception CreateExceptionForAbandonedBinary(WorkItemOutcome outcome)
+        => outcome switch
+        {
+            WorkItemOutcome.ExceededTimeLimit => new TimeoutException("Analysis was abandoned after exceeding the per-binary time limit (see /binaryTimeLimitMinutes)"),
+            WorkItemOutcome.ExceededMemoryLimit => new InsufficientMemoryException("Analysis was abandoned after exceeding the per-binary memory limit (see /binaryMemoryLimitMB)"),
+            _ => new InvalidOperationException("The worker process analyzing this binary exited unexpectedly"),
+        };
+}
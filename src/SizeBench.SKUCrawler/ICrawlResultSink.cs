@@ -0,0 +1,24 @@
+﻿using SizeBench.Logging;
+
+namespace SizeBench.SKUCrawler;
+
+internal enum CrawlOutputFormat
+{
+    SQLite,
+    Columnar
+}
+
+// Where a worker's results end up - the worker opens a new sink after each checkpoint.  Results are written into the sink from a single
+// thread, in groups of however many binaries finished analyzing since the last write, so a sink is free to buffer as much as it likes
+// between calls and doesn't need to be thread-safe.
+internal interface ICrawlResultSink : IDisposable
+{
+    string OutputPath { get; }
+
+    void Open(ILogger logger);
+
+    void Write(IReadOnlyList<ProductBinaryAnalysisResults> results, ILogger logger);
+
+    // Called once after the last Write, anything not yet on disk must be written out here.
+    void Complete(ILogger logger);
+}
@@ -1,107 +1,243 @@
 ﻿using System.Collections.Concurrent;
-using System.Diagnostics;
 using SizeBench.Logging;
 using SizeBench.SKUCrawler.CrawlFolder;
-using SizeBench.Threading.Tasks.Schedulers;
 
 namespace SizeBench.SKUCrawler;
 
-internal sealed class MasterControllerProcess : IDisposable
+// Runs the crawl as a pool of long-lived worker processes, each pulling binaries off one shared queue as it becomes free - so a few huge
+// binaries don't hold up a whole batch of small ones behind them, and there's no process startup cost per batch.  The queue hands out the
+// largest binaries first, so the long poles start as early as possible and the small ones fill in around them at the end.
+//
+// Each worker is held to a per-binary time and memory limit.  If it goes over (or crashes), the worker is killed and replaced, the binary
+// is recorded as abandoned, and everything that worker had finished since its last checkpoint goes back in the queue for someone else.
+internal sealed class MasterControllerProcess
 {
-    private readonly ConcurrentBag<Process> BatchProcesses = new ConcurrentBag<Process>();
-    //TODO: SKUCrawler: check if Parallel.ForEachAsync might be a simpler way of writing this code, once moved to .NET 6
-    //TODO: SKUCrawler: 3 seems like a reasonable number of batch processes to run at once, since each one tries to soak all the CPU cores already, so this just
-    //                  has a few running to interleave CPU work as they wait on disk I/O and such.
-    private readonly QueuedTaskScheduler _taskScheduler = new QueuedTaskScheduler(threadCount: 3);
-    private readonly TaskFactory _taskFactory;
-    private readonly List<Task> _batchTasks = new List<Task>();
+    // A binary that was in the unsaved work of a killed worker this many times is probably what's taking the workers down, even if it never
+    // went over a limit itself - so stop trying it.
+    internal const int MaxTimesRequeued = 3;
+
+    // The memory limit is held against how much a worker grows while it analyzes one binary, but a long-lived worker also holds onto memory
+    // between binaries.  Once that's more than this fraction of the limit, the worker is finished and replaced with a fresh one before it
+    // gets another binary, so what it's holding onto doesn't crowd out the binary it's given next.
+    private const double FractionOfMemoryLimitAWorkerCanHoldBetweenBinaries = 0.5;
+
+    private readonly PriorityQueue<CrawlWorkItem, long> _workQueue = new PriorityQueue<CrawlWorkItem, long>();
+    private readonly Lock _workQueueLock = new Lock();
     private readonly Lock _outputSyncObject = new Lock();
-    private readonly ConcurrentDictionary<int, ConcurrentBag<string>> _errorsFromBatchesByPID = new ConcurrentDictionary<int, ConcurrentBag<string>>();
-    private readonly ConcurrentDictionary<int, string> _batchCommandLinesByPID = new ConcurrentDictionary<int, string>();
-    private readonly ConcurrentDictionary<int, int> _batchNumbersByPID = new ConcurrentDictionary<int, int>();
+    private readonly ConcurrentDictionary<int, ConcurrentBag<string>> _errorsFromWorkersByWorkerNumber = new ConcurrentDictionary<int, ConcurrentBag<string>>();
+    private readonly ConcurrentDictionary<int, string> _binaryBeingAnalyzedAtFirstErrorByWorkerNumber = new ConcurrentDictionary<int, string>();
+    private readonly ConcurrentBag<(string BinaryPath, string Reason)> _abandonedBinaries = new ConcurrentBag<(string BinaryPath, string Reason)>();
+    private int _workersStarted;
+
+    internal IReadOnlyCollection<(string BinaryPath, string Reason)> AbandonedBinaries => this._abandonedBinaries;
 
-    public MasterControllerProcess()
+    public async Task CrawlWithWorkerPool(List<ProductBinary> productBinaries, CrawlFolderArguments appArgs)
     {
-        this._taskFactory = new TaskFactory(this._taskScheduler);
+        foreach (var binary in productBinaries)
+        {
+            Enqueue(CrawlWorkItem.Create(binary));
+        }
+
+        var workerCount = Math.Min(appArgs.WorkerCount, productBinaries.Count);
+        Console.WriteLine($"Found {productBinaries.Count} binaries that SizeBench can try to parse.  Analyzing them with {workerCount} worker processes.");
+
+        var workerSlots = new List<Task>(workerCount);
+        for (var i = 0; i < workerCount; i++)
+        {
+            workerSlots.Add(Task.Run(() => RunWorkerSlotAsync(appArgs)));
+        }
+
+        await Task.WhenAll(workerSlots);
     }
 
-    public Task KickOffAndWaitForBatches(List<ProductBinary> productBinaries, CrawlFolderArguments appArgs)
+    // Abandoned binaries only need their error written down, so they go first - that way they're done even if the crawl is cut short.
+    internal void Enqueue(CrawlWorkItem item)
     {
-        var numBatches = (int)Math.Ceiling(productBinaries.Count / (float)appArgs.BatchSize);
-        Console.WriteLine($"Found {productBinaries.Count} binaries that SizeBench can try to parse.  Breaking this up into {numBatches} batches.");
+        lock (this._workQueueLock)
+        {
+            this._workQueue.Enqueue(item, item.AbandonedBecause is null ? -item.SizeInBytes : Int64.MinValue);
+        }
+    }
 
-        // Note that batch number starts at 1, not zero.  Why?  I forget, but that's what it is.
-        for (var i = 1; i < numBatches + 1; i++)
+    internal bool TryDequeue(out CrawlWorkItem item)
+    {
+        lock (this._workQueueLock)
         {
-            var batchNumber = i; // Need to put this inside the loop so the lambda doesn't capture "i" as the final value over and over
-            var commandLine = appArgs.CommandLineArgsForBatch(batchNumber);
-            this._batchTasks.Add(this._taskFactory.StartNew(() => StartOneBatchTask(commandLine, batchNumber),
-                                 CancellationToken.None,
-                                 TaskCreationOptions.LongRunning,
-                                 this._taskScheduler));
+            return this._workQueue.TryDequeue(out item!, out _);
         }
+    }
+
+    // One slot in the pool - keeps one worker busy until the queue is empty, replacing it whenever it has to be killed.
+    private async Task RunWorkerSlotAsync(CrawlFolderArguments appArgs)
+    {
+        CrawlWorker? worker = null;
+
+        try
+        {
+            while (true)
+            {
+                if (!TryDequeue(out var item))
+                {
+                    if (worker is null)
+                    {
+                        return;
+                    }
 
-        return Task.WhenAll(this._batchTasks);
+                    // Nothing left for now, so let this worker write out what it has - but if that fails, whatever it hadn't checkpointed
+                    // goes back in the queue, and this slot keeps going to pick it up.
+                    if (await worker.FinishAsync().ConfigureAwait(false))
+                    {
+                        worker.Dispose();
+                        worker = null;
+                        return;
+                    }
+
+                    RequeueUnsavedWork(worker);
+                    worker.Dispose();
+                    worker = null;
+                    continue;
+                }
+
+                if (worker != null && WorkerShouldBeRecycled(worker, appArgs))
+                {
+                    if (!await worker.FinishAsync().ConfigureAwait(false))
+                    {
+                        RequeueUnsavedWork(worker);
+                    }
+
+                    worker.Dispose();
+                    worker = null;
+                }
+
+                worker ??= StartWorker(appArgs);
+
+                var outcome = await worker.ProcessAsync(item, appArgs.BinaryTimeLimit, appArgs.BinaryMemoryLimitInBytes).ConfigureAwait(false);
+                if (outcome == WorkItemOutcome.Finished)
+                {
+                    continue;
+                }
+
+                worker.Kill();
+
+                if (item.AbandonedBecause is null)
+                {
+                    // Another worker writes this down as the binary's error, so it's in the results like any other failure.
+                    this._abandonedBinaries.Add((item.Binary.BinaryPath, CrawlWorkerProtocol.DescribeOutcome(outcome, appArgs)));
+                    Enqueue(item with { AbandonedBecause = outcome });
+                }
+                else
+                {
+                    // Even writing down the error didn't work, all we can do is report it.
+                    RecordWorkerError(worker, $"Could not record that {item.Binary.BinaryPath} was abandoned, the worker for that failed too ({outcome}).");
+                }
+
+                RequeueUnsavedWork(worker);
+                worker.Dispose();
+                worker = null;
+            }
+        }
+        finally
+        {
+            worker?.Kill();
+            worker?.Dispose();
+        }
     }
 
-    private void StartOneBatchTask(string commandLineForBatch, int batchNumber)
+    private static bool WorkerShouldBeRecycled(CrawlWorker worker, CrawlFolderArguments appArgs)
     {
-        var psi = new ProcessStartInfo("SizeBench.SKUCrawler.exe", commandLineForBatch)
-        {
-            CreateNoWindow = true,
-            WindowStyle = ProcessWindowStyle.Hidden,
-            UseShellExecute = false,
-            RedirectStandardOutput = true,
-            RedirectStandardError = true,
-        };
-
-        Console.WriteLine($"Starting batch process, command line: {commandLineForBatch}");
-
-        var batchProcess = new Process()
-        {
-            StartInfo = psi,
-            EnableRaisingEvents = true
-        };
-        batchProcess.OutputDataReceived += BatchProcess_OutputDataReceived;
-        batchProcess.ErrorDataReceived += BatchProcess_ErrorDataReceived;
-        this.BatchProcesses.Add(batchProcess);
-        batchProcess.Start();
-        batchProcess.BeginOutputReadLine();
-        batchProcess.BeginErrorReadLine();
-        this._batchCommandLinesByPID.TryAdd(batchProcess.Id, commandLineForBatch);
-        this._batchNumbersByPID.TryAdd(batchProcess.Id, batchNumber);
-        batchProcess.WaitForExit(); //TODO: is there a way to use WaitForExitAsync to make this code cleaner and more correctly async?
+        if (appArgs.BinaryMemoryLimitInBytes <= 0)
+        {
+            return false;
+        }
+
+        try
+        {
+            return worker.PrivateMemoryInBytes > appArgs.BinaryMemoryLimitInBytes * FractionOfMemoryLimitAWorkerCanHoldBetweenBinaries;
+        }
+        catch (InvalidOperationException)
+        {
+            // It has already exited, which ProcessAsync will find out and deal with.
+            return false;
+        }
     }
 
-    private void BatchProcess_ErrorDataReceived(object sender, DataReceivedEventArgs e)
+    private CrawlWorker StartWorker(CrawlFolderArguments appArgs)
     {
-        if (!String.IsNullOrEmpty(e.Data))
+        // Worker numbers start at 1, since output from a previous crawl that's carried forward goes in as batch0.
+        var workerNumber = Interlocked.Increment(ref this._workersStarted);
+        var commandLine = appArgs.CommandLineArgsForBatch(workerNumber);
+
+        lock (this._outputSyncObject)
         {
-            lock (this._outputSyncObject)
+            Console.WriteLine($"Starting worker process, command line: {commandLine}");
+        }
+
+        return CrawlWorker.Start(workerNumber, commandLine, Worker_OutputLineReceived, Worker_ErrorLineReceived);
+    }
+
+    internal void RequeueUnsavedWork(CrawlWorker worker)
+    {
+        foreach (var unsavedItem in worker.TakeItemsSinceLastCheckpoint())
+        {
+            if (unsavedItem.TimesRequeued >= MaxTimesRequeued && unsavedItem.AbandonedBecause != null)
             {
-                var batchProcess = (Process)sender;
-                var errorsFromThisBatch = this._errorsFromBatchesByPID.GetOrAdd(batchProcess.Id, (_) => new ConcurrentBag<string>());
-                errorsFromThisBatch.Add(e.Data);
+                RecordWorkerError(worker, $"Could not record that {unsavedItem.Binary.BinaryPath} was abandoned, the results were lost {unsavedItem.TimesRequeued + 1} times.");
+            }
+            else if (unsavedItem.TimesRequeued >= MaxTimesRequeued)
+            {
+                var reason = $"Analysis finished, but the results were lost {unsavedItem.TimesRequeued + 1} times because the worker was killed or crashed before saving them";
+                this._abandonedBinaries.Add((unsavedItem.Binary.BinaryPath, reason));
+                Enqueue(unsavedItem with { AbandonedBecause = WorkItemOutcome.WorkerExited });
+            }
+            else
+            {
+                Enqueue(unsavedItem with { TimesRequeued = unsavedItem.TimesRequeued + 1 });
             }
         }
     }
 
-    private void BatchProcess_OutputDataReceived(object sender, DataReceivedEventArgs e)
+    private void Worker_ErrorLineReceived(CrawlWorker worker, string line) => RecordWorkerError(worker, line);
+
+    private void RecordWorkerError(CrawlWorker worker, string line)
     {
-        if (!String.IsNullOrEmpty(e.Data))
+        lock (this._outputSyncObject)
         {
-            lock (this._outputSyncObject)
+            var errorsFromThisWorker = this._errorsFromWorkersByWorkerNumber.GetOrAdd(worker.WorkerNumber, (_) => new ConcurrentBag<string>());
+            errorsFromThisWorker.Add(line);
+
+            if (worker.CurrentItem is CrawlWorkItem currentItem)
             {
-                Console.WriteLine(e.Data);
+                this._binaryBeingAnalyzedAtFirstErrorByWorkerNumber.TryAdd(worker.WorkerNumber, currentItem.Binary.BinaryPath);
             }
         }
     }
 
-    public void ProcessAllDeferredBatchErrors(ILogger log)
+    private void Worker_OutputLineReceived(CrawlWorker worker, string line)
     {
+        lock (this._outputSyncObject)
+        {
+            Console.WriteLine(line);
+        }
+    }
+
+    public void ProcessAllDeferredWorkerErrors(ILogger log)
+    {
+        if (!this._abandonedBinaries.IsEmpty)
+        {
+            using (new ConsoleColorScope(ConsoleColor.Yellow))
+            {
+                WriteToLogAndStdErr(log, String.Empty);
+                WriteToLogAndStdErr(log, $"{this._abandonedBinaries.Count} binaries were abandoned, these are listed in the Errors table of the output:");
+                foreach (var (binaryPath, reason) in this._abandonedBinaries.OrderBy(abandoned => abandoned.BinaryPath, StringComparer.OrdinalIgnoreCase))
+                {
+                    WriteToLogAndStdErr(log, $"    {binaryPath}: {reason}");
+                }
+            }
+        }
+
         using (var colorScope = new ConsoleColorScope(ConsoleColor.Red))
         {
-            foreach ((var batchPID, var errors) in this._errorsFromBatchesByPID)
+            foreach ((var workerNumber, var errors) in this._errorsFromWorkersByWorkerNumber)
             {
                 if (errors.IsEmpty)
                 {
@@ -109,40 +245,38 @@ internal sealed class MasterControllerProcess : IDisposable
                 }
 
                 WriteToLogAndStdErr(log, String.Empty);
-                WriteToLogAndStdErr(log, $"Errors from batch with PID={batchPID}:");
+                WriteToLogAndStdErr(log, $"Errors from worker {workerNumber}:");
 
-                foreach (var errorLineFromBatch in errors)
+                foreach (var errorLineFromWorker in errors)
                 {
                     // We get the errors one line at a time, so we try to guess at where the interesting 'first line' of an exception is, by looking for
                     // "Exception:" - that way "System.InvalidOperationException: some message" gets this extra data before we then let it spew out the callstack.
-                    if (errorLineFromBatch.Contains("Exception:", StringComparison.Ordinal))
+                    if (errorLineFromWorker.Contains("Exception:", StringComparison.Ordinal))
                     {
                         WriteToLogAndStdErr(log, String.Empty);
                         WriteToLogAndStdErr(log, "----------------------------------------");
-                        if (this._batchNumbersByPID.TryGetValue(batchPID, out var batchNumber))
+                        if (this._binaryBeingAnalyzedAtFirstErrorByWorkerNumber.TryGetValue(workerNumber, out var binaryPath))
                         {
-                            WriteToLogAndStdErr(log, $"Process for batch {batchNumber} had an error:");
-                            WriteToLogAndStdErr(log, $"To repro this error, use the command line: ");
-                            WriteToLogAndStdErr(log, $"    {this._batchCommandLinesByPID[batchPID]}");
+                            WriteToLogAndStdErr(log, $"Worker {workerNumber} had an error while analyzing {binaryPath}:");
                         }
                         else
                         {
-                            WriteToLogAndStdErr(log, $"Process with PID {batchPID} had an error, but we could not determine which batch this was from:");
+                            WriteToLogAndStdErr(log, $"Worker {workerNumber} had an error between binaries:");
                         }
                         WriteToLogAndStdErr(log, String.Empty);
-                        WriteToLogAndStdErr(log, errorLineFromBatch);
+                        WriteToLogAndStdErr(log, errorLineFromWorker);
                     }
                     else
                     {
-                        WriteToLogAndStdErr(log, errorLineFromBatch);
+                        WriteToLogAndStdErr(log, errorLineFromWorker);
                     }
                 }
             }
         }
 
-        if (!this._errorsFromBatchesByPID.IsEmpty)
+        if (!this._errorsFromWorkersByWorkerNumber.IsEmpty)
         {
-            throw new InvalidOperationException($"{this._errorsFromBatchesByPID.Count} batches (of {this.BatchProcesses.Count} batches total) had at least one error emitted.");
+            throw new InvalidOperationException($"{this._errorsFromWorkersByWorkerNumber.Count} workers (of {this._workersStarted} workers total) had at least one error emitted.");
         }
     }
 
@@ -151,33 +285,4 @@ internal sealed class MasterControllerProcess : IDisposable
         log.Log(s, LogLevel.Error);
         Console.Error.WriteLine(s);
     }
-
-    #region IDisposable Support
-    private bool disposedValue; // To detect redundant calls
-
-    private void Dispose(bool disposing)
-    {
-        if (!this.disposedValue)
-        {
-            if (disposing)
-            {
-                this._taskScheduler.Dispose();
-            }
-
-            this.disposedValue = true;
-        }
-    }
-
-    // TODO: override a finalizer only if Dispose(bool disposing) above has code to free unmanaged resources.
-    // ~MasterControllerProcess()
-    // {
-    //   // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
-    //   Dispose(false);
-    // }
-
-    // This code added to correctly implement the disposable pattern.
-    void IDisposable.Dispose() =>
-        // Do not change this code. Put cleanup code in Dispose(bool disposing) above.
-        Dispose(true);// TODO: uncomment the following line if the finalizer is overridden above.// GC.SuppressFinalize(this);
-    #endregion
 }
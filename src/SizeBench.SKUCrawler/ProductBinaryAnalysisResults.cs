@@ -0,0 +1,66 @@
+﻿using System.IO;
+using System.Text.RegularExpressions;
+using SizeBench.AnalysisEngine;
+using SizeBench.AnalysisEngine.Symbols;
+
+namespace SizeBench.SKUCrawler;
+
+// At least in SKUCrawler we want to 'fold up' all the BlockSymbols from a function up into the Function.
+// At some point it'd be good to have a way to do this in the Analysis Engine for other customers, as BlockSymbols suck
+// for diffing in the GUI too - but that needs a lot more thought because it breaks something important by allowing a
+// single symbol to contribute to multiple COFF Groups and how to visualize that in the UI and represent that in the
+// object model is hard.  So for now, to unblock SKUCrawler progress, this 'folding up blocks' functionality is here.
+internal sealed class SKUCrawlerSymbol
+{
+    public string Name = String.Empty;
+    public string? DetemplatedName;
+    public uint Size;
+    public SKUCrawlerSymbol() { }
+    public SKUCrawlerSymbol(ISymbol sym)
+    {
+        if (sym is CodeBlockSymbol)
+        {
+            throw new ArgumentException("Don't try to construct a SKUCrawlerSymbol from a block", nameof(sym));
+        }
+
+        this.Name = sym.Name;
+        this.DetemplatedName = null;
+        this.Size = sym.Size;
+    }
+}
+
+internal sealed class ProductBinaryAnalysisResults
+{
+    public ProductBinaryAnalysisResults(string binaryPath)
+    {
+        this.binaryPath = binaryPath;
+    }
+
+    public readonly string binaryPath;
+    public long fullBinarySize;
+    public long openingTookMs;
+    public IReadOnlyList<BinarySection>? sections;
+    public long sectionEnumerationTookMs;
+    public IReadOnlyCollection<Library>? libs;
+    public long libEnumerationTookMs;
+    public IReadOnlyList<SourceFile>? sourceFiles;
+    public long sourceFileEnumerationTookMs;
+    public IReadOnlyList<DuplicateDataItem>? duplicateDataItems;
+    public long ddiEnumerationTookMs;
+    public IReadOnlyList<WastefulVirtualItem>? wastefulVirtualItems;
+    public long wviEnumerationTookMs;
+    public IReadOnlyList<AnnotationSymbol>? annotations;
+    public long annotationEnumerationTookMs;
+    public Dictionary<(Compiland compiland, SourceFile sourceFile), List<SKUCrawlerSymbol>>? codeSymbolsInAllSourceFiles;
+    public long codeSymbolsInSourceFilesEnumerationTookMs;
+    public CrawlManifestEntry? manifestEntry;
+    public Exception? errorDuringProcessing;
+
+    public string GetBinaryName(string binaryRoot) => GetBinaryName(this.binaryPath, binaryRoot);
+
+    // Binaries are recorded relative to the root of the crawl when there is one, otherwise just by file name.
+    public static string GetBinaryName(string binaryPath, string binaryRoot)
+        => !String.IsNullOrEmpty(binaryRoot)
+           ? Regex.Replace(binaryPath, "^" + binaryRoot.Replace(@"\", @"\\", StringComparison.Ordinal), String.Empty, RegexOptions.IgnoreCase).TrimStart('\\')
+           : Path.GetFileName(binaryPath);
+}
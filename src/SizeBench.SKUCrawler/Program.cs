@@ -2,6 +2,7 @@
 using System.Diagnostics.CodeAnalysis;
 using System.Globalization;
 using System.IO;
+using System.Text;
 using Microsoft.Data.Sqlite;
 using Nito.AsyncEx;
 using SizeBench.Logging;
@@ -104,47 +105,70 @@ internal static class Program
     {
         if (crawlArgs.IsBatch)
         {
+            // Workers don't look at the folder at all, the master sends them each binary to analyze.
             _logFilenameBase = Path.Combine(crawlArgs.OutputFolder, $"SizeBench.SKUCrawler-{crawlArgs.TimestampOfMaster}-batch{crawlArgs.BatchNumber}");
-            await Console.Out.WriteLineAsync($"Batch process started!  Batch number={crawlArgs.BatchNumber}, PID={Environment.ProcessId}, outputting to {_logFilenameBase}");
-        }
-        else if (crawlArgs.IsMasterController)
-        {
-            _logFilenameBase = Path.Combine(crawlArgs.OutputFolder, $"SizeBench.SKUCrawler-{crawlArgs.TimestampOfMaster}-master");
-            await Console.Out.WriteLineAsync($"Master process started!  Outputting to {_logFilenameBase}");
+            await Console.Out.WriteLineAsync($"Worker process started!  Worker number={crawlArgs.BatchNumber}, PID={Environment.ProcessId}, outputting to {_logFilenameBase}");
+
+            var batchProcess = new BatchProcess(crawlArgs.BatchNumber, _logFilenameBase)
+            {
+                BinaryRoot = crawlArgs.CrawlRoot ?? String.Empty,
+                IncludeWastefulVirtuals = crawlArgs.IncludeWastefulVirtuals,
+                IncludeCodeSymbols = crawlArgs.IncludeCodeSymbols,
+                IncludeDuplicateDataItems = crawlArgs.IncludeDuplicateDataItems,
+                OutputFormat = crawlArgs.OutputFormat,
+            };
+
+            // The master writes work items as UTF-8, whatever the console's code page is, so paths come through intact.
+            using var workItems = new StreamReader(Console.OpenStandardInput(), new UTF8Encoding(encoderShouldEmitUTF8Identifier: false));
+            await batchProcess.AnalyzeWorkItemsFromMasterAsync(appLogger, workItems, Console.Out, crawlArgs.BatchSize, crawlArgs.CheckpointInterval);
+
+            return $"Done executing worker {crawlArgs.BatchNumber}";
         }
 
+        _logFilenameBase = Path.Combine(crawlArgs.OutputFolder, $"SizeBench.SKUCrawler-{crawlArgs.TimestampOfMaster}-master");
+        await Console.Out.WriteLineAsync($"Master process started!  Outputting to {_logFilenameBase}");
+
         var productBinaries = CrawlFolderBinaryCollector.FindAllBinariesForTheseArgs(crawlArgs, appLogger);
 
-        if (productBinaries.Count > 0)
+        var binariesCarriedForward = 0;
+        if (crawlArgs.PreviousCrawlDatabase != null)
+        {
+            using var taskLog = appLogger.StartTaskLog($"Carrying forward unchanged binaries from {crawlArgs.PreviousCrawlDatabase}");
+            productBinaries = CrawlManifest.FindChangedBinaries(crawlArgs, productBinaries, taskLog, out var unchangedBinaryIDs);
+
+            if (unchangedBinaryIDs.Count > 0)
+            {
+                CarryForwardFromPreviousCrawl(crawlArgs, unchangedBinaryIDs);
+                binariesCarriedForward = unchangedBinaryIDs.Count;
+            }
+        }
+
+        if (productBinaries.Count > 0 || binariesCarriedForward > 0)
         {
-            if (crawlArgs.IsMasterController)
+            var masterController = new MasterControllerProcess();
+            await masterController.CrawlWithWorkerPool(productBinaries, crawlArgs);
+
+            if (crawlArgs.OutputFormat == CrawlOutputFormat.SQLite)
             {
-                using var masterController = new MasterControllerProcess();
-                await masterController.KickOffAndWaitForBatches(productBinaries, crawlArgs);
                 await Console.Out.WriteLineAsync($"Merging all the databases in {crawlArgs.OutputFolder}");
 
-                using (appLogger.StartTaskLog("Merging batch databases"))
+                using (appLogger.StartTaskLog("Merging worker databases"))
                 {
                     MergeDatabases(crawlArgs);
                 }
-
-                using var deferredErrorsLog = appLogger.StartTaskLog("Processing all deferred errors from batches");
-                masterController.ProcessAllDeferredBatchErrors(deferredErrorsLog);
             }
-            else if (crawlArgs.IsBatch)
+            else
             {
-                var productBinariesInThisBatch = new List<ProductBinary>(crawlArgs.BatchSize);
-                productBinariesInThisBatch.AddRange(productBinaries.Skip(crawlArgs.BatchSize * (crawlArgs.BatchNumber - 1)).Take(crawlArgs.BatchSize));
+                await Console.Out.WriteLineAsync($"Merging all the columnar files in {crawlArgs.OutputFolder}");
 
-                var batchProcess = new BatchProcess(crawlArgs.BatchNumber, productBinariesInThisBatch, _logFilenameBase)
+                using (appLogger.StartTaskLog("Merging worker columnar files"))
                 {
-                    BinaryRoot = crawlArgs.CrawlRoot ?? String.Empty,
-                    IncludeWastefulVirtuals = crawlArgs.IncludeWastefulVirtuals,
-                    IncludeCodeSymbols = crawlArgs.IncludeCodeSymbols,
-                    IncludeDuplicateDataItems = crawlArgs.IncludeDuplicateDataItems,
-                };
-                await batchProcess.AnalyzeBatchAsync(appLogger);
+                    MergeColumnarFiles(crawlArgs);
+                }
             }
+
+            using var deferredErrorsLog = appLogger.StartTaskLog("Processing all deferred errors from workers");
+            masterController.ProcessAllDeferredWorkerErrors(deferredErrorsLog);
         }
         else
         {
@@ -152,7 +176,7 @@ internal static class Program
             CreateMergedDb(crawlArgs);
         }
 
-        return $"Done executing {(crawlArgs.IsMasterController ? "all batches" : $"batch {crawlArgs.BatchNumber}")}";
+        return "Done executing all workers";
     }
 
     public static Task<string> MergeAsync(MergeArguments mergeArgs)
@@ -238,6 +262,21 @@ internal static class Program
                           "                         omitted by default because it's potentially slow." + Environment.NewLine +
                           "/includeDuplicateData    Include Duplicate Data information in the output database - this is omitted by " + Environment.NewLine +
                           "                         default because it's potentially slow." + Environment.NewLine +
+                          "/outputFormat [format]   Either sqlite (the default) or columnar.  columnar writes each worker's output to" + Environment.NewLine +
+                          "                         compressed column-oriented .sbcol files, which are much faster to write for very" + Environment.NewLine +
+                          "                         large crawls.  These are merged into merged.sbcol instead of merged.db." + Environment.NewLine +
+                          "/previousCrawl [path]    The merged.db from an earlier crawl of the same folder, with the same options.  Binaries" + Environment.NewLine +
+                          "                         that haven't changed since then (same PDB signature and file hash) have their results" + Environment.NewLine +
+                          "                         copied forward from it instead of being analyzed again.  Only works with sqlite output." + Environment.NewLine +
+                          Environment.NewLine +
+                          "/workers [count]         How many worker processes analyze binaries at once.  Defaults to the number of" + Environment.NewLine +
+                          "                         processors." + Environment.NewLine +
+                          "/binaryTimeLimitMinutes [minutes]" + Environment.NewLine +
+                          "                         A binary that takes longer than this to analyze is abandoned and listed in the" + Environment.NewLine +
+                          "                         Errors table.  Defaults to 60." + Environment.NewLine +
+                          "/binaryMemoryLimitMB [MB]" + Environment.NewLine +
+                          "                         A binary whose worker uses more memory than this is abandoned and listed in the" + Environment.NewLine +
+                          "                         Errors table.  There is no limit by default." + Environment.NewLine +
                           Environment.NewLine +
                           "/merge [fileName]        The fileName database will be merged into the final database." + Environment.NewLine +
                           Environment.NewLine +
@@ -287,14 +326,17 @@ internal static class Program
     private const string _ErrorsTableName = "Errors";
 
     private static void CreateMergedDb(ApplicationArguments appArgs)
+        => CreateMergedDb(Path.Combine(appArgs.OutputFolder, "merged.db"));
+
+    private static void CreateMergedDb(string dbFileName)
     {
         try
         {
-            var dbFileName = Path.Combine(appArgs.OutputFolder, "merged.db");
             File.Delete(dbFileName);
             using var connection = new SqliteConnection(new SqliteConnectionStringBuilder()
             {
-                DataSource = dbFileName
+                DataSource = dbFileName,
+                Pooling = false
             }.ToString());
             connection.Open();
 
@@ -522,6 +564,22 @@ internal static class Program
                 command.ExecuteNonQuery();
             }
 
+            createTableQuery = $"CREATE TABLE {CrawlManifest.TableName} (" +
+                                "BinaryID INT NOT NULL, " +
+                                "PdbGuid TEXT, " +
+                                "PdbAge INT, " +
+                                "BinarySHA256 TEXT, " +
+                                "CrawlOptions INT NOT NULL, " +
+                                "CONSTRAINT fk_binaries " +
+                                "  FOREIGN KEY (BinaryID) " +
+                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
+                                ")";
+
+            using (var command = new SqliteCommand(createTableQuery, connection))
+            {
+                command.ExecuteNonQuery();
+            }
+
             createTableQuery = $"CREATE TABLE {_ErrorsTableName} (" +
                                 "ErrorID INTEGER PRIMARY KEY, " +
                                 "BinaryID INT NOT NULL, " +
@@ -545,611 +603,375 @@ internal static class Program
         }
     }
 
-    private static void MergeDatabases(ApplicationArguments appArgs)
+    // Merging is a tree reduction: the batch databases are merged in pairs, in parallel, into intermediate databases - then those are
+    // merged in pairs, and so on until there's only one left, which becomes merged.db.  Each pair is merged with ATTACH DATABASE and a
+    // handful of set-based INSERT...SELECT statements per table, rather than reading and inserting each row individually.
+    //
+    // IDs are remapped by offsetting them: everything merged in from one database has its IDs shifted past the largest ID already in the
+    // database it's being merged into, so a foreign key can be remapped with the same addition as the primary key it points to, and no
+    // ID lookup tables are needed.  Symbols are the one exception - they're shared across binaries by name and size, so those go through
+    // a temporary table mapping each incoming SymbolID to the merged one.
+    internal static void MergeDatabases(ApplicationArguments appArgs)
     {
-        CreateMergedDb(appArgs);
+        var mergeStartTime = DateTime.Now;
+        var mergedDbFileName = Path.Combine(appArgs.OutputFolder, "merged.db");
+        var filesToMerge = appArgs.GetDatabaseFilesToMerge().Select(file => file.FullName).ToList();
 
-        using (var connectionToMerged = new SqliteConnection(new SqliteConnectionStringBuilder()
+        if (filesToMerge.Count == 0)
         {
-            DataSource = Path.Combine(appArgs.OutputFolder, "merged.db")
-        }.ToString()))
+            CreateMergedDb(mergedDbFileName);
+        }
+        else
         {
-            var mergeStartTime = DateTime.Now;
-            connectionToMerged.Open();
+            var intermediateFolder = Path.Combine(appArgs.OutputFolder, $"SizeBench.SKUCrawler-merge-{Environment.ProcessId}");
+            Directory.CreateDirectory(intermediateFolder);
+            var parallelOptions = new ParallelOptions() { MaxDegreeOfParallelism = Environment.ProcessorCount };
 
+            try
             {
-                // Disable on-disk journaling for perf
-                var pragmaCommand = connectionToMerged.CreateCommand();
-                pragmaCommand.CommandText = "PRAGMA journal_mode = MEMORY;";
-                pragmaCommand.ExecuteNonQuery();
-            }
-
-            using var transaction = connectionToMerged.BeginTransaction();
-
-            var symbolSizeAndNameToMergedDatabaseIDs = new SortedList<int, SortedList<string, int>>(capacity: 10000);
-            foreach (var file in appArgs.GetDatabaseFilesToMerge())
-            {
-                Console.Out.WriteLine($"Merging in {file.Name}");
-                using var connectionToOneBatch = new SqliteConnection(new SqliteConnectionStringBuilder()
-                {
-                    DataSource = file.FullName
-                }.ToString());
-                connectionToOneBatch.Open();
-
+                // The first level merges pairs of batch databases into new databases with the merged schema, since a batch only has the optional
+                // tables for what it was asked to crawl.
+                var mergedSoFar = new string[(filesToMerge.Count + 1) / 2];
+                Parallel.For(0, mergedSoFar.Length, parallelOptions, i =>
                 {
-                    // Disable on-disk journaling for perf
-                    var pragmaCommand = connectionToOneBatch.CreateCommand();
-                    pragmaCommand.CommandText = "PRAGMA journal_mode = MEMORY;";
-                    pragmaCommand.ExecuteNonQuery();
-                }
-
-                var mergedCommand = connectionToMerged.CreateCommand();
-                mergedCommand.Transaction = transaction;
-
-                var mergedSelect_last_rowidCommand = connectionToMerged.CreateCommand();
-                mergedSelect_last_rowidCommand.CommandText = "select last_insert_rowid()";
-                mergedSelect_last_rowidCommand.Transaction = transaction;
-
-                var binaryIDMappings = MergeInBinariesTable(mergedCommand, mergedSelect_last_rowidCommand, connectionToOneBatch);
-                var sectionIDMappingns = MergeInSectionsTable(mergedCommand, mergedSelect_last_rowidCommand, connectionToOneBatch, binaryIDMappings);
-                var coffGroupIDMappings = MergeInCOFFGroupsTable(mergedCommand, mergedSelect_last_rowidCommand, connectionToOneBatch, binaryIDMappings, sectionIDMappingns);
-                var libIDMappings = MergeInLibsTable(mergedCommand, mergedSelect_last_rowidCommand, connectionToOneBatch, binaryIDMappings);
-                var compilandIDMappings = MergeInCompilandsTable(mergedCommand, mergedSelect_last_rowidCommand, connectionToOneBatch, binaryIDMappings, libIDMappings);
-                var sourceFileIDMappings = MergeInSourceFilesTable(mergedCommand, mergedSelect_last_rowidCommand, connectionToOneBatch, binaryIDMappings);
-                var symbolIDMappings = MergeInSymbolsTable(mergedCommand, mergedSelect_last_rowidCommand, connectionToOneBatch, symbolSizeAndNameToMergedDatabaseIDs);
-
-                if (BatchHasDuplicateDataTable(connectionToOneBatch))
-                {
-                    MergeInDuplicateDataTable(mergedCommand, connectionToOneBatch, binaryIDMappings, symbolIDMappings);
-                }
-
-                if (BatchHasWastefulVirtualsTable(connectionToOneBatch))
-                {
-                    var wvTypeIDMappings = MergeInWastefulVirtualTypesTable(mergedCommand, mergedSelect_last_rowidCommand, connectionToOneBatch, binaryIDMappings);
-                    MergInWastefulVirtualFunctionsTable(mergedCommand, connectionToOneBatch, wvTypeIDMappings);
-                }
-
-                MergeInAnnotationsTable(mergedCommand, connectionToOneBatch, binaryIDMappings, sourceFileIDMappings);
-
-                if (BatchHasCodeSymbolsTable(connectionToOneBatch))
+                    var intermediateDbFileName = Path.Combine(intermediateFolder, $"level0-{i}.db");
+                    CreateMergedDb(intermediateDbFileName);
+                    MergeDatabasesInto(intermediateDbFileName, filesToMerge.Skip(i * 2).Take(2));
+                    mergedSoFar[i] = intermediateDbFileName;
+                });
+
+                // Each level after that merges the right database of each pair into the left, so IDs keep the same order as the batches.
+                while (mergedSoFar.Length > 1)
                 {
-                    MergeInCompilandSymbolsTable(mergedCommand, connectionToOneBatch, symbolIDMappings, compilandIDMappings, sourceFileIDMappings);
+                    Console.Out.WriteLine($"Merging {mergedSoFar.Length} intermediate databases down to {(mergedSoFar.Length + 1) / 2}");
+                    var previousLevel = mergedSoFar;
+                    mergedSoFar = new string[(previousLevel.Length + 1) / 2];
+                    Parallel.For(0, mergedSoFar.Length, parallelOptions, i =>
+                    {
+                        if (i * 2 + 1 < previousLevel.Length)
+                        {
+                            MergeDatabasesInto(previousLevel[i * 2], [previousLevel[i * 2 + 1]]);
+                            File.Delete(previousLevel[i * 2 + 1]);
+                        }
+
+                        mergedSoFar[i] = previousLevel[i * 2];
+                    });
                 }
 
-                MergeInPerfStatsTable(mergedCommand, connectionToOneBatch, binaryIDMappings);
-                MergeInErrorsTable(mergedCommand, connectionToOneBatch, binaryIDMappings);
+                AddIndexesToMergedDb(mergedSoFar[0]);
+                File.Move(mergedSoFar[0], mergedDbFileName, overwrite: true);
             }
-
-            // Add indexes to merged db
-            const string indexesToCreate = @"
-                        CREATE INDEX[IX_Binaries_Name] ON[Binaries](Name);
-                        CREATE INDEX[IX_COFFGroups_BinaryIDBinarySectionID] ON[COFFGroups](BinaryID, BinarySectionID);
-                        CREATE INDEX[IX_COFFGroups_COFFGroupNameBinaryID] ON[COFFGroups](COFFGroupName, BinaryID);
-                        CREATE INDEX[IX_COFFGroups_BinaryID] ON[COFFGroups](BinaryID);
-                        CREATE INDEX[IX_Compilands_CompilandNameBinaryID] ON[Compilands](CompilandName, BinaryID);
-                        CREATE INDEX[IX_Compilands_BinaryLibIDCompilandName] ON[Compilands](BinaryLibID, CompilandName);
-                        CREATE INDEX[IX_Libs_BinaryIDLibName] ON[Libs](BinaryID, LibName);
-                        CREATE INDEX[IX_Libs_LibName] ON[Libs](LibName);
-                        CREATE INDEX[IX_Sections_BinaryIDSectionName] ON[Sections](BinaryID, SectionName);
-                        CREATE INDEX[IX_Sections_SectionName] ON[Sections](SectionName);";
-
-            using (var commandToAddIndexes = new SqliteCommand(indexesToCreate, connectionToMerged, transaction))
+            finally
             {
-                commandToAddIndexes.ExecuteNonQuery();
+                Directory.Delete(intermediateFolder, recursive: true);
             }
-
-            transaction.Commit();
-            var mergeEndTime = DateTime.Now;
-            Console.Out.WriteLine($"Merging process itself took {mergeEndTime - mergeStartTime}");
         }
 
+        var mergeEndTime = DateTime.Now;
+        Console.Out.WriteLine($"Merging process itself took {mergeEndTime - mergeStartTime}");
+
         using (_ = new ConsoleColorScope(ConsoleColor.Green))
         {
-            Console.Out.WriteLine($"Finished processing - full SQLite database output is in {Path.Combine(appArgs.OutputFolder, "merged.db")}");
+            Console.Out.WriteLine($"Finished processing - full SQLite database output is in {mergedDbFileName}");
         }
     }
 
-    private static bool BatchHasDuplicateDataTable(SqliteConnection connectionToOneBatch)
-        => DoesTableExist(connectionToOneBatch, _DuplicateDataTableName);
-
-    private static bool BatchHasWastefulVirtualsTable(SqliteConnection connectionToOneBatch)
-        => DoesTableExist(connectionToOneBatch, _WastefulVirtualsTypeTableName);
-
-    private static bool BatchHasCodeSymbolsTable(SqliteConnection connectionToOneBatch)
-        => DoesTableExist(connectionToOneBatch, _SymbolLocationsTableName);
-
-    private static bool DoesTableExist(SqliteConnection connectionToOneBatch, string tableName)
+    // See ColumnarFileMerger for how this lines up with what MergeDatabases does.
+    private static void MergeColumnarFiles(CrawlFolderArguments crawlArgs)
     {
-        using var query = connectionToOneBatch.CreateCommand();
-        query.CommandText = "SELECT * FROM sqlite_master WHERE type = 'table' AND tbl_name=@TableName";
-        query.Parameters.AddWithValue("@TableName", tableName);
-        var reader = query.ExecuteReader();
-        return reader.HasRows;
-    }
+        var mergeStartTime = DateTime.Now;
+        var mergedFileName = Path.Combine(crawlArgs.OutputFolder, "merged.sbcol");
+        var filesToMerge = crawlArgs.GetColumnarFilesToMerge().Select(file => file.FullName).ToList();
 
-    private static SortedList<int, int> MergeInBinariesTable(SqliteCommand mergedCommand, SqliteCommand mergedSelect_last_rowidCommand,
-                                                             SqliteConnection connectionToOneBatch)
-    {
-        var binaryIDMappings = new SortedList<int, int>(capacity: 1000);
-        using (var queryBinaries = connectionToOneBatch.CreateCommand())
-        {
-            queryBinaries.CommandText = "SELECT * FROM Binaries ORDER BY BinaryID";
-            var reader = queryBinaries.ExecuteReader();
-
-            mergedCommand.CommandText = "INSERT INTO Binaries " +
-                                        "(Name, Size) " +
-                                        "VALUES " +
-                                        "(@Name, @Size)";
+        var filesMerged = ColumnarFileMerger.Merge(filesToMerge, mergedFileName, Console.Out);
 
-            mergedCommand.Parameters.Clear();
-            mergedCommand.Parameters.AddWithValue("@Name", String.Empty);
-            mergedCommand.Parameters.AddWithValue("@Size", 0);
-
-            while (reader.Read())
-            {
-                mergedCommand.Parameters["@Name"].Value = reader["Name"];
-                mergedCommand.Parameters["@Size"].Value = reader["Size"];
-                mergedCommand.ExecuteNonQuery();
+        var mergeEndTime = DateTime.Now;
+        Console.Out.WriteLine($"Merging process itself took {mergeEndTime - mergeStartTime}");
 
-                binaryIDMappings.Add(Convert.ToInt32(reader["BinaryID"], CultureInfo.InvariantCulture),
-                                     Convert.ToInt32(mergedSelect_last_rowidCommand.ExecuteScalar(), CultureInfo.InvariantCulture));
-            }
+        using (_ = new ConsoleColorScope(ConsoleColor.Green))
+        {
+            Console.Out.WriteLine($"Finished processing - merged {filesMerged} of {filesToMerge.Count} columnar files into {mergedFileName}");
         }
-
-        return binaryIDMappings;
     }
 
-    private static SortedList<int, int> MergeInSectionsTable(SqliteCommand mergedCommand, SqliteCommand mergedSelect_last_rowidCommand,
-                                                             SqliteConnection connectionToOneBatch, SortedList<int, int> binaryIDMappings)
+    private static void MergeDatabasesInto(string mergedDbFileName, IEnumerable<string> dbFileNamesToMergeIn)
     {
-        var sectionIDMappings = new SortedList<int, int>(capacity: 1000);
-        using (var querySections = connectionToOneBatch.CreateCommand())
+        // Pooling is off for every connection used while merging, so that nothing holds the file open once we're done with it and the
+        // intermediate databases can be deleted or moved.
+        using var connectionToMerged = new SqliteConnection(new SqliteConnectionStringBuilder()
         {
-            querySections.CommandText = "SELECT * FROM Sections ORDER BY BinarySectionID";
-            var reader = querySections.ExecuteReader();
+            DataSource = mergedDbFileName,
+            Pooling = false
+        }.ToString());
+        connectionToMerged.Open();
 
-            mergedCommand.CommandText = "INSERT INTO Sections " +
-                                        "(BinaryID, SectionName, Size, VirtualSize) " +
-                                        "VALUES " +
-                                        "(@BinaryID, @SectionName, @Size, @VirtualSize)";
+        using (var setupCommand = connectionToMerged.CreateCommand())
+        {
+            // Disable on-disk journaling for perf - if a merge fails part way through the whole merge needs to be re-run anyway.
+            // Symbols are de-duplicated by name and size as they're merged, which needs an index to be fast.
+            setupCommand.CommandText = "PRAGMA journal_mode = MEMORY; " +
+                                       "PRAGMA synchronous = OFF; " +
+                                      $"CREATE INDEX IF NOT EXISTS [IX_Symbols_SizeSymbolName] ON [{_SymbolsTableName}](Size, SymbolName); " +
+                                       "CREATE TEMP TABLE IF NOT EXISTS SymbolIDMappings (BatchSymbolID INTEGER PRIMARY KEY, MergedSymbolID INT NOT NULL);";
+            setupCommand.ExecuteNonQuery();
+        }
 
-            mergedCommand.Parameters.Clear();
-            mergedCommand.Parameters.AddWithValue("@BinaryID", 0);
-            mergedCommand.Parameters.AddWithValue("@SectionName", String.Empty);
-            mergedCommand.Parameters.AddWithValue("@Size", 0);
-            mergedCommand.Parameters.AddWithValue("@VirtualSize", 0);
+        foreach (var dbFileName in dbFileNamesToMergeIn)
+        {
+            Console.Out.WriteLine($"Merging in {Path.GetFileName(dbFileName)}");
 
-            while (reader.Read())
+            // ATTACH and DETACH can't be done inside a transaction, so each database gets its own transaction.
+            using (var attachCommand = connectionToMerged.CreateCommand())
             {
-                mergedCommand.Parameters["@BinaryID"].Value = binaryIDMappings[Convert.ToInt32(reader["BinaryID"], CultureInfo.InvariantCulture)];
-                mergedCommand.Parameters["@SectionName"].Value = reader["SectionName"];
-                mergedCommand.Parameters["@Size"].Value = reader["Size"];
-                mergedCommand.Parameters["@VirtualSize"].Value = reader["VirtualSize"];
-                mergedCommand.ExecuteNonQuery();
-
-                sectionIDMappings.Add(Convert.ToInt32(reader["BinarySectionID"], CultureInfo.InvariantCulture),
-                                      Convert.ToInt32(mergedSelect_last_rowidCommand.ExecuteScalar(), CultureInfo.InvariantCulture));
+                attachCommand.CommandText = "ATTACH DATABASE @FileName AS batch";
+                attachCommand.Parameters.AddWithValue("@FileName", dbFileName);
+                attachCommand.ExecuteNonQuery();
             }
-        }
 
-        return sectionIDMappings;
-    }
+            using (var transaction = connectionToMerged.BeginTransaction())
+            {
+                MergeInAttachedDatabase(connectionToMerged, transaction);
+                transaction.Commit();
+            }
 
-    private static SortedList<int, int> MergeInCOFFGroupsTable(SqliteCommand mergedCommand, SqliteCommand mergedSelect_last_rowidCommand,
-                                                               SqliteConnection connectionToOneBatch,
-                                                               SortedList<int, int> binaryIDMappings, SortedList<int, int> sectionIDMappings)
-    {
-        var coffGroupIDMappings = new SortedList<int, int>(capacity: 1000);
-        using (var queryCOFFGroups = connectionToOneBatch.CreateCommand())
-        {
-            queryCOFFGroups.CommandText = "SELECT * FROM COFFGroups ORDER BY BinaryCOFFGroupID";
-            var reader = queryCOFFGroups.ExecuteReader();
-
-            mergedCommand.CommandText = "INSERT INTO COFFGroups " +
-                                        "(BinaryID, BinarySectionID, COFFGroupName, Size, VirtualSize) " +
-                                        "VALUES " +
-                                        "(@BinaryID, @BinarySectionID, @COFFGroupName, @Size, @VirtualSize)";
-
-            mergedCommand.Parameters.Clear();
-            mergedCommand.Parameters.AddWithValue("@BinaryID", 0);
-            mergedCommand.Parameters.AddWithValue("@BinarySectionID", 0);
-            mergedCommand.Parameters.AddWithValue("@COFFGroupName", String.Empty);
-            mergedCommand.Parameters.AddWithValue("@Size", 0);
-            mergedCommand.Parameters.AddWithValue("@VirtualSize", 0);
-
-            while (reader.Read())
+            using (var detachCommand = connectionToMerged.CreateCommand())
             {
-                mergedCommand.Parameters["@BinaryID"].Value = binaryIDMappings[Convert.ToInt32(reader["BinaryID"], CultureInfo.InvariantCulture)];
-                mergedCommand.Parameters["@BinarySectionID"].Value = sectionIDMappings[Convert.ToInt32(reader["BinarySectionID"], CultureInfo.InvariantCulture)];
-                mergedCommand.Parameters["@COFFGroupName"].Value = reader["COFFGroupName"];
-                mergedCommand.Parameters["@Size"].Value = reader["Size"];
-                mergedCommand.Parameters["@VirtualSize"].Value = reader["VirtualSize"];
-                mergedCommand.ExecuteNonQuery();
-
-                coffGroupIDMappings.Add(Convert.ToInt32(reader["BinaryCOFFGroupID"], CultureInfo.InvariantCulture),
-                                        Convert.ToInt32(mergedSelect_last_rowidCommand.ExecuteScalar(), CultureInfo.InvariantCulture));
+                detachCommand.CommandText = "DETACH DATABASE batch";
+                detachCommand.ExecuteNonQuery();
             }
         }
-
-        return coffGroupIDMappings;
     }
 
-    private static SortedList<int, int> MergeInLibsTable(SqliteCommand mergedCommand, SqliteCommand mergedSelect_last_rowidCommand,
-                                                         SqliteConnection connectionToOneBatch, SortedList<int, int> binaryIDMappings)
+    private static void MergeInAttachedDatabase(SqliteConnection connectionToMerged, SqliteTransaction transaction)
     {
-        var libIDMappings = new SortedList<int, int>(capacity: 1000);
-        using (var queryLibs = connectionToOneBatch.CreateCommand())
-        {
-            queryLibs.CommandText = "SELECT * FROM Libs ORDER BY BinaryLibID";
-            var reader = queryLibs.ExecuteReader();
+        using var mergedCommand = connectionToMerged.CreateCommand();
+        mergedCommand.Transaction = transaction;
 
-            mergedCommand.CommandText = "INSERT INTO Libs " +
-                                        "(BinaryID, LibName, Size) " +
-                                        "VALUES " +
-                                        "(@BinaryID, @LibName, @Size)";
+        // Every offset has to be read before anything is inserted, since the tables are filled in one at a time below.
+        mergedCommand.Parameters.AddWithValue("@BinaryIDOffset", GetLargestID(mergedCommand, _BinariesTable, "BinaryID"));
+        mergedCommand.Parameters.AddWithValue("@SectionIDOffset", GetLargestID(mergedCommand, _SectionTableName, "BinarySectionID"));
+        mergedCommand.Parameters.AddWithValue("@LibIDOffset", GetLargestID(mergedCommand, _LibsTableName, "BinaryLibID"));
+        mergedCommand.Parameters.AddWithValue("@CompilandIDOffset", GetLargestID(mergedCommand, _CompilandsTableName, "BinaryCompilandID"));
+        mergedCommand.Parameters.AddWithValue("@SourceFileIDOffset", GetLargestID(mergedCommand, _SourceFilesTableName, "SourceFileID"));
+        mergedCommand.Parameters.AddWithValue("@WastefulVirtualTypeIDOffset", GetLargestID(mergedCommand, _WastefulVirtualsTypeTableName, "WastefulVirtualTypeID"));
 
-            mergedCommand.Parameters.Clear();
-            mergedCommand.Parameters.AddWithValue("@BinaryID", 0);
-            mergedCommand.Parameters.AddWithValue("@LibName", String.Empty);
-            mergedCommand.Parameters.AddWithValue("@Size", 0);
+        ExecuteMergeStatement(mergedCommand,
+            $"INSERT INTO main.{_BinariesTable} (BinaryID, Name, Size) " +
+            $"SELECT BinaryID + @BinaryIDOffset, Name, Size FROM batch.{_BinariesTable} ORDER BY BinaryID");
 
-            while (reader.Read())
-            {
-                mergedCommand.Parameters["@BinaryID"].Value = binaryIDMappings[Convert.ToInt32(reader["BinaryID"], CultureInfo.InvariantCulture)];
-                mergedCommand.Parameters["@LibName"].Value = reader["LibName"];
-                mergedCommand.Parameters["@Size"].Value = reader["Size"];
-                mergedCommand.ExecuteNonQuery();
+        ExecuteMergeStatement(mergedCommand,
+            $"INSERT INTO main.{_SectionTableName} (BinarySectionID, BinaryID, SectionName, Size, VirtualSize) " +
+            $"SELECT BinarySectionID + @SectionIDOffset, BinaryID + @BinaryIDOffset, SectionName, Size, VirtualSize FROM batch.{_SectionTableName} ORDER BY BinarySectionID");
 
-                libIDMappings.Add(Convert.ToInt32(reader["BinaryLibID"], CultureInfo.InvariantCulture),
-                                  Convert.ToInt32(mergedSelect_last_rowidCommand.ExecuteScalar(), CultureInfo.InvariantCulture));
-            }
-        }
+        ExecuteMergeStatement(mergedCommand,
+            $"INSERT INTO main.{_COFFGroupTableName} (BinaryID, BinarySectionID, COFFGroupName, Size, VirtualSize) " +
+            $"SELECT BinaryID + @BinaryIDOffset, BinarySectionID + @SectionIDOffset, COFFGroupName, Size, VirtualSize FROM batch.{_COFFGroupTableName} ORDER BY BinaryCOFFGroupID");
 
-        return libIDMappings;
-    }
+        ExecuteMergeStatement(mergedCommand,
+            $"INSERT INTO main.{_LibsTableName} (BinaryLibID, BinaryID, LibName, Size) " +
+            $"SELECT BinaryLibID + @LibIDOffset, BinaryID + @BinaryIDOffset, LibName, Size FROM batch.{_LibsTableName} ORDER BY BinaryLibID");
 
-    private static SortedList<int, int> MergeInCompilandsTable(SqliteCommand mergedCommand, SqliteCommand mergedSelect_last_rowidCommand,
-                                                               SqliteConnection connectionToOneBatch,
-                                                               SortedList<int, int> binaryIDMappings, SortedList<int, int> libIDMappings)
-    {
-        var compilandIDMappings = new SortedList<int, int>(capacity: 1000);
-        using (var queryCompilands = connectionToOneBatch.CreateCommand())
-        {
-            queryCompilands.CommandText = "SELECT * FROM Compilands ORDER BY BinaryCompilandID";
-            var reader = queryCompilands.ExecuteReader();
-
-            mergedCommand.CommandText = "INSERT INTO Compilands " +
-                                        "(BinaryID, BinaryLibID, CompilandName, Size, CommandLine, RTTIEnabled, Language, FrontEndVersion, BackEndVersion) " +
-                                        "VALUES " +
-                                        "(@BinaryID, @BinaryLibID, @CompilandName, @Size, @CommandLine, @RTTIEnabled, @Language, @FrontEndVersion, @BackEndVersion)";
-
-            mergedCommand.Parameters.Clear();
-            mergedCommand.Parameters.AddWithValue("@BinaryID", 0);
-            mergedCommand.Parameters.AddWithValue("@BinaryLibID", 0);
-            mergedCommand.Parameters.AddWithValue("@CompilandName", String.Empty);
-            mergedCommand.Parameters.AddWithValue("@Size", 0);
-            mergedCommand.Parameters.AddWithValue("@CommandLine", String.Empty);
-            mergedCommand.Parameters.AddWithValue("@RTTIEnabled", 0);
-            mergedCommand.Parameters.AddWithValue("@Language", String.Empty);
-            mergedCommand.Parameters.AddWithValue("@FrontEndVersion", 0);
-            mergedCommand.Parameters.AddWithValue("@BackEndVersion", 0);
-
-            while (reader.Read())
-            {
-                mergedCommand.Parameters["@BinaryID"].Value = binaryIDMappings[Convert.ToInt32(reader["BinaryID"], CultureInfo.InvariantCulture)];
-                mergedCommand.Parameters["@BinaryLibID"].Value = libIDMappings[Convert.ToInt32(reader["BinaryLibID"], CultureInfo.InvariantCulture)];
-                mergedCommand.Parameters["@CompilandName"].Value = reader["CompilandName"];
-                mergedCommand.Parameters["@Size"].Value = reader["Size"];
-                mergedCommand.Parameters["@CommandLine"].Value = reader["CommandLine"];
-                mergedCommand.Parameters["@RTTIEnabled"].Value = reader["RTTIEnabled"];
-                mergedCommand.Parameters["@Language"].Value = reader["Language"];
-                mergedCommand.Parameters["@FrontEndVersion"].Value = reader["FrontEndVersion"];
-                mergedCommand.Parameters["@BackEndVersion"].Value = reader["BackEndVersion"];
-                mergedCommand.ExecuteNonQuery();
-
-                compilandIDMappings.Add(Convert.ToInt32(reader["BinaryCompilandID"], CultureInfo.InvariantCulture),
-                                        Convert.ToInt32(mergedSelect_last_rowidCommand.ExecuteScalar(), CultureInfo.InvariantCulture));
-            }
-        }
+        ExecuteMergeStatement(mergedCommand,
+            $"INSERT INTO main.{_CompilandsTableName} (BinaryCompilandID, BinaryID, BinaryLibID, CompilandName, Size, CommandLine, RTTIEnabled, Language, FrontEndVersion, BackEndVersion) " +
+            $"SELECT BinaryCompilandID + @CompilandIDOffset, BinaryID + @BinaryIDOffset, BinaryLibID + @LibIDOffset, CompilandName, Size, CommandLine, RTTIEnabled, Language, FrontEndVersion, BackEndVersion " +
+            $"FROM batch.{_CompilandsTableName} ORDER BY BinaryCompilandID");
 
-        return compilandIDMappings;
-    }
-
-    private static void MergeInDuplicateDataTable(SqliteCommand mergedCommand, SqliteConnection connectionToOneBatch,
-                                                  SortedList<int, int> binaryIDMappings, SortedList<int, int> symbolIDMappings)
-    {
-        using var queryDDI = connectionToOneBatch.CreateCommand();
-        queryDDI.CommandText = "SELECT * FROM DuplicateData";
-        var reader = queryDDI.ExecuteReader();
+        ExecuteMergeStatement(mergedCommand,
+            $"INSERT INTO main.{_SourceFilesTableName} (SourceFileID, BinaryID, SourceFileName, Size) " +
+            $"SELECT SourceFileID + @SourceFileIDOffset, BinaryID + @BinaryIDOffset, SourceFileName, Size FROM batch.{_SourceFilesTableName} ORDER BY SourceFileID");
 
-        mergedCommand.CommandText = "INSERT INTO DuplicateData " +
-                                    "(BinaryID, SymbolID, WastedSize) " +
-                                    "VALUES " +
-                                    "(@BinaryID, @SymbolID, @WastedSize)";
+        // Only symbols with a name and size that aren't already in the merged database are inserted.  The same symbol can be in the incoming
+        // database more than once (a batch only shares them within each binary), so they're grouped to insert just the first of each.
+        ExecuteMergeStatement(mergedCommand,
+            $"INSERT INTO main.{_SymbolsTableName} (SymbolName, SymbolDetemplatedName, Size) " +
+             "SELECT SymbolName, SymbolDetemplatedName, Size FROM " +
+             "(SELECT MIN(incoming.SymbolID) AS FirstSymbolID, incoming.SymbolName, incoming.SymbolDetemplatedName, incoming.Size " +
+            $" FROM batch.{_SymbolsTableName} AS incoming " +
+            $" WHERE NOT EXISTS (SELECT 1 FROM main.{_SymbolsTableName} AS merged WHERE merged.Size = incoming.Size AND merged.SymbolName = incoming.SymbolName) " +
+             " GROUP BY incoming.Size, incoming.SymbolName) " +
+             "ORDER BY FirstSymbolID");
 
-        mergedCommand.Parameters.Clear();
-        mergedCommand.Parameters.AddWithValue("@BinaryID", 0);
-        mergedCommand.Parameters.AddWithValue("@SymbolID", 0);
-        mergedCommand.Parameters.AddWithValue("@WastedSize", 0);
+        ExecuteMergeStatement(mergedCommand, "DELETE FROM temp.SymbolIDMappings");
+        ExecuteMergeStatement(mergedCommand,
+             "INSERT INTO temp.SymbolIDMappings (BatchSymbolID, MergedSymbolID) " +
+            $"SELECT incoming.SymbolID, merged.SymbolID FROM batch.{_SymbolsTableName} AS incoming " +
+            $"INNER JOIN main.{_SymbolsTableName} AS merged ON merged.Size = incoming.Size AND merged.SymbolName = incoming.SymbolName");
 
-        while (reader.Read())
+        if (AttachedDatabaseHasTable(mergedCommand, _DuplicateDataTableName))
         {
-            mergedCommand.Parameters["@BinaryID"].Value = binaryIDMappings[Convert.ToInt32(reader["BinaryID"], CultureInfo.InvariantCulture)];
-            mergedCommand.Parameters["@SymbolID"].Value = symbolIDMappings[Convert.ToInt32(reader["SymbolID"], CultureInfo.InvariantCulture)];
-            mergedCommand.Parameters["@WastedSize"].Value = reader["WastedSize"];
-            mergedCommand.ExecuteNonQuery();
+            ExecuteMergeStatement(mergedCommand,
+                $"INSERT INTO main.{_DuplicateDataTableName} (BinaryID, SymbolID, WastedSize) " +
+                $"SELECT ddi.BinaryID + @BinaryIDOffset, mappings.MergedSymbolID, ddi.WastedSize FROM batch.{_DuplicateDataTableName} AS ddi " +
+                 "INNER JOIN temp.SymbolIDMappings AS mappings ON mappings.BatchSymbolID = ddi.SymbolID ORDER BY ddi.DuplicateDataID");
         }
-    }
 
-    private static SortedList<int, int> MergeInWastefulVirtualTypesTable(SqliteCommand mergedCommand, SqliteCommand mergedSelect_last_rowidCommand,
-                                                                         SqliteConnection connectionToOneBatch, SortedList<int, int> binaryIDMappings)
-    {
-        var wvTypeIDMappings = new SortedList<int, int>(capacity: 1000);
-        using (var queryWVTypes = connectionToOneBatch.CreateCommand())
+        if (AttachedDatabaseHasTable(mergedCommand, _WastefulVirtualsTypeTableName))
         {
-            queryWVTypes.CommandText = "SELECT * FROM WastefulVirtualTypes ORDER BY WastefulVirtualTypeID";
-            var reader = queryWVTypes.ExecuteReader();
-
-            mergedCommand.CommandText = "INSERT INTO WastefulVirtualTypes " +
-                                        "(BinaryID, TypeName, IsCOMType, WastePerSlot, WastedSize) " +
-                                        "VALUES " +
-                                        "(@BinaryID, @TypeName, @IsCOMType, @WastePerSlot, @WastedSize)";
-
-            mergedCommand.Parameters.Clear();
-            mergedCommand.Parameters.AddWithValue("@BinaryID", 0);
-            mergedCommand.Parameters.AddWithValue("@TypeName", String.Empty);
-            mergedCommand.Parameters.AddWithValue("@IsCOMType", 0);
-            mergedCommand.Parameters.AddWithValue("@WastePerSlot", 0);
-            mergedCommand.Parameters.AddWithValue("@WastedSize", 0);
-
-            while (reader.Read())
-            {
-                mergedCommand.Parameters["@BinaryID"].Value = binaryIDMappings[Convert.ToInt32(reader["BinaryID"], CultureInfo.InvariantCulture)];
-                mergedCommand.Parameters["@TypeName"].Value = reader["TypeName"];
-                mergedCommand.Parameters["@IsCOMType"].Value = reader["IsCOMType"];
-                mergedCommand.Parameters["@WastePerSlot"].Value = reader["WastePerSlot"];
-                mergedCommand.Parameters["@WastedSize"].Value = reader["WastedSize"];
-                mergedCommand.ExecuteNonQuery();
-
-                wvTypeIDMappings.Add(Convert.ToInt32(reader["WastefulVirtualTypeID"], CultureInfo.InvariantCulture),
-                                     Convert.ToInt32(mergedSelect_last_rowidCommand.ExecuteScalar(), CultureInfo.InvariantCulture));
-            }
-        }
+            ExecuteMergeStatement(mergedCommand,
+                $"INSERT INTO main.{_WastefulVirtualsTypeTableName} (WastefulVirtualTypeID, BinaryID, TypeName, IsCOMType, WastePerSlot, WastedSize) " +
+                $"SELECT WastefulVirtualTypeID + @WastefulVirtualTypeIDOffset, BinaryID + @BinaryIDOffset, TypeName, IsCOMType, WastePerSlot, WastedSize " +
+                $"FROM batch.{_WastefulVirtualsTypeTableName} ORDER BY WastefulVirtualTypeID");
 
-        return wvTypeIDMappings;
-    }
+            ExecuteMergeStatement(mergedCommand,
+                $"INSERT INTO main.{_WastefulVirtualsFunctionTableName} (WastefulVirtualTypeID, FunctionName, WastedSize) " +
+                $"SELECT WastefulVirtualTypeID + @WastefulVirtualTypeIDOffset, FunctionName, WastedSize FROM batch.{_WastefulVirtualsFunctionTableName} ORDER BY WastefulVirtualFunctionID");
+        }
 
-    private static void MergInWastefulVirtualFunctionsTable(SqliteCommand mergedCommand, SqliteConnection connectionToOneBatch, SortedList<int, int> wvTypeIDMappings)
-    {
-        using var queryWVFunctions = connectionToOneBatch.CreateCommand();
-        queryWVFunctions.CommandText = "SELECT * FROM WastefulVirtualFunctions";
-        var reader = queryWVFunctions.ExecuteReader();
+        ExecuteMergeStatement(mergedCommand,
+            $"INSERT INTO main.{_AnnotationsTableName} (BinaryID, SourceFileID, LineNumber, IsInlinedOrAnnotatingInlineSite, AnnotationText) " +
+            $"SELECT BinaryID + @BinaryIDOffset, SourceFileID + @SourceFileIDOffset, LineNumber, IsInlinedOrAnnotatingInlineSite, AnnotationText FROM batch.{_AnnotationsTableName} ORDER BY AnnotationID");
 
-        mergedCommand.CommandText = "INSERT INTO WastefulVirtualFunctions " +
-                                    "(WastefulVirtualTypeID, FunctionName, WastedSize) " +
-                                    "VALUES " +
-                                    "(@WastefulVirtualTypeID, @FunctionName, @WastedSize)";
+        if (AttachedDatabaseHasTable(mergedCommand, _SymbolLocationsTableName))
+        {
+            ExecuteMergeStatement(mergedCommand,
+                $"INSERT INTO main.{_SymbolLocationsTableName} (BinaryCompilandID, SourceFileID, SymbolID) " +
+                $"SELECT locations.BinaryCompilandID + @CompilandIDOffset, locations.SourceFileID + @SourceFileIDOffset, mappings.MergedSymbolID FROM batch.{_SymbolLocationsTableName} AS locations " +
+                 "INNER JOIN temp.SymbolIDMappings AS mappings ON mappings.BatchSymbolID = locations.SymbolID ORDER BY locations.SymbolLocationID");
+        }
 
-        mergedCommand.Parameters.Clear();
-        mergedCommand.Parameters.AddWithValue("@WastefulVirtualTypeID", 0);
-        mergedCommand.Parameters.AddWithValue("@FunctionName", String.Empty);
-        mergedCommand.Parameters.AddWithValue("@WastedSize", 0);
+        ExecuteMergeStatement(mergedCommand,
+            $"INSERT INTO main.{_PerfStatsTable} (BinaryID, OpeningTookMs, SectionsTookMs, LibsTookMs, SourceFilesTookMs, DDITookMs, WVITookMs, AnnotationsTookMs, SymbolsInCompilandsTookMs) " +
+            $"SELECT BinaryID + @BinaryIDOffset, OpeningTookMs, SectionsTookMs, LibsTookMs, SourceFilesTookMs, DDITookMs, WVITookMs, AnnotationsTookMs, SymbolsInCompilandsTookMs FROM batch.{_PerfStatsTable}");
 
-        while (reader.Read())
+        // Databases from before the manifest existed just won't have anything to carry forward into the next crawl.
+        if (AttachedDatabaseHasTable(mergedCommand, CrawlManifest.TableName))
         {
-            mergedCommand.Parameters["@WastefulVirtualTypeID"].Value = wvTypeIDMappings[Convert.ToInt32(reader["WastefulVirtualTypeID"], CultureInfo.InvariantCulture)];
-            mergedCommand.Parameters["@FunctionName"].Value = reader["FunctionName"];
-            mergedCommand.Parameters["@WastedSize"].Value = reader["WastedSize"];
-            mergedCommand.ExecuteNonQuery();
+            ExecuteMergeStatement(mergedCommand,
+                $"INSERT INTO main.{CrawlManifest.TableName} (BinaryID, PdbGuid, PdbAge, BinarySHA256, CrawlOptions) " +
+                $"SELECT BinaryID + @BinaryIDOffset, PdbGuid, PdbAge, BinarySHA256, CrawlOptions FROM batch.{CrawlManifest.TableName}");
         }
+
+        ExecuteMergeStatement(mergedCommand,
+            $"INSERT INTO main.{_ErrorsTableName} (BinaryID, ExceptionType, ExceptionMessage, ExceptionDetails) " +
+            $"SELECT BinaryID + @BinaryIDOffset, ExceptionType, ExceptionMessage, ExceptionDetails FROM batch.{_ErrorsTableName} ORDER BY ErrorID");
     }
 
-    private static SortedList<int, int> MergeInSourceFilesTable(SqliteCommand mergedCommand, SqliteCommand mergedSelect_last_rowidCommand,
-                                                                SqliteConnection connectionToOneBatch,
-                                                                SortedList<int, int> binaryIDMappings)
+    // Copies everything the previous crawl recorded about the unchanged binaries into a new database with the merged schema, named like a
+    // batch database so that it's merged along with the batches.  Batch numbers start at 1, so batch 0 is free, and it sorts first so the
+    // carried-forward binaries end up with the lowest IDs.  IDs are copied as they are - merging offsets them anyway, so the gaps left by
+    // binaries that weren't carried forward don't matter.
+    private static void CarryForwardFromPreviousCrawl(CrawlFolderArguments crawlArgs, List<long> unchangedBinaryIDs)
     {
-        var sourceFileIDMappings = new SortedList<int, int>(capacity: 1000);
+        var carriedForwardDbFileName = Path.Combine(crawlArgs.OutputFolder, $"SizeBench.SKUCrawler-{crawlArgs.TimestampOfMaster}-batch0.db");
+        Console.Out.WriteLine($"Carrying forward {unchangedBinaryIDs.Count} unchanged binaries into {Path.GetFileName(carriedForwardDbFileName)}");
+        CreateMergedDb(carriedForwardDbFileName);
 
-        using (var querySourceFiles = connectionToOneBatch.CreateCommand())
+        using var connection = new SqliteConnection(new SqliteConnectionStringBuilder()
         {
-            querySourceFiles.CommandText = $"SELECT * FROM {_SourceFilesTableName} ORDER BY SourceFileID";
-            var reader = querySourceFiles.ExecuteReader();
-
-            mergedCommand.CommandText = $"INSERT INTO {_SourceFilesTableName} " +
-                                         "(BinaryID, SourceFileName, Size) " +
-                                         "VALUES " +
-                                         "(@BinaryID, @SourceFileName, @Size)";
+            DataSource = carriedForwardDbFileName,
+            Pooling = false
+        }.ToString());
+        connection.Open();
 
-            mergedCommand.Parameters.Clear();
-            mergedCommand.Parameters.AddWithValue("@BinaryID", 0);
-            mergedCommand.Parameters.AddWithValue("@SourceFileName", String.Empty);
-            mergedCommand.Parameters.AddWithValue("@Size", 0);
-
-            while (reader.Read())
-            {
-                mergedCommand.Parameters["@BinaryID"].Value = binaryIDMappings[Convert.ToInt32(reader["BinaryID"], CultureInfo.InvariantCulture)];
-                mergedCommand.Parameters["@SourceFileName"].Value = reader["SourceFileName"];
-                mergedCommand.Parameters["@Size"].Value = reader["Size"];
-                mergedCommand.ExecuteNonQuery();
-
-                sourceFileIDMappings.Add(Convert.ToInt32(reader["SourceFileID"], CultureInfo.InvariantCulture),
-                                         Convert.ToInt32(mergedSelect_last_rowidCommand.ExecuteScalar(), CultureInfo.InvariantCulture));
-            }
+        using (var setupCommand = connection.CreateCommand())
+        {
+            setupCommand.CommandText = "PRAGMA journal_mode = MEMORY; " +
+                                       "PRAGMA synchronous = OFF; " +
+                                       "CREATE TEMP TABLE CarriedForwardBinaries (BinaryID INTEGER PRIMARY KEY);";
+            setupCommand.ExecuteNonQuery();
         }
 
-        return sourceFileIDMappings;
-    }
-
-    private static void MergeInAnnotationsTable(SqliteCommand mergedCommand, SqliteConnection connectionToOneBatch,
-                                                SortedList<int, int> binaryIDMappings, SortedList<int, int> sourceFileIDMappings)
-    {
-        using var queryAnnotations = connectionToOneBatch.CreateCommand();
-        queryAnnotations.CommandText = $"SELECT * FROM {_AnnotationsTableName}";
-        var reader = queryAnnotations.ExecuteReader();
-
-        mergedCommand.CommandText = $"INSERT INTO {_AnnotationsTableName} " +
-                                     "(BinaryID, SourceFileID, LineNumber, IsInlinedOrAnnotatingInlineSite, AnnotationText) " +
-                                     "VALUES " +
-                                     "(@BinaryID, @SourceFileID, @LineNumber, @IsInlinedOrAnnotatingInlineSite, @AnnotationText) ";
-
-        mergedCommand.Parameters.Clear();
-        mergedCommand.Parameters.AddWithValue("@BinaryID", 0);
-        mergedCommand.Parameters.AddWithValue("@SourceFileID", 0);
-        mergedCommand.Parameters.AddWithValue("@LineNumber", 0);
-        mergedCommand.Parameters.AddWithValue("@IsInlinedOrAnnotatingInlineSite", 0);
-        mergedCommand.Parameters.AddWithValue("@AnnotationText", String.Empty);
-
-        while (reader.Read())
+        using (var attachCommand = connection.CreateCommand())
         {
-            mergedCommand.Parameters["@BinaryID"].Value = binaryIDMappings[Convert.ToInt32(reader["BinaryID"], CultureInfo.InvariantCulture)];
-            mergedCommand.Parameters["@SourceFileID"].Value = sourceFileIDMappings[Convert.ToInt32(reader["SourceFileID"], CultureInfo.InvariantCulture)];
-            mergedCommand.Parameters["@LineNumber"].Value = reader["LineNumber"];
-            mergedCommand.Parameters["@IsInlinedOrAnnotatingInlineSite"].Value = reader["IsInlinedOrAnnotatingInlineSite"];
-            mergedCommand.Parameters["@AnnotationText"].Value = reader["AnnotationText"];
-            mergedCommand.ExecuteNonQuery();
+            attachCommand.CommandText = "ATTACH DATABASE @FileName AS previous";
+            attachCommand.Parameters.AddWithValue("@FileName", crawlArgs.PreviousCrawlDatabase);
+            attachCommand.ExecuteNonQuery();
         }
-    }
 
-    private static SortedList<int, int> MergeInSymbolsTable(SqliteCommand mergedCommand, SqliteCommand mergedSelect_last_rowidCommand,
-                                                            SqliteConnection connectionToOneBatch,
-                                                            SortedList<int, SortedList<string, int>> symbolSizeAndNameToMergedDatabaseIDs)
-    {
-        var symbolIDMappingsFromBatchToMerged = new SortedList<int, int>(capacity: 10000);
-
-        using var querySymbols = connectionToOneBatch.CreateCommand();
-        querySymbols.CommandText = $"SELECT * FROM {_SymbolsTableName} ORDER BY SymbolID";
-        var reader = querySymbols.ExecuteReader();
-
-        mergedCommand.CommandText = $"INSERT INTO {_SymbolsTableName} " +
-                                     "(SymbolName, SymbolDetemplatedName, Size) " +
-                                     "VALUES " +
-                                     "(@SymbolName, @SymbolDetemplatedName, @Size)";
-
-        mergedCommand.Parameters.Clear();
-        mergedCommand.Parameters.AddWithValue("@SymbolName", String.Empty);
-        mergedCommand.Parameters.AddWithValue("@SymbolDetemplatedName", String.Empty);
-        mergedCommand.Parameters.AddWithValue("@Size", 0);
-
-        while (reader.Read())
+        using (var transaction = connection.BeginTransaction())
         {
-            var symbolName = (string)reader["SymbolName"];
-            var symbolSize = Convert.ToInt32(reader["Size"], CultureInfo.InvariantCulture);
-            var symbolIDInBatchDB = Convert.ToInt32(reader["SymbolID"], CultureInfo.InvariantCulture);
+            using var command = connection.CreateCommand();
+            command.Transaction = transaction;
 
-            // First we need to find the symbol's name and size from the batch, to see if a previous binary in the merged DB may have already written this, to re-use its ID as we merge.
-            if (symbolSizeAndNameToMergedDatabaseIDs.TryGetValue(symbolSize, out var symbolsOfThatSize))
+            command.CommandText = "INSERT INTO temp.CarriedForwardBinaries (BinaryID) VALUES (@BinaryID)";
+            var binaryIDParameter = command.Parameters.AddWithValue("@BinaryID", 0L);
+            foreach (var binaryID in unchangedBinaryIDs)
             {
-                if (symbolsOfThatSize.TryGetValue(symbolName, out var symbolIDInMergedDB))
-                {
-                    symbolIDMappingsFromBatchToMerged.Add(symbolIDInBatchDB, symbolIDInMergedDB);
-                    continue;
-                }
+                binaryIDParameter.Value = binaryID;
+                command.ExecuteNonQuery();
             }
 
-            // No symbol with this name and size exists, so we'll insert it now.  This keeps the database from having tons of copies of the SymbolName string, and makes it easier
-            // to query across binaries for like symbols, when looking for SKU-wide opportunities across binaries and files.
-            mergedCommand.Parameters["@SymbolName"].Value = symbolName;
-            mergedCommand.Parameters["@SymbolDetemplatedName"].Value = reader["SymbolDetemplatedName"];
-            mergedCommand.Parameters["@Size"].Value = symbolSize;
-            mergedCommand.ExecuteNonQuery();
+            const string isCarriedForwardBinary = "BinaryID IN (SELECT BinaryID FROM temp.CarriedForwardBinaries)";
+            CopyRowsFromPreviousCrawl(command, _BinariesTable, "BinaryID, Name, Size", isCarriedForwardBinary);
+            CopyRowsFromPreviousCrawl(command, _PerfStatsTable, "BinaryID, OpeningTookMs, SectionsTookMs, LibsTookMs, SourceFilesTookMs, DDITookMs, WVITookMs, AnnotationsTookMs, SymbolsInCompilandsTookMs", isCarriedForwardBinary);
+            CopyRowsFromPreviousCrawl(command, _SectionTableName, "BinarySectionID, BinaryID, SectionName, Size, VirtualSize", isCarriedForwardBinary);
+            CopyRowsFromPreviousCrawl(command, _COFFGroupTableName, "BinaryCOFFGroupID, BinaryID, BinarySectionID, COFFGroupName, Size, VirtualSize", isCarriedForwardBinary);
+            CopyRowsFromPreviousCrawl(command, _LibsTableName, "BinaryLibID, BinaryID, LibName, Size", isCarriedForwardBinary);
+            CopyRowsFromPreviousCrawl(command, _CompilandsTableName, "BinaryCompilandID, BinaryID, BinaryLibID, CompilandName, Size, CommandLine, RTTIEnabled, Language, FrontEndVersion, BackEndVersion", isCarriedForwardBinary);
+            CopyRowsFromPreviousCrawl(command, _SourceFilesTableName, "SourceFileID, BinaryID, SourceFileName, Size", isCarriedForwardBinary);
+            CopyRowsFromPreviousCrawl(command, _AnnotationsTableName, "AnnotationID, BinaryID, SourceFileID, LineNumber, IsInlinedOrAnnotatingInlineSite, AnnotationText", isCarriedForwardBinary);
+            CopyRowsFromPreviousCrawl(command, _DuplicateDataTableName, "DuplicateDataID, BinaryID, SymbolID, WastedSize", isCarriedForwardBinary);
+            CopyRowsFromPreviousCrawl(command, _WastefulVirtualsTypeTableName, "WastefulVirtualTypeID, BinaryID, TypeName, IsCOMType, WastePerSlot, WastedSize", isCarriedForwardBinary);
+            CopyRowsFromPreviousCrawl(command, CrawlManifest.TableName, "BinaryID, PdbGuid, PdbAge, BinarySHA256, CrawlOptions", isCarriedForwardBinary);
+
+            // These tables don't have a BinaryID, so they're found through the rows that were just copied, and only the symbols those refer to are kept.
+            CopyRowsFromPreviousCrawl(command, _WastefulVirtualsFunctionTableName, "WastefulVirtualFunctionID, WastefulVirtualTypeID, FunctionName, WastedSize",
+                                      $"WastefulVirtualTypeID IN (SELECT WastefulVirtualTypeID FROM main.{_WastefulVirtualsTypeTableName})");
+            CopyRowsFromPreviousCrawl(command, _SymbolLocationsTableName, "SymbolLocationID, BinaryCompilandID, SourceFileID, SymbolID",
+                                      $"BinaryCompilandID IN (SELECT BinaryCompilandID FROM main.{_CompilandsTableName})");
+            CopyRowsFromPreviousCrawl(command, _SymbolsTableName, "SymbolID, SymbolName, SymbolDetemplatedName, Size",
+                                      $"SymbolID IN (SELECT SymbolID FROM main.{_DuplicateDataTableName} UNION SELECT SymbolID FROM main.{_SymbolLocationsTableName})");
 
-            symbolIDMappingsFromBatchToMerged.Add(Convert.ToInt32(reader["SymbolID"], CultureInfo.InvariantCulture),
-                                                  Convert.ToInt32(mergedSelect_last_rowidCommand.ExecuteScalar(), CultureInfo.InvariantCulture));
+            transaction.Commit();
         }
 
-        return symbolIDMappingsFromBatchToMerged;
+        using (var detachCommand = connection.CreateCommand())
+        {
+            detachCommand.CommandText = "DETACH DATABASE previous";
+            detachCommand.ExecuteNonQuery();
+        }
     }
 
-    private static void MergeInCompilandSymbolsTable(SqliteCommand mergedCommand, SqliteConnection connectionToOneBatch,
-                                                     SortedList<int, int> symbolIDMappings, SortedList<int, int> compilandIDMappings,
-                                                     SortedList<int, int> sourceFileIDMappings)
-    {
-        using var queryCompilandSymbols = connectionToOneBatch.CreateCommand();
-        queryCompilandSymbols.CommandText = $"SELECT * FROM {_SymbolLocationsTableName}";
-        var reader = queryCompilandSymbols.ExecuteReader();
-
-        mergedCommand.CommandText = $"INSERT INTO {_SymbolLocationsTableName} " +
-                                     "(BinaryCompilandID, SourceFileID, SymbolID) " +
-                                     "VALUES " +
-                                     "(@BinaryCompilandID, @SourceFileID, @SymbolID)";
+    private static void CopyRowsFromPreviousCrawl(SqliteCommand command, string tableName, string columns, string whereClause)
+        => ExecuteMergeStatement(command, $"INSERT INTO main.{tableName} ({columns}) SELECT {columns} FROM previous.{tableName} WHERE {whereClause}");
 
-        mergedCommand.Parameters.Clear();
-        mergedCommand.Parameters.AddWithValue("@BinaryCompilandID", 0);
-        mergedCommand.Parameters.AddWithValue("@SourceFileID", 0);
-        mergedCommand.Parameters.AddWithValue("@SymbolID", 0);
-
-        while (reader.Read())
-        {
-            mergedCommand.Parameters["@BinaryCompilandID"].Value = compilandIDMappings[Convert.ToInt32(reader["BinaryCompilandID"], CultureInfo.InvariantCulture)];
-            mergedCommand.Parameters["@SourceFileID"].Value = sourceFileIDMappings[Convert.ToInt32(reader["SourceFileID"], CultureInfo.InvariantCulture)];
-            mergedCommand.Parameters["@SymbolID"].Value = symbolIDMappings[Convert.ToInt32(reader["SymbolID"], CultureInfo.InvariantCulture)];
+    private static void ExecuteMergeStatement(SqliteCommand mergedCommand, string commandText)
+    {
+        mergedCommand.CommandText = commandText;
+        mergedCommand.ExecuteNonQuery();
+    }
 
-            mergedCommand.ExecuteNonQuery();
-        }
+    private static long GetLargestID(SqliteCommand mergedCommand, string tableName, string idColumnName)
+    {
+        mergedCommand.CommandText = $"SELECT COALESCE(MAX({idColumnName}), 0) FROM main.{tableName}";
+        return Convert.ToInt64(mergedCommand.ExecuteScalar(), CultureInfo.InvariantCulture);
     }
 
-    private static void MergeInPerfStatsTable(SqliteCommand mergedCommand, SqliteConnection connectionToOneBatch, SortedList<int, int> binaryIDMappings)
+    private static bool AttachedDatabaseHasTable(SqliteCommand mergedCommand, string tableName)
     {
-        using var queryPerfStats = connectionToOneBatch.CreateCommand();
-        queryPerfStats.CommandText = "SELECT * FROM PerfStats";
-        var reader = queryPerfStats.ExecuteReader();
-
-        mergedCommand.CommandText = "INSERT INTO PerfStats " +
-                                    "(BinaryID, OpeningTookMs, SectionsTookMs, LibsTookMs, SourceFilesTookMs, DDITookMs, WVITookMs, AnnotationsTookMs, SymbolsInCompilandsTookMs) " +
-                                    "VALUES " +
-                                    "(@BinaryID, @OpeningTookMs, @SectionsTookMs, @LibsTookMs, @SourceFilesTookMs, @DDITookMs, @WVITookMs, @AnnotationsTookMs, @SymbolsInCompilandsTookMs)";
-
-        mergedCommand.Parameters.Clear();
-        mergedCommand.Parameters.AddWithValue("@BinaryID", 0);
-        mergedCommand.Parameters.AddWithValue("@OpeningTookMs", 0);
-        mergedCommand.Parameters.AddWithValue("@SectionsTookMs", 0);
-        mergedCommand.Parameters.AddWithValue("@LibsTookMs", 0);
-        mergedCommand.Parameters.AddWithValue("@SourceFilesTookMs", 0);
-        mergedCommand.Parameters.AddWithValue("@DDITookMs", 0);
-        mergedCommand.Parameters.AddWithValue("@WVITookMs", 0);
-        mergedCommand.Parameters.AddWithValue("@AnnotationsTookMs", 0);
-        mergedCommand.Parameters.AddWithValue("@SymbolsInCompilandsTookMs", 0);
-
-        while (reader.Read())
-        {
-            mergedCommand.Parameters["@BinaryID"].Value = binaryIDMappings[Convert.ToInt32(reader["BinaryID"], CultureInfo.InvariantCulture)];
-            mergedCommand.Parameters["@OpeningTookMs"].Value = reader["OpeningTookMs"];
-            mergedCommand.Parameters["@SectionsTookMs"].Value = reader["SectionsTookMs"];
-            mergedCommand.Parameters["@LibsTookMs"].Value = reader["LibsTookMs"];
-            mergedCommand.Parameters["@SourceFilesTookMs"].Value = reader["SourceFilesTookMs"];
-            mergedCommand.Parameters["@DDITookMs"].Value = reader["DDITookMs"];
-            mergedCommand.Parameters["@WVITookMs"].Value = reader["WVITookMs"];
-            mergedCommand.Parameters["@AnnotationsTookMs"].Value = reader["AnnotationsTookMs"];
-            mergedCommand.Parameters["@SymbolsInCompilandsTookMs"].Value = reader["SymbolsInCompilandsTookMs"];
-            mergedCommand.ExecuteNonQuery();
-        }
+        // Table names are built into the SQL rather than passed as a parameter, so that the offset parameters on this command are left alone.
+        mergedCommand.CommandText = $"SELECT COUNT(*) FROM batch.sqlite_master WHERE type = 'table' AND tbl_name = '{tableName}'";
+        return Convert.ToInt64(mergedCommand.ExecuteScalar(), CultureInfo.InvariantCulture) > 0;
     }
 
-    private static void MergeInErrorsTable(SqliteCommand mergedCommand, SqliteConnection connectionToOneBatch, SortedList<int, int> binaryIDMappings)
+    private static void AddIndexesToMergedDb(string mergedDbFileName)
     {
-        using var queryPerfStats = connectionToOneBatch.CreateCommand();
-        queryPerfStats.CommandText = $"SELECT * FROM {_ErrorsTableName}";
-        var reader = queryPerfStats.ExecuteReader();
-
-        mergedCommand.CommandText = $"INSERT INTO {_ErrorsTableName} " +
-                                     "(BinaryID, ExceptionType, ExceptionMessage, ExceptionDetails) " +
-                                     "VALUES " +
-                                     "(@BinaryID, @ExceptionType, @ExceptionMessage, @ExceptionDetails)";
-
-        mergedCommand.Parameters.Clear();
-        mergedCommand.Parameters.AddWithValue("@BinaryID", 0);
-        mergedCommand.Parameters.AddWithValue("@ExceptionType", String.Empty);
-        mergedCommand.Parameters.AddWithValue("@ExceptionMessage", String.Empty);
-        mergedCommand.Parameters.AddWithValue("@ExceptionDetails", String.Empty);
-
-        while (reader.Read())
+        using var connectionToMerged = new SqliteConnection(new SqliteConnectionStringBuilder()
         {
-            mergedCommand.Parameters["@BinaryID"].Value = binaryIDMappings[Convert.ToInt32(reader["BinaryID"], CultureInfo.InvariantCulture)];
-            mergedCommand.Parameters["@ExceptionType"].Value = reader["ExceptionType"];
-            mergedCommand.Parameters["@ExceptionMessage"].Value = reader["ExceptionMessage"];
-            mergedCommand.Parameters["@ExceptionDetails"].Value = reader["ExceptionDetails"];
-            mergedCommand.ExecuteNonQuery();
+            DataSource = mergedDbFileName,
+            Pooling = false
+        }.ToString());
+        connectionToMerged.Open();
+
+        const string indexesToCreate = @"
+                    CREATE INDEX[IX_Binaries_Name] ON[Binaries](Name);
+                    CREATE INDEX[IX_COFFGroups_BinaryIDBinarySectionID] ON[COFFGroups](BinaryID, BinarySectionID);
+                    CREATE INDEX[IX_COFFGroups_COFFGroupNameBinaryID] ON[COFFGroups](COFFGroupName, BinaryID);
+                    CREATE INDEX[IX_COFFGroups_BinaryID] ON[COFFGroups](BinaryID);
+                    CREATE INDEX[IX_Compilands_CompilandNameBinaryID] ON[Compilands](CompilandName, BinaryID);
+                    CREATE INDEX[IX_Compilands_BinaryLibIDCompilandName] ON[Compilands](BinaryLibID, CompilandName);
+                    CREATE INDEX[IX_Libs_BinaryIDLibName] ON[Libs](BinaryID, LibName);
+                    CREATE INDEX[IX_Libs_LibName] ON[Libs](LibName);
+                    CREATE INDEX[IX_Sections_BinaryIDSectionName] ON[Sections](BinaryID, SectionName);
+                    CREATE INDEX[IX_Sections_SectionName] ON[Sections](SectionName);";
+
+        using var transaction = connectionToMerged.BeginTransaction();
+        using (var commandToAddIndexes = new SqliteCommand(indexesToCreate, connectionToMerged, transaction))
+        {
+            commandToAddIndexes.ExecuteNonQuery();
         }
+
+        transaction.Commit();
     }
 
     #endregion
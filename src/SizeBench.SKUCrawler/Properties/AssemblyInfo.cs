@@ -1,2 +1,4 @@
-﻿
+﻿using System.Runtime.CompilerServices;
+
 [assembly: CLSCompliant(false)]
+[assembly: InternalsVisibleTo("SizeBench.SKUCrawler.Tests")]
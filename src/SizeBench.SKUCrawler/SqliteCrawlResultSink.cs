@@ -0,0 +1,888 @@
+﻿using System.Globalization;
+using System.IO;
+using Microsoft.Data.Sqlite;
+using SizeBench.AnalysisEngine;
+using SizeBench.AnalysisEngine.Symbols;
+using SizeBench.Logging;
+
+namespace SizeBench.SKUCrawler;
+
+// One SQLite database per batch, which is what the master process merges together at the end of a crawl.  Every row is its own INSERT,
+// but they all go through one transaction so the database is only written to disk once, when the batch completes.
+//
+// With no rollback journal on disk, a worker that's killed part way through can leave a database with some pages written and others not.
+// So the database is written under another name, and only moved to OutputPath once the transaction has committed - anything under the
+// in-progress name is from a worker that never finished it, and is never merged.
+internal sealed class SqliteCrawlResultSink : ICrawlResultSink
+{
+    private readonly string _logFilenameBase;
+    private SqliteConnection? _connection;
+    private SqliteTransaction? _transaction;
+
+    public string BinaryRoot { get; }
+    public bool IncludeWastefulVirtuals { get; }
+    public bool IncludeCodeSymbols { get; }
+    public bool IncludeDuplicateDataItems { get; }
+
+    public string OutputPath => $"{this._logFilenameBase}.db";
+
+    private string InProgressPath => this.OutputPath + ".inprogress";
+
+    public SqliteCrawlResultSink(string logFilenameBase, string binaryRoot, bool includeWastefulVirtuals, bool includeCodeSymbols, bool includeDuplicateDataItems)
+    {
+        this._logFilenameBase = logFilenameBase;
+        this.BinaryRoot = binaryRoot;
+        this.IncludeWastefulVirtuals = includeWastefulVirtuals;
+        this.IncludeCodeSymbols = includeCodeSymbols;
+        this.IncludeDuplicateDataItems = includeDuplicateDataItems;
+    }
+
+    public void Open(ILogger logger)
+    {
+        EnsureDatabaseCreated(logger);
+
+        this._connection = new SqliteConnection(ConnectionString);
+        this._connection.Open();
+
+        {
+            // Disable on-disk journaling for perf
+            using var pragmaCommand = this._connection.CreateCommand();
+            pragmaCommand.CommandText = "PRAGMA journal_mode = MEMORY;";
+            pragmaCommand.ExecuteNonQuery();
+        }
+
+        this._transaction = this._connection.BeginTransaction();
+    }
+
+    public void Write(IReadOnlyList<ProductBinaryAnalysisResults> results, ILogger logger)
+    {
+        if (this._connection is null || this._transaction is null)
+        {
+            throw new InvalidOperationException("The database must be opened before writing to it.  This is a bug in SizeBench's implementation, not your usage of it.");
+        }
+
+        var connection = this._connection;
+        var transaction = this._transaction;
+        foreach (var databaseWrite in results)
+        {
+            try
+            {
+                var compilandsToDatabaseIDs = new Dictionary<Compiland, int>();
+                var symbolsToDatabaseIDs = new Dictionary<uint, Dictionary<string, int>>();
+
+                var binaryID = InsertBinary(connection, transaction, databaseWrite);
+
+                InsertPerfStats(connection, transaction, binaryID, databaseWrite);
+
+                if (databaseWrite.sections != null)
+                {
+                    foreach (var section in databaseWrite.sections)
+                    {
+                        InsertSectionAndCOFFGroupsInThatSection(connection, transaction, binaryID, section);
+                    }
+                }
+
+                if (databaseWrite.libs != null)
+                {
+                    foreach (var lib in databaseWrite.libs)
+                    {
+                        InsertLibAndCompilands(connection, transaction, binaryID, lib, compilandsToDatabaseIDs);
+                    }
+                }
+
+                var sourceFilesToDatabaseIDs = new Dictionary<SourceFile, int>();
+
+                // We need to establish an ID for the 'null' source file since some annotations do not have a source file but still need to
+                // get their foreign key set up.
+                var sourceFileNullID = -1;
+
+                if (databaseWrite.sourceFiles != null)
+                {
+                    sourceFileNullID = InsertSourceFile(connection, transaction, binaryID, null, sourceFilesToDatabaseIDs);
+
+                    foreach (var sf in databaseWrite.sourceFiles)
+                    {
+                        InsertSourceFile(connection, transaction, binaryID, sf, sourceFilesToDatabaseIDs);
+                    }
+                }
+
+                if (this.IncludeDuplicateDataItems && databaseWrite.duplicateDataItems != null)
+                {
+                    foreach (var ddi in databaseWrite.duplicateDataItems)
+                    {
+                        InsertDuplicateDataItem(connection, transaction, binaryID, symbolsToDatabaseIDs, ddi);
+                    }
+                }
+
+                if (this.IncludeWastefulVirtuals && databaseWrite.wastefulVirtualItems != null)
+                {
+                    foreach (var wvi in databaseWrite.wastefulVirtualItems)
+                    {
+                        InsertWastefulVirtualItems(connection, transaction, binaryID, wvi);
+                    }
+                }
+
+                if (databaseWrite.annotations != null)
+                {
+                    foreach (var annotation in databaseWrite.annotations)
+                    {
+                        InsertAnnotation(connection, transaction, binaryID, sourceFilesToDatabaseIDs, sourceFileNullID, annotation);
+                    }
+                }
+
+                if (this.IncludeCodeSymbols && databaseWrite.codeSymbolsInAllSourceFiles != null)
+                {
+                    foreach (var symbolsInCompilandAndSourceFile in databaseWrite.codeSymbolsInAllSourceFiles)
+                    {
+                        InsertSymbolsInSourceFileAndCompiland(connection, transaction,
+                                                              compilandsToDatabaseIDs[symbolsInCompilandAndSourceFile.Key.compiland],
+                                                              sourceFilesToDatabaseIDs[symbolsInCompilandAndSourceFile.Key.sourceFile],
+                                                              symbolsToDatabaseIDs, symbolsInCompilandAndSourceFile.Value);
+                    }
+                }
+
+                if (databaseWrite.manifestEntry != null)
+                {
+                    InsertManifestEntry(connection, transaction, binaryID, databaseWrite.manifestEntry);
+                }
+
+                if (databaseWrite.errorDuringProcessing != null)
+                {
+                    InsertError(connection, transaction, binaryID, databaseWrite.errorDuringProcessing);
+                }
+            }
+#pragma warning disable CA1031 // Do not catch general exception types - if we throw trying to write one binary, maybe we can still write most of them, let's keep going
+            catch (Exception ex)
+#pragma warning restore CA1031 // Do not catch general exception types
+            {
+                Program.LogExceptionAndReportToStdErr("Database write threw an exception!", ex, logger);
+            }
+        }
+    }
+
+    public void Complete(ILogger logger)
+    {
+        if (this._connection is null || this._transaction is null)
+        {
+            throw new InvalidOperationException("The database must be opened before completing it.  This is a bug in SizeBench's implementation, not your usage of it.");
+        }
+
+        this._transaction.Commit();
+        this._transaction.Dispose();
+        this._transaction = null;
+        this._connection.Dispose();
+        this._connection = null;
+
+        File.Move(this.InProgressPath, this.OutputPath, overwrite: true);
+    }
+
+    // Pooling is off so the file isn't held open once the connection is disposed, since it needs to be moved (or deleted) right after.
+    private string ConnectionString => new SqliteConnectionStringBuilder()
+    {
+        DataSource = this.InProgressPath,
+        Pooling = false
+    }.ToString();
+
+    private const string _BinariesTable = "Binaries";
+    private const string _PerfStatsTable = "PerfStats";
+    private const string _SectionTableName = "Sections";
+    private const string _COFFGroupTableName = "COFFGroups";
+    private const string _LibsTableName = "Libs";
+    private const string _CompilandsTableName = "Compilands";
+    private const string _DuplicateDataTableName = "DuplicateData";
+    private const string _WastefulVirtualsTypeTableName = "WastefulVirtualTypes";
+    private const string _WastefulVirtualsFunctionTableName = "WastefulVirtualFunctions";
+    private const string _SourceFilesTableName = "SourceFiles";
+    private const string _AnnotationsTableName = "Annotations";
+    private const string _SymbolsTableName = "Symbols";
+    private const string _SymbolLocationsTableName = "SymbolLocations";
+    private const string _ErrorsTableName = "Errors";
+
+    private int InsertBinary(SqliteConnection connection, SqliteTransaction transaction, ProductBinaryAnalysisResults results)
+    {
+        var binaryName = results.GetBinaryName(this.BinaryRoot);
+
+        using var command = connection.CreateCommand();
+        command.Transaction = transaction;
+        command.CommandText = $"INSERT INTO {_BinariesTable} " +
+                              $"(Name, Size) " +
+                              $"VALUES " +
+                              $"(@Name, @Size)";
+
+        command.Parameters.AddWithValue("@Name", binaryName);
+        command.Parameters.AddWithValue("@Size", results.fullBinarySize);
+        command.ExecuteNonQuery();
+
+        command.CommandText = "select last_insert_rowid()";
+        return Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture);
+    }
+
+    private static void InsertPerfStats(SqliteConnection connection, SqliteTransaction transaction, int binaryID, ProductBinaryAnalysisResults results)
+    {
+        using var command = connection.CreateCommand();
+        command.Transaction = transaction;
+        command.CommandText =
+                            $"INSERT INTO {_PerfStatsTable} " +
+                            $"(BinaryID, OpeningTookMs, SectionsTookMs, LibsTookMs, SourceFilesTookMs, DDITookMs, WVITookMs, AnnotationsTookMs, SymbolsInCompilandsTookMs) " +
+                            $"VALUES " +
+                            $"(@BinaryID, @OpeningTookMs, @SectionsTookMs, @LibsTookMs, @SourceFilesTookMs, @DDITookMs, @WVITookMs, @AnnotationsTookMs, @SymbolsInCompilandsTookMs)";
+
+        command.Parameters.AddWithValue("@BinaryID", binaryID);
+        command.Parameters.AddWithValue("@OpeningTookMs", results.openingTookMs);
+        command.Parameters.AddWithValue("@SectionsTookMs", results.sectionEnumerationTookMs);
+        command.Parameters.AddWithValue("@LibsTookMs", results.libEnumerationTookMs);
+        command.Parameters.AddWithValue("@SourceFilesTookMs", results.sourceFileEnumerationTookMs);
+        command.Parameters.AddWithValue("@DDITookMs", results.ddiEnumerationTookMs);
+        command.Parameters.AddWithValue("@WVITookMs", results.wviEnumerationTookMs);
+        command.Parameters.AddWithValue("@AnnotationsTookMs", results.annotationEnumerationTookMs);
+        command.Parameters.AddWithValue("@SymbolsInCompilandsTookMs", results.codeSymbolsInSourceFilesEnumerationTookMs);
+        command.ExecuteNonQuery();
+    }
+
+    private static void InsertSectionAndCOFFGroupsInThatSection(SqliteConnection connection, SqliteTransaction transaction, int binaryID, BinarySection section)
+    {
+        var sectionID = 0;
+        using (var command = connection.CreateCommand())
+        {
+            command.Transaction = transaction;
+            command.CommandText =
+                            $"INSERT INTO {_SectionTableName} " +
+                            $"(BinaryID, SectionName, Size, VirtualSize) " +
+                            $"VALUES " +
+                            $"(@BinaryID, @SectionName, @Size, @VirtualSize)";
+
+            command.Parameters.AddWithValue("@BinaryID", binaryID);
+            command.Parameters.AddWithValue("@SectionName", section.Name);
+            command.Parameters.AddWithValue("@Size", section.Size);
+            command.Parameters.AddWithValue("@VirtualSize", section.VirtualSize);
+            command.ExecuteNonQuery();
+
+            command.CommandText = "select last_insert_rowid()";
+            sectionID = Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture);
+        }
+
+        using (var command = connection.CreateCommand())
+        {
+            command.Transaction = transaction;
+            command.CommandText =
+                            $"INSERT INTO {_COFFGroupTableName} " +
+                            $"(BinaryID, BinarySectionID, COFFGroupName, Size, VirtualSize) " +
+                            $"VALUES " +
+                            $"(@BinaryID, @BinarySectionID, @COFFGroupName, @Size, @VirtualSize)";
+
+            command.Parameters.AddWithValue("@BinaryID", binaryID);
+            command.Parameters.AddWithValue("@BinarySectionID", sectionID);
+            command.Parameters.AddWithValue("@COFFGroupName", String.Empty);
+            command.Parameters.AddWithValue("@Size", 0);
+            command.Parameters.AddWithValue("@VirtualSize", 0);
+
+            foreach (var cg in section.COFFGroups)
+            {
+                command.Parameters["@COFFGroupName"].Value = cg.Name;
+                command.Parameters["@Size"].Value = cg.Size;
+                command.Parameters["@VirtualSize"].Value = cg.VirtualSize;
+                command.ExecuteNonQuery();
+            }
+        }
+    }
+
+    private static void InsertLibAndCompilands(SqliteConnection connection, SqliteTransaction transaction, int binaryID, Library lib, Dictionary<Compiland, int> compilandsToDatabaseIDs)
+    {
+        var libID = 0;
+        using (var command = connection.CreateCommand())
+        {
+            command.Transaction = transaction;
+            command.CommandText =
+                            $"INSERT INTO {_LibsTableName} " +
+                            $"(BinaryID, LibName, Size) " +
+                            $"VALUES " +
+                            $"(@BinaryID, @LibName, @Size)";
+
+            command.Parameters.AddWithValue("@BinaryID", binaryID);
+            command.Parameters.AddWithValue("@LibName", lib.Name);
+            command.Parameters.AddWithValue("@Size", lib.Size);
+            command.ExecuteNonQuery();
+
+            command.CommandText = "select last_insert_rowid()";
+            libID = Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture);
+        }
+
+        using (var command = connection.CreateCommand())
+        {
+            command.Transaction = transaction;
+            command.CommandText =
+                            $"INSERT INTO {_CompilandsTableName} " +
+                            $"(BinaryID, BinaryLibID, CompilandName, Size, CommandLine, RTTIEnabled, Language, FrontEndVersion, BackEndVersion) " +
+                            $"VALUES " +
+                            $"(@BinaryID, @BinaryLibID, @CompilandName, @Size, @CommandLine, @RTTIEnabled, @Language, @FrontEndVersion, @BackEndVersion)";
+
+            command.Parameters.AddWithValue("@BinaryID", binaryID);
+            command.Parameters.AddWithValue("@BinaryLibID", libID);
+            command.Parameters.AddWithValue("@CompilandName", String.Empty);
+            command.Parameters.AddWithValue("@Size", 0);
+            command.Parameters.AddWithValue("@CommandLine", String.Empty);
+            command.Parameters.AddWithValue("@RTTIEnabled", 0);
+            command.Parameters.AddWithValue("@Language", String.Empty);
+            command.Parameters.AddWithValue("@FrontEndVersion", String.Empty);
+            command.Parameters.AddWithValue("@BackEndVersion", String.Empty);
+
+
+            foreach (var compiland in lib.Compilands.Values)
+            {
+                command.CommandText =
+                            $"INSERT INTO {_CompilandsTableName} " +
+                            $"(BinaryID, BinaryLibID, CompilandName, Size, CommandLine, RTTIEnabled, Language, FrontEndVersion, BackEndVersion) " +
+                            $"VALUES " +
+                            $"(@BinaryID, @BinaryLibID, @CompilandName, @Size, @CommandLine, @RTTIEnabled, @Language, @FrontEndVersion, @BackEndVersion)";
+
+                command.Parameters["@CompilandName"].Value = compiland.Name;
+                command.Parameters["@Size"].Value = compiland.Size;
+                command.Parameters["@CommandLine"].Value = compiland.CommandLine;
+                command.Parameters["@RTTIEnabled"].Value = compiland.RTTIEnabled ? 1 : 0;
+                command.Parameters["@Language"].Value = BatchProcess.ToolLanguageFriendlyNames[compiland.ToolLanguage];
+                command.Parameters["@FrontEndVersion"].Value = compiland.ToolFrontEndVersion.ToString();
+                command.Parameters["@BackEndVersion"].Value = compiland.ToolBackEndVersion.ToString();
+                command.ExecuteNonQuery();
+
+                command.CommandText = "select last_insert_rowid()";
+                compilandsToDatabaseIDs.Add(compiland, Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture));
+            }
+        }
+    }
+
+    private static int InsertSourceFile(SqliteConnection connection, SqliteTransaction transaction, int binaryID, SourceFile? sourceFile, Dictionary<SourceFile, int> sourceFilesToDatabaseIDs)
+    {
+        using var command = connection.CreateCommand();
+        command.Transaction = transaction;
+        command.CommandText =
+                        $"INSERT INTO {_SourceFilesTableName} " +
+                        $"(BinaryID, SourceFileName, Size) " +
+                        $"VALUES " +
+                        $"(@BinaryID, @SourceFileName, @Size)";
+
+        command.Parameters.AddWithValue("@BinaryID", binaryID);
+        command.Parameters.AddWithValue("@SourceFileName", sourceFile?.Name ?? "unknown source file");
+        command.Parameters.AddWithValue("@Size", sourceFile?.Size ?? 0);
+        command.ExecuteNonQuery();
+
+        command.CommandText = "select last_insert_rowid()";
+        var newID = Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture);
+
+        if (sourceFile != null)
+        {
+            sourceFilesToDatabaseIDs.Add(sourceFile, newID);
+        }
+
+        return newID;
+    }
+
+    private static int InsertSymbol(SqliteConnection connection, SqliteTransaction transaction, Dictionary<uint, Dictionary<string, int>> symbolsToDatabaseIDs, SKUCrawlerSymbol skuSymbol)
+    {
+        if (symbolsToDatabaseIDs.TryGetValue(skuSymbol.Size, out var symbolsOfCorrectSize))
+        {
+            if (symbolsOfCorrectSize != null && symbolsOfCorrectSize.TryGetValue(skuSymbol.Name, out var existingSymbolID))
+            {
+                return existingSymbolID;
+            }
+        }
+
+        // No symbol with this name and size exists, so we'll insert it now.  This keeps the database from having tons of copies of the SymbolName string, and makes it easier
+        // to query across binaries for like symbols, when looking for SKU-wide opportunities across binaries and files.
+        using var command = connection.CreateCommand();
+        command.Transaction = transaction;
+        command.CommandText =
+                        $"INSERT INTO {_SymbolsTableName} " +
+                        $"(SymbolName, SymbolDetemplatedName, Size) " +
+                        $"VALUES " +
+                        $"(@SymbolName, @SymbolDetemplatedName, @Size)";
+
+        command.Parameters.AddWithValue("@SymbolName", skuSymbol.Name);
+        if (skuSymbol.DetemplatedName != null)
+        {
+            command.Parameters.AddWithValue("@SymbolDetemplatedName", skuSymbol.DetemplatedName);
+        }
+        else
+        {
+            command.Parameters.AddWithValue("@SymbolDetemplatedName", DBNull.Value);
+        }
+
+        command.Parameters.AddWithValue("@Size", skuSymbol.Size);
+        command.ExecuteNonQuery();
+
+        command.CommandText = "select last_insert_rowid()";
+        var symbolIDJustInserted = Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture);
+
+        if (symbolsOfCorrectSize != null)
+        {
+            symbolsOfCorrectSize.Add(skuSymbol.Name, symbolIDJustInserted);
+        }
+        else
+        {
+            var newSymbolsOfCorrectSize = new Dictionary<string, int>(StringComparer.Ordinal)
+                {
+                    { skuSymbol.Name, symbolIDJustInserted }
+                };
+            symbolsToDatabaseIDs.Add(skuSymbol.Size, newSymbolsOfCorrectSize);
+        }
+
+        return symbolIDJustInserted;
+    }
+
+    private static void InsertDuplicateDataItem(SqliteConnection connection, SqliteTransaction transaction, int binaryID, Dictionary<uint, Dictionary<string, int>> symbolsToDatabaseIDs, DuplicateDataItem ddi)
+    {
+        var symbolID = InsertSymbol(connection, transaction, symbolsToDatabaseIDs, new SKUCrawlerSymbol(ddi.Symbol));
+
+        using var command = connection.CreateCommand();
+        command.Transaction = transaction;
+        command.CommandText =
+                        $"INSERT INTO {_DuplicateDataTableName} " +
+                        $"(BinaryID, SymbolID, WastedSize) " +
+                        $"VALUES " +
+                        $"(@BinaryID, @SymbolID, @WastedSize)";
+
+        command.Parameters.AddWithValue("@BinaryID", binaryID);
+        command.Parameters.AddWithValue("@SymbolID", symbolID);
+        command.Parameters.AddWithValue("@WastedSize", ddi.WastedSize);
+        command.ExecuteNonQuery();
+    }
+
+    private static void InsertWastefulVirtualItems(SqliteConnection connection, SqliteTransaction transaction, int binaryID, WastefulVirtualItem wvi)
+    {
+        var wastefulVirtualTypeID = 0;
+        using (var command = connection.CreateCommand())
+        {
+            command.Transaction = transaction;
+            command.CommandText =
+                            $"INSERT INTO {_WastefulVirtualsTypeTableName} " +
+                            $"(BinaryID, TypeName, IsCOMType, WastePerSlot, WastedSize) " +
+                            $"VALUES " +
+                            $"(@BinaryID, @TypeName, @IsCOMType, @WastePerSlot, @WastedSize)";
+
+            command.Parameters.AddWithValue("@BinaryID", binaryID);
+            command.Parameters.AddWithValue("@TypeName", wvi.UserDefinedType.Name);
+            command.Parameters.AddWithValue("@IsCOMType", wvi.IsCOMType ? 0 : 1);
+            command.Parameters.AddWithValue("@WastePerSlot", wvi.WastePerSlot);
+            command.Parameters.AddWithValue("@WastedSize", wvi.WastedSize);
+            command.ExecuteNonQuery();
+
+            command.CommandText = "select last_insert_rowid()";
+            wastefulVirtualTypeID = Convert.ToInt32(command.ExecuteScalar(), CultureInfo.InvariantCulture);
+        }
+
+        using (var command = connection.CreateCommand())
+        {
+            command.Transaction = transaction;
+            command.CommandText =
+                            $"INSERT INTO {_WastefulVirtualsFunctionTableName} " +
+                            $"(WastefulVirtualTypeID, FunctionName, WastedSize) " +
+                            $"VALUES " +
+                            $"(@WastefulVirtualTypeID, @FunctionName, @WastedSize)";
+
+            command.Parameters.AddWithValue("@WastefulVirtualTypeID", wastefulVirtualTypeID);
+            command.Parameters.AddWithValue("@FunctionName", String.Empty);
+            command.Parameters.AddWithValue("@WastedSize", wvi.WastePerSlot);
+
+            foreach (var func in wvi.WastedOverridesNonPureWithNoOverrides.Concat(wvi.WastedOverridesPureWithExactlyOneOverride))
+            {
+                command.Parameters["@FunctionName"].Value = func.FormattedName.IncludeParentType;
+                command.ExecuteNonQuery();
+            }
+        }
+    }
+
+    private static void InsertAnnotation(SqliteConnection connection, SqliteTransaction transaction, int binaryID, Dictionary<SourceFile, int> sourceFileToIDMapping,
+                                         int sourceFileNullID, AnnotationSymbol annotation)
+    {
+        var sourceFileID = annotation.SourceFile is null ? sourceFileNullID : sourceFileToIDMapping[annotation.SourceFile];
+
+        using var command = connection.CreateCommand();
+        command.Transaction = transaction;
+        command.CommandText =
+                        $"INSERT INTO {_AnnotationsTableName} " +
+                        $"(BinaryID, SourceFileID, LineNumber, IsInlinedOrAnnotatingInlineSite, AnnotationText) " +
+                        $"VALUES " +
+                        $"(@BinaryID, @SourceFileID, @LineNumber, @IsInlinedOrAnnotatingInlineSite, @AnnotationText)";
+
+        command.Parameters.AddWithValue("@BinaryID", binaryID);
+        command.Parameters.AddWithValue("@SourceFileID", sourceFileID);
+        command.Parameters.AddWithValue("@LineNumber", annotation.LineNumber);
+        command.Parameters.AddWithValue("@IsInlinedOrAnnotatingInlineSite", annotation.IsInlinedOrAnnotatingInlineSite);
+        command.Parameters.AddWithValue("@AnnotationText", annotation.Text);
+        command.ExecuteNonQuery();
+    }
+
+    private static void InsertSymbolsInSourceFileAndCompiland(SqliteConnection connection, SqliteTransaction transaction, int binaryCompilandID, int sourceFileID,
+                                                              Dictionary<uint, Dictionary<string, int>> symbolsToIDMapping, List<SKUCrawlerSymbol> symbols)
+    {
+        foreach (var symbol in symbols)
+        {
+            var symbolID = InsertSymbol(connection, transaction, symbolsToIDMapping, symbol);
+
+            using var command = connection.CreateCommand();
+            command.Transaction = transaction;
+            command.CommandText =
+                            $"INSERT INTO {_SymbolLocationsTableName} " +
+                            $"(BinaryCompilandID, SourceFileID, SymbolID) " +
+                            $"VALUES " +
+                            $"(@BinaryCompilandID, @SourceFileID, @SymbolID)";
+
+            command.Parameters.AddWithValue("@BinaryCompilandID", binaryCompilandID);
+            command.Parameters.AddWithValue("@SourceFileID", sourceFileID);
+            command.Parameters.AddWithValue("@SymbolID", symbolID);
+            command.ExecuteNonQuery();
+        }
+    }
+
+    private void InsertManifestEntry(SqliteConnection connection, SqliteTransaction transaction, int binaryID, CrawlManifestEntry manifestEntry)
+    {
+        using var command = connection.CreateCommand();
+        command.Transaction = transaction;
+        command.CommandText =
+                            $"INSERT INTO {CrawlManifest.TableName} " +
+                            $"(BinaryID, PdbGuid, PdbAge, BinarySHA256, CrawlOptions) " +
+                            $"VALUES " +
+                            $"(@BinaryID, @PdbGuid, @PdbAge, @BinarySHA256, @CrawlOptions)";
+
+        command.Parameters.AddWithValue("@BinaryID", binaryID);
+        command.Parameters.AddWithValue("@PdbGuid", manifestEntry.PdbGuid.ToString());
+        command.Parameters.AddWithValue("@PdbAge", manifestEntry.PdbAge);
+        command.Parameters.AddWithValue("@BinarySHA256", manifestEntry.BinarySHA256);
+        command.Parameters.AddWithValue("@CrawlOptions", (int)CrawlManifest.GetOptions(this.IncludeWastefulVirtuals, this.IncludeCodeSymbols, this.IncludeDuplicateDataItems));
+        command.ExecuteNonQuery();
+    }
+
+    private static void InsertError(SqliteConnection connection, SqliteTransaction transaction, int binaryID, Exception error)
+    {
+        using var command = connection.CreateCommand();
+        command.Transaction = transaction;
+        command.CommandText =
+                            $"INSERT INTO {_ErrorsTableName} " +
+                            $"(BinaryID, ExceptionType, ExceptionMessage, ExceptionDetails) " +
+                            $"VALUES " +
+                            $"(@BinaryID, @ExceptionType, @ExceptionMessage, @ExceptionDetails)";
+
+        command.Parameters.AddWithValue("@BinaryID", binaryID);
+        command.Parameters.AddWithValue("@ExceptionType", error.GetType().Name);
+        command.Parameters.AddWithValue("@ExceptionMessage", error.Message);
+        command.Parameters.AddWithValue("@ExceptionDetails", error.GetFormattedTextForLogging(String.Empty, Environment.NewLine));
+        command.ExecuteNonQuery();
+    }
+
+    private void EnsureDatabaseCreated(ILogger logger)
+    {
+        logger.Log($"Creating new DB file {this.InProgressPath}, which becomes {this.OutputPath} when complete");
+        try
+        {
+            // Left behind by an earlier worker with this same batch number that didn't finish.
+            File.Delete(this.InProgressPath);
+
+            using var connection = new SqliteConnection(ConnectionString);
+            connection.Open();
+
+            var createTableQuery = $"CREATE TABLE {_BinariesTable} (" +
+                                       "BinaryID INTEGER PRIMARY KEY, " +
+                                       "Name TEXT, " +
+                                       "Size INT " +
+                                       ")";
+
+            SqliteCommand command;
+            using (command = new SqliteCommand(createTableQuery, connection))
+            {
+                command.ExecuteNonQuery();
+            }
+
+            createTableQuery = $"CREATE TABLE {_PerfStatsTable} (" +
+                                "BinaryID INT NOT NULL, " +
+                                "OpeningTookMs INT NOT NULL, " +
+                                "SectionsTookMs INT NOT NULL, " +
+                                "LibsTookMs INT NOT NULL, " +
+                                "SourceFilesTookMs INT NOT NULL, " +
+                                "DDITookMs INT NOT NULL, " +
+                                "WVITookMs INT NOT NULL, " +
+                                "AnnotationsTookMs INT NOT NULL, " +
+                                "SymbolsInCompilandsTookMs INT NOT NULL, " +
+                                "CONSTRAINT fk_binaries " +
+                                "  FOREIGN KEY (BinaryID) " +
+                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
+                                ")";
+
+            using (command = new SqliteCommand(createTableQuery, connection))
+            {
+                command.ExecuteNonQuery();
+            }
+
+            createTableQuery = $"CREATE TABLE {_SectionTableName} (" +
+                                "BinarySectionID INTEGER PRIMARY KEY, " +
+                                "BinaryID INT NOT NULL, " +
+                                "SectionName TEXT, " +
+                                "Size INT," +
+                                "VirtualSize INT, " +
+                                "CONSTRAINT fk_binaries " +
+                                "  FOREIGN KEY (BinaryID) " +
+                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
+                                ")";
+            using (command = new SqliteCommand(createTableQuery, connection))
+            {
+                command.ExecuteNonQuery();
+            }
+
+            createTableQuery = $"CREATE TABLE {_COFFGroupTableName} (" +
+                                "BinaryCOFFGroupID INTEGER PRIMARY KEY, " +
+                                "BinaryID INT NOT NULL, " +
+                                "BinarySectionID INT NOT NULL, " +
+                                "COFFGroupName TEXT, " +
+                                "Size INT," +
+                                "VirtualSize INT, " +
+                                "CONSTRAINT fk_binaries " +
+                                "  FOREIGN KEY (BinaryID) " +
+                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
+                                "CONSTRAINT fk_binarySections " +
+                                "  FOREIGN KEY (BinarySectionID) " +
+                               $"  REFERENCES {_SectionTableName}(BinarySectionID) " +
+                                ")";
+
+            using (command = new SqliteCommand(createTableQuery, connection))
+            {
+                command.ExecuteNonQuery();
+            }
+
+            createTableQuery = $"CREATE TABLE {_LibsTableName} (" +
+                                "BinaryLibID INTEGER PRIMARY KEY, " +
+                                "BinaryID INT NOT NULL, " +
+                                "LibName TEXT, " +
+                                "Size INT," +
+                                "CONSTRAINT fk_binaries " +
+                                "  FOREIGN KEY (BinaryID) " +
+                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
+                                ")";
+
+            using (command = new SqliteCommand(createTableQuery, connection))
+            {
+                command.ExecuteNonQuery();
+            }
+
+            createTableQuery = $"CREATE TABLE {_CompilandsTableName} (" +
+                                "BinaryCompilandID INTEGER PRIMARY KEY, " +
+                                "BinaryID INT NOT NULL, " +
+                                "BinaryLibID INT NOT NULL, " +
+                                "CompilandName TEXT, " +
+                                "Size INT," +
+                                "CommandLine TEXT, " +
+                                "RTTIEnabled INT, " +
+                                "Language TEXT, " +
+                                "FrontEndVersion TEXT, " +
+                                "BackEndVersion TEXT, " +
+                                "CONSTRAINT fk_binaries " +
+                                "  FOREIGN KEY (BinaryID) " +
+                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
+                                "CONSTRAINT fk_binaryLibs " +
+                                "  FOREIGN KEY (BinaryLibID) " +
+                               $"  REFERENCES {_LibsTableName}(BinaryLibID) " +
+                                ")";
+
+            using (command = new SqliteCommand(createTableQuery, connection))
+            {
+                command.ExecuteNonQuery();
+            }
+
+            //TODO: SKUCrawler: consider recording section/COFFGroup contributions of each lib/compiland too
+
+            createTableQuery = $"CREATE TABLE {_SymbolsTableName} (" +
+                                    "SymbolID INTEGER PRIMARY KEY, " +
+                                    "SymbolName TEXT NOT NULL, " +
+                                    "SymbolDetemplatedName TEXT, " +
+                                    "Size INT NOT NULL " +
+                                    ")";
+
+            using (command = new SqliteCommand(createTableQuery, connection))
+            {
+                command.ExecuteNonQuery();
+            }
+
+            if (this.IncludeDuplicateDataItems)
+            {
+                createTableQuery = $"CREATE TABLE {_DuplicateDataTableName} (" +
+                                    "DuplicateDataID INTEGER PRIMARY KEY, " +
+                                    "BinaryID INT NOT NULL, " +
+                                    "SymbolID INT NOT NULL, " +
+                                    "WastedSize INT," +
+                                    "CONSTRAINT fk_binaries " +
+                                    "  FOREIGN KEY (BinaryID) " +
+                                   $"  REFERENCES {_BinariesTable}(BinaryID) " +
+                                    "CONSTRAINT fk_symbols " +
+                                    "  FOREIGN KEY (SymbolID) " +
+                                   $"  REFERENCES {_SymbolsTableName}(SymbolID) " +
+                                    ")";
+
+                using (command = new SqliteCommand(createTableQuery, connection))
+                {
+                    command.ExecuteNonQuery();
+                }
+            }
+
+            if (this.IncludeWastefulVirtuals)
+            {
+                createTableQuery = $"CREATE TABLE {_WastefulVirtualsTypeTableName} (" +
+                                    "WastefulVirtualTypeID INTEGER PRIMARY KEY, " +
+                                    "BinaryID INT NOT NULL, " +
+                                    "TypeName TEXT, " +
+                                    "IsCOMType INT, " +
+                                    "WastePerSlot INT," +
+                                    "WastedSize INT," +
+                                    "CONSTRAINT fk_binaries " +
+                                    "  FOREIGN KEY (BinaryID) " +
+                                   $"  REFERENCES {_BinariesTable}(BinaryID) " +
+                                    ")";
+
+                using (command = new SqliteCommand(createTableQuery, connection))
+                {
+                    command.ExecuteNonQuery();
+                }
+
+                createTableQuery = $"CREATE TABLE {_WastefulVirtualsFunctionTableName} (" +
+                                    "WastefulVirtualFunctionID INTEGER PRIMARY KEY, " +
+                                    "WastefulVirtualTypeID INT NOT NULL, " +
+                                    "FunctionName TEXT, " +
+                                    "WastedSize INT, " +
+                                    "CONSTRAINT fk_wastefulVirtualTypes " +
+                                    "  FOREIGN KEY (WastefulVirtualTypeID) " +
+                                   $"  REFERENCES {_WastefulVirtualsTypeTableName}(WastefulVirtualTypeID) " +
+                                    ")";
+
+                using (command = new SqliteCommand(createTableQuery, connection))
+                {
+                    command.ExecuteNonQuery();
+                }
+            }
+
+            createTableQuery = $"CREATE TABLE {_SourceFilesTableName} (" +
+                                "SourceFileID INTEGER PRIMARY KEY, " +
+                                "BinaryID INT NOT NULL, " +
+                                "SourceFileName TEXT, " +
+                                "Size INT, " +
+                                "CONSTRAINT fk_binaries " +
+                                "  FOREIGN KEY (BinaryID) " +
+                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
+                                ")";
+
+            using (command = new SqliteCommand(createTableQuery, connection))
+            {
+                command.ExecuteNonQuery();
+            }
+
+            createTableQuery = $"CREATE TABLE {_AnnotationsTableName} (" +
+                                "AnnotationID INTEGER PRIMARY KEY, " +
+                                "BinaryID INT NOT NULL, " +
+                                "SourceFileID INT NOT NULL, " +
+                                "LineNumber INT NOT NULL, " +
+                                "IsInlinedOrAnnotatingInlineSite INT NOT NULL, " +
+                                "AnnotationText TEXT, " +
+                                "CONSTRAINT fk_binaries " +
+                                "  FOREIGN KEY (BinaryID) " +
+                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
+                                "CONSTRAINT fk_sourceFiles " +
+                                "  FOREIGN KEY (SourceFileID) " +
+                               $"  REFERENCES {_SourceFilesTableName}(SourceFileID) " +
+                                ")";
+
+            using (command = new SqliteCommand(createTableQuery, connection))
+            {
+                command.ExecuteNonQuery();
+            }
+
+            if (this.IncludeCodeSymbols)
+            {
+                createTableQuery = $"CREATE TABLE {_SymbolLocationsTableName} (" +
+                                    "SymbolLocationID INTEGER PRIMARY KEY, " +
+                                    "BinaryCompilandID INT NOT NULL, " +
+                                    "SourceFileID INT NOT NULL, " +
+                                    "SymbolID INT NOT NULL, " +
+                                    "CONSTRAINT fk_binaryCompilands " +
+                                    "  FOREIGN KEY (BinaryCompilandID) " +
+                                   $"  REFERENCES {_CompilandsTableName}(BinaryCompilandID) " +
+                                    "CONSTRAINT fk_sourceFiles " +
+                                    "  FOREIGN KEY (SourceFileID) " +
+                                   $"  REFERENCES {_SourceFilesTableName}(SourceFileID) " +
+                                    "CONSTRAINT fk_symbols " +
+                                    "  FOREIGN KEY (SymbolID) " +
+                                   $"  REFERENCES {_SymbolsTableName}(SymbolID) " +
+                                    ")";
+
+                using (command = new SqliteCommand(createTableQuery, connection))
+                {
+                    command.ExecuteNonQuery();
+                }
+            }
+
+            createTableQuery = $"CREATE TABLE {CrawlManifest.TableName} (" +
+                                "BinaryID INT NOT NULL, " +
+                                "PdbGuid TEXT, " +
+                                "PdbAge INT, " +
+                                "BinarySHA256 TEXT, " +
+                                "CrawlOptions INT NOT NULL, " +
+                                "CONSTRAINT fk_binaries " +
+                                "  FOREIGN KEY (BinaryID) " +
+                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
+                                ")";
+
+            using (command = new SqliteCommand(createTableQuery, connection))
+            {
+                command.ExecuteNonQuery();
+            }
+
+            createTableQuery = $"CREATE TABLE {_ErrorsTableName} (" +
+                                "ErrorID INTEGER PRIMARY KEY, " +
+                                "BinaryID INT NOT NULL, " +
+                                "ExceptionType TEXT, " +
+                                "ExceptionMessage TEXT, " +
+                                "ExceptionDetails TEXT, " +
+                                "CONSTRAINT fk_binaries " +
+                                "  FOREIGN KEY (BinaryID) " +
+                               $"  REFERENCES {_BinariesTable}(BinaryID) " +
+                                ")";
+
+            using (command = new SqliteCommand(createTableQuery, connection))
+            {
+                command.ExecuteNonQuery();
+            }
+        }
+        catch (Exception ex)
+        {
+            logger.LogException("Failed to setup the DB!", ex);
+            throw;
+        }
+    }
+
+    #region IDisposable Support
+
+    private bool _isDisposed; // To detect redundant calls
+
+    private void Dispose(bool disposing)
+    {
+        if (!this._isDisposed)
+        {
+            if (disposing)
+            {
+                this._transaction?.Dispose();
+
+                // Still open means Complete was never called, so this database is incomplete and shouldn't be left around to be mistaken
+                // for anything else.
+                if (this._connection != null)
+                {
+                    this._connection.Dispose();
+                    File.Delete(this.InProgressPath);
+                }
+            }
+
+            this._isDisposed = true;
+        }
+    }
+
+    public void Dispose()
+    {
+        Dispose(true);
+        GC.SuppressFinalize(this);
+    }
+
+    #endregion
+}
@@ -5,3 +5,5 @@
 
 [assembly: InternalsVisibleTo("SizeBench.GUI.Tests")]
 [assembly: InternalsVisibleTo("SizeBench.AnalysisEngine.Tests")]
+[assembly: InternalsVisibleTo("SizeBench.AnalysisEngine.Benchmarks")]
+[assembly: InternalsVisibleTo("SizeBench.SKUCrawler.Tests")]
@@ -99,6 +99,8 @@ internal class TestDIAAdapter : IDIAAdapter
         }
     }
 
+    public List<StaticDataSymbol>? FindStaticDataSymbolsThatMayBeDuplicates(HashSet<Compiland> compilands, ILogger logger, CancellationToken cancellation) => null;
+
     public Dictionary<uint, IEnumerable<IFunctionCodeSymbol>> FunctionsToFindBySymIndexId = new Dictionary<uint, IEnumerable<IFunctionCodeSymbol>>();
 
     public IEnumerable<IFunctionCodeSymbol> FindAllFunctionsWithinUDT(uint symIndexId, CancellationToken token)
@@ -175,6 +177,8 @@ internal class TestDIAAdapter : IDIAAdapter
         }
     }
 
+    public HashSet<string>? FindNamesOfUserDefinedTypesWithVirtualFunctions(ILogger logger, CancellationToken token) => null;
+
     public IEnumerable<AnnotationSymbol>? AnnotationsToFind;
     public IEnumerable<AnnotationSymbol> FindAllAnnotations(ILogger logger, CancellationToken token)
     {
@@ -230,15 +234,21 @@ internal class TestDIAAdapter : IDIAAdapter
     }
 
     public Dictionary<Tuple<SourceFile, Compiland>, IEnumerable<RVARange>> RVARangesToFindForSourceFileCompilandCombinations = new Dictionary<Tuple<SourceFile, Compiland>, IEnumerable<RVARange>>();
-    public IEnumerable<RVARange> FindRVARangesForSourceFileAndCompiland(SourceFile sourceFile, Compiland compiland, CancellationToken token)
+    public Dictionary<(SourceFile sourceFile, Compiland compiland), List<RVARange>> FindRVARangesForSourceFilesAndCompilands(IReadOnlyList<SourceFile> sourceFiles, ILogger logger, CancellationToken token)
     {
-        var key = Tuple.Create(sourceFile, compiland);
-        if (this.RVARangesToFindForSourceFileCompilandCombinations.ContainsKey(key))
+        var rangesBySourceFileAndCompiland = new Dictionary<(SourceFile sourceFile, Compiland compiland), List<RVARange>>();
+        foreach (var sourceFile in sourceFiles)
         {
-            return this.RVARangesToFindForSourceFileCompilandCombinations[key];
+            foreach (var compiland in sourceFile._compilands)
+            {
+                if (this.RVARangesToFindForSourceFileCompilandCombinations.TryGetValue(Tuple.Create(sourceFile, compiland), out var ranges))
+                {
+                    rangesBySourceFileAndCompiland.Add((sourceFile, compiland), ranges.ToList());
+                }
+            }
         }
 
-        return Enumerable.Empty<RVARange>();
+        return rangesBySourceFileAndCompiland;
     }
 
     public Dictionary<uint, byte> CountOfVTablesToFind = new Dictionary<uint, byte>();